@@ -107,8 +107,9 @@ extern time_t   last_program_stop;
 extern time_t   program_start;
 extern time_t   event_start;
 
-extern timed_event       *event_list_low;
-extern timed_event       *event_list_low_tail;
+extern int      check_result_reaper_threads;
+
+extern timed_event_queue event_queue_low;
 
 extern host              *host_list;
 extern service           *service_list;
@@ -119,7 +120,7 @@ extern unsigned long   next_event_id;
 extern unsigned long   next_problem_id;
 
 extern check_result    check_result_info;
-extern check_result    *check_result_list;
+extern check_result_queue check_result_list;
 
 extern pthread_t       worker_threads[TOTAL_WORKER_THREADS];
 
@@ -131,6 +132,169 @@ extern int      use_embedded_perl;
 
 int dummy;	/* reduce compiler warnings */
 
+static time_t get_service_freshness_expiration(service *, int *);
+static time_t get_host_freshness_expiration(host *, int *);
+
+
+/******************************************************************/
+/******************** CHECK DEADLINE FUNCTIONS ********************/
+/******************************************************************/
+
+/*
+ * the freshness and orphan checks keep a deadline for every host and
+ * service in a binary min-heap, so they only look at the objects whose
+ * deadline has passed instead of walking all of them. a deadline may be
+ * early (the object just gets a new one), but never late: it is updated
+ * when a check result comes in or a command changes what it depends on.
+ */
+static check_deadline_queue service_freshness_queue;
+static check_deadline_queue host_freshness_queue;
+static check_deadline_queue service_orphan_queue;
+static check_deadline_queue host_orphan_queue;
+
+
+/* returns TRUE if deadline a passes before deadline b */
+static int deadline_passes_before(void *a, void *b) {
+
+	return (((check_deadline *)a)->deadline < ((check_deadline *)b)->deadline) ? TRUE : FALSE;
+}
+
+
+/* remembers the heap slot of a deadline */
+static void set_deadline_queue_pos(void *deadline, unsigned int pos) {
+
+	((check_deadline *)deadline)->queue_pos = pos;
+}
+
+
+/* returns the heap of a deadline queue, which gets its callbacks on first use */
+static minheap *get_deadline_heap(check_deadline_queue *queue) {
+
+	if (queue->heap.comes_before == NULL)
+		minheap_init(&queue->heap, deadline_passes_before, set_deadline_queue_pos);
+
+	return &queue->heap;
+}
+
+
+/* takes a deadline out of its queue */
+static void remove_check_deadline(check_deadline_queue *queue, check_deadline *deadline) {
+
+	if (minheap_contains(&queue->heap, deadline, deadline->queue_pos) == FALSE)
+		return;
+
+	minheap_delete(get_deadline_heap(queue), deadline->queue_pos);
+}
+
+
+/* adds a deadline to its queue or moves it if it's already queued */
+static void set_check_deadline(check_deadline_queue *queue, check_deadline *deadline, void *object, time_t when) {
+
+	deadline->deadline = when;
+	deadline->object = object;
+
+	if (minheap_contains(&queue->heap, deadline, deadline->queue_pos) == TRUE)
+		minheap_update(get_deadline_heap(queue), deadline->queue_pos);
+
+	else if (minheap_insert(get_deadline_heap(queue), deadline) == ERROR)
+		logit(NSLOG_RUNTIME_ERROR, TRUE, "Error: Could not allocate memory for check deadline queue!\n");
+}
+
+
+/* takes the earliest deadline out of its queue if it has passed */
+static check_deadline *get_due_check_deadline(check_deadline_queue *queue, time_t current_time) {
+	check_deadline *deadline = NULL;
+
+	if ((deadline = (check_deadline *)minheap_peek(&queue->heap)) == NULL || deadline->deadline > current_time)
+		return NULL;
+
+	return (check_deadline *)minheap_pop(&queue->heap);
+}
+
+
+/* the time at which the results of a running service check should have come in (allow 10 minutes slack time) */
+static time_t get_service_orphan_time(service *svc) {
+
+	return (time_t)(svc->next_check + svc->latency + service_check_timeout + check_reaper_interval + 600);
+}
+
+
+/* the time at which the results of a running host check should have come in (allow 10 minutes slack time) */
+static time_t get_host_orphan_time(host *hst) {
+
+	return (time_t)(hst->next_check + hst->latency + host_check_timeout + check_reaper_interval + 600);
+}
+
+
+/* updates the time at which the freshness check has to look at a service again */
+void update_service_freshness_deadline(service *svc) {
+
+	if (svc == NULL)
+		return;
+
+	/* services without freshness checking don't need a deadline */
+	if (svc->check_freshness == FALSE || (svc->check_interval == 0 && svc->freshness_threshold == 0)) {
+		remove_check_deadline(&service_freshness_queue, &svc->freshness_deadline);
+		return;
+	}
+
+	/* all services are added on the first freshness check */
+	if (service_freshness_queue.built == FALSE)
+		return;
+
+	set_check_deadline(&service_freshness_queue, &svc->freshness_deadline, svc, get_service_freshness_expiration(svc, NULL) + 1);
+}
+
+
+/* updates the time at which the freshness check has to look at a host again */
+void update_host_freshness_deadline(host *hst) {
+
+	if (hst == NULL)
+		return;
+
+	/* hosts without freshness checking don't need a deadline */
+	if (hst->check_freshness == FALSE) {
+		remove_check_deadline(&host_freshness_queue, &hst->freshness_deadline);
+		return;
+	}
+
+	/* all hosts are added on the first freshness check */
+	if (host_freshness_queue.built == FALSE)
+		return;
+
+	set_check_deadline(&host_freshness_queue, &hst->freshness_deadline, hst, get_host_freshness_expiration(hst, NULL) + 1);
+}
+
+
+/* remembers when a service check that was just started counts as orphaned */
+void add_service_orphan_deadline(service *svc) {
+
+	set_check_deadline(&service_orphan_queue, &svc->orphan_deadline, svc, get_service_orphan_time(svc) + 1);
+}
+
+
+/* remembers when a host check that was just started counts as orphaned */
+void add_host_orphan_deadline(host *hst) {
+
+	set_check_deadline(&host_orphan_queue, &hst->orphan_deadline, hst, get_host_orphan_time(hst) + 1);
+}
+
+
+/* frees the deadline queues, the objects they point to are about to go away */
+void free_check_deadline_queues(void) {
+
+	minheap_free(&service_freshness_queue.heap);
+	minheap_free(&host_freshness_queue.heap);
+	minheap_free(&service_orphan_queue.heap);
+	minheap_free(&host_orphan_queue.heap);
+
+	memset(&service_freshness_queue, 0, sizeof(service_freshness_queue));
+	memset(&host_freshness_queue, 0, sizeof(host_freshness_queue));
+	memset(&service_orphan_queue, 0, sizeof(service_orphan_queue));
+	memset(&host_orphan_queue, 0, sizeof(host_orphan_queue));
+}
+
+
 /******************************************************************/
 /********************* MISCELLANEOUS FUNCTIONS ********************/
 /******************************************************************/
@@ -152,7 +316,7 @@ static void extract_check_result(FILE *fp, dbuf *checkresult_dbuf) {
 }
 
 /* convert a command line to an array of arguments, suitable for exec* functions */
-static int parse_command_line(char *cmd, char *argv[MAX_CMD_ARGS]) {
+int parse_command_line(char *cmd, char *argv[MAX_CMD_ARGS]) {
 	unsigned int argc = 0;
 	char *parsed_cmd;
 
@@ -193,7 +357,7 @@ static int parse_command_line(char *cmd, char *argv[MAX_CMD_ARGS]) {
 
 		if (argc >= MAX_CMD_ARGS - 1) {
 			logit(NSLOG_RUNTIME_WARNING, TRUE, "overlimit args for command %s\n", argv[0]);
-			_exit(STATE_UNKNOWN);
+			return ERROR;
 		} else
 			*(parsed_cmd++) = '\0';
 	}
@@ -232,7 +396,8 @@ static int run_check(char *processed_command, dbuf *checkresult_dbuf) {
 			close(pipefds[1]);
 
 			/* extract command args for execv */
-			parse_command_line(processed_command, argv);
+			if (parse_command_line(processed_command, argv) == ERROR)
+				_exit(STATE_UNKNOWN);
 
 			if (!argv[0]) {
 				logit(NSLOG_RUNTIME_WARNING, TRUE, "插件命令定义为空\n");
@@ -287,8 +452,32 @@ static int run_check(char *processed_command, dbuf *checkresult_dbuf) {
 /********************** CHECK REAPER FUNCTIONS ********************/
 /******************************************************************/
 
+/*
+ * the reaper threads are started with the first batch and kept until shutdown. the main
+ * thread hands them a batch through the work queue below and waits until every thread has
+ * parsed the output of the results belonging to its hosts.
+ */
+typedef struct check_result_work_queue_struct{
+	pthread_t threads[MAX_CHECK_RESULT_REAPER_THREADS];
+	int thread_count;
+	check_result **results;
+	int count;
+	unsigned long batch;				/* number of the current batch, threads wait for the next one */
+	unsigned long start_batch;			/* batch number when the threads were started */
+	int busy_threads;				/* threads still working on the current batch */
+	int shutdown;
+	pthread_mutex_t lock;
+	pthread_cond_t work_cond;
+	pthread_cond_t done_cond;
+	}check_result_work_queue;
+
+static check_result_work_queue reaper_queue;
+
 /* reaps host and service check results */
 int reap_check_results(void) {
+	static check_result *reaper_batch[CHECK_RESULT_REAPER_BATCH_SIZE];
+	int batch_count = 0;
+	int batch_next = 0;
 	check_result *queued_check_result = NULL;
 	service *temp_service = NULL;
 	host *temp_host = NULL;
@@ -302,11 +491,33 @@ int reap_check_results(void) {
 	/* get the start time */
 	time(&reaper_start_time);
 
+	/* collect results streamed back by the check workers */
+	read_check_worker_results();
+
+	/* collect results forked checks sent through the in-memory channel */
+	read_check_result_channel();
+
 	/* process files in the check result queue */
 	process_check_result_queue(check_result_path);
 
 	/* read all check results that have come in... */
-	while ((queued_check_result = read_check_result())) {
+	while (1) {
+
+		/* let the reaper threads parse the output of the next batch of results */
+		if (check_result_reaper_threads > 0) {
+			if (batch_next == batch_count) {
+				for (batch_count = 0, batch_next = 0; batch_count < CHECK_RESULT_REAPER_BATCH_SIZE; batch_count++) {
+					if ((reaper_batch[batch_count] = read_check_result()) == NULL)
+						break;
+				}
+				preparse_check_results(reaper_batch, batch_count, check_result_reaper_threads);
+			}
+			queued_check_result = (batch_next < batch_count) ? reaper_batch[batch_next++] : NULL;
+		} else
+			queued_check_result = read_check_result();
+
+		if (queued_check_result == NULL)
+			break;
 
 		reaped_checks++;
 
@@ -333,6 +544,9 @@ int reap_check_results(void) {
 
 			/* process the check result */
 			handle_async_service_check_result(temp_service, queued_check_result);
+
+			/* the result changes when the service goes stale */
+			update_service_freshness_deadline(temp_service);
 		}
 
 		/* host check */
@@ -355,6 +569,9 @@ int reap_check_results(void) {
 
 			/* process the check result */
 			handle_async_host_check_result_3x(temp_host, queued_check_result);
+
+			/* the result changes when the host goes stale */
+			update_host_freshness_deadline(temp_host);
 		}
 
 		log_debug_info(DEBUGL_CHECKS | DEBUGL_IPC, 1, "删除检查结果文件 '%s'\n", queued_check_result->output_file);
@@ -378,6 +595,10 @@ int reap_check_results(void) {
 		}
 	}
 
+	/* results of the batch we didn't get to go back to the list, they keep their parsed output */
+	while (batch_next < batch_count)
+		add_check_result_to_list(reaper_batch[batch_next++]);
+
 	log_debug_info(DEBUGL_CHECKS, 0, "Finished reaping %d check results\n", reaped_checks);
 	log_debug_info(DEBUGL_FUNCTIONS, 0, "reap_check_results() end\n");
 
@@ -385,6 +606,201 @@ int reap_check_results(void) {
 }
 
 
+/* parses the output of one check result, so the main thread doesn't have to */
+static void preparse_check_result(check_result *cr) {
+	char *temp_buffer = NULL;
+
+	if (cr->output_parsed == TRUE || cr->output == NULL)
+		return;
+
+	/* parse_check_output() changes the buffer it is given */
+	if ((temp_buffer = (char *)strdup(cr->output)) == NULL)
+		return;
+
+	parse_check_output(temp_buffer, &cr->short_output, &cr->long_output, &cr->perf_data, TRUE, TRUE);
+	my_free(temp_buffer);
+
+	cr->output_parsed = TRUE;
+}
+
+
+/* parses the output of the results in a batch that belong to the hosts of a shard */
+static void preparse_check_result_shard(check_result **results, int count, int shard, int shards) {
+	check_result *cr = NULL;
+	int x = 0;
+
+	for (x = 0; x < count; x++) {
+		cr = results[x];
+		if (cr->host_name == NULL || hashfunc(cr->host_name, NULL, shards) != shard)
+			continue;
+		preparse_check_result(cr);
+	}
+}
+
+
+/* reaper thread: waits for a batch and handles the results of the hosts in its shard */
+static void *check_result_reaper_thread(void *data) {
+	int shard = (int)(long)data;
+	unsigned long last_batch = 0L;
+	check_result **results = NULL;
+	int count = 0;
+	int shards = 0;
+
+	pthread_mutex_lock(&reaper_queue.lock);
+	last_batch = reaper_queue.start_batch;
+
+	while (1) {
+
+		while (reaper_queue.shutdown == FALSE && reaper_queue.batch == last_batch)
+			pthread_cond_wait(&reaper_queue.work_cond, &reaper_queue.lock);
+
+		if (reaper_queue.shutdown == TRUE)
+			break;
+
+		last_batch = reaper_queue.batch;
+		results = reaper_queue.results;
+		count = reaper_queue.count;
+		shards = reaper_queue.thread_count;
+		pthread_mutex_unlock(&reaper_queue.lock);
+
+		preparse_check_result_shard(results, count, shard, shards);
+
+		pthread_mutex_lock(&reaper_queue.lock);
+		if (--reaper_queue.busy_threads == 0)
+			pthread_cond_signal(&reaper_queue.done_cond);
+	}
+
+	pthread_mutex_unlock(&reaper_queue.lock);
+
+	return NULL;
+}
+
+
+/* starts the reaper threads, fewer if not all of them can be started */
+static int init_check_result_reaper_threads(int threads) {
+	sigset_t newmask;
+	sigset_t oldmask;
+
+	reaper_queue.shutdown = FALSE;
+	reaper_queue.busy_threads = 0;
+	reaper_queue.thread_count = 0;
+	reaper_queue.start_batch = reaper_queue.batch;
+	pthread_mutex_init(&reaper_queue.lock, NULL);
+	pthread_cond_init(&reaper_queue.work_cond, NULL);
+	pthread_cond_init(&reaper_queue.done_cond, NULL);
+
+	/* reaper threads should block all signals */
+	sigfillset(&newmask);
+	pthread_sigmask(SIG_BLOCK, &newmask, &oldmask);
+
+	while (reaper_queue.thread_count < threads) {
+		if (pthread_create(&reaper_queue.threads[reaper_queue.thread_count], NULL, check_result_reaper_thread, (void *)(long)reaper_queue.thread_count) != 0)
+			break;
+		reaper_queue.thread_count++;
+	}
+
+	pthread_sigmask(SIG_SETMASK, &oldmask, NULL);
+
+	log_debug_info(DEBUGL_CHECKS, 1, "Started %d check result reaper threads\n", reaper_queue.thread_count);
+
+	if (reaper_queue.thread_count == 0) {
+		pthread_mutex_destroy(&reaper_queue.lock);
+		pthread_cond_destroy(&reaper_queue.work_cond);
+		pthread_cond_destroy(&reaper_queue.done_cond);
+		return ERROR;
+	}
+
+	return OK;
+}
+
+
+/* tells the reaper threads to exit and waits for them */
+int shutdown_check_result_reaper_threads(void) {
+	int x = 0;
+
+	if (reaper_queue.thread_count == 0)
+		return OK;
+
+	pthread_mutex_lock(&reaper_queue.lock);
+	reaper_queue.shutdown = TRUE;
+	pthread_cond_broadcast(&reaper_queue.work_cond);
+	pthread_mutex_unlock(&reaper_queue.lock);
+
+	for (x = 0; x < reaper_queue.thread_count; x++)
+		pthread_join(reaper_queue.threads[x], NULL);
+
+	reaper_queue.thread_count = 0;
+	pthread_mutex_destroy(&reaper_queue.lock);
+	pthread_cond_destroy(&reaper_queue.work_cond);
+	pthread_cond_destroy(&reaper_queue.done_cond);
+
+	return OK;
+}
+
+
+/* parses the output of a batch of check results in threads, all results of a host are handled by the same thread */
+int preparse_check_results(check_result **results, int count, int threads) {
+	int x = 0;
+
+	if (results == NULL || count <= 0)
+		return OK;
+
+	if (threads > MAX_CHECK_RESULT_REAPER_THREADS)
+		threads = MAX_CHECK_RESULT_REAPER_THREADS;
+
+	/* no point in handing the batch to threads */
+	if (threads <= 1 || count == 1) {
+		for (x = 0; x < count; x++)
+			preparse_check_result(results[x]);
+		return OK;
+	}
+
+	/* the threads are started once, or again if their number has been changed */
+	if (reaper_queue.thread_count != threads) {
+		shutdown_check_result_reaper_threads();
+		init_check_result_reaper_threads(threads);
+	}
+
+	if (reaper_queue.thread_count > 0) {
+		pthread_mutex_lock(&reaper_queue.lock);
+		reaper_queue.results = results;
+		reaper_queue.count = count;
+		reaper_queue.busy_threads = reaper_queue.thread_count;
+		reaper_queue.batch++;
+		pthread_cond_broadcast(&reaper_queue.work_cond);
+		while (reaper_queue.busy_threads > 0)
+			pthread_cond_wait(&reaper_queue.done_cond, &reaper_queue.lock);
+		reaper_queue.results = NULL;
+		pthread_mutex_unlock(&reaper_queue.lock);
+	}
+
+	/* results without a host name aren't in any shard, the rest if no thread could be started */
+	for (x = 0; x < count; x++)
+		preparse_check_result(results[x]);
+
+	log_debug_info(DEBUGL_CHECKS, 2, "Reaper threads parsed the output of %d check results\n", count);
+
+	return OK;
+}
+
+
+/* takes the output parsed by the reaper threads, or parses the raw output if that didn't happen */
+int get_parsed_check_output(check_result *cr, char **short_output, char **long_output, char **perf_data) {
+
+	if (cr->output_parsed == FALSE)
+		return parse_check_output(cr->output, short_output, long_output, perf_data, TRUE, TRUE);
+
+	*short_output = cr->short_output;
+	*long_output = cr->long_output;
+	*perf_data = cr->perf_data;
+	cr->short_output = NULL;
+	cr->long_output = NULL;
+	cr->perf_data = NULL;
+
+	return OK;
+}
+
+
 
 
 /******************************************************************/
@@ -498,6 +914,7 @@ int run_async_service_check(service *svc, int check_options, double latency, int
 	char *output_file = NULL;
 	double old_latency = 0.0;
 	dbuf checkresult_dbuf;
+	check_result *worker_check_result = NULL;
 	int dbuf_chunk = 1024;
 	FILE *fp;
 #ifdef USE_EVENT_BROKER
@@ -594,7 +1011,7 @@ int run_async_service_check(service *svc, int check_options, double latency, int
 	}
 
 	/* process any macros contained in the argument */
-	process_macros_r(&mac, raw_command, &processed_command, 0);
+	process_command_macros_r(&mac, svc->check_command_ptr, &processed_command, 0);
 
 	my_free(raw_command);
 
@@ -631,6 +1048,7 @@ int run_async_service_check(service *svc, int check_options, double latency, int
 
 	/* set the execution flag */
 	svc->is_executing = TRUE;
+	add_service_orphan_deadline(svc);
 
 	/* start save check info */
 	check_result_info.object_check_type = SERVICE_CHECK;
@@ -638,6 +1056,7 @@ int run_async_service_check(service *svc, int check_options, double latency, int
 	check_result_info.check_options = check_options;
 	check_result_info.scheduled_check = scheduled_check;
 	check_result_info.reschedule_check = reschedule_check;
+	check_result_info.latency = svc->latency;
 	check_result_info.start_time = start_time;
 	check_result_info.finish_time = start_time;
 	check_result_info.early_timeout = FALSE;
@@ -645,6 +1064,43 @@ int run_async_service_check(service *svc, int check_options, double latency, int
 	check_result_info.return_code = STATE_OK;
 	check_result_info.output = NULL;
 
+	/* let a persistent check worker run the plugin, if we have any */
+	if (check_worker_can_run(processed_command) == TRUE && (worker_check_result = (check_result *)malloc(sizeof(check_result))) != NULL) {
+
+		init_check_result(worker_check_result);
+		worker_check_result->object_check_type = SERVICE_CHECK;
+		worker_check_result->host_name = (char *)strdup(svc->host_name);
+		worker_check_result->service_description = (char *)strdup(svc->description);
+		worker_check_result->output_file = NULL;
+		worker_check_result->check_type = SERVICE_CHECK_ACTIVE;
+		worker_check_result->check_options = check_options;
+		worker_check_result->scheduled_check = scheduled_check;
+		worker_check_result->reschedule_check = reschedule_check;
+		worker_check_result->latency = svc->latency;
+		worker_check_result->start_time = start_time;
+		worker_check_result->finish_time = start_time;
+
+		if (submit_check_to_worker(worker_check_result, &mac, processed_command, service_check_timeout) == OK) {
+
+			log_debug_info(DEBUGL_CHECKS, 2, "Service check was handed to a check worker\n");
+
+			/* reset latency (permanent value will be set later) */
+			svc->latency = old_latency;
+
+			/* update check statistics */
+			update_check_stats((scheduled_check == TRUE) ? ACTIVE_SCHEDULED_SERVICE_CHECK_STATS : ACTIVE_ONDEMAND_SERVICE_CHECK_STATS, start_time.tv_sec);
+
+			clear_volatile_macros_r(&mac);
+			my_free(processed_command);
+
+			return OK;
+		}
+
+		/* fall back to forking the check ourselves */
+		free_check_result(worker_check_result);
+		my_free(worker_check_result);
+	}
+
 	/* open a temp file for storing check output */
 	old_umask = umask(new_umask);
 	dummy = asprintf(&output_file, "%s/checkXXXXXX", temp_path);
@@ -785,8 +1241,8 @@ int run_async_service_check(service *svc, int check_options, double latency, int
 				/* close the temp file */
 				fclose(check_result_info.output_file_fp);
 
-				/* move check result to queue directory */
-				move_check_result_to_queue(check_result_info.output_file);
+				/* pass check result on to the core */
+				submit_check_result(&check_result_info, checkresult_dbuf.buf);
 			}
 
 			/* free memory */
@@ -925,8 +1381,8 @@ int run_async_service_check(service *svc, int check_options, double latency, int
 					/* close the temp file */
 					fclose(check_result_info.output_file_fp);
 
-					/* move check result to queue directory */
-					move_check_result_to_queue(check_result_info.output_file);
+					/* pass check result on to the core */
+					submit_check_result(&check_result_info, checkresult_dbuf.buf);
 				}
 
 				/* free memory */
@@ -984,8 +1440,8 @@ int run_async_service_check(service *svc, int check_options, double latency, int
 				/* close the temp file */
 				fclose(fp);
 
-				/* move check result to queue directory */
-				move_check_result_to_queue(check_result_info.output_file);
+				/* pass check result on to the core */
+				submit_check_result(&check_result_info, checkresult_dbuf.buf);
 			}
 
 			/* free memory */
@@ -1180,7 +1636,7 @@ int handle_async_service_check_result(service *temp_service, check_result *queue
 	else {
 
 		/* parse check output to get: (1) short output, (2) long output, (3) perf data */
-		parse_check_output(queued_check_result->output, &temp_service->plugin_output, &temp_service->long_plugin_output, &temp_service->perf_data, TRUE, TRUE);
+		get_parsed_check_output(queued_check_result, &temp_service->plugin_output, &temp_service->long_plugin_output, &temp_service->perf_data);
 
 		/* make sure the plugin output isn't null */
 		if (temp_service->plugin_output == NULL)
@@ -1949,7 +2405,7 @@ void schedule_service_check(service *svc, time_t check_time, int options) {
 		log_debug_info(DEBUGL_CHECKS, 2, "Scheduling new service check event for '%s' on host '%s' @ %s", svc->description, svc->host_name, ctime(&check_time));
 
 		/* allocate memory for a new event item */
-		new_event = (timed_event *)malloc(sizeof(timed_event));
+		new_event = (timed_event *)calloc(1, sizeof(timed_event));
 
 		if (new_event == NULL) {
 			logit(NSLOG_RUNTIME_WARNING, TRUE, "Warning: Could not reschedule check of service '%s' on host '%s'!\n", svc->description, svc->host_name);
@@ -1959,7 +2415,7 @@ void schedule_service_check(service *svc, time_t check_time, int options) {
 		/* make sure we kill off the old event */
 		if (temp_event) {
 			log_debug_info(DEBUGL_CHECKS, 2, "Removing service check event for service '%s' on host '%s' @ %s", svc->description, svc->host_name, ctime(&temp_event->run_time));
-			remove_event(temp_event, &event_list_low, &event_list_low_tail);
+			remove_event(temp_event, &event_queue_low);
 			my_free(temp_event);
 		}
 
@@ -1980,7 +2436,7 @@ void schedule_service_check(service *svc, time_t check_time, int options) {
 		new_event->event_interval = 0L;
 		new_event->timing_func = NULL;
 		new_event->compensate_for_time_change = TRUE;
-		reschedule_event(new_event, &event_list_low, &event_list_low_tail);
+		reschedule_event(new_event, &event_queue_low);
 	}
 
 	else {
@@ -2126,6 +2582,7 @@ int check_service_dependencies(service *svc, int dependency_type) {
 /* check for services that never returned from a check... */
 void check_for_orphaned_services(void) {
 	service *temp_service = NULL;
+	check_deadline *deadline = NULL;
 	time_t current_time = 0L;
 	time_t expected_time = 0L;
 
@@ -2135,15 +2592,23 @@ void check_for_orphaned_services(void) {
 	/* get the current time */
 	time(&current_time);
 
-	/* check all services... */
-	for (temp_service = service_list; temp_service != NULL; temp_service = temp_service->next) {
+	/* check the services whose check should have returned by now... */
+	while ((deadline = get_due_check_deadline(&service_orphan_queue, current_time)) != NULL) {
+
+		temp_service = (service *)deadline->object;
 
 		/* skip services that are not currently executing */
 		if (temp_service->is_executing == FALSE)
 			continue;
 
 		/* determine the time at which the check results should have come in (allow 10 minutes slack time) */
-		expected_time = (time_t)(temp_service->next_check + temp_service->latency + service_check_timeout + check_reaper_interval + 600);
+		expected_time = get_service_orphan_time(temp_service);
+
+		/* the service was rescheduled while its check was running */
+		if (expected_time >= current_time) {
+			set_check_deadline(&service_orphan_queue, deadline, temp_service, expected_time + 1);
+			continue;
+		}
 
 		/* this service was supposed to have executed a while ago, but for some reason the results haven't come back in... */
 		if (expected_time < current_time) {
@@ -2177,7 +2642,9 @@ void check_for_orphaned_services(void) {
 /* check freshness of service results */
 void check_service_result_freshness(void) {
 	service *temp_service = NULL;
+	check_deadline *deadline = NULL;
 	time_t current_time = 0L;
+	time_t next_valid_time = 0L;
 
 
 	log_debug_info(DEBUGL_FUNCTIONS, 0, "check_service_result_freshness()\n");
@@ -2192,8 +2659,21 @@ void check_service_result_freshness(void) {
 	/* get the current time */
 	time(&current_time);
 
-	/* check all services... */
-	for (temp_service = service_list; temp_service != NULL; temp_service = temp_service->next) {
+	/* the first run looks at all services */
+	if (service_freshness_queue.built == FALSE) {
+		service_freshness_queue.built = TRUE;
+		for (temp_service = service_list; temp_service != NULL; temp_service = temp_service->next)
+			update_service_freshness_deadline(temp_service);
+	}
+
+	/*
+	 * only look at the services whose results may have expired by now.
+	 * services that are skipped get a new deadline once a check result
+	 * comes in or their checks are enabled again
+	 */
+	while ((deadline = get_due_check_deadline(&service_freshness_queue, current_time)) != NULL) {
+
+		temp_service = (service *)deadline->object;
 
 		/* skip services we shouldn't be checking for freshness */
 		if (temp_service->check_freshness == FALSE)
@@ -2212,8 +2692,14 @@ void check_service_result_freshness(void) {
 			continue;
 
 		/* see if the time is right... */
-		if (check_time_against_period(current_time, temp_service->check_period_ptr) == ERROR)
+		if (check_time_against_period(current_time, temp_service->check_period_ptr) == ERROR) {
+
+			/* look again when the check period starts */
+			next_valid_time = 0L;
+			get_next_valid_time(current_time, &next_valid_time, temp_service->check_period_ptr);
+			set_check_deadline(&service_freshness_queue, deadline, temp_service, (next_valid_time > current_time) ? next_valid_time : current_time + 1);
 			continue;
+		}
 
 		/* EXCEPTION */
 		/* don't check freshness of services without regular check intervals if we're using auto-freshness threshold */
@@ -2230,6 +2716,9 @@ void check_service_result_freshness(void) {
 			schedule_service_check(temp_service, current_time, CHECK_OPTION_FORCE_EXECUTION | CHECK_OPTION_FRESHNESS_CHECK);
 		}
 
+		/* look again when the results expire */
+		else
+			set_check_deadline(&service_freshness_queue, deadline, temp_service, get_service_freshness_expiration(temp_service, NULL) + 1);
 	}
 
 	return;
@@ -2252,6 +2741,37 @@ int is_service_result_fresh(service *temp_service, time_t current_time, int log_
 
 	log_debug_info(DEBUGL_CHECKS, 2, "Checking freshness of service '%s' on host '%s'...\n", temp_service->description, temp_service->host_name);
 
+	expiration_time = get_service_freshness_expiration(temp_service, &freshness_threshold);
+
+	log_debug_info(DEBUGL_CHECKS, 2, "SERVICE: HBC (has_been_checked): %d, PS (program_start): %lu, ES (event_start): %lu, LC (last_check): %lu, CT (current_time): %lu, ET (expiration_time): %lu\n", temp_service->has_been_checked, (unsigned long)program_start, (unsigned long)event_start, (unsigned long)temp_service->last_check, (unsigned long)current_time, (unsigned long)expiration_time);
+
+	/* the results for the last check of this service are stale */
+	if (expiration_time < current_time) {
+
+		get_time_breakdown((current_time - expiration_time), &days, &hours, &minutes, &seconds);
+		get_time_breakdown(freshness_threshold, &tdays, &thours, &tminutes, &tseconds);
+
+		/* log a warning */
+		if (log_this == TRUE)
+			logit(NSLOG_RUNTIME_WARNING, TRUE, "警报: The results of service '%s' on host '%s' are stale by %dd %dh %dm %ds (threshold=%dd %dh %dm %ds).  I'm forcing an immediate check of the service.\n", temp_service->description, temp_service->host_name, days, hours, minutes, seconds, tdays, thours, tminutes, tseconds);
+
+		log_debug_info(DEBUGL_CHECKS, 1, "Check results for service '%s' on host '%s' are stale by %dd %dh %dm %ds (threshold=%dd %dh %dm %ds).  Forcing an immediate check of the service...\n", temp_service->description, temp_service->host_name, days, hours, minutes, seconds, tdays, thours, tminutes, tseconds);
+
+		return FALSE;
+	}
+
+	log_debug_info(DEBUGL_CHECKS, 1, "Check results for service '%s' on host '%s' are fresh.\n", temp_service->description, temp_service->host_name);
+
+	return TRUE;
+}
+
+
+
+/* calculates when the results of a service's last check expire */
+static time_t get_service_freshness_expiration(service *temp_service, int *threshold) {
+	int freshness_threshold = 0;
+	time_t expiration_time = 0L;
+
 	/* use user-supplied freshness threshold or auto-calculate a freshness threshold to use? */
 	if (temp_service->freshness_threshold == 0) {
 		if (temp_service->state_type == HARD_STATE || temp_service->current_state == STATE_OK)
@@ -2299,26 +2819,10 @@ int is_service_result_fresh(service *temp_service, time_t current_time, int log_
 	else
 		expiration_time = (time_t)(temp_service->last_check + freshness_threshold);
 
-	log_debug_info(DEBUGL_CHECKS, 2, "SERVICE: HBC (has_been_checked): %d, PS (program_start): %lu, ES (event_start): %lu, LC (last_check): %lu, CT (current_time): %lu, ET (expiration_time): %lu\n", temp_service->has_been_checked, (unsigned long)program_start, (unsigned long)event_start, (unsigned long)temp_service->last_check, (unsigned long)current_time, (unsigned long)expiration_time);
-
-	/* the results for the last check of this service are stale */
-	if (expiration_time < current_time) {
-
-		get_time_breakdown((current_time - expiration_time), &days, &hours, &minutes, &seconds);
-		get_time_breakdown(freshness_threshold, &tdays, &thours, &tminutes, &tseconds);
-
-		/* log a warning */
-		if (log_this == TRUE)
-			logit(NSLOG_RUNTIME_WARNING, TRUE, "警报: The results of service '%s' on host '%s' are stale by %dd %dh %dm %ds (threshold=%dd %dh %dm %ds).  I'm forcing an immediate check of the service.\n", temp_service->description, temp_service->host_name, days, hours, minutes, seconds, tdays, thours, tminutes, tseconds);
-
-		log_debug_info(DEBUGL_CHECKS, 1, "Check results for service '%s' on host '%s' are stale by %dd %dh %dm %ds (threshold=%dd %dh %dm %ds).  Forcing an immediate check of the service...\n", temp_service->description, temp_service->host_name, days, hours, minutes, seconds, tdays, thours, tminutes, tseconds);
-
-		return FALSE;
-	}
+	if (threshold != NULL)
+		*threshold = freshness_threshold;
 
-	log_debug_info(DEBUGL_CHECKS, 1, "Check results for service '%s' on host '%s' are fresh.\n", temp_service->description, temp_service->host_name);
-
-	return TRUE;
+	return expiration_time;
 }
 
 
@@ -2431,14 +2935,14 @@ void schedule_host_check(host *hst, time_t check_time, int options) {
 		log_debug_info(DEBUGL_CHECKS, 2, "Scheduling new host check event for '%s' @ %s", hst->name, ctime(&check_time));
 
 		/* allocate memory for a new event item */
-		if((new_event = (timed_event *)malloc(sizeof(timed_event))) == NULL) {
+		if((new_event = (timed_event *)calloc(1, sizeof(timed_event))) == NULL) {
 			logit(NSLOG_RUNTIME_WARNING, TRUE, "Warning: Could not reschedule check of host '%s'!\n", hst->name);
 			return;
 		}
 
 		if (temp_event) {
 			log_debug_info(DEBUGL_CHECKS, 2, "Removing host check event for host '%s' @ %s", hst->name, ctime(&temp_event->run_time));
-			remove_event(temp_event, &event_list_low, &event_list_low_tail);
+			remove_event(temp_event, &event_queue_low);
 			my_free(temp_event);
 		}
 
@@ -2459,7 +2963,7 @@ void schedule_host_check(host *hst, time_t check_time, int options) {
 		new_event->event_interval = 0L;
 		new_event->timing_func = NULL;
 		new_event->compensate_for_time_change = TRUE;
-		reschedule_event(new_event, &event_list_low, &event_list_low_tail);
+		reschedule_event(new_event, &event_queue_low);
 	}
 
 	else {
@@ -2536,6 +3040,7 @@ int check_host_dependencies(host *hst, int dependency_type) {
 /* check for hosts that never returned from a check... */
 void check_for_orphaned_hosts(void) {
 	host *temp_host = NULL;
+	check_deadline *deadline = NULL;
 	time_t current_time = 0L;
 	time_t expected_time = 0L;
 
@@ -2545,8 +3050,10 @@ void check_for_orphaned_hosts(void) {
 	/* get the current time */
 	time(&current_time);
 
-	/* check all hosts... */
-	for (temp_host = host_list; temp_host != NULL; temp_host = temp_host->next) {
+	/* check the hosts whose check should have returned by now... */
+	while ((deadline = get_due_check_deadline(&host_orphan_queue, current_time)) != NULL) {
+
+		temp_host = (host *)deadline->object;
 
 		/* skip hosts that don't have a set check interval (on-demand checks are missed by the orphan logic) */
 		if (temp_host->next_check == (time_t)0L)
@@ -2557,7 +3064,13 @@ void check_for_orphaned_hosts(void) {
 			continue;
 
 		/* determine the time at which the check results should have come in (allow 10 minutes slack time) */
-		expected_time = (time_t)(temp_host->next_check + temp_host->latency + host_check_timeout + check_reaper_interval + 600);
+		expected_time = get_host_orphan_time(temp_host);
+
+		/* the host was rescheduled while its check was running */
+		if (expected_time >= current_time) {
+			set_check_deadline(&host_orphan_queue, deadline, temp_host, expected_time + 1);
+			continue;
+		}
 
 		/* this host was supposed to have executed a while ago, but for some reason the results haven't come back in... */
 		if (expected_time < current_time) {
@@ -2588,7 +3101,9 @@ void check_for_orphaned_hosts(void) {
 /* check freshness of host results */
 void check_host_result_freshness(void) {
 	host *temp_host = NULL;
+	check_deadline *deadline = NULL;
 	time_t current_time = 0L;
+	time_t next_valid_time = 0L;
 
 
 	log_debug_info(DEBUGL_FUNCTIONS, 0, "check_host_result_freshness()\n");
@@ -2603,8 +3118,17 @@ void check_host_result_freshness(void) {
 	/* get the current time */
 	time(&current_time);
 
-	/* check all hosts... */
-	for (temp_host = host_list; temp_host != NULL; temp_host = temp_host->next) {
+	/* the first run looks at all hosts */
+	if (host_freshness_queue.built == FALSE) {
+		host_freshness_queue.built = TRUE;
+		for (temp_host = host_list; temp_host != NULL; temp_host = temp_host->next)
+			update_host_freshness_deadline(temp_host);
+	}
+
+	/* only look at the hosts whose results may have expired by now */
+	while ((deadline = get_due_check_deadline(&host_freshness_queue, current_time)) != NULL) {
+
+		temp_host = (host *)deadline->object;
 
 		/* skip hosts we shouldn't be checking for freshness */
 		if (temp_host->check_freshness == FALSE)
@@ -2623,8 +3147,14 @@ void check_host_result_freshness(void) {
 			continue;
 
 		/* see if the time is right... */
-		if (check_time_against_period(current_time, temp_host->check_period_ptr) == ERROR)
+		if (check_time_against_period(current_time, temp_host->check_period_ptr) == ERROR) {
+
+			/* look again when the check period starts */
+			next_valid_time = 0L;
+			get_next_valid_time(current_time, &next_valid_time, temp_host->check_period_ptr);
+			set_check_deadline(&host_freshness_queue, deadline, temp_host, (next_valid_time > current_time) ? next_valid_time : current_time + 1);
 			continue;
+		}
 
 		/* the results for the last check of this host are stale */
 		if (is_host_result_fresh(temp_host, current_time, TRUE) == FALSE) {
@@ -2635,6 +3165,10 @@ void check_host_result_freshness(void) {
 			/* schedule an immediate forced check of the host */
 			schedule_host_check(temp_host, current_time, CHECK_OPTION_FORCE_EXECUTION | CHECK_OPTION_FRESHNESS_CHECK);
 		}
+
+		/* look again when the results expire */
+		else
+			set_check_deadline(&host_freshness_queue, deadline, temp_host, get_host_freshness_expiration(temp_host, NULL) + 1);
 	}
 
 	return;
@@ -2657,6 +3191,36 @@ int is_host_result_fresh(host *temp_host, time_t current_time, int log_this) {
 
 	log_debug_info(DEBUGL_CHECKS, 2, "Checking freshness of host '%s'...\n", temp_host->name);
 
+	expiration_time = get_host_freshness_expiration(temp_host, &freshness_threshold);
+
+	log_debug_info(DEBUGL_CHECKS, 2, "主机: HBC (has_been_checked): %d, PS (program_start): %lu, ES (event_start): %lu, LC (last_check): %lu, CT (current_time): %lu, ET (expiration_time): %lu\n", temp_host->has_been_checked, (unsigned long)program_start, (unsigned long)event_start, (unsigned long)temp_host->last_check, (unsigned long)current_time, (unsigned long)expiration_time);
+
+	/* the results for the last check of this host are stale */
+	if (expiration_time < current_time) {
+
+		get_time_breakdown((current_time - expiration_time), &days, &hours, &minutes, &seconds);
+		get_time_breakdown(freshness_threshold, &tdays, &thours, &tminutes, &tseconds);
+
+		/* log a warning */
+		if (log_this == TRUE)
+			logit(NSLOG_RUNTIME_WARNING, TRUE, "警报: The results of host '%s' are stale by %dd %dh %dm %ds (threshold=%dd %dh %dm %ds).  I'm forcing an immediate check of the host.\n", temp_host->name, days, hours, minutes, seconds, tdays, thours, tminutes, tseconds);
+
+		log_debug_info(DEBUGL_CHECKS, 1, "Check results for host '%s' are stale by %dd %dh %dm %ds (threshold=%dd %dh %dm %ds).  Forcing an immediate check of the host...\n", temp_host->name, days, hours, minutes, seconds, tdays, thours, tminutes, tseconds);
+
+		return FALSE;
+	} else
+		log_debug_info(DEBUGL_CHECKS, 1, "Check results for host '%s' are fresh.\n", temp_host->name);
+
+	return TRUE;
+}
+
+
+
+/* calculates when the results of a host's last check expire */
+static time_t get_host_freshness_expiration(host *temp_host, int *threshold) {
+	time_t expiration_time = 0L;
+	int freshness_threshold = 0;
+
 	/* use user-supplied freshness threshold or auto-calculate a freshness threshold to use? */
 	if (temp_host->freshness_threshold == 0)
 		if (temp_host->state_type == HARD_STATE || temp_host->current_state == STATE_OK)
@@ -2694,25 +3258,10 @@ int is_host_result_fresh(host *temp_host, time_t current_time, int log_this) {
 	else
 		expiration_time = (time_t)(temp_host->last_check + freshness_threshold);
 
-	log_debug_info(DEBUGL_CHECKS, 2, "主机: HBC (has_been_checked): %d, PS (program_start): %lu, ES (event_start): %lu, LC (last_check): %lu, CT (current_time): %lu, ET (expiration_time): %lu\n", temp_host->has_been_checked, (unsigned long)program_start, (unsigned long)event_start, (unsigned long)temp_host->last_check, (unsigned long)current_time, (unsigned long)expiration_time);
-
-	/* the results for the last check of this host are stale */
-	if (expiration_time < current_time) {
-
-		get_time_breakdown((current_time - expiration_time), &days, &hours, &minutes, &seconds);
-		get_time_breakdown(freshness_threshold, &tdays, &thours, &tminutes, &tseconds);
-
-		/* log a warning */
-		if (log_this == TRUE)
-			logit(NSLOG_RUNTIME_WARNING, TRUE, "警报: The results of host '%s' are stale by %dd %dh %dm %ds (threshold=%dd %dh %dm %ds).  I'm forcing an immediate check of the host.\n", temp_host->name, days, hours, minutes, seconds, tdays, thours, tminutes, tseconds);
-
-		log_debug_info(DEBUGL_CHECKS, 1, "Check results for host '%s' are stale by %dd %dh %dm %ds (threshold=%dd %dh %dm %ds).  Forcing an immediate check of the host...\n", temp_host->name, days, hours, minutes, seconds, tdays, thours, tminutes, tseconds);
+	if (threshold != NULL)
+		*threshold = freshness_threshold;
 
-		return FALSE;
-	} else
-		log_debug_info(DEBUGL_CHECKS, 1, "Check results for host '%s' are fresh.\n", temp_host->name);
-
-	return TRUE;
+	return expiration_time;
 }
 
 
@@ -2847,6 +3396,7 @@ int run_sync_host_check_3x(host *hst, int *check_result_code, int check_options,
 
 	/* process the host check result */
 	process_host_check_result_3x(hst, host_result, old_plugin_output, check_options, FALSE, use_cached_result, check_timestamp_horizon);
+	update_host_freshness_deadline(hst);
 
 	/* free memory */
 	my_free(old_plugin_output);
@@ -2936,7 +3486,7 @@ int execute_sync_host_check_3x(host *hst) {
 	}
 
 	/* process any macros contained in the argument */
-	process_macros_r(&mac, raw_command, &processed_command, 0);
+	process_command_macros_r(&mac, hst->check_command_ptr, &processed_command, 0);
 	if (processed_command == NULL) {
 		my_free(raw_command);
 		clear_volatile_macros_r(&mac);
@@ -3134,6 +3684,7 @@ int run_async_host_check_3x(host *hst, int check_options, double latency, int sc
 	char *output_file = NULL;
 	double old_latency = 0.0;
 	dbuf checkresult_dbuf;
+	check_result *worker_check_result = NULL;
 	int dbuf_chunk = 1024;
 	FILE *fp;
 #ifdef USE_EVENT_BROKER
@@ -3207,7 +3758,7 @@ int run_async_host_check_3x(host *hst, int check_options, double latency, int sc
 	}
 
 	/* process any macros contained in the argument */
-	process_macros_r(&mac, raw_command, &processed_command, 0);
+	process_command_macros_r(&mac, hst->check_command_ptr, &processed_command, 0);
 
 	my_free(raw_command);
 
@@ -3228,6 +3779,49 @@ int run_async_host_check_3x(host *hst, int check_options, double latency, int sc
 
 	/* set the execution flag */
 	hst->is_executing = TRUE;
+	add_host_orphan_deadline(hst);
+
+	/* let a persistent check worker run the plugin, if we have any */
+	if (check_worker_can_run(processed_command) == TRUE && (worker_check_result = (check_result *)malloc(sizeof(check_result))) != NULL) {
+
+		init_check_result(worker_check_result);
+		worker_check_result->object_check_type = HOST_CHECK;
+		worker_check_result->host_name = (char *)strdup(hst->name);
+		worker_check_result->output_file = NULL;
+		worker_check_result->check_type = HOST_CHECK_ACTIVE;
+		worker_check_result->check_options = check_options;
+		worker_check_result->scheduled_check = scheduled_check;
+		worker_check_result->reschedule_check = reschedule_check;
+		worker_check_result->latency = latency;
+		worker_check_result->start_time = start_time;
+		worker_check_result->finish_time = start_time;
+
+		if (submit_check_to_worker(worker_check_result, &mac, processed_command, host_check_timeout) == OK) {
+
+			log_debug_info(DEBUGL_CHECKS, 2, "Host check was handed to a check worker\n");
+
+#ifdef USE_EVENT_BROKER
+			/* send data to event broker, the fork() path below sends it if the worker didn't take the check */
+			broker_host_check(NEBTYPE_HOSTCHECK_INITIATE, NEBFLAG_NONE, NEBATTR_NONE, hst, HOST_CHECK_ACTIVE, hst->current_state, hst->state_type, start_time, end_time, hst->host_check_command, hst->latency, 0.0, host_check_timeout, FALSE, 0, processed_command, NULL, NULL, NULL, NULL);
+#endif
+
+			/* reset latency (permanent value for this check will get set later) */
+			hst->latency = old_latency;
+
+			/* update check statistics */
+			update_check_stats((scheduled_check == TRUE) ? ACTIVE_SCHEDULED_HOST_CHECK_STATS : ACTIVE_ONDEMAND_HOST_CHECK_STATS, start_time.tv_sec);
+			update_check_stats(PARALLEL_HOST_CHECK_STATS, start_time.tv_sec);
+
+			clear_volatile_macros_r(&mac);
+			my_free(processed_command);
+
+			return OK;
+		}
+
+		/* fall back to forking the check ourselves */
+		free_check_result(worker_check_result);
+		my_free(worker_check_result);
+	}
 
 	/* open a temp file for storing check output */
 	old_umask = umask(new_umask);
@@ -3396,8 +3990,8 @@ int run_async_host_check_3x(host *hst, int check_options, double latency, int sc
 				/* close the temp file */
 				fclose(fp);
 
-				/* move check result to queue directory */
-				move_check_result_to_queue(check_result_info.output_file);
+				/* pass check result on to the core */
+				submit_check_result(&check_result_info, checkresult_dbuf.buf);
 			}
 
 			/* free memory */
@@ -3564,7 +4158,7 @@ int handle_async_host_check_result_3x(host *temp_host, check_result *queued_chec
 	my_free(temp_host->perf_data);
 
 	/* parse check output to get: (1) short output, (2) long output, (3) perf data */
-	parse_check_output(queued_check_result->output, &temp_host->plugin_output, &temp_host->long_plugin_output, &temp_host->perf_data, TRUE, TRUE);
+	get_parsed_check_output(queued_check_result, &temp_host->plugin_output, &temp_host->long_plugin_output, &temp_host->perf_data);
 
 	/* make sure we have some data */
 	if (temp_host->plugin_output == NULL || !strcmp(temp_host->plugin_output, "")) {
@@ -4431,13 +5025,14 @@ int handle_host_state(host *hst) {
 /* parse raw plugin output and return: short and long output, perf data */
 int parse_check_output(char *buf, char **short_output, char **long_output, char **perf_data, int escape_newlines_please, int newlines_are_escaped) {
 	int current_line = 0;
-	int found_newline = FALSE;
 	int eof = FALSE;
-	int used_buf = 0;
 	int dbuf_chunk = 1024;
 	dbuf db1;
 	dbuf db2;
 	char *ptr = NULL;
+	char *line = NULL;
+	char *next_line = NULL;
+	char *saveptr = NULL;
 	int in_perf_data = FALSE;
 	char *tempbuf = NULL;
 	register int x = 0;
@@ -4455,8 +5050,6 @@ int parse_check_output(char *buf, char **short_output, char **long_output, char
 	if (buf == NULL || !strcmp(buf, ""))
 		return OK;
 
-	used_buf = strlen(buf) + 1;
-
 	/* initialize dynamic buffers (1KB chunk size) */
 	dbuf_init(&db1, dbuf_chunk);
 	dbuf_init(&db2, dbuf_chunk);
@@ -4476,97 +5069,69 @@ int parse_check_output(char *buf, char **short_output, char **long_output, char
 		buf[y] = '\x0';
 	}
 
-	/* process each line of input */
-	for (x = 0; eof == FALSE; x++) {
-
-		/* we found the end of a line */
-		if (buf[x] == '\n')
-			found_newline = TRUE;
-		else if (buf[x] == '\\' && buf[x+1] == 'n' && newlines_are_escaped == TRUE) {
-			found_newline = TRUE;
-			buf[x] = '\x0';
-			x++;
-		} else if (buf[x] == '\x0') {
-			found_newline = TRUE;
-			eof = TRUE;
-		} else
-			found_newline = FALSE;
-
-		if (found_newline == TRUE) {
-
-			current_line++;
+	/* process each line of input (lines are terminated in place, so this is safe to run in the reaper threads) */
+	for (line = buf; eof == FALSE; line = next_line) {
 
-			/* handle this line of input */
-			buf[x] = '\x0';
-			if ((tempbuf = (char *)strdup(buf))) {
-
-				/* first line contains short plugin output and optional perf data */
-				if (current_line == 1) {
-
-					/* get the short plugin output */
-					if ((ptr = strtok(tempbuf, "|"))) {
-						if (short_output)
-							*short_output = (char *)strdup(ptr);
-
-						/* get the optional perf data */
-						if ((ptr = strtok(NULL, "\n")))
-							dbuf_strcat(&db2, ptr);
-					}
-				}
-
-				/* additional lines contain long plugin output and optional perf data */
-				else {
+		/* find the end of the line */
+		for (x = 0; line[x] != '\n' && line[x] != '\x0'; x++) {
+			if (line[x] == '\\' && line[x+1] == 'n' && newlines_are_escaped == TRUE)
+				break;
+		}
 
-					/* rest of the output is perf data */
-					if (in_perf_data == TRUE) {
-						dbuf_strcat(&db2, tempbuf);
-						dbuf_strcat(&db2, " ");
-					}
+		if (line[x] == '\x0')
+			eof = TRUE;
+		else if (line[x] == '\n')
+			next_line = &line[x+1];
+		else
+			next_line = &line[x+2];
+		line[x] = '\x0';
 
-					/* we're still in long output */
-					else {
+		current_line++;
 
-						/* perf data separator has been found */
-						if (strstr(tempbuf, "|")) {
+		/* first line contains short plugin output and optional perf data */
+		if (current_line == 1) {
 
-							/* NOTE: strtok() causes problems if first character of tempbuf='|', so use my_strtok() instead */
-							/* get the remaining long plugin output */
-							if ((ptr = my_strtok(tempbuf, "|"))) {
+			/* get the short plugin output */
+			if ((ptr = strtok_r(line, "|", &saveptr))) {
+				if (short_output)
+					*short_output = (char *)strdup(ptr);
 
-								if (current_line > 2)
-									dbuf_strcat(&db1, "\n");
-								dbuf_strcat(&db1, ptr);
+				/* get the optional perf data */
+				if ((ptr = strtok_r(NULL, "\n", &saveptr)))
+					dbuf_strcat(&db2, ptr);
+			}
+		}
 
-								/* get the perf data */
-								if ((ptr = my_strtok(NULL, "\n"))) {
-									dbuf_strcat(&db2, ptr);
-									dbuf_strcat(&db2, " ");
-								}
-							}
+		/* rest of the output is perf data */
+		else if (in_perf_data == TRUE) {
+			dbuf_strcat(&db2, line);
+			dbuf_strcat(&db2, " ");
+		}
 
-							/* set the perf data flag */
-							in_perf_data = TRUE;
-						}
+		/* perf data separator has been found in the long output */
+		else if ((ptr = strchr(line, '|'))) {
 
-						/* just long output */
-						else {
-							if (current_line > 2)
-								dbuf_strcat(&db1, "\n");
-							dbuf_strcat(&db1, tempbuf);
-						}
-					}
-				}
+			/* get the remaining long plugin output */
+			*ptr = '\x0';
+			if (current_line > 2)
+				dbuf_strcat(&db1, "\n");
+			dbuf_strcat(&db1, line);
 
-				my_free(tempbuf);
-				tempbuf = NULL;
+			/* get the perf data */
+			if (ptr[1] != '\x0') {
+				dbuf_strcat(&db2, ptr + 1);
+				dbuf_strcat(&db2, " ");
 			}
 
+			/* set the perf data flag */
+			in_perf_data = TRUE;
+		}
 
-			/* shift data back to front of buffer and adjust counters */
-			memmove((void *)&buf[0], (void *)&buf[x+1], (size_t)((int)used_buf - x - 1));
-			used_buf -= (x + 1);
-			buf[used_buf] = '\x0';
-			x = -1;
+		/* just long output */
+		else {
+			if (current_line > 2)
+				dbuf_strcat(&db1, "\n");
+			dbuf_strcat(&db1, line);
 		}
 	}
 
@@ -0,0 +1,444 @@
+/*****************************************************************************
+ *
+ * CMDBUFFER.C - External command buffer and command file worker thread
+ *
+ * Copyright (c) 2009-2013 Icinga Development Team (http://www.icinga.org)
+ *
+ * License:
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *****************************************************************************/
+
+/*
+ * The command file worker thread read()s the command file (named pipe)
+ * in large chunks, splits the chunks into commands in place and copies
+ * the commands into the slots of external_command_buffer. The main
+ * thread takes them out again in check_for_external_commands().
+ *
+ * The buffer is a ring with one consumer (the main thread) and, usually,
+ * one producer (the worker thread). The consumer never locks: head and
+ * tail are only ever moved by their owner and are published with atomic
+ * stores. Producers serialize on buffer_lock, which the worker thread
+ * takes once per chunk and which is only contended when event broker
+ * modules call submit_external_command() themselves.
+ *
+ * Slots keep their memory, so in steady state no command is malloc()ed.
+ * When the ring is full the worker thread waits for the main thread to
+ * signal space_cond instead of sleeping for a fixed time.
+ */
+
+#include "../include/config.h"
+#include "../include/common.h"
+#include "../include/objects.h"
+#include "../include/icinga.h"
+
+#include <poll.h>
+
+extern int      dummy;
+
+extern int      sigrestart;
+
+extern unsigned long logging_options;
+
+extern int      command_file_fd;
+
+extern pthread_t       worker_threads[TOTAL_WORKER_THREADS];
+
+extern circular_buffer external_command_buffer;
+extern int             external_command_buffer_slots;
+
+
+/******************************************************************/
+/************************ BUFFER FUNCTIONS ************************/
+/******************************************************************/
+
+/* copies a command into the next free slot and hands it to the consumer - caller must hold buffer_lock */
+static int push_external_command(char *cmd, int len) {
+	unsigned long head = external_command_buffer.head;
+	unsigned long tail = __atomic_load_n(&external_command_buffer.tail, __ATOMIC_SEQ_CST);
+	char *new_slot = NULL;
+	int slot = 0;
+	int new_size = 0;
+
+	/* buffer is full */
+	if (head - tail >= (unsigned long)external_command_buffer_slots)
+		return ERROR;
+
+	slot = (int)(head % (unsigned long)external_command_buffer_slots);
+
+	/* grow the slot if the command doesn't fit */
+	if (external_command_buffer.slot_size[slot] < len + 1) {
+		new_size = ((len + 1) + 255) & ~255;
+		if ((new_slot = (char *)realloc(external_command_buffer.buffer[slot], (size_t)new_size)) == NULL) {
+			external_command_buffer.overflow++;
+			return OK;
+		}
+		external_command_buffer.buffer[slot] = new_slot;
+		external_command_buffer.slot_size[slot] = new_size;
+	}
+
+	memcpy(external_command_buffer.buffer[slot], cmd, (size_t)len);
+	external_command_buffer.buffer[slot][len] = '\x0';
+
+	/* publish the command */
+	__atomic_store_n(&external_command_buffer.head, head + 1, __ATOMIC_RELEASE);
+
+	if ((int)(head + 1 - tail) > external_command_buffer.high)
+		external_command_buffer.high = (int)(head + 1 - tail);
+
+	return OK;
+}
+
+
+/* waits until the consumer has made room in a full buffer */
+static void wait_for_external_command_slot(void) {
+	struct timespec deadline;
+	unsigned long tail = 0L;
+	int oldstate = 0;
+
+	pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &oldstate);
+
+	pthread_mutex_lock(&external_command_buffer.space_lock);
+	__atomic_store_n(&external_command_buffer.producer_waiting, TRUE, __ATOMIC_SEQ_CST);
+
+	/* the consumer may have made room before it could see our flag */
+	tail = __atomic_load_n(&external_command_buffer.tail, __ATOMIC_SEQ_CST);
+	if (external_command_buffer.head - tail >= (unsigned long)external_command_buffer_slots) {
+
+		/* the timeout only makes sure we notice being cancelled */
+		clock_gettime(CLOCK_REALTIME, &deadline);
+		deadline.tv_sec++;
+		pthread_cond_timedwait(&external_command_buffer.space_cond, &external_command_buffer.space_lock, &deadline);
+	}
+
+	__atomic_store_n(&external_command_buffer.producer_waiting, FALSE, __ATOMIC_SEQ_CST);
+	pthread_mutex_unlock(&external_command_buffer.space_lock);
+
+	pthread_setcancelstate(oldstate, NULL);
+
+	/* should we shutdown? */
+	pthread_testcancel();
+
+	return;
+}
+
+
+/* returns the oldest command in the buffer, it stays valid until release_external_command() is called - main thread only */
+char *get_external_command(void) {
+
+	if (external_command_buffer.buffer == NULL)
+		return NULL;
+
+	if (external_command_buffer.tail == __atomic_load_n(&external_command_buffer.head, __ATOMIC_ACQUIRE))
+		return NULL;
+
+	return external_command_buffer.buffer[external_command_buffer.tail % (unsigned long)external_command_buffer_slots];
+}
+
+
+/* hands the slot of the command returned by get_external_command() back to the producers - main thread only */
+void release_external_command(void) {
+
+	__atomic_store_n(&external_command_buffer.tail, external_command_buffer.tail + 1, __ATOMIC_SEQ_CST);
+
+	/* wake up the worker thread if it is waiting for room */
+	if (__atomic_load_n(&external_command_buffer.producer_waiting, __ATOMIC_SEQ_CST) == TRUE) {
+		pthread_mutex_lock(&external_command_buffer.space_lock);
+		pthread_cond_signal(&external_command_buffer.space_cond);
+		pthread_mutex_unlock(&external_command_buffer.space_lock);
+	}
+
+	return;
+}
+
+
+/* returns the number of commands in the buffer */
+int get_external_command_buffer_items(void) {
+	unsigned long tail = __atomic_load_n(&external_command_buffer.tail, __ATOMIC_ACQUIRE);
+
+	return (int)(__atomic_load_n(&external_command_buffer.head, __ATOMIC_ACQUIRE) - tail);
+}
+
+
+
+/******************************************************************/
+/********************* WORKER THREAD FUNCTIONS ********************/
+/******************************************************************/
+
+/* initializes command file worker thread */
+int init_command_file_worker_thread(void) {
+	int result = 0;
+	sigset_t newmask;
+
+	/* initialize circular buffer */
+	external_command_buffer.head = 0L;
+	external_command_buffer.tail = 0L;
+	external_command_buffer.high = 0;
+	external_command_buffer.overflow = 0L;
+	external_command_buffer.producer_waiting = FALSE;
+	external_command_buffer.buffer = (char **)calloc(external_command_buffer_slots, sizeof(char *));
+	external_command_buffer.slot_size = (int *)calloc(external_command_buffer_slots, sizeof(int));
+	if (external_command_buffer.buffer == NULL || external_command_buffer.slot_size == NULL) {
+		my_free(external_command_buffer.buffer);
+		my_free(external_command_buffer.slot_size);
+		return ERROR;
+	}
+
+	/* initialize mutexes (only on cold startup) */
+	if (sigrestart == FALSE) {
+		pthread_mutex_init(&external_command_buffer.buffer_lock, NULL);
+		pthread_mutex_init(&external_command_buffer.space_lock, NULL);
+		pthread_cond_init(&external_command_buffer.space_cond, NULL);
+	}
+
+	/* new thread should block all signals */
+	sigfillset(&newmask);
+	pthread_sigmask(SIG_BLOCK, &newmask, NULL);
+
+	/* create worker thread */
+	result = pthread_create(&worker_threads[COMMAND_WORKER_THREAD], NULL, command_file_worker_thread, NULL);
+
+	/* main thread should unblock all signals */
+	pthread_sigmask(SIG_UNBLOCK, &newmask, NULL);
+
+	if (result)
+		return ERROR;
+
+	return OK;
+}
+
+
+/* shutdown command file worker thread */
+int shutdown_command_file_worker_thread(void) {
+	int result = 0;
+
+	/* 2010-01-04 AE:
+	 * calling pthread_cancel(0) will cause segfaults with some
+	 * thread libraries. It's possible that will happen if the
+	 * user has a number of config files larger than the max
+	 * open file descriptor limit (ulimit -n) and some retarded
+	 * eventbroker module leaks filedescriptors, since we'll then
+	 * enter the cleanup() routine from main() before we've
+	 * spawned any threads.
+	 */
+	if (worker_threads[COMMAND_WORKER_THREAD]) {
+		/* tell the worker thread to exit */
+		result = pthread_cancel(worker_threads[COMMAND_WORKER_THREAD]);
+
+		/* wait for the worker thread to exit */
+		if (result == 0) {
+			result = pthread_join(worker_threads[COMMAND_WORKER_THREAD], NULL);
+		}
+
+		/* we're being called from a fork()'ed child process - can't cancel thread, so just cleanup memory */
+		else {
+			cleanup_command_file_worker_thread(NULL);
+		}
+	}
+
+	return OK;
+}
+
+
+/* clean up resources used by command file worker thread */
+void cleanup_command_file_worker_thread(void *arg) {
+	register int x = 0;
+
+	/* release memory allocated to circular buffer */
+	if (external_command_buffer.buffer != NULL) {
+		for (x = 0; x < external_command_buffer_slots; x++)
+			my_free(external_command_buffer.buffer[x]);
+	}
+	my_free(external_command_buffer.buffer);
+	my_free(external_command_buffer.slot_size);
+
+	return;
+}
+
+
+
+/* worker thread - artificially increases buffer of named pipe */
+void * command_file_worker_thread(void *arg) {
+	char input_buffer[EXTERNAL_COMMAND_READ_BUFFER_SIZE];
+	struct pollfd pfd;
+	int pollval;
+	ssize_t bytes_read = 0;
+	int used = 0;
+	char *line = NULL;
+	char *eol = NULL;
+
+	/* specify cleanup routine */
+	pthread_cleanup_push(cleanup_command_file_worker_thread, NULL);
+
+	/* set cancellation info */
+	pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
+	pthread_setcanceltype(PTHREAD_CANCEL_DEFERRED, NULL);
+
+	while (1) {
+
+		/* should we shutdown? */
+		pthread_testcancel();
+
+		/* wait for data to arrive */
+		/* select seems to not work, so we have to use poll instead */
+		pfd.fd = command_file_fd;
+		pfd.events = POLLIN;
+		pollval = poll(&pfd, 1, 500);
+
+		/* loop if no data */
+		if (pollval == 0)
+			continue;
+
+		/* check for errors */
+		if (pollval == -1) {
+
+			switch (errno) {
+			case EBADF:
+				write_to_log("command_file_worker_thread(): poll(): EBADF", logging_options, NULL);
+				break;
+			case ENOMEM:
+				write_to_log("command_file_worker_thread(): poll(): ENOMEM", logging_options, NULL);
+				break;
+			case EFAULT:
+				write_to_log("command_file_worker_thread(): poll(): EFAULT", logging_options, NULL);
+				break;
+			case EINTR:
+				/* this can happen when running under a debugger like gdb */
+				/*
+				write_to_log("command_file_worker_thread(): poll(): EINTR (impossible)",logging_options,NULL);
+				*/
+				break;
+			default:
+				write_to_log("command_file_worker_thread(): poll(): Unknown errno value.", logging_options, NULL);
+				break;
+			}
+
+			continue;
+		}
+
+		/* should we shutdown? */
+		pthread_testcancel();
+
+		/* read everything that is in the pipe, as much as fits into the buffer at once (the pipe is non-blocking) */
+		while ((bytes_read = read(command_file_fd, input_buffer + used, sizeof(input_buffer) - used - 1)) > 0) {
+
+			used += (int)bytes_read;
+			input_buffer[used] = '\x0';
+
+#ifdef DEBUG_CFWT
+			printf("(CFWT) READ: %d bytes\n", (int)bytes_read);
+#endif
+
+			/* split the complete commands in place and buffer them all under one lock */
+			pthread_mutex_lock(&external_command_buffer.buffer_lock);
+
+			for (line = input_buffer; (eol = (char *)memchr(line, '\n', (size_t)(used - (line - input_buffer)))) != NULL; line = eol + 1) {
+
+				/* skip empty lines */
+				if (eol == line)
+					continue;
+
+				/* wait for the main thread to make room if the buffer is full */
+				while (push_external_command(line, (int)(eol - line)) == ERROR) {
+					pthread_mutex_unlock(&external_command_buffer.buffer_lock);
+					wait_for_external_command_slot();
+					pthread_mutex_lock(&external_command_buffer.buffer_lock);
+				}
+			}
+
+			/* a command that fills the whole buffer is cut, just like fgets() used to do */
+			used -= (int)(line - input_buffer);
+			if (used == (int)sizeof(input_buffer) - 1) {
+				while (push_external_command(line, used) == ERROR) {
+					pthread_mutex_unlock(&external_command_buffer.buffer_lock);
+					wait_for_external_command_slot();
+					pthread_mutex_lock(&external_command_buffer.buffer_lock);
+				}
+				used = 0;
+			}
+
+			pthread_mutex_unlock(&external_command_buffer.buffer_lock);
+
+			/* keep the start of an incomplete command for the next read() */
+			if (used > 0 && line != input_buffer)
+				memmove(input_buffer, line, (size_t)used);
+
+			/* should we shutdown? */
+			pthread_testcancel();
+		}
+	}
+
+	/* removes cleanup handler - this should never be reached */
+	pthread_cleanup_pop(0);
+
+	return NULL;
+}
+
+
+
+/* submits an external command for processing */
+int submit_external_command(char *cmd, int *buffer_items) {
+	int result = OK;
+
+	if (cmd == NULL || external_command_buffer.buffer == NULL) {
+		if (buffer_items != NULL)
+			*buffer_items = -1;
+		return ERROR;
+	}
+
+	/* obtain a lock for writing to the buffer */
+	pthread_mutex_lock(&external_command_buffer.buffer_lock);
+
+	/* save the line in the buffer (fails if the buffer is full) */
+	result = push_external_command(cmd, (int)strlen(cmd));
+
+	/* release lock on buffer */
+	pthread_mutex_unlock(&external_command_buffer.buffer_lock);
+
+	/* return number of items now in buffer */
+	if (buffer_items != NULL)
+		*buffer_items = get_external_command_buffer_items();
+
+	return result;
+}
+
+
+
+/* submits a raw external command (without timestamp) for processing */
+int submit_raw_external_command(char *cmd, time_t *ts, int *buffer_items) {
+	char *newcmd = NULL;
+	int result = OK;
+	time_t timestamp;
+
+	if (cmd == NULL)
+		return ERROR;
+
+	/* get the time */
+	if (ts != NULL)
+		timestamp = *ts;
+	else
+		time(&timestamp);
+
+	/* create the command string */
+	dummy = asprintf(&newcmd, "[%lu] %s", (unsigned long)timestamp, cmd);
+
+	/* submit the command */
+	result = submit_external_command(newcmd, buffer_items);
+
+	/* free allocated memory */
+	my_free(newcmd);
+
+	return result;
+}
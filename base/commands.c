@@ -79,12 +79,13 @@ extern command  *global_service_event_handler_ptr;
 extern host     *host_list;
 extern service  *service_list;
 
-extern FILE     *command_file_fp;
 extern int      command_file_fd;
 
 passive_check_result    *passive_check_result_list = NULL;
 passive_check_result    *passive_check_result_list_tail = NULL;
 
+extern unsigned long   check_result_channel_stats[CHECK_RESULT_CHANNELS];
+
 extern pthread_t       worker_threads[TOTAL_WORKER_THREADS];
 extern circular_buffer external_command_buffer;
 extern int             external_command_buffer_slots;
@@ -125,36 +126,14 @@ int check_for_external_commands(void) {
 	passive_check_result_list = NULL;
 	passive_check_result_list_tail = NULL;
 
-	/* process all commands found in the buffer */
-	while (1) {
-
-		/* get a lock on the buffer */
-		pthread_mutex_lock(&external_command_buffer.buffer_lock);
-
-		/* if no items present, bail out */
-		if (external_command_buffer.items <= 0) {
-			pthread_mutex_unlock(&external_command_buffer.buffer_lock);
-			break;
-		}
-
-		if (external_command_buffer.buffer[external_command_buffer.tail])
-			buffer = strdup(((char **)external_command_buffer.buffer)[external_command_buffer.tail]);
-
-		/* free memory allocated for buffer slot */
-		my_free(((char **)external_command_buffer.buffer)[external_command_buffer.tail]);
-
-		/* adjust tail counter and number of items */
-		external_command_buffer.tail = (external_command_buffer.tail + 1) % external_command_buffer_slots;
-		external_command_buffer.items--;
-
-		/* release the lock on the buffer */
-		pthread_mutex_unlock(&external_command_buffer.buffer_lock);
+	/* process all commands found in the buffer - the command is processed right in its slot, which is handed back afterwards */
+	while ((buffer = get_external_command()) != NULL) {
 
 		/* process the command */
 		process_external_command1(buffer);
 
-		/* free memory */
-		my_free(buffer);
+		/* let the worker thread reuse the slot */
+		release_external_command();
 	}
 
 	/**** PROCESS ALL PASSIVE HOST AND SERVICE CHECK RESULTS AT ONE TIME ****/
@@ -211,6 +190,237 @@ int process_external_commands_from_file(char *fname, int delete_file) {
 
 
 
+/* finds the host a passive check result was submitted for, by its name or address */
+static host *find_passive_check_host(char *host_name) {
+	host *temp_host = NULL;
+
+	if ((temp_host = find_host(host_name)) != NULL)
+		return temp_host;
+
+	for (temp_host = host_list; temp_host != NULL; temp_host = temp_host->next) {
+		if (!strcmp(host_name, temp_host->address))
+			return temp_host;
+		else if (!strcmp(host_name, temp_host->address6))
+			return temp_host;
+	}
+
+	return NULL;
+}
+
+
+
+/* moves a batch of passive check results from a file onto the check result list */
+static void flush_check_result_file_batch(check_result **batch, int *batch_count) {
+
+	if (*batch_count == 0)
+		return;
+
+	add_check_results_to_list(batch, *batch_count);
+	check_result_channel_stats[CHECK_RESULT_CHANNEL_EXTCMD] += *batch_count;
+	*batch_count = 0;
+
+	return;
+}
+
+
+
+/* processes many passive check results in a (regular) file in one go
+
+   lines have the same format as in the command file:
+
+	[<timestamp>] PROCESS_SERVICE_CHECK_RESULT;<host_name>;<svc_description>;<return_code>;<plugin_output>
+	[<timestamp>] PROCESS_HOST_CHECK_RESULT;<host_name>;<return_code>;<plugin_output>
+
+   hosts are only looked up again when the host name changes, so results should be grouped by host.
+   the results are added to the check result list in batches instead of one by one, other commands
+   found in the file are processed in order like with PROCESS_FILE */
+int process_passive_check_result_file(char *fname, int delete_file) {
+	mmapfile *thefile = NULL;
+	char *input = NULL;
+	char *temp_ptr = NULL;
+	char *command_name = NULL;
+	char *host_name = NULL;
+	char *svc_description = NULL;
+	char *output = NULL;
+	char *cached_host_name = NULL;
+	char *temp_buffer = NULL;
+	host *cached_host = NULL;
+	service *temp_service = NULL;
+	check_result *new_cr = NULL;
+	check_result **batch = NULL;
+	check_result **new_batch = NULL;
+	int batch_count = 0;
+	int batch_size = 0;
+	int object_check_type = SERVICE_CHECK;
+	int return_code = 0;
+	int total_results = 0;
+	time_t check_time = 0L;
+	struct timeval tv;
+	double latency = 0.0;
+
+	log_debug_info(DEBUGL_FUNCTIONS, 0, "process_passive_check_result_file()\n");
+
+	if (fname == NULL)
+		return ERROR;
+
+	log_debug_info(DEBUGL_EXTERNALCOMMANDS, 1, "Processing check results from file '%s'.  File will %s deleted after processing.\n", fname, (delete_file == TRUE) ? "be" : "NOT be");
+
+	if ((thefile = mmap_fopen(fname)) == NULL) {
+		logit(NSLOG_INFO_MESSAGE, FALSE, "错误: 无法打开文件 '%s' 处理检测结果!", fname);
+		return ERROR;
+	}
+
+	/* all results in the file arrived at the same time */
+	gettimeofday(&tv, NULL);
+
+	while (1) {
+
+		my_free(input);
+
+		if ((input = mmap_fgets(thefile)) == NULL)
+			break;
+
+		strip(input);
+		if (input[0] == '\x0' || input[0] == '#')
+			continue;
+
+		/* get the entry time and the command name */
+		if (input[0] != '[' || (temp_ptr = strchr(input, ']')) == NULL) {
+			logit(NSLOG_EXTERNAL_COMMAND | NSLOG_RUNTIME_WARNING, TRUE, "警报: 检测结果文件 '%s' 中的无效条目 -> %s\n", fname, input);
+			continue;
+		}
+		check_time = (time_t)strtoul(input + 1, NULL, 10);
+		for (command_name = temp_ptr + 1; *command_name == ' '; command_name++);
+
+		if (!strncmp(command_name, "PROCESS_SERVICE_CHECK_RESULT;", 29)) {
+			object_check_type = SERVICE_CHECK;
+			host_name = command_name + 29;
+		} else if (!strncmp(command_name, "PROCESS_HOST_CHECK_RESULT;", 26)) {
+			object_check_type = HOST_CHECK;
+			host_name = command_name + 26;
+		} else {
+			/* anything else is handled like a normal command, after the results that came before it */
+			flush_check_result_file_batch(batch, &batch_count);
+			process_external_command1(input);
+			continue;
+		}
+
+		update_check_stats(EXTERNAL_COMMAND_STATS, time(NULL));
+
+		if (log_passive_checks == TRUE) {
+			dummy = asprintf(&temp_buffer, "额外命令: %s\n", command_name);
+			write_to_all_logs(temp_buffer, NSLOG_PASSIVE_CHECK);
+			my_free(temp_buffer);
+		}
+
+		/* split the arguments in place */
+		svc_description = NULL;
+		if ((temp_ptr = strchr(host_name, ';')) == NULL)
+			continue;
+		*temp_ptr++ = '\x0';
+		if (object_check_type == SERVICE_CHECK) {
+			svc_description = temp_ptr;
+			if ((temp_ptr = strchr(svc_description, ';')) == NULL)
+				continue;
+			*temp_ptr++ = '\x0';
+		}
+		return_code = atoi(temp_ptr);
+		if ((output = strchr(temp_ptr, ';')) == NULL)
+			output = "";
+		else
+			output++;
+
+		if (object_check_type == SERVICE_CHECK && accept_passive_service_checks == FALSE)
+			continue;
+		if (object_check_type == HOST_CHECK && (accept_passive_host_checks == FALSE || return_code < 0 || return_code > 2))
+			continue;
+
+		/* only look the host up when it differs from the one on the previous line */
+		if (cached_host_name == NULL || strcmp(cached_host_name, host_name)) {
+			my_free(cached_host_name);
+			cached_host_name = (char *)strdup(host_name);
+			cached_host = find_passive_check_host(host_name);
+		}
+
+		if (cached_host == NULL) {
+			if (object_check_type == SERVICE_CHECK)
+				logit(NSLOG_RUNTIME_WARNING, TRUE, "警报:  Passive check result was received for service '%s' on host '%s', but the host could not be found!\n", svc_description, host_name);
+			else
+				logit(NSLOG_RUNTIME_WARNING, TRUE, "警报:  Passive check result was received for host '%s', but the host could not be found!\n", host_name);
+			continue;
+		}
+
+		if (object_check_type == SERVICE_CHECK) {
+			if ((temp_service = find_service(cached_host->name, svc_description)) == NULL) {
+				logit(NSLOG_RUNTIME_WARNING, TRUE, "警报:  Passive check result was received for service '%s' on host '%s', but the service could not be found!\n", svc_description, host_name);
+				continue;
+			}
+			if (temp_service->accept_passive_service_checks == FALSE)
+				continue;
+		} else if (cached_host->accept_passive_host_checks == FALSE)
+			continue;
+
+		/* make room in the batch */
+		if (batch_count == batch_size) {
+			if ((new_batch = (check_result **)realloc(batch, (batch_size + CHECK_RESULT_FILE_BATCH_SIZE) * sizeof(check_result *))) == NULL) {
+				flush_check_result_file_batch(batch, &batch_count);
+				if (batch_size == 0)
+					break;
+			} else {
+				batch = new_batch;
+				batch_size += CHECK_RESULT_FILE_BATCH_SIZE;
+			}
+		}
+
+		if ((new_cr = (check_result *)malloc(sizeof(check_result))) == NULL)
+			continue;
+
+		init_check_result(new_cr);
+		new_cr->object_check_type = object_check_type;
+		new_cr->check_type = (object_check_type == HOST_CHECK) ? HOST_CHECK_PASSIVE : SERVICE_CHECK_PASSIVE;
+		new_cr->output_file = NULL;
+		new_cr->start_time.tv_sec = check_time;
+		new_cr->finish_time.tv_sec = check_time;
+		new_cr->return_code = (return_code < 0 || return_code > 3) ? STATE_UNKNOWN : return_code;
+
+		latency = (double)((double)(tv.tv_sec - check_time) + (double)(tv.tv_usec / 1000.0) / 1000.0);
+		new_cr->latency = (latency < 0.0) ? 0.0 : latency;
+
+		new_cr->host_name = (char *)strdup(cached_host->name);
+		if (object_check_type == SERVICE_CHECK)
+			new_cr->service_description = (char *)strdup(temp_service->description);
+		new_cr->output = (char *)strdup(output);
+
+		if (new_cr->host_name == NULL || new_cr->output == NULL || (object_check_type == SERVICE_CHECK && new_cr->service_description == NULL)) {
+			free_check_result(new_cr);
+			my_free(new_cr);
+			continue;
+		}
+
+		batch[batch_count++] = new_cr;
+		total_results++;
+
+		if (batch_count == CHECK_RESULT_FILE_BATCH_SIZE)
+			flush_check_result_file_batch(batch, &batch_count);
+	}
+
+	flush_check_result_file_batch(batch, &batch_count);
+
+	log_debug_info(DEBUGL_EXTERNALCOMMANDS, 1, "Queued %d passive check results from file '%s'.\n", total_results, fname);
+
+	my_free(batch);
+	my_free(cached_host_name);
+
+	mmap_fclose(thefile);
+
+	if (delete_file == TRUE)
+		unlink(fname);
+
+	return OK;
+}
+
+
+
 /* top-level external command processor */
 int process_external_command1(char *cmd) {
 	char *temp_buffer = NULL;
@@ -254,475 +464,18 @@ int process_external_command1(char *cmd) {
 		return ERROR;
 	}
 
-	/* decide what type of command this is... */
-
-	/**************************/
-	/**** PROCESS COMMANDS ****/
-	/**************************/
-
-	if (!strcmp(command_id, "ENTER_STANDBY_MODE") || !strcmp(command_id, "DISABLE_NOTIFICATIONS"))
-		command_type = CMD_DISABLE_NOTIFICATIONS;
-	else if (!strcmp(command_id, "ENTER_ACTIVE_MODE") || !strcmp(command_id, "ENABLE_NOTIFICATIONS"))
-		command_type = CMD_ENABLE_NOTIFICATIONS;
-	else if (!strcmp(command_id, "DISABLE_NOTIFICATIONS_EXPIRE_TIME"))
-		command_type = CMD_DISABLE_NOTIFICATIONS_EXPIRE_TIME;
-
-	else if (!strcmp(command_id, "SHUTDOWN_PROGRAM") || !strcmp(command_id, "SHUTDOWN_PROCESS"))
-		command_type = CMD_SHUTDOWN_PROCESS;
-	else if (!strcmp(command_id, "RESTART_PROGRAM") || !strcmp(command_id, "RESTART_PROCESS"))
-		command_type = CMD_RESTART_PROCESS;
-
-	else if (!strcmp(command_id, "SAVE_STATE_INFORMATION"))
-		command_type = CMD_SAVE_STATE_INFORMATION;
-	else if (!strcmp(command_id, "READ_STATE_INFORMATION"))
-		command_type = CMD_READ_STATE_INFORMATION;
-	else if (!strcmp(command_id, "SYNC_STATE_INFORMATION"))
-		command_type = CMD_SYNC_STATE_INFORMATION;
-
-	else if (!strcmp(command_id, "ENABLE_EVENT_HANDLERS"))
-		command_type = CMD_ENABLE_EVENT_HANDLERS;
-	else if (!strcmp(command_id, "DISABLE_EVENT_HANDLERS"))
-		command_type = CMD_DISABLE_EVENT_HANDLERS;
-
-	else if (!strcmp(command_id, "FLUSH_PENDING_COMMANDS"))
-		command_type = CMD_FLUSH_PENDING_COMMANDS;
-
-	else if (!strcmp(command_id, "ENABLE_FAILURE_PREDICTION"))
-		command_type = CMD_ENABLE_FAILURE_PREDICTION;
-	else if (!strcmp(command_id, "DISABLE_FAILURE_PREDICTION"))
-		command_type = CMD_DISABLE_FAILURE_PREDICTION;
-
-	else if (!strcmp(command_id, "ENABLE_PERFORMANCE_DATA"))
-		command_type = CMD_ENABLE_PERFORMANCE_DATA;
-	else if (!strcmp(command_id, "DISABLE_PERFORMANCE_DATA"))
-		command_type = CMD_DISABLE_PERFORMANCE_DATA;
-
-	else if (!strcmp(command_id, "START_EXECUTING_HOST_CHECKS"))
-		command_type = CMD_START_EXECUTING_HOST_CHECKS;
-	else if (!strcmp(command_id, "STOP_EXECUTING_HOST_CHECKS"))
-		command_type = CMD_STOP_EXECUTING_HOST_CHECKS;
-
-	else if (!strcmp(command_id, "START_EXECUTING_SVC_CHECKS"))
-		command_type = CMD_START_EXECUTING_SVC_CHECKS;
-	else if (!strcmp(command_id, "STOP_EXECUTING_SVC_CHECKS"))
-		command_type = CMD_STOP_EXECUTING_SVC_CHECKS;
-
-	else if (!strcmp(command_id, "START_ACCEPTING_PASSIVE_HOST_CHECKS"))
-		command_type = CMD_START_ACCEPTING_PASSIVE_HOST_CHECKS;
-	else if (!strcmp(command_id, "STOP_ACCEPTING_PASSIVE_HOST_CHECKS"))
-		command_type = CMD_STOP_ACCEPTING_PASSIVE_HOST_CHECKS;
-
-	else if (!strcmp(command_id, "START_ACCEPTING_PASSIVE_SVC_CHECKS"))
-		command_type = CMD_START_ACCEPTING_PASSIVE_SVC_CHECKS;
-	else if (!strcmp(command_id, "STOP_ACCEPTING_PASSIVE_SVC_CHECKS"))
-		command_type = CMD_STOP_ACCEPTING_PASSIVE_SVC_CHECKS;
-
-	else if (!strcmp(command_id, "START_OBSESSING_OVER_HOST_CHECKS"))
-		command_type = CMD_START_OBSESSING_OVER_HOST_CHECKS;
-	else if (!strcmp(command_id, "STOP_OBSESSING_OVER_HOST_CHECKS"))
-		command_type = CMD_STOP_OBSESSING_OVER_HOST_CHECKS;
-
-	else if (!strcmp(command_id, "START_OBSESSING_OVER_SVC_CHECKS"))
-		command_type = CMD_START_OBSESSING_OVER_SVC_CHECKS;
-	else if (!strcmp(command_id, "STOP_OBSESSING_OVER_SVC_CHECKS"))
-		command_type = CMD_STOP_OBSESSING_OVER_SVC_CHECKS;
-
-	else if (!strcmp(command_id, "ENABLE_FLAP_DETECTION"))
-		command_type = CMD_ENABLE_FLAP_DETECTION;
-	else if (!strcmp(command_id, "DISABLE_FLAP_DETECTION"))
-		command_type = CMD_DISABLE_FLAP_DETECTION;
-
-	else if (!strcmp(command_id, "CHANGE_GLOBAL_HOST_EVENT_HANDLER"))
-		command_type = CMD_CHANGE_GLOBAL_HOST_EVENT_HANDLER;
-	else if (!strcmp(command_id, "CHANGE_GLOBAL_SVC_EVENT_HANDLER"))
-		command_type = CMD_CHANGE_GLOBAL_SVC_EVENT_HANDLER;
-
-	else if (!strcmp(command_id, "ENABLE_SERVICE_FRESHNESS_CHECKS"))
-		command_type = CMD_ENABLE_SERVICE_FRESHNESS_CHECKS;
-	else if (!strcmp(command_id, "DISABLE_SERVICE_FRESHNESS_CHECKS"))
-		command_type = CMD_DISABLE_SERVICE_FRESHNESS_CHECKS;
-
-	else if (!strcmp(command_id, "ENABLE_HOST_FRESHNESS_CHECKS"))
-		command_type = CMD_ENABLE_HOST_FRESHNESS_CHECKS;
-	else if (!strcmp(command_id, "DISABLE_HOST_FRESHNESS_CHECKS"))
-		command_type = CMD_DISABLE_HOST_FRESHNESS_CHECKS;
-
-
-	/*******************************/
-	/**** HOST-RELATED COMMANDS ****/
-	/*******************************/
-
-	else if (!strcmp(command_id, "ADD_HOST_COMMENT"))
-		command_type = CMD_ADD_HOST_COMMENT;
-	else if (!strcmp(command_id, "DEL_HOST_COMMENT"))
-		command_type = CMD_DEL_HOST_COMMENT;
-	else if (!strcmp(command_id, "DEL_ALL_HOST_COMMENTS"))
-		command_type = CMD_DEL_ALL_HOST_COMMENTS;
-
-	else if (!strcmp(command_id, "DELAY_HOST_NOTIFICATION"))
-		command_type = CMD_DELAY_HOST_NOTIFICATION;
-
-	else if (!strcmp(command_id, "ENABLE_HOST_NOTIFICATIONS"))
-		command_type = CMD_ENABLE_HOST_NOTIFICATIONS;
-	else if (!strcmp(command_id, "DISABLE_HOST_NOTIFICATIONS"))
-		command_type = CMD_DISABLE_HOST_NOTIFICATIONS;
-
-	else if (!strcmp(command_id, "ENABLE_ALL_NOTIFICATIONS_BEYOND_HOST"))
-		command_type = CMD_ENABLE_ALL_NOTIFICATIONS_BEYOND_HOST;
-	else if (!strcmp(command_id, "DISABLE_ALL_NOTIFICATIONS_BEYOND_HOST"))
-		command_type = CMD_DISABLE_ALL_NOTIFICATIONS_BEYOND_HOST;
-
-	else if (!strcmp(command_id, "ENABLE_HOST_AND_CHILD_NOTIFICATIONS"))
-		command_type = CMD_ENABLE_HOST_AND_CHILD_NOTIFICATIONS;
-	else if (!strcmp(command_id, "DISABLE_HOST_AND_CHILD_NOTIFICATIONS"))
-		command_type = CMD_DISABLE_HOST_AND_CHILD_NOTIFICATIONS;
-
-	else if (!strcmp(command_id, "ENABLE_HOST_SVC_NOTIFICATIONS"))
-		command_type = CMD_ENABLE_HOST_SVC_NOTIFICATIONS;
-	else if (!strcmp(command_id, "DISABLE_HOST_SVC_NOTIFICATIONS"))
-		command_type = CMD_DISABLE_HOST_SVC_NOTIFICATIONS;
-
-	else if (!strcmp(command_id, "ENABLE_HOST_SVC_CHECKS"))
-		command_type = CMD_ENABLE_HOST_SVC_CHECKS;
-	else if (!strcmp(command_id, "DISABLE_HOST_SVC_CHECKS"))
-		command_type = CMD_DISABLE_HOST_SVC_CHECKS;
-
-	else if (!strcmp(command_id, "ENABLE_PASSIVE_HOST_CHECKS"))
-		command_type = CMD_ENABLE_PASSIVE_HOST_CHECKS;
-	else if (!strcmp(command_id, "DISABLE_PASSIVE_HOST_CHECKS"))
-		command_type = CMD_DISABLE_PASSIVE_HOST_CHECKS;
-
-	else if (!strcmp(command_id, "SCHEDULE_HOST_SVC_CHECKS"))
-		command_type = CMD_SCHEDULE_HOST_SVC_CHECKS;
-	else if (!strcmp(command_id, "SCHEDULE_FORCED_HOST_SVC_CHECKS"))
-		command_type = CMD_SCHEDULE_FORCED_HOST_SVC_CHECKS;
-
-	else if (!strcmp(command_id, "ACKNOWLEDGE_HOST_PROBLEM"))
-		command_type = CMD_ACKNOWLEDGE_HOST_PROBLEM;
-	else if (!strcmp(command_id, "ACKNOWLEDGE_HOST_PROBLEM_EXPIRE"))
-		command_type = CMD_ACKNOWLEDGE_HOST_PROBLEM_EXPIRE;
-	else if (!strcmp(command_id, "REMOVE_HOST_ACKNOWLEDGEMENT"))
-		command_type = CMD_REMOVE_HOST_ACKNOWLEDGEMENT;
-
-	else if (!strcmp(command_id, "ENABLE_HOST_EVENT_HANDLER"))
-		command_type = CMD_ENABLE_HOST_EVENT_HANDLER;
-	else if (!strcmp(command_id, "DISABLE_HOST_EVENT_HANDLER"))
-		command_type = CMD_DISABLE_HOST_EVENT_HANDLER;
-
-	else if (!strcmp(command_id, "ENABLE_HOST_CHECK"))
-		command_type = CMD_ENABLE_HOST_CHECK;
-	else if (!strcmp(command_id, "DISABLE_HOST_CHECK"))
-		command_type = CMD_DISABLE_HOST_CHECK;
-
-	else if (!strcmp(command_id, "SCHEDULE_HOST_CHECK"))
-		command_type = CMD_SCHEDULE_HOST_CHECK;
-	else if (!strcmp(command_id, "SCHEDULE_FORCED_HOST_CHECK"))
-		command_type = CMD_SCHEDULE_FORCED_HOST_CHECK;
-
-	else if (!strcmp(command_id, "SCHEDULE_HOST_DOWNTIME"))
-		command_type = CMD_SCHEDULE_HOST_DOWNTIME;
-	else if (!strcmp(command_id, "SCHEDULE_HOST_SVC_DOWNTIME"))
-		command_type = CMD_SCHEDULE_HOST_SVC_DOWNTIME;
-	else if (!strcmp(command_id, "DEL_HOST_DOWNTIME"))
-		command_type = CMD_DEL_HOST_DOWNTIME;
-	else if (!strcmp(command_id, "DEL_DOWNTIME_BY_HOST_NAME"))
-		command_type = CMD_DEL_DOWNTIME_BY_HOST_NAME;
-	else if (!strcmp(command_id, "DEL_DOWNTIME_BY_HOSTGROUP_NAME"))
-		command_type = CMD_DEL_DOWNTIME_BY_HOSTGROUP_NAME;
-
-	else if (!strcmp(command_id, "DEL_DOWNTIME_BY_START_TIME_COMMENT"))
-		command_type = CMD_DEL_DOWNTIME_BY_START_TIME_COMMENT;
-
-	else if (!strcmp(command_id, "ENABLE_HOST_FLAP_DETECTION"))
-		command_type = CMD_ENABLE_HOST_FLAP_DETECTION;
-	else if (!strcmp(command_id, "DISABLE_HOST_FLAP_DETECTION"))
-		command_type = CMD_DISABLE_HOST_FLAP_DETECTION;
-
-	else if (!strcmp(command_id, "START_OBSESSING_OVER_HOST"))
-		command_type = CMD_START_OBSESSING_OVER_HOST;
-	else if (!strcmp(command_id, "STOP_OBSESSING_OVER_HOST"))
-		command_type = CMD_STOP_OBSESSING_OVER_HOST;
-
-	else if (!strcmp(command_id, "CHANGE_HOST_EVENT_HANDLER"))
-		command_type = CMD_CHANGE_HOST_EVENT_HANDLER;
-	else if (!strcmp(command_id, "CHANGE_HOST_CHECK_COMMAND"))
-		command_type = CMD_CHANGE_HOST_CHECK_COMMAND;
-
-	else if (!strcmp(command_id, "CHANGE_NORMAL_HOST_CHECK_INTERVAL"))
-		command_type = CMD_CHANGE_NORMAL_HOST_CHECK_INTERVAL;
-	else if (!strcmp(command_id, "CHANGE_RETRY_HOST_CHECK_INTERVAL"))
-		command_type = CMD_CHANGE_RETRY_HOST_CHECK_INTERVAL;
-
-	else if (!strcmp(command_id, "CHANGE_MAX_HOST_CHECK_ATTEMPTS"))
-		command_type = CMD_CHANGE_MAX_HOST_CHECK_ATTEMPTS;
-
-	else if (!strcmp(command_id, "SCHEDULE_AND_PROPAGATE_TRIGGERED_HOST_DOWNTIME"))
-		command_type = CMD_SCHEDULE_AND_PROPAGATE_TRIGGERED_HOST_DOWNTIME;
-
-	else if (!strcmp(command_id, "SCHEDULE_AND_PROPAGATE_HOST_DOWNTIME"))
-		command_type = CMD_SCHEDULE_AND_PROPAGATE_HOST_DOWNTIME;
-
-	else if (!strcmp(command_id, "SET_HOST_NOTIFICATION_NUMBER"))
-		command_type = CMD_SET_HOST_NOTIFICATION_NUMBER;
-
-	else if (!strcmp(command_id, "CHANGE_HOST_CHECK_TIMEPERIOD"))
-		command_type = CMD_CHANGE_HOST_CHECK_TIMEPERIOD;
-
-	else if (!strcmp(command_id, "CHANGE_CUSTOM_HOST_VAR"))
-		command_type = CMD_CHANGE_CUSTOM_HOST_VAR;
-
-	else if (!strcmp(command_id, "SEND_CUSTOM_HOST_NOTIFICATION"))
-		command_type = CMD_SEND_CUSTOM_HOST_NOTIFICATION;
-
-	else if (!strcmp(command_id, "CHANGE_HOST_NOTIFICATION_TIMEPERIOD"))
-		command_type = CMD_CHANGE_HOST_NOTIFICATION_TIMEPERIOD;
-
-	else if (!strcmp(command_id, "CHANGE_HOST_MODATTR"))
-		command_type = CMD_CHANGE_HOST_MODATTR;
-
-
-	/************************************/
-	/**** HOSTGROUP-RELATED COMMANDS ****/
-	/************************************/
-
-	else if (!strcmp(command_id, "ENABLE_HOSTGROUP_HOST_NOTIFICATIONS"))
-		command_type = CMD_ENABLE_HOSTGROUP_HOST_NOTIFICATIONS;
-	else if (!strcmp(command_id, "DISABLE_HOSTGROUP_HOST_NOTIFICATIONS"))
-		command_type = CMD_DISABLE_HOSTGROUP_HOST_NOTIFICATIONS;
-
-	else if (!strcmp(command_id, "ENABLE_HOSTGROUP_SVC_NOTIFICATIONS"))
-		command_type = CMD_ENABLE_HOSTGROUP_SVC_NOTIFICATIONS;
-	else if (!strcmp(command_id, "DISABLE_HOSTGROUP_SVC_NOTIFICATIONS"))
-		command_type = CMD_DISABLE_HOSTGROUP_SVC_NOTIFICATIONS;
-
-	else if (!strcmp(command_id, "ENABLE_HOSTGROUP_HOST_CHECKS"))
-		command_type = CMD_ENABLE_HOSTGROUP_HOST_CHECKS;
-	else if (!strcmp(command_id, "DISABLE_HOSTGROUP_HOST_CHECKS"))
-		command_type = CMD_DISABLE_HOSTGROUP_HOST_CHECKS;
-
-	else if (!strcmp(command_id, "ENABLE_HOSTGROUP_PASSIVE_HOST_CHECKS"))
-		command_type = CMD_ENABLE_HOSTGROUP_PASSIVE_HOST_CHECKS;
-	else if (!strcmp(command_id, "DISABLE_HOSTGROUP_PASSIVE_HOST_CHECKS"))
-		command_type = CMD_DISABLE_HOSTGROUP_PASSIVE_HOST_CHECKS;
-
-	else if (!strcmp(command_id, "ENABLE_HOSTGROUP_SVC_CHECKS"))
-		command_type = CMD_ENABLE_HOSTGROUP_SVC_CHECKS;
-	else if (!strcmp(command_id, "DISABLE_HOSTGROUP_SVC_CHECKS"))
-		command_type = CMD_DISABLE_HOSTGROUP_SVC_CHECKS;
-
-	else if (!strcmp(command_id, "ENABLE_HOSTGROUP_PASSIVE_SVC_CHECKS"))
-		command_type = CMD_ENABLE_HOSTGROUP_PASSIVE_SVC_CHECKS;
-	else if (!strcmp(command_id, "DISABLE_HOSTGROUP_PASSIVE_SVC_CHECKS"))
-		command_type = CMD_DISABLE_HOSTGROUP_PASSIVE_SVC_CHECKS;
-
-	else if (!strcmp(command_id, "SCHEDULE_HOSTGROUP_HOST_DOWNTIME"))
-		command_type = CMD_SCHEDULE_HOSTGROUP_HOST_DOWNTIME;
-	else if (!strcmp(command_id, "SCHEDULE_HOSTGROUP_SVC_DOWNTIME"))
-		command_type = CMD_SCHEDULE_HOSTGROUP_SVC_DOWNTIME;
-
-
-	/**********************************/
-	/**** SERVICE-RELATED COMMANDS ****/
-	/**********************************/
-
-	else if (!strcmp(command_id, "ADD_SVC_COMMENT"))
-		command_type = CMD_ADD_SVC_COMMENT;
-	else if (!strcmp(command_id, "DEL_SVC_COMMENT"))
-		command_type = CMD_DEL_SVC_COMMENT;
-	else if (!strcmp(command_id, "DEL_ALL_SVC_COMMENTS"))
-		command_type = CMD_DEL_ALL_SVC_COMMENTS;
-
-	else if (!strcmp(command_id, "SCHEDULE_SVC_CHECK"))
-		command_type = CMD_SCHEDULE_SVC_CHECK;
-	else if (!strcmp(command_id, "SCHEDULE_FORCED_SVC_CHECK"))
-		command_type = CMD_SCHEDULE_FORCED_SVC_CHECK;
-
-	else if (!strcmp(command_id, "ENABLE_SVC_CHECK"))
-		command_type = CMD_ENABLE_SVC_CHECK;
-	else if (!strcmp(command_id, "DISABLE_SVC_CHECK"))
-		command_type = CMD_DISABLE_SVC_CHECK;
-
-	else if (!strcmp(command_id, "ENABLE_PASSIVE_SVC_CHECKS"))
-		command_type = CMD_ENABLE_PASSIVE_SVC_CHECKS;
-	else if (!strcmp(command_id, "DISABLE_PASSIVE_SVC_CHECKS"))
-		command_type = CMD_DISABLE_PASSIVE_SVC_CHECKS;
-
-	else if (!strcmp(command_id, "DELAY_SVC_NOTIFICATION"))
-		command_type = CMD_DELAY_SVC_NOTIFICATION;
-	else if (!strcmp(command_id, "ENABLE_SVC_NOTIFICATIONS"))
-		command_type = CMD_ENABLE_SVC_NOTIFICATIONS;
-	else if (!strcmp(command_id, "DISABLE_SVC_NOTIFICATIONS"))
-		command_type = CMD_DISABLE_SVC_NOTIFICATIONS;
-
-	else if (!strcmp(command_id, "PROCESS_SERVICE_CHECK_RESULT"))
-		command_type = CMD_PROCESS_SERVICE_CHECK_RESULT;
-	else if (!strcmp(command_id, "PROCESS_HOST_CHECK_RESULT"))
-		command_type = CMD_PROCESS_HOST_CHECK_RESULT;
-
-	else if (!strcmp(command_id, "ENABLE_SVC_EVENT_HANDLER"))
-		command_type = CMD_ENABLE_SVC_EVENT_HANDLER;
-	else if (!strcmp(command_id, "DISABLE_SVC_EVENT_HANDLER"))
-		command_type = CMD_DISABLE_SVC_EVENT_HANDLER;
-
-	else if (!strcmp(command_id, "ENABLE_SVC_FLAP_DETECTION"))
-		command_type = CMD_ENABLE_SVC_FLAP_DETECTION;
-	else if (!strcmp(command_id, "DISABLE_SVC_FLAP_DETECTION"))
-		command_type = CMD_DISABLE_SVC_FLAP_DETECTION;
-
-	else if (!strcmp(command_id, "SCHEDULE_SVC_DOWNTIME"))
-		command_type = CMD_SCHEDULE_SVC_DOWNTIME;
-	else if (!strcmp(command_id, "DEL_SVC_DOWNTIME"))
-		command_type = CMD_DEL_SVC_DOWNTIME;
-
-	else if (!strcmp(command_id, "ACKNOWLEDGE_SVC_PROBLEM"))
-		command_type = CMD_ACKNOWLEDGE_SVC_PROBLEM;
-	else if (!strcmp(command_id, "ACKNOWLEDGE_SVC_PROBLEM_EXPIRE"))
-		command_type = CMD_ACKNOWLEDGE_SVC_PROBLEM_EXPIRE;
-	else if (!strcmp(command_id, "REMOVE_SVC_ACKNOWLEDGEMENT"))
-		command_type = CMD_REMOVE_SVC_ACKNOWLEDGEMENT;
-
-	else if (!strcmp(command_id, "START_OBSESSING_OVER_SVC"))
-		command_type = CMD_START_OBSESSING_OVER_SVC;
-	else if (!strcmp(command_id, "STOP_OBSESSING_OVER_SVC"))
-		command_type = CMD_STOP_OBSESSING_OVER_SVC;
-
-	else if (!strcmp(command_id, "CHANGE_SVC_EVENT_HANDLER"))
-		command_type = CMD_CHANGE_SVC_EVENT_HANDLER;
-	else if (!strcmp(command_id, "CHANGE_SVC_CHECK_COMMAND"))
-		command_type = CMD_CHANGE_SVC_CHECK_COMMAND;
-
-	else if (!strcmp(command_id, "CHANGE_NORMAL_SVC_CHECK_INTERVAL"))
-		command_type = CMD_CHANGE_NORMAL_SVC_CHECK_INTERVAL;
-	else if (!strcmp(command_id, "CHANGE_RETRY_SVC_CHECK_INTERVAL"))
-		command_type = CMD_CHANGE_RETRY_SVC_CHECK_INTERVAL;
-
-	else if (!strcmp(command_id, "CHANGE_MAX_SVC_CHECK_ATTEMPTS"))
-		command_type = CMD_CHANGE_MAX_SVC_CHECK_ATTEMPTS;
-
-	else if (!strcmp(command_id, "SET_SVC_NOTIFICATION_NUMBER"))
-		command_type = CMD_SET_SVC_NOTIFICATION_NUMBER;
-
-	else if (!strcmp(command_id, "CHANGE_SVC_CHECK_TIMEPERIOD"))
-		command_type = CMD_CHANGE_SVC_CHECK_TIMEPERIOD;
-
-	else if (!strcmp(command_id, "CHANGE_CUSTOM_SVC_VAR"))
-		command_type = CMD_CHANGE_CUSTOM_SVC_VAR;
-
-	else if (!strcmp(command_id, "CHANGE_CUSTOM_CONTACT_VAR"))
-		command_type = CMD_CHANGE_CUSTOM_CONTACT_VAR;
-
-	else if (!strcmp(command_id, "SEND_CUSTOM_SVC_NOTIFICATION"))
-		command_type = CMD_SEND_CUSTOM_SVC_NOTIFICATION;
-
-	else if (!strcmp(command_id, "CHANGE_SVC_NOTIFICATION_TIMEPERIOD"))
-		command_type = CMD_CHANGE_SVC_NOTIFICATION_TIMEPERIOD;
-
-	else if (!strcmp(command_id, "CHANGE_SVC_MODATTR"))
-		command_type = CMD_CHANGE_SVC_MODATTR;
-
-
-	/***************************************/
-	/**** SERVICEGROUP-RELATED COMMANDS ****/
-	/***************************************/
-
-	else if (!strcmp(command_id, "ENABLE_SERVICEGROUP_HOST_NOTIFICATIONS"))
-		command_type = CMD_ENABLE_SERVICEGROUP_HOST_NOTIFICATIONS;
-	else if (!strcmp(command_id, "DISABLE_SERVICEGROUP_HOST_NOTIFICATIONS"))
-		command_type = CMD_DISABLE_SERVICEGROUP_HOST_NOTIFICATIONS;
-
-	else if (!strcmp(command_id, "ENABLE_SERVICEGROUP_SVC_NOTIFICATIONS"))
-		command_type = CMD_ENABLE_SERVICEGROUP_SVC_NOTIFICATIONS;
-	else if (!strcmp(command_id, "DISABLE_SERVICEGROUP_SVC_NOTIFICATIONS"))
-		command_type = CMD_DISABLE_SERVICEGROUP_SVC_NOTIFICATIONS;
-
-	else if (!strcmp(command_id, "ENABLE_SERVICEGROUP_HOST_CHECKS"))
-		command_type = CMD_ENABLE_SERVICEGROUP_HOST_CHECKS;
-	else if (!strcmp(command_id, "DISABLE_SERVICEGROUP_HOST_CHECKS"))
-		command_type = CMD_DISABLE_SERVICEGROUP_HOST_CHECKS;
-
-	else if (!strcmp(command_id, "ENABLE_SERVICEGROUP_PASSIVE_HOST_CHECKS"))
-		command_type = CMD_ENABLE_SERVICEGROUP_PASSIVE_HOST_CHECKS;
-	else if (!strcmp(command_id, "DISABLE_SERVICEGROUP_PASSIVE_HOST_CHECKS"))
-		command_type = CMD_DISABLE_SERVICEGROUP_PASSIVE_HOST_CHECKS;
-
-	else if (!strcmp(command_id, "ENABLE_SERVICEGROUP_SVC_CHECKS"))
-		command_type = CMD_ENABLE_SERVICEGROUP_SVC_CHECKS;
-	else if (!strcmp(command_id, "DISABLE_SERVICEGROUP_SVC_CHECKS"))
-		command_type = CMD_DISABLE_SERVICEGROUP_SVC_CHECKS;
-
-	else if (!strcmp(command_id, "ENABLE_SERVICEGROUP_PASSIVE_SVC_CHECKS"))
-		command_type = CMD_ENABLE_SERVICEGROUP_PASSIVE_SVC_CHECKS;
-	else if (!strcmp(command_id, "DISABLE_SERVICEGROUP_PASSIVE_SVC_CHECKS"))
-		command_type = CMD_DISABLE_SERVICEGROUP_PASSIVE_SVC_CHECKS;
-
-	else if (!strcmp(command_id, "SCHEDULE_SERVICEGROUP_HOST_DOWNTIME"))
-		command_type = CMD_SCHEDULE_SERVICEGROUP_HOST_DOWNTIME;
-	else if (!strcmp(command_id, "SCHEDULE_SERVICEGROUP_SVC_DOWNTIME"))
-		command_type = CMD_SCHEDULE_SERVICEGROUP_SVC_DOWNTIME;
-
-
-	/**********************************/
-	/**** CONTACT-RELATED COMMANDS ****/
-	/**********************************/
-
-	else if (!strcmp(command_id, "ENABLE_CONTACT_HOST_NOTIFICATIONS"))
-		command_type = CMD_ENABLE_CONTACT_HOST_NOTIFICATIONS;
-	else if (!strcmp(command_id, "DISABLE_CONTACT_HOST_NOTIFICATIONS"))
-		command_type = CMD_DISABLE_CONTACT_HOST_NOTIFICATIONS;
-
-	else if (!strcmp(command_id, "ENABLE_CONTACT_SVC_NOTIFICATIONS"))
-		command_type = CMD_ENABLE_CONTACT_SVC_NOTIFICATIONS;
-	else if (!strcmp(command_id, "DISABLE_CONTACT_SVC_NOTIFICATIONS"))
-		command_type = CMD_DISABLE_CONTACT_SVC_NOTIFICATIONS;
-
-	else if (!strcmp(command_id, "CHANGE_CONTACT_HOST_NOTIFICATION_TIMEPERIOD"))
-		command_type = CMD_CHANGE_CONTACT_HOST_NOTIFICATION_TIMEPERIOD;
-
-	else if (!strcmp(command_id, "CHANGE_CONTACT_SVC_NOTIFICATION_TIMEPERIOD"))
-		command_type = CMD_CHANGE_CONTACT_SVC_NOTIFICATION_TIMEPERIOD;
-
-	else if (!strcmp(command_id, "CHANGE_CONTACT_MODATTR"))
-		command_type = CMD_CHANGE_CONTACT_MODATTR;
-	else if (!strcmp(command_id, "CHANGE_CONTACT_MODHATTR"))
-		command_type = CMD_CHANGE_CONTACT_MODHATTR;
-	else if (!strcmp(command_id, "CHANGE_CONTACT_MODSATTR"))
-		command_type = CMD_CHANGE_CONTACT_MODSATTR;
-
-	/***************************************/
-	/**** CONTACTGROUP-RELATED COMMANDS ****/
-	/***************************************/
-
-	else if (!strcmp(command_id, "ENABLE_CONTACTGROUP_HOST_NOTIFICATIONS"))
-		command_type = CMD_ENABLE_CONTACTGROUP_HOST_NOTIFICATIONS;
-	else if (!strcmp(command_id, "DISABLE_CONTACTGROUP_HOST_NOTIFICATIONS"))
-		command_type = CMD_DISABLE_CONTACTGROUP_HOST_NOTIFICATIONS;
-
-	else if (!strcmp(command_id, "ENABLE_CONTACTGROUP_SVC_NOTIFICATIONS"))
-		command_type = CMD_ENABLE_CONTACTGROUP_SVC_NOTIFICATIONS;
-	else if (!strcmp(command_id, "DISABLE_CONTACTGROUP_SVC_NOTIFICATIONS"))
-		command_type = CMD_DISABLE_CONTACTGROUP_SVC_NOTIFICATIONS;
-
-
-	/**************************/
-	/****** MISC COMMANDS *****/
-	/**************************/
-
-	else if (!strcmp(command_id, "PROCESS_FILE"))
-		command_type = CMD_PROCESS_FILE;
-
-
+	/* decide what type of command this is (binary search in the list of external commands in common/extcmd_list.c) */
+	command_type = extcmd_get_id(command_id);
 
 	/****************************/
 	/****** CUSTOM COMMANDS *****/
 	/****************************/
 
-	else if (command_id[0] == '_')
+	if (command_type == CMD_NONE && command_id[0] == '_')
 		command_type = CMD_CUSTOM_COMMAND;
 
-
-
 	/**** UNKNOWN COMMAND ****/
-	else {
+	if (command_type == CMD_NONE) {
 		/* log the bad external command */
 		logit(NSLOG_EXTERNAL_COMMAND | NSLOG_RUNTIME_WARNING, TRUE, "警报: 无法识别的额外命令 -> %s;%s\n", command_id, args);
 
@@ -1167,6 +920,10 @@ int process_external_command2(int cmd, time_t entry_time, char *args) {
 		cmd_process_external_commands_from_file(cmd, args);
 		break;
 
+	case CMD_PROCESS_CHECK_RESULT_FILE:
+		cmd_process_passive_check_result_file(cmd, args);
+		break;
+
 
 		/*************************/
 		/**** CUSTOM COMMANDS ****/
@@ -2119,19 +1876,8 @@ int process_passive_service_check(time_t check_time, char *host_name, char *svc_
 		return ERROR;
 
 	/* find the host by its name or address */
-	if (find_host(host_name) != NULL)
-		real_host_name = host_name;
-	else {
-		for (temp_host = host_list; temp_host != NULL; temp_host = temp_host->next) {
-			if (!strcmp(host_name, temp_host->address)) {
-				real_host_name = temp_host->name;
-				break;
-			} else if (!strcmp(host_name, temp_host->address6)) {
-				real_host_name = temp_host->name;
-				break;
-			}
-		}
-	}
+	if ((temp_host = find_passive_check_host(host_name)) != NULL)
+		real_host_name = temp_host->name;
 
 	/* we couldn't find the host */
 	if (real_host_name == NULL) {
@@ -2263,19 +2009,8 @@ int process_passive_host_check(time_t check_time, char *host_name, int return_co
 		return ERROR;
 
 	/* find the host by its name or address */
-	if ((temp_host = find_host(host_name)) != NULL)
-		real_host_name = host_name;
-	else {
-		for (temp_host = host_list; temp_host != NULL; temp_host = temp_host->next) {
-			if (!strcmp(host_name, temp_host->address)) {
-				real_host_name = temp_host->name;
-				break;
-			} else if (!strcmp(host_name, temp_host->address6)) {
-				real_host_name = temp_host->name;
-				break;
-			}
-		}
-	}
+	if ((temp_host = find_passive_check_host(host_name)) != NULL)
+		real_host_name = temp_host->name;
 
 	/* we couldn't find the host */
 	if (temp_host == NULL) {
@@ -2961,6 +2696,7 @@ int cmd_change_object_int_var(int cmd, char *args) {
 		/* modify the check interval */
 		temp_host->check_interval = dval;
 		attr = MODATTR_NORMAL_CHECK_INTERVAL;
+		update_host_freshness_deadline(temp_host);
 
 		/* schedule a host check if previous interval was 0 (checks were not regularly scheduled) */
 		if (old_dval == 0 && temp_host->checks_enabled == TRUE) {
@@ -2987,6 +2723,7 @@ int cmd_change_object_int_var(int cmd, char *args) {
 
 		temp_host->retry_interval = dval;
 		attr = MODATTR_RETRY_CHECK_INTERVAL;
+		update_host_freshness_deadline(temp_host);
 
 		break;
 
@@ -3009,6 +2746,7 @@ int cmd_change_object_int_var(int cmd, char *args) {
 		/* modify the check interval */
 		temp_service->check_interval = dval;
 		attr = MODATTR_NORMAL_CHECK_INTERVAL;
+		update_service_freshness_deadline(temp_service);
 
 		/* schedule a service check if previous interval was 0 (checks were not regularly scheduled) */
 		if (old_dval == 0 && temp_service->checks_enabled == TRUE && temp_service->check_interval != 0) {
@@ -3035,6 +2773,7 @@ int cmd_change_object_int_var(int cmd, char *args) {
 
 		temp_service->retry_interval = dval;
 		attr = MODATTR_RETRY_CHECK_INTERVAL;
+		update_service_freshness_deadline(temp_service);
 
 		break;
 
@@ -3352,6 +3091,7 @@ int cmd_change_object_char_var(int cmd, char *args) {
 		temp_host->check_period = temp_ptr;
 		temp_host->check_period_ptr = temp_timeperiod;
 		attr = MODATTR_CHECK_TIMEPERIOD;
+		update_host_freshness_deadline(temp_host);
 		break;
 
 	case CMD_CHANGE_HOST_NOTIFICATION_TIMEPERIOD:
@@ -3384,6 +3124,7 @@ int cmd_change_object_char_var(int cmd, char *args) {
 		temp_service->check_period = temp_ptr;
 		temp_service->check_period_ptr = temp_timeperiod;
 		attr = MODATTR_CHECK_TIMEPERIOD;
+		update_service_freshness_deadline(temp_service);
 		break;
 
 	case CMD_CHANGE_SVC_NOTIFICATION_TIMEPERIOD:
@@ -3668,6 +3409,33 @@ int cmd_process_external_commands_from_file(int cmd, char *args) {
 }
 
 
+/* processes passive check results from a file */
+int cmd_process_passive_check_result_file(int cmd, char *args) {
+	char *fname = NULL;
+	char *temp_ptr = NULL;
+	int delete_file = FALSE;
+
+	/* get the file name */
+	if ((temp_ptr = my_strtok(args, ";")) == NULL)
+		return ERROR;
+	if ((fname = (char *)strdup(temp_ptr)) == NULL)
+		return ERROR;
+
+	/* find the deletion option */
+	if ((temp_ptr = my_strtok(NULL, "\n")) == NULL) {
+		my_free(fname);
+		return ERROR;
+	}
+	delete_file = (atoi(temp_ptr) == 0) ? FALSE : TRUE;
+
+	process_passive_check_result_file(fname, delete_file);
+
+	my_free(fname);
+
+	return OK;
+}
+
+
 /******************************************************************/
 /*************** INTERNAL COMMAND IMPLEMENTATIONS  ****************/
 /******************************************************************/
@@ -3685,6 +3453,7 @@ void disable_service_checks(service *svc) {
 
 	/* disable the service check... */
 	svc->checks_enabled = FALSE;
+	update_service_freshness_deadline(svc);
 	svc->should_be_scheduled = FALSE;
 
 #ifdef USE_EVENT_BROKER
@@ -3715,6 +3484,7 @@ void enable_service_checks(service *svc) {
 
 	/* enable the service check... */
 	svc->checks_enabled = TRUE;
+	update_service_freshness_deadline(svc);
 	svc->should_be_scheduled = TRUE;
 
 	/* services with no check intervals don't get checked */
@@ -4405,6 +4175,7 @@ void enable_passive_service_checks(service *svc) {
 
 	/* set the passive check flag */
 	svc->accept_passive_service_checks = TRUE;
+	update_service_freshness_deadline(svc);
 
 #ifdef USE_EVENT_BROKER
 	/* send data to event broker */
@@ -4568,6 +4339,7 @@ void enable_passive_host_checks(host *hst) {
 
 	/* set the passive check flag */
 	hst->accept_passive_host_checks = TRUE;
+	update_host_freshness_deadline(hst);
 
 #ifdef USE_EVENT_BROKER
 	/* send data to event broker */
@@ -4780,6 +4552,7 @@ void disable_host_checks(host *hst) {
 
 	/* set the host check flag */
 	hst->checks_enabled = FALSE;
+	update_host_freshness_deadline(hst);
 	hst->should_be_scheduled = FALSE;
 
 #ifdef USE_EVENT_BROKER
@@ -4809,6 +4582,7 @@ void enable_host_checks(host *hst) {
 
 	/* set the host check flag */
 	hst->checks_enabled = TRUE;
+	update_host_freshness_deadline(hst);
 	hst->should_be_scheduled = TRUE;
 
 	/* hosts with no check intervals don't get checked */
@@ -5289,15 +5063,9 @@ void set_service_notification_number(service *svc, int num) {
 
 /* process all passive host and service checks we found in the external command file */
 void process_passive_checks(void) {
-	passive_check_result *temp_pcr = NULL;
 	passive_check_result *this_pcr = NULL;
 	passive_check_result *next_pcr = NULL;
-	char *checkresult_file = NULL;
-	int checkresult_file_fd = -1;
-	FILE *checkresult_file_fp = NULL;
-	mode_t new_umask = 077;
-	mode_t old_umask;
-	time_t current_time;
+	check_result *new_cr = NULL;
 
 	log_debug_info(DEBUGL_FUNCTIONS, 0, "process_passive_checks()\n");
 
@@ -5307,68 +5075,38 @@ void process_passive_checks(void) {
 
 	log_debug_info(DEBUGL_CHECKS, 1, "Submitting passive host/service check results obtained from external commands...\n");
 
-	/* open a temp file for storing check result(s) */
-	old_umask = umask(new_umask);
-	dummy = asprintf(&checkresult_file, "%s/checkXXXXXX", temp_path);
-	checkresult_file_fd = mkstemp(checkresult_file);
-	umask(old_umask);
-
-	if (checkresult_file_fd < 0) {
-		logit(NSLOG_RUNTIME_ERROR, TRUE, "Failed to open checkresult file '%s': %s\n", checkresult_file, strerror(errno));
-		free(checkresult_file);
-		return;
-	}
-
-	checkresult_file_fp = fdopen(checkresult_file_fd, "w");
-
-	time(&current_time);
-	fprintf(checkresult_file_fp, "### Passive Check Result File ###\n");
-	fprintf(checkresult_file_fp, "# Time: %s", ctime(&current_time));
-	fprintf(checkresult_file_fp, "file_time=%lu\n", (unsigned long)current_time);
-	fprintf(checkresult_file_fp, "\n");
-
-	log_debug_info(DEBUGL_CHECKS | DEBUGL_IPC, 1, "Passive check result(s) will be written to '%s' (fd=%d)\n", checkresult_file, checkresult_file_fd);
-
-	/* write all service checks to check result queue file for later processing */
-	for (temp_pcr = passive_check_result_list; temp_pcr != NULL; temp_pcr = temp_pcr->next) {
-
-		/* write check results to file */
-		if (checkresult_file_fp) {
-
-			fprintf(checkresult_file_fp, "### Icinga %s Check Result ###\n", (temp_pcr->object_check_type == SERVICE_CHECK) ? "Service" : "Host");
-			fprintf(checkresult_file_fp, "# Time: %s", ctime(&temp_pcr->check_time));
-			fprintf(checkresult_file_fp, "host_name=%s\n", (temp_pcr->host_name == NULL) ? "" : temp_pcr->host_name);
-			if (temp_pcr->object_check_type == SERVICE_CHECK)
-				fprintf(checkresult_file_fp, "service_description=%s\n", (temp_pcr->service_description == NULL) ? "" : temp_pcr->service_description);
-			fprintf(checkresult_file_fp, "check_type=%d\n", (temp_pcr->object_check_type == HOST_CHECK) ? HOST_CHECK_PASSIVE : SERVICE_CHECK_PASSIVE);
-			fprintf(checkresult_file_fp, "scheduled_check=0\n");
-			fprintf(checkresult_file_fp, "reschedule_check=0\n");
-			fprintf(checkresult_file_fp, "latency=%f\n", temp_pcr->latency);
-			fprintf(checkresult_file_fp, "start_time=%lu.%lu\n", temp_pcr->check_time, 0L);
-			fprintf(checkresult_file_fp, "finish_time=%lu.%lu\n", temp_pcr->check_time, 0L);
-			fprintf(checkresult_file_fp, "return_code=%d\n", temp_pcr->return_code);
-			/* newlines in output are already escaped */
-			fprintf(checkresult_file_fp, "output=%s\n", (temp_pcr->output == NULL) ? "" : temp_pcr->output);
-			fprintf(checkresult_file_fp, "\n");
-		}
-	}
-
-	/* close the temp file */
-	fclose(checkresult_file_fp);
-
-	/* move check result to queue directory */
-	move_check_result_to_queue(checkresult_file);
-
-	/* free memory */
-	my_free(checkresult_file);
-
-	/* free memory for the passive check result list */
+	/* put all passive checks straight onto the check result list, there is no need to pass them through the queue directory */
 	this_pcr = passive_check_result_list;
 	while (this_pcr != NULL) {
 		next_pcr = this_pcr->next;
-		my_free(this_pcr->host_name);
-		my_free(this_pcr->service_description);
-		my_free(this_pcr->output);
+
+		if ((new_cr = (check_result *)malloc(sizeof(check_result))) != NULL) {
+
+			init_check_result(new_cr);
+			new_cr->object_check_type = this_pcr->object_check_type;
+			new_cr->check_type = (this_pcr->object_check_type == HOST_CHECK) ? HOST_CHECK_PASSIVE : SERVICE_CHECK_PASSIVE;
+			new_cr->output_file = NULL;
+			new_cr->latency = this_pcr->latency;
+			new_cr->start_time.tv_sec = this_pcr->check_time;
+			new_cr->finish_time.tv_sec = this_pcr->check_time;
+			new_cr->return_code = this_pcr->return_code;
+
+			/* the check result takes over the strings - newlines in output are already escaped */
+			new_cr->host_name = (this_pcr->host_name == NULL) ? (char *)strdup("") : this_pcr->host_name;
+			if (this_pcr->object_check_type == SERVICE_CHECK)
+				new_cr->service_description = (this_pcr->service_description == NULL) ? (char *)strdup("") : this_pcr->service_description;
+			else
+				my_free(this_pcr->service_description);
+			new_cr->output = (this_pcr->output == NULL) ? (char *)strdup("") : this_pcr->output;
+
+			add_check_result_to_list(new_cr);
+			check_result_channel_stats[CHECK_RESULT_CHANNEL_EXTCMD]++;
+		} else {
+			my_free(this_pcr->host_name);
+			my_free(this_pcr->service_description);
+			my_free(this_pcr->output);
+		}
+
 		my_free(this_pcr);
 		this_pcr = next_pcr;
 	}
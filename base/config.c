@@ -183,8 +183,12 @@ extern double   high_host_flap_threshold;
 
 extern int      use_large_installation_tweaks;
 extern int      enable_environment_macros;
+extern int      lazy_environment_macros;
 extern int      free_child_process_memory;
 extern int      child_processes_fork_twice;
+extern int      check_worker_processes;
+extern int      check_result_reaper_threads;
+extern int      max_async_commands;
 
 extern int      enable_embedded_perl;
 extern int      use_embedded_perl_implicitly;
@@ -1363,12 +1367,48 @@ int read_main_config_file(char *main_config_file) {
 		else if (!strcmp(variable, "enable_environment_macros"))
 			enable_environment_macros = (atoi(value) > 0) ? TRUE : FALSE;
 
+		else if (!strcmp(variable, "lazy_environment_macros"))
+			lazy_environment_macros = (atoi(value) > 0) ? TRUE : FALSE;
+
 		else if (!strcmp(variable, "free_child_process_memory"))
 			free_child_process_memory = (atoi(value) > 0) ? TRUE : FALSE;
 
 		else if (!strcmp(variable, "child_processes_fork_twice"))
 			child_processes_fork_twice = (atoi(value) > 0) ? TRUE : FALSE;
 
+		else if (!strcmp(variable, "check_worker_processes")) {
+
+			check_worker_processes = atoi(value);
+
+			if (check_worker_processes < 0) {
+				dummy = asprintf(&error_message, "Illegal value for check_worker_processes");
+				error = TRUE;
+				break;
+			}
+		}
+
+		else if (!strcmp(variable, "check_result_reaper_threads")) {
+
+			check_result_reaper_threads = atoi(value);
+
+			if (check_result_reaper_threads < 0 || check_result_reaper_threads > MAX_CHECK_RESULT_REAPER_THREADS) {
+				dummy = asprintf(&error_message, "Illegal value for check_result_reaper_threads");
+				error = TRUE;
+				break;
+			}
+		}
+
+		else if (!strcmp(variable, "max_async_commands")) {
+
+			max_async_commands = atoi(value);
+
+			if (max_async_commands < 0) {
+				dummy = asprintf(&error_message, "Illegal value for max_async_commands");
+				error = TRUE;
+				break;
+			}
+		}
+
 		else if (!strcmp(variable, "enable_embedded_perl")) {
 
 			if (strlen(value) != 1 || value[0] < '0' || value[0] > '1') {
@@ -1509,6 +1549,10 @@ int read_main_config_file(char *main_config_file) {
 		/* ignore external variables */
 		else if (!strcmp(variable, "status_file"))
 			continue;
+		else if (!strcmp(variable, "status_file_delta_updates"))
+			continue;
+		else if (!strcmp(variable, "status_file_binary"))
+			continue;
 		else if (!strcmp(variable, "perfdata_timeout"))
 			continue;
 		else if (strstr(variable, "host_perfdata") == variable)
@@ -1521,10 +1565,14 @@ int read_main_config_file(char *main_config_file) {
 			continue;
 		else if (strstr(input, "sync_retention_file=") == input)
 			continue;
+		else if (!strcmp(variable, "retention_file_binary"))
+			continue;
 		else if (strstr(input, "object_cache_file=") == input)
 			continue;
 		else if (strstr(input, "precached_object_file=") == input)
 			continue;
+		else if (!strcmp(variable, "object_parse_threads"))
+			continue;
 
 		/* we don't know what this variable is... */
 		else {
@@ -1540,6 +1588,9 @@ int read_main_config_file(char *main_config_file) {
 		set_environment_var("TZ", use_timezone, 1);
 	tzset();
 
+	/* time ranges compiled under the old timezone don't hold anymore */
+	invalidate_compiled_timeperiods();
+
 	/* adjust command check interval */
 	if (command_check_interval_is_seconds == FALSE && command_check_interval != -1)
 		command_check_interval *= interval_length;
@@ -2763,6 +2814,10 @@ int pre_flight_object_check(int *w, int *e) {
 				errors++;
 			}
 		}
+
+		/* split the command line into macro tokens once, instead of for every check */
+		if (temp_command->macro_tokens == NULL)
+			temp_command->macro_tokens = compile_macro_tokens(temp_command->command_line);
 	}
 
 	if (verify_config)
@@ -97,10 +97,8 @@ extern time_t	disable_notifications_expire_time;
 extern int 	event_profiling_enabled;
 #endif
 
-timed_event *event_list_low = NULL;
-timed_event *event_list_low_tail = NULL;
-timed_event *event_list_high = NULL;
-timed_event *event_list_high_tail = NULL;
+timed_event_queue event_queue_low;
+timed_event_queue event_queue_high;
 
 extern host     *host_list;
 extern service  *service_list;
@@ -744,43 +742,48 @@ void display_event_data(timed_event* event, int priority) {
 
 /* displays the service check scheduling queue */
 void display_schedule(void) {
-	timed_event* high_event = NULL;
-	timed_event* low_event = NULL;
-	timed_event* event = NULL;
+	timed_event **high_events = NULL;
+	timed_event **low_events = NULL;
+	timed_event **high_event = NULL;
+	timed_event **low_event = NULL;
+	timed_event *event = NULL;
 	int priority = 0;
 
 	printf("*** 下面列出的当前调度队列 ***\n");
 
-	high_event = event_list_high;
-	low_event = event_list_low;
+	high_events = get_sorted_event_list(&event_queue_high);
+	low_events = get_sorted_event_list(&event_queue_low);
+	if (high_events == NULL || low_events == NULL) {
+		my_free(high_events);
+		my_free(low_events);
+		return;
+	}
+
+	high_event = high_events;
+	low_event = low_events;
 
-	while (high_event || low_event) {
-		if (low_event && high_event) {
-			if (low_event->run_time < high_event->run_time) {
-				event = low_event;
-				low_event = low_event->next;
+	while (*high_event || *low_event) {
+		if (*low_event && *high_event) {
+			if ((*low_event)->run_time < (*high_event)->run_time) {
+				event = *low_event++;
 				priority = 0;
 			} else {
-				event = high_event;
-				high_event = high_event->next;
+				event = *high_event++;
 				priority = 1;
 			}
+		} else if (*high_event) {
+			event = *high_event++;
+			priority = 1;
 		} else {
-			if (high_event) {
-				event = high_event;
-				high_event = high_event->next;
-				priority = 1;
-			}
-
-			if (low_event) {
-				event = low_event;
-				low_event = low_event->next;
-				priority = 0;
-			}
+			event = *low_event++;
+			priority = 0;
 		}
 
 		display_event_data(event, priority);
 	}
+
+	my_free(high_events);
+	my_free(low_events);
 }
 
 
@@ -909,19 +912,15 @@ void display_scheduling_info(void) {
 
 /* schedule a new timed event */
 int schedule_new_event(int event_type, int high_priority, time_t run_time, int recurring, unsigned long event_interval, void *timing_func, int compensate_for_time_change, void *event_data, void *event_args, int event_options) {
-	timed_event **event_list = NULL;
-	timed_event **event_list_tail = NULL;
+	timed_event_queue *event_queue = NULL;
 	timed_event *new_event = NULL;
 
 	log_debug_info(DEBUGL_FUNCTIONS, 0, "schedule_new_event()\n");
 
-	if (high_priority == TRUE) {
-		event_list = &event_list_high;
-		event_list_tail = &event_list_high_tail;
-	} else {
-		event_list = &event_list_low;
-		event_list_tail = &event_list_low_tail;
-	}
+	if (high_priority == TRUE)
+		event_queue = &event_queue_high;
+	else
+		event_queue = &event_queue_low;
 
 	new_event = (timed_event *)malloc(sizeof(timed_event));
 	if (new_event != NULL) {
@@ -934,6 +933,7 @@ int schedule_new_event(int event_type, int high_priority, time_t run_time, int r
 		new_event->event_interval = event_interval;
 		new_event->timing_func = timing_func;
 		new_event->compensate_for_time_change = compensate_for_time_change;
+		new_event->queue_pos = 0;
 		/*
 		 * we need to keep the reverse link from the (service|host *)event_data->next_check_event
 		 * to the new_event in order to stay sane on schedule_host|service_check() checks
@@ -953,8 +953,8 @@ int schedule_new_event(int event_type, int high_priority, time_t run_time, int r
 	} else
 		return ERROR;
 
-	/* add the event to the event list */
-	add_event(new_event, event_list, event_list_tail);
+	/* add the event to the event queue */
+	add_event(new_event, event_queue);
 
 	return OK;
 }
@@ -965,9 +965,9 @@ int schedule_new_event(int event_type, int high_priority, time_t run_time, int r
 	If needed for other cases, you have to adopt this function to fit all needs!!!
 */
 int delete_scheduled_event(int event_type, int high_priority, time_t run_time, int recurring, unsigned long event_interval, void *timing_func, int compensate_for_time_change, void *event_data, void *event_args, int event_options) {
-	timed_event **event_list = NULL;
-	timed_event **event_list_tail = NULL;
+	timed_event_queue *event_queue = NULL;
 	timed_event *temp_event = NULL;
+	unsigned int x = 0;
 
 	/* we support only acknowledgements at the moment */
 	if (event_type != EVENT_EXPIRE_ACKNOWLEDGEMENT)
@@ -975,23 +975,22 @@ int delete_scheduled_event(int event_type, int high_priority, time_t run_time, i
 
 	log_debug_info(DEBUGL_FUNCTIONS, 0, "delete_scheduled_event()\n");
 
-	if (high_priority == TRUE) {
-		event_list = &event_list_high;
-		event_list_tail = &event_list_high_tail;
-	} else {
-		event_list = &event_list_low;
-		event_list_tail = &event_list_low_tail;
-	}
+	if (high_priority == TRUE)
+		event_queue = &event_queue_high;
+	else
+		event_queue = &event_queue_low;
 
-	/* start from the beginning */
-	for (temp_event = *event_list; temp_event != NULL; temp_event = temp_event->next) {
+	/* the queue is not ordered beyond its first element, so check every slot */
+	for (x = 1; x <= event_queue->heap.count; x++) {
+
+		temp_event = (timed_event *)event_queue->heap.items[x];
 
 		if (temp_event->event_type == event_type && temp_event->event_options == event_options && temp_event->event_data == event_data) {
 
 			log_debug_info(DEBUGL_EVENTS, 1, "移除事件类型 %d @ %s", event_type, ctime(&run_time));
 
-			/* remove the event from the event list */
-			remove_event(temp_event, event_list, event_list_tail);
+			/* remove the event from the event queue */
+			remove_event(temp_event, event_queue);
 
 			return OK;
 		}
@@ -1002,7 +1001,7 @@ int delete_scheduled_event(int event_type, int high_priority, time_t run_time, i
 
 
 /* reschedule an event in order of execution time */
-void reschedule_event(timed_event *event, timed_event **event_list, timed_event **event_list_tail) {
+void reschedule_event(timed_event *event, timed_event_queue *event_queue) {
 	time_t current_time = 0L;
 	time_t (*timingfunc)(void);
 
@@ -1026,60 +1025,68 @@ void reschedule_event(timed_event *event, timed_event **event_list, timed_event
 		}
 	}
 
-	/* add the event to the event list */
-	add_event(event, event_list, event_list_tail);
+	/* add the event to the event queue */
+	add_event(event, event_queue);
 
 	return;
 }
 
 
-/* add an event to list ordered by execution time */
-void add_event(timed_event *event, timed_event **event_list, timed_event **event_list_tail) {
-	timed_event *temp_event = NULL;
-	timed_event *first_event = NULL;
+/******************************************************************/
+/********************* EVENT QUEUE (HEAP) FUNCTIONS ***************/
+/******************************************************************/
 
-	log_debug_info(DEBUGL_FUNCTIONS, 0, "add_event()\n");
+/* returns TRUE if event a has to run before event b */
+static int event_runs_before(void *a, void *b) {
+	timed_event *event_a = (timed_event *)a;
+	timed_event *event_b = (timed_event *)b;
 
-	event->next = NULL;
-	event->prev = NULL;
+	if (event_a->run_time != event_b->run_time)
+		return (event_a->run_time < event_b->run_time) ? TRUE : FALSE;
 
-	first_event = *event_list;
+	/* events with the same run time are executed in the order they were added */
+	return (event_a->queue_seq < event_b->queue_seq) ? TRUE : FALSE;
+}
 
-	/* add the event to the head of the list if there are no other events */
-	if (*event_list == NULL) {
-		*event_list = event;
-		*event_list_tail = event;
-	}
 
-	/* add event to head of the list if it should be executed first */
-	else if (event->run_time < first_event->run_time) {
-		event->prev = NULL;
-		(*event_list)->prev = event;
-		event->next = *event_list;
-		*event_list = event;
-	}
+/* remembers the heap slot of an event */
+static void set_event_queue_pos(void *event, unsigned int pos) {
 
-	/* else place the event according to next execution time */
-	else {
+	((timed_event *)event)->queue_pos = pos;
+}
 
-		/* start from the end of the list, as new events are likely to be executed in the future, rather than now... */
-		for (temp_event = *event_list_tail; temp_event != NULL; temp_event = temp_event->prev) {
-			if (event->run_time >= temp_event->run_time) {
-				event->next = temp_event->next;
-				event->prev = temp_event;
-				temp_event->next = event;
-				if (event->next == NULL)
-					*event_list_tail = event;
-				else
-					event->next->prev = event;
-				break;
-			} else if (temp_event->prev == NULL) {
-				temp_event->prev = event;
-				event->next = temp_event;
-				*event_list = event;
-				break;
-			}
-		}
+
+/* returns the heap of an event queue, the queues are globals and get their callbacks on first use */
+static minheap *get_event_heap(timed_event_queue *event_queue) {
+
+	if (event_queue->heap.comes_before == NULL)
+		minheap_init(&event_queue->heap, event_runs_before, set_event_queue_pos);
+
+	return &event_queue->heap;
+}
+
+
+/* returns TRUE if the event currently lives in the given queue */
+static int event_is_queued(timed_event *event, timed_event_queue *event_queue) {
+
+	return minheap_contains(&event_queue->heap, event, event->queue_pos);
+}
+
+
+/* add an event to the queue ordered by execution time */
+void add_event(timed_event *event, timed_event_queue *event_queue) {
+
+	log_debug_info(DEBUGL_FUNCTIONS, 0, "add_event()\n");
+
+	event->queue_seq = event_queue->next_seq++;
+
+	/* the event is already queued (its run time changed), so just move it to its new position */
+	if (event_is_queued(event, event_queue) == TRUE)
+		minheap_update(get_event_heap(event_queue), event->queue_pos);
+
+	else if (minheap_insert(get_event_heap(event_queue), event) == ERROR) {
+		logit(NSLOG_RUNTIME_ERROR, TRUE, "Error: Could not allocate memory for event queue!\n");
+		return;
 	}
 
 #ifdef USE_EVENT_BROKER
@@ -1093,8 +1100,7 @@ void add_event(timed_event *event, timed_event **event_list, timed_event **event
 
 
 /* remove an event from the queue */
-void remove_event(timed_event *event, timed_event **event_list, timed_event **event_list_tail) {
-	timed_event *prev_event, *next_event;
+void remove_event(timed_event *event, timed_event_queue *event_queue) {
 
 	log_debug_info(DEBUGL_FUNCTIONS, 0, "remove_event()\n");
 
@@ -1106,41 +1112,80 @@ void remove_event(timed_event *event, timed_event **event_list, timed_event **ev
 	broker_timed_event(NEBTYPE_TIMEDEVENT_REMOVE, NEBFLAG_NONE, NEBATTR_NONE, event, NULL);
 #endif
 
-	if (*event_list == NULL)
-		return;
-
 	/*
-	 * the event struct already holds next+prev ptrs
-	 * for the doubly linked list, so fetch them
-	 * and reassign previous with next, and reverse
-	 * check #2183 for a detailed description
+	 * events keep their heap slot in queue_pos, so they can be
+	 * removed without searching the queue. events that are not
+	 * (or no longer) in this queue are ignored, see #2183
 	 */
-	prev_event = event->prev;
-	next_event = event->next;
+	if (event_is_queued(event, event_queue) == FALSE)
+		return;
 
-	if (prev_event) {
-		prev_event->next = next_event;
-	}
-	if (next_event) {
-		next_event->prev = prev_event;
-	}
+	minheap_delete(get_event_heap(event_queue), event->queue_pos);
 
-	/* re-assign head and tail */
-	if (!prev_event) {
-		/* no previous event, so "next" is now first in list */
-		*event_list = next_event;
-	}
-	if (!next_event) {
-		/* no following event, so "prev" is now last in list */
-		*event_list_tail = prev_event;
+	return;
+}
+
+
+/* returns the event that will be executed first, without removing it from the queue */
+timed_event *get_next_event(timed_event_queue *event_queue) {
+
+	return (timed_event *)minheap_peek(&event_queue->heap);
+}
+
+
+/* removes and returns the event that will be executed first */
+timed_event *pop_next_event(timed_event_queue *event_queue) {
+
+	return (timed_event *)minheap_pop(get_event_heap(event_queue));
+}
+
+
+/* qsort() callback for ordering events by execution time */
+static int compare_timed_events(const void *a, const void *b) {
+	timed_event *event_a = *(timed_event **)a;
+	timed_event *event_b = *(timed_event **)b;
+
+	if (event_a == event_b)
+		return 0;
+
+	return (event_runs_before(event_a, event_b) == TRUE) ? -1 : 1;
+}
+
+
+/* returns a NULL-terminated copy of the queue ordered by execution time - caller frees the array (not the events) */
+timed_event **get_sorted_event_list(timed_event_queue *event_queue) {
+	timed_event **sorted_events = NULL;
+	unsigned int x = 0;
+
+	sorted_events = (timed_event **)malloc((event_queue->heap.count + 1) * sizeof(timed_event *));
+	if (sorted_events == NULL)
+		return NULL;
+
+	for (x = 0; x < event_queue->heap.count; x++)
+		sorted_events[x] = (timed_event *)event_queue->heap.items[x + 1];
+	qsort(sorted_events, event_queue->heap.count, sizeof(timed_event *), compare_timed_events);
+	sorted_events[event_queue->heap.count] = NULL;
+
+	return sorted_events;
+}
+
+
+/* frees all events in a queue along with the queue itself */
+void free_event_queue(timed_event_queue *event_queue) {
+	timed_event *this_event = NULL;
+	unsigned int x = 0;
+
+	for (x = 1; x <= event_queue->heap.count; x++) {
+		this_event = (timed_event *)event_queue->heap.items[x];
+		if (this_event->event_type == EVENT_SCHEDULED_DOWNTIME)
+			my_free(this_event->event_data);
+		my_free(this_event);
 	}
 
-	/*
-	 * If there was only one event in the list,
-	 * it's done just as if there were events before
-	 * and after the deleted event.
-	 * head and tail pointers are now NULL in this case
-	 */
+	minheap_free(&event_queue->heap);
+	event_queue->next_seq = 0L;
+
+	return;
 }
 
 
@@ -1148,6 +1193,8 @@ void remove_event(timed_event *event, timed_event **event_list, timed_event **ev
 /* this is the main event handler loop */
 int event_execution_loop(void) {
 	timed_event *temp_event = NULL;
+	timed_event *next_high_event = NULL;
+	timed_event *next_low_event = NULL;
 	timed_event sleep_event;
 	time_t last_time = 0L;
 	time_t current_time = 0L;
@@ -1180,8 +1227,8 @@ int event_execution_loop(void) {
 	sleep_event.event_data = NULL;
 	sleep_event.event_args = NULL;
 	sleep_event.event_options = 0;
-	sleep_event.next = NULL;
-	sleep_event.prev = NULL;
+	sleep_event.queue_pos = 0;
+	sleep_event.queue_seq = 0L;
 
 	while (1) {
 
@@ -1195,8 +1242,11 @@ int event_execution_loop(void) {
 		if (sigshutdown == TRUE || sigrestart == TRUE)
 			break;
 
+		next_high_event = get_next_event(&event_queue_high);
+		next_low_event = get_next_event(&event_queue_low);
+
 		/* if we don't have any events to handle, exit */
-		if (event_list_high == NULL && event_list_low == NULL) {
+		if (next_high_event == NULL && next_low_event == NULL) {
 			log_debug_info(DEBUGL_EVENTS, 0, "没有任何需要处理的事件!退出...\n");
 			break;
 		}
@@ -1212,16 +1262,20 @@ int event_execution_loop(void) {
 		else if ((current_time - last_time) >= time_change_threshold)
 			compensate_for_system_time_change((unsigned long)last_time, (unsigned long)current_time);
 
+		/* compensating may have reordered the queues */
+		next_high_event = get_next_event(&event_queue_high);
+		next_low_event = get_next_event(&event_queue_low);
+
 		/* keep track of the last time */
 		last_time = current_time;
 
 		log_debug_info(DEBUGL_EVENTS, 1, "** 事件循环校验\n");
-		if (event_list_high != NULL)
-			log_debug_info(DEBUGL_EVENTS, 1, "下一个高优先级事件时间: %s", ctime(&event_list_high->run_time));
+		if (next_high_event != NULL)
+			log_debug_info(DEBUGL_EVENTS, 1, "下一个高优先级事件时间: %s", ctime(&next_high_event->run_time));
 		else
 			log_debug_info(DEBUGL_EVENTS, 1, "没有安排高优先级事件...\n");
-		if (event_list_low != NULL)
-			log_debug_info(DEBUGL_EVENTS, 1, "下一个低优先级事件时间:  %s", ctime(&event_list_low->run_time));
+		if (next_low_event != NULL)
+			log_debug_info(DEBUGL_EVENTS, 1, "下一个低优先级事件时间:  %s", ctime(&next_low_event->run_time));
 		else
 			log_debug_info(DEBUGL_EVENTS, 1, "没有安排低优先级事件...\n");
 		log_debug_info(DEBUGL_EVENTS, 1, "目前/最大服务检查: %d/%d\n", currently_running_service_checks, max_parallel_service_checks);
@@ -1231,23 +1285,21 @@ int event_execution_loop(void) {
 			while ((wait_result = waitpid(-1, NULL, WNOHANG)) > 0);
 		}
 
+		/* finish notifications and event handlers the check workers have run and start queued ones */
+		handle_async_commands();
+
 		/* handle high priority events */
-		if (event_list_high != NULL && (current_time >= event_list_high->run_time)) {
+		if (next_high_event != NULL && (current_time >= next_high_event->run_time)) {
 
 			/* remove the first event from the timing loop */
-			temp_event = event_list_high;
-			event_list_high = event_list_high->next;
-
-			/* we may have just removed the only item from the list */
-			if (event_list_high != NULL)
-				event_list_high->prev = NULL;
+			temp_event = pop_next_event(&event_queue_high);
 
 			/* handle the event */
 			handle_timed_event(temp_event);
 
 			/* reschedule the event if necessary */
 			if (temp_event->recurring == TRUE)
-				reschedule_event(temp_event, &event_list_high, &event_list_high_tail);
+				reschedule_event(temp_event, &event_queue_high);
 
 			/* else free memory associated with the event */
 			else
@@ -1273,16 +1325,16 @@ int event_execution_loop(void) {
 		*/
 
 		/* handle low priority events */
-		else if (event_list_low != NULL && (current_time >= event_list_low->run_time)) {
+		else if (next_low_event != NULL && (current_time >= next_low_event->run_time)) {
 
 			/* default action is to execute the event */
 			run_event = TRUE;
 			nudge_seconds = 0;
 
 			/* run a few checks before executing a service check... */
-			if (event_list_low->event_type == EVENT_SERVICE_CHECK) {
+			if (next_low_event->event_type == EVENT_SERVICE_CHECK) {
 
-				temp_service = (service *)event_list_low->event_data;
+				temp_service = (service *)next_low_event->event_data;
 
 				log_debug_info(DEBUGL_EVENTS | DEBUGL_CHECKS, 1, "Run a few checks before executing a service check for '%s'.\n", temp_service->description);
 
@@ -1315,11 +1367,8 @@ int event_execution_loop(void) {
 					/* remove the service check from the event queue and reschedule it for a later time */
 					/* 12/20/05 since event was not executed, it needs to be remove()'ed to maintain sync with event broker modules */
 					log_debug_info(DEBUGL_EVENTS | DEBUGL_CHECKS, 1, "跳过事件, 从列表移除服务 '%s'.\n", temp_service->description);
-					temp_event = event_list_low;
-					remove_event(temp_event, &event_list_low, &event_list_low_tail);
-					/*
-					event_list_low=event_list_low->next;
-					*/
+					temp_event = next_low_event;
+					remove_event(temp_event, &event_queue_low);
 					if (nudge_seconds) {
 						/* We nudge the next check time when it is due to too many concurrent service checks */
 						temp_service->next_check = (time_t)(temp_service->next_check + nudge_seconds);
@@ -1332,7 +1381,7 @@ int event_execution_loop(void) {
 					}
 
 					temp_event->run_time = temp_service->next_check;
-					reschedule_event(temp_event, &event_list_low, &event_list_low_tail);
+					reschedule_event(temp_event, &event_queue_low);
 					update_service_status(temp_service, FALSE);
 
 					run_event = FALSE;
@@ -1341,9 +1390,9 @@ int event_execution_loop(void) {
 			}
 
 			/* run a few checks before executing a host check... */
-			else if (event_list_low->event_type == EVENT_HOST_CHECK) {
+			else if (next_low_event->event_type == EVENT_HOST_CHECK) {
 
-				temp_host = (host *)event_list_low->event_data;
+				temp_host = (host *)next_low_event->event_data;
 
 				log_debug_info(DEBUGL_EVENTS | DEBUGL_CHECKS, 1, "Run a few checks before executing a host check for '%s'.\n", temp_host->name);
 
@@ -1365,18 +1414,15 @@ int event_execution_loop(void) {
 					/* remove the host check from the event queue and reschedule it for a later time */
 					/* 12/20/05 since event was not executed, it needs to be remove()'ed to maintain sync with event broker modules */
 					log_debug_info(DEBUGL_EVENTS | DEBUGL_CHECKS, 1, "Skip event, removing host '%s' from list.\n", temp_host->name);
-					temp_event = event_list_low;
-					remove_event(temp_event, &event_list_low, &event_list_low_tail);
-					/*
-					event_list_low=event_list_low->next;
-					*/
+					temp_event = next_low_event;
+					remove_event(temp_event, &event_queue_low);
 					if (temp_host->state_type == SOFT_STATE && temp_host->current_state != STATE_OK)
 						temp_host->next_check = (time_t)(temp_host->next_check + (temp_host->retry_interval * interval_length));
 					else
 						temp_host->next_check = (time_t)(temp_host->next_check + (temp_host->check_interval * interval_length));
 
 					temp_event->run_time = temp_host->next_check;
-					reschedule_event(temp_event, &event_list_low, &event_list_low_tail);
+					reschedule_event(temp_event, &event_queue_low);
 					update_host_status(temp_host, FALSE);
 
 					run_event = FALSE;
@@ -1387,11 +1433,7 @@ int event_execution_loop(void) {
 			if (run_event == TRUE) {
 
 				/* remove the first event from the timing loop */
-				temp_event = event_list_low;
-				event_list_low = event_list_low->next;
-				/* we may have just removed the only item from the list */
-				if (event_list_low != NULL)
-					event_list_low->prev = NULL;
+				temp_event = pop_next_event(&event_queue_low);
 
 				log_debug_info(DEBUGL_EVENTS, 1, "运行事件...\n");
 
@@ -1400,7 +1442,7 @@ int event_execution_loop(void) {
 
 				/* reschedule the event if necessary */
 				if (temp_event->recurring == TRUE)
-					reschedule_event(temp_event, &event_list_low, &event_list_low_tail);
+					reschedule_event(temp_event, &event_queue_low);
 
 				/* else free memory associated with the event */
 				else
@@ -1410,7 +1452,7 @@ int event_execution_loop(void) {
 		}
 
 		/* we don't have anything to do at this moment in time... */
-		else if ((event_list_high == NULL || (current_time < event_list_high->run_time)) && (event_list_low == NULL || (current_time < event_list_low->run_time))) {
+		else if ((next_high_event == NULL || (current_time < next_high_event->run_time)) && (next_low_event == NULL || (current_time < next_low_event->run_time))) {
 
 			log_debug_info(DEBUGL_EVENTS, 2, "No events to execute at the moment.  Idling for a bit...\n");
 
@@ -1729,6 +1771,8 @@ int handle_timed_event(timed_event *event) {
 
 /* adjusts scheduling of host and service checks */
 void adjust_check_scheduling(void) {
+	timed_event **sorted_events = NULL;
+	timed_event **event_ptr = NULL;
 	timed_event *temp_event = NULL;
 	service *temp_service = NULL;
 	host *temp_host = NULL;
@@ -1764,8 +1808,12 @@ void adjust_check_scheduling(void) {
 	first_window_time = current_time;
 	last_window_time = first_window_time + auto_rescheduling_window;
 
+	/* walk the low priority events in order of execution */
+	if ((sorted_events = get_sorted_event_list(&event_queue_low)) == NULL)
+		return;
+
 	/* get current scheduling data */
-	for (temp_event = event_list_low; temp_event != NULL; temp_event = temp_event->next) {
+	for (event_ptr = sorted_events; (temp_event = *event_ptr) != NULL; event_ptr++) {
 
 		/* skip events outside of our current window */
 		if (temp_event->run_time <= first_window_time)
@@ -1833,6 +1881,7 @@ void adjust_check_scheduling(void) {
 		printf("EXEC TIME:   %.3f\n",total_check_exec_time);
 		*/
 
+		my_free(sorted_events);
 		return;
 	}
 
@@ -1855,7 +1904,7 @@ void adjust_check_scheduling(void) {
 
 	/* adjust check scheduling */
 	current_icd_offset = (inter_check_delay / 2.0);
-	for (temp_event = event_list_low; temp_event != NULL; temp_event = temp_event->next) {
+	for (event_ptr = sorted_events; (temp_event = *event_ptr) != NULL; event_ptr++) {
 
 		/* skip events outside of our current window */
 		if (temp_event->run_time <= first_window_time)
@@ -1917,8 +1966,10 @@ void adjust_check_scheduling(void) {
 		current_exec_time_offset += current_exec_time;
 	}
 
-	/* resort event list (some events may be out of order at this point) */
-	resort_event_list(&event_list_low, &event_list_low_tail);
+	my_free(sorted_events);
+
+	/* resort event queue (some events may be out of order at this point) */
+	resort_event_queue(&event_queue_low);
 
 	log_debug_info(DEBUGL_FUNCTIONS, 0, "adjust_check_scheduling() end\n");
 
@@ -1931,6 +1982,7 @@ void adjust_check_scheduling(void) {
 void compensate_for_system_time_change(unsigned long last_time, unsigned long current_time) {
 	unsigned long time_difference = 0L;
 	timed_event *temp_event = NULL;
+	unsigned int x = 0;
 	service *temp_service = NULL;
 	host *temp_host = NULL;
 	int days = 0;
@@ -1960,7 +2012,9 @@ void compensate_for_system_time_change(unsigned long last_time, unsigned long cu
 	logit(NSLOG_PROCESS_INFO | NSLOG_RUNTIME_WARNING, TRUE, "Warning: A system time change of %dd %dh %dm %ds (%s in time) has been detected.  Compensating...\n", days, hours, minutes, seconds, (last_time > current_time) ? "backwards" : "forwards");
 
 	/* adjust the next run time for all high priority timed events */
-	for (temp_event = event_list_high; temp_event != NULL; temp_event = temp_event->next) {
+	for (x = 1; x <= event_queue_high.heap.count; x++) {
+
+		temp_event = (timed_event *)event_queue_high.heap.items[x];
 
 		/* skip special events that occur at specific times... */
 		if (temp_event->compensate_for_time_change == FALSE)
@@ -1977,11 +2031,13 @@ void compensate_for_system_time_change(unsigned long last_time, unsigned long cu
 			adjust_timestamp_for_time_change(last_time, current_time, time_difference, &temp_event->run_time);
 	}
 
-	/* resort event list (some events may be out of order at this point) */
-	resort_event_list(&event_list_high, &event_list_high_tail);
+	/* resort event queue (some events may be out of order at this point) */
+	resort_event_queue(&event_queue_high);
 
 	/* adjust the next run time for all low priority timed events */
-	for (temp_event = event_list_low; temp_event != NULL; temp_event = temp_event->next) {
+	for (x = 1; x <= event_queue_low.heap.count; x++) {
+
+		temp_event = (timed_event *)event_queue_low.heap.items[x];
 
 		/* skip special events that occur at specific times... */
 		if (temp_event->compensate_for_time_change == FALSE)
@@ -1998,8 +2054,8 @@ void compensate_for_system_time_change(unsigned long last_time, unsigned long cu
 			adjust_timestamp_for_time_change(last_time, current_time, time_difference, &temp_event->run_time);
 	}
 
-	/* resort event list (some events may be out of order at this point) */
-	resort_event_list(&event_list_low, &event_list_low_tail);
+	/* resort event queue (some events may be out of order at this point) */
+	resort_event_queue(&event_queue_low);
 
 	/* adjust service timestamps */
 	for (temp_service = service_list; temp_service != NULL; temp_service = temp_service->next) {
@@ -2047,27 +2103,12 @@ void compensate_for_system_time_change(unsigned long last_time, unsigned long cu
 
 
 
-/* resorts an event list by event execution time - needed when compensating for system time changes */
-void resort_event_list(timed_event **event_list, timed_event **event_list_tail) {
-	timed_event *temp_event_list = NULL;
-	timed_event *temp_event = NULL;
-	timed_event *next_event = NULL;
-
-	log_debug_info(DEBUGL_FUNCTIONS, 0, "resort_event_list()\n");
+/* resorts an event queue by event execution time - needed when compensating for system time changes */
+void resort_event_queue(timed_event_queue *event_queue) {
 
-	/* move current event list to temp list */
-	temp_event_list = *event_list;
-	*event_list = NULL;
+	log_debug_info(DEBUGL_FUNCTIONS, 0, "resort_event_queue()\n");
 
-	/* move all events to the new event list */
-	for (temp_event = temp_event_list; temp_event != NULL; temp_event = next_event) {
-		next_event = temp_event->next;
-
-		/* add the event to the newly created event list so it will be resorted */
-		temp_event->next = NULL;
-		temp_event->prev = NULL;
-		add_event(temp_event, event_list, event_list_tail);
-	}
+	minheap_heapify(get_event_heap(event_queue));
 
 	return;
 }
@@ -230,8 +230,12 @@ double          high_host_flap_threshold = DEFAULT_HIGH_HOST_FLAP_THRESHOLD;
 
 int             use_large_installation_tweaks = DEFAULT_USE_LARGE_INSTALLATION_TWEAKS;
 int             enable_environment_macros = TRUE;
+int             lazy_environment_macros = FALSE;
 int             free_child_process_memory = -1;
 int             child_processes_fork_twice = -1;
+int             check_worker_processes = DEFAULT_CHECK_WORKER_PROCESSES;
+int             check_result_reaper_threads = DEFAULT_CHECK_RESULT_REAPER_THREADS;
+int             max_async_commands = DEFAULT_MAX_ASYNC_COMMANDS;
 
 int             enable_embedded_perl = DEFAULT_ENABLE_EMBEDDED_PERL;
 int             use_embedded_perl_implicitly = DEFAULT_USE_EMBEDDED_PERL_IMPLICITLY;
@@ -248,7 +252,6 @@ char            *use_timezone = NULL;
 int             allow_empty_hostgroup_assignment = DEFAULT_ALLOW_EMPTY_HOSTGROUP_ASSIGNMENT;
 
 int             command_file_fd;
-FILE            *command_file_fp;
 int             command_file_created = FALSE;
 
 /* make sure gcc3 won't hit here */
@@ -265,11 +268,14 @@ extern command         *command_list;
 extern timeperiod      *timeperiod_list;
 extern serviceescalation *serviceescalation_list;
 extern module          *module_list;
+extern int             object_hash_profiling;
 
 notification    *notification_list;
 
 check_result    check_result_info;
-check_result    *check_result_list = NULL;
+check_result_queue check_result_list;
+unsigned long   check_result_channel_stats[CHECK_RESULT_CHANNELS];
+async_command_stats async_command_statistics;
 unsigned long	max_check_result_file_age = DEFAULT_MAX_CHECK_RESULT_AGE;
 
 dbuf            check_result_dbuf;
@@ -445,6 +451,7 @@ int main(int argc, char **argv, char **env) {
 		printf("Options:\n");
 		printf("\n");
 		printf("  -v, --verify-config          Verify all configuration data\n");
+		printf("                               Use -v -v to also show object config processing times\n");
 		printf("  -s, --test-scheduling        Shows projected/recommended check scheduling and other\n");
 		printf("                               diagnostic info based on the current configuration files.\n");
 		printf("  -S, --show-scheduling        Same as -s, but also show the scheduling queue\n");
@@ -686,6 +693,12 @@ int main(int argc, char **argv, char **env) {
 				exit(EXIT_FAILURE);
 			}
 
+			/* make sure gcc3 won't hit here */
+#ifndef GCCTOOOLD
+			/* time object lookups only when the profiler is on */
+			object_hash_profiling = event_profiling_enabled;
+#endif
+
 			/* we need to read the modules in the first place as object configuration before neb modules are initialized/loaded */
 			result = read_object_config_data(config_file, READ_MODULES, FALSE, FALSE);
 
@@ -874,6 +887,12 @@ int main(int argc, char **argv, char **env) {
 			/* initialize check statistics */
 			init_check_stats();
 
+			/* create the channel forked checks send their results through */
+			open_check_result_channel();
+
+			/* start the check worker processes */
+			init_check_workers();
+
 			/* update all status data (with retained information) */
 			update_all_status_data();
 
@@ -903,6 +922,9 @@ int main(int argc, char **argv, char **env) {
 			/* (doesn't return until a restart or shutdown signal is encountered) */
 			event_execution_loop();
 
+			/* stop the check worker processes */
+			shutdown_check_workers();
+
 			/* 03/01/2007 EG Moved from sighandler() to prevent FUTEX locking problems under NPTL */
 			/* 03/21/2007 EG SIGSEGV signals are still logged in sighandler() so we don't loose them */
 			/* did we catch a signal? */
@@ -947,8 +969,14 @@ int main(int argc, char **argv, char **env) {
 			if (sigrestart == FALSE) {
 				shutdown_command_file_worker_thread();
 				close_command_file();
+
+				/* close the check result channel */
+				close_check_result_channel();
 			}
 
+			/* stop the check result reaper threads, they are started again with the configured number */
+			shutdown_check_result_reaper_threads();
+
 			/* cleanup embedded perl interpreter */
 			if (sigrestart == FALSE)
 				deinit_embedded_perl();
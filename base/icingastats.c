@@ -204,6 +204,23 @@ int total_external_command_buffer_slots = 0;
 int used_external_command_buffer_slots = 0;
 int high_external_command_buffer_slots = 0;
 
+int check_result_list_length = 0;
+int high_check_result_list_length = 0;
+
+unsigned long spool_check_results = 0L;
+unsigned long pipe_check_results = 0L;
+unsigned long worker_check_results = 0L;
+unsigned long external_command_check_results = 0L;
+
+int queued_async_commands = 0;
+int running_async_commands = 0;
+int high_queued_async_commands = 0;
+unsigned long completed_async_commands = 0L;
+unsigned long timed_out_async_commands = 0L;
+double average_async_command_queue_latency = 0.0;
+double max_async_command_queue_latency = 0.0;
+double average_async_command_execution_time = 0.0;
+
 /* make sure gcc3 won't hit here */
 #ifndef GCCTOOOLD
 int event_profiling_enabled = 0;
@@ -355,6 +372,8 @@ int main(int argc, char **argv) {
 		printf(" TOTCMDBUF            total number of external command buffer slots available.\n");
 		printf(" USEDCMDBUF           number of external command buffer slots currently in use.\n");
 		printf(" HIGHCMDBUF           highest number of external command buffer slots ever in use.\n");
+		printf(" CHECKRESULTS         number of check results waiting to be handled by the reaper.\n");
+		printf(" HIGHCHECKRESULTS     highest number of check results ever waiting to be handled.\n");
 		printf(" NUMSERVICES          total number of services.\n");
 		printf(" NUMHOSTS             total number of hosts.\n");
 		printf(" NUMSVCOK             number of services OK.\n");
@@ -403,6 +422,15 @@ int main(int argc, char **argv) {
 		printf(" NUMSACTSVCCHECKSxM   number of scheduled active service checks occuring in last 1/5/15 minutes.\n");
 		printf(" NUMPSVSVCCHECKSxM    number of passive service checks occuring in last 1/5/15 minutes.\n");
 		printf(" NUMEXTCMDSxM         number of external commands processed in last 1/5/15 minutes.\n");
+		printf(" NUMSPOOLRESULTS      number of check results read from the check result queue directory.\n");
+		printf(" NUMPIPERESULTS       number of check results received through the in-memory check result channel.\n");
+		printf(" NUMWORKERRESULTS     number of check results received from check worker processes.\n");
+		printf(" NUMEXTCMDRESULTS     number of passive check results received through external commands.\n");
+		printf(" NUMASYNCCMDSQUEUED   number of notification/event handler/OCSP/OCHP commands waiting for a check worker.\n");
+		printf(" NUMASYNCCMDSRUNNING  number of notification/event handler/OCSP/OCHP commands running in check workers.\n");
+		printf(" NUMASYNCCMDSDONE     number of notification/event handler/OCSP/OCHP commands run by check workers.\n");
+		printf(" xxxASYNCCMDLAT       MAX/AVG time commands waited for a check worker (ms).\n");
+		printf(" AVGASYNCCMDEXT       AVG execution time of commands run by check workers (ms).\n");
 
 		/* make sure gcc3 won't hit here */
 #ifndef GCCTOOOLD
@@ -527,6 +555,10 @@ int display_mrtg_values(void) {
 			printf("%d%s", used_external_command_buffer_slots, mrtg_delimiter);
 		else if (!strcmp(temp_ptr, "HIGHCMDBUF"))
 			printf("%d%s", high_external_command_buffer_slots, mrtg_delimiter);
+		else if (!strcmp(temp_ptr, "CHECKRESULTS"))
+			printf("%d%s", check_result_list_length, mrtg_delimiter);
+		else if (!strcmp(temp_ptr, "HIGHCHECKRESULTS"))
+			printf("%d%s", high_check_result_list_length, mrtg_delimiter);
 
 		else if (!strcmp(temp_ptr, "NUMSERVICES"))
 			printf("%d%s", status_service_entries, mrtg_delimiter);
@@ -753,6 +785,30 @@ int display_mrtg_values(void) {
 		else if (!strcmp(temp_ptr, "NUMEXTCMDS15M"))
 			printf("%d%s", external_commands_last_15min, mrtg_delimiter);
 
+		/* check result channel stats */
+		else if (!strcmp(temp_ptr, "NUMSPOOLRESULTS"))
+			printf("%lu%s", spool_check_results, mrtg_delimiter);
+		else if (!strcmp(temp_ptr, "NUMPIPERESULTS"))
+			printf("%lu%s", pipe_check_results, mrtg_delimiter);
+		else if (!strcmp(temp_ptr, "NUMWORKERRESULTS"))
+			printf("%lu%s", worker_check_results, mrtg_delimiter);
+		else if (!strcmp(temp_ptr, "NUMEXTCMDRESULTS"))
+			printf("%lu%s", external_command_check_results, mrtg_delimiter);
+
+		/* asynchronous command stats */
+		else if (!strcmp(temp_ptr, "NUMASYNCCMDSQUEUED"))
+			printf("%d%s", queued_async_commands, mrtg_delimiter);
+		else if (!strcmp(temp_ptr, "NUMASYNCCMDSRUNNING"))
+			printf("%d%s", running_async_commands, mrtg_delimiter);
+		else if (!strcmp(temp_ptr, "NUMASYNCCMDSDONE"))
+			printf("%lu%s", completed_async_commands, mrtg_delimiter);
+		else if (!strcmp(temp_ptr, "MAXASYNCCMDLAT"))
+			printf("%d%s", (int)(max_async_command_queue_latency * 1000), mrtg_delimiter);
+		else if (!strcmp(temp_ptr, "AVGASYNCCMDLAT"))
+			printf("%d%s", (int)(average_async_command_queue_latency * 1000), mrtg_delimiter);
+		else if (!strcmp(temp_ptr, "AVGASYNCCMDEXT"))
+			printf("%d%s", (int)(average_async_command_execution_time * 1000), mrtg_delimiter);
+
 		/* service states */
 		else if (!strcmp(temp_ptr, "NUMSVCOK"))
 			printf("%d%s", services_ok, mrtg_delimiter);
@@ -835,6 +891,7 @@ int display_stats(void) {
 	printf("应用程序运行时间:                   %dd %dh %dm %ds\n", days, hours, minutes, seconds);
 	printf("%s PID:                             %lu\n", PROGRAM_NAME, nagios_pid);
 	printf("使用/高/总共命令缓冲器:        %d / %d / %d\n", used_external_command_buffer_slots, high_external_command_buffer_slots, total_external_command_buffer_slots);
+	printf("使用/高检查结果队列:            %d / %d\n", check_result_list_length, high_check_result_list_length);
 	printf("\n");
 	printf("总计服务:                         %d\n", status_service_entries);
 	printf("检查服务:                       %d\n", services_checked);
@@ -886,6 +943,13 @@ int display_stats(void) {
 	printf("\n");
 	printf("额外命令 最近1/5/15分钟:      %d / %d / %d\n", external_commands_last_1min, external_commands_last_5min, external_commands_last_15min);
 	printf("\n");
+	printf("检查结果 队列目录/管道/工作进程/额外命令: %lu / %lu / %lu / %lu\n", spool_check_results, pipe_check_results, worker_check_results, external_command_check_results);
+	printf("\n");
+	printf("异步命令 排队/高/运行:          %d / %d / %d\n", queued_async_commands, high_queued_async_commands, running_async_commands);
+	printf("异步命令 完成/超时:             %lu / %lu\n", completed_async_commands, timed_out_async_commands);
+	printf("异步命令 排队延迟 最大/平均:    %.3f / %.3f sec\n", max_async_command_queue_latency, average_async_command_queue_latency);
+	printf("异步命令 平均执行时间:          %.3f sec\n", average_async_command_execution_time);
+	printf("\n");
 	printf("\n");
 
 	/* make sure gcc3 won't hit here */
@@ -1273,6 +1337,10 @@ int read_status_file(void) {
 					used_external_command_buffer_slots = atoi(val);
 				else if (!strcmp(var, "high_external_command_buffer_slots"))
 					high_external_command_buffer_slots = atoi(val);
+				else if (!strcmp(var, "check_result_list_length"))
+					check_result_list_length = atoi(val);
+				else if (!strcmp(var, "high_check_result_list_length"))
+					high_check_result_list_length = atoi(val);
 				else if (!strcmp(var, "icinga_pid"))
 					nagios_pid = strtoul(val, NULL, 10);
 				else if (!strcmp(var, "active_scheduled_host_check_stats")) {
@@ -1352,7 +1420,32 @@ int read_status_file(void) {
 						serial_host_checks_last_5min = atoi(temp_ptr);
 					if ((temp_ptr = strtok(NULL, ",")))
 						serial_host_checks_last_15min = atoi(temp_ptr);
-				} else if (!strcmp(var, "event_profiling_enabled")) {
+				} else if (!strcmp(var, "spool_check_results"))
+					spool_check_results = strtoul(val, NULL, 10);
+				else if (!strcmp(var, "pipe_check_results"))
+					pipe_check_results = strtoul(val, NULL, 10);
+				else if (!strcmp(var, "worker_check_results"))
+					worker_check_results = strtoul(val, NULL, 10);
+				else if (!strcmp(var, "external_command_check_results"))
+					external_command_check_results = strtoul(val, NULL, 10);
+				else if (!strcmp(var, "queued_async_commands"))
+					queued_async_commands = atoi(val);
+				else if (!strcmp(var, "running_async_commands"))
+					running_async_commands = atoi(val);
+				else if (!strcmp(var, "high_queued_async_commands"))
+					high_queued_async_commands = atoi(val);
+				else if (!strcmp(var, "completed_async_commands"))
+					completed_async_commands = strtoul(val, NULL, 10);
+				else if (!strcmp(var, "timed_out_async_commands"))
+					timed_out_async_commands = strtoul(val, NULL, 10);
+				else if (!strcmp(var, "async_command_queue_latency")) {
+					if ((temp_ptr = strtok(val, ",")))
+						average_async_command_queue_latency = strtod(temp_ptr, NULL);
+					if ((temp_ptr = strtok(NULL, ",")))
+						max_async_command_queue_latency = strtod(temp_ptr, NULL);
+				} else if (!strcmp(var, "async_command_execution_time"))
+					average_async_command_execution_time = strtod(val, NULL);
+				else if (!strcmp(var, "event_profiling_enabled")) {
 					/* make sure gcc3 won't hit here */
 #ifndef GCCTOOOLD
 					event_profiling_enabled = atoi(val);
@@ -1472,6 +1565,10 @@ int read_icingastats_file(void) {
 			used_external_command_buffer_slots = atoi(val);
 		else if (!strcmp(var, "high_external_command_buffer_slots"))
 			high_external_command_buffer_slots = atoi(val);
+		else if (!strcmp(var, "check_result_list_length"))
+			check_result_list_length = atoi(val);
+		else if (!strcmp(var, "high_check_result_list_length"))
+			high_check_result_list_length = atoi(val);
 		else if (!strcmp(var, "icinga_pid"))
 			nagios_pid = strtoul(val, NULL, 10);
 		else if (!strcmp(var, "active_scheduled_host_check_stats")) {
@@ -1551,7 +1648,31 @@ int read_icingastats_file(void) {
 				serial_host_checks_last_5min = atoi(temp_ptr);
 			if ((temp_ptr = strtok(NULL, ",")))
 				serial_host_checks_last_15min = atoi(temp_ptr);
-		}
+		} else if (!strcmp(var, "spool_check_results"))
+			spool_check_results = strtoul(val, NULL, 10);
+		else if (!strcmp(var, "pipe_check_results"))
+			pipe_check_results = strtoul(val, NULL, 10);
+		else if (!strcmp(var, "worker_check_results"))
+			worker_check_results = strtoul(val, NULL, 10);
+		else if (!strcmp(var, "external_command_check_results"))
+			external_command_check_results = strtoul(val, NULL, 10);
+		else if (!strcmp(var, "queued_async_commands"))
+			queued_async_commands = atoi(val);
+		else if (!strcmp(var, "running_async_commands"))
+			running_async_commands = atoi(val);
+		else if (!strcmp(var, "high_queued_async_commands"))
+			high_queued_async_commands = atoi(val);
+		else if (!strcmp(var, "completed_async_commands"))
+			completed_async_commands = strtoul(val, NULL, 10);
+		else if (!strcmp(var, "timed_out_async_commands"))
+			timed_out_async_commands = strtoul(val, NULL, 10);
+		else if (!strcmp(var, "async_command_queue_latency")) {
+			if ((temp_ptr = strtok(val, ",")))
+				average_async_command_queue_latency = strtod(temp_ptr, NULL);
+			if ((temp_ptr = strtok(NULL, ",")))
+				max_async_command_queue_latency = strtod(temp_ptr, NULL);
+		} else if (!strcmp(var, "async_command_execution_time"))
+			average_async_command_execution_time = strtod(val, NULL);
 
 		/***** HOST INFO *****/
 
@@ -29,6 +29,7 @@
 #include "../include/macros.h"
 #include "../include/icinga.h"
 #include "../include/broker.h"
+#include "../include/logindex.h"
 
 
 extern char	*log_file;
@@ -564,6 +565,10 @@ int rotate_log_file(time_t rotation_time) {
 		return ERROR;
 	}
 
+	/* index the archive, so the CGIs don't have to read all of it */
+	if (write_log_index(log_archive, NULL) == ERROR)
+		logit(NSLOG_RUNTIME_WARNING, TRUE, "警报: 无法为日志归档 '%s' 创建索引\n", log_archive);
+
 	/* record the log rotation after it has been done... */
 	dummy = asprintf(&temp_buffer, "日志回滚: %s\n", method_string);
 	write_to_all_logs_with_timestamp(temp_buffer, NSLOG_PROCESS_INFO, &rotation_time);
@@ -45,6 +45,7 @@ extern int             log_notifications;
 extern int             enable_notifications;
 
 extern int             notification_timeout;
+extern int             max_async_commands;
 
 extern unsigned long   next_notification_id;
 
@@ -70,6 +71,81 @@ const char *notification_reason_name (unsigned int reason_type) {
 	return "(未知)";
 }
 
+/******************************************************************/
+/************** ASYNCHRONOUS NOTIFICATION FUNCTIONS ***************/
+/******************************************************************/
+
+/* what is needed to finish a notification method run by a check worker */
+typedef struct async_notification_struct {
+	int notification_type;				/* HOST_NOTIFICATION or SERVICE_NOTIFICATION */
+	int reason_type;
+	void *object;
+	contact *cntct;
+	char *command;
+	char *not_author;
+	char *not_data;
+	int escalated;
+	struct timeval method_start_time;
+} async_notification;
+
+
+/* logs timeouts and sends the end of a notification method to the broker once a check worker has run it */
+static void finish_async_notification(void *data, char *processed_command, int result, int early_timeout, double exectime, struct timeval *end_time, char *output) {
+	async_notification *notification = (async_notification *)data;
+
+	/* check to see if the notification command timed out */
+	if (early_timeout == TRUE) {
+		if (notification->notification_type == SERVICE_NOTIFICATION)
+			logit(NSLOG_SERVICE_NOTIFICATION | NSLOG_RUNTIME_WARNING, TRUE, "警报: 联系人 '%s' 服务通知命令 '%s' 超时%d秒\n", notification->cntct->name, processed_command, notification_timeout);
+		else
+			logit(NSLOG_HOST_NOTIFICATION | NSLOG_RUNTIME_WARNING, TRUE, "Warning: Contact '%s' host notification command '%s' timed out after %d seconds\n", notification->cntct->name, processed_command, notification_timeout);
+	}
+
+#ifdef USE_EVENT_BROKER
+	/* send data to event broker, the method ended when the command did */
+	broker_contact_notification_method_data(NEBTYPE_CONTACTNOTIFICATIONMETHOD_END, NEBFLAG_NONE, NEBATTR_NONE, notification->notification_type, notification->reason_type, notification->method_start_time, *end_time, notification->object, notification->cntct, notification->command, notification->not_author, notification->not_data, notification->escalated, NULL);
+#endif
+
+	/* free memory */
+	my_free(notification->not_author);
+	my_free(notification->not_data);
+	my_free(notification);
+}
+
+
+/* hands a notification command to the check workers if asynchronous commands are enabled */
+static int run_async_notification(icinga_macros *mac, char *processed_command, int notification_type, int reason_type, void *object, contact *cntct, char *command, char *not_author, char *not_data, int escalated, struct timeval method_start_time) {
+	async_notification *notification = NULL;
+
+	if (max_async_commands <= 0)
+		return ERROR;
+
+	if ((notification = (async_notification *)calloc(1, sizeof(async_notification))) == NULL)
+		return ERROR;
+
+	notification->notification_type = notification_type;
+	notification->reason_type = reason_type;
+	notification->object = object;
+	notification->cntct = cntct;
+	notification->command = command;
+	if (not_author != NULL)
+		notification->not_author = (char *)strdup(not_author);
+	if (not_data != NULL)
+		notification->not_data = (char *)strdup(not_data);
+	notification->escalated = escalated;
+	notification->method_start_time = method_start_time;
+
+	if (run_async_command(mac, processed_command, notification_timeout, finish_async_notification, (void *)notification) == ERROR) {
+		my_free(notification->not_author);
+		my_free(notification->not_data);
+		my_free(notification);
+		return ERROR;
+	}
+
+	return OK;
+}
+
+
 /******************************************************************/
 /***************** SERVICE NOTIFICATION FUNCTIONS *****************/
 /******************************************************************/
@@ -842,7 +918,7 @@ int notify_contact_of_service(icinga_macros *mac, contact *cntct, service *svc,
 		log_debug_info(DEBUGL_NOTIFICATIONS, 2, "原始通知命令: %s\n", raw_command);
 
 		/* process any macros contained in the argument */
-		process_macros_r(mac, raw_command, &processed_command, macro_options);
+		process_command_macros_r(mac, temp_commandsmember->command_ptr, &processed_command, macro_options);
 		my_free(raw_command);
 		if (processed_command == NULL)
 			continue;
@@ -905,6 +981,13 @@ int notify_contact_of_service(icinga_macros *mac, contact *cntct, service *svc,
                         continue ;
 #endif
 
+		/* let a check worker run the notification command - the method ends once it has finished */
+		if (run_async_notification(mac, processed_command, SERVICE_NOTIFICATION, type, (void *)svc, cntct, temp_commandsmember->command, not_author, not_data, escalated, method_start_time) == OK) {
+			my_free(command_name);
+			my_free(processed_command);
+			continue;
+		}
+
 		/* run the notification command */
 		my_system_r(mac, processed_command, notification_timeout, &early_timeout, &exectime, NULL, 0);
 
@@ -1955,7 +2038,7 @@ int notify_contact_of_host(icinga_macros *mac, contact *cntct, host *hst, int ty
 		log_debug_info(DEBUGL_NOTIFICATIONS, 2, "原始通知命令: %s\n", raw_command);
 
 		/* process any macros contained in the argument */
-		process_macros_r(mac, raw_command, &processed_command, macro_options);
+		process_command_macros_r(mac, temp_commandsmember->command_ptr, &processed_command, macro_options);
 		my_free(raw_command);
 		if (processed_command == NULL)
 			continue;
@@ -2018,6 +2101,13 @@ int notify_contact_of_host(icinga_macros *mac, contact *cntct, host *hst, int ty
                         continue;
 #endif
 
+		/* let a check worker run the notification command - the method ends once it has finished */
+		if (run_async_notification(mac, processed_command, HOST_NOTIFICATION, type, (void *)hst, cntct, temp_commandsmember->command, not_author, not_data, escalated, method_start_time) == OK) {
+			my_free(command_name);
+			my_free(processed_command);
+			continue;
+		}
+
 		/* run the notification command */
 		my_system_r(mac, processed_command, notification_timeout, &early_timeout, &exectime, NULL, 0);
 
@@ -175,7 +175,19 @@ void profiler_update(int event, struct timeval start) {
 	}
 }
 
+/* name lookups through the object hash indexes, see common/objects.c */
+static char *profiler_object_hash_names[NUM_OBJECT_HASHES] = {
+	"FIND_HOST",
+	"FIND_SERVICE",
+	"FIND_COMMAND",
+	"FIND_TIMEPERIOD",
+	"FIND_CONTACT"
+};
+
 void profiler_output(FILE* fp) {
+	unsigned long lookups = 0L;
+	unsigned long misses = 0L;
+	double elapsed = 0.0;
 	int c;
 	for (c = 0; c < profiler_item_count; c++) {
 		//Only print those that are turned on.
@@ -187,6 +199,14 @@ void profiler_output(FILE* fp) {
 		}
 	}
 
+	for (c = 0; c < NUM_OBJECT_HASHES; c++) {
+		if (get_object_hash_stats(c, &lookups, &misses, &elapsed) == ERROR)
+			continue;
+		fprintf(fp, "\tPROFILE_COUNTER_%s=%lu\n", profiler_object_hash_names[c], lookups);
+		fprintf(fp, "\tPROFILE_ELAPSED_%s=%f\n", profiler_object_hash_names[c], elapsed);
+		fprintf(fp, "\tPROFILE_COUNTER_%s_MISSES=%lu\n", profiler_object_hash_names[c], misses);
+	}
+
 }
 
 #endif
@@ -49,6 +49,7 @@ extern unsigned long   next_problem_id;
 extern int             event_handler_timeout;
 extern int             ocsp_timeout;
 extern int             ochp_timeout;
+extern int             max_async_commands;
 
 extern char            *global_host_event_handler;
 extern char            *global_service_event_handler;
@@ -64,6 +65,98 @@ extern time_t          program_start;
 
 int dummy;	/* reduce compiler warnings */
 
+
+/******************************************************************/
+/**************** ASYNCHRONOUS HANDLER FUNCTIONS ******************/
+/******************************************************************/
+
+/* what is needed to finish an event handler run by a check worker */
+typedef struct async_event_handler_struct {
+	int eventhandler_type;
+	void *object;
+	int state;
+	int state_type;
+	char *command;
+	struct timeval start_time;
+} async_event_handler;
+
+
+/* logs timeouts of OCSP commands run by a check worker */
+static void finish_async_ocsp_command(void *data, char *processed_command, int result, int early_timeout, double exectime, struct timeval *end_time, char *output) {
+	service *svc = (service *)data;
+
+	if (early_timeout == TRUE)
+		logit(NSLOG_RUNTIME_WARNING, TRUE, "警报: OCSP command '%s' for service '%s' on host '%s' timed out after %d seconds\n", processed_command, svc->description, svc->host_name, ocsp_timeout);
+}
+
+
+/* logs timeouts of OCHP commands run by a check worker */
+static void finish_async_ochp_command(void *data, char *processed_command, int result, int early_timeout, double exectime, struct timeval *end_time, char *output) {
+	host *hst = (host *)data;
+
+	if (early_timeout == TRUE)
+		logit(NSLOG_RUNTIME_WARNING, TRUE, "警报: OCHP command '%s' for host '%s' timed out after %d seconds\n", processed_command, hst->name, ochp_timeout);
+}
+
+
+/* logs timeouts and sends the end of an event handler to the broker once a check worker has run it */
+static void finish_async_event_handler(void *data, char *processed_command, int result, int early_timeout, double exectime, struct timeval *end_time, char *output) {
+	async_event_handler *handler = (async_event_handler *)data;
+
+	/* check to see if the event handler timed out */
+	if (early_timeout == TRUE) {
+		switch (handler->eventhandler_type) {
+		case GLOBAL_SERVICE_EVENTHANDLER:
+			logit(NSLOG_EVENT_HANDLER | NSLOG_RUNTIME_WARNING, TRUE, "警报: 全局服务事件处理命令 '%s' 在%d 秒后逾期\n", processed_command, event_handler_timeout);
+			break;
+		case SERVICE_EVENTHANDLER:
+			logit(NSLOG_EVENT_HANDLER | NSLOG_RUNTIME_WARNING, TRUE, "Warning: Service event handler command '%s' timed out after %d seconds\n", processed_command, event_handler_timeout);
+			break;
+		case GLOBAL_HOST_EVENTHANDLER:
+			logit(NSLOG_EVENT_HANDLER | NSLOG_RUNTIME_WARNING, TRUE, "Warning: Global host event handler command '%s' timed out after %d seconds\n", processed_command, event_handler_timeout);
+			break;
+		default:
+			logit(NSLOG_EVENT_HANDLER | NSLOG_RUNTIME_WARNING, TRUE, "警报 主机事件处理命令 '%s' 在 %d 秒后逾期\n", processed_command, event_handler_timeout);
+			break;
+		}
+	}
+
+#ifdef USE_EVENT_BROKER
+	/* send event data to broker, with the time the command ended instead of the time we got its result */
+	broker_event_handler(NEBTYPE_EVENTHANDLER_END, NEBFLAG_NONE, NEBATTR_NONE, handler->eventhandler_type, handler->object, handler->state, handler->state_type, handler->start_time, *end_time, exectime, event_handler_timeout, early_timeout, result, handler->command, processed_command, output, NULL);
+#endif
+
+	my_free(handler);
+}
+
+
+/* hands an event handler command to the check workers if asynchronous commands are enabled */
+static int run_async_event_handler(icinga_macros *mac, char *processed_command, int eventhandler_type, void *object, int state, int state_type, char *command) {
+	async_event_handler *handler = NULL;
+
+	if (max_async_commands <= 0)
+		return ERROR;
+
+	if ((handler = (async_event_handler *)malloc(sizeof(async_event_handler))) == NULL)
+		return ERROR;
+
+	handler->eventhandler_type = eventhandler_type;
+	handler->object = object;
+	handler->state = state;
+	handler->state_type = state_type;
+	handler->command = command;
+	gettimeofday(&handler->start_time, NULL);
+
+	if (run_async_command(mac, processed_command, event_handler_timeout, finish_async_event_handler, (void *)handler) == ERROR) {
+		my_free(handler);
+		return ERROR;
+	}
+
+	return OK;
+}
+
+
+
 /******************************************************************/
 /************* OBSESSIVE COMPULSIVE HANDLER FUNCTIONS *************/
 /******************************************************************/
@@ -112,7 +205,7 @@ int obsessive_compulsive_service_check_processor(service *svc) {
 	log_debug_info(DEBUGL_CHECKS, 2, "Raw obsessive compulsive service processor command line: %s\n", raw_command);
 
 	/* process any macros in the raw command line */
-	process_macros_r(&mac, raw_command, &processed_command, macro_options);
+	process_command_macros_r(&mac, ocsp_command_ptr, &processed_command, macro_options);
 	if (processed_command == NULL) {
 		clear_volatile_macros_r(&mac);
 		return ERROR;
@@ -120,6 +213,14 @@ int obsessive_compulsive_service_check_processor(service *svc) {
 
 	log_debug_info(DEBUGL_CHECKS, 2, "Processed obsessive compulsive service processor command line: %s\n", processed_command);
 
+	/* let a check worker run the command */
+	if (run_async_command(&mac, processed_command, ocsp_timeout, finish_async_ocsp_command, (void *)svc) == OK) {
+		clear_volatile_macros_r(&mac);
+		my_free(raw_command);
+		my_free(processed_command);
+		return OK;
+	}
+
 	/* run the command */
 	my_system_r(&mac, processed_command, ocsp_timeout, &early_timeout, &exectime, NULL, 0);
 
@@ -176,7 +277,7 @@ int obsessive_compulsive_host_check_processor(host *hst) {
 	log_debug_info(DEBUGL_CHECKS, 2, "Raw obsessive compulsive host processor command line: %s\n", raw_command);
 
 	/* process any macros in the raw command line */
-	process_macros_r(&mac, raw_command, &processed_command, macro_options);
+	process_command_macros_r(&mac, ochp_command_ptr, &processed_command, macro_options);
 	if (processed_command == NULL) {
 		clear_volatile_macros_r(&mac);
 		return ERROR;
@@ -184,6 +285,14 @@ int obsessive_compulsive_host_check_processor(host *hst) {
 
 	log_debug_info(DEBUGL_CHECKS, 2, "Processed obsessive compulsive host processor command line: %s\n", processed_command);
 
+	/* let a check worker run the command */
+	if (run_async_command(&mac, processed_command, ochp_timeout, finish_async_ochp_command, (void *)hst) == OK) {
+		clear_volatile_macros_r(&mac);
+		my_free(raw_command);
+		my_free(processed_command);
+		return OK;
+	}
+
 	/* run the command */
 	my_system_r(&mac, processed_command, ochp_timeout, &early_timeout, &exectime, NULL, 0);
 	clear_volatile_macros_r(&mac);
@@ -300,7 +409,7 @@ int run_global_service_event_handler(icinga_macros *mac, service *svc) {
 	log_debug_info(DEBUGL_EVENTHANDLERS, 2, "Raw global service event handler command line: %s\n", raw_command);
 
 	/* process any macros in the raw command line */
-	process_macros_r(mac, raw_command, &processed_command, macro_options);
+	process_command_macros_r(mac, global_service_event_handler_ptr, &processed_command, macro_options);
 	my_free(raw_command);
 	if (processed_command == NULL)
 		return ERROR;
@@ -328,6 +437,14 @@ int run_global_service_event_handler(icinga_macros *mac, service *svc) {
 	}
 #endif
 
+	/* let a check worker run the command - the event handler ends once it has finished */
+	if (run_async_event_handler(mac, processed_command, GLOBAL_SERVICE_EVENTHANDLER, (void *)svc, svc->current_state, svc->state_type, global_service_event_handler) == OK) {
+		my_free(processed_command);
+		my_free(raw_logentry);
+		my_free(processed_logentry);
+		return OK;
+	}
+
 	/* run the command */
 	result = my_system_r(mac, processed_command, event_handler_timeout, &early_timeout, &exectime, &command_output, 0);
 
@@ -398,7 +515,7 @@ int run_service_event_handler(icinga_macros *mac, service *svc) {
 	log_debug_info(DEBUGL_EVENTHANDLERS, 2, "Raw service event handler command line: %s\n", raw_command);
 
 	/* process any macros in the raw command line */
-	process_macros_r(mac, raw_command, &processed_command, macro_options);
+	process_command_macros_r(mac, svc->event_handler_ptr, &processed_command, macro_options);
 	my_free(raw_command);
 	if (processed_command == NULL)
 		return ERROR;
@@ -426,6 +543,14 @@ int run_service_event_handler(icinga_macros *mac, service *svc) {
 	}
 #endif
 
+	/* let a check worker run the command - the event handler ends once it has finished */
+	if (run_async_event_handler(mac, processed_command, SERVICE_EVENTHANDLER, (void *)svc, svc->current_state, svc->state_type, svc->event_handler) == OK) {
+		my_free(processed_command);
+		my_free(raw_logentry);
+		my_free(processed_logentry);
+		return OK;
+	}
+
 	/* run the command */
 	result = my_system_r(mac, processed_command, event_handler_timeout, &early_timeout, &exectime, &command_output, 0);
 
@@ -544,7 +669,7 @@ int run_global_host_event_handler(icinga_macros *mac, host *hst) {
 	log_debug_info(DEBUGL_EVENTHANDLERS, 2, "Raw global host event handler command line: %s\n", raw_command);
 
 	/* process any macros in the raw command line */
-	process_macros_r(mac, raw_command, &processed_command, macro_options);
+	process_command_macros_r(mac, global_host_event_handler_ptr, &processed_command, macro_options);
 	my_free(raw_command);
 	if (processed_command == NULL)
 		return ERROR;
@@ -572,6 +697,14 @@ int run_global_host_event_handler(icinga_macros *mac, host *hst) {
 	}
 #endif
 
+	/* let a check worker run the command - the event handler ends once it has finished */
+	if (run_async_event_handler(mac, processed_command, GLOBAL_HOST_EVENTHANDLER, (void *)hst, hst->current_state, hst->state_type, global_host_event_handler) == OK) {
+		my_free(processed_command);
+		my_free(raw_logentry);
+		my_free(processed_logentry);
+		return OK;
+	}
+
 	/* run the command */
 	result = my_system_r(mac, processed_command, event_handler_timeout, &early_timeout, &exectime, &command_output, 0);
 
@@ -641,7 +774,7 @@ int run_host_event_handler(icinga_macros *mac, host *hst) {
 	log_debug_info(DEBUGL_EVENTHANDLERS, 2, "Raw host event handler command line: %s\n", raw_command);
 
 	/* process any macros in the raw command line */
-	process_macros_r(mac, raw_command, &processed_command, macro_options);
+	process_command_macros_r(mac, hst->event_handler_ptr, &processed_command, macro_options);
 	my_free(raw_command);
 	if (processed_command == NULL)
 		return ERROR;
@@ -669,6 +802,14 @@ int run_host_event_handler(icinga_macros *mac, host *hst) {
 	}
 #endif
 
+	/* let a check worker run the command - the event handler ends once it has finished */
+	if (run_async_event_handler(mac, processed_command, HOST_EVENTHANDLER, (void *)hst, hst->current_state, hst->state_type, hst->event_handler) == OK) {
+		my_free(processed_command);
+		my_free(raw_logentry);
+		my_free(processed_logentry);
+		return OK;
+	}
+
 	/* run the command */
 	result = my_system_r(mac, processed_command, event_handler_timeout, &early_timeout, &exectime, &command_output, 0);
 
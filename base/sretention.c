@@ -94,7 +94,7 @@ int save_state_information(int autosave) {
 
 	/********* IMPLEMENTATION-SPECIFIC OUTPUT FUNCTION ********/
 #ifdef USE_XRDDEFAULT
-	result = xrddefault_save_state_information();
+	result = xrddefault_save_state_information(autosave);
 #endif
 
 #ifdef USE_EVENT_BROKER
@@ -223,8 +223,12 @@ extern double   high_host_flap_threshold;
 
 extern int      use_large_installation_tweaks;
 extern int      enable_environment_macros;
+extern int      lazy_environment_macros;
 extern int      free_child_process_memory;
 extern int      child_processes_fork_twice;
+extern int      check_worker_processes;
+extern int      check_result_reaper_threads;
+extern int      max_async_commands;
 
 extern int      enable_embedded_perl;
 extern int      use_embedded_perl_implicitly;
@@ -244,14 +248,13 @@ extern host             *host_list;
 extern hostgroup	*hostgroup_list;
 extern service          *service_list;
 extern servicegroup     *servicegroup_list;
-extern timed_event      *event_list_high;
-extern timed_event      *event_list_low;
+extern timed_event_queue event_queue_high;
+extern timed_event_queue event_queue_low;
 extern notification     *notification_list;
 extern command          *command_list;
 extern timeperiod       *timeperiod_list;
 
 extern int      command_file_fd;
-extern FILE     *command_file_fp;
 extern int      command_file_created;
 
 #ifdef HAVE_TZNAME
@@ -262,11 +265,16 @@ extern char     *tzname[2];
 #endif
 #endif
 
-extern check_result    *check_result_list;
+extern check_result_queue check_result_list;
+extern unsigned long   check_result_channel_stats[CHECK_RESULT_CHANNELS];
 extern unsigned long   max_check_result_file_age;
 
 extern dbuf            check_result_dbuf;
 
+static int check_result_channel[2] = { -1, -1 };	/* read/write end of the in-memory check result channel */
+
+static void set_check_result_var(check_result *, char *, char *);
+
 extern pthread_t       worker_threads[TOTAL_WORKER_THREADS];
 extern circular_buffer external_command_buffer;
 extern circular_buffer check_result_buffer;
@@ -835,8 +843,8 @@ int get_dlst_shift(time_t *start, time_t *end) {
 
 /*#define TEST_TIMEPERIODS_A 1*/
 
-/* see if the specified time falls into a valid time range in the given time period */
-int check_time_against_period(time_t test_time, timeperiod *tperiod) {
+/* see if the specified time falls into a valid time range in the given time period, without using the precompiled time ranges */
+int _check_time_against_period(time_t test_time, timeperiod *tperiod) {
 	timeperiodexclusion *temp_timeperiodexclusion = NULL;
 	timeperiodexclusion *first_timeperiodexclusion = NULL;
 	daterange *temp_daterange = NULL;
@@ -856,8 +864,6 @@ int check_time_against_period(time_t test_time, timeperiod *tperiod) {
 	int year = 0;
 	int shift;
 
-	log_debug_info(DEBUGL_FUNCTIONS, 0, "check_time_against_period()\n");
-
 	/* if no period was specified, assume the time is good */
 	if (tperiod == NULL)
 		return OK;
@@ -867,7 +873,7 @@ int check_time_against_period(time_t test_time, timeperiod *tperiod) {
 	first_timeperiodexclusion = tperiod->exclusions;
 	tperiod->exclusions = NULL;
 	for (temp_timeperiodexclusion = first_timeperiodexclusion; temp_timeperiodexclusion != NULL; temp_timeperiodexclusion = temp_timeperiodexclusion->next) {
-		if (check_time_against_period(test_time, temp_timeperiodexclusion->timeperiod_ptr) == OK) {
+		if (_check_time_against_period(test_time, temp_timeperiodexclusion->timeperiod_ptr) == OK) {
 			tperiod->exclusions = first_timeperiodexclusion;
 			return ERROR;
 		}
@@ -1110,6 +1116,282 @@ int check_time_against_period(time_t test_time, timeperiod *tperiod) {
 }
 
 
+/*
+ * precompiled timeperiods: the result of _check_time_against_period() only changes at local
+ * midnight, at dst changes and where a time range starts or ends. the valid times of a whole
+ * week are computed by evaluating the timeperiod at each of these points, so checking a time
+ * or finding the next valid time is a binary search until the week is over. the ranges are
+ * freed with the timeperiod on reload.
+ */
+
+#define TIMEPERIOD_COMPILE_DAYS		7
+
+/* returns a value that changes with the local day and the dst flag */
+static long get_timeperiod_day_key(time_t t) {
+	struct tm tm_s;
+
+	localtime_r(&t, &tm_s);
+
+	return (((long)tm_s.tm_year * 400 + tm_s.tm_yday) * 2) + ((tm_s.tm_isdst > 0) ? 1 : 0);
+}
+
+/* returns the first time of the day (or dst period within a day) the given time falls into */
+static time_t get_timeperiod_segment_start(time_t t) {
+	time_t low = t - (26 * 3600);
+	time_t high = t;
+	time_t mid = (time_t)0L;
+	long key = get_timeperiod_day_key(t);
+
+	while (high - low > 1) {
+		mid = low + ((high - low) / 2);
+		if (get_timeperiod_day_key(mid) == key)
+			high = mid;
+		else
+			low = mid;
+	}
+
+	return high;
+}
+
+/* returns the first time after the day (or dst period within a day) the given time falls into */
+static time_t get_timeperiod_segment_end(time_t t) {
+	time_t low = t;
+	time_t high = t + (26 * 3600);
+	time_t mid = (time_t)0L;
+	long key = get_timeperiod_day_key(t);
+
+	while (high - low > 1) {
+		mid = low + ((high - low) / 2);
+		if (get_timeperiod_day_key(mid) == key)
+			low = mid;
+		else
+			high = mid;
+	}
+
+	return high;
+}
+
+static int add_compiled_time(time_t **times, int *count, int *size, time_t t) {
+	time_t *new_times = NULL;
+
+	if (*count >= *size) {
+		if ((new_times = (time_t *)realloc(*times, ((*size > 0) ? *size * 2 : 64) * sizeof(time_t))) == NULL)
+			return ERROR;
+		*times = new_times;
+		*size = (*size > 0) ? *size * 2 : 64;
+	}
+
+	(*times)[(*count)++] = t;
+
+	return OK;
+}
+
+static int compare_compiled_times(const void *a, const void *b) {
+	time_t ta = *(const time_t *)a;
+	time_t tb = *(const time_t *)b;
+
+	return (ta < tb) ? -1 : (ta > tb) ? 1 : 0;
+}
+
+/* collects the start and end offsets of all time ranges in a timeperiod and its exclusions */
+static int add_timeperiod_offsets(timeperiod *tperiod, time_t **offsets, int *count, int *size) {
+	timeperiodexclusion *temp_timeperiodexclusion = NULL;
+	timeperiodexclusion *first_timeperiodexclusion = NULL;
+	daterange *temp_daterange = NULL;
+	timerange *temp_timerange = NULL;
+	int result = OK;
+	int x = 0;
+
+	if (tperiod == NULL)
+		return OK;
+
+	for (x = 0; x < 7 && result == OK; x++) {
+		for (temp_timerange = tperiod->days[x]; temp_timerange != NULL && result == OK; temp_timerange = temp_timerange->next) {
+			result = add_compiled_time(offsets, count, size, (time_t)temp_timerange->range_start);
+			if (result == OK)
+				result = add_compiled_time(offsets, count, size, (time_t)temp_timerange->range_end + 1);
+		}
+	}
+
+	for (x = 0; x < DATERANGE_TYPES && result == OK; x++) {
+		for (temp_daterange = tperiod->exceptions[x]; temp_daterange != NULL && result == OK; temp_daterange = temp_daterange->next) {
+			for (temp_timerange = temp_daterange->times; temp_timerange != NULL && result == OK; temp_timerange = temp_timerange->next) {
+				result = add_compiled_time(offsets, count, size, (time_t)temp_timerange->range_start);
+				if (result == OK)
+					result = add_compiled_time(offsets, count, size, (time_t)temp_timerange->range_end + 1);
+			}
+		}
+	}
+
+	/* same loop protection as in _check_time_against_period() */
+	first_timeperiodexclusion = tperiod->exclusions;
+	tperiod->exclusions = NULL;
+	for (temp_timeperiodexclusion = first_timeperiodexclusion; temp_timeperiodexclusion != NULL && result == OK; temp_timeperiodexclusion = temp_timeperiodexclusion->next)
+		result = add_timeperiod_offsets(temp_timeperiodexclusion->timeperiod_ptr, offsets, count, size);
+	tperiod->exclusions = first_timeperiodexclusion;
+
+	return result;
+}
+
+/* computes the valid time ranges of the week starting with the day the given time falls into */
+static int compile_timeperiod(timeperiod *tperiod, time_t t) {
+	time_t *offsets = NULL;
+	time_t *points = NULL;
+	int offset_count = 0;
+	int offset_size = 0;
+	int point_count = 0;
+	int point_size = 0;
+	int range_times = 0;
+	time_t compile_start = (time_t)0L;
+	time_t segment_start = (time_t)0L;
+	time_t segment_end = (time_t)0L;
+	time_t midnight = (time_t)0L;
+	time_t day_start = (time_t)0L;
+	time_t point_end = (time_t)0L;
+	struct tm tm_s;
+	int result = OK;
+	int x = 0;
+	int y = 0;
+
+	log_debug_info(DEBUGL_FUNCTIONS, 0, "compile_timeperiod()\n");
+
+	tperiod->compiled_start = (time_t)0L;
+	tperiod->compiled_end = (time_t)0L;
+	tperiod->compiled_range_count = 0;
+
+	result = add_timeperiod_offsets(tperiod, &offsets, &offset_count, &offset_size);
+
+	compile_start = get_timeperiod_segment_start(t);
+	for (segment_start = compile_start; segment_start < compile_start + (TIMEPERIOD_COMPILE_DAYS * 24 * 3600) && result == OK; segment_start = segment_end) {
+
+		segment_end = get_timeperiod_segment_end(segment_start);
+
+		/* midnight as _check_time_against_period() calculates it for times in this segment */
+		localtime_r(&segment_start, &tm_s);
+		tm_s.tm_sec = 0;
+		tm_s.tm_min = 0;
+		tm_s.tm_hour = 0;
+		midnight = mktime(&tm_s);
+
+		/* real start of the day, date ranges with skip intervals are compared against it */
+		localtime_r(&segment_start, &tm_s);
+		tm_s.tm_sec = 0;
+		tm_s.tm_min = 0;
+		tm_s.tm_hour = 0;
+		tm_s.tm_isdst = -1;
+		day_start = mktime(&tm_s);
+
+		/* all times in this segment at which the result may change */
+		point_count = 0;
+		result = add_compiled_time(&points, &point_count, &point_size, segment_start);
+		if (result == OK && day_start > segment_start && day_start < segment_end)
+			result = add_compiled_time(&points, &point_count, &point_size, day_start);
+		for (x = 0; x < offset_count && result == OK; x++) {
+			if (midnight + offsets[x] > segment_start && midnight + offsets[x] < segment_end)
+				result = add_compiled_time(&points, &point_count, &point_size, midnight + offsets[x]);
+		}
+		if (result == ERROR)
+			break;
+
+		qsort(points, point_count, sizeof(time_t), compare_compiled_times);
+
+		for (x = 0; x < point_count; x = y) {
+
+			for (y = x + 1; y < point_count && points[y] == points[x]; y++);
+			point_end = (y < point_count) ? points[y] : segment_end;
+
+			if (_check_time_against_period(points[x], tperiod) == ERROR)
+				continue;
+
+			/* extend the previous range if it ends here */
+			if (tperiod->compiled_range_count > 0 && tperiod->compiled_ranges[(tperiod->compiled_range_count * 2) - 1] == points[x]) {
+				tperiod->compiled_ranges[(tperiod->compiled_range_count * 2) - 1] = point_end;
+				continue;
+			}
+
+			range_times = tperiod->compiled_range_count * 2;
+			if ((result = add_compiled_time(&tperiod->compiled_ranges, &range_times, &tperiod->compiled_range_size, points[x])) == OK)
+				result = add_compiled_time(&tperiod->compiled_ranges, &range_times, &tperiod->compiled_range_size, point_end);
+			if (result == ERROR)
+				break;
+			tperiod->compiled_range_count++;
+		}
+	}
+
+	my_free(offsets);
+	my_free(points);
+
+	if (result == ERROR) {
+		tperiod->compiled_range_count = 0;
+		return ERROR;
+	}
+
+	tperiod->compiled_start = compile_start;
+	tperiod->compiled_end = segment_end;
+
+	return OK;
+}
+
+/* makes sure the precompiled time ranges of a timeperiod cover the given time */
+static int get_compiled_timeperiod(timeperiod *tperiod, time_t t) {
+
+	if (t >= tperiod->compiled_start && t < tperiod->compiled_end)
+		return OK;
+
+	return compile_timeperiod(tperiod, t);
+}
+
+/* returns the last precompiled time range that starts at or before the given time, -1 if there is none */
+static int find_compiled_range(timeperiod *tperiod, time_t t) {
+	int low = 0;
+	int high = tperiod->compiled_range_count - 1;
+	int mid = 0;
+	int found = -1;
+
+	while (low <= high) {
+		mid = (low + high) / 2;
+		if (tperiod->compiled_ranges[mid * 2] <= t) {
+			found = mid;
+			low = mid + 1;
+		} else
+			high = mid - 1;
+	}
+
+	return found;
+}
+
+/* drops the precompiled time ranges of all timeperiods, needed after the timezone has changed */
+void invalidate_compiled_timeperiods(void) {
+	timeperiod *temp_timeperiod = NULL;
+
+	for (temp_timeperiod = timeperiod_list; temp_timeperiod != NULL; temp_timeperiod = temp_timeperiod->next) {
+		temp_timeperiod->compiled_start = (time_t)0L;
+		temp_timeperiod->compiled_end = (time_t)0L;
+		temp_timeperiod->compiled_range_count = 0;
+	}
+}
+
+/* see if the specified time falls into a valid time range in the given time period */
+int check_time_against_period(time_t test_time, timeperiod *tperiod) {
+	int x = 0;
+
+	log_debug_info(DEBUGL_FUNCTIONS, 0, "check_time_against_period()\n");
+
+	/* if no period was specified, assume the time is good */
+	if (tperiod == NULL)
+		return OK;
+
+	if (get_compiled_timeperiod(tperiod, test_time) == ERROR)
+		return _check_time_against_period(test_time, tperiod);
+
+	x = find_compiled_range(tperiod, test_time);
+	if (x >= 0 && test_time < tperiod->compiled_ranges[(x * 2) + 1])
+		return OK;
+
+	return ERROR;
+}
+
+
 
 /*#define TEST_TIMEPERIODS_B 1*/
 
@@ -1117,6 +1399,7 @@ int check_time_against_period(time_t test_time, timeperiod *tperiod) {
 
 void _get_next_valid_time(time_t pref_time, time_t current_time, time_t *valid_time, timeperiod *tperiod) {
 	time_t preferred_time = (time_t)0L;
+	int x = 0;
 
 	/*
 	 * Moving checks at the top with preferred time
@@ -1136,6 +1419,22 @@ void _get_next_valid_time(time_t pref_time, time_t current_time, time_t *valid_t
 		return;
 	}
 
+	/*
+	 * the next valid time within the precompiled week is the
+	 * preferred time itself or the start of the next valid range
+	 */
+	if (get_compiled_timeperiod(tperiod, preferred_time) == OK) {
+		x = find_compiled_range(tperiod, preferred_time);
+		if (x >= 0 && preferred_time < tperiod->compiled_ranges[(x * 2) + 1]) {
+			*valid_time = preferred_time;
+			return;
+		}
+		if (x + 1 < tperiod->compiled_range_count) {
+			*valid_time = tperiod->compiled_ranges[(x + 1) * 2];
+			return;
+		}
+	}
+
 	/*
 	 * if the preferred time is valid in timeperiod, go with it
 	 * ithis is necessary because the code below won't catch 
@@ -2339,8 +2638,8 @@ void service_check_sighandler(int sig) {
 		/* close the temp file */
 		fclose(check_result_info.output_file_fp);
 
-		/* move check result to queue directory */
-		move_check_result_to_queue(check_result_info.output_file);
+		/* pass check result on to the core */
+		submit_check_result(&check_result_info, "(服务检查超时)");
 	}
 
 	/* free check result memory */
@@ -2379,8 +2678,8 @@ void host_check_sighandler(int sig) {
 		/* close the temp file */
 		fclose(check_result_info.output_file_fp);
 
-		/* move check result to queue directory */
-		move_check_result_to_queue(check_result_info.output_file);
+		/* pass check result on to the core */
+		submit_check_result(&check_result_info, "(主机检查超时)");
 	}
 
 	/* free check result memory */
@@ -2694,6 +2993,158 @@ int move_check_result_to_queue(char *checkresult_file) {
 
 
 
+/* creates the in-memory channel forked checks send their results through */
+int open_check_result_channel(void) {
+	int buffer_size = CHECK_RESULT_CHANNEL_BUFFER_SIZE;
+
+	/* the channel survives restarts, as checks started before may still report through it */
+	if (check_result_channel[0] >= 0)
+		return OK;
+
+	/* datagrams keep the results of concurrent checks from getting mixed up */
+	if (socketpair(AF_UNIX, SOCK_DGRAM, 0, check_result_channel) < 0) {
+		logit(NSLOG_RUNTIME_WARNING, TRUE, "Warning: Could not create check result channel, check results will be passed through '%s' only: %s\n", check_result_path, strerror(errno));
+		check_result_channel[0] = -1;
+		check_result_channel[1] = -1;
+		return ERROR;
+	}
+
+	/* leave room for result bursts - results that don't fit go to the queue directory */
+	setsockopt(check_result_channel[1], SOL_SOCKET, SO_SNDBUF, &buffer_size, sizeof(buffer_size));
+	setsockopt(check_result_channel[0], SOL_SOCKET, SO_RCVBUF, &buffer_size, sizeof(buffer_size));
+
+	/* plugins must not inherit the channel */
+	fcntl(check_result_channel[0], F_SETFD, FD_CLOEXEC);
+	fcntl(check_result_channel[1], F_SETFD, FD_CLOEXEC);
+	fcntl(check_result_channel[0], F_SETFL, fcntl(check_result_channel[0], F_GETFL) | O_NONBLOCK);
+
+	log_debug_info(DEBUGL_IPC, 1, "Check result channel created (fd=%d/%d)\n", check_result_channel[0], check_result_channel[1]);
+
+	return OK;
+}
+
+
+
+/* closes the in-memory check result channel */
+int close_check_result_channel(void) {
+
+	if (check_result_channel[0] >= 0)
+		close(check_result_channel[0]);
+	if (check_result_channel[1] >= 0)
+		close(check_result_channel[1]);
+
+	check_result_channel[0] = -1;
+	check_result_channel[1] = -1;
+
+	return OK;
+}
+
+
+
+/* sends a finished check result to the core - the result file is only used if the channel can't take it */
+int submit_check_result(check_result *info, char *output) {
+	char *record = NULL;
+	int record_length = 0;
+
+	if (info == NULL)
+		return ERROR;
+
+	if (check_result_channel[1] >= 0) {
+
+		record_length = asprintf(&record, "host_name=%s\n%s%s%scheck_type=%d\ncheck_options=%d\nscheduled_check=%d\nreschedule_check=%d\nlatency=%f\nstart_time=%lu.%lu\nfinish_time=%lu.%lu\nearly_timeout=%d\nexited_ok=%d\nreturn_code=%d\noutput=%s\n",
+		                         info->host_name,
+		                         (info->service_description == NULL) ? "" : "service_description=",
+		                         (info->service_description == NULL) ? "" : info->service_description,
+		                         (info->service_description == NULL) ? "" : "\n",
+		                         info->check_type,
+		                         info->check_options,
+		                         info->scheduled_check,
+		                         info->reschedule_check,
+		                         info->latency,
+		                         info->start_time.tv_sec, info->start_time.tv_usec,
+		                         info->finish_time.tv_sec, info->finish_time.tv_usec,
+		                         info->early_timeout,
+		                         info->exited_ok,
+		                         info->return_code,
+		                         (output == NULL) ? "(null)" : output);
+
+		if (record_length > 0 && record_length <= MAX_CHECK_RESULT_RECORD_LENGTH && send(check_result_channel[1], record, record_length, MSG_DONTWAIT | MSG_NOSIGNAL) == record_length) {
+			my_free(record);
+
+			/* the result file was only kept in case things went wrong */
+			if (info->output_file != NULL)
+				unlink(info->output_file);
+
+			return OK;
+		}
+
+		my_free(record);
+	}
+
+	if (info->output_file == NULL)
+		return ERROR;
+
+	/* move check result to queue directory */
+	return move_check_result_to_queue(info->output_file);
+}
+
+
+
+/* moves all results waiting in the in-memory channel to the check result list */
+int read_check_result_channel(void) {
+	static char *record = NULL;
+	check_result *new_cr = NULL;
+	char *line = NULL;
+	char *next_line = NULL;
+	char *val = NULL;
+	ssize_t record_length = 0;
+	int results = 0;
+
+	if (check_result_channel[0] < 0)
+		return 0;
+
+	if (record == NULL && (record = (char *)malloc(MAX_CHECK_RESULT_RECORD_LENGTH + 1)) == NULL)
+		return 0;
+
+	while ((record_length = recv(check_result_channel[0], record, MAX_CHECK_RESULT_RECORD_LENGTH, MSG_DONTWAIT)) > 0) {
+
+		record[record_length] = '\x0';
+
+		if ((new_cr = (check_result *)malloc(sizeof(check_result))) == NULL)
+			break;
+		init_check_result(new_cr);
+		new_cr->output_file = NULL;
+
+		/* one var=value pair per line, just like in result files */
+		for (line = record; line != NULL && *line != '\x0'; line = next_line) {
+			if ((next_line = strchr(line, '\n')) != NULL)
+				*next_line++ = '\x0';
+			if ((val = strchr(line, '=')) == NULL)
+				continue;
+			*val++ = '\x0';
+			set_check_result_var(new_cr, line, val);
+		}
+
+		/* do we have the minimum amount of data? */
+		if (new_cr->host_name == NULL || new_cr->output == NULL) {
+			free_check_result(new_cr);
+			my_free(new_cr);
+			continue;
+		}
+
+		add_check_result_to_list(new_cr);
+		check_result_channel_stats[CHECK_RESULT_CHANNEL_PIPE]++;
+		results++;
+	}
+
+	if (results > 0)
+		log_debug_info(DEBUGL_CHECKS | DEBUGL_IPC, 1, "Received %d check results through the check result channel\n", results);
+
+	return results;
+}
+
+
+
 /* processes files in the check result queue directory */
 int process_check_result_queue(char *dirname) {
 	char file[MAX_FILENAME_LENGTH];
@@ -2705,17 +3156,9 @@ int process_check_result_queue(char *dirname) {
 	char *temp_buffer = NULL;
 	int result = OK;
 
-	unsigned long list_length = 0;
-	check_result *current = check_result_list;
+	unsigned long list_length = check_result_list.heap.count;
 
 	if (max_check_result_list_items != 0) {
-		/* get the number of items currently to-be-processed
-		 * already on the checkresult list
-		 */
-		while (current != NULL) {
-			list_length++;
-			current = current->next;
-		}
 
 		log_debug_info(DEBUGL_CHECKS, 1, "check_result_list has %lu items\n", list_length);
 
@@ -2803,13 +3246,57 @@ int process_check_result_queue(char *dirname) {
 
 
 
+/* sets a single check result variable read from a result file or the check result channel */
+static void set_check_result_var(check_result *new_cr, char *var, char *val) {
+	char *v1 = NULL, *v2 = NULL;
+
+	if (!strcmp(var, "host_name"))
+		new_cr->host_name = (char *)strdup(val);
+	else if (!strcmp(var, "service_description")) {
+		new_cr->service_description = (char *)strdup(val);
+		new_cr->object_check_type = SERVICE_CHECK;
+	} else if (!strcmp(var, "check_type"))
+		new_cr->check_type = atoi(val);
+	else if (!strcmp(var, "check_options"))
+		new_cr->check_options = atoi(val);
+	else if (!strcmp(var, "scheduled_check"))
+		new_cr->scheduled_check = atoi(val);
+	else if (!strcmp(var, "reschedule_check"))
+		new_cr->reschedule_check = atoi(val);
+	else if (!strcmp(var, "latency"))
+		new_cr->latency = strtod(val, NULL);
+	else if (!strcmp(var, "start_time")) {
+		if ((v1 = strtok(val, ".")) == NULL)
+			return;
+		if ((v2 = strtok(NULL, "\n")) == NULL)
+			return;
+		new_cr->start_time.tv_sec = strtoul(v1, NULL, 0);
+		new_cr->start_time.tv_usec = strtoul(v2, NULL, 0);
+	} else if (!strcmp(var, "finish_time")) {
+		if ((v1 = strtok(val, ".")) == NULL)
+			return;
+		if ((v2 = strtok(NULL, "\n")) == NULL)
+			return;
+		new_cr->finish_time.tv_sec = strtoul(v1, NULL, 0);
+		new_cr->finish_time.tv_usec = strtoul(v2, NULL, 0);
+	} else if (!strcmp(var, "early_timeout"))
+		new_cr->early_timeout = atoi(val);
+	else if (!strcmp(var, "exited_ok"))
+		new_cr->exited_ok = atoi(val);
+	else if (!strcmp(var, "return_code"))
+		new_cr->return_code = atoi(val);
+	else if (!strcmp(var, "output"))
+		new_cr->output = (char *)strdup(val);
+}
+
+
+
 /* reads check result(s) from a file */
 int process_check_result_file(char *fname) {
 	mmapfile *thefile = NULL;
 	char *input = NULL;
 	char *var = NULL;
 	char *val = NULL;
-	char *v1 = NULL, *v2 = NULL;
 	time_t current_time;
 	check_result *new_cr = NULL;
 
@@ -2854,6 +3341,7 @@ int process_check_result_file(char *fname) {
 
 					/* add check result to list in memory */
 					add_check_result_to_list(new_cr);
+					check_result_channel_stats[CHECK_RESULT_CHANNEL_SPOOL]++;
 
 					/* reset pointer */
 					new_cr = NULL;
@@ -2897,43 +3385,7 @@ int process_check_result_file(char *fname) {
 				new_cr->output_file = (char *)strdup(fname);
 			}
 
-			if (!strcmp(var, "host_name"))
-				new_cr->host_name = (char *)strdup(val);
-			else if (!strcmp(var, "service_description")) {
-				new_cr->service_description = (char *)strdup(val);
-				new_cr->object_check_type = SERVICE_CHECK;
-			} else if (!strcmp(var, "check_type"))
-				new_cr->check_type = atoi(val);
-			else if (!strcmp(var, "check_options"))
-				new_cr->check_options = atoi(val);
-			else if (!strcmp(var, "scheduled_check"))
-				new_cr->scheduled_check = atoi(val);
-			else if (!strcmp(var, "reschedule_check"))
-				new_cr->reschedule_check = atoi(val);
-			else if (!strcmp(var, "latency"))
-				new_cr->latency = strtod(val, NULL);
-			else if (!strcmp(var, "start_time")) {
-				if ((v1 = strtok(val, ".")) == NULL)
-					continue;
-				if ((v2 = strtok(NULL, "\n")) == NULL)
-					continue;
-				new_cr->start_time.tv_sec = strtoul(v1, NULL, 0);
-				new_cr->start_time.tv_usec = strtoul(v2, NULL, 0);
-			} else if (!strcmp(var, "finish_time")) {
-				if ((v1 = strtok(val, ".")) == NULL)
-					continue;
-				if ((v2 = strtok(NULL, "\n")) == NULL)
-					continue;
-				new_cr->finish_time.tv_sec = strtoul(v1, NULL, 0);
-				new_cr->finish_time.tv_usec = strtoul(v2, NULL, 0);
-			} else if (!strcmp(var, "early_timeout"))
-				new_cr->early_timeout = atoi(val);
-			else if (!strcmp(var, "exited_ok"))
-				new_cr->exited_ok = atoi(val);
-			else if (!strcmp(var, "return_code"))
-				new_cr->return_code = atoi(val);
-			else if (!strcmp(var, "output"))
-				new_cr->output = (char *)strdup(val);
+			set_check_result_var(new_cr, var, val);
 		}
 	}
 
@@ -2945,6 +3397,7 @@ int process_check_result_file(char *fname) {
 
 			/* add check result to list in memory */
 			add_check_result_to_list(new_cr);
+			check_result_channel_stats[CHECK_RESULT_CHANNEL_SPOOL]++;
 
 			/* reset pointer */
 			new_cr = NULL;
@@ -2990,15 +3443,41 @@ int delete_check_result_file(char *fname) {
 
 
 
+/* does the first check result have to be handled before the second one? */
+static int check_result_runs_before(void *a, void *b) {
+	check_result *first = (check_result *)a;
+	check_result *second = (check_result *)b;
+
+	if (first->finish_time.tv_sec != second->finish_time.tv_sec)
+		return (first->finish_time.tv_sec < second->finish_time.tv_sec) ? TRUE : FALSE;
+	if (first->finish_time.tv_usec != second->finish_time.tv_usec)
+		return (first->finish_time.tv_usec < second->finish_time.tv_usec) ? TRUE : FALSE;
+
+	return (first->queue_seq < second->queue_seq) ? TRUE : FALSE;
+}
+
+
+
+/* returns the heap of the check result list, which gets its callback on first use */
+static minheap *get_check_result_heap(void) {
+
+	/* results are only ever taken from the top, so they don't need to know their slot */
+	if (check_result_list.heap.comes_before == NULL)
+		minheap_init(&check_result_list.heap, check_result_runs_before, NULL);
+
+	return &check_result_list.heap;
+}
+
+
+
 /* reads the first host/service check result from the list in memory */
 check_result *read_check_result(void) {
 	check_result *first_cr = NULL;
 
-	if (check_result_list == NULL)
+	if ((first_cr = (check_result *)minheap_pop(get_check_result_heap())) == NULL)
 		return NULL;
 
-	first_cr = check_result_list;
-	check_result_list = check_result_list->next;
+	first_cr->next = NULL;
 
 	return first_cr;
 }
@@ -3030,7 +3509,12 @@ int init_check_result(check_result *info) {
 	info->exited_ok = TRUE;
 	info->return_code = 0;
 	info->output = NULL;
+	info->output_parsed = FALSE;
+	info->short_output = NULL;
+	info->long_output = NULL;
+	info->perf_data = NULL;
 	info->next = NULL;
+	info->queue_seq = 0L;
 
 	return OK;
 }
@@ -3040,38 +3524,52 @@ int init_check_result(check_result *info) {
 
 /* adds a new host/service check result to the list in memory */
 int add_check_result_to_list(check_result *new_cr) {
-	check_result *temp_cr = NULL;
-	check_result *last_cr = NULL;
 
 	if (new_cr == NULL)
 		return ERROR;
 
-	/* add to list, sorted by finish time (asc) */
-
-	/* find insertion point */
-	last_cr = check_result_list;
-	for (temp_cr = check_result_list; temp_cr != NULL; temp_cr = temp_cr->next) {
-		if (temp_cr->finish_time.tv_sec >= new_cr->finish_time.tv_sec) {
-			if (temp_cr->finish_time.tv_sec > new_cr->finish_time.tv_sec)
-				break;
-			else if (temp_cr->finish_time.tv_usec > new_cr->finish_time.tv_usec)
-				break;
-		}
-		last_cr = temp_cr;
+	/* results are handled sorted by finish time (asc), results finished at the same time in the order they came in */
+	new_cr->next = NULL;
+	new_cr->queue_seq = check_result_list.next_seq++;
+	if (minheap_insert(get_check_result_heap(), new_cr) == ERROR) {
+		logit(NSLOG_RUNTIME_ERROR, TRUE, "Error: Could not allocate memory for the check result list, dropping check result for host '%s'.\n", (new_cr->host_name == NULL) ? "" : new_cr->host_name);
+		free_check_result(new_cr);
+		my_free(new_cr);
+		return ERROR;
 	}
 
-	/* item goes at head of list */
-	if (check_result_list == NULL || temp_cr == check_result_list) {
-		new_cr->next = check_result_list;
-		check_result_list = new_cr;
+	if (check_result_list.heap.count > check_result_list.high)
+		check_result_list.high = check_result_list.heap.count;
+
+	return OK;
+}
+
+
+
+/* adds a batch of check results to the list in memory, growing the heap only once */
+int add_check_results_to_list(check_result **new_results, int count) {
+	int x = 0;
+
+	if (new_results == NULL || count <= 0)
+		return ERROR;
+
+	/* make room for the whole batch */
+	if (minheap_reserve(get_check_result_heap(), count) == ERROR) {
+		/* fall back to adding them one by one, which drops what doesn't fit */
+		for (x = 0; x < count; x++)
+			add_check_result_to_list(new_results[x]);
+		return ERROR;
 	}
 
-	/* item goes in middle or at end of list */
-	else {
-		new_cr->next = temp_cr;
-		last_cr->next = new_cr;
+	for (x = 0; x < count; x++) {
+		new_results[x]->next = NULL;
+		new_results[x]->queue_seq = check_result_list.next_seq++;
+		minheap_insert(&check_result_list.heap, new_results[x]);
 	}
 
+	if (check_result_list.heap.count > check_result_list.high)
+		check_result_list.high = check_result_list.heap.count;
+
 	return OK;
 }
 
@@ -3080,16 +3578,16 @@ int add_check_result_to_list(check_result *new_cr) {
 
 /* frees all memory associated with the check result list */
 int free_check_result_list(void) {
-	check_result *this_cr = NULL;
-	check_result *next_cr = NULL;
+	check_result *temp_cr = NULL;
+	unsigned int x = 0;
 
-	for (this_cr = check_result_list; this_cr != NULL; this_cr = next_cr) {
-		next_cr = this_cr->next;
-		free_check_result(this_cr);
-		my_free(this_cr);
+	for (x = 1; x <= check_result_list.heap.count; x++) {
+		temp_cr = (check_result *)check_result_list.heap.items[x];
+		free_check_result(temp_cr);
+		my_free(temp_cr);
 	}
 
-	check_result_list = NULL;
+	minheap_free(&check_result_list.heap);
 
 	return OK;
 }
@@ -3107,6 +3605,9 @@ int free_check_result(check_result *info) {
 	my_free(info->service_description);
 	my_free(info->output_file);
 	my_free(info->output);
+	my_free(info->short_output);
+	my_free(info->long_output);
+	my_free(info->perf_data);
 
 	return OK;
 }
@@ -3148,21 +3649,13 @@ int open_command_file(void) {
 		return ERROR;
 	}
 
-	/* re-open the FIFO for use with fgets() */
-	if ((command_file_fp = (FILE *)fdopen(command_file_fd, "r")) == NULL) {
-
-		logit(NSLOG_RUNTIME_ERROR, TRUE, "错误: 使用 fdopen() 无法打开并读取额外命令文件: (%d) -> %s\n", errno, strerror(errno));
-
-		return ERROR;
-	}
-
 	/* initialize worker thread */
 	if (init_command_file_worker_thread() == ERROR) {
 
 		logit(NSLOG_RUNTIME_ERROR, TRUE, "错误: 无法初始化命令文件的工作线程.\n");
 
 		/* close the command file */
-		fclose(command_file_fp);
+		close(command_file_fd);
 
 		/* delete the named pipe */
 		unlink(command_file);
@@ -3192,7 +3685,7 @@ int close_command_file(void) {
 	command_file_created = FALSE;
 
 	/* close the command file */
-	fclose(command_file_fp);
+	close(command_file_fd);
 
 	return OK;
 }
@@ -3664,305 +4157,6 @@ int file_uses_embedded_perl(char *fname) {
 
 
 
-/******************************************************************/
-/************************ THREAD FUNCTIONS ************************/
-/******************************************************************/
-
-/* initializes command file worker thread */
-int init_command_file_worker_thread(void) {
-	int result = 0;
-	sigset_t newmask;
-
-	/* initialize circular buffer */
-	external_command_buffer.head = 0;
-	external_command_buffer.tail = 0;
-	external_command_buffer.items = 0;
-	external_command_buffer.high = 0;
-	external_command_buffer.overflow = 0L;
-	external_command_buffer.buffer = (void **)malloc(external_command_buffer_slots * sizeof(char **));
-	if (external_command_buffer.buffer == NULL)
-		return ERROR;
-
-	/* initialize mutex (only on cold startup) */
-	if (sigrestart == FALSE)
-		pthread_mutex_init(&external_command_buffer.buffer_lock, NULL);
-
-	/* new thread should block all signals */
-	sigfillset(&newmask);
-	pthread_sigmask(SIG_BLOCK, &newmask, NULL);
-
-	/* create worker thread */
-	result = pthread_create(&worker_threads[COMMAND_WORKER_THREAD], NULL, command_file_worker_thread, NULL);
-
-	/* main thread should unblock all signals */
-	pthread_sigmask(SIG_UNBLOCK, &newmask, NULL);
-
-	if (result)
-		return ERROR;
-
-	return OK;
-}
-
-
-/* shutdown command file worker thread */
-int shutdown_command_file_worker_thread(void) {
-	int result = 0;
-
-	/* 2010-01-04 AE:
-	 * calling pthread_cancel(0) will cause segfaults with some
-	 * thread libraries. It's possible that will happen if the
-	 * user has a number of config files larger than the max
-	 * open file descriptor limit (ulimit -n) and some retarded
-	 * eventbroker module leaks filedescriptors, since we'll then
-	 * enter the cleanup() routine from main() before we've
-	 * spawned any threads.
-	 */
-	if (worker_threads[COMMAND_WORKER_THREAD]) {
-		/* tell the worker thread to exit */
-		result = pthread_cancel(worker_threads[COMMAND_WORKER_THREAD]);
-
-		/* wait for the worker thread to exit */
-		if (result == 0) {
-			result = pthread_join(worker_threads[COMMAND_WORKER_THREAD], NULL);
-		}
-
-		/* we're being called from a fork()'ed child process - can't cancel thread, so just cleanup memory */
-		else {
-			cleanup_command_file_worker_thread(NULL);
-		}
-	}
-
-	return OK;
-}
-
-
-/* clean up resources used by command file worker thread */
-void cleanup_command_file_worker_thread(void *arg) {
-	register int x = 0;
-
-	/* release memory allocated to circular buffer */
-	for (x = external_command_buffer.tail; x != external_command_buffer.head; x = (x + 1) % external_command_buffer_slots) {
-		my_free(((char **)external_command_buffer.buffer)[x]);
-	}
-	my_free(external_command_buffer.buffer);
-
-	return;
-}
-
-
-
-/* worker thread - artificially increases buffer of named pipe */
-void * command_file_worker_thread(void *arg) {
-	char input_buffer[MAX_EXTERNAL_COMMAND_LENGTH];
-	struct pollfd pfd;
-	int pollval;
-	struct timeval tv;
-	int buffer_items = 0;
-	int result = 0;
-
-	/* specify cleanup routine */
-	pthread_cleanup_push(cleanup_command_file_worker_thread, NULL);
-
-	/* set cancellation info */
-	pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
-	pthread_setcanceltype(PTHREAD_CANCEL_DEFERRED, NULL);
-
-	while (1) {
-
-		/* should we shutdown? */
-		pthread_testcancel();
-
-		/* wait for data to arrive */
-		/* select seems to not work, so we have to use poll instead */
-		/* 10-15-08 EG check into implementing William's patch @ http://blog.netways.de/2008/08/15/nagios-unter-mac-os-x-installieren/ */
-		/* 10-15-08 EG poll() seems broken on OSX - see Jonathan's patch a few lines down */
-		pfd.fd = command_file_fd;
-		pfd.events = POLLIN;
-		pollval = poll(&pfd, 1, 500);
-
-		/* loop if no data */
-		if (pollval == 0)
-			continue;
-
-		/* check for errors */
-		if (pollval == -1) {
-
-			switch (errno) {
-			case EBADF:
-				write_to_log("command_file_worker_thread(): poll(): EBADF", logging_options, NULL);
-				break;
-			case ENOMEM:
-				write_to_log("command_file_worker_thread(): poll(): ENOMEM", logging_options, NULL);
-				break;
-			case EFAULT:
-				write_to_log("command_file_worker_thread(): poll(): EFAULT", logging_options, NULL);
-				break;
-			case EINTR:
-				/* this can happen when running under a debugger like gdb */
-				/*
-				write_to_log("command_file_worker_thread(): poll(): EINTR (impossible)",logging_options,NULL);
-				*/
-				break;
-			default:
-				write_to_log("command_file_worker_thread(): poll(): Unknown errno value.", logging_options, NULL);
-				break;
-			}
-
-			continue;
-		}
-
-		/* should we shutdown? */
-		pthread_testcancel();
-
-		/* get number of items in the buffer */
-		pthread_mutex_lock(&external_command_buffer.buffer_lock);
-		buffer_items = external_command_buffer.items;
-		pthread_mutex_unlock(&external_command_buffer.buffer_lock);
-
-#ifdef DEBUG_CFWT
-		printf("(CFWT) BUFFER ITEMS: %d/%d\n", buffer_items, external_command_buffer_slots);
-#endif
-
-		/* 10-15-08 Fix for OS X by Jonathan Saggau - see http://www.jonathansaggau.com/blog/2008/09/using_shark_and_custom_dtrace.html */
-		/* Not sure if this would have negative effects on other OSes... */
-		if (buffer_items == 0) {
-			/* pause a bit so OS X doesn't go nuts with CPU overload */
-			tv.tv_sec = 0;
-			tv.tv_usec = 500;
-			select(0, NULL, NULL, NULL, &tv);
-		}
-
-		/* process all commands in the file (named pipe) if there's some space in the buffer */
-		if (buffer_items < external_command_buffer_slots) {
-
-			/* clear EOF condition from prior run (FreeBSD fix) */
-			/* FIXME: use_poll_on_cmd_pipe: Still needed? */
-			clearerr(command_file_fp);
-
-			/* read and process the next command in the file */
-			while (fgets(input_buffer, (int)(sizeof(input_buffer) - 1), command_file_fp) != NULL) {
-
-#ifdef DEBUG_CFWT
-				printf("(CFWT) READ: %s", input_buffer);
-#endif
-
-				/* submit the external command for processing (retry if buffer is full) */
-				while ((result = submit_external_command(input_buffer, &buffer_items)) == ERROR && buffer_items == external_command_buffer_slots) {
-
-					/* wait a bit */
-					tv.tv_sec = 0;
-					tv.tv_usec = 250000;
-					select(0, NULL, NULL, NULL, &tv);
-
-					/* should we shutdown? */
-					pthread_testcancel();
-				}
-
-#ifdef DEBUG_CFWT
-				printf("(CFWT) RES: %d, BUFFER_ITEMS: %d/%d\n", result, buffer_items, external_comand_buffer_slots);
-#endif
-
-				/* bail if the circular buffer is full */
-				if (buffer_items == external_command_buffer_slots)
-					break;
-
-				/* should we shutdown? */
-				pthread_testcancel();
-			}
-		} else {
-			/* HB 06-07-2009:
-			 * We should wait for the event queuing to catch up some commands
-			 * from the buffer if for this atomic run the buffer is filled completely or
-			 * is overrun
-			  */
-			/* wait a bit */
-			tv.tv_sec = 0;
-			tv.tv_usec = 250000;
-			select(0, NULL, NULL, NULL, &tv);
-
-			/* should we shutdown? */
-			pthread_testcancel();
-		}
-	}
-
-	/* removes cleanup handler - this should never be reached */
-	pthread_cleanup_pop(0);
-
-	return NULL;
-}
-
-
-
-/* submits an external command for processing */
-int submit_external_command(char *cmd, int *buffer_items) {
-	int result = OK;
-
-	if (cmd == NULL || external_command_buffer.buffer == NULL) {
-		if (buffer_items != NULL)
-			*buffer_items = -1;
-		return ERROR;
-	}
-
-	/* obtain a lock for writing to the buffer */
-	pthread_mutex_lock(&external_command_buffer.buffer_lock);
-
-	if (external_command_buffer.items < external_command_buffer_slots) {
-
-		/* save the line in the buffer */
-		((char **)external_command_buffer.buffer)[external_command_buffer.head] = (char *)strdup(cmd);
-
-		/* increment the head counter and items */
-		external_command_buffer.head = (external_command_buffer.head + 1) % external_command_buffer_slots;
-		external_command_buffer.items++;
-		if (external_command_buffer.items > external_command_buffer.high)
-			external_command_buffer.high = external_command_buffer.items;
-	}
-
-	/* buffer was full */
-	else
-		result = ERROR;
-
-	/* return number of items now in buffer */
-	if (buffer_items != NULL)
-		*buffer_items = external_command_buffer.items;
-
-	/* release lock on buffer */
-	pthread_mutex_unlock(&external_command_buffer.buffer_lock);
-
-	return result;
-}
-
-
-
-/* submits a raw external command (without timestamp) for processing */
-int submit_raw_external_command(char *cmd, time_t *ts, int *buffer_items) {
-	char *newcmd = NULL;
-	int result = OK;
-	time_t timestamp;
-
-	if (cmd == NULL)
-		return ERROR;
-
-	/* get the time */
-	if (ts != NULL)
-		timestamp = *ts;
-	else
-		time(&timestamp);
-
-	/* create the command string */
-	dummy = asprintf(&newcmd, "[%lu] %s", (unsigned long)timestamp, cmd);
-
-	/* submit the command */
-	result = submit_external_command(newcmd, buffer_items);
-
-	/* free allocated memory */
-	my_free(newcmd);
-
-	return result;
-}
-
-
-
 /******************************************************************/
 /********************** CHECK STATS FUNCTIONS *********************/
 /******************************************************************/
@@ -4263,8 +4457,6 @@ void cleanup(void) {
 
 /* free the memory allocated to the linked lists */
 void free_memory(icinga_macros *mac) {
-	timed_event *this_event = NULL;
-	timed_event *next_event = NULL;
 
 	/* free all allocated memory for the object definitions */
 	free_object_data();
@@ -4275,31 +4467,14 @@ void free_memory(icinga_macros *mac) {
 	/* free check result list */
 	free_check_result_list();
 
-	/* free memory for the high priority event list */
-	this_event = event_list_high;
-	while (this_event != NULL) {
-		if (this_event->event_type == EVENT_SCHEDULED_DOWNTIME)
-			my_free(this_event->event_data);
-		next_event = this_event->next;
-		my_free(this_event);
-		this_event = next_event;
-	}
+	/* free the freshness and orphan check deadlines */
+	free_check_deadline_queues();
 
-	/* reset the event pointer */
-	event_list_high = NULL;
-
-	/* free memory for the low priority event list */
-	this_event = event_list_low;
-	while (this_event != NULL) {
-		if (this_event->event_type == EVENT_SCHEDULED_DOWNTIME)
-			my_free(this_event->event_data);
-		next_event = this_event->next;
-		my_free(this_event);
-		this_event = next_event;
-	}
+	/* free memory for the high priority event queue */
+	free_event_queue(&event_queue_high);
 
-	/* reset the event pointer */
-	event_list_low = NULL;
+	/* free memory for the low priority event queue */
+	free_event_queue(&event_queue_low);
 
 	/* free memory for global event handlers */
 	my_free(global_host_event_handler);
@@ -4503,8 +4678,12 @@ int reset_variables(void) {
 
 	use_large_installation_tweaks = DEFAULT_USE_LARGE_INSTALLATION_TWEAKS;
 	enable_environment_macros = TRUE;
+	lazy_environment_macros = FALSE;
 	free_child_process_memory = -1;
 	child_processes_fork_twice = -1;
+	check_worker_processes = DEFAULT_CHECK_WORKER_PROCESSES;
+	check_result_reaper_threads = DEFAULT_CHECK_RESULT_REAPER_THREADS;
+	max_async_commands = DEFAULT_MAX_ASYNC_COMMANDS;
 
 	additional_freshness_latency = DEFAULT_ADDITIONAL_FRESHNESS_LATENCY;
 
@@ -0,0 +1,1107 @@
+/*****************************************************************************
+ *
+ * WORKERS.C - Persistent check worker processes for Icinga
+ *
+ * Copyright (c) 2009-2013 Icinga Development Team (http://www.icinga.org)
+ *
+ * License:
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *****************************************************************************/
+
+/*
+ * Every active check normally costs a fork() of the whole core process
+ * (twice, unless child_processes_fork_twice is disabled), and the result
+ * makes a round trip through a file in check_result_path.
+ *
+ * With check_worker_processes > 0 the core instead starts a few worker
+ * processes once. The core sends fully macro-expanded command lines to
+ * them over a socketpair, the workers spawn the plugins with posix_spawn()
+ * (which does not copy the worker's address space), enforce the check
+ * timeout and stream the results back. The core turns the results into
+ * check_result items and puts them straight onto the check result list.
+ *
+ * Whenever a check cannot be handed to a worker, the caller falls back to
+ * the fork()ing code path in checks.c.
+ *
+ * With max_async_commands > 0 the workers also run notification, event
+ * handler and OCSP/OCHP commands. Those are queued with the macro
+ * environment of the moment, at most max_async_commands of them run at
+ * once, and the caller's completion handler gets their outcome once the
+ * event loop picks up the response.
+ */
+
+#include "../include/config.h"
+#include "../include/common.h"
+#include "../include/objects.h"
+#include "../include/macros.h"
+#include "../include/icinga.h"
+#include "../include/broker.h"
+
+#include <spawn.h>
+#include <poll.h>
+#include <sys/socket.h>
+
+#ifdef EMBEDDEDPERL
+#include "../include/epn_icinga.h"
+#endif
+
+extern char **environ;
+
+extern int      check_worker_processes;
+extern int      max_async_commands;
+extern int      enable_environment_macros;
+extern int      service_check_timeout_state;
+
+extern unsigned long max_debug_file_size;
+extern unsigned long check_result_channel_stats[CHECK_RESULT_CHANNELS];
+extern async_command_stats async_command_statistics;
+
+#ifdef EMBEDDEDPERL
+extern int      use_embedded_perl;
+#endif
+
+#define CHECK_WORKER_JOB_SLOTS		1024		/* size of the pending job hash */
+#define CHECK_WORKER_READ_SIZE		65536		/* bytes read from a socket or pipe at once */
+
+/* sent from the core to a worker, followed by the command line and the environment block */
+typedef struct check_worker_request_struct {
+	unsigned long job_id;
+	int timeout;
+	unsigned int command_length;			/* including the terminating NUL */
+	unsigned int environment_length;		/* NUL-separated NAME=VALUE strings */
+} check_worker_request;
+
+/* sent from a worker to the core, followed by the raw plugin output */
+typedef struct check_worker_response_struct {
+	unsigned long job_id;
+	int return_code;
+	int early_timeout;
+	int exited_ok;
+	struct timeval finish_time;
+	unsigned int output_length;			/* including the terminating NUL */
+} check_worker_response;
+
+/* worker process as seen from the core */
+typedef struct check_worker_struct {
+	pid_t pid;
+	int sd;
+	int running_jobs;
+	char *buf;					/* partially received responses */
+	unsigned long buf_used;
+	unsigned long buf_size;
+} check_worker;
+
+/* notification, event handler or OCSP/OCHP command waiting for a slot or running in a worker */
+typedef struct async_command_struct {
+	char *command_line;
+	char *environment;
+	unsigned long environment_length;
+	int timeout;
+	struct timeval queued_time;
+	struct timeval start_time;
+	void (*handler)(void *, char *, int, int, double, struct timeval *, char *);	/* return code, early timeout, execution time, end time, output */
+	void *data;
+	struct async_command_struct *next;
+} async_command;
+
+/* check or command waiting for its result, as seen from the core */
+typedef struct check_worker_job_struct {
+	unsigned long job_id;
+	int worker;
+	check_result *cr;				/* NULL for asynchronous commands */
+	async_command *command;
+	struct check_worker_job_struct *next;
+} check_worker_job;
+
+/* plugin run by a worker process */
+typedef struct worker_plugin_struct {
+	unsigned long job_id;
+	pid_t pid;
+	int fd;
+	int reaped;
+	int wait_status;
+	int early_timeout;
+	time_t deadline;
+	dbuf output;
+} worker_plugin;
+
+static check_worker *check_workers = NULL;
+static int num_check_workers = 0;
+static check_worker_job *check_worker_jobs[CHECK_WORKER_JOB_SLOTS];
+static unsigned long next_check_worker_job_id = 1L;
+static async_command *async_command_queue = NULL;
+static async_command *async_command_queue_tail = NULL;
+
+static int spawn_check_worker(int);
+static int check_worker_main(int);
+static void start_async_commands(void);
+static void finish_async_command(async_command *, int, int, struct timeval *, char *);
+static void flush_async_commands(void);
+
+
+/******************************************************************/
+/********************** LOW LEVEL I/O FUNCTIONS *******************/
+/******************************************************************/
+
+/* writes a whole buffer to a (blocking) descriptor */
+static int write_all(int fd, const char *buf, size_t len) {
+	ssize_t result = 0;
+
+	while (len > 0) {
+		result = send(fd, buf, len, MSG_NOSIGNAL);
+		if (result < 0) {
+			if (errno == EINTR)
+				continue;
+			return ERROR;
+		}
+		buf += result;
+		len -= (size_t)result;
+	}
+
+	return OK;
+}
+
+
+/* appends raw bytes to a growable buffer */
+static int append_buffer(char **buf, unsigned long *used, unsigned long *size, const char *data, unsigned long len) {
+	char *new_buf = NULL;
+	unsigned long new_size = 0L;
+
+	if (*used + len > *size) {
+		new_size = (*size == 0L) ? CHECK_WORKER_READ_SIZE : *size;
+		while (new_size < *used + len)
+			new_size *= 2;
+		if ((new_buf = (char *)realloc(*buf, new_size)) == NULL)
+			return ERROR;
+		*buf = new_buf;
+		*size = new_size;
+	}
+
+	memcpy(*buf + *used, data, len);
+	*used += len;
+
+	return OK;
+}
+
+
+/* removes consumed bytes from the front of a buffer */
+static void consume_buffer(char *buf, unsigned long *used, unsigned long len) {
+
+	if (len < *used)
+		memmove(buf, buf + len, *used - len);
+	*used -= len;
+}
+
+
+/******************************************************************/
+/************************* CORE FUNCTIONS *************************/
+/******************************************************************/
+
+/* starts the configured number of check worker processes */
+int init_check_workers(void) {
+	int workers = check_worker_processes;
+	int x = 0;
+
+	/* asynchronous commands need at least one worker, even if checks are forked */
+	if (workers <= 0 && max_async_commands > 0)
+		workers = 1;
+	if (workers <= 0)
+		return OK;
+
+	log_debug_info(DEBUGL_FUNCTIONS, 0, "init_check_workers()\n");
+
+	if ((check_workers = (check_worker *)calloc(workers, sizeof(check_worker))) == NULL) {
+		logit(NSLOG_RUNTIME_ERROR, TRUE, "Error: Could not allocate memory for check workers, checks will be forked as usual.\n");
+		return ERROR;
+	}
+	num_check_workers = workers;
+
+	for (x = 0; x < num_check_workers; x++) {
+		check_workers[x].sd = -1;
+		if (spawn_check_worker(x) == ERROR)
+			logit(NSLOG_RUNTIME_WARNING, TRUE, "Warning: Could not start check worker #%d: %s\n", x, strerror(errno));
+	}
+
+	logit(NSLOG_PROCESS_INFO, FALSE, "Started %d check worker processes.\n", num_check_workers);
+
+	return OK;
+}
+
+
+/* forks a single check worker process */
+static int spawn_check_worker(int worker) {
+	int sv[2];
+	pid_t pid = 0;
+	int x = 0;
+
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0)
+		return ERROR;
+
+	if ((pid = fork()) < 0) {
+		close(sv[0]);
+		close(sv[1]);
+		return ERROR;
+	}
+
+	/* the worker process */
+	if (pid == 0) {
+
+		close(sv[0]);
+
+		/* don't hold on to the sockets of the other workers */
+		for (x = 0; x < num_check_workers; x++) {
+			if (check_workers[x].sd >= 0)
+				close(check_workers[x].sd);
+		}
+
+		/* workers have no use for the external command file or the check result channel */
+		close_command_file();
+		close_check_result_channel();
+
+		reset_sighandler();
+		signal(SIGPIPE, SIG_IGN);
+
+		/* the core closes our socket once it is done with us, until then queued commands still get run */
+		signal(SIGTERM, SIG_IGN);
+		signal(SIGINT, SIG_IGN);
+		signal(SIGHUP, SIG_IGN);
+
+		/* disable rotation of the debug file */
+		max_debug_file_size = 0L;
+
+		_exit(check_worker_main(sv[1]));
+	}
+
+	/* the core */
+	close(sv[1]);
+	fcntl(sv[0], F_SETFD, FD_CLOEXEC);
+
+	check_workers[worker].pid = pid;
+	check_workers[worker].sd = sv[0];
+	check_workers[worker].running_jobs = 0;
+	check_workers[worker].buf_used = 0L;
+
+	log_debug_info(DEBUGL_CHECKS | DEBUGL_IPC, 1, "Started check worker #%d (pid=%lu)\n", worker, (unsigned long)pid);
+
+	return OK;
+}
+
+
+/* stops all check worker processes */
+int shutdown_check_workers(void) {
+	check_worker_job *job = NULL;
+	check_worker_job *next_job = NULL;
+	int x = 0;
+
+	if (check_workers == NULL)
+		return OK;
+
+	log_debug_info(DEBUGL_FUNCTIONS, 0, "shutdown_check_workers()\n");
+
+	/* notifications and event handlers that were already queued still get run */
+	flush_async_commands();
+
+	/* workers exit (and kill their plugins) once they see their socket being closed */
+	for (x = 0; x < num_check_workers; x++) {
+		if (check_workers[x].sd >= 0)
+			close(check_workers[x].sd);
+	}
+	for (x = 0; x < num_check_workers; x++) {
+		if (check_workers[x].pid > 0)
+			waitpid(check_workers[x].pid, NULL, 0);
+		my_free(check_workers[x].buf);
+	}
+
+	/* results of checks that were still running are lost */
+	for (x = 0; x < CHECK_WORKER_JOB_SLOTS; x++) {
+		for (job = check_worker_jobs[x]; job != NULL; job = next_job) {
+			next_job = job->next;
+			if (job->command != NULL)
+				finish_async_command(job->command, STATE_UNKNOWN, FALSE, NULL, "(Check worker exited before the command finished)");
+			else {
+				free_check_result(job->cr);
+				my_free(job->cr);
+			}
+			my_free(job);
+		}
+		check_worker_jobs[x] = NULL;
+	}
+
+	my_free(check_workers);
+	num_check_workers = 0;
+
+	return OK;
+}
+
+
+/* can this command line be run by a worker? */
+static int worker_can_run(char *processed_command) {
+#ifdef EMBEDDEDPERL
+	char fname[512] = "";
+#endif
+
+	if (check_workers == NULL || processed_command == NULL)
+		return FALSE;
+
+#ifdef EMBEDDEDPERL
+	/* the embedded Perl interpreter lives in the core, so those plugins have to be forked as before */
+	if (use_embedded_perl == TRUE) {
+		strncpy(fname, processed_command, sizeof(fname) - 1);
+		fname[strcspn(fname, " ")] = '\x0';
+		if (file_uses_embedded_perl(fname) == TRUE)
+			return FALSE;
+	}
+#endif
+
+	return TRUE;
+}
+
+
+/* can this check command line be run by a check worker? */
+int check_worker_can_run(char *processed_command) {
+
+	/* workers that only exist for asynchronous commands don't run checks */
+	if (check_worker_processes <= 0)
+		return FALSE;
+
+	return worker_can_run(processed_command);
+}
+
+
+/* collects the macro environment variables for a check as a NUL-separated block */
+static char *get_macro_environment_block(icinga_macros *mac, unsigned long *len) {
+	char *block = NULL;
+	unsigned long used = 0L;
+	unsigned long size = 0L;
+	size_t prefix_len = strlen(MACRO_ENV_VAR_PREFIX);
+	char **env = NULL;
+
+	*len = 0L;
+
+	if (enable_environment_macros == FALSE)
+		return NULL;
+
+	set_all_macro_environment_vars_r(mac, TRUE);
+	for (env = environ; env != NULL && *env != NULL; env++) {
+		if (strncmp(*env, MACRO_ENV_VAR_PREFIX, prefix_len))
+			continue;
+		if (append_buffer(&block, &used, &size, *env, strlen(*env) + 1) == ERROR)
+			break;
+	}
+	set_all_macro_environment_vars_r(mac, FALSE);
+
+	*len = used;
+
+	return block;
+}
+
+
+/* sends a check or command to the least busy worker and registers it as a pending job */
+static int send_to_worker(char *command_line, char *environment, unsigned long environment_length, int timeout, check_result *cr, async_command *command) {
+	check_worker_request request;
+	check_worker_job *new_job = NULL;
+	int worker = -1;
+	int x = 0;
+
+	if (check_workers == NULL)
+		return ERROR;
+
+	for (x = 0; x < num_check_workers; x++) {
+		if (check_workers[x].sd < 0)
+			continue;
+		if (worker < 0 || check_workers[x].running_jobs < check_workers[worker].running_jobs)
+			worker = x;
+	}
+	if (worker < 0)
+		return ERROR;
+
+	if ((new_job = (check_worker_job *)malloc(sizeof(check_worker_job))) == NULL)
+		return ERROR;
+
+	memset(&request, 0, sizeof(request));
+	request.job_id = next_check_worker_job_id++;
+	request.timeout = timeout;
+	request.command_length = strlen(command_line) + 1;
+	request.environment_length = environment_length;
+
+	if (write_all(check_workers[worker].sd, (char *)&request, sizeof(request)) == ERROR
+	        || write_all(check_workers[worker].sd, command_line, request.command_length) == ERROR
+	        || (environment_length > 0 && write_all(check_workers[worker].sd, environment, environment_length) == ERROR)) {
+
+		logit(NSLOG_RUNTIME_WARNING, TRUE, "Warning: Could not send %s to worker #%d: %s\n", (cr != NULL) ? "check" : "command", worker, strerror(errno));
+		my_free(new_job);
+		return ERROR;
+	}
+
+	new_job->job_id = request.job_id;
+	new_job->worker = worker;
+	new_job->cr = cr;
+	new_job->command = command;
+	new_job->next = check_worker_jobs[request.job_id % CHECK_WORKER_JOB_SLOTS];
+	check_worker_jobs[request.job_id % CHECK_WORKER_JOB_SLOTS] = new_job;
+
+	check_workers[worker].running_jobs++;
+
+	log_debug_info(DEBUGL_CHECKS | DEBUGL_IPC, 1, "%s job #%lu sent to worker #%d\n", (cr != NULL) ? "Check" : "Command", request.job_id, worker);
+
+	return OK;
+}
+
+
+/* hands a check to the least busy worker - the check result is completed when the worker responds */
+int submit_check_to_worker(check_result *cr, icinga_macros *mac, char *processed_command, int timeout) {
+	char *environment = NULL;
+	unsigned long environment_length = 0L;
+	int result = OK;
+
+	if (check_workers == NULL)
+		return ERROR;
+
+	environment = get_macro_environment_block(mac, &environment_length);
+	result = send_to_worker(processed_command, environment, environment_length, timeout, cr, NULL);
+	my_free(environment);
+
+	return result;
+}
+
+
+/* queues a notification, event handler or OCSP/OCHP command - the handler is called once it has finished */
+int run_async_command(icinga_macros *mac, char *processed_command, int timeout, void (*handler)(void *, char *, int, int, double, struct timeval *, char *), void *data) {
+	async_command *new_command = NULL;
+
+	if (max_async_commands <= 0 || worker_can_run(processed_command) == FALSE)
+		return ERROR;
+
+	if ((new_command = (async_command *)calloc(1, sizeof(async_command))) == NULL)
+		return ERROR;
+	if ((new_command->command_line = (char *)strdup(processed_command)) == NULL) {
+		my_free(new_command);
+		return ERROR;
+	}
+
+	/* the macros are only valid right now, so the environment is taken along */
+	new_command->environment = get_macro_environment_block(mac, &new_command->environment_length);
+	new_command->timeout = timeout;
+	new_command->handler = handler;
+	new_command->data = data;
+	gettimeofday(&new_command->queued_time, NULL);
+
+	if (async_command_queue_tail == NULL)
+		async_command_queue = new_command;
+	else
+		async_command_queue_tail->next = new_command;
+	async_command_queue_tail = new_command;
+
+	async_command_statistics.queued++;
+	if (async_command_statistics.queued > async_command_statistics.max_queued)
+		async_command_statistics.max_queued = async_command_statistics.queued;
+
+	log_debug_info(DEBUGL_COMMANDS, 1, "Queued asynchronous command (%d queued, %d running): %s\n", async_command_statistics.queued, async_command_statistics.running, processed_command);
+
+	/* start it right away if there is a free slot */
+	start_async_commands();
+
+	return OK;
+}
+
+
+/* hands queued commands to the workers while there are free slots */
+static void start_async_commands(void) {
+	async_command *command = NULL;
+#ifdef USE_EVENT_BROKER
+	struct timeval end_time;
+#endif
+	double latency = 0.0;
+
+	while (async_command_queue != NULL && async_command_statistics.running < max_async_commands) {
+
+		command = async_command_queue;
+		gettimeofday(&command->start_time, NULL);
+
+		/* leave it queued if no worker can take it right now */
+		if (send_to_worker(command->command_line, command->environment, command->environment_length, command->timeout, NULL, command) == ERROR)
+			break;
+
+		async_command_queue = command->next;
+		if (async_command_queue == NULL)
+			async_command_queue_tail = NULL;
+		command->next = NULL;
+		my_free(command->environment);
+
+		latency = (double)(command->start_time.tv_sec - command->queued_time.tv_sec) + ((double)(command->start_time.tv_usec - command->queued_time.tv_usec) / 1000000.0);
+		async_command_statistics.queued--;
+		async_command_statistics.running++;
+		async_command_statistics.total_queue_latency += latency;
+		if (latency > async_command_statistics.max_queue_latency)
+			async_command_statistics.max_queue_latency = latency;
+
+#ifdef USE_EVENT_BROKER
+		/* send data to event broker */
+		end_time.tv_sec = 0L;
+		end_time.tv_usec = 0L;
+		broker_system_command(NEBTYPE_SYSTEM_COMMAND_START, NEBFLAG_NONE, NEBATTR_NONE, command->start_time, end_time, 0.0, command->timeout, FALSE, 0, command->command_line, NULL, NULL);
+#endif
+	}
+}
+
+
+/* completes the commands the workers have finished and starts queued ones */
+int handle_async_commands(void) {
+
+	if (async_command_queue == NULL && async_command_statistics.running == 0)
+		return OK;
+
+	/* results of finished commands (and checks) */
+	if (async_command_statistics.running > 0)
+		read_check_worker_results();
+
+	start_async_commands();
+
+	return OK;
+}
+
+
+/* waits for all queued and running commands to finish, their timeouts are enforced by the workers */
+static void flush_async_commands(void) {
+	async_command *command = NULL;
+	struct pollfd *pfds = NULL;
+	int num_pfds = 0;
+	int x = 0;
+
+	if (async_command_queue == NULL && async_command_statistics.running == 0)
+		return;
+
+	log_debug_info(DEBUGL_COMMANDS, 0, "Waiting for %d queued and %d running asynchronous commands to finish...\n", async_command_statistics.queued, async_command_statistics.running);
+
+	if ((pfds = (struct pollfd *)calloc(num_check_workers, sizeof(struct pollfd))) != NULL) {
+
+		while (async_command_queue != NULL || async_command_statistics.running > 0) {
+
+			handle_async_commands();
+			if (async_command_queue == NULL && async_command_statistics.running == 0)
+				break;
+
+			for (x = 0, num_pfds = 0; x < num_check_workers; x++) {
+				if (check_workers[x].sd < 0)
+					continue;
+				pfds[num_pfds].fd = check_workers[x].sd;
+				pfds[num_pfds].events = POLLIN;
+				pfds[num_pfds].revents = 0;
+				num_pfds++;
+			}
+			if (num_pfds == 0)
+				break;
+
+			poll(pfds, num_pfds, 1000);
+		}
+
+		my_free(pfds);
+	}
+
+	/* commands that could not be started at all */
+	while ((command = async_command_queue) != NULL) {
+		async_command_queue = command->next;
+		async_command_statistics.queued--;
+		async_command_statistics.running++;
+		finish_async_command(command, STATE_UNKNOWN, FALSE, NULL, "(No check worker was available to run the command)");
+	}
+	async_command_queue_tail = NULL;
+}
+
+
+/* removes a pending job from the job hash */
+static check_worker_job *remove_check_worker_job(unsigned long job_id) {
+	check_worker_job **job_ptr = NULL;
+	check_worker_job *job = NULL;
+
+	for (job_ptr = &check_worker_jobs[job_id % CHECK_WORKER_JOB_SLOTS]; *job_ptr != NULL; job_ptr = &(*job_ptr)->next) {
+		if ((*job_ptr)->job_id == job_id) {
+			job = *job_ptr;
+			*job_ptr = job->next;
+			return job;
+		}
+	}
+
+	return NULL;
+}
+
+
+/* completes an asynchronous command and hands its outcome to the handler */
+static void finish_async_command(async_command *command, int return_code, int early_timeout, struct timeval *finish_time, char *output) {
+	struct timeval end_time;
+	double exectime = 0.0;
+
+	if (finish_time != NULL)
+		end_time = *finish_time;
+	else
+		gettimeofday(&end_time, NULL);
+	if (command->start_time.tv_sec == 0L)
+		command->start_time = end_time;
+	exectime = (double)(end_time.tv_sec - command->start_time.tv_sec) + ((double)(end_time.tv_usec - command->start_time.tv_usec) / 1000000.0);
+	if (exectime < 0.0)
+		exectime = 0.0;
+
+	/* same return code handling as my_system_r() */
+	if (early_timeout == TRUE) {
+		return_code = STATE_CRITICAL;
+		output = NULL;
+	} else {
+		if (return_code == 126 || return_code == 127)
+			logit(NSLOG_RUNTIME_WARNING, TRUE, "警报: 试图执行命令 \"%s\" 结果,返回%d代码. 确保您尝试执行脚本或二进制确实存在...\n", command->command_line, return_code);
+		if (return_code < -1 || return_code > 3)
+			return_code = STATE_UNKNOWN;
+	}
+
+	async_command_statistics.running--;
+	async_command_statistics.completed++;
+	async_command_statistics.total_execution_time += exectime;
+	if (early_timeout == TRUE)
+		async_command_statistics.timed_out++;
+
+	log_debug_info(DEBUGL_COMMANDS, 1, "执行时间=%.3f sec, 初期超时=%d, 结果=%d, 输出=%s\n", exectime, early_timeout, return_code, (output == NULL) ? "(null)" : output);
+
+#ifdef USE_EVENT_BROKER
+	/* send data to event broker */
+	broker_system_command(NEBTYPE_SYSTEM_COMMAND_END, NEBFLAG_NONE, NEBATTR_NONE, command->start_time, end_time, exectime, command->timeout, early_timeout, return_code, command->command_line, output, NULL);
+#endif
+
+	if (command->handler != NULL)
+		command->handler(command->data, command->command_line, return_code, early_timeout, exectime, &end_time, output);
+
+	my_free(command->command_line);
+	my_free(command->environment);
+	my_free(command);
+}
+
+
+/* completes a check result with the data reported by a worker and queues it for the reaper */
+static void finish_check_worker_job(check_worker_job *job, int return_code, int early_timeout, int exited_ok, struct timeval *finish_time, char *output) {
+	check_result *cr = job->cr;
+
+	if (check_workers != NULL && job->worker < num_check_workers)
+		check_workers[job->worker].running_jobs--;
+
+	if (job->command != NULL) {
+		finish_async_command(job->command, return_code, early_timeout, finish_time, output);
+		my_free(job);
+		return;
+	}
+
+	cr->finish_time = *finish_time;
+	cr->early_timeout = early_timeout;
+	cr->exited_ok = exited_ok;
+	cr->return_code = return_code;
+
+	/* timed out checks look the same as they do when forked */
+	if (early_timeout == TRUE) {
+		if (cr->object_check_type == SERVICE_CHECK) {
+			cr->return_code = service_check_timeout_state;
+			cr->output = (char *)strdup("(服务检查超时)");
+		} else {
+			cr->return_code = STATE_CRITICAL;
+			cr->output = (char *)strdup("(主机检查超时)");
+		}
+	} else
+		cr->output = escape_newlines((output == NULL) ? "" : output);
+
+	if (cr->output == NULL)
+		cr->output = (char *)strdup("(null)");
+
+	add_check_result_to_list(cr);
+	check_result_channel_stats[CHECK_RESULT_CHANNEL_WORKER]++;
+	my_free(job);
+}
+
+
+/* a worker went away - fail its checks and start a new one */
+static void restart_check_worker(int worker) {
+	check_worker_job *job = NULL;
+	check_worker_job *next_job = NULL;
+	struct timeval now;
+	int x = 0;
+
+	logit(NSLOG_RUNTIME_WARNING, TRUE, "Warning: Check worker #%d (pid=%lu) exited unexpectedly, restarting it.\n", worker, (unsigned long)check_workers[worker].pid);
+
+	close(check_workers[worker].sd);
+	check_workers[worker].sd = -1;
+	if (check_workers[worker].pid > 0)
+		waitpid(check_workers[worker].pid, NULL, WNOHANG);
+	check_workers[worker].pid = 0;
+	check_workers[worker].buf_used = 0L;
+
+	gettimeofday(&now, NULL);
+	for (x = 0; x < CHECK_WORKER_JOB_SLOTS; x++) {
+		for (job = check_worker_jobs[x]; job != NULL; job = next_job) {
+			next_job = job->next;
+			if (job->worker != worker)
+				continue;
+			remove_check_worker_job(job->job_id);
+			finish_check_worker_job(job, STATE_UNKNOWN, FALSE, FALSE, &now, (job->command != NULL) ? "(Check worker exited before the command finished)" : "(Check worker exited before the check finished)");
+		}
+	}
+	check_workers[worker].running_jobs = 0;
+
+	if (spawn_check_worker(worker) == ERROR)
+		logit(NSLOG_RUNTIME_WARNING, TRUE, "Warning: Could not restart check worker #%d: %s\n", worker, strerror(errno));
+}
+
+
+/* reads all results the workers have sent so far and puts them on the check result list */
+int read_check_worker_results(void) {
+	check_worker_response response;
+	check_worker_job *job = NULL;
+	check_worker *worker = NULL;
+	char buf[CHECK_WORKER_READ_SIZE];
+	unsigned long frame_length = 0L;
+	ssize_t bytes_read = 0;
+	int results = 0;
+	int x = 0;
+
+	if (check_workers == NULL)
+		return 0;
+
+	for (x = 0; x < num_check_workers; x++) {
+
+		worker = &check_workers[x];
+		if (worker->sd < 0)
+			continue;
+
+		/* drain the socket without blocking */
+		while ((bytes_read = recv(worker->sd, buf, sizeof(buf), MSG_DONTWAIT)) > 0) {
+			if (append_buffer(&worker->buf, &worker->buf_used, &worker->buf_size, buf, (unsigned long)bytes_read) == ERROR)
+				break;
+		}
+
+		/* process all complete responses */
+		while (worker->buf_used >= sizeof(response)) {
+
+			memcpy(&response, worker->buf, sizeof(response));
+			frame_length = sizeof(response) + response.output_length;
+			if (worker->buf_used < frame_length)
+				break;
+
+			if ((job = remove_check_worker_job(response.job_id)) == NULL)
+				log_debug_info(DEBUGL_CHECKS | DEBUGL_IPC, 0, "Worker #%d returned a result for unknown job #%lu\n", x, response.job_id);
+			else {
+				/* make sure the output is terminated, whatever the plugin wrote */
+				if (response.output_length > 0)
+					worker->buf[frame_length - 1] = '\x0';
+				finish_check_worker_job(job, response.return_code, response.early_timeout, response.exited_ok, &response.finish_time, (response.output_length > 0) ? worker->buf + sizeof(response) : NULL);
+				results++;
+			}
+
+			consume_buffer(worker->buf, &worker->buf_used, frame_length);
+		}
+
+		/* the worker died */
+		if (bytes_read == 0 || (bytes_read < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+			restart_check_worker(x);
+	}
+
+	if (results > 0)
+		log_debug_info(DEBUGL_CHECKS | DEBUGL_IPC, 1, "Received %d check results from check workers\n", results);
+
+	return results;
+}
+
+
+/******************************************************************/
+/************************ WORKER FUNCTIONS ************************/
+/******************************************************************/
+
+/* starts a plugin, its stdout and stderr go to a pipe we read from */
+static int start_worker_plugin(worker_plugin *plugin, char *command, char **envp) {
+	posix_spawn_file_actions_t file_actions;
+	posix_spawnattr_t attr;
+	sigset_t signals;
+	char *argv[MAX_CMD_ARGS];
+	char *shell_argv[4] = { "/bin/sh", "-c", NULL, NULL };
+	char *parsed_command = NULL;
+	int pipefds[2];
+	int result = 0;
+
+	if (pipe(pipefds) < 0)
+		return errno;
+	fcntl(pipefds[0], F_SETFD, FD_CLOEXEC);
+
+	posix_spawn_file_actions_init(&file_actions);
+	posix_spawn_file_actions_adddup2(&file_actions, pipefds[1], STDOUT_FILENO);
+	posix_spawn_file_actions_adddup2(&file_actions, pipefds[1], STDERR_FILENO);
+	posix_spawn_file_actions_addclose(&file_actions, pipefds[1]);
+
+	/* plugins get their own process group, so timeouts can kill all of their children */
+	posix_spawnattr_init(&attr);
+	sigfillset(&signals);
+	posix_spawnattr_setsigdefault(&attr, &signals);
+	sigemptyset(&signals);
+	posix_spawnattr_setsigmask(&attr, &signals);
+	posix_spawnattr_setpgroup(&attr, 0);
+	posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP | POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_SETSIGMASK);
+
+	/* same execution method (shell or execvp) as forked checks use */
+	if (has_shell_metachars(command)) {
+		shell_argv[2] = command;
+		result = posix_spawn(&plugin->pid, shell_argv[0], &file_actions, &attr, shell_argv, envp);
+	} else {
+		parsed_command = (char *)strdup(command);
+		if (parsed_command == NULL || parse_command_line(parsed_command, argv) == ERROR || argv[0] == NULL)
+			result = EINVAL;
+		else
+			result = posix_spawnp(&plugin->pid, argv[0], &file_actions, &attr, argv, envp);
+		my_free(parsed_command);
+	}
+
+	posix_spawn_file_actions_destroy(&file_actions);
+	posix_spawnattr_destroy(&attr);
+	close(pipefds[1]);
+
+	if (result != 0) {
+		close(pipefds[0]);
+		return result;
+	}
+
+	plugin->fd = pipefds[0];
+
+	return 0;
+}
+
+
+/* queues the result of a finished plugin for the core */
+static void send_worker_result(worker_plugin *plugin, int return_code, int exited_ok, char **out, unsigned long *out_used, unsigned long *out_size) {
+	check_worker_response response;
+
+	memset(&response, 0, sizeof(response));
+	response.job_id = plugin->job_id;
+	response.return_code = return_code;
+	response.early_timeout = plugin->early_timeout;
+	response.exited_ok = exited_ok;
+	gettimeofday(&response.finish_time, NULL);
+	response.output_length = (plugin->output.buf == NULL) ? 0 : plugin->output.used_size + 1;
+
+	append_buffer(out, out_used, out_size, (char *)&response, sizeof(response));
+	if (response.output_length > 0)
+		append_buffer(out, out_used, out_size, plugin->output.buf, response.output_length);
+}
+
+
+/* main loop of a check worker process */
+static int check_worker_main(int sd) {
+	check_worker_request request;
+	worker_plugin *plugins = NULL;
+	worker_plugin *plugin = NULL;
+	struct pollfd *pfds = NULL;
+	char buf[CHECK_WORKER_READ_SIZE];
+	char *in = NULL, *out = NULL;
+	unsigned long in_used = 0L, in_size = 0L;
+	unsigned long out_used = 0L, out_size = 0L;
+	unsigned long frame_length = 0L;
+	char **envp = NULL;
+	char *command = NULL;
+	char *env_ptr = NULL;
+	int num_plugins = 0, max_plugins = 0;
+	int num_env = 0, num_pfds = 0;
+	int core_gone = FALSE;
+	int poll_timeout = 0;
+	int return_code = 0;
+	int result = 0;
+	time_t current_time = 0L;
+	ssize_t bytes = 0;
+	int x = 0, y = 0;
+
+	fcntl(sd, F_SETFD, FD_CLOEXEC);
+	fcntl(sd, F_SETFL, fcntl(sd, F_GETFL) | O_NONBLOCK);
+
+	while (core_gone == FALSE || num_plugins > 0) {
+
+		/* the core is gone, don't leave plugins behind */
+		if (core_gone == TRUE) {
+			for (x = 0; x < num_plugins; x++) {
+				if (plugins[x].reaped == FALSE) {
+					kill(-plugins[x].pid, SIGKILL);
+					waitpid(plugins[x].pid, NULL, 0);
+				}
+				if (plugins[x].fd >= 0)
+					close(plugins[x].fd);
+			}
+			break;
+		}
+
+		/* build the poll set: the core socket first, then every plugin still writing output */
+		if ((pfds = (struct pollfd *)realloc(pfds, (num_plugins + 1) * sizeof(struct pollfd))) == NULL)
+			return STATE_UNKNOWN;
+		pfds[0].fd = sd;
+		pfds[0].events = POLLIN | ((out_used > 0) ? POLLOUT : 0);
+		pfds[0].revents = 0;
+		num_pfds = 1;
+
+		time(&current_time);
+		poll_timeout = -1;
+		for (x = 0; x < num_plugins; x++) {
+			plugin = &plugins[x];
+			if (plugin->fd >= 0) {
+				pfds[num_pfds].fd = plugin->fd;
+				pfds[num_pfds].events = POLLIN;
+				pfds[num_pfds].revents = 0;
+				num_pfds++;
+			}
+			/* plugins that closed their output but have not exited yet are polled for */
+			else if (poll_timeout < 0 || poll_timeout > 50)
+				poll_timeout = 50;
+
+			if (plugin->deadline <= current_time)
+				poll_timeout = 0;
+			else if (poll_timeout < 0 || poll_timeout > (plugin->deadline - current_time) * 1000)
+				poll_timeout = (plugin->deadline - current_time) * 1000;
+		}
+
+		if (poll(pfds, num_pfds, poll_timeout) < 0 && errno != EINTR)
+			break;
+
+		/* send queued results to the core */
+		if (out_used > 0 && (pfds[0].revents & POLLOUT)) {
+			bytes = send(sd, out, out_used, MSG_NOSIGNAL | MSG_DONTWAIT);
+			if (bytes > 0)
+				consume_buffer(out, &out_used, (unsigned long)bytes);
+			else if (bytes < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+				core_gone = TRUE;
+		}
+
+		/* read new requests from the core */
+		if (pfds[0].revents & (POLLIN | POLLHUP | POLLERR)) {
+			while ((bytes = recv(sd, buf, sizeof(buf), MSG_DONTWAIT)) > 0)
+				append_buffer(&in, &in_used, &in_size, buf, (unsigned long)bytes);
+			if (bytes == 0 || (bytes < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+				core_gone = TRUE;
+		}
+
+		/* start every complete request */
+		while (in_used >= sizeof(request)) {
+
+			memcpy(&request, in, sizeof(request));
+			frame_length = sizeof(request) + request.command_length + request.environment_length;
+			if (in_used < frame_length)
+				break;
+
+			if (num_plugins == max_plugins) {
+				max_plugins = (max_plugins == 0) ? 64 : max_plugins * 2;
+				if ((plugins = (worker_plugin *)realloc(plugins, max_plugins * sizeof(worker_plugin))) == NULL)
+					return STATE_UNKNOWN;
+			}
+			plugin = &plugins[num_plugins];
+			memset(plugin, 0, sizeof(worker_plugin));
+			plugin->job_id = request.job_id;
+			plugin->fd = -1;
+			plugin->deadline = time(NULL) + request.timeout;
+			dbuf_init(&plugin->output, 1024);
+
+			command = in + sizeof(request);
+			command[request.command_length - 1] = '\x0';
+
+			/* our own environment plus the macros of this check */
+			for (num_env = 0; environ[num_env] != NULL; num_env++);
+			envp = (char **)malloc((num_env + request.environment_length + 1) * sizeof(char *));
+			if (envp != NULL) {
+				memcpy(envp, environ, num_env * sizeof(char *));
+				env_ptr = command + request.command_length;
+				for (y = 0; (unsigned int)y < request.environment_length; y += strlen(env_ptr + y) + 1)
+					envp[num_env++] = env_ptr + y;
+				envp[num_env] = NULL;
+			}
+
+			result = (envp == NULL) ? ENOMEM : start_worker_plugin(plugin, command, envp);
+			my_free(envp);
+
+			/* the plugin could not be started - report it the way a shell would */
+			if (result != 0) {
+				dbuf_strcat(&plugin->output, strerror(result));
+				send_worker_result(plugin, (result == ENOENT) ? 127 : (result == EACCES) ? 126 : STATE_UNKNOWN, TRUE, &out, &out_used, &out_size);
+				dbuf_free(&plugin->output);
+			} else
+				num_plugins++;
+
+			consume_buffer(in, &in_used, frame_length);
+		}
+
+		/* collect plugin output */
+		for (x = 1; x < num_pfds; x++) {
+			if (!(pfds[x].revents & (POLLIN | POLLHUP | POLLERR)))
+				continue;
+			for (y = 0; y < num_plugins; y++) {
+				if (plugins[y].fd == pfds[x].fd)
+					break;
+			}
+			if (y == num_plugins)
+				continue;
+			plugin = &plugins[y];
+
+			bytes = read(plugin->fd, buf, sizeof(buf) - 1);
+			if (bytes > 0) {
+				buf[bytes] = '\x0';
+				dbuf_strcat(&plugin->output, buf);
+			} else if (bytes == 0 || errno != EINTR) {
+				close(plugin->fd);
+				plugin->fd = -1;
+			}
+		}
+
+		/* reap finished plugins and kill the ones that ran for too long */
+		time(&current_time);
+		for (x = 0; x < num_plugins; x++) {
+			plugin = &plugins[x];
+
+			if (plugin->reaped == FALSE && waitpid(plugin->pid, &plugin->wait_status, WNOHANG) == plugin->pid)
+				plugin->reaped = TRUE;
+
+			if (plugin->reaped == FALSE && current_time >= plugin->deadline) {
+				kill(-plugin->pid, SIGKILL);
+				waitpid(plugin->pid, &plugin->wait_status, 0);
+				plugin->reaped = TRUE;
+				plugin->early_timeout = TRUE;
+			}
+
+			/* wait until the plugin has exited and all of its output is read */
+			if (plugin->reaped == FALSE || (plugin->fd >= 0 && plugin->early_timeout == FALSE))
+				continue;
+
+			if (plugin->fd >= 0) {
+				close(plugin->fd);
+				plugin->fd = -1;
+			}
+
+			/* same return code mapping as forked checks */
+			if (WIFSIGNALED(plugin->wait_status))
+				return_code = 128 + WTERMSIG(plugin->wait_status);
+			else
+				return_code = WEXITSTATUS(plugin->wait_status);
+
+			send_worker_result(plugin, return_code, TRUE, &out, &out_used, &out_size);
+			dbuf_free(&plugin->output);
+
+			/* fill the hole with the last plugin */
+			plugins[x] = plugins[num_plugins - 1];
+			num_plugins--;
+			x--;
+		}
+	}
+
+	my_free(pfds);
+	my_free(plugins);
+	my_free(in);
+	my_free(out);
+	close(sd);
+
+	return STATE_OK;
+}
@@ -87,6 +87,8 @@ extern int       log_rotation_method;
 #define HOST_SUBJECT            0
 #define SERVICE_SUBJECT         1
 
+#define SUBJECT_HASHSLOTS       1024
+
 #define MIN_TIMESTAMP_SPACING	10
 
 #define MAX_ARCHIVE_SPREAD	65
@@ -139,9 +141,12 @@ typedef struct avail_subject_struct {
 	unsigned long time_indeterminate_notrunning;
 
 	struct avail_subject_struct *next;
+	struct avail_subject_struct *nexthash;
 } avail_subject;
 
 avail_subject *subject_list = NULL;
+avail_subject *subject_list_tail = NULL;
+avail_subject **subject_hashlist = NULL;
 
 time_t t1;
 time_t t2;
@@ -198,6 +203,7 @@ char *service_desc = "";
 
 void create_subject_list(void);
 void add_subject(int, char *, char *);
+int add_subject_to_hashlist(avail_subject *);
 avail_subject *find_subject(int, char *, char *);
 void compute_availability(void);
 void compute_subject_availability(avail_subject *, time_t);
@@ -2648,6 +2654,22 @@ void add_subject(int subject_type, char *hn, char *sd) {
 	new_subject->as_list_tail = NULL;
 	new_subject->sd_list = NULL;
 	new_subject->last_known_state = AS_NO_DATA;
+	new_subject->nexthash = NULL;
+
+	if (!add_subject_to_hashlist(new_subject)) {
+		my_free(new_subject->host_name);
+		my_free(new_subject->service_description);
+		my_free(new_subject);
+		return;
+	}
+
+	/* subjects mostly get added in host name order, so try appending first */
+	if (subject_list_tail != NULL && strcmp(new_subject->host_name, subject_list_tail->host_name) >= 0) {
+		new_subject->next = NULL;
+		subject_list_tail->next = new_subject;
+		subject_list_tail = new_subject;
+		return;
+	}
 
 	/* add the new entry to the list in memory, sorted by host name */
 	last_subject = subject_list;
@@ -2665,15 +2687,49 @@ void add_subject(int subject_type, char *hn, char *sd) {
 	if (subject_list == NULL) {
 		new_subject->next = NULL;
 		subject_list = new_subject;
+		subject_list_tail = new_subject;
 	} else if (temp_subject == NULL) {
 		new_subject->next = NULL;
 		last_subject->next = new_subject;
+		subject_list_tail = new_subject;
 	}
 
 	return;
 }
 
 
+/* adds a subject to the hash list, host subjects are hashed by host name only */
+int add_subject_to_hashlist(avail_subject *new_subject) {
+	avail_subject *temp_subject = NULL;
+	avail_subject *lastpointer = NULL;
+	int hashslot = 0;
+
+	/* initialize hash list */
+	if (subject_hashlist == NULL) {
+
+		subject_hashlist = (avail_subject **)calloc(SUBJECT_HASHSLOTS, sizeof(avail_subject *));
+		if (subject_hashlist == NULL)
+			return 0;
+	}
+
+	if (new_subject->host_name == NULL || (new_subject->type == SERVICE_SUBJECT && new_subject->service_description == NULL))
+		return 0;
+
+	hashslot = hashfunc(new_subject->host_name, new_subject->service_description, SUBJECT_HASHSLOTS);
+	lastpointer = NULL;
+	for (temp_subject = subject_hashlist[hashslot]; temp_subject && compare_hashdata(temp_subject->host_name, temp_subject->service_description, new_subject->host_name, new_subject->service_description) < 0; temp_subject = temp_subject->nexthash)
+		lastpointer = temp_subject;
+
+	if (lastpointer)
+		lastpointer->nexthash = new_subject;
+	else
+		subject_hashlist[hashslot] = new_subject;
+	new_subject->nexthash = temp_subject;
+
+	return 1;
+}
+
+
 
 /* finds a specific subject */
 avail_subject *find_subject(int type, char *hn, char *sd) {
@@ -2685,14 +2741,15 @@ avail_subject *find_subject(int type, char *hn, char *sd) {
 	if (type == SERVICE_SUBJECT && sd == NULL)
 		return NULL;
 
-	for (temp_subject = subject_list; temp_subject != NULL; temp_subject = temp_subject->next) {
-		if (temp_subject->type != type)
-			continue;
-		if (strcmp(hn, temp_subject->host_name))
-			continue;
-		if (type == SERVICE_SUBJECT && strcmp(sd, temp_subject->service_description))
-			continue;
-		return temp_subject;
+	if (subject_hashlist == NULL)
+		return NULL;
+
+	if (type == HOST_SUBJECT)
+		sd = NULL;
+
+	for (temp_subject = subject_hashlist[hashfunc(hn, sd, SUBJECT_HASHSLOTS)]; temp_subject != NULL; temp_subject = temp_subject->nexthash) {
+		if (compare_hashdata(temp_subject->host_name, temp_subject->service_description, hn, sd) == 0)
+			return temp_subject;
 	}
 
 	return NULL;
@@ -2829,6 +2886,10 @@ void free_availability_data(void) {
 		this_subject = next_subject;
 	}
 
+	subject_list = NULL;
+	subject_list_tail = NULL;
+	my_free(subject_hashlist);
+
 	return;
 }
 
@@ -2866,8 +2927,49 @@ void read_archived_state_data(void) {
 	logentry *entry_list = NULL;
 	logfilter *filter_list = NULL;
 
+	/* only keep the entries we need, all subjects get fed from this one pass over the archives */
+	add_log_filter(&filter_list, LOGENTRY_STARTUP, LOGFILTER_INCLUDE);
+	add_log_filter(&filter_list, LOGENTRY_RESTART, LOGFILTER_INCLUDE);
+	add_log_filter(&filter_list, LOGENTRY_SHUTDOWN, LOGFILTER_INCLUDE);
+	add_log_filter(&filter_list, LOGENTRY_BAILOUT, LOGFILTER_INCLUDE);
+
+	if (display_type == DISPLAY_HOST_AVAIL || display_type == DISPLAY_HOSTGROUP_AVAIL || display_type == DISPLAY_SERVICEGROUP_AVAIL) {
+		add_log_filter(&filter_list, LOGENTRY_HOST_DOWN, LOGFILTER_INCLUDE);
+		add_log_filter(&filter_list, LOGENTRY_HOST_UNREACHABLE, LOGFILTER_INCLUDE);
+		add_log_filter(&filter_list, LOGENTRY_HOST_RECOVERY, LOGFILTER_INCLUDE);
+		add_log_filter(&filter_list, LOGENTRY_HOST_UP, LOGFILTER_INCLUDE);
+		add_log_filter(&filter_list, LOGENTRY_HOST_INITIAL_STATE, LOGFILTER_INCLUDE);
+		add_log_filter(&filter_list, LOGENTRY_HOST_CURRENT_STATE, LOGFILTER_INCLUDE);
+	}
+
+	if (display_type == DISPLAY_SERVICE_AVAIL || display_type == DISPLAY_HOST_AVAIL || display_type == DISPLAY_SERVICEGROUP_AVAIL) {
+		add_log_filter(&filter_list, LOGENTRY_SERVICE_CRITICAL, LOGFILTER_INCLUDE);
+		add_log_filter(&filter_list, LOGENTRY_SERVICE_WARNING, LOGFILTER_INCLUDE);
+		add_log_filter(&filter_list, LOGENTRY_SERVICE_UNKNOWN, LOGFILTER_INCLUDE);
+		add_log_filter(&filter_list, LOGENTRY_SERVICE_RECOVERY, LOGFILTER_INCLUDE);
+		add_log_filter(&filter_list, LOGENTRY_SERVICE_OK, LOGFILTER_INCLUDE);
+		add_log_filter(&filter_list, LOGENTRY_SERVICE_INITIAL_STATE, LOGFILTER_INCLUDE);
+		add_log_filter(&filter_list, LOGENTRY_SERVICE_CURRENT_STATE, LOGFILTER_INCLUDE);
+		add_log_filter(&filter_list, LOGENTRY_SERVICE_DOWNTIME_STARTED, LOGFILTER_INCLUDE);
+		add_log_filter(&filter_list, LOGENTRY_SERVICE_DOWNTIME_STOPPED, LOGFILTER_INCLUDE);
+		add_log_filter(&filter_list, LOGENTRY_SERVICE_DOWNTIME_CANCELLED, LOGFILTER_INCLUDE);
+	}
+
+	/* host downtimes apply to host and service subjects */
+	add_log_filter(&filter_list, LOGENTRY_HOST_DOWNTIME_STARTED, LOGFILTER_INCLUDE);
+	add_log_filter(&filter_list, LOGENTRY_HOST_DOWNTIME_STOPPED, LOGFILTER_INCLUDE);
+	add_log_filter(&filter_list, LOGENTRY_HOST_DOWNTIME_CANCELLED, LOGFILTER_INCLUDE);
+
+	/* a single host or service doesn't need the entries of all other objects in indexed archives */
+	if (display_type == DISPLAY_HOST_AVAIL && show_all_hosts == FALSE)
+		add_log_object_filter(&filter_list, host_name, NULL);
+	else if (display_type == DISPLAY_SERVICE_AVAIL && show_all_services == FALSE)
+		add_log_object_filter(&filter_list, host_name, service_desc);
+
 	status = get_log_entries(&entry_list, &filter_list, &error_text, NULL, FALSE, t1 - get_backtrack_seconds(backtrack_archives), t2);
 
+	free_log_filters(&filter_list);
+
 	if (status != READLOG_ERROR_FATAL) {
 
 		for (temp_entry = entry_list; temp_entry != NULL; temp_entry = temp_entry->next) {
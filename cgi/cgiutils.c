@@ -225,6 +225,9 @@ extern int CGI_ID;
 /* used for logging function */
 char		cgi_log_file[MAX_FILENAME_LENGTH] = "";
 char		cgi_log_archive_path[MAX_FILENAME_LENGTH] = "";
+
+/* used for reading log archives */
+char		log_index_cache_path[MAX_FILENAME_LENGTH] = "";
 int		use_logging = FALSE;
 int		cgi_log_rotation_method = LOG_ROTATION_NONE;
 
@@ -502,6 +505,15 @@ int read_cgi_config_file(char *filename) {
 			if (cgi_log_archive_path[strlen(cgi_log_archive_path) - 1] != '/' && (strlen(cgi_log_archive_path) < sizeof(cgi_log_archive_path) - 1))
 				strcat(cgi_log_archive_path, "/");
 
+		} else if (!strcmp(var, "log_index_cache_path")) {
+
+			strncpy(log_index_cache_path, val, sizeof(log_index_cache_path));
+			log_index_cache_path[sizeof(log_index_cache_path) - 1] = '\x0';
+
+			strip(log_index_cache_path);
+			if (log_index_cache_path[0] != '\x0' && log_index_cache_path[strlen(log_index_cache_path) - 1] != '/' && (strlen(log_index_cache_path) < sizeof(log_index_cache_path) - 1))
+				strcat(log_index_cache_path, "/");
+
 		} else if (!strcmp(var, "cgi_log_file")) {
 
 			strncpy(cgi_log_file, val, sizeof(cgi_log_file));
@@ -1593,34 +1605,6 @@ void write_popup_code(int cgi_id) {
  *************** MISC UTILITY FUNCTIONS *******************
  **********************************************************/
 
-/* unescapes newlines in a string */
-char *unescape_newlines(char *rawbuf) {
-	register int x, y;
-
-	for (x = 0, y = 0; rawbuf[x] != (char)'\x0'; x++) {
-
-		if (rawbuf[x] == '\\') {
-
-			/* unescape newlines */
-			if (rawbuf[x + 1] == 'n') {
-				rawbuf[y++] = '\n';
-				x++;
-			}
-
-			/* unescape backslashes and other stuff */
-			if (rawbuf[x + 1] != '\x0') {
-				rawbuf[y++] = rawbuf[x + 1];
-				x++;
-			}
-
-		} else
-			rawbuf[y++] = rawbuf[x];
-	}
-	rawbuf[y] = '\x0';
-
-	return rawbuf;
-}
-
 /* escapes newlines in a string */
 char *escape_newlines(char *rawbuf) {
 	char *newbuf = NULL;
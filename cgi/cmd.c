@@ -41,7 +41,6 @@
 
 /** @name External vars
     @{ **/
-extern const char *extcmd_get_name(int id);
 
 extern char main_config_file[MAX_FILENAME_LENGTH];
 extern char url_html_path[MAX_FILENAME_LENGTH];
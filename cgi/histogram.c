@@ -2157,6 +2157,12 @@ void read_archived_state_data(void) {
 	add_log_filter(&filter_list, LOGENTRY_SHUTDOWN, LOGFILTER_INCLUDE);
 	add_log_filter(&filter_list, LOGENTRY_BAILOUT, LOGFILTER_INCLUDE);
 
+	/* only the entries of the graphed host or service are needed */
+	if (display_type == DISPLAY_HOST_HISTOGRAM)
+		add_log_object_filter(&filter_list, host_name, NULL);
+	else if (display_type == DISPLAY_SERVICE_HISTOGRAM)
+		add_log_object_filter(&filter_list, host_name, service_desc);
+
 	status = get_log_entries(&entry_list, &filter_list, &error_text, NULL, FALSE, t1 - get_backtrack_seconds(backtrack_archives), t2);
 
 	free_log_filters(&filter_list);
@@ -602,6 +602,12 @@ void show_history(void) {
 	add_log_filter(&filter_list, LOGENTRY_BAILOUT, LOGFILTER_INCLUDE);
 	add_log_filter(&filter_list, LOGENTRY_RESTART, LOGFILTER_INCLUDE);
 
+	/* skip entries of other hosts and services in indexed archives */
+	if (display_type == DISPLAY_HOSTS && show_all_hosts == FALSE)
+		add_log_object_filter(&filter_list, host_name, NULL);
+	else if (display_type == DISPLAY_SERVICES)
+		add_log_object_filter(&filter_list, host_name, service_desc);
+
 
 	/* scan the log file for archived state data */
 	status = get_log_entries(&entry_list, &filter_list, &error_text, NULL, reverse, ts_start, ts_end);
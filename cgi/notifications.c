@@ -689,6 +689,12 @@ void display_notifications(void) {
 	add_log_filter(&filter_list, LOGENTRY_HOST_NOTIFICATION, LOGFILTER_INCLUDE);
 	add_log_filter(&filter_list, LOGENTRY_SERVICE_NOTIFICATION, LOGFILTER_INCLUDE);
 
+	/* skip notifications of other hosts and services in indexed archives */
+	if (query_type == DISPLAY_HOSTS && find_all == FALSE)
+		add_log_object_filter(&filter_list, query_host_name, NULL);
+	else if (query_type == DISPLAY_SERVICES)
+		add_log_object_filter(&filter_list, query_host_name, query_svc_description);
+
 	/* scan the log file for notification data */
 	status = get_log_entries(&entry_list, &filter_list, &error_text, NULL, reverse, ts_start, ts_end);
 
@@ -28,6 +28,7 @@
 
 #include "../include/cgiutils.h"
 #include "../include/readlogs.h"
+#include "../include/logindex.h"
 
 /** @brief file name data struct
  *
@@ -42,6 +43,7 @@ struct file_data {
 extern char	log_file[MAX_FILENAME_LENGTH];		/**< the full file name of the main icinga log file */
 extern char	log_archive_path[MAX_FILENAME_LENGTH];	/**< the full path to the archived log files */
 extern int	log_rotation_method;			/**< time interval of log rotation */
+extern char	log_index_cache_path[MAX_FILENAME_LENGTH];	/**< where to keep indexes for archives the core didn't index */
 /** @} */
 
 
@@ -137,6 +139,8 @@ int add_log_filter(logfilter **new_filter, int requested_filter, int include_exc
 	temp_filter->next = NULL;
 	temp_filter->include = 0;
 	temp_filter->exclude = 0;
+	temp_filter->host_hash = 0;
+	temp_filter->service_hash = 0;
 
 	if (include_exclude == LOGFILTER_INCLUDE)
 		temp_filter->include = requested_filter;
@@ -158,6 +162,101 @@ int add_log_filter(logfilter **new_filter, int requested_filter, int include_exc
 }
 
 
+/** @brief Add host or service to the list of log filters
+ *  @param [out] filter_list a list of filters of type logfilter struct where requested filter got added
+ *  @param [in] host_name the host the log entries should belong to
+ *  @param [in] service_description the service the log entries should belong to, NULL for all services of the host
+ *  @return wether adding filter was successful or not (see readlogs.h)
+ *	@retval READLOG_OK
+ *	@retval READLOG_ERROR_FATAL
+ *	@retval READLOG_ERROR_MEMORY
+ *
+ *  Object filters are only a hint for log archives which have an index (see common/logindex.c).
+ *  Entries of other hosts and services are skipped without reading them from the archive.
+ *  Entries of the current log file, of archives without index and entries which don't
+ *  belong to any host are always returned, so the caller still has to check the host
+ *  and service of every entry. If more than one object filter is added, entries of all
+ *  of these objects are returned.
+**/
+int add_log_object_filter(logfilter **new_filter, char *host_name, char *service_description) {
+	logfilter *temp_filter = NULL;
+
+	if (host_name == NULL)
+		return READLOG_ERROR_FATAL;
+
+	temp_filter = (logfilter *)malloc(sizeof(logfilter));
+	if (temp_filter == NULL)
+		return READLOG_ERROR_MEMORY;
+
+	temp_filter->include = 0;
+	temp_filter->exclude = 0;
+	temp_filter->host_hash = get_log_object_hash(host_name, strlen(host_name));
+	temp_filter->service_hash = (service_description == NULL) ? 0 : get_log_object_hash(service_description, strlen(service_description));
+
+	temp_filter->next = *new_filter;
+	*new_filter = temp_filter;
+
+	return READLOG_OK;
+}
+
+/** @brief checks if a log entry type passes the include and exclude filters
+ *  @param [in] filter_list a list of filters of type logfilter struct
+ *  @param [in] type the type of the log entry
+ *  @return wether entry should be kept or not
+ *	@retval TRUE
+ *	@retval FALSE
+**/
+int check_log_entry_type(logfilter *filter_list, int type) {
+	logfilter *temp_filter;
+	int found_filter = FALSE;
+	int keep_entry = FALSE;
+
+	for (temp_filter = filter_list; temp_filter != NULL; temp_filter = temp_filter->next) {
+		if (temp_filter->include != 0) {
+			found_filter = TRUE;
+			if (temp_filter->include == type)
+				return TRUE;
+		} else if (temp_filter->exclude != 0) {
+			found_filter = TRUE;
+			if (temp_filter->exclude == type)
+				return FALSE;
+			keep_entry = TRUE;
+		}
+	}
+
+	/* object filters alone don't filter by type */
+	return (found_filter == TRUE) ? keep_entry : TRUE;
+}
+
+/** @brief checks if an indexed log entry passes the object filters
+ *  @param [in] filter_list a list of filters of type logfilter struct
+ *  @param [in] entry the index entry of the log entry
+ *  @return wether entry could belong to one of the requested objects
+ *	@retval TRUE
+ *	@retval FALSE
+**/
+static int check_log_entry_object(logfilter *filter_list, logindex_entry *entry) {
+	logfilter *temp_filter;
+	int found_filter = FALSE;
+
+	/* entries without host always pass */
+	if (entry->host_hash == 0)
+		return TRUE;
+
+	for (temp_filter = filter_list; temp_filter != NULL; temp_filter = temp_filter->next) {
+		if (temp_filter->host_hash == 0)
+			continue;
+		found_filter = TRUE;
+		if (temp_filter->host_hash != entry->host_hash)
+			continue;
+		if (temp_filter->service_hash == 0 || entry->service_hash == 0 || temp_filter->service_hash == entry->service_hash)
+			return TRUE;
+	}
+
+	return (found_filter == TRUE) ? FALSE : TRUE;
+}
+
+
 /** @brief Read's log data for defined timerange and stores the entries into entry_list struct
  *  @param [out] entry_list returns a filled entry list of requested log data
  *  @param [in] filter_list a list of filters of type logfilter struct
@@ -189,27 +288,31 @@ int get_log_entries(logentry **entry_list, logfilter **filter_list, char **error
 	char *input = NULL;
 	char *temp_buffer = NULL;
 	char *search_regex = NULL;
+	char *archive_name = NULL;
 	char log_file_name[MAX_FILENAME_LENGTH];
+	char index_file_name[MAX_FILENAME_LENGTH];
 	char ts_buffer[16];
 	int type = 0;
 	int regex_i = 0, i = 0, len = 0;
 	int file_num = 1;
+	int files_allocated = 64;
 	int file = 0;
 	int in_range = FALSE;
 	int return_val = READLOG_OK;
 	int data_found = FALSE;
 	int dummy;
-	short keep_entry = TRUE;
 	time_t timestamp = 0L;
 	time_t last_timestamp = 0L;
 	mmapfile *thefile = NULL;
 	logentry *temp_entry = NULL;
 	logentry *last_entry = NULL;
 	regex_t preg;
-	logfilter *temp_filter;
+	logindex *log_index = NULL;
+	unsigned long entry_num = 0L;
 	DIR *dirp;
 	struct dirent *dptr;
-	struct file_data files[10000];
+	struct file_data *files = NULL;
+	struct file_data *new_files = NULL;
 
 	/* empty error_text */
 	if (*error_text != NULL)
@@ -248,15 +351,19 @@ int get_log_entries(logentry **entry_list, logfilter **filter_list, char **error
 		my_free(search_regex);
 	}
 
-	/* initialize file data array */
-	for (i=0;i<10000;i++)
-		files[i].file_name = NULL;
+	/* initialize file data array, one entry more than files are found */
+	if ((files = (struct file_data *)calloc(files_allocated, sizeof(struct file_data))) == NULL) {
+		if (search_string != NULL)
+			regfree(&preg);
+		return READLOG_ERROR_MEMORY;
+	}
 
 	/* try to open log_archive_path, return if it fails */
 	if ((dirp=opendir(log_archive_path)) == NULL){
 
 		if (search_string != NULL)
 			regfree(&preg);
+		my_free(files);
 
 		dummy = asprintf(&temp_buffer, "无法打开 \"日志归档路径\" -> \"%s\"!!!", log_archive_path);
 		*error_text = strdup(temp_buffer);
@@ -271,8 +378,19 @@ int get_log_entries(logentry **entry_list, logfilter **filter_list, char **error
 
 			/* filter dir for icinga / nagios log files */
 			if ((strncmp("icinga-",dptr->d_name,7) == 0 || strncmp("nagios-",dptr->d_name,7) == 0 ) &&
-			    strstr(dptr->d_name, ".log") && strlen(dptr->d_name) == 24)
+			    strstr(dptr->d_name, ".log") && strlen(dptr->d_name) == 24) {
+
+				/* grow file data array */
+				if (file_num + 1 >= files_allocated) {
+					if ((new_files = (struct file_data *)realloc(files, files_allocated * 2 * sizeof(struct file_data))) == NULL)
+						break;
+					files = new_files;
+					memset(files + files_allocated, 0, files_allocated * sizeof(struct file_data));
+					files_allocated *= 2;
+				}
+
 				files[file_num++].file_name = strdup(dptr->d_name);
+			}
 		}
 		closedir(dirp);
 	}
@@ -367,12 +485,56 @@ int get_log_entries(logentry **entry_list, logfilter **filter_list, char **error
 		if ((thefile = mmap_fopen(files[i].file_name)) == NULL)
 			continue;
 
+		/* archives written by the core come with an index, the current log file never has one */
+		log_index = (i == 0) ? NULL : open_log_index(files[i].file_name, NULL);
+
+		/* index older archives once and keep the index in the cache */
+		if (i != 0 && log_index == NULL && log_index_cache_path[0] != '\x0') {
+			archive_name = strrchr(files[i].file_name, '/');
+			len = snprintf(index_file_name, sizeof(index_file_name), "%s%s%s", log_index_cache_path, (archive_name == NULL) ? files[i].file_name : archive_name + 1, LOGINDEX_SUFFIX);
+
+			/* don't cache an index under a truncated name */
+			if (len >= 0 && len < (int)sizeof(index_file_name)) {
+				if ((log_index = open_log_index(files[i].file_name, index_file_name)) == NULL && write_log_index(files[i].file_name, index_file_name) == OK)
+					log_index = open_log_index(files[i].file_name, index_file_name);
+			}
+		}
+
+		/* never trust an index that doesn't fit the file we mapped */
+		if (log_index != NULL && log_index->header->log_size != thefile->file_size) {
+			close_log_index(log_index);
+			log_index = NULL;
+		}
+
+		entry_num = find_log_index_entry(log_index, ts_start);
+
 		while (1) {
 
 			/* free memory */
 			my_free(input);
 
-			if ((input = mmap_fgets(thefile)) == NULL)
+			if (log_index != NULL) {
+
+				/* skip entries by index, without reading them from the archive */
+				while (entry_num < log_index->header->entry_count && (log_index->entries[entry_num].timestamp < (unsigned long)ts_start || log_index->entries[entry_num].timestamp > (unsigned long)ts_end || check_log_entry_type(*filter_list, log_index->entries[entry_num].type) == FALSE || check_log_entry_object(*filter_list, &log_index->entries[entry_num]) == FALSE)) {
+
+					/* entries are sorted by time, nothing newer than ts_end will match */
+					if ((log_index->header->flags & LOGINDEX_SORTED) && log_index->entries[entry_num].timestamp > (unsigned long)ts_end)
+						entry_num = log_index->header->entry_count;
+					else
+						entry_num++;
+				}
+
+				if (entry_num >= log_index->header->entry_count)
+					break;
+
+				if ((input = (char *)malloc(log_index->entries[entry_num].length + 1)) == NULL)
+					break;
+				memcpy(input, (char *)thefile->mmap_buf + log_index->entries[entry_num].offset, log_index->entries[entry_num].length);
+				input[log_index->entries[entry_num].length] = '\x0';
+				entry_num++;
+
+			} else if ((input = mmap_fgets(thefile)) == NULL)
 				break;
 
 			strip(input);
@@ -404,124 +566,22 @@ int get_log_entries(logentry **entry_list, logfilter **filter_list, char **error
 					continue;
 			}
 
-			/* categorize log entry */
-			if (strstr(temp_buffer, " 开始..."))
-				type = LOGENTRY_STARTUP;
-			else if (strstr(temp_buffer, " 关闭..."))
-				type = LOGENTRY_SHUTDOWN;
-			else if (strstr(temp_buffer, "救助"))
-				type = LOGENTRY_BAILOUT;
-			else if (strstr(temp_buffer, " 重启..."))
-				type = LOGENTRY_RESTART;
-			else if (strstr(temp_buffer, "主机警告:") && strstr(temp_buffer, ";宕机;"))
-				type = LOGENTRY_HOST_DOWN;
-			else if (strstr(temp_buffer, "主机警告:") && strstr(temp_buffer, ";不可达;"))
-				type = LOGENTRY_HOST_UNREACHABLE;
-			else if (strstr(temp_buffer, "主机警告:") && strstr(temp_buffer, ";恢复;"))
-				type = LOGENTRY_HOST_RECOVERY;
-			else if (strstr(temp_buffer, "主机警告:") && strstr(temp_buffer, ";运行;"))
-				type = LOGENTRY_HOST_UP;
-			else if (strstr(temp_buffer, "主机通知:"))
-				type = LOGENTRY_HOST_NOTIFICATION;
-			else if (strstr(temp_buffer, "服务警告:") && strstr(temp_buffer, ";严重;"))
-				type = LOGENTRY_SERVICE_CRITICAL;
-			else if (strstr(temp_buffer, "服务警告:") && strstr(temp_buffer, ";警报;"))
-				type = LOGENTRY_SERVICE_WARNING;
-			else if (strstr(temp_buffer, "服务警告:") && strstr(temp_buffer, ";未知;"))
-				type = LOGENTRY_SERVICE_UNKNOWN;
-			else if (strstr(temp_buffer, "服务警告:") && strstr(temp_buffer, ";恢复;"))
-				type = LOGENTRY_SERVICE_RECOVERY;
-			else if (strstr(temp_buffer, "服务警告:") && strstr(temp_buffer, ";正常;"))
-				type = LOGENTRY_SERVICE_OK;
-			else if (strstr(temp_buffer, "服务通知:"))
-				type = LOGENTRY_SERVICE_NOTIFICATION;
-			else if (strstr(temp_buffer, "服务事件处理:"))
-				type = LOGENTRY_SERVICE_EVENT_HANDLER;
-			else if (strstr(temp_buffer, "主机事件处理:"))
-				type = LOGENTRY_HOST_EVENT_HANDLER;
-			else if (strstr(temp_buffer, "额外命令:"))
-				type = LOGENTRY_EXTERNAL_COMMAND;
-			else if (strstr(temp_buffer, "被动服务检查:"))
-				type = LOGENTRY_PASSIVE_SERVICE_CHECK;
-			else if (strstr(temp_buffer, "被动主机检查:"))
-				type = LOGENTRY_PASSIVE_HOST_CHECK;
-			else if (strstr(temp_buffer, "日志回滚:"))
-				type = LOGENTRY_LOG_ROTATION;
-			else if (strstr(temp_buffer, "主动模式..."))
-				type = LOGENTRY_ACTIVE_MODE;
-			else if (strstr(temp_buffer, "待机模式..."))
-				type = LOGENTRY_STANDBY_MODE;
-			else if (strstr(temp_buffer, "服务抖动警告:") && strstr(temp_buffer, ";开始;"))
-				type = LOGENTRY_SERVICE_FLAPPING_STARTED;
-			else if (strstr(temp_buffer, "服务抖动警告:") && strstr(temp_buffer, ";停止;"))
-				type = LOGENTRY_SERVICE_FLAPPING_STOPPED;
-			else if (strstr(temp_buffer, "服务抖动警告:") && strstr(temp_buffer, ";禁止;"))
-				type = LOGENTRY_SERVICE_FLAPPING_DISABLED;
-			else if (strstr(temp_buffer, "主机抖动警告:") && strstr(temp_buffer, ";开始;"))
-				type = LOGENTRY_HOST_FLAPPING_STARTED;
-			else if (strstr(temp_buffer, "主机抖动警告:") && strstr(temp_buffer, ";停止;"))
-				type = LOGENTRY_HOST_FLAPPING_STOPPED;
-			else if (strstr(temp_buffer, "主机抖动警告:") && strstr(temp_buffer, ";禁止;"))
-				type = LOGENTRY_HOST_FLAPPING_DISABLED;
-			else if (strstr(temp_buffer, "服务宕机警告:") && strstr(temp_buffer, ";开始;"))
-				type = LOGENTRY_SERVICE_DOWNTIME_STARTED;
-			else if (strstr(temp_buffer, "服务宕机警告:") && strstr(temp_buffer, ";停止;"))
-				type = LOGENTRY_SERVICE_DOWNTIME_STOPPED;
-			else if (strstr(temp_buffer, "服务宕机警告:") && strstr(temp_buffer, ";取消;"))
-				type = LOGENTRY_SERVICE_DOWNTIME_CANCELLED;
-			else if (strstr(temp_buffer, "主机宕机警告:") && strstr(temp_buffer, ";开始;"))
-				type = LOGENTRY_HOST_DOWNTIME_STARTED;
-			else if (strstr(temp_buffer, "主机宕机警告:") && strstr(temp_buffer, ";停止;"))
-				type = LOGENTRY_HOST_DOWNTIME_STOPPED;
-			else if (strstr(temp_buffer, "主机宕机警告:") && strstr(temp_buffer, ";取消;"))
-				type = LOGENTRY_HOST_DOWNTIME_CANCELLED;
-			else if (strstr(temp_buffer, "初始服务状态:"))
-				type = LOGENTRY_SERVICE_INITIAL_STATE;
-			else if (strstr(temp_buffer, "初始主机状态:"))
-				type = LOGENTRY_HOST_INITIAL_STATE;
-			else if (strstr(temp_buffer, "当前服务状态:"))
-				type = LOGENTRY_SERVICE_CURRENT_STATE;
-			else if (strstr(temp_buffer, "当前主机状态:"))
-				type = LOGENTRY_HOST_CURRENT_STATE;
-			else if (strstr(temp_buffer, "错误的执行命令"))
-				type = LOGENTRY_ERROR_COMMAND_EXECUTION;
-			else if (strstr(temp_buffer, "idomod:"))
-				type = LOGENTRY_IDOMOD;
-			else if (strstr(temp_buffer, "npcdmod:"))
-				type = LOGENTRY_NPCDMOD;
-			else if (strstr(temp_buffer, "自动保存"))
-				type = LOGENTRY_AUTOSAVE;
-			else if (strstr(temp_buffer, "警报:"))
-				type = LOGENTRY_SYSTEM_WARNING;
+			/* categorize log entry, indexed entries are already categorized */
+			if (log_index != NULL)
+				type = log_index->entries[entry_num - 1].type;
 			else
-				type = LOGENTRY_UNDEFINED;
+				type = get_log_entry_type(temp_buffer);
 
 			/* apply filters */
-			if (*filter_list != NULL) {
-				keep_entry = FALSE;
-				for (temp_filter = *filter_list; temp_filter != NULL; temp_filter = temp_filter->next) {
-					if (temp_filter->include != 0) {
-						if (temp_filter->include == type) {
-							keep_entry = TRUE;
-							break;
-						}
-					} else if (temp_filter->exclude != 0) {
-						if (temp_filter->exclude == type) {
-							keep_entry = FALSE;
-							break;
-						} else
-							keep_entry = TRUE;
-					}
-				}
-				if (keep_entry == FALSE)
-					continue;
-			}
+			if (check_log_entry_type(*filter_list, type) == FALSE)
+				continue;
 
 			/* initialzie */
 			/* allocate memory for a new log entry */
 			temp_entry = (logentry *)malloc(sizeof(logentry));
 			if (temp_entry == NULL) {
 
+				close_log_index(log_index);
 				mmap_fclose(thefile);
 				return READLOG_ERROR_MEMORY;
 			}
@@ -550,11 +610,13 @@ int get_log_entries(logentry **entry_list, logfilter **filter_list, char **error
 			}
 		}
 
+		close_log_index(log_index);
 		mmap_fclose(thefile);
 	}
 
 	for (i=0; i< file_num;i++)
 		my_free(files[i].file_name);
+	my_free(files);
 
 	if (search_string != NULL)
 		regfree(&preg);
@@ -148,6 +148,7 @@ typedef struct statusdata_struct {
 	time_t		ts_last_check;			/**< last time status is checked as timestamp */
 	char		*state_duration;		/**< duration of this status as string */
 	time_t		ts_state_duration;		/**< duration of this status as timestamp */
+	time_t		ts_last_state_change;		/**< last state change as timestamp */
 	char		*attempts;			/**< attempts as string */
 	int		current_attempt;		/**< attempts as integer */
 	char		*plugin_output;			/**< full processed plugin output */
@@ -158,6 +159,8 @@ typedef struct statusdata_struct {
 	int		accept_passive_checks;		/**< bool if passive checks are enabled */
 	int		is_flapping;			/**< bool if status is flapping */
 	int		state_type;			/**< type of state HARD_STATE / SOFT_STATE */
+	void		*data;				/**< hoststatus/servicestatus this entry was made from */
+	int		formatted;			/**< bool if the strings for displaying have been formatted */
 	struct statusdata_struct *next;			/**< next statusdata */
 } statusdata;
 
@@ -170,10 +173,16 @@ statusdata *last_statusdata = NULL;			/**< last element of status data list (nee
 **/
 typedef struct sort_struct {
 	statusdata *status;				/**< pointer to status data element */
+	char *key_string;				/**< precomputed string sort key, NULL if sorted by key */
+	long key;					/**< precomputed numeric sort key */
+	int position;					/**< position in @ref statusdata_list, orders entries with equal keys */
 	struct sort_struct *next;			/**< next sort entry */
 } sort;
 
 sort *statussort_list = NULL;				/**< list of all sorted elements */
+sort *statussort_entries = NULL;			/**< array holding all elements of @ref statussort_list */
+int statussort_descending = FALSE;			/**< bool if @ref statussort_list is sorted descending */
+int statussort_reversed_ties = FALSE;			/**< bool if entries with equal keys are sorted in reverse order */
 
 /** @brief named list structure
  *
@@ -307,6 +316,14 @@ struct namedlist req_servicegroups[NUM_NAMED_ENTRIES];	/**< initialze list of re
 **/
 int add_status_data(int , void *);
 
+/** @brief formats the strings of a status data element for displaying
+ *  @param [in] status_data element of @ref statusdata_list
+ *
+ *  @n Last check, state duration, attempts and plugin output are only needed for the entries
+ *  actually displayed on the current page, so @ref add_status_data leaves them to this function.
+**/
+void format_status_data(statusdata *);
+
 /** @brief frees all memory allocated to @ref statusdata_list entries in memory **/
 void free_local_status_data(void);
 
@@ -327,25 +344,16 @@ void free_local_status_data(void);
 **/
 int sort_status_data(int, int, int);
 
-/** @brief compares two status data elements by type and option
- *  @param [in] status_type type of statusdata
- *	@arg HOST_STATUS
- *	@arg SERVICE_STATUS
- *  @param [in] sort_type defines sort direction
- *	@arg SORT_ASCENDING
- *	@arg SORT_DESCENDING
- *  @param [in] sort_option the field data is sorted after, see SORT OPTIONS in cgiutils.h
- *  @param [in] new_sort first status of two to comapre
- *  @param [in] temp_sort second status of two to comapre
+/** @brief compares two sort entries by their precomputed keys
+ *  @param [in] a first sort entry of two to compare
+ *  @param [in] b second sort entry of two to compare
  *
- *	@retval TRUE
- *	@retval FALSE
- *  @return wether adding of status data was successfull or not
+ *  @return less than, equal to or greater than zero if a sorts before, same as or after b
  *
- *  @n Is only used by @ref sort_status_data . Compares first satatus with second one
- *  and retruns TRUE or FALSE depending on sort_type and sort_option
+ *  @n Is only used by @ref sort_status_data as qsort() callback. Direction and order of
+ *  entries with equal keys are taken from @ref statussort_descending and @ref statussort_reversed_ties
 **/
-int compare_sort_entries(int, int, int, sort *, sort *);
+int compare_sort_entries(const void *, const void *);
 
 /** @brief frees all memory allocated to @ref statussort_list entries in memory **/
 void free_sort_list(void);
@@ -2358,6 +2366,9 @@ void show_service_detail(void) {
 			continue;
 		}
 
+		/* only entries on the requested page get their strings formatted */
+		format_status_data(temp_status);
+
 		if (strcmp(last_host, temp_status->host_name) || displayed_service_entries == 0)
 			new_host = TRUE;
 		else
@@ -2954,6 +2965,9 @@ void show_host_detail(void) {
 			continue;
 		}
 
+		/* only entries on the requested page get their strings formatted */
+		format_status_data(temp_statusdata);
+
 		if (odd)
 			odd = 0;
 		else
@@ -5854,22 +5868,10 @@ int add_status_data(int status_type, void *data) {
 	char *status_string = NULL;
 	char *host_name = NULL;
 	char *svc_description = NULL;
-	char *plugin_output_short = NULL;
-	char *plugin_output_long = NULL;
-	char *plugin_output = NULL;
-	char last_check[MAX_DATETIME_LENGTH];
-	char state_duration[48];
-	char attempts[MAX_INPUT_BUFFER];
 	time_t ts_state_duration = 0L;
 	time_t ts_last_check = 0L;
 	time_t ts_last_state_change = 0L;
-	int days;
-	int hours;
-	int minutes;
-	int seconds;
-	int duration_error = FALSE;
 	int status = OK;
-	int dummy = 0;
 	int current_attempt = 0;
 	int is_flapping = FALSE;
 	int problem_has_been_acknowledged = FALSE;
@@ -5913,12 +5915,6 @@ int add_status_data(int status_type, void *data) {
 		is_flapping = host_status->is_flapping;
 		state_type = host_status->state_type;
 
-		plugin_output_short = host_status->plugin_output;
-		plugin_output_long = host_status->long_plugin_output;
-
-		snprintf(attempts, sizeof(attempts) - 1, "%d/%d", host_status->current_attempt, host_status->max_attempts);
-		attempts[sizeof(attempts) - 1] = '\x0';
-
 	} else if (status_type == SERVICE_STATUS) {
 
 		service_status = (servicestatus*)data;
@@ -5956,66 +5952,18 @@ int add_status_data(int status_type, void *data) {
 		is_flapping = service_status->is_flapping;
 		state_type = service_status->state_type;
 
-		plugin_output_short = service_status->plugin_output;
-		plugin_output_long = service_status->long_plugin_output;
-
-		if (content_type == CSV_CONTENT || content_type == JSON_CONTENT)
-			snprintf(attempts, sizeof(attempts) - 1, "%d/%d", service_status->current_attempt, service_status->max_attempts);
-		else
-			snprintf(attempts, sizeof(attempts) - 1, "%d/%d %s#%d%s", service_status->current_attempt, service_status->max_attempts, (service_status->status & (service_status->state_type == HARD_STATE ? add_notif_num_hard : add_notif_num_soft) ? "(" : "<!-- "), service_status->current_notification_number, (service_status->status & (service_status->state_type == HARD_STATE ? add_notif_num_hard : add_notif_num_soft) ? ")" : " -->"));
-		attempts[sizeof(attempts) - 1] = '\x0';
-
 	} else {
 		return ERROR;
 	}
 
-	/* last check timestamp to string */
-	get_time_string(&ts_last_check, last_check, (int)sizeof(last_check), SHORT_DATE_TIME);
-	if ((unsigned long)ts_last_check == 0L)
-		strcpy(last_check, "无");
-
-	/* state duration calculation... */
-	ts_state_duration = 0;
-	duration_error = FALSE;
+	/* state duration is needed for sorting, the strings are formatted later for displayed entries only */
 	if (ts_last_state_change == (time_t)0) {
-		if (program_start > current_time)
-			duration_error = TRUE;
-		else
+		if (program_start <= current_time)
 			ts_state_duration = current_time - program_start;
 	} else {
-		if (ts_last_state_change > current_time)
-			duration_error = TRUE;
-		else
+		if (ts_last_state_change <= current_time)
 			ts_state_duration = current_time - ts_last_state_change;
 	}
-	get_time_breakdown((unsigned long)ts_state_duration, &days, &hours, &minutes, &seconds);
-	if (duration_error == TRUE)
-		snprintf(state_duration, sizeof(state_duration) - 1, "???");
-	else
-		snprintf(state_duration, sizeof(state_duration) - 1, "%2d天%2d时%2d分%2d秒%s", days, hours, minutes, seconds, (ts_last_state_change == (time_t)0) ? "+" : "");
-	state_duration[sizeof(state_duration) - 1] = '\x0';
-	strip(state_duration);
-
-	/* plugin ouput */
-	if (status_show_long_plugin_output != FALSE && plugin_output_long != NULL) {
-		if (content_type == CSV_CONTENT || content_type == JSON_CONTENT) {
-			if (plugin_output_short != NULL)
-				dummy = asprintf(&plugin_output, "%s", escape_newlines(plugin_output_long));
-			else
-				dummy = asprintf(&plugin_output, "%s %s", plugin_output_short, escape_newlines(plugin_output_long));
-		} else
-			dummy = asprintf(&plugin_output, "%s<BR>%s", (plugin_output_short == NULL) ? "" : html_encode(plugin_output_short, TRUE), html_encode(plugin_output_long, TRUE));
-	} else if (plugin_output_short != NULL) {
-		if (content_type == CSV_CONTENT || content_type == JSON_CONTENT)
-			dummy = asprintf(&plugin_output, "%s", plugin_output_short);
-		else
-			dummy = asprintf(&plugin_output, "%s&nbsp;", html_encode(plugin_output_short, TRUE));
-	} else {
-		if (content_type == CSV_CONTENT || content_type == JSON_CONTENT)
-			plugin_output = NULL;
-		else
-			dummy = asprintf(&plugin_output, "&nbsp;");
-	}
 
 	/* allocating new memory */
 	new_statusdata = (statusdata *)malloc(sizeof(statusdata));
@@ -6027,11 +5975,12 @@ int add_status_data(int status_type, void *data) {
 	new_statusdata->status_string = strdup(status_string);
 	new_statusdata->host_name = strdup(host_name);
 	new_statusdata->svc_description = (svc_description == NULL) ? NULL : strdup(svc_description);
-	new_statusdata->state_duration = strdup(state_duration);
+	new_statusdata->state_duration = NULL;
 	new_statusdata->ts_state_duration = ts_state_duration;
-	new_statusdata->last_check = strdup(last_check);
+	new_statusdata->ts_last_state_change = ts_last_state_change;
+	new_statusdata->last_check = NULL;
 	new_statusdata->ts_last_check = ts_last_check;
-	new_statusdata->attempts = strdup(attempts);
+	new_statusdata->attempts = NULL;
 
 	new_statusdata->current_attempt = current_attempt;
 
@@ -6043,7 +5992,9 @@ int add_status_data(int status_type, void *data) {
 	new_statusdata->is_flapping = is_flapping;
 	new_statusdata->state_type = state_type;
 
-	new_statusdata->plugin_output = (plugin_output == NULL) ? NULL : strdup(plugin_output);
+	new_statusdata->plugin_output = NULL;
+	new_statusdata->data = data;
+	new_statusdata->formatted = FALSE;
 
 	if (statusdata_list == NULL) {
 		statusdata_list = new_statusdata;
@@ -6055,8 +6006,6 @@ int add_status_data(int status_type, void *data) {
 		last_statusdata->next = NULL;
 	}
 
-	my_free(plugin_output);
-
 	/* count data */
 	if (status_type == HOST_STATUS) {
 
@@ -6115,6 +6064,106 @@ int add_status_data(int status_type, void *data) {
 	return OK;
 }
 
+/* formats the strings of a status data element which is going to be displayed */
+void format_status_data(statusdata *status_data) {
+	hoststatus *host_status = NULL;
+	servicestatus *service_status = NULL;
+	char *plugin_output_short = NULL;
+	char *plugin_output_long = NULL;
+	char *plugin_output = NULL;
+	char last_check[MAX_DATETIME_LENGTH];
+	char state_duration[48];
+	char attempts[MAX_INPUT_BUFFER];
+	time_t ts_last_check = 0L;
+	time_t ts_last_state_change = 0L;
+	int days;
+	int hours;
+	int minutes;
+	int seconds;
+	int duration_error = FALSE;
+	int dummy = 0;
+
+	if (status_data == NULL || status_data->formatted == TRUE)
+		return;
+
+	if (status_data->type == HOST_STATUS) {
+
+		host_status = (hoststatus *)status_data->data;
+
+		plugin_output_short = host_status->plugin_output;
+		plugin_output_long = host_status->long_plugin_output;
+
+		snprintf(attempts, sizeof(attempts) - 1, "%d/%d", host_status->current_attempt, host_status->max_attempts);
+		attempts[sizeof(attempts) - 1] = '\x0';
+
+	} else {
+
+		service_status = (servicestatus *)status_data->data;
+
+		plugin_output_short = service_status->plugin_output;
+		plugin_output_long = service_status->long_plugin_output;
+
+		if (content_type == CSV_CONTENT || content_type == JSON_CONTENT)
+			snprintf(attempts, sizeof(attempts) - 1, "%d/%d", service_status->current_attempt, service_status->max_attempts);
+		else
+			snprintf(attempts, sizeof(attempts) - 1, "%d/%d %s#%d%s", service_status->current_attempt, service_status->max_attempts, (service_status->status & (service_status->state_type == HARD_STATE ? add_notif_num_hard : add_notif_num_soft) ? "(" : "<!-- "), service_status->current_notification_number, (service_status->status & (service_status->state_type == HARD_STATE ? add_notif_num_hard : add_notif_num_soft) ? ")" : " -->"));
+		attempts[sizeof(attempts) - 1] = '\x0';
+	}
+
+	ts_last_check = status_data->ts_last_check;
+	ts_last_state_change = status_data->ts_last_state_change;
+
+	/* last check timestamp to string */
+	get_time_string(&ts_last_check, last_check, (int)sizeof(last_check), SHORT_DATE_TIME);
+	if ((unsigned long)ts_last_check == 0L)
+		strcpy(last_check, "无");
+
+	/* state duration was calculated by add_status_data(), only check for errors here */
+	if (ts_last_state_change == (time_t)0) {
+		if (program_start > current_time)
+			duration_error = TRUE;
+	} else {
+		if (ts_last_state_change > current_time)
+			duration_error = TRUE;
+	}
+	get_time_breakdown((unsigned long)status_data->ts_state_duration, &days, &hours, &minutes, &seconds);
+	if (duration_error == TRUE)
+		snprintf(state_duration, sizeof(state_duration) - 1, "???");
+	else
+		snprintf(state_duration, sizeof(state_duration) - 1, "%2d天%2d时%2d分%2d秒%s", days, hours, minutes, seconds, (ts_last_state_change == (time_t)0) ? "+" : "");
+	state_duration[sizeof(state_duration) - 1] = '\x0';
+	strip(state_duration);
+
+	/* plugin ouput */
+	if (status_show_long_plugin_output != FALSE && plugin_output_long != NULL) {
+		if (content_type == CSV_CONTENT || content_type == JSON_CONTENT) {
+			if (plugin_output_short != NULL)
+				dummy = asprintf(&plugin_output, "%s", escape_newlines(plugin_output_long));
+			else
+				dummy = asprintf(&plugin_output, "%s %s", plugin_output_short, escape_newlines(plugin_output_long));
+		} else
+			dummy = asprintf(&plugin_output, "%s<BR>%s", (plugin_output_short == NULL) ? "" : html_encode(plugin_output_short, TRUE), html_encode(plugin_output_long, TRUE));
+	} else if (plugin_output_short != NULL) {
+		if (content_type == CSV_CONTENT || content_type == JSON_CONTENT)
+			dummy = asprintf(&plugin_output, "%s", plugin_output_short);
+		else
+			dummy = asprintf(&plugin_output, "%s&nbsp;", html_encode(plugin_output_short, TRUE));
+	} else {
+		if (content_type == CSV_CONTENT || content_type == JSON_CONTENT)
+			plugin_output = NULL;
+		else
+			dummy = asprintf(&plugin_output, "&nbsp;");
+	}
+
+	status_data->last_check = strdup(last_check);
+	status_data->state_duration = strdup(state_duration);
+	status_data->attempts = strdup(attempts);
+	status_data->plugin_output = plugin_output;
+	status_data->formatted = TRUE;
+
+	return;
+}
+
 /* free local created status data */
 void free_local_status_data(void) {
 	statusdata *this_statusdata = NULL;
@@ -6140,10 +6189,10 @@ void free_local_status_data(void) {
 
 /* sorts the service list */
 int sort_status_data(int status_type, int sort_type, int sort_option) {
-	sort *new_sort;
-	sort *last_sort;
 	sort *temp_sort;
 	statusdata *temp_status = NULL;
+	int total_entries = 0;
+	int x = 0;
 
 	if (sort_type == SORT_NONE)
 		return ERROR;
@@ -6151,152 +6200,103 @@ int sort_status_data(int status_type, int sort_type, int sort_option) {
 	if (statusdata_list == NULL)
 		return ERROR;
 
+	for (temp_status = statusdata_list; temp_status != NULL; temp_status = temp_status->next) {
+		if (temp_status->type == status_type)
+			total_entries++;
+	}
+
+	if (total_entries == 0)
+		return OK;
+
+	/* allocate all sort entries at once */
+	statussort_entries = (sort *)malloc(sizeof(sort) * total_entries);
+	if (statussort_entries == NULL)
+		return ERROR;
+
+	/*
+	 * keep the order of entries with equal keys the former insertion sort produced:
+	 * the "<=" comparisons put them in reverse order, unknown sort options reverse the whole list
+	 */
+	statussort_descending = (sort_type == SORT_ASCENDING) ? FALSE : TRUE;
+	statussort_reversed_ties = FALSE;
+	if (sort_type == SORT_ASCENDING && (sort_option == SORT_HOSTURGENCY || (sort_option == SORT_SERVICESTATUS && status_type == SERVICE_STATUS) || (sort_option == SORT_HOSTSTATUS && status_type == HOST_STATUS)))
+		statussort_reversed_ties = TRUE;
+
+	/* precompute the sort keys */
 	for (temp_status = statusdata_list; temp_status != NULL; temp_status = temp_status->next) {
 
 		if (temp_status->type != status_type)
 			continue;
 
-		/* allocate memory for a new sort structure */
-		new_sort = (sort *)malloc(sizeof(sort));
-		if (new_sort == NULL)
-			return ERROR;
+		temp_sort = &statussort_entries[x];
+		temp_sort->status = temp_status;
+		temp_sort->key_string = NULL;
+		temp_sort->key = 0L;
+		temp_sort->position = x;
+
+		if (sort_option == SORT_LASTCHECKTIME)
+			temp_sort->key = (long)temp_status->ts_last_check;
+		else if (sort_option == SORT_CURRENTATTEMPT)
+			temp_sort->key = (long)temp_status->current_attempt;
+		else if (sort_option == SORT_SERVICESTATUS && status_type == SERVICE_STATUS)
+			temp_sort->key = (long)temp_status->status;
+		else if (sort_option == SORT_HOSTURGENCY)
+			temp_sort->key = (long)HOST_URGENCY(temp_status->status);
+		else if (sort_option == SORT_HOSTNAME)
+			temp_sort->key_string = temp_status->host_name;
+		else if (sort_option == SORT_HOSTSTATUS && status_type == HOST_STATUS)
+			temp_sort->key = (long)temp_status->status;
+		else if (sort_option == SORT_SERVICENAME && status_type == SERVICE_STATUS)
+			temp_sort->key_string = temp_status->svc_description;
+		else if (sort_option == SORT_STATEDURATION)
+			temp_sort->key = (long)temp_status->ts_state_duration;
+		else
+			statussort_reversed_ties = TRUE;
 
-		new_sort->status = temp_status;
+		x++;
+	}
 
-		last_sort = statussort_list;
-		for (temp_sort = statussort_list; temp_sort != NULL; temp_sort = temp_sort->next) {
+	qsort(statussort_entries, total_entries, sizeof(sort), compare_sort_entries);
 
-			if (compare_sort_entries(status_type, sort_type, sort_option, new_sort, temp_sort) == TRUE) {
-				new_sort->next = temp_sort;
-				if (temp_sort == statussort_list)
-					statussort_list = new_sort;
-				else
-					last_sort->next = new_sort;
-				break;
-			} else
-				last_sort = temp_sort;
-		}
+	/* link the sorted array, so the list can be walked as before */
+	for (x = 0; x < total_entries - 1; x++)
+		statussort_entries[x].next = &statussort_entries[x + 1];
+	statussort_entries[total_entries - 1].next = NULL;
 
-		if (statussort_list == NULL) {
-			new_sort->next = NULL;
-			statussort_list = new_sort;
-		} else if (temp_sort == NULL) {
-			new_sort->next = NULL;
-			last_sort->next = new_sort;
-		}
-	}
+	statussort_list = statussort_entries;
 
 	return OK;
 }
 
 /* compare status data for sorting */
-int compare_sort_entries(int status_type, int sort_type, int sort_option, sort *new_sort, sort *temp_sort) {
-	statusdata *new_status;
-	statusdata *temp_status;
-
-	new_status = new_sort->status;
-	temp_status = temp_sort->status;
-
-	if (sort_type == SORT_ASCENDING) {
-
-		if (sort_option == SORT_LASTCHECKTIME) {
-			if (new_status->ts_last_check < temp_status->ts_last_check)
-				return TRUE;
-			else
-				return FALSE;
-		} else if (sort_option == SORT_CURRENTATTEMPT) {
-			if (new_status->current_attempt < temp_status->current_attempt)
-				return TRUE;
-			else
-				return FALSE;
-		} else if (sort_option == SORT_SERVICESTATUS && status_type == SERVICE_STATUS) {
-			if (new_status->status <= temp_status->status)
-				return TRUE;
-			else
-				return FALSE;
-		} else if (sort_option == SORT_HOSTURGENCY) {
-			if (HOST_URGENCY(new_status->status) <= HOST_URGENCY(temp_status->status))
-				return TRUE;
-			else
-				return FALSE;
-		} else if (sort_option == SORT_HOSTNAME) {
-			if (strcasecmp(new_status->host_name, temp_status->host_name) < 0)
-				return TRUE;
-			else
-				return FALSE;
-		} else if (sort_option == SORT_HOSTSTATUS && status_type == HOST_STATUS) {
-			if (new_status->status <= temp_status->status)
-				return TRUE;
-			else
-				return FALSE;
-		} else if (sort_option == SORT_SERVICENAME && status_type == SERVICE_STATUS) {
-			if (strcasecmp(new_status->svc_description, temp_status->svc_description) < 0)
-				return TRUE;
-			else
-				return FALSE;
-		} else if (sort_option == SORT_STATEDURATION) {
-			if (new_status->ts_state_duration < temp_status->ts_state_duration)
-				return TRUE;
-			else
-				return FALSE;
-		}
-	} else {
-		if (sort_option == SORT_LASTCHECKTIME) {
-			if (new_status->ts_last_check > temp_status->ts_last_check)
-				return TRUE;
-			else
-				return FALSE;
-		} else if (sort_option == SORT_CURRENTATTEMPT) {
-			if (new_status->current_attempt > temp_status->current_attempt)
-				return TRUE;
-			else
-				return FALSE;
-		} else if (sort_option == SORT_SERVICESTATUS && status_type == SERVICE_STATUS) {
-			if (new_status->status > temp_status->status)
-				return TRUE;
-			else
-				return FALSE;
-		} else if (sort_option == SORT_HOSTURGENCY) {
-			if (HOST_URGENCY(new_status->status) > HOST_URGENCY(temp_status->status))
-				return TRUE;
-			else
-				return FALSE;
-		} else if (sort_option == SORT_HOSTNAME) {
-			if (strcasecmp(new_status->host_name, temp_status->host_name) > 0)
-				return TRUE;
-			else
-				return FALSE;
-		} else if (sort_option == SORT_HOSTSTATUS && status_type == HOST_STATUS) {
-			if (new_status->status > temp_status->status)
-				return TRUE;
-			else
-				return FALSE;
-		} else if (sort_option == SORT_SERVICENAME && status_type == SERVICE_STATUS) {
-			if (strcasecmp(new_status->svc_description, temp_status->svc_description) > 0)
-				return TRUE;
-			else
-				return FALSE;
-		} else if (sort_option == SORT_STATEDURATION) {
-			if (new_status->ts_state_duration > temp_status->ts_state_duration)
-				return TRUE;
-			else
-				return FALSE;
-		}
-	}
-
-	return TRUE;
+int compare_sort_entries(const void *a, const void *b) {
+	const sort *first_sort = (const sort *)a;
+	const sort *second_sort = (const sort *)b;
+	int result = 0;
+
+	if (first_sort->key_string != NULL && second_sort->key_string != NULL)
+		result = strcasecmp(first_sort->key_string, second_sort->key_string);
+	else if (first_sort->key < second_sort->key)
+		result = -1;
+	else if (first_sort->key > second_sort->key)
+		result = 1;
+
+	if (result != 0)
+		return (statussort_descending == TRUE) ? -result : result;
+
+	/* equal keys */
+	if (statussort_reversed_ties == TRUE)
+		return second_sort->position - first_sort->position;
+
+	return first_sort->position - second_sort->position;
 }
 
 /* free list of sorted items */
 void free_sort_list(void) {
-	sort *this_sort;
-	sort *next_sort;
 
-	/* free memory for sort list */
-	for (this_sort = statussort_list; this_sort != NULL; this_sort = next_sort) {
-		next_sort = this_sort->next;
-		free(this_sort);
-	}
+	/* all entries of the sort list are held by one array */
+	my_free(statussort_entries);
+	statussort_list = NULL;
 
 	return;
 }
@@ -47,6 +47,8 @@
 comment     *comment_list = NULL;
 int	    defer_comment_sorting = 0;
 comment     **comment_hashlist = NULL;
+comment     **comment_id_hashlist = NULL;
+static comment *comment_list_tail = NULL;
 
 
 
@@ -169,8 +171,6 @@ int add_new_service_comment(int entry_type, char *host_name, char *svc_descripti
 int delete_comment(int type, unsigned long comment_id) {
 	int result = OK;
 	comment *this_comment = NULL;
-	comment *last_comment = NULL;
-	comment *next_comment = NULL;
 	int hashslot = 0;
 	comment *this_hash = NULL;
 	comment *last_hash = NULL;
@@ -181,15 +181,7 @@ int delete_comment(int type, unsigned long comment_id) {
 #endif
 
 	/* find the comment we should remove */
-	for (this_comment = comment_list, last_comment = comment_list; this_comment != NULL; this_comment = next_comment) {
-		next_comment = this_comment->next;
-
-		/* we found the comment we should delete */
-		if (this_comment->comment_id == comment_id && this_comment->comment_type == type)
-			break;
-
-		last_comment = this_comment;
-	}
+	this_comment = find_comment(comment_id, type);
 
 	/* remove the comment from the list in memory */
 	if (this_comment != NULL) {
@@ -218,11 +210,29 @@ int delete_comment(int type, unsigned long comment_id) {
 			last_hash = this_hash;
 		}
 
+		/* then from the id hash list */
+		hashslot = comment_id % COMMENT_ID_HASHSLOTS;
+		last_hash = NULL;
+		for (this_hash = comment_id_hashlist[hashslot]; this_hash; this_hash = this_hash->nextid) {
+			if (this_hash == this_comment) {
+				if (last_hash)
+					last_hash->nextid = this_hash->nextid;
+				else
+					comment_id_hashlist[hashslot] = this_hash->nextid;
+				break;
+			}
+			last_hash = this_hash;
+		}
+
 		/* then removed from linked list */
-		if (comment_list == this_comment)
+		if (this_comment->prev == NULL)
 			comment_list = this_comment->next;
 		else
-			last_comment->next = next_comment;
+			this_comment->prev->next = this_comment->next;
+		if (this_comment->next == NULL)
+			comment_list_tail = this_comment->prev;
+		else
+			this_comment->next->prev = this_comment->prev;
 
 		/* free memory */
 		my_free(this_comment->host_name);
@@ -337,9 +347,9 @@ int delete_all_service_comments(char *host_name, char *svc_description) {
 		return ERROR;
 
 	/* delete service comments from memory */
-	for (temp_comment = comment_list; temp_comment != NULL; temp_comment = next_comment) {
-		next_comment = temp_comment->next;
-		if (temp_comment->comment_type == SERVICE_COMMENT && !strcmp(temp_comment->host_name, host_name) && !strcmp(temp_comment->service_description, svc_description))
+	for (temp_comment = get_first_comment_by_host(host_name); temp_comment != NULL; temp_comment = next_comment) {
+		next_comment = get_next_comment_by_host(host_name, temp_comment);
+		if (temp_comment->comment_type == SERVICE_COMMENT && !strcmp(temp_comment->service_description, svc_description))
 			delete_comment(SERVICE_COMMENT, temp_comment->comment_id);
 	}
 
@@ -357,9 +367,9 @@ int delete_service_acknowledgement_comments(service *svc) {
 		return ERROR;
 
 	/* delete comments from memory */
-	for (temp_comment = comment_list; temp_comment != NULL; temp_comment = next_comment) {
-		next_comment = temp_comment->next;
-		if (temp_comment->comment_type == SERVICE_COMMENT && !strcmp(temp_comment->host_name, svc->host_name) && !strcmp(temp_comment->service_description, svc->description)  && temp_comment->entry_type == ACKNOWLEDGEMENT_COMMENT && temp_comment->persistent == FALSE)
+	for (temp_comment = get_first_comment_by_host(svc->host_name); temp_comment != NULL; temp_comment = next_comment) {
+		next_comment = get_next_comment_by_host(svc->host_name, temp_comment);
+		if (temp_comment->comment_type == SERVICE_COMMENT && !strcmp(temp_comment->service_description, svc->description) && temp_comment->entry_type == ACKNOWLEDGEMENT_COMMENT && temp_comment->persistent == FALSE)
 			delete_comment(SERVICE_COMMENT, temp_comment->comment_id);
 	}
 
@@ -370,18 +380,11 @@ int delete_service_acknowledgement_comments(service *svc) {
 /* checks for an expired comment (and removes it) */
 int check_for_expired_comment(unsigned long comment_id) {
 	comment *temp_comment = NULL;
-	comment *next_comment = NULL;
 
-	/* check all comments */
-	for (temp_comment = comment_list; temp_comment != NULL; temp_comment = next_comment) {
-		next_comment = temp_comment->next;
-
-		/* delete the now expired comment */
-		if (temp_comment->comment_id == comment_id && temp_comment->expires == TRUE && temp_comment->expire_time < time(NULL)) {
-			delete_comment(temp_comment->comment_type, comment_id);
-			break;
-		}
-	}
+	/* delete the now expired comment */
+	temp_comment = find_comment(comment_id, ANY_COMMENT);
+	if (temp_comment != NULL && temp_comment->expires == TRUE && temp_comment->expire_time < time(NULL))
+		delete_comment(temp_comment->comment_type, comment_id);
 
 	return OK;
 }
@@ -397,13 +400,13 @@ int check_for_expired_comment(unsigned long comment_id) {
 /****************** CHAINED HASH FUNCTIONS ************************/
 /******************************************************************/
 
-/* adds comment to hash list in memory */
+/* adds comment to the host name and id hash lists in memory */
 int add_comment_to_hashlist(comment *new_comment) {
 	comment *temp_comment = NULL;
 	comment *lastpointer = NULL;
 	int hashslot = 0;
 
-	/* initialize hash list */
+	/* initialize hash lists */
 	if (comment_hashlist == NULL) {
 		int i;
 
@@ -414,6 +417,16 @@ int add_comment_to_hashlist(comment *new_comment) {
 		for (i = 0; i < COMMENT_HASHSLOTS; i++)
 			comment_hashlist[i] = NULL;
 	}
+	if (comment_id_hashlist == NULL) {
+		int i;
+
+		comment_id_hashlist = (comment **)malloc(sizeof(comment *) * COMMENT_ID_HASHSLOTS);
+		if (comment_id_hashlist == NULL)
+			return 0;
+
+		for (i = 0; i < COMMENT_ID_HASHSLOTS; i++)
+			comment_id_hashlist[i] = NULL;
+	}
 
 	if (!new_comment)
 		return 0;
@@ -433,6 +446,10 @@ int add_comment_to_hashlist(comment *new_comment) {
 		comment_hashlist[hashslot] = new_comment;
 	new_comment->nexthash = temp_comment;
 
+	hashslot = new_comment->comment_id % COMMENT_ID_HASHSLOTS;
+	new_comment->nextid = comment_id_hashlist[hashslot];
+	comment_id_hashlist[hashslot] = new_comment;
+
 	return 1;
 }
 
@@ -468,7 +485,6 @@ int add_service_comment(int entry_type, char *host_name, char *svc_description,
 /* adds a comment to the list in memory */
 int add_comment(int comment_type, int entry_type, char *host_name, char *svc_description, time_t entry_time, char *author, char *comment_data, unsigned long comment_id, int persistent, int expires, time_t expire_time, int source) {
 	comment *new_comment = NULL;
-	comment *last_comment = NULL;
 	comment *temp_comment = NULL;
 	int result = OK;
 
@@ -518,35 +534,36 @@ int add_comment(int comment_type, int entry_type, char *host_name, char *svc_des
 	}
 
 	if (defer_comment_sorting) {
+		new_comment->prev = NULL;
 		new_comment->next = comment_list;
+		if (comment_list == NULL)
+			comment_list_tail = new_comment;
+		else
+			comment_list->prev = new_comment;
 		comment_list = new_comment;
 	} else {
 		/* add new comment to comment list, sorted by comment id,
 		 * but lock the list first so broker threads doesn't crash
-		 * out in case they're modifying this list too
+		 * out in case they're modifying this list too.
+		 * new comments usually get the highest id, so look from the end.
 		 */
 #ifdef NSCORE
 		pthread_mutex_lock(&icinga_comment_lock);
 #endif
-		last_comment = comment_list;
-		for (temp_comment = comment_list; temp_comment != NULL; temp_comment = temp_comment->next) {
-			if (new_comment->comment_id < temp_comment->comment_id) {
-				new_comment->next = temp_comment;
-				if (temp_comment == comment_list)
-					comment_list = new_comment;
-				else
-					last_comment->next = new_comment;
-				break;
-			} else
-				last_comment = temp_comment;
-		}
-		if (comment_list == NULL) {
-			new_comment->next = NULL;
+		for (temp_comment = comment_list_tail; temp_comment != NULL && new_comment->comment_id < temp_comment->comment_id; temp_comment = temp_comment->prev);
+
+		new_comment->prev = temp_comment;
+		if (temp_comment == NULL) {
+			new_comment->next = comment_list;
 			comment_list = new_comment;
-		} else if (temp_comment == NULL) {
-			new_comment->next = NULL;
-			last_comment->next = new_comment;
+		} else {
+			new_comment->next = temp_comment->next;
+			temp_comment->next = new_comment;
 		}
+		if (new_comment->next == NULL)
+			comment_list_tail = new_comment;
+		else
+			new_comment->next->prev = new_comment;
 #ifdef NSCORE
 		pthread_mutex_unlock(&icinga_comment_lock);
 #endif
@@ -594,11 +611,14 @@ int sort_comments(void) {
 
 	qsort((void *)array, i, sizeof(*array), comment_compar);
 	comment_list = temp_comment = array[0];
+	temp_comment->prev = NULL;
 	for (i = 1; i < unsorted_comments; i++) {
 		temp_comment->next = array[i];
+		array[i]->prev = temp_comment;
 		temp_comment = temp_comment->next;
 	}
 	temp_comment->next = NULL;
+	comment_list_tail = temp_comment;
 	my_free(array);
 	return OK;
 }
@@ -622,10 +642,11 @@ void free_comment_data(void) {
 		my_free(this_comment);
 	}
 
-	/* free hash list and reset list pointer */
+	/* free hash lists and reset list pointers */
 	my_free(comment_hashlist);
-	comment_hashlist = NULL;
+	my_free(comment_id_hashlist);
 	comment_list = NULL;
+	comment_list_tail = NULL;
 
 	return;
 }
@@ -725,7 +746,10 @@ comment *find_host_comment(unsigned long comment_id) {
 comment *find_comment(unsigned long comment_id, int comment_type) {
 	comment *temp_comment = NULL;
 
-	for (temp_comment = comment_list; temp_comment != NULL; temp_comment = temp_comment->next) {
+	if (comment_id_hashlist == NULL)
+		return NULL;
+
+	for (temp_comment = comment_id_hashlist[comment_id % COMMENT_ID_HASHSLOTS]; temp_comment != NULL; temp_comment = temp_comment->nextid) {
 		if (comment_type != ANY_COMMENT && temp_comment->comment_type != comment_type)
 			continue;
 		if (temp_comment->comment_id == comment_id)
@@ -739,9 +763,8 @@ comment *find_comment(unsigned long comment_id, int comment_type) {
 comment *find_comment_by_similar_content(int comment_type, char *hostname, char *service_description, char *author, char *comment_data) {
 	comment *temp_comment = NULL;
 
-	for (temp_comment = comment_list; temp_comment != NULL; temp_comment = temp_comment->next) {
+	for (temp_comment = get_first_comment_by_host(hostname); temp_comment != NULL; temp_comment = get_next_comment_by_host(hostname, temp_comment)) {
 		if (temp_comment->comment_type == comment_type
-		        && strcmp(temp_comment->host_name, hostname) == 0
 		        && (service_description == NULL || strcmp(temp_comment->service_description, service_description) == 0)
 		        && strcmp(temp_comment->author, author) == 0
 		        && strcmp(temp_comment->comment_data, comment_data) == 0)
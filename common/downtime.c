@@ -47,6 +47,14 @@
 
 
 scheduled_downtime *scheduled_downtime_list = NULL;
+static scheduled_downtime *scheduled_downtime_list_tail = NULL;
+scheduled_downtime **downtime_hashlist = NULL;
+scheduled_downtime **downtime_id_hashlist = NULL;
+
+#ifdef NSCORE
+static void remove_downtime_from_hashlist(scheduled_downtime *);
+#endif
+
 /*
  * downtimes are not sorted by id, but starttime
  * this leads into https://dev.icinga.org/issues/2688
@@ -59,8 +67,7 @@ scheduled_downtime *scheduled_downtime_list = NULL;
 int		   defer_downtime_sorting = 0;
 
 #ifdef NSCORE
-extern timed_event *event_list_high;
-extern timed_event *event_list_high_tail;
+extern timed_event_queue event_queue_high;
 pthread_mutex_t icinga_downtime_lock = PTHREAD_MUTEX_INITIALIZER;
 #endif
 
@@ -138,6 +145,7 @@ int unschedule_downtime(int type, unsigned long downtime_id) {
 	host *hst = NULL;
 	service *svc = NULL;
 	timed_event *temp_event = NULL;
+	unsigned int x = 0;
 #ifdef USE_EVENT_BROKER
 	int attr = 0;
 #endif
@@ -208,14 +216,15 @@ int unschedule_downtime(int type, unsigned long downtime_id) {
 	}
 
 	/* remove scheduled entry from event queue */
-	for (temp_event = event_list_high; temp_event != NULL; temp_event = temp_event->next) {
+	for (x = 1; x <= event_queue_high.heap.count; x++) {
+		temp_event = (timed_event *)event_queue_high.heap.items[x];
 		if (temp_event->event_type != EVENT_SCHEDULED_DOWNTIME)
 			continue;
 		if (((unsigned long)temp_event->event_data) == downtime_id)
 			break;
 	}
-	if (temp_event != NULL) {
-		remove_event(temp_event, &event_list_high, &event_list_high_tail);
+	if (x <= event_queue_high.heap.count) {
+		remove_event(temp_event, &event_queue_high);
 		my_free(temp_event->event_data);
 		my_free(temp_event);
 	}
@@ -598,8 +607,8 @@ int check_pending_flex_host_downtime(host *hst) {
 	if (hst->current_state == HOST_UP)
 		return OK;
 
-	/* check all downtime entries */
-	for (temp_downtime = scheduled_downtime_list; temp_downtime != NULL; temp_downtime = temp_downtime->next) {
+	/* check all downtime entries of this host */
+	for (temp_downtime = get_first_downtime_by_host(hst->name); temp_downtime != NULL; temp_downtime = get_next_downtime_by_host(hst->name, temp_downtime)) {
 
 		if (temp_downtime->type != HOST_DOWNTIME)
 			continue;
@@ -614,17 +623,13 @@ int check_pending_flex_host_downtime(host *hst) {
 		if (temp_downtime->triggered_by != 0)
 			continue;
 
-		/* this entry matches our host! */
-		if (find_host(temp_downtime->host_name) == hst) {
-
-			/* if the time boundaries are okay, start this scheduled downtime */
-			if (temp_downtime->start_time <= current_time && current_time <= temp_downtime->end_time) {
+		/* if the time boundaries are okay, start this scheduled downtime */
+		if (temp_downtime->start_time <= current_time && current_time <= temp_downtime->end_time) {
 
-				log_debug_info(DEBUGL_DOWNTIME, 0, "从现在开始主机'%s'的可变宕机(id=%lu)...\n", hst->name, temp_downtime->downtime_id);
+			log_debug_info(DEBUGL_DOWNTIME, 0, "从现在开始主机'%s'的可变宕机(id=%lu)...\n", hst->name, temp_downtime->downtime_id);
 
-				temp_downtime->start_flex_downtime = TRUE;
-				handle_scheduled_downtime(temp_downtime);
-			}
+			temp_downtime->start_flex_downtime = TRUE;
+			handle_scheduled_downtime(temp_downtime);
 		}
 	}
 
@@ -649,8 +654,8 @@ int check_pending_flex_service_downtime(service *svc) {
 	if (svc->current_state == STATE_OK)
 		return OK;
 
-	/* check all downtime entries */
-	for (temp_downtime = scheduled_downtime_list; temp_downtime != NULL; temp_downtime = temp_downtime->next) {
+	/* check all downtime entries of the host this service runs on */
+	for (temp_downtime = get_first_downtime_by_host(svc->host_name); temp_downtime != NULL; temp_downtime = get_next_downtime_by_host(svc->host_name, temp_downtime)) {
 
 		if (temp_downtime->type != SERVICE_DOWNTIME)
 			continue;
@@ -666,7 +671,7 @@ int check_pending_flex_service_downtime(service *svc) {
 			continue;
 
 		/* this entry matches our service! */
-		if (find_service(temp_downtime->host_name, temp_downtime->service_description) == svc) {
+		if (!strcmp(temp_downtime->service_description, svc->description)) {
 
 			/* if the time boundaries are okay, start this scheduled downtime */
 			if (temp_downtime->start_time <= current_time && current_time <= temp_downtime->end_time) {
@@ -797,23 +802,13 @@ int add_new_service_downtime(char *host_name, char *service_description, time_t
 int delete_downtime(int type, unsigned long downtime_id) {
 	int result = OK;
 	scheduled_downtime *this_downtime = NULL;
-	scheduled_downtime *last_downtime = NULL;
-	scheduled_downtime *next_downtime = NULL;
 
 #ifdef NSCORE
 	pthread_mutex_lock(&icinga_downtime_lock);
 #endif
 
 	/* find the downtime we should remove */
-	for (this_downtime = scheduled_downtime_list, last_downtime = scheduled_downtime_list; this_downtime != NULL; this_downtime = next_downtime) {
-		next_downtime = this_downtime->next;
-
-		/* we found the downtime we should delete */
-		if (this_downtime->downtime_id == downtime_id && this_downtime->type == type)
-			break;
-
-		last_downtime = this_downtime;
-	}
+	this_downtime = find_downtime(type, downtime_id);
 
 	/* remove the downtime from the list in memory */
 	if (this_downtime != NULL) {
@@ -829,10 +824,17 @@ int delete_downtime(int type, unsigned long downtime_id) {
 		broker_downtime_data(NEBTYPE_DOWNTIME_DELETE, NEBFLAG_NONE, NEBATTR_NONE, type, this_downtime->host_name, this_downtime->service_description, this_downtime->entry_time, this_downtime->author, this_downtime->comment, this_downtime->start_time, this_downtime->end_time, this_downtime->fixed, this_downtime->triggered_by, this_downtime->duration, downtime_id, NULL, this_downtime->is_in_effect, this_downtime->trigger_time);
 #endif
 
-		if (scheduled_downtime_list == this_downtime)
+		/* remove from the hash lists and the linked list */
+		remove_downtime_from_hashlist(this_downtime);
+
+		if (this_downtime->prev == NULL)
 			scheduled_downtime_list = this_downtime->next;
 		else
-			last_downtime->next = next_downtime;
+			this_downtime->prev->next = this_downtime->next;
+		if (this_downtime->next == NULL)
+			scheduled_downtime_list_tail = this_downtime->prev;
+		else
+			this_downtime->next->prev = this_downtime->prev;
 
 		/* free memory */
 		my_free(this_downtime->host_name);
@@ -947,6 +949,78 @@ int delete_downtime_by_hostname_service_description_start_time_comment(char *hos
 
 
 
+/******************************************************************/
+/****************** CHAINED HASH FUNCTIONS ************************/
+/******************************************************************/
+
+/* adds downtime to the host name and id hash lists in memory */
+int add_downtime_to_hashlist(scheduled_downtime *new_downtime) {
+	scheduled_downtime *temp_downtime = NULL;
+	scheduled_downtime *lastpointer = NULL;
+	int hashslot = 0;
+
+	/* initialize hash lists */
+	if (downtime_hashlist == NULL) {
+		if ((downtime_hashlist = (scheduled_downtime **)calloc(DOWNTIME_HASHSLOTS, sizeof(scheduled_downtime *))) == NULL)
+			return 0;
+	}
+	if (downtime_id_hashlist == NULL) {
+		if ((downtime_id_hashlist = (scheduled_downtime **)calloc(DOWNTIME_ID_HASHSLOTS, sizeof(scheduled_downtime *))) == NULL)
+			return 0;
+	}
+
+	if (!new_downtime)
+		return 0;
+
+	hashslot = hashfunc(new_downtime->host_name, NULL, DOWNTIME_HASHSLOTS);
+	lastpointer = NULL;
+	for (temp_downtime = downtime_hashlist[hashslot]; temp_downtime && compare_hashdata(temp_downtime->host_name, NULL, new_downtime->host_name, NULL) < 0; temp_downtime = temp_downtime->nexthash)
+		lastpointer = temp_downtime;
+
+	/* multiples are allowed */
+	if (lastpointer)
+		lastpointer->nexthash = new_downtime;
+	else
+		downtime_hashlist[hashslot] = new_downtime;
+	new_downtime->nexthash = temp_downtime;
+
+	hashslot = new_downtime->downtime_id % DOWNTIME_ID_HASHSLOTS;
+	new_downtime->nextid = downtime_id_hashlist[hashslot];
+	downtime_id_hashlist[hashslot] = new_downtime;
+
+	return 1;
+}
+
+
+#ifdef NSCORE
+/* removes downtime from the hash lists in memory */
+static void remove_downtime_from_hashlist(scheduled_downtime *this_downtime) {
+	scheduled_downtime **temp_ptr = NULL;
+
+	if (downtime_hashlist != NULL) {
+		for (temp_ptr = &downtime_hashlist[hashfunc(this_downtime->host_name, NULL, DOWNTIME_HASHSLOTS)]; *temp_ptr != NULL; temp_ptr = &((*temp_ptr)->nexthash)) {
+			if (*temp_ptr == this_downtime) {
+				*temp_ptr = this_downtime->nexthash;
+				break;
+			}
+		}
+	}
+
+	if (downtime_id_hashlist != NULL) {
+		for (temp_ptr = &downtime_id_hashlist[this_downtime->downtime_id % DOWNTIME_ID_HASHSLOTS]; *temp_ptr != NULL; temp_ptr = &((*temp_ptr)->nextid)) {
+			if (*temp_ptr == this_downtime) {
+				*temp_ptr = this_downtime->nextid;
+				break;
+			}
+		}
+	}
+
+	return;
+}
+#endif
+
+
+
 /******************************************************************/
 /******************** ADDITION FUNCTIONS **************************/
 /******************************************************************/
@@ -974,7 +1048,6 @@ int add_service_downtime(char *host_name, char *svc_description, time_t entry_ti
 /* adds a host or service downtime entry to the list in memory */
 int add_downtime(int downtime_type, char *host_name, char *svc_description, time_t entry_time, char *author, char *comment_data, time_t start_time, time_t end_time, int fixed, unsigned long triggered_by, unsigned long duration, unsigned long downtime_id, int is_in_effect, time_t trigger_time) {
 	scheduled_downtime *new_downtime = NULL;
-	scheduled_downtime *last_downtime = NULL;
 	scheduled_downtime *temp_downtime = NULL;
 	int result = OK;
 
@@ -1027,43 +1100,57 @@ int add_downtime(int downtime_type, char *host_name, char *svc_description, time
 	new_downtime->is_in_effect = is_in_effect;
 	new_downtime->trigger_time = trigger_time;
 
+#ifdef NSCORE
+	pthread_mutex_lock(&icinga_downtime_lock);
+#endif
+
+	/* add downtime to the host name and id hash lists */
+	if (!add_downtime_to_hashlist(new_downtime)) {
+#ifdef NSCORE
+		pthread_mutex_unlock(&icinga_downtime_lock);
+#endif
+		my_free(new_downtime->comment);
+		my_free(new_downtime->author);
+		my_free(new_downtime->service_description);
+		my_free(new_downtime->host_name);
+		my_free(new_downtime);
+		return ERROR;
+	}
+
 	if (defer_downtime_sorting) {
+		new_downtime->prev = NULL;
 		new_downtime->next = scheduled_downtime_list;
+		if (scheduled_downtime_list == NULL)
+			scheduled_downtime_list_tail = new_downtime;
+		else
+			scheduled_downtime_list->prev = new_downtime;
 		scheduled_downtime_list = new_downtime;
 	} else {
 		/*
 		 * add new downtime to downtime list, sorted by start time,
 		 * but lock the lists first so broker modules fiddling
 		 * with them at the same time doesn't crash out.
+		 * new downtimes usually start last, so look from the end.
 		 */
-#ifdef NSCORE
-		pthread_mutex_lock(&icinga_downtime_lock);
-#endif
-		last_downtime = scheduled_downtime_list;
-		for (temp_downtime = scheduled_downtime_list; temp_downtime != NULL; temp_downtime = temp_downtime->next) {
-			if (new_downtime->start_time < temp_downtime->start_time) {
-				new_downtime->next = temp_downtime;
-				if (temp_downtime == scheduled_downtime_list)
-					scheduled_downtime_list = new_downtime;
-				else
-					last_downtime->next = new_downtime;
-				break;
-			} else
-				last_downtime = temp_downtime;
-		}
+		for (temp_downtime = scheduled_downtime_list_tail; temp_downtime != NULL && new_downtime->start_time < temp_downtime->start_time; temp_downtime = temp_downtime->prev);
 
-		if (scheduled_downtime_list == NULL) {
-			new_downtime->next = NULL;
+		new_downtime->prev = temp_downtime;
+		if (temp_downtime == NULL) {
+			new_downtime->next = scheduled_downtime_list;
 			scheduled_downtime_list = new_downtime;
-		} else if (temp_downtime == NULL) {
-			new_downtime->next = NULL;
-			last_downtime->next = new_downtime;
+		} else {
+			new_downtime->next = temp_downtime->next;
+			temp_downtime->next = new_downtime;
 		}
-#ifdef NSCORE
-		pthread_mutex_unlock(&icinga_downtime_lock);
-#endif
+		if (new_downtime->next == NULL)
+			scheduled_downtime_list_tail = new_downtime;
+		else
+			new_downtime->next->prev = new_downtime;
 	}
+
 #ifdef NSCORE
+	pthread_mutex_unlock(&icinga_downtime_lock);
+
 #ifdef USE_EVENT_BROKER
 	/* send data to event broker */
 	broker_downtime_data(NEBTYPE_DOWNTIME_LOAD, NEBFLAG_NONE, NEBATTR_NONE, downtime_type, host_name, svc_description, entry_time, author, comment_data, start_time, end_time, fixed, triggered_by, duration, downtime_id, NULL, is_in_effect, trigger_time);
@@ -1115,17 +1202,51 @@ int sort_downtime(void) {
 
 	qsort((void *)array, i, sizeof(*array), downtime_compar);
 	scheduled_downtime_list = temp_downtime = array[0];
+	temp_downtime->prev = NULL;
 	for (i = 1; i < unsorted_downtimes; i++) {
 		temp_downtime->next = array[i];
+		array[i]->prev = temp_downtime;
 		temp_downtime = temp_downtime->next;
 	}
 	temp_downtime->next = NULL;
+	scheduled_downtime_list_tail = temp_downtime;
 	my_free(array);
 	return OK;
 }
 
 
 
+/******************************************************************/
+/********************* TRAVERSAL FUNCTIONS ************************/
+/******************************************************************/
+
+scheduled_downtime *get_first_downtime_by_host(char *host_name) {
+
+	return get_next_downtime_by_host(host_name, NULL);
+}
+
+
+scheduled_downtime *get_next_downtime_by_host(char *host_name, scheduled_downtime *start) {
+	scheduled_downtime *temp_downtime = NULL;
+
+	if (host_name == NULL || downtime_hashlist == NULL)
+		return NULL;
+
+	if (start == NULL)
+		temp_downtime = downtime_hashlist[hashfunc(host_name, NULL, DOWNTIME_HASHSLOTS)];
+	else
+		temp_downtime = start->nexthash;
+
+	for (; temp_downtime && compare_hashdata(temp_downtime->host_name, NULL, host_name, NULL) < 0; temp_downtime = temp_downtime->nexthash);
+
+	if (temp_downtime && compare_hashdata(temp_downtime->host_name, NULL, host_name, NULL) == 0)
+		return temp_downtime;
+
+	return NULL;
+}
+
+
+
 /******************************************************************/
 /************************ SEARCH FUNCTIONS ************************/
 /******************************************************************/
@@ -1134,7 +1255,10 @@ int sort_downtime(void) {
 scheduled_downtime *find_downtime(int type, unsigned long downtime_id) {
 	scheduled_downtime *temp_downtime = NULL;
 
-	for (temp_downtime = scheduled_downtime_list; temp_downtime != NULL; temp_downtime = temp_downtime->next) {
+	if (downtime_id_hashlist == NULL)
+		return NULL;
+
+	for (temp_downtime = downtime_id_hashlist[downtime_id % DOWNTIME_ID_HASHSLOTS]; temp_downtime != NULL; temp_downtime = temp_downtime->nextid) {
 		if (type != ANY_DOWNTIME && temp_downtime->type != type)
 			continue;
 		if (temp_downtime->downtime_id == downtime_id)
@@ -1172,7 +1296,7 @@ scheduled_downtime *find_downtime_by_similar_content(int type, char *host_name,
 			return NULL;
 	}
 
-	for (temp_downtime = scheduled_downtime_list; temp_downtime != NULL; temp_downtime = temp_downtime->next) {
+	for (temp_downtime = get_first_downtime_by_host(host_name); temp_downtime != NULL; temp_downtime = get_next_downtime_by_host(host_name, temp_downtime)) {
 
 		if (type != ANY_DOWNTIME && temp_downtime->type != type)
 			continue;
@@ -1181,7 +1305,6 @@ scheduled_downtime *find_downtime_by_similar_content(int type, char *host_name,
 		        && temp_downtime->end_time == end_time
 		        && temp_downtime->fixed == fixed
 		        && temp_downtime->duration == duration
-		        && strcmp(temp_downtime->host_name, host_name) == 0
 		        && (service_description == NULL || (temp_downtime->type == SERVICE_DOWNTIME && strcmp(temp_downtime->service_description, service_description) == 0))
 		        && strcmp(temp_downtime->author, author) == 0
 		        && strcmp(temp_downtime->comment, comment_data) == 0)
@@ -1211,8 +1334,11 @@ void free_downtime_data(void) {
 		my_free(this_downtime);
 	}
 
-	/* reset list pointer */
+	/* free hash lists and reset list pointers */
+	my_free(downtime_hashlist);
+	my_free(downtime_id_hashlist);
 	scheduled_downtime_list = NULL;
+	scheduled_downtime_list_tail = NULL;
 
 	return;
 }
@@ -1,6 +1,6 @@
 /*****************************************************************************
  *
- * EXTCMD_LIST.C for Icinga CGIs
+ * EXTCMD_LIST.C - External command names for the Icinga core and CGIs
  *
  * Copyright (c) 1999-2009 Ethan Galstad (egalstad@nagios.org)
  * Copyright (c) 2009-2013 Icinga Development Team (http://www.icinga.org)
@@ -25,11 +25,13 @@
 #include <stdio.h>
 #include <unistd.h>
 #include <stdlib.h>
+#include <string.h>
 #include "../include/common.h"
 
 struct nagios_extcmd {
 	const char *name;
 	int id;
+	int cgi_only;		/* known to the CGIs, but not accepted by the core */
 	/*	size_t namelen;
 		int min_args;
 		int (*handler)(struct nagios_extcmd *, int, char **);
@@ -38,10 +40,14 @@ struct nagios_extcmd {
 };
 
 #define CMD_DEF(name, min_args, handler) \
-	{ #name, CMD_ ## name }
+	{ #name, CMD_ ## name, FALSE }
+#define CMD_DEF_CGI(name) \
+	{ #name, CMD_ ## name, TRUE }
+#define CMD_ALIAS(alias, name) \
+	{ #alias, CMD_ ## name, FALSE }
 /*	{ #name, sizeof(#name) - 1, CMD_ ## name, min_args, handler, NULL } */
 struct nagios_extcmd in_core_commands[] = {
-	CMD_DEF(NONE, 0, NULL),
+	CMD_DEF_CGI(NONE),
 	CMD_DEF(ADD_HOST_COMMENT, 0, NULL),
 	CMD_DEF(DEL_HOST_COMMENT, 0, NULL),
 	CMD_DEF(ADD_SVC_COMMENT, 0, NULL),
@@ -59,7 +65,7 @@ struct nagios_extcmd in_core_commands[] = {
 	CMD_DEF(ENABLE_HOST_SVC_CHECKS, 0, NULL),
 	CMD_DEF(DISABLE_HOST_SVC_CHECKS, 0, NULL),
 	CMD_DEF(SCHEDULE_HOST_SVC_CHECKS, 0, NULL),
-	CMD_DEF(DELAY_HOST_SVC_NOTIFICATIONS, 0, NULL),
+	CMD_DEF_CGI(DELAY_HOST_SVC_NOTIFICATIONS),
 	CMD_DEF(DEL_ALL_HOST_COMMENTS, 0, NULL),
 	CMD_DEF(DEL_ALL_SVC_COMMENTS, 0, NULL),
 	CMD_DEF(ENABLE_SVC_NOTIFICATIONS, 0, NULL),
@@ -112,14 +118,14 @@ struct nagios_extcmd in_core_commands[] = {
 	CMD_DEF(DISABLE_HOSTGROUP_HOST_NOTIFICATIONS, 0, NULL),
 	CMD_DEF(ENABLE_HOSTGROUP_SVC_CHECKS, 0, NULL),
 	CMD_DEF(DISABLE_HOSTGROUP_SVC_CHECKS, 0, NULL),
-	CMD_DEF(CANCEL_HOST_DOWNTIME, 0, NULL),
-	CMD_DEF(CANCEL_SVC_DOWNTIME, 0, NULL),
-	CMD_DEF(CANCEL_ACTIVE_HOST_DOWNTIME, 0, NULL),
-	CMD_DEF(CANCEL_PENDING_HOST_DOWNTIME, 0, NULL),
-	CMD_DEF(CANCEL_ACTIVE_SVC_DOWNTIME, 0, NULL),
-	CMD_DEF(CANCEL_PENDING_SVC_DOWNTIME, 0, NULL),
-	CMD_DEF(CANCEL_ACTIVE_HOST_SVC_DOWNTIME, 0, NULL),
-	CMD_DEF(CANCEL_PENDING_HOST_SVC_DOWNTIME, 0, NULL),
+	CMD_DEF_CGI(CANCEL_HOST_DOWNTIME),
+	CMD_DEF_CGI(CANCEL_SVC_DOWNTIME),
+	CMD_DEF_CGI(CANCEL_ACTIVE_HOST_DOWNTIME),
+	CMD_DEF_CGI(CANCEL_PENDING_HOST_DOWNTIME),
+	CMD_DEF_CGI(CANCEL_ACTIVE_SVC_DOWNTIME),
+	CMD_DEF_CGI(CANCEL_PENDING_SVC_DOWNTIME),
+	CMD_DEF_CGI(CANCEL_ACTIVE_HOST_SVC_DOWNTIME),
+	CMD_DEF_CGI(CANCEL_PENDING_HOST_SVC_DOWNTIME),
 	CMD_DEF(FLUSH_PENDING_COMMANDS, 0, NULL),
 	CMD_DEF(DEL_HOST_DOWNTIME, 0, NULL),
 	CMD_DEF(DEL_SVC_DOWNTIME, 0, NULL),
@@ -212,8 +218,20 @@ struct nagios_extcmd in_core_commands[] = {
 	CMD_DEF(CHANGE_CONTACT_MODATTR, 0, NULL),
 	CMD_DEF(CHANGE_CONTACT_MODHATTR, 0, NULL),
 	CMD_DEF(CHANGE_CONTACT_MODSATTR, 0, NULL),
+	CMD_DEF(SYNC_STATE_INFORMATION, 0, NULL),
+	CMD_DEF(DEL_DOWNTIME_BY_HOSTGROUP_NAME, 0, NULL),
+	CMD_DEF(DEL_DOWNTIME_BY_START_TIME_COMMENT, 0, NULL),
+	CMD_DEF(PROCESS_CHECK_RESULT_FILE, 0, NULL),
+
+	/* old names still accepted by the core, keep them behind the real ones for extcmd_get_name() */
+	CMD_ALIAS(ENTER_STANDBY_MODE, DISABLE_NOTIFICATIONS),
+	CMD_ALIAS(ENTER_ACTIVE_MODE, ENABLE_NOTIFICATIONS),
+	CMD_ALIAS(SHUTDOWN_PROGRAM, SHUTDOWN_PROCESS),
+	CMD_ALIAS(RESTART_PROGRAM, RESTART_PROCESS),
 };
 #undef CMD_DEF
+#undef CMD_DEF_CGI
+#undef CMD_ALIAS
 
 #ifndef ARRAY_SIZE
 # define ARRAY_SIZE(x) (sizeof(x) / sizeof(x[0]))
@@ -232,6 +250,43 @@ const char *extcmd_get_name(int id) {
 	return NULL;
 }
 
+/* the commands sorted by name, for binary searches */
+static struct nagios_extcmd *sorted_commands[ARRAY_SIZE(in_core_commands)];
+static int sorted_commands_ready = FALSE;
+
+static int compare_extcmd_names(const void *a, const void *b) {
+
+	return strcmp((*(struct nagios_extcmd **)a)->name, (*(struct nagios_extcmd **)b)->name);
+}
+
+/* returns the id of the external command with the given name, or CMD_NONE if the core doesn't know it */
+int extcmd_get_id(const char *name) {
+	struct nagios_extcmd key;
+	struct nagios_extcmd *keyp = &key;
+	struct nagios_extcmd **found = NULL;
+	int i;
+
+	if (name == NULL)
+		return CMD_NONE;
+
+	/* sort the list on first use */
+	if (sorted_commands_ready == FALSE) {
+		for (i = 0; i < ARRAY_SIZE(in_core_commands); i++)
+			sorted_commands[i] = &in_core_commands[i];
+		qsort(sorted_commands, ARRAY_SIZE(in_core_commands), sizeof(sorted_commands[0]), compare_extcmd_names);
+		sorted_commands_ready = TRUE;
+	}
+
+	key.name = name;
+	if ((found = (struct nagios_extcmd **)bsearch(&keyp, sorted_commands, ARRAY_SIZE(in_core_commands), sizeof(sorted_commands[0]), compare_extcmd_names)) == NULL)
+		return CMD_NONE;
+
+	if ((*found)->cgi_only == TRUE)
+		return CMD_NONE;
+
+	return (*found)->id;
+}
+
 #ifdef ECMD_LIST_TESTING
 int main(int argc, char **argv) {
 	int i, no_handler = 0;
@@ -0,0 +1,472 @@
+/*****************************************************************************
+ *
+ * LOGINDEX.C - Log archive index functions shared by the core and the CGIs
+ *
+ * Copyright (c) 2009-2013 Icinga Development Team (http://www.icinga.org)
+ *
+ * License:
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *****************************************************************************/
+
+#include "../include/config.h"
+#include "../include/common.h"
+#include "../include/logindex.h"
+
+#include <sys/mman.h>
+
+
+/******************************************************************/
+/********************* LOG ENTRY CLASSIFICATION *******************/
+/******************************************************************/
+
+/* categorizes the text of a log entry */
+int get_log_entry_type(char *text) {
+
+	if (strstr(text, " 开始..."))
+		return LOGENTRY_STARTUP;
+	else if (strstr(text, " 关闭..."))
+		return LOGENTRY_SHUTDOWN;
+	else if (strstr(text, "救助"))
+		return LOGENTRY_BAILOUT;
+	else if (strstr(text, " 重启..."))
+		return LOGENTRY_RESTART;
+	else if (strstr(text, "主机警告:") && strstr(text, ";宕机;"))
+		return LOGENTRY_HOST_DOWN;
+	else if (strstr(text, "主机警告:") && strstr(text, ";不可达;"))
+		return LOGENTRY_HOST_UNREACHABLE;
+	else if (strstr(text, "主机警告:") && strstr(text, ";恢复;"))
+		return LOGENTRY_HOST_RECOVERY;
+	else if (strstr(text, "主机警告:") && strstr(text, ";运行;"))
+		return LOGENTRY_HOST_UP;
+	else if (strstr(text, "主机通知:"))
+		return LOGENTRY_HOST_NOTIFICATION;
+	else if (strstr(text, "服务警告:") && strstr(text, ";严重;"))
+		return LOGENTRY_SERVICE_CRITICAL;
+	else if (strstr(text, "服务警告:") && strstr(text, ";警报;"))
+		return LOGENTRY_SERVICE_WARNING;
+	else if (strstr(text, "服务警告:") && strstr(text, ";未知;"))
+		return LOGENTRY_SERVICE_UNKNOWN;
+	else if (strstr(text, "服务警告:") && strstr(text, ";恢复;"))
+		return LOGENTRY_SERVICE_RECOVERY;
+	else if (strstr(text, "服务警告:") && strstr(text, ";正常;"))
+		return LOGENTRY_SERVICE_OK;
+	else if (strstr(text, "服务通知:"))
+		return LOGENTRY_SERVICE_NOTIFICATION;
+	else if (strstr(text, "服务事件处理:"))
+		return LOGENTRY_SERVICE_EVENT_HANDLER;
+	else if (strstr(text, "主机事件处理:"))
+		return LOGENTRY_HOST_EVENT_HANDLER;
+	else if (strstr(text, "额外命令:"))
+		return LOGENTRY_EXTERNAL_COMMAND;
+	else if (strstr(text, "被动服务检查:"))
+		return LOGENTRY_PASSIVE_SERVICE_CHECK;
+	else if (strstr(text, "被动主机检查:"))
+		return LOGENTRY_PASSIVE_HOST_CHECK;
+	else if (strstr(text, "日志回滚:"))
+		return LOGENTRY_LOG_ROTATION;
+	else if (strstr(text, "主动模式..."))
+		return LOGENTRY_ACTIVE_MODE;
+	else if (strstr(text, "待机模式..."))
+		return LOGENTRY_STANDBY_MODE;
+	else if (strstr(text, "服务抖动警告:") && strstr(text, ";开始;"))
+		return LOGENTRY_SERVICE_FLAPPING_STARTED;
+	else if (strstr(text, "服务抖动警告:") && strstr(text, ";停止;"))
+		return LOGENTRY_SERVICE_FLAPPING_STOPPED;
+	else if (strstr(text, "服务抖动警告:") && strstr(text, ";禁止;"))
+		return LOGENTRY_SERVICE_FLAPPING_DISABLED;
+	else if (strstr(text, "主机抖动警告:") && strstr(text, ";开始;"))
+		return LOGENTRY_HOST_FLAPPING_STARTED;
+	else if (strstr(text, "主机抖动警告:") && strstr(text, ";停止;"))
+		return LOGENTRY_HOST_FLAPPING_STOPPED;
+	else if (strstr(text, "主机抖动警告:") && strstr(text, ";禁止;"))
+		return LOGENTRY_HOST_FLAPPING_DISABLED;
+	else if (strstr(text, "服务宕机警告:") && strstr(text, ";开始;"))
+		return LOGENTRY_SERVICE_DOWNTIME_STARTED;
+	else if (strstr(text, "服务宕机警告:") && strstr(text, ";停止;"))
+		return LOGENTRY_SERVICE_DOWNTIME_STOPPED;
+	else if (strstr(text, "服务宕机警告:") && strstr(text, ";取消;"))
+		return LOGENTRY_SERVICE_DOWNTIME_CANCELLED;
+	else if (strstr(text, "主机宕机警告:") && strstr(text, ";开始;"))
+		return LOGENTRY_HOST_DOWNTIME_STARTED;
+	else if (strstr(text, "主机宕机警告:") && strstr(text, ";停止;"))
+		return LOGENTRY_HOST_DOWNTIME_STOPPED;
+	else if (strstr(text, "主机宕机警告:") && strstr(text, ";取消;"))
+		return LOGENTRY_HOST_DOWNTIME_CANCELLED;
+	else if (strstr(text, "初始服务状态:"))
+		return LOGENTRY_SERVICE_INITIAL_STATE;
+	else if (strstr(text, "初始主机状态:"))
+		return LOGENTRY_HOST_INITIAL_STATE;
+	else if (strstr(text, "当前服务状态:"))
+		return LOGENTRY_SERVICE_CURRENT_STATE;
+	else if (strstr(text, "当前主机状态:"))
+		return LOGENTRY_HOST_CURRENT_STATE;
+	else if (strstr(text, "错误的执行命令"))
+		return LOGENTRY_ERROR_COMMAND_EXECUTION;
+	else if (strstr(text, "idomod:"))
+		return LOGENTRY_IDOMOD;
+	else if (strstr(text, "npcdmod:"))
+		return LOGENTRY_NPCDMOD;
+	else if (strstr(text, "自动保存"))
+		return LOGENTRY_AUTOSAVE;
+	else if (strstr(text, "警报:"))
+		return LOGENTRY_SYSTEM_WARNING;
+
+	return LOGENTRY_UNDEFINED;
+}
+
+
+/* hashes a host name or service description, never returns 0 */
+unsigned int get_log_object_hash(const char *name, int len) {
+	unsigned int hash = 0;
+	int x;
+
+	/* same as sdbm(), but limited to len bytes */
+	for (x = 0; x < len && name[x] != '\x0'; x++)
+		hash = name[x] + (hash << 6) + (hash << 16) - hash;
+
+	return (hash == 0) ? 1 : hash;
+}
+
+
+/* returns the hashes of the host and service a log entry belongs to (0 if unknown) */
+void get_log_entry_object_hashes(int type, char *text, unsigned int *host_hash, unsigned int *service_hash) {
+	const char *prefix = NULL;
+	char *ptr = NULL;
+	char *end = NULL;
+	int skip_fields = 0;
+	int is_service = FALSE;
+
+	*host_hash = 0;
+	*service_hash = 0;
+
+	switch (type) {
+	case LOGENTRY_HOST_DOWN:
+	case LOGENTRY_HOST_UNREACHABLE:
+	case LOGENTRY_HOST_RECOVERY:
+	case LOGENTRY_HOST_UP:
+		prefix = "主机警告: ";
+		break;
+	case LOGENTRY_HOST_NOTIFICATION:
+		prefix = "主机通知: ";
+		skip_fields = 1;
+		break;
+	case LOGENTRY_HOST_EVENT_HANDLER:
+		prefix = "主机事件处理: ";
+		break;
+	case LOGENTRY_HOST_FLAPPING_STARTED:
+	case LOGENTRY_HOST_FLAPPING_STOPPED:
+	case LOGENTRY_HOST_FLAPPING_DISABLED:
+		prefix = "主机抖动警告: ";
+		break;
+	case LOGENTRY_HOST_DOWNTIME_STARTED:
+	case LOGENTRY_HOST_DOWNTIME_STOPPED:
+	case LOGENTRY_HOST_DOWNTIME_CANCELLED:
+		prefix = "主机宕机警告: ";
+		break;
+	case LOGENTRY_HOST_INITIAL_STATE:
+		prefix = "初始主机状态: ";
+		break;
+	case LOGENTRY_HOST_CURRENT_STATE:
+		prefix = "当前主机状态: ";
+		break;
+	case LOGENTRY_PASSIVE_HOST_CHECK:
+		prefix = "被动主机检查: ";
+		break;
+	case LOGENTRY_SERVICE_CRITICAL:
+	case LOGENTRY_SERVICE_WARNING:
+	case LOGENTRY_SERVICE_UNKNOWN:
+	case LOGENTRY_SERVICE_RECOVERY:
+	case LOGENTRY_SERVICE_OK:
+		prefix = "服务警告: ";
+		is_service = TRUE;
+		break;
+	case LOGENTRY_SERVICE_NOTIFICATION:
+		prefix = "服务通知: ";
+		skip_fields = 1;
+		is_service = TRUE;
+		break;
+	case LOGENTRY_SERVICE_EVENT_HANDLER:
+		prefix = "服务事件处理: ";
+		is_service = TRUE;
+		break;
+	case LOGENTRY_SERVICE_FLAPPING_STARTED:
+	case LOGENTRY_SERVICE_FLAPPING_STOPPED:
+	case LOGENTRY_SERVICE_FLAPPING_DISABLED:
+		prefix = "服务抖动警告: ";
+		is_service = TRUE;
+		break;
+	case LOGENTRY_SERVICE_DOWNTIME_STARTED:
+	case LOGENTRY_SERVICE_DOWNTIME_STOPPED:
+	case LOGENTRY_SERVICE_DOWNTIME_CANCELLED:
+		prefix = "服务宕机警告: ";
+		is_service = TRUE;
+		break;
+	case LOGENTRY_SERVICE_INITIAL_STATE:
+		prefix = "初始服务状态: ";
+		is_service = TRUE;
+		break;
+	case LOGENTRY_SERVICE_CURRENT_STATE:
+		prefix = "当前服务状态: ";
+		is_service = TRUE;
+		break;
+	case LOGENTRY_PASSIVE_SERVICE_CHECK:
+		prefix = "被动服务检查: ";
+		is_service = TRUE;
+		break;
+	default:
+		return;
+	}
+
+	/* the type was found somewhere in the text, only trust entries that start with it */
+	for (ptr = text; *ptr == ' '; ptr++);
+	if (strncmp(ptr, prefix, strlen(prefix)))
+		return;
+	ptr += strlen(prefix);
+
+	/* notifications start with the contact name */
+	for (; skip_fields > 0; skip_fields--) {
+		if ((ptr = strchr(ptr, ';')) == NULL)
+			return;
+		ptr++;
+	}
+
+	if ((end = strchr(ptr, ';')) == NULL)
+		return;
+	*host_hash = get_log_object_hash(ptr, (int)(end - ptr));
+
+	if (is_service == FALSE)
+		return;
+
+	ptr = end + 1;
+	if ((end = strchr(ptr, ';')) == NULL)
+		return;
+	*service_hash = get_log_object_hash(ptr, (int)(end - ptr));
+
+	return;
+}
+
+
+/******************************************************************/
+/************************ INDEX FUNCTIONS *************************/
+/******************************************************************/
+
+/* writes the index for a log archive to index_file, or next to the archive if index_file is NULL */
+int write_log_index(char *archive, char *index_file) {
+	char *temp_index = NULL;
+	char *index_name = NULL;
+	char *input = NULL;
+	char *temp_buffer = NULL;
+	char *text = NULL;
+	mmapfile *thefile = NULL;
+	logindex_header header;
+	logindex_entry *entries = NULL;
+	logindex_entry *new_entries = NULL;
+	unsigned long entries_allocated = 0L;
+	unsigned long offset = 0L;
+	struct stat statbuf;
+	FILE *fp = NULL;
+	int result = OK;
+
+	if (archive == NULL || stat(archive, &statbuf) == -1)
+		return ERROR;
+
+	if ((thefile = mmap_fopen(archive)) == NULL)
+		return ERROR;
+
+	memset(&header, 0, sizeof(header));
+	strncpy(header.magic, LOGINDEX_MAGIC, sizeof(header.magic));
+	header.version = LOGINDEX_VERSION;
+	header.entry_size = sizeof(logindex_entry);
+	header.log_size = thefile->file_size;
+	header.log_mtime = (unsigned long)statbuf.st_mtime;
+	header.flags = LOGINDEX_SORTED;
+
+	while (1) {
+
+		my_free(input);
+
+		offset = thefile->current_position;
+		if ((input = mmap_fgets(thefile)) == NULL)
+			break;
+
+		/* parse the line the same way get_log_entries() does */
+		strip(input);
+
+		for (temp_buffer = input; *temp_buffer == ']'; temp_buffer++);
+		if (*temp_buffer == '\x0')
+			continue;
+
+		if ((text = strchr(temp_buffer, ']')) == NULL || *(text + 1) == '\x0')
+			continue;
+		*text++ = '\x0';
+
+		if (header.entry_count == entries_allocated) {
+			entries_allocated = (entries_allocated == 0L) ? 1024 : entries_allocated * 2;
+			if ((new_entries = (logindex_entry *)realloc(entries, entries_allocated * sizeof(logindex_entry))) == NULL) {
+				result = ERROR;
+				break;
+			}
+			entries = new_entries;
+		}
+
+		new_entries = &entries[header.entry_count];
+		new_entries->timestamp = strtoul(temp_buffer + 1, NULL, 10);
+		new_entries->offset = offset;
+		new_entries->length = (unsigned int)(thefile->current_position - offset);
+		new_entries->type = get_log_entry_type(text);
+		get_log_entry_object_hashes(new_entries->type, text, &new_entries->host_hash, &new_entries->service_hash);
+
+		if (header.entry_count == 0L)
+			header.first_timestamp = new_entries->timestamp;
+		else if (new_entries->timestamp < header.last_timestamp)
+			header.flags &= ~LOGINDEX_SORTED;
+		header.last_timestamp = new_entries->timestamp;
+
+		header.entry_count++;
+	}
+
+	my_free(input);
+	mmap_fclose(thefile);
+
+	if (result == ERROR) {
+		my_free(entries);
+		return ERROR;
+	}
+
+	if (index_file == NULL)
+		result = asprintf(&index_name, "%s%s", archive, LOGINDEX_SUFFIX);
+	else
+		index_name = strdup(index_file);
+
+	/* write a temp file first, the CGIs must never see half an index */
+	if (result == -1 || index_name == NULL || asprintf(&temp_index, "%s.%d.tmp", index_name, (int)getpid()) == -1) {
+		my_free(index_name);
+		my_free(entries);
+		return ERROR;
+	}
+	result = OK;
+
+	if ((fp = fopen(temp_index, "w")) == NULL)
+		result = ERROR;
+	else {
+		if (fwrite(&header, sizeof(header), 1, fp) != 1)
+			result = ERROR;
+		else if (header.entry_count > 0L && fwrite(entries, sizeof(logindex_entry), header.entry_count, fp) != header.entry_count)
+			result = ERROR;
+		if (fclose(fp) != 0)
+			result = ERROR;
+	}
+
+	if (result == OK && rename(temp_index, index_name) != 0)
+		result = ERROR;
+	if (result == ERROR)
+		unlink(temp_index);
+
+	my_free(index_name);
+	my_free(temp_index);
+	my_free(entries);
+
+	return result;
+}
+
+
+/* maps the index of a log archive from index_file, or from next to the archive if index_file is NULL */
+/* returns NULL if there is none or it doesn't belong to the archive */
+logindex *open_log_index(char *archive, char *index_file) {
+	char *temp_buffer = NULL;
+	logindex *new_index = NULL;
+	logindex_header *header = NULL;
+	struct stat statbuf;
+	struct stat log_statbuf;
+	void *buf = NULL;
+	int fd = -1;
+
+	if (archive == NULL || stat(archive, &log_statbuf) == -1)
+		return NULL;
+
+	if (index_file == NULL) {
+		if (asprintf(&temp_buffer, "%s%s", archive, LOGINDEX_SUFFIX) == -1)
+			return NULL;
+		fd = open(temp_buffer, O_RDONLY);
+		my_free(temp_buffer);
+	} else
+		fd = open(index_file, O_RDONLY);
+	if (fd == -1)
+		return NULL;
+
+	if (fstat(fd, &statbuf) == -1 || statbuf.st_size < (off_t)sizeof(logindex_header)) {
+		close(fd);
+		return NULL;
+	}
+
+	buf = mmap(0, statbuf.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (buf == MAP_FAILED)
+		return NULL;
+
+	/* the archive must not have changed since the index was written */
+	header = (logindex_header *)buf;
+	if (strncmp(header->magic, LOGINDEX_MAGIC, sizeof(header->magic)) || header->version != LOGINDEX_VERSION || header->entry_size != sizeof(logindex_entry) || header->log_size != (unsigned long)log_statbuf.st_size || header->log_mtime != (unsigned long)log_statbuf.st_mtime || (unsigned long)statbuf.st_size != sizeof(logindex_header) + header->entry_count * sizeof(logindex_entry)) {
+		munmap(buf, statbuf.st_size);
+		return NULL;
+	}
+
+	if ((new_index = (logindex *)malloc(sizeof(logindex))) == NULL) {
+		munmap(buf, statbuf.st_size);
+		return NULL;
+	}
+
+	new_index->header = header;
+	new_index->entries = (logindex_entry *)((char *)buf + sizeof(logindex_header));
+	new_index->size = statbuf.st_size;
+
+	return new_index;
+}
+
+
+/* returns the first entry that is not older than timestamp */
+unsigned long find_log_index_entry(logindex *log_index, time_t timestamp) {
+	unsigned long low = 0L;
+	unsigned long high = 0L;
+	unsigned long middle = 0L;
+
+	if (log_index == NULL || !(log_index->header->flags & LOGINDEX_SORTED) || timestamp <= 0)
+		return 0L;
+
+	high = log_index->header->entry_count;
+	while (low < high) {
+		middle = low + (high - low) / 2;
+		if (log_index->entries[middle].timestamp < (unsigned long)timestamp)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	return low;
+}
+
+
+/* unmaps an index */
+void close_log_index(logindex *log_index) {
+
+	if (log_index == NULL)
+		return;
+
+	munmap((void *)log_index->header, log_index->size);
+	my_free(log_index);
+
+	return;
+}
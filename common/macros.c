@@ -38,6 +38,7 @@
 #ifdef NSCORE
 extern int      use_large_installation_tweaks;
 extern int      enable_environment_macros;
+extern int      lazy_environment_macros;
 extern int	keep_unknown_macros;
 #endif
 
@@ -122,24 +123,180 @@ const struct macro_key_code *find_macro_key(const char *name) {
 }
 
 
+/* appends text to the output of macro processing, growing it as needed */
+static void add_macro_output(char **buf, size_t *length, size_t *size, const char *text, size_t text_length) {
+	char *new_buf = NULL;
+	size_t new_size = 0;
+
+	if (*buf == NULL)
+		return;
+
+	if (*length + text_length + 1 > *size) {
+		for (new_size = *size * 2; new_size < *length + text_length + 1; new_size *= 2);
+		if ((new_buf = (char *)realloc(*buf, new_size)) == NULL)
+			return;
+		*buf = new_buf;
+		*size = new_size;
+	}
+
+	memcpy(*buf + *length, text, text_length);
+	*length += text_length;
+	(*buf)[*length] = '\x0';
+}
+
+
+/* gets the value of a precompiled macro token - the same lookups grab_macro_value_r() does, minus the parsing */
+static int grab_macro_token_value_r(icinga_macros *mac, macro_token *token, char **output, int *clean_options, int *free_macro) {
+
+	*free_macro = FALSE;
+
+	switch (token->type) {
+
+	case MACRO_TOKEN_ARGV:
+		*output = mac->argv[token->index];
+		return OK;
+
+	case MACRO_TOKEN_USER:
+		*output = macro_user[token->index];
+		return OK;
+
+	case MACRO_TOKEN_X:
+		/* same shortcut grab_macro_value_r() takes */
+		if (mac->host_ptr && token->index == MACRO_HOSTADDRESS) {
+			*output = mac->host_ptr->address;
+			return OK;
+		}
+		if (mac->host_ptr && token->index == MACRO_HOSTADDRESS6) {
+			*output = mac->host_ptr->address6;
+			return OK;
+		}
+		*free_macro = TRUE;
+		*clean_options |= token->clean_options;
+		return grab_macrox_value_r(mac, token->index, NULL, NULL, output, free_macro);
+
+	case MACRO_TOKEN_CUSTOM:
+		*free_macro = TRUE;
+		return grab_custom_macro_value_r(mac, token->text, NULL, NULL, output);
+
+	default:
+		return grab_macro_value_r(mac, token->text, output, clean_options, free_macro);
+	}
+}
+
+
+/* looks up a single macro and appends its (cleaned) value to the output */
+static void add_macro_value_r(icinga_macros *mac, macro_token *token, char *macro_name, int terminated, int options, char **buf, size_t *length, size_t *size) {
+	char *selected_macro = NULL;
+	char *original_macro = NULL;
+	char *cleaned_macro = NULL;
+	int clean_options = 0;
+	int free_macro = FALSE;
+	int macro_options = 0;
+	int result = OK;
+
+	/* grab the macro value */
+	if (token != NULL)
+		result = grab_macro_token_value_r(mac, token, &selected_macro, &clean_options, &free_macro);
+	else
+		result = grab_macro_value_r(mac, macro_name, &selected_macro, &clean_options, &free_macro);
+	log_debug_info(DEBUGL_MACROS, 2, "  处理 '%s', 清除选项: %d, 空闲: %d\n, 值: '%s'", macro_name, clean_options, free_macro, selected_macro ? selected_macro : "");
+
+	/* an error occurred - we couldn't parse the macro, so continue on */
+	if (result == ERROR) {
+		/* empty string still could mean that we hit the escaped $, so log an error in all other cases */
+		/* the error tells the user that the macro is valid, but value fetching contained error*/
+		if (strcmp(macro_name, "")) {
+			log_debug_info(DEBUGL_MACROS, 2, "警报: 错误攫取宏 '%s' 值 '%s'! 可能使用在错误的范围? 检查文档.\n", macro_name, selected_macro ? selected_macro : "");
+#ifdef NSCORE
+			if (keep_unknown_macros == FALSE) {
+				logit(NSLOG_RUNTIME_WARNING, TRUE, "警报: 错误攫取宏 '%s' 值 '%s'! 可能使用在错误的范围? 检查文档.\n", macro_name, selected_macro ? selected_macro : "");
+			}
+#endif
+		}
+
+		if (free_macro == TRUE)
+			my_free(selected_macro);
+	}
+
+	/* we already have a macro... */
+	if (result == OK)
+		; /* do nothing special if things worked out ok */
+
+	/* an escaped $ is done by specifying two $$ next to each other */
+	else if (!strcmp(macro_name, "")) {
+		add_macro_output(buf, length, size, "$", 1);
+	}
+
+	/* a non-macro, just some user-defined string between two $s */
+	else {
+
+#ifdef NSCORE
+		if (keep_unknown_macros == TRUE) {
+#endif
+			/* add the plain text to the end of the already processed buffer */
+			add_macro_output(buf, length, size, "$", 1);
+			add_macro_output(buf, length, size, macro_name, strlen(macro_name));
+			if (terminated == TRUE)
+				add_macro_output(buf, length, size, "$", 1);
+#ifdef NSCORE
+		} else {
+			/* do not process unknown macros */
+			logit(NSLOG_RUNTIME_WARNING, TRUE, "警报: 跳过未知宏 '$%s$', 从输出中移除它! 修复你的配置, 或相应设置keep_unknown_macros...\n", macro_name);
+		}
+#endif
+	}
+
+	/* insert macro */
+	if (selected_macro != NULL) {
+
+		/* include any cleaning options passed back to us */
+		macro_options = (options | clean_options);
+
+		log_debug_info(DEBUGL_MACROS, 2, "   清除选项: 全局=%d, 本地=%d, 有效=%d\n", options, clean_options, macro_options);
+
+		/* URL encode the macro if requested - this allocates new memory */
+		if (macro_options & URL_ENCODE_MACRO_CHARS) {
+			original_macro = selected_macro;
+			selected_macro = get_url_encoded_string(selected_macro);
+			if (free_macro == TRUE) {
+				my_free(original_macro);
+			}
+			free_macro = TRUE;
+		}
+
+		/* some macros are cleaned... */
+		if ((macro_options & STRIP_ILLEGAL_MACRO_CHARS) || (macro_options & ESCAPE_MACRO_CHARS)) {
+
+			/* add the (cleaned) processed macro to the end of the already processed buffer */
+			if (selected_macro != NULL && (cleaned_macro = clean_macro_chars(selected_macro, macro_options)) != NULL)
+				add_macro_output(buf, length, size, cleaned_macro, strlen(cleaned_macro));
+		}
+
+		/* others are not cleaned */
+		else if (selected_macro != NULL)
+			add_macro_output(buf, length, size, selected_macro, strlen(selected_macro));
+
+		/* free memory if necessary (if we URL encoded the macro or we were told to do so by grab_macro_value()) */
+		if (free_macro == TRUE)
+			my_free(selected_macro);
+	}
+
+	log_debug_info(DEBUGL_MACROS, 2, "  刚刚完成宏.  运行输出 (%lu): '%s'\n", (unsigned long)*length, (*buf == NULL) ? "" : *buf);
+}
+
+
 /**
  * replace macros in notification commands with their values,
  * the thread-safe version
  */
 int process_macros_r(icinga_macros *mac, char *input_buffer, char **output_buffer, int options) {
-	char *temp_buffer = NULL;
 	char *save_buffer = NULL;
 	char *buf_ptr = NULL;
 	char *delim_ptr = NULL;
+	char *temp_buffer = NULL;
+	size_t length = 0;
+	size_t size = 0;
 	int in_macro = FALSE;
-	char *selected_macro = NULL;
-	char *original_macro = NULL;
-	char *cleaned_macro = NULL;
-	int clean_macro = FALSE;
-	int result = OK;
-	int clean_options = 0;
-	int free_macro = FALSE;
-	int macro_options = 0;
 
 
 	log_debug_info(DEBUGL_FUNCTIONS, 0, "process_macros_r()\n");
@@ -147,18 +304,21 @@ int process_macros_r(icinga_macros *mac, char *input_buffer, char **output_buffe
 	if (output_buffer == NULL)
 		return ERROR;
 
-	*output_buffer = (char *)strdup("");
-
-	if (input_buffer == NULL)
+	if (input_buffer == NULL) {
+		*output_buffer = (char *)strdup("");
 		return ERROR;
-
-	in_macro = FALSE;
+	}
 
 	log_debug_info(DEBUGL_MACROS, 1, "**** BEGIN MACRO PROCESSING ***********\n");
 	log_debug_info(DEBUGL_MACROS, 1, "处理: '%s'\n", input_buffer);
 
+	/* the output is built in a single buffer that grows as needed */
+	size = strlen(input_buffer) + 64;
+	if ((*output_buffer = (char *)malloc(size)) != NULL)
+		(*output_buffer)[0] = '\x0';
+
 	/* save original input_buffer ptr for later free'ing */
-	save_buffer = buf_ptr = (input_buffer ? strdup(input_buffer) : NULL);
+	save_buffer = buf_ptr = (char *)strdup(input_buffer);
 
 	while (buf_ptr) {
 
@@ -176,146 +336,210 @@ int process_macros_r(icinga_macros *mac, char *input_buffer, char **output_buffe
 
 		log_debug_info(DEBUGL_MACROS, 2, "  处理部分: '%s'\n", temp_buffer);
 
-		selected_macro = NULL;
-		clean_macro = FALSE;
-
 		/* we're in plain text... */
 		if (in_macro == FALSE) {
 
 			/* add the plain text to the end of the already processed buffer */
-			*output_buffer = (char *)realloc(*output_buffer, strlen(*output_buffer) + strlen(temp_buffer) + 1);
-			strcat(*output_buffer, temp_buffer);
-
-			log_debug_info(DEBUGL_MACROS, 2, "没有当前宏.  运行输出 (%lu): '%s'\n", (unsigned long)strlen(*output_buffer), *output_buffer);
-
+			add_macro_output(output_buffer, &length, &size, temp_buffer, (delim_ptr != NULL) ? (size_t)(delim_ptr - temp_buffer) : strlen(temp_buffer));
 			in_macro = TRUE;
 		}
 
 		/* looks like we're in a macro, so process it... */
 		else {
+			add_macro_value_r(mac, NULL, temp_buffer, (buf_ptr != NULL) ? TRUE : FALSE, options, output_buffer, &length, &size);
+			in_macro = FALSE;
+		}
+	}
 
-			/* reset clean options */
-			clean_options = 0;
+	/* free copy of input buffer */
+	my_free(save_buffer);
 
-			/* grab the macro value */
-			result = grab_macro_value_r(mac, temp_buffer, &selected_macro, &clean_options, &free_macro);
-			log_debug_info(DEBUGL_MACROS, 2, "  处理 '%s', 清除选项: %d, 空闲: %d\n, 值: '%s'", temp_buffer, clean_options, free_macro, selected_macro ? selected_macro : "");
+	log_debug_info(DEBUGL_MACROS, 1, "  完成.  最终输出: '%s'\n", (*output_buffer == NULL) ? "" : *output_buffer);
+	log_debug_info(DEBUGL_MACROS, 1, "**** 结束宏处理 *************\n");
 
-			/* an error occurred - we couldn't parse the macro, so continue on */
-			if (result == ERROR) {
-				/* empty string still could mean that we hit the escaped $, so log an error in all other cases */
-				/* the error tells the user that the macro is valid, but value fetching contained error*/
-				if(strcmp(temp_buffer, "")) {
-					log_debug_info(DEBUGL_MACROS, 2, "警报: 错误攫取宏 '%s' 值 '%s'! 可能使用在错误的范围? 检查文档.\n", temp_buffer, selected_macro ? selected_macro : "" );
-#ifdef NSCORE
-					if (keep_unknown_macros == FALSE) {
-						logit(NSLOG_RUNTIME_WARNING, TRUE, "警报: 错误攫取宏 '%s' 值 '%s'! 可能使用在错误的范围? 检查文档.\n", temp_buffer, selected_macro ? selected_macro : "" );
-					}
-#endif
-				}
+	return OK;
+}
 
-				if (free_macro == TRUE)
-					my_free(selected_macro);
-			}
 
-			/* we already have a macro... */
-			if (result == OK)
-				; /* do nothing special if things worked out ok */
+/* replaces the macros in a string that was split into tokens by compile_macro_tokens() */
+int process_macro_tokens_r(icinga_macros *mac, macro_token *tokens, char **output_buffer, int options) {
+	macro_token *token = NULL;
+	size_t length = 0;
+	size_t size = 64;
 
-			/* an escaped $ is done by specifying two $$ next to each other */
-			else if (!strcmp(temp_buffer, "")) {
+	log_debug_info(DEBUGL_FUNCTIONS, 0, "process_macro_tokens_r()\n");
 
-				log_debug_info(DEBUGL_MACROS, 2, "  Escaped $.  运行输出 (%lu): '%s'\n", (unsigned long)strlen(*output_buffer), *output_buffer);
+	if (output_buffer == NULL)
+		return ERROR;
 
-				*output_buffer = (char *)realloc(*output_buffer, strlen(*output_buffer) + 2);
-				strcat(*output_buffer, "$");
-			}
+	for (token = tokens; token != NULL; token = token->next)
+		size += token->length;
+	if ((*output_buffer = (char *)malloc(size)) != NULL)
+		(*output_buffer)[0] = '\x0';
 
-			/* a non-macro, just some user-defined string between two $s */
-			else {
+	for (token = tokens; token != NULL; token = token->next) {
+		if (token->type == MACRO_TOKEN_TEXT)
+			add_macro_output(output_buffer, &length, &size, token->text, token->length);
+		else
+			add_macro_value_r(mac, token, token->text, token->terminated, options, output_buffer, &length, &size);
+	}
 
-				log_debug_info(DEBUGL_MACROS, 2, " 非宏.   运行输出 (%lu): '%s'\n", (unsigned long)strlen(*output_buffer), *output_buffer);
+	log_debug_info(DEBUGL_MACROS, 1, "  完成.  最终输出: '%s'\n", (*output_buffer == NULL) ? "" : *output_buffer);
+
+	return OK;
+}
+
+
+/* replaces the macros in the command line of a command, which is only split into tokens once */
+int process_command_macros_r(icinga_macros *mac, command *cmd_ptr, char **output_buffer, int options) {
+
+	if (output_buffer == NULL)
+		return ERROR;
+
+	if (cmd_ptr == NULL || cmd_ptr->command_line == NULL) {
+		*output_buffer = (char *)strdup("");
+		return ERROR;
+	}
 
 #ifdef NSCORE
-				if (keep_unknown_macros == TRUE) {
-#endif
-					/* add the plain text to the end of the already processed buffer */
-					*output_buffer = (char *)realloc(*output_buffer, strlen(*output_buffer) + strlen(temp_buffer) + 3);
-					strcat(*output_buffer, "$");
-					strcat(*output_buffer, temp_buffer);
-					if (buf_ptr != NULL)
-						strcat(*output_buffer, "$");
-#ifdef NSCORE
-				} else {
-					/* do not process unknown macros */
-					logit(NSLOG_RUNTIME_WARNING, TRUE, "警报: 跳过未知宏 '$%s$', 从输出中移除它! 修复你的配置, 或相应设置keep_unknown_macros...\n", temp_buffer);
-				}
+	if (cmd_ptr->macro_tokens == NULL)
+		cmd_ptr->macro_tokens = compile_macro_tokens(cmd_ptr->command_line);
+
+	/* remember which macros the command uses for the environment */
+	mac->command_tokens = cmd_ptr->macro_tokens;
+
+	if (cmd_ptr->macro_tokens != NULL)
+		return process_macro_tokens_r(mac, cmd_ptr->macro_tokens, output_buffer, options);
 #endif
-			}
 
-			/* insert macro */
-			if (selected_macro != NULL) {
+	return process_macros_r(mac, cmd_ptr->command_line, output_buffer, options);
+}
 
-				log_debug_info(DEBUGL_MACROS, 2, "  处理 '%s', 清除选项: %d, 空闲: %d\n", temp_buffer, clean_options, free_macro);
 
-				/* include any cleaning options passed back to us */
-				macro_options = (options | clean_options);
+/* adds a token to the end of a token list, text tokens are merged */
+static int add_macro_token(macro_token **tokens, macro_token **last_token, int type, char *text, int length, int terminated) {
+	macro_token *new_token = NULL;
+	char *new_text = NULL;
+	const struct macro_key_code *mkey = NULL;
+	int x = 0;
 
-				log_debug_info(DEBUGL_MACROS, 2, "   清除选项: 全局=%d, 本地=%d, 有效=%d\n", options, clean_options, macro_options);
+	/* consecutive text is kept in a single token */
+	if (type == MACRO_TOKEN_TEXT && *last_token != NULL && (*last_token)->type == MACRO_TOKEN_TEXT) {
+		if ((new_text = (char *)realloc((*last_token)->text, (*last_token)->length + length + 1)) == NULL)
+			return ERROR;
+		memcpy(new_text + (*last_token)->length, text, length);
+		(*last_token)->length += length;
+		new_text[(*last_token)->length] = '\x0';
+		(*last_token)->text = new_text;
+		return OK;
+	}
 
-				/* URL encode the macro if requested - this allocates new memory */
-				if (macro_options & URL_ENCODE_MACRO_CHARS) {
-					original_macro = selected_macro;
-					selected_macro = get_url_encoded_string(selected_macro);
-					if (free_macro == TRUE) {
-						my_free(original_macro);
-					}
-					free_macro = TRUE;
-				}
+	if ((new_token = (macro_token *)calloc(1, sizeof(macro_token))) == NULL)
+		return ERROR;
+	if ((new_token->text = (char *)malloc(length + 1)) == NULL) {
+		my_free(new_token);
+		return ERROR;
+	}
+	memcpy(new_token->text, text, length);
+	new_token->text[length] = '\x0';
+	new_token->length = length;
+	new_token->type = type;
+	new_token->terminated = terminated;
+
+	/* resolve what grab_macro_value_r() would otherwise have to look up for every check */
+	if (type == MACRO_TOKEN_MACRO) {
+
+		if (strstr(new_token->text, "ARG") == new_token->text) {
+			x = atoi(new_token->text + 3);
+			if (x > 0 && x <= MAX_COMMAND_ARGUMENTS) {
+				new_token->type = MACRO_TOKEN_ARGV;
+				new_token->index = x - 1;
+			}
+		} else if (strstr(new_token->text, "USER") == new_token->text) {
+			x = atoi(new_token->text + 4);
+			if (x > 0 && x <= MAX_USER_MACROS) {
+				new_token->type = MACRO_TOKEN_USER;
+				new_token->index = x - 1;
+			}
+		} else if (strchr(new_token->text, ':') == NULL) {
+			if ((mkey = find_macro_key(new_token->text)) != NULL) {
+				new_token->type = MACRO_TOKEN_X;
+				new_token->index = mkey->code;
+				new_token->clean_options = mkey->clean_options;
+			} else if (new_token->text[0] == '_')
+				new_token->type = MACRO_TOKEN_CUSTOM;
+		}
+	}
 
-				/* some macros are cleaned... */
-				if (clean_macro == TRUE || ((macro_options & STRIP_ILLEGAL_MACRO_CHARS) || (macro_options & ESCAPE_MACRO_CHARS))) {
+	if (*last_token == NULL)
+		*tokens = new_token;
+	else
+		(*last_token)->next = new_token;
+	*last_token = new_token;
 
-					/* add the (cleaned) processed macro to the end of the already processed buffer */
-					if (selected_macro != NULL && (cleaned_macro = clean_macro_chars(selected_macro, macro_options)) != NULL) {
-						*output_buffer = (char *)realloc(*output_buffer, strlen(*output_buffer) + strlen(cleaned_macro) + 1);
-						strcat(*output_buffer, cleaned_macro);
+	return OK;
+}
 
-						log_debug_info(DEBUGL_MACROS, 2, "  已清除宏.  运行输出  (%lu): '%s'\n", (unsigned long)strlen(*output_buffer), *output_buffer);
-					}
-				}
 
-				/* others are not cleaned */
-				else {
-					/* add the processed macro to the end of the already processed buffer */
-					if (selected_macro != NULL) {
-						*output_buffer = (char *)realloc(*output_buffer, strlen(*output_buffer) + strlen(selected_macro) + 1);
-						strcat(*output_buffer, selected_macro);
+/* splits a string into text and macro tokens the same way process_macros_r() reads it */
+macro_token *compile_macro_tokens(char *input_buffer) {
+	macro_token *tokens = NULL;
+	macro_token *last_token = NULL;
+	char *buf_ptr = NULL;
+	char *delim_ptr = NULL;
+	int in_macro = FALSE;
+	int length = 0;
+	int result = OK;
 
-						log_debug_info(DEBUGL_MACROS, 2, "  未清除宏.  运行输出 (%lu): '%s'\n", (unsigned long)strlen(*output_buffer), *output_buffer);
-					}
-				}
+	if (input_buffer == NULL)
+		return NULL;
 
-				/* free memory if necessary (if we URL encoded the macro or we were told to do so by grab_macro_value()) */
-				if (free_macro == TRUE)
-					my_free(selected_macro);
+	for (buf_ptr = input_buffer; buf_ptr != NULL && result == OK; buf_ptr = (delim_ptr != NULL) ? delim_ptr + 1 : NULL) {
 
-				log_debug_info(DEBUGL_MACROS, 2, "  刚刚完成宏.  运行输出 (%lu): '%s'\n", (unsigned long)strlen(*output_buffer), *output_buffer);
-			}
+		delim_ptr = strchr(buf_ptr, '$');
+		length = (delim_ptr != NULL) ? (int)(delim_ptr - buf_ptr) : (int)strlen(buf_ptr);
+
+		if (in_macro == FALSE) {
+			if (length > 0)
+				result = add_macro_token(&tokens, &last_token, MACRO_TOKEN_TEXT, buf_ptr, length, TRUE);
+			in_macro = TRUE;
+		}
 
+		/* an empty macro name is an escaped $ */
+		else {
+			if (length == 0)
+				result = add_macro_token(&tokens, &last_token, MACRO_TOKEN_TEXT, "$", 1, TRUE);
+			else
+				result = add_macro_token(&tokens, &last_token, MACRO_TOKEN_MACRO, buf_ptr, length, (delim_ptr != NULL) ? TRUE : FALSE);
 			in_macro = FALSE;
 		}
 	}
 
-	/* free copy of input buffer */
-	my_free(save_buffer);
+	if (result == ERROR) {
+		free_macro_tokens(tokens);
+		return NULL;
+	}
 
-	log_debug_info(DEBUGL_MACROS, 1, "  完成.  最终输出: '%s'\n", *output_buffer);
-	log_debug_info(DEBUGL_MACROS, 1, "**** 结束宏处理 *************\n");
+	/* an empty string still gets a token, so callers can tell it was compiled */
+	if (tokens == NULL)
+		add_macro_token(&tokens, &last_token, MACRO_TOKEN_TEXT, "", 0, TRUE);
 
-	return OK;
+	return tokens;
 }
 
+
+void free_macro_tokens(macro_token *tokens) {
+	macro_token *token = NULL;
+	macro_token *next_token = NULL;
+
+	for (token = tokens; token != NULL; token = next_token) {
+		next_token = token->next;
+		my_free(token->text);
+		my_free(token);
+	}
+}
+
+
 int process_macros(char *input_buffer, char **output_buffer, int options) {
 	return process_macros_r(&global_macros, input_buffer, output_buffer, options);
 }
@@ -3026,6 +3250,7 @@ int clear_volatile_macros_r(icinga_macros *mac) {
 
 	/* clear ARGx macros */
 	clear_argv_macros_r(mac);
+	mac->command_tokens = NULL;
 
 	/* clear custom host variables */
 	for (this_customvariablesmember = mac->custom_host_vars; this_customvariablesmember != NULL; this_customvariablesmember = next_customvariablesmember) {
@@ -3364,6 +3589,10 @@ int set_all_macro_environment_vars_r(icinga_macros *mac, int set) {
 	if (enable_environment_macros == FALSE)
 		return ERROR;
 
+	/* only the macros the command line references */
+	if (lazy_environment_macros == TRUE && mac->command_tokens != NULL)
+		return set_referenced_macro_environment_vars_r(mac, set);
+
 	set_macrox_environment_vars_r(mac, set);
 	set_argv_macro_environment_vars_r(mac, set);
 	set_custom_macro_environment_vars_r(mac, set);
@@ -3378,43 +3607,48 @@ int set_all_macro_environment_vars(int set) {
 
 
 /**
- * sets or unsets macrox environment variables
+ * sets or unsets a single macrox environment variable
  */
-int set_macrox_environment_vars_r(icinga_macros *mac, int set) {
-	register int x = 0;
+static void set_macrox_environment_var_r(icinga_macros *mac, int x, int set) {
 	int free_macro = FALSE;
 
-	/* set each of the macrox environment variables */
-	for (x = 0; x < MACRO_X_COUNT; x++) {
+	if (use_large_installation_tweaks == TRUE) {
 
-		free_macro = FALSE;
+		/* skip summary macro generation if large installation tweaks are enabled */
+		if (x >= MACRO_TOTALHOSTSUP && x <= MACRO_TOTALSERVICEPROBLEMSUNHANDLED)
+			return;
 
-		if (use_large_installation_tweaks == TRUE) {
+		/* skip groupmembers macro generation
+		 * if large installation tweaks are enabled
+		 * they may break environment macros, check
+		 * https://dev.icinga.org/issues/3859
+		 */
+		if (x == MACRO_HOSTGROUPMEMBERS || x == MACRO_SERVICEGROUPMEMBERS)
+			return;
+	}
 
-			/* skip summary macro generation if large installation tweaks are enabled */
-			if (x >= MACRO_TOTALHOSTSUP && x <= MACRO_TOTALSERVICEPROBLEMSUNHANDLED)
-				continue;
+	/* generate the macro value if it hasn't already been done */
+	/* THIS IS EXPENSIVE */
+	if (set == TRUE) {
 
-			/* skip groupmembers macro generation
-			 * if large installation tweaks are enabled
-			 * they may break environment macros, check
-			 * https://dev.icinga.org/issues/3859
-			 */
-			if (x == MACRO_HOSTGROUPMEMBERS || x == MACRO_SERVICEGROUPMEMBERS)
-				continue;
-		}
+		if (mac->x[x] == NULL)
+			grab_macrox_value_r(mac, x, NULL, NULL, &mac->x[x], &free_macro);
+	}
 
-		/* generate the macro value if it hasn't already been done */
-		/* THIS IS EXPENSIVE */
-		if (set == TRUE) {
+	/* set the value */
+	set_macro_environment_var(macro_x_names[x], mac->x[x], set);
+}
 
-			if (mac->x[x] == NULL)
-				grab_macrox_value_r(mac, x, NULL, NULL, &mac->x[x], &free_macro);
-		}
 
-		/* set the value */
-		set_macro_environment_var(macro_x_names[x], mac->x[x], set);
-	}
+/**
+ * sets or unsets macrox environment variables
+ */
+int set_macrox_environment_vars_r(icinga_macros *mac, int set) {
+	register int x = 0;
+
+	/* set each of the macrox environment variables */
+	for (x = 0; x < MACRO_X_COUNT; x++)
+		set_macrox_environment_var_r(mac, x, set);
 
 	return OK;
 }
@@ -3528,6 +3762,56 @@ int set_contact_address_environment_vars(int set) {
 }
 
 
+/**
+ * sets or unsets environment variables only for the macros the
+ * last processed command line references (lazy_environment_macros)
+ */
+int set_referenced_macro_environment_vars_r(icinga_macros *mac, int set) {
+	macro_token *token = NULL;
+	char *macro_name = NULL;
+	char *value = NULL;
+	int contact_addresses = FALSE;
+
+	for (token = mac->command_tokens; token != NULL; token = token->next) {
+
+		switch (token->type) {
+
+		case MACRO_TOKEN_X:
+			set_macrox_environment_var_r(mac, token->index, set);
+			break;
+
+		case MACRO_TOKEN_ARGV:
+			dummy = asprintf(&macro_name, "ARG%d", token->index + 1);
+			set_macro_environment_var(macro_name, mac->argv[token->index], set);
+			my_free(macro_name);
+			break;
+
+		case MACRO_TOKEN_CUSTOM:
+			if (set == TRUE) {
+				if (grab_custom_macro_value_r(mac, token->text, NULL, NULL, &value) == OK && value != NULL)
+					set_macro_environment_var(token->text, clean_macro_chars(value, STRIP_ILLEGAL_MACRO_CHARS | ESCAPE_MACRO_CHARS), TRUE);
+				my_free(value);
+			} else
+				set_macro_environment_var(token->text, NULL, FALSE);
+			break;
+
+		case MACRO_TOKEN_MACRO:
+			if (strstr(token->text, "CONTACTADDRESS") == token->text)
+				contact_addresses = TRUE;
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	if (contact_addresses == TRUE)
+		set_contact_address_environment_vars_r(mac, set);
+
+	return OK;
+}
+
+
 /**
  * sets or unsets a macro environment variable
  */
@@ -0,0 +1,200 @@
+/*****************************************************************************
+ *
+ * MINHEAP.C - Binary min-heap used by the event, check result and deadline queues
+ *
+ * Copyright (c) 2009-2013 Icinga Development Team (http://www.icinga.org)
+ *
+ * License:
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *****************************************************************************/
+
+#include "../include/config.h"
+#include "../include/common.h"
+#include "../include/minheap.h"
+
+
+/* sets up an empty heap */
+void minheap_init(minheap *heap, minheap_compare_func comes_before, minheap_position_func set_position) {
+
+	heap->items = NULL;
+	heap->count = 0;
+	heap->size = 0;
+	heap->comes_before = comes_before;
+	heap->set_position = set_position;
+}
+
+
+/* places an item in a slot and tells the item about it */
+static void minheap_set(minheap *heap, unsigned int pos, void *item) {
+
+	heap->items[pos] = item;
+	if (heap->set_position != NULL)
+		heap->set_position(item, pos);
+}
+
+
+/* moves the item in the given slot towards the top, returns its new slot */
+static unsigned int minheap_sift_up(minheap *heap, unsigned int pos) {
+	void *item = heap->items[pos];
+	unsigned int parent = 0;
+
+	while (pos > 1) {
+		parent = pos / 2;
+		if (heap->comes_before(item, heap->items[parent]) == FALSE)
+			break;
+		minheap_set(heap, pos, heap->items[parent]);
+		pos = parent;
+	}
+
+	minheap_set(heap, pos, item);
+
+	return pos;
+}
+
+
+/* moves the item in the given slot towards the bottom */
+static void minheap_sift_down(minheap *heap, unsigned int pos) {
+	void *item = heap->items[pos];
+	unsigned int child = 0;
+
+	while ((child = pos * 2) <= heap->count) {
+		if (child < heap->count && heap->comes_before(heap->items[child + 1], heap->items[child]) == TRUE)
+			child++;
+		if (heap->comes_before(heap->items[child], item) == FALSE)
+			break;
+		minheap_set(heap, pos, heap->items[child]);
+		pos = child;
+	}
+
+	minheap_set(heap, pos, item);
+}
+
+
+/* makes sure the heap has room for the given number of additional items */
+int minheap_reserve(minheap *heap, unsigned int items) {
+	void **new_items = NULL;
+	unsigned int new_size = 0;
+
+	/* slot 0 is never used */
+	if (heap->count + items < heap->size)
+		return OK;
+
+	/* grow the heap */
+	new_size = (heap->size == 0) ? 1024 : heap->size;
+	while (new_size <= heap->count + items)
+		new_size *= 2;
+	if ((new_items = (void **)realloc(heap->items, new_size * sizeof(void *))) == NULL)
+		return ERROR;
+	heap->items = new_items;
+	heap->size = new_size;
+
+	return OK;
+}
+
+
+/* adds an item to the heap */
+int minheap_insert(minheap *heap, void *item) {
+
+	if (minheap_reserve(heap, 1) == ERROR)
+		return ERROR;
+
+	heap->count++;
+	heap->items[heap->count] = item;
+	minheap_sift_up(heap, heap->count);
+
+	return OK;
+}
+
+
+/* moves the item in the given slot to where its (changed) order puts it */
+void minheap_update(minheap *heap, unsigned int pos) {
+
+	if (pos < 1 || pos > heap->count)
+		return;
+
+	pos = minheap_sift_up(heap, pos);
+	minheap_sift_down(heap, pos);
+}
+
+
+/* takes the item in the given slot out of the heap */
+void *minheap_delete(minheap *heap, unsigned int pos) {
+	void *item = NULL;
+	void *last_item = NULL;
+
+	if (pos < 1 || pos > heap->count)
+		return NULL;
+
+	item = heap->items[pos];
+	last_item = heap->items[heap->count];
+	heap->items[heap->count] = NULL;
+	heap->count--;
+	if (heap->set_position != NULL)
+		heap->set_position(item, 0);
+
+	/* move the last item into the hole and restore heap order */
+	if (last_item != item) {
+		minheap_set(heap, pos, last_item);
+		minheap_update(heap, pos);
+	}
+
+	return item;
+}
+
+
+/* returns the first item without removing it */
+void *minheap_peek(minheap *heap) {
+
+	if (heap->count == 0)
+		return NULL;
+
+	return heap->items[1];
+}
+
+
+/* removes and returns the first item */
+void *minheap_pop(minheap *heap) {
+
+	return minheap_delete(heap, 1);
+}
+
+
+/* returns TRUE if the item currently lives in the given slot */
+int minheap_contains(minheap *heap, void *item, unsigned int pos) {
+
+	if (pos < 1 || pos > heap->count)
+		return FALSE;
+
+	return (heap->items[pos] == item) ? TRUE : FALSE;
+}
+
+
+/* rebuilds heap order bottom-up, which is linear in the number of items */
+void minheap_heapify(minheap *heap) {
+	unsigned int x = 0;
+
+	for (x = heap->count / 2; x >= 1; x--)
+		minheap_sift_down(heap, x);
+}
+
+
+/* frees the slots of the heap, the items belong to the caller */
+void minheap_free(minheap *heap) {
+
+	my_free(heap->items);
+	heap->count = 0;
+	heap->size = 0;
+}
@@ -66,6 +66,9 @@ module		*module_list = NULL, *module_list_tail = NULL;
 skiplist *object_skiplists[NUM_OBJECT_SKIPLISTS];
 static int object_skiplists_valid = 0;
 
+object_hash object_hashes[NUM_OBJECT_HASHES];
+int object_hash_profiling = FALSE;
+
 
 #ifdef NSCORE
 /* keep this for compatibility */
@@ -89,6 +92,9 @@ int read_object_config_data(char *main_config_file, int options, int cache, int
 	/* initialize object skiplists */
 	init_object_skiplists();
 
+	/* initialize hash indexes for name lookups */
+	init_object_hashes();
+
 	/********* IMPLEMENTATION-SPECIFIC INPUT FUNCTION ********/
 #ifdef USE_XODTEMPLATE
 	/* read in data from all text host config files (template-based) */
@@ -146,6 +152,180 @@ int free_object_skiplists(void) {
 }
 
 
+
+
+/******************************************************************/
+/******************** HASH INDEX FUNCTIONS ************************/
+/******************************************************************/
+
+/* the skiplists stay around for duplicate detection and ordered walks, all name lookups go through these */
+
+int init_object_hashes(void) {
+	int x = 0;
+
+	free_object_hashes();
+
+	for (x = 0; x < NUM_OBJECT_HASHES; x++) {
+		object_hashes[x].entries = (object_hash_entry *)calloc(OBJECT_HASH_MIN_SIZE, sizeof(object_hash_entry));
+		object_hashes[x].size = (object_hashes[x].entries == NULL) ? 0 : OBJECT_HASH_MIN_SIZE;
+	}
+
+	return OK;
+}
+
+
+
+int free_object_hashes(void) {
+	int x = 0;
+
+	for (x = 0; x < NUM_OBJECT_HASHES; x++) {
+		my_free(object_hashes[x].entries);
+		object_hashes[x].size = 0;
+		object_hashes[x].items = 0;
+	}
+
+	return OK;
+}
+
+
+
+/* doubles the size of a hash index, entries carry their hash so names are not looked at */
+static int grow_object_hash(object_hash *index) {
+	object_hash_entry *new_entries = NULL;
+	unsigned long new_size = 0L;
+	unsigned long mask = 0L;
+	unsigned long x = 0L;
+	unsigned long pos = 0L;
+
+	new_size = (index->size == 0) ? OBJECT_HASH_MIN_SIZE : index->size * 2;
+	if ((new_entries = (object_hash_entry *)calloc(new_size, sizeof(object_hash_entry))) == NULL)
+		return ERROR;
+
+	mask = new_size - 1;
+	for (x = 0; x < index->size; x++) {
+		if (index->entries[x].object == NULL)
+			continue;
+		for (pos = index->entries[x].hash & mask; new_entries[pos].object != NULL; pos = (pos + 1) & mask);
+		new_entries[pos] = index->entries[x];
+	}
+
+	my_free(index->entries);
+	index->entries = new_entries;
+	index->size = new_size;
+
+	return OK;
+}
+
+
+
+/* adds an object to a hash index - duplicates must have been weeded out by the skiplist already */
+int add_object_to_hash(int type, unsigned long hash, void *object) {
+	object_hash *index = NULL;
+	unsigned long mask = 0L;
+	unsigned long pos = 0L;
+
+	if (type < 0 || type >= NUM_OBJECT_HASHES || object == NULL)
+		return ERROR;
+
+	index = &object_hashes[type];
+
+	/* keep the load below one half, but carry on with a fuller table if we can't get memory */
+	if ((index->items + 1) * 2 > index->size) {
+		if (grow_object_hash(index) == ERROR && index->items + 1 >= index->size)
+			return ERROR;
+	}
+
+	mask = index->size - 1;
+	for (pos = hash & mask; index->entries[pos].object != NULL; pos = (pos + 1) & mask);
+	index->entries[pos].hash = hash;
+	index->entries[pos].object = object;
+	index->items++;
+
+	return OK;
+}
+
+
+
+/* checks whether a hashed object really has the name(s) we're looking for */
+static int object_hash_match(int type, void *object, const char *name1, const char *name2) {
+
+	switch (type) {
+	case HOST_HASH:
+		return (!strcmp(((host *)object)->name, name1)) ? TRUE : FALSE;
+	case SERVICE_HASH:
+		return (!strcmp(((service *)object)->description, name2) && !strcmp(((service *)object)->host_name, name1)) ? TRUE : FALSE;
+	case COMMAND_HASH:
+		return (!strcmp(((command *)object)->name, name1)) ? TRUE : FALSE;
+	case TIMEPERIOD_HASH:
+		return (!strcmp(((timeperiod *)object)->name, name1)) ? TRUE : FALSE;
+	case CONTACT_HASH:
+		return (!strcmp(((contact *)object)->name, name1)) ? TRUE : FALSE;
+	default:
+		break;
+	}
+
+	return FALSE;
+}
+
+
+
+/* finds an object by name(s) in a hash index */
+static void *find_object_in_hash(int type, const char *name1, const char *name2) {
+	object_hash *index = &object_hashes[type];
+	object_hash_entry *entry = NULL;
+	void *found = NULL;
+	unsigned long hash = 0L;
+	unsigned long mask = 0L;
+	unsigned long pos = 0L;
+	struct timeval start;
+	struct timeval end;
+
+	if (object_hash_profiling == TRUE)
+		gettimeofday(&start, NULL);
+
+	index->lookups++;
+
+	if (index->size > 0) {
+		hash = (name2 == NULL) ? sdbm(name1) : OBJECT_HASH_PAIR(sdbm(name1), sdbm(name2));
+		mask = index->size - 1;
+		for (pos = hash & mask; (entry = &index->entries[pos])->object != NULL; pos = (pos + 1) & mask) {
+			if (entry->hash == hash && object_hash_match(type, entry->object, name1, name2) == TRUE) {
+				found = entry->object;
+				break;
+			}
+		}
+	}
+
+	if (found == NULL)
+		index->misses++;
+
+	if (object_hash_profiling == TRUE) {
+		gettimeofday(&end, NULL);
+		index->elapsed += (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_usec - start.tv_usec) / 1000000.0;
+	}
+
+	return found;
+}
+
+
+
+/* returns lookup statistics of a hash index for the profiler */
+int get_object_hash_stats(int type, unsigned long *lookups, unsigned long *misses, double *elapsed) {
+
+	if (type < 0 || type >= NUM_OBJECT_HASHES)
+		return ERROR;
+
+	if (lookups != NULL)
+		*lookups = object_hashes[type].lookups;
+	if (misses != NULL)
+		*misses = object_hashes[type].misses;
+	if (elapsed != NULL)
+		*elapsed = object_hashes[type].elapsed;
+
+	return OK;
+}
+
+
 int skiplist_compare_text(const char *val1a, const char *val1b, const char *val2a, const char *val2b) {
 	int result = 0;
 
@@ -464,7 +644,11 @@ timeperiod *add_timeperiod(char *name, char *alias) {
 			result = ERROR;
 			break;
 		case SKIPLIST_OK:
-			result = OK;
+			result = add_object_to_hash(TIMEPERIOD_HASH, sdbm(new_timeperiod->name), (void *)new_timeperiod);
+			if (result == ERROR) {
+				logit(NSLOG_CONFIG_ERROR, TRUE, "Error: Could not add timeperiod '%s' to hash index\n", name);
+				skiplist_delete(object_skiplists[TIMEPERIOD_SKIPLIST], (void *)new_timeperiod);
+			}
 			break;
 		default:
 			logit(NSLOG_CONFIG_ERROR, TRUE, "Error: Could not add timeperiod '%s' to skiplist\n", name);
@@ -833,7 +1017,11 @@ host *add_host(char *name, char *display_name, char *alias, char *address, char
 			result = ERROR;
 			break;
 		case SKIPLIST_OK:
-			result = OK;
+			result = add_object_to_hash(HOST_HASH, new_host->name_hash, (void *)new_host);
+			if (result == ERROR) {
+				logit(NSLOG_CONFIG_ERROR, TRUE, "Error: Could not add host '%s' to hash index\n", name);
+				skiplist_delete(object_skiplists[HOST_SKIPLIST], (void *)new_host);
+			}
 			break;
 		default:
 			logit(NSLOG_CONFIG_ERROR, TRUE, "Error: Could not add host '%s' to skiplist\n", name);
@@ -1388,7 +1576,11 @@ contact *add_contact(char *name, char *alias, char *email, char *pager, char **a
 			result = ERROR;
 			break;
 		case SKIPLIST_OK:
-			result = OK;
+			result = add_object_to_hash(CONTACT_HASH, sdbm(new_contact->name), (void *)new_contact);
+			if (result == ERROR) {
+				logit(NSLOG_CONFIG_ERROR, TRUE, "Error: Could not add contact '%s' to hash index\n", name);
+				skiplist_delete(object_skiplists[CONTACT_SKIPLIST], (void *)new_contact);
+			}
 			break;
 		default:
 			logit(NSLOG_CONFIG_ERROR, TRUE, "Error: Could not add contact '%s' to skiplist\n", name);
@@ -1780,7 +1972,11 @@ service *add_service(char *host_name, char *description, char *display_name, cha
 			result = ERROR;
 			break;
 		case SKIPLIST_OK:
-			result = OK;
+			result = add_object_to_hash(SERVICE_HASH, OBJECT_HASH_PAIR(new_service->host_name_hash, new_service->description_hash), (void *)new_service);
+			if (result == ERROR) {
+				logit(NSLOG_CONFIG_ERROR, TRUE, "Error: Could not add service '%s' on host '%s' to hash index\n", description, host_name);
+				skiplist_delete(object_skiplists[SERVICE_SKIPLIST], (void *)new_service);
+			}
 			break;
 		default:
 			logit(NSLOG_CONFIG_ERROR, TRUE, "Error: Could not add service '%s' on host '%s' to skiplist\n", description, host_name);
@@ -1901,7 +2097,11 @@ command *add_command(char *name, char *value) {
 			result = ERROR;
 			break;
 		case SKIPLIST_OK:
-			result = OK;
+			result = add_object_to_hash(COMMAND_HASH, sdbm(new_command->name), (void *)new_command);
+			if (result == ERROR) {
+				logit(NSLOG_CONFIG_ERROR, TRUE, "Error: Could not add command '%s' to hash index\n", name);
+				skiplist_delete(object_skiplists[COMMAND_SKIPLIST], (void *)new_command);
+			}
 			break;
 		default:
 			logit(NSLOG_CONFIG_ERROR, TRUE, "Error: Could not add command '%s' to skiplist\n", name);
@@ -2597,27 +2797,21 @@ int add_module_objects_to_neb(void) {
 
 /* given a timeperiod name and a starting point, find a timeperiod from the list in memory */
 timeperiod * find_timeperiod(char *name) {
-	timeperiod temp_timeperiod;
 
 	if (name == NULL)
 		return NULL;
 
-	temp_timeperiod.name = name;
-
-	return skiplist_find_first(object_skiplists[TIMEPERIOD_SKIPLIST], &temp_timeperiod, NULL);
+	return (timeperiod *)find_object_in_hash(TIMEPERIOD_HASH, name, NULL);
 }
 
 
 /* given a host name, find it in the list in memory */
 host * find_host(char *name) {
-	host temp_host;
 
 	if (name == NULL)
 		return NULL;
 
-	temp_host.name = name;
-
-	return skiplist_find_first(object_skiplists[HOST_SKIPLIST], &temp_host, NULL);
+	return (host *)find_object_in_hash(HOST_HASH, name, NULL);
 }
 
 
@@ -2649,14 +2843,11 @@ servicegroup * find_servicegroup(char *name) {
 
 /* find a contact from the list in memory */
 contact * find_contact(char *name) {
-	contact temp_contact;
 
 	if (name == NULL)
 		return NULL;
 
-	temp_contact.name = name;
-
-	return skiplist_find_first(object_skiplists[CONTACT_SKIPLIST], &temp_contact, NULL);
+	return (contact *)find_object_in_hash(CONTACT_HASH, name, NULL);
 }
 
 
@@ -2675,28 +2866,21 @@ contactgroup * find_contactgroup(char *name) {
 
 /* given a command name, find a command from the list in memory */
 command * find_command(char *name) {
-	command temp_command;
 
 	if (name == NULL)
 		return NULL;
 
-	temp_command.name = name;
-
-	return skiplist_find_first(object_skiplists[COMMAND_SKIPLIST], &temp_command, NULL);
+	return (command *)find_object_in_hash(COMMAND_HASH, name, NULL);
 }
 
 
 /* given a host/service name, find the service in the list in memory */
 service * find_service(char *host_name, char *svc_desc) {
-	service temp_service;
 
 	if (host_name == NULL || svc_desc == NULL)
 		return NULL;
 
-	temp_service.host_name = host_name;
-	temp_service.description = svc_desc;
-
-	return skiplist_find_first(object_skiplists[SERVICE_SKIPLIST], &temp_service, NULL);
+	return (service *)find_object_in_hash(SERVICE_HASH, host_name, svc_desc);
 }
 
 
@@ -3449,6 +3633,9 @@ int free_object_data(void) {
 		}
 
 		next_timeperiod = this_timeperiod->next;
+#ifdef NSCORE
+		my_free(this_timeperiod->compiled_ranges);
+#endif
 		my_free(this_timeperiod->name);
 		my_free(this_timeperiod->alias);
 		my_free(this_timeperiod);
@@ -3761,6 +3948,9 @@ int free_object_data(void) {
 		next_command = this_command->next;
 		my_free(this_command->name);
 		my_free(this_command->command_line);
+#ifdef NSCORE
+		free_macro_tokens(this_command->macro_tokens);
+#endif
 		my_free(this_command);
 		this_command = next_command;
 	}
@@ -3906,6 +4096,9 @@ int free_object_data(void) {
 	/* free object skiplists */
 	free_object_skiplists();
 
+	/* free hash indexes */
+	free_object_hashes();
+
 	return OK;
 }
 
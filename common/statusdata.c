@@ -58,6 +58,10 @@ hoststatus      **hoststatus_hashlist = NULL;
 servicestatus   **servicestatus_hashlist = NULL;
 
 extern int      use_pending_states;
+
+/* strings of a mapped binary status snapshot are released along with the mapping */
+static void     *status_data_mapping = NULL;
+static size_t   status_data_mapping_size = 0;
 #endif
 
 int dummy;	/* reduce compiler warnings */
@@ -144,6 +148,12 @@ int update_program_status(int aggregated_dump) {
 /* updates host status info */
 int update_host_status(host *hst, int aggregated_dump) {
 
+	/* remember to write this object with the next status delta and retention save */
+	if (hst != NULL) {
+		hst->status_dirty = TRUE;
+		hst->retention_dirty = TRUE;
+	}
+
 #ifdef USE_EVENT_BROKER
 	/* send data to event broker (non-aggregated dumps only) */
 	if (aggregated_dump == FALSE)
@@ -164,6 +174,12 @@ int update_host_status(host *hst, int aggregated_dump) {
 /* updates service status info */
 int update_service_status(service *svc, int aggregated_dump) {
 
+	/* remember to write this object with the next status delta and retention save */
+	if (svc != NULL) {
+		svc->status_dirty = TRUE;
+		svc->retention_dirty = TRUE;
+	}
+
 #ifdef USE_EVENT_BROKER
 	/* send data to event broker (non-aggregated dumps only) */
 	if (aggregated_dump == FALSE)
@@ -184,6 +200,12 @@ int update_service_status(service *svc, int aggregated_dump) {
 /* updates contact status info */
 int update_contact_status(contact *cntct, int aggregated_dump) {
 
+	/* remember to write this object with the next status delta and retention save */
+	if (cntct != NULL) {
+		cntct->status_dirty = TRUE;
+		cntct->retention_dirty = TRUE;
+	}
+
 #ifdef USE_EVENT_BROKER
 	/* send data to event broker (non-aggregated dumps only) */
 	if (aggregated_dump == FALSE)
@@ -224,6 +246,32 @@ int read_status_data(char *main_config_file, int options) {
 }
 
 
+/* tells which memory holds the strings of a mapped binary status snapshot, unmapped by free_status_data() */
+int set_status_data_mapping(void *mapping, size_t size) {
+
+	/* only one snapshot can be in use at a time */
+	if (status_data_mapping != NULL)
+		return ERROR;
+
+	status_data_mapping = mapping;
+	status_data_mapping_size = size;
+
+	return OK;
+}
+
+
+/* frees a status string unless it lives in the mapped status snapshot */
+static void free_status_string(char **string) {
+
+	if (status_data_mapping != NULL && *string >= (char *)status_data_mapping && *string < (char *)status_data_mapping + status_data_mapping_size)
+		*string = NULL;
+	else
+		my_free(*string);
+
+	return;
+}
+
+
 
 /******************************************************************/
 /****************** CHAINED HASH FUNCTIONS ************************/
@@ -316,9 +364,93 @@ int add_servicestatus_to_hashlist(servicestatus *new_servicestatus) {
 /******************************************************************/
 
 
+/* converts the host state and fills in the output of pending hosts */
+static void massage_host_status(hoststatus *new_hoststatus) {
+	char date_string[MAX_DATETIME_LENGTH];
+
+	switch (new_hoststatus->status) {
+	case 0:
+		new_hoststatus->status = HOST_UP;
+		break;
+	case 1:
+		new_hoststatus->status = HOST_DOWN;
+		break;
+	case 2:
+		new_hoststatus->status = HOST_UNREACHABLE;
+		break;
+	default:
+		new_hoststatus->status = HOST_UP;
+		break;
+	}
+	if (new_hoststatus->has_been_checked == FALSE) {
+		if (use_pending_states == TRUE)
+			new_hoststatus->status = HOST_PENDING;
+		free_status_string(&new_hoststatus->plugin_output);
+		if (new_hoststatus->should_be_scheduled == TRUE) {
+			get_time_string(&new_hoststatus->next_check, date_string, sizeof(date_string), LONG_DATE_TIME);
+			dummy = asprintf(&new_hoststatus->plugin_output, "%s安排主机检查", date_string);
+		} else {
+			/* passive-only hosts that have just been scheduled for a forced check */
+			if (new_hoststatus->checks_enabled == FALSE && new_hoststatus->next_check != (time_t)0L && (new_hoststatus->check_options & CHECK_OPTION_FORCE_EXECUTION)) {
+				get_time_string(&new_hoststatus->next_check, date_string, sizeof(date_string), LONG_DATE_TIME);
+				dummy = asprintf(&new_hoststatus->plugin_output, "%s强迫安排主机检查", date_string);
+			}
+			/* passive-only hosts not scheduled to be checked */
+			else
+				new_hoststatus->plugin_output = (char *)strdup("没安排主机检查...");
+		}
+	}
+
+	return;
+}
+
+
+/* converts the service state and fills in the output of pending services */
+static void massage_service_status(servicestatus *new_svcstatus) {
+	char date_string[MAX_DATETIME_LENGTH];
+
+	switch (new_svcstatus->status) {
+	case 0:
+		new_svcstatus->status = SERVICE_OK;
+		break;
+	case 1:
+		new_svcstatus->status = SERVICE_WARNING;
+		break;
+	case 2:
+		new_svcstatus->status = SERVICE_CRITICAL;
+		break;
+	case 3:
+		new_svcstatus->status = SERVICE_UNKNOWN;
+		break;
+	default:
+		new_svcstatus->status = SERVICE_OK;
+		break;
+	}
+	if (new_svcstatus->has_been_checked == FALSE) {
+		if (use_pending_states == TRUE)
+			new_svcstatus->status = SERVICE_PENDING;
+		free_status_string(&new_svcstatus->plugin_output);
+		if (new_svcstatus->should_be_scheduled == TRUE) {
+			get_time_string(&new_svcstatus->next_check, date_string, sizeof(date_string), LONG_DATE_TIME);
+			dummy = asprintf(&new_svcstatus->plugin_output, "%s安排服务检查", date_string);
+		} else {
+			/* passive-only services that have just been scheduled for a forced check */
+			if (new_svcstatus->checks_enabled == FALSE && new_svcstatus->next_check != (time_t)0L && (new_svcstatus->check_options & CHECK_OPTION_FORCE_EXECUTION)) {
+				get_time_string(&new_svcstatus->next_check, date_string, sizeof(date_string), LONG_DATE_TIME);
+				dummy = asprintf(&new_svcstatus->plugin_output, "%s强迫安排服务检查", date_string);
+			}
+			/* passive-only services not scheduled to be checked */
+			else
+				new_svcstatus->plugin_output = (char *)strdup("没有安排服务检查...");
+		}
+	}
+
+	return;
+}
+
+
 /* adds a host status entry to the list in memory */
 int add_host_status(hoststatus *new_hoststatus) {
-	char date_string[MAX_DATETIME_LENGTH];
 
 	/* make sure we have what we need */
 	if (new_hoststatus == NULL)
@@ -327,40 +459,7 @@ int add_host_status(hoststatus *new_hoststatus) {
 		return ERROR;
 
 	/* massage host status a bit */
-	if (new_hoststatus != NULL) {
-		switch (new_hoststatus->status) {
-		case 0:
-			new_hoststatus->status = HOST_UP;
-			break;
-		case 1:
-			new_hoststatus->status = HOST_DOWN;
-			break;
-		case 2:
-			new_hoststatus->status = HOST_UNREACHABLE;
-			break;
-		default:
-			new_hoststatus->status = HOST_UP;
-			break;
-		}
-		if (new_hoststatus->has_been_checked == FALSE) {
-			if (use_pending_states == TRUE)
-				new_hoststatus->status = HOST_PENDING;
-			my_free(new_hoststatus->plugin_output);
-			if (new_hoststatus->should_be_scheduled == TRUE) {
-				get_time_string(&new_hoststatus->next_check, date_string, sizeof(date_string), LONG_DATE_TIME);
-				dummy = asprintf(&new_hoststatus->plugin_output, "%s安排主机检查", date_string);
-			} else {
-				/* passive-only hosts that have just been scheduled for a forced check */
-				if (new_hoststatus->checks_enabled == FALSE && new_hoststatus->next_check != (time_t)0L && (new_hoststatus->check_options & CHECK_OPTION_FORCE_EXECUTION)) {
-					get_time_string(&new_hoststatus->next_check, date_string, sizeof(date_string), LONG_DATE_TIME);
-					dummy = asprintf(&new_hoststatus->plugin_output, "%s强迫安排主机检查", date_string);
-				}
-				/* passive-only hosts not scheduled to be checked */
-				else
-					new_hoststatus->plugin_output = (char *)strdup("没安排主机检查...");
-			}
-		}
-	}
+	massage_host_status(new_hoststatus);
 
 	new_hoststatus->next = NULL;
 	new_hoststatus->nexthash = NULL;
@@ -384,7 +483,6 @@ int add_host_status(hoststatus *new_hoststatus) {
 
 /* adds a service status entry to the list in memory */
 int add_service_status(servicestatus *new_svcstatus) {
-	char date_string[MAX_DATETIME_LENGTH];
 
 	/* make sure we have what we need */
 	if (new_svcstatus == NULL)
@@ -392,45 +490,8 @@ int add_service_status(servicestatus *new_svcstatus) {
 	if (new_svcstatus->host_name == NULL || new_svcstatus->description == NULL)
 		return ERROR;
 
-
 	/* massage service status a bit */
-	if (new_svcstatus != NULL) {
-		switch (new_svcstatus->status) {
-		case 0:
-			new_svcstatus->status = SERVICE_OK;
-			break;
-		case 1:
-			new_svcstatus->status = SERVICE_WARNING;
-			break;
-		case 2:
-			new_svcstatus->status = SERVICE_CRITICAL;
-			break;
-		case 3:
-			new_svcstatus->status = SERVICE_UNKNOWN;
-			break;
-		default:
-			new_svcstatus->status = SERVICE_OK;
-			break;
-		}
-		if (new_svcstatus->has_been_checked == FALSE) {
-			if (use_pending_states == TRUE)
-				new_svcstatus->status = SERVICE_PENDING;
-			my_free(new_svcstatus->plugin_output);
-			if (new_svcstatus->should_be_scheduled == TRUE) {
-				get_time_string(&new_svcstatus->next_check, date_string, sizeof(date_string), LONG_DATE_TIME);
-				dummy = asprintf(&new_svcstatus->plugin_output, "%s安排服务检查", date_string);
-			} else {
-				/* passive-only services that have just been scheduled for a forced check */
-				if (new_svcstatus->checks_enabled == FALSE && new_svcstatus->next_check != (time_t)0L && (new_svcstatus->check_options & CHECK_OPTION_FORCE_EXECUTION)) {
-					get_time_string(&new_svcstatus->next_check, date_string, sizeof(date_string), LONG_DATE_TIME);
-					dummy = asprintf(&new_svcstatus->plugin_output, "%s强迫安排服务检查", date_string);
-				}
-				/* passive-only services not scheduled to be checked */
-				else
-					new_svcstatus->plugin_output = (char *)strdup("没有安排服务检查...");
-			}
-		}
-	}
+	massage_service_status(new_svcstatus);
 
 	new_svcstatus->next = NULL;
 	new_svcstatus->nexthash = NULL;
@@ -452,6 +513,178 @@ int add_service_status(servicestatus *new_svcstatus) {
 }
 
 
+/* adds host status entries whose hash chains were precomputed by the core (binary status snapshot) */
+int add_indexed_host_status(hoststatus **entries, unsigned long count, unsigned long *slot_heads, unsigned long *next_entries) {
+	hoststatus *temp_hoststatus = NULL;
+	hoststatus *last_hoststatus = NULL;
+	unsigned long linked = 0L;
+	unsigned long x = 0L;
+	int i = 0;
+
+	/* the chains can only be taken over as a whole */
+	if (hoststatus_hashlist != NULL || hoststatus_list != NULL)
+		return ERROR;
+	if ((hoststatus_hashlist = (hoststatus **)calloc(HOSTSTATUS_HASHSLOTS, sizeof(hoststatus *))) == NULL)
+		return ERROR;
+
+	/* every entry must be in its own slot and the chains strictly sorted, otherwise lookups would fail */
+	for (i = 0; i < HOSTSTATUS_HASHSLOTS; i++) {
+		last_hoststatus = NULL;
+		for (x = slot_heads[i]; x < count && linked <= count; x = next_entries[x], linked++) {
+			temp_hoststatus = entries[x];
+			if (temp_hoststatus->host_name == NULL || hashfunc(temp_hoststatus->host_name, NULL, HOSTSTATUS_HASHSLOTS) != i)
+				break;
+			if (last_hoststatus == NULL)
+				hoststatus_hashlist[i] = temp_hoststatus;
+			else if (compare_hashdata(last_hoststatus->host_name, NULL, temp_hoststatus->host_name, NULL) < 0)
+				last_hoststatus->nexthash = temp_hoststatus;
+			else
+				break;
+			temp_hoststatus->nexthash = NULL;
+			last_hoststatus = temp_hoststatus;
+		}
+		if (x < count)
+			break;
+	}
+
+	if (i < HOSTSTATUS_HASHSLOTS || linked != count) {
+		for (x = 0; x < count; x++)
+			entries[x]->nexthash = NULL;
+		my_free(hoststatus_hashlist);
+		return ERROR;
+	}
+
+	for (x = 0; x < count; x++) {
+		massage_host_status(entries[x]);
+		entries[x]->next = NULL;
+		if (hoststatus_list == NULL)
+			hoststatus_list = entries[x];
+		else
+			hoststatus_list_tail->next = entries[x];
+		hoststatus_list_tail = entries[x];
+	}
+
+	return OK;
+}
+
+
+/* adds service status entries whose hash chains were precomputed by the core (binary status snapshot) */
+int add_indexed_service_status(servicestatus **entries, unsigned long count, unsigned long *slot_heads, unsigned long *next_entries) {
+	servicestatus *temp_svcstatus = NULL;
+	servicestatus *last_svcstatus = NULL;
+	unsigned long linked = 0L;
+	unsigned long x = 0L;
+	int i = 0;
+
+	/* the chains can only be taken over as a whole */
+	if (servicestatus_hashlist != NULL || servicestatus_list != NULL)
+		return ERROR;
+	if ((servicestatus_hashlist = (servicestatus **)calloc(SERVICESTATUS_HASHSLOTS, sizeof(servicestatus *))) == NULL)
+		return ERROR;
+
+	/* every entry must be in its own slot and the chains strictly sorted, otherwise lookups would fail */
+	for (i = 0; i < SERVICESTATUS_HASHSLOTS; i++) {
+		last_svcstatus = NULL;
+		for (x = slot_heads[i]; x < count && linked <= count; x = next_entries[x], linked++) {
+			temp_svcstatus = entries[x];
+			if (temp_svcstatus->host_name == NULL || temp_svcstatus->description == NULL || hashfunc(temp_svcstatus->host_name, temp_svcstatus->description, SERVICESTATUS_HASHSLOTS) != i)
+				break;
+			if (last_svcstatus == NULL)
+				servicestatus_hashlist[i] = temp_svcstatus;
+			else if (compare_hashdata(last_svcstatus->host_name, last_svcstatus->description, temp_svcstatus->host_name, temp_svcstatus->description) < 0)
+				last_svcstatus->nexthash = temp_svcstatus;
+			else
+				break;
+			temp_svcstatus->nexthash = NULL;
+			last_svcstatus = temp_svcstatus;
+		}
+		if (x < count)
+			break;
+	}
+
+	if (i < SERVICESTATUS_HASHSLOTS || linked != count) {
+		for (x = 0; x < count; x++)
+			entries[x]->nexthash = NULL;
+		my_free(servicestatus_hashlist);
+		return ERROR;
+	}
+
+	for (x = 0; x < count; x++) {
+		massage_service_status(entries[x]);
+		entries[x]->next = NULL;
+		if (servicestatus_list == NULL)
+			servicestatus_list = entries[x];
+		else
+			servicestatus_list_tail->next = entries[x];
+		servicestatus_list_tail = entries[x];
+	}
+
+	return OK;
+}
+
+
+
+
+
+/* replaces a host status entry already in memory (from a status delta), adds it otherwise */
+int replace_host_status(hoststatus *new_hoststatus) {
+	hoststatus *temp_hoststatus = NULL;
+	hoststatus *next_hoststatus = NULL;
+	hoststatus *nexthash_hoststatus = NULL;
+
+	if (new_hoststatus == NULL || new_hoststatus->host_name == NULL)
+		return ERROR;
+
+	if ((temp_hoststatus = find_hoststatus(new_hoststatus->host_name)) == NULL)
+		return add_host_status(new_hoststatus);
+
+	massage_host_status(new_hoststatus);
+
+	/* keep the position of the old entry in the list and hash list */
+	next_hoststatus = temp_hoststatus->next;
+	nexthash_hoststatus = temp_hoststatus->nexthash;
+	free_status_string(&temp_hoststatus->host_name);
+	free_status_string(&temp_hoststatus->plugin_output);
+	free_status_string(&temp_hoststatus->long_plugin_output);
+	free_status_string(&temp_hoststatus->perf_data);
+	memcpy(temp_hoststatus, new_hoststatus, sizeof(hoststatus));
+	temp_hoststatus->next = next_hoststatus;
+	temp_hoststatus->nexthash = nexthash_hoststatus;
+	my_free(new_hoststatus);
+
+	return OK;
+}
+
+
+/* replaces a service status entry already in memory (from a status delta), adds it otherwise */
+int replace_service_status(servicestatus *new_svcstatus) {
+	servicestatus *temp_svcstatus = NULL;
+	servicestatus *next_svcstatus = NULL;
+	servicestatus *nexthash_svcstatus = NULL;
+
+	if (new_svcstatus == NULL || new_svcstatus->host_name == NULL || new_svcstatus->description == NULL)
+		return ERROR;
+
+	if ((temp_svcstatus = find_servicestatus(new_svcstatus->host_name, new_svcstatus->description)) == NULL)
+		return add_service_status(new_svcstatus);
+
+	massage_service_status(new_svcstatus);
+
+	/* keep the position of the old entry in the list and hash list */
+	next_svcstatus = temp_svcstatus->next;
+	nexthash_svcstatus = temp_svcstatus->nexthash;
+	free_status_string(&temp_svcstatus->host_name);
+	free_status_string(&temp_svcstatus->description);
+	free_status_string(&temp_svcstatus->plugin_output);
+	free_status_string(&temp_svcstatus->long_plugin_output);
+	free_status_string(&temp_svcstatus->perf_data);
+	memcpy(temp_svcstatus, new_svcstatus, sizeof(servicestatus));
+	temp_svcstatus->next = next_svcstatus;
+	temp_svcstatus->nexthash = nexthash_svcstatus;
+	my_free(new_svcstatus);
+
+	return OK;
+}
 
 
 
@@ -470,21 +703,21 @@ void free_status_data(void) {
 	/* free memory for the host status list */
 	for (this_hoststatus = hoststatus_list; this_hoststatus != NULL; this_hoststatus = next_hoststatus) {
 		next_hoststatus = this_hoststatus->next;
-		my_free(this_hoststatus->host_name);
-		my_free(this_hoststatus->plugin_output);
-		my_free(this_hoststatus->long_plugin_output);
-		my_free(this_hoststatus->perf_data);
+		free_status_string(&this_hoststatus->host_name);
+		free_status_string(&this_hoststatus->plugin_output);
+		free_status_string(&this_hoststatus->long_plugin_output);
+		free_status_string(&this_hoststatus->perf_data);
 		my_free(this_hoststatus);
 	}
 
 	/* free memory for the service status list */
 	for (this_svcstatus = servicestatus_list; this_svcstatus != NULL; this_svcstatus = next_svcstatus) {
 		next_svcstatus = this_svcstatus->next;
-		my_free(this_svcstatus->host_name);
-		my_free(this_svcstatus->description);
-		my_free(this_svcstatus->plugin_output);
-		my_free(this_svcstatus->long_plugin_output);
-		my_free(this_svcstatus->perf_data);
+		free_status_string(&this_svcstatus->host_name);
+		free_status_string(&this_svcstatus->description);
+		free_status_string(&this_svcstatus->plugin_output);
+		free_status_string(&this_svcstatus->long_plugin_output);
+		free_status_string(&this_svcstatus->perf_data);
 		my_free(this_svcstatus);
 	}
 
@@ -494,6 +727,12 @@ void free_status_data(void) {
 	hoststatus_list = NULL;
 	servicestatus_list = NULL;
 
+	/* the strings of a binary status snapshot go away with it */
+	if (status_data_mapping != NULL)
+		munmap(status_data_mapping, status_data_mapping_size);
+	status_data_mapping = NULL;
+	status_data_mapping_size = 0;
+
 	return;
 }
 
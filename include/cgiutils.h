@@ -526,7 +526,6 @@ int read_icinga_resource_file(char *);
 int read_all_object_configuration_data(char *,int);
 int read_all_status_data(char *,int);
 
-char *unescape_newlines(char *);
 char *escape_newlines(char *);
 void sanitize_plugin_output(char *);				/* strips HTML and bad characters from plugin output */
 void strip_html_brackets(char *);				/* strips > and < from string */
@@ -60,7 +60,8 @@
 
 /*************************** CHAINED HASH LIMITS ***************************/
 
-#define COMMENT_HASHSLOTS      1024
+#define COMMENT_HASHSLOTS      1024		/* by host name */
+#define COMMENT_ID_HASHSLOTS   16384		/* by comment id */
 
 
 
@@ -83,6 +84,8 @@ typedef struct comment_struct{
 	char 	*comment_data;
 	struct 	comment_struct *next;
 	struct 	comment_struct *nexthash;
+	struct 	comment_struct *prev;
+	struct 	comment_struct *nextid;		/* next comment in the same id slot */
         }comment;
 
 
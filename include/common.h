@@ -319,6 +319,9 @@
 /* for disabled notifications expiry */
 #define CMD_DISABLE_NOTIFICATIONS_EXPIRE_TIME		176
 
+/* many passive check results in one file */
+#define CMD_PROCESS_CHECK_RESULT_FILE			177
+
 /* custom command introduced in Nagios 3.x */
 #define CMD_CUSTOM_COMMAND                              999
 
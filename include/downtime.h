@@ -35,6 +35,12 @@
   extern "C" {
 #endif
 
+/*************************** CHAINED HASH LIMITS ***************************/
+
+#define DOWNTIME_HASHSLOTS      1024		/* by host name */
+#define DOWNTIME_ID_HASHSLOTS   16384		/* by downtime id */
+
+
 /* SCHEDULED_DOWNTIME_ENTRY structure */
 typedef struct scheduled_downtime_struct{
 	int type;
@@ -57,6 +63,9 @@ typedef struct scheduled_downtime_struct{
 #endif
 	struct scheduled_downtime_struct *next;
 	time_t trigger_time;				/* needed to detect when a flexible downtime starts/triggers */
+	struct scheduled_downtime_struct *prev;
+	struct scheduled_downtime_struct *nexthash;	/* next downtime in the same host name slot */
+	struct scheduled_downtime_struct *nextid;	/* next downtime in the same id slot */
 	}scheduled_downtime;
 
 
@@ -102,6 +111,11 @@ scheduled_downtime *find_host_downtime(unsigned long);
 scheduled_downtime *find_service_downtime(unsigned long);
 scheduled_downtime *find_downtime_by_similar_content(int,char *,char *,char *,char *,time_t,time_t,int,unsigned long);
 
+scheduled_downtime *get_first_downtime_by_host(char *);
+scheduled_downtime *get_next_downtime_by_host(char *,scheduled_downtime *);
+
+int add_downtime_to_hashlist(scheduled_downtime *);
+
 void free_downtime_data(void);                                       /* frees memory allocated to scheduled downtime list */
 
 int delete_downtime_by_hostname_service_description_start_time_comment(char *,char *,time_t,char *);
@@ -36,6 +36,7 @@
 #include "locations.h"
 #include "objects.h"
 #include "macros.h"
+#include "minheap.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -147,6 +148,10 @@ extern "C" {
 
 #define DEFAULT_ALLOW_EMPTY_HOSTGROUP_ASSIGNMENT                0	/* Do not allow empty hostgroup assignment by default */
 
+#define DEFAULT_CHECK_WORKER_PROCESSES				0	/* number of persistent processes running active checks, 0 forks every check as before */
+#define DEFAULT_CHECK_RESULT_REAPER_THREADS			0	/* number of threads parsing check results, 0 parses them in the main thread */
+#define DEFAULT_MAX_ASYNC_COMMANDS				0	/* notifications, event handlers and OCSP/OCHP commands run by the check workers at once, 0 runs them in the core as before */
+
 #define DEFAULT_MAX_CHECK_RESULT_LIST_ITEMS              	0	/* max items in checkresult lists, where reaper will not process anymore files into the lists. 0 means *all* */
 
 /******************** HOST STATUS *********************/
@@ -299,11 +304,18 @@ typedef struct timed_event_struct{
 	void *event_data;
 	void *event_args;
 	int event_options;
-        struct timed_event_struct *next;
-        struct timed_event_struct *prev;
+	unsigned int queue_pos;				/* 1-based heap slot, 0 if not queued */
+	unsigned long queue_seq;			/* insertion order, keeps equal run times FIFO */
         }timed_event;
 
 
+/* TIMED_EVENT_QUEUE structure - binary min-heap ordered by run time */
+typedef struct timed_event_queue_struct{
+	minheap heap;
+	unsigned long next_seq;
+        }timed_event_queue;
+
+
 /* NOTIFY_LIST structure */
 typedef struct notify_list_struct{
 	contact *contact;
@@ -330,10 +342,46 @@ typedef struct check_result_struct{
 	int exited_ok;					/* did the plugin check return okay? */
 	int return_code;				/* plugin return code */
 	char *output;	                                /* plugin output */
+	int output_parsed;				/* has the output been parsed by a reaper thread? */
+	char *short_output;				/* parsed plugin output */
+	char *long_output;
+	char *perf_data;
 	struct check_result_struct *next;
+	unsigned long queue_seq;			/* keeps results with the same finish time in arrival order */
 	}check_result;
 
 
+/* CHECK_RESULT_QUEUE structure - binary min-heap ordered by finish time */
+typedef struct check_result_queue_struct{
+	minheap heap;
+	unsigned int high;				/* highest number of results ever queued */
+	unsigned long next_seq;
+	}check_result_queue;
+
+
+/* CHECK_DEADLINE_QUEUE structure - binary min-heap of host or service deadlines */
+typedef struct check_deadline_queue_struct{
+	minheap heap;
+	int built;					/* TRUE once all objects have been added */
+	}check_deadline_queue;
+
+
+/* ways check results get to the core */
+#define CHECK_RESULT_CHANNEL_SPOOL		0	/* files in check_result_path */
+#define CHECK_RESULT_CHANNEL_PIPE		1	/* forked checks, through the in-memory channel */
+#define CHECK_RESULT_CHANNEL_WORKER		2	/* check worker processes */
+#define CHECK_RESULT_CHANNEL_EXTCMD		3	/* passive results from external commands */
+
+#define CHECK_RESULT_CHANNELS			4
+
+#define CHECK_RESULT_CHANNEL_BUFFER_SIZE	4194304	/* socket buffer size requested for the in-memory channel */
+#define MAX_CHECK_RESULT_RECORD_LENGTH		262144	/* larger results are passed through the queue directory */
+
+#define CHECK_RESULT_REAPER_BATCH_SIZE		1024	/* results handed to the reaper threads at once */
+#define CHECK_RESULT_FILE_BATCH_SIZE		1024	/* results from a check result file added to the list at once */
+#define MAX_CHECK_RESULT_REAPER_THREADS		64
+
+
 /* SCHED_INFO structure */
 typedef struct sched_info_struct{
 	int total_services;
@@ -374,15 +422,18 @@ typedef struct passive_check_result_struct{
 	}passive_check_result;
 
 
-/* CIRCULAR_BUFFER structure - used by worker threads */
+/* CIRCULAR_BUFFER structure - ring of reusable slots filled by worker threads and emptied by the main thread without locking */
 typedef struct circular_buffer_struct{
-	void            **buffer;
-	int             tail;
-	int             head;
-	int             items;
+	char            **buffer;
+	int             *slot_size;	/* allocated size of each slot, slots are reused */
+	unsigned long   tail;		/* only moved by the consumer */
+	unsigned long   head;		/* only moved by the producer holding buffer_lock */
 	int		high;		/* highest number of items that has ever been stored in buffer */
-	unsigned long   overflow;
-	pthread_mutex_t buffer_lock;
+	unsigned long   overflow;	/* items that couldn't be stored */
+	pthread_mutex_t buffer_lock;	/* serializes producers */
+	pthread_mutex_t space_lock;
+	pthread_cond_t  space_cond;	/* signalled by the consumer when a full buffer gets room */
+	int             producer_waiting;
         }circular_buffer;
 
 
@@ -407,11 +458,27 @@ typedef struct check_stats_struct{
         }check_stats;
 
 
+/* used for tracking notification, event handler and OCSP/OCHP commands run by the check workers */
+typedef struct async_command_stats_struct{
+	int queued;					/* waiting for one of the max_async_commands slots */
+	int running;
+	int max_queued;					/* highest number of commands ever waiting */
+	unsigned long completed;
+	unsigned long timed_out;
+	double total_queue_latency;			/* seconds between queueing and starting */
+	double max_queue_latency;
+	double total_execution_time;
+        }async_command_stats;
+
+
 /******************* THREAD STUFF ********************/
 
 /* slots in circular buffers */
 #define DEFAULT_EXTERNAL_COMMAND_BUFFER_SLOTS     4096
 
+/* size of the buffer the command file worker thread read()s the command file into */
+#define EXTERNAL_COMMAND_READ_BUFFER_SIZE         (MAX_EXTERNAL_COMMAND_LENGTH * 16)
+
 /* worker threads */
 #define TOTAL_WORKER_THREADS              1
 
@@ -442,28 +509,38 @@ void display_scheduling_info(void);				/* displays service check scheduling info
 /**** Event Queue Functions ****/
 int schedule_new_event(int,int,time_t,int,unsigned long,void *,int,void *,void *,int);	/* schedules a new timed event */
 int delete_scheduled_event(int,int,time_t,int,unsigned long,void *,int,void *,void *,int);	/* delete a scheduled event */
-void reschedule_event(timed_event *,timed_event **,timed_event **);   		/* reschedules an event */
-void add_event(timed_event *,timed_event **,timed_event **);     		/* adds an event to the execution queue */
-void remove_event(timed_event *,timed_event **,timed_event **);     		/* remove an event from the execution queue */
+void reschedule_event(timed_event *,timed_event_queue *);   		/* reschedules an event */
+void add_event(timed_event *,timed_event_queue *);     			/* adds an event to the execution queue */
+void remove_event(timed_event *,timed_event_queue *);     		/* remove an event from the execution queue */
+timed_event *get_next_event(timed_event_queue *);			/* returns the event that will run first, without removing it */
+timed_event *pop_next_event(timed_event_queue *);			/* removes and returns the event that will run first */
+timed_event **get_sorted_event_list(timed_event_queue *);		/* returns a NULL-terminated, run time ordered copy of a queue */
+void free_event_queue(timed_event_queue *);				/* frees all events in a queue */
 int event_execution_loop(void);                      		/* main monitoring/event handler loop */
 int handle_timed_event(timed_event *);		     		/* top level handler for timed events */
 void adjust_check_scheduling(void);		        	/* auto-adjusts scheduling of host and service checks */
 void compensate_for_system_time_change(unsigned long,unsigned long);	/* attempts to compensate for a change in the system time */
 void adjust_timestamp_for_time_change(time_t,time_t,unsigned long,time_t *); /* adjusts a timestamp variable for a system time change */
-void resort_event_list(timed_event **,timed_event **);                 	/* resorts event list by event run time for system time changes */
+void resort_event_queue(timed_event_queue *);                 		/* resorts event queue by event run time for system time changes */
 
 
 /**** IPC Functions ****/
 int move_check_result_to_queue(char *);
+int open_check_result_channel(void);				/* creates the in-memory channel forked checks send their results through */
+int close_check_result_channel(void);				/* closes the in-memory check result channel */
+int submit_check_result(check_result *,char *);			/* sends a finished check result to the core, falling back to the queue directory */
+int read_check_result_channel(void);				/* moves results from the in-memory channel to the check result list */
 int process_check_result_queue(char *);
 int process_check_result_file(char *);
 int add_check_result_to_list(check_result *);
+int add_check_results_to_list(check_result **,int);
 check_result *read_check_result(void);                  	/* reads a host/service check result from the list in memory */
 int delete_check_result_file(char *);
 int free_check_result_list(void);
 int init_check_result(check_result *);
 int free_check_result(check_result *);                  	/* frees memory associated with a host/service check result */
 int parse_check_output(char *,char **,char **,char **,int,int);
+int get_parsed_check_output(check_result *,char **,char **,char **);	/* takes the output parsed by the reaper threads or parses it now */
 int open_command_file(void);					/* creates the external command file as a named pipe (FIFO) and opens it for reading */
 int close_command_file(void);					/* closes and deletes the external command file (FIFO) */
 
@@ -477,6 +554,11 @@ void check_service_result_freshness(void);              	/* checks the "freshnes
 int is_service_result_fresh(service *,time_t,int);              /* determines if a service's check results are fresh */
 void check_host_result_freshness(void);                 	/* checks the "freshness" of host check results */
 int is_host_result_fresh(host *,time_t,int);                    /* determines if a host's check results are fresh */
+void update_service_freshness_deadline(service *);		/* tells the freshness check when to look at a service again */
+void update_host_freshness_deadline(host *);			/* tells the freshness check when to look at a host again */
+void add_service_orphan_deadline(service *);			/* tells the orphan check when a running service check is overdue */
+void add_host_orphan_deadline(host *);				/* tells the orphan check when a running host check is overdue */
+void free_check_deadline_queues(void);
 int my_system(char *,int,int *,double *,char **,int);         	/* executes a command via popen(), but also protects against timeouts */
 int my_system_r(icinga_macros *mac, char *,int,int *,double *,char **,int); /* thread-safe version of the above */
 
@@ -526,6 +608,19 @@ int handle_host_state(host *);               			/* top level host state handler
 
 /**** Common Check Fucntions *****/
 int reap_check_results(void);
+int preparse_check_results(check_result **,int,int);		/* parses the output of a batch of check results in threads sharded by host */
+int shutdown_check_result_reaper_threads(void);			/* stops the threads preparse_check_results() has started */
+int parse_command_line(char *,char *[MAX_CMD_ARGS]);				/* splits a command line into arguments for exec* functions */
+
+
+/**** Check Worker Functions ****/
+int init_check_workers(void);					/* starts the check worker processes */
+int shutdown_check_workers(void);				/* stops the check worker processes */
+int check_worker_can_run(char *);				/* can a check worker run this command? */
+int submit_check_to_worker(check_result *,icinga_macros *,char *,int);	/* hands a check to a worker process */
+int read_check_worker_results(void);				/* moves results from the workers to the check result list */
+int run_async_command(icinga_macros *,char *,int,void (*)(void *,char *,int,int,double,struct timeval *,char *),void *);	/* queues a notification, event handler or OCSP/OCHP command for the workers */
+int handle_async_commands(void);				/* starts queued commands and completes the finished ones */
 
 
 /**** Check Statistics Functions ****/
@@ -599,6 +694,8 @@ extern int get_raw_command_line_r(icinga_macros *mac, command *,char *,char **,i
 extern int get_raw_command_line(command *,char *,char **,int);
 
 int check_time_against_period(time_t,timeperiod *);	/* check to see if a specific time is covered by a time period */
+int _check_time_against_period(time_t,timeperiod *);	/* same as above, without the precompiled time ranges */
+void invalidate_compiled_timeperiods(void);		/* drops the precompiled time ranges of all timeperiods */
 int is_daterange_single_day(daterange *);
 time_t calculate_time_from_weekday_of_month(int,int,int,int);	/* calculates midnight time of specific (3rd, last, etc.) weekday of a particular month */
 time_t calculate_time_from_day_of_month(int,int,int);	/* calculates midnight time of specific (1st, last, etc.) day of a particular month */
@@ -621,6 +718,7 @@ int check_for_external_commands(void);			/* checks for any external commands */
 int process_external_command1(char *);                  /* top-level external command processor */
 int process_external_command2(int,time_t,char *);	/* process an external command */
 int process_external_commands_from_file(char *,int);    /* process external commands in a file */
+int process_passive_check_result_file(char *,int);      /* process many passive check results in a file */
 int process_host_command(int,time_t,char *);            /* process an external host command */
 int process_hostgroup_command(int,time_t,char *);       /* process an external hostgroup command */
 int process_service_command(int,time_t,char *);         /* process an external service command */
@@ -648,6 +746,7 @@ int cmd_change_object_int_var(int,char *);                      /* changes host/
 int cmd_change_object_char_var(int,char *);			/* changes host/svc (char) variable */
 int cmd_change_object_custom_var(int,char *);                   /* changes host/svc custom variable */
 int cmd_process_external_commands_from_file(int,char *);        /* process external commands from a file */
+int cmd_process_passive_check_result_file(int,char *);                  /* process passive check results from a file */
 int cmd_delete_downtime_by_start_time_comment(int,char *);
 int cmd_delete_downtime_by_host_name(int,char *);
 int cmd_delete_downtime_by_hostgroup_name(int,char *);
@@ -732,6 +831,9 @@ void cleanup_command_file_worker_thread(void *);
 
 int submit_external_command(char *,int *);
 int submit_raw_external_command(char *,time_t *,int *);
+char *get_external_command(void);			/* returns the oldest buffered external command, if any */
+void release_external_command(void);			/* frees the slot of the command returned by get_external_command() */
+int get_external_command_buffer_items(void);
 
 char *get_program_version(void);
 char *get_program_modification_date(void);
@@ -0,0 +1,87 @@
+/*****************************************************************************
+ *
+ * LOGINDEX.H - Header file for log archive index functions
+ *
+ * Copyright (c) 2009-2013 Icinga Development Team (http://www.icinga.org)
+ *
+ * License:
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *****************************************************************************/
+
+#ifndef _LOGINDEX_H
+#define _LOGINDEX_H
+
+#include "readlogs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * the core writes <archive>.idx next to every log archive it rotates. the index holds
+ * one entry per log line with its timestamp, entry type and a hash of the host and
+ * service names, so the CGIs only have to read the lines they are going to use.
+ * archives without index get one in the CGIs' log_index_cache_path on first use.
+ * an index is only used if it was built from an archive of the same size and mtime.
+ */
+
+#define LOGINDEX_MAGIC          "ICLOGIX"
+#define LOGINDEX_VERSION        2
+#define LOGINDEX_SUFFIX         ".idx"
+
+#define LOGINDEX_SORTED         1	/* timestamps never decrease, entries can be searched by time */
+
+typedef struct logindex_header_struct {
+	char            magic[8];
+	unsigned int    version;
+	unsigned int    entry_size;
+	unsigned long   log_size;		/* size of the archive the index was built from */
+	unsigned long   log_mtime;		/* modification time of the archive */
+	unsigned long   entry_count;
+	unsigned long   first_timestamp;
+	unsigned long   last_timestamp;
+	int             flags;
+	} logindex_header;
+
+typedef struct logindex_entry_struct {
+	unsigned long   timestamp;
+	unsigned long   offset;			/* start of the line in the archive */
+	unsigned int    length;			/* length of the line, including its newline */
+	int             type;			/* LOGENTRY_* type */
+	unsigned int    host_hash;		/* 0 if the entry doesn't belong to a host */
+	unsigned int    service_hash;		/* 0 if the entry doesn't belong to a service */
+	} logindex_entry;
+
+typedef struct logindex_struct {
+	logindex_header *header;
+	logindex_entry  *entries;
+	unsigned long   size;
+	} logindex;
+
+int get_log_entry_type(char *);
+unsigned int get_log_object_hash(const char *, int);
+void get_log_entry_object_hashes(int, char *, unsigned int *, unsigned int *);
+
+int write_log_index(char *, char *);
+logindex *open_log_index(char *, char *);
+unsigned long find_log_index_entry(logindex *, time_t);
+void close_log_index(logindex *);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
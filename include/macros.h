@@ -58,6 +58,7 @@ struct icinga_macros {
 	customvariablesmember *custom_host_vars;
 	customvariablesmember *custom_service_vars;
 	customvariablesmember *custom_contact_vars;
+	struct macro_token_struct *command_tokens;	/* tokens of the last command line processed with process_command_macros_r() */
 };
 typedef struct icinga_macros icinga_macros;
 
@@ -76,9 +77,31 @@ struct nagios_macros {
         customvariablesmember *custom_host_vars;
         customvariablesmember *custom_service_vars;
         customvariablesmember *custom_contact_vars;
+        struct macro_token_struct *command_tokens;	/* tokens of the last command line processed with process_command_macros_r() */
 };
 typedef struct nagios_macros nagios_macros;
 
+
+/****************** MACRO TOKENS **********************/
+
+#define MACRO_TOKEN_TEXT			0	/* literal text (escaped $s included) */
+#define MACRO_TOKEN_MACRO			1	/* looked up by name with grab_macro_value_r() */
+#define MACRO_TOKEN_ARGV			2	/* $ARGn$ */
+#define MACRO_TOKEN_USER			3	/* $USERn$ */
+#define MACRO_TOKEN_X				4	/* standard macro without arguments */
+#define MACRO_TOKEN_CUSTOM			5	/* custom variable macro without arguments */
+
+/* a command line split into text and macros, so it doesn't have to be parsed for every check */
+typedef struct macro_token_struct{
+	int type;
+	char *text;				/* the text, or the macro name without $s */
+	int length;
+	int index;				/* argv/user macro number or MACRO_* code */
+	int clean_options;
+	int terminated;				/* FALSE if the string ended before the closing $ */
+	struct macro_token_struct *next;
+	}macro_token;
+
 #define MACRO_HOSTNAME				0
 #define MACRO_HOSTALIAS				1
 #define MACRO_HOSTADDRESS			2
@@ -257,6 +280,12 @@ int process_macros(char *, char **, int);
 /* thread-safe version of the above */
 int process_macros_r(icinga_macros *mac, char *,char **,int);
 
+/* precompiled macro strings */
+macro_token *compile_macro_tokens(char *);			/* splits a string into text and macro tokens */
+void free_macro_tokens(macro_token *);
+int process_macro_tokens_r(icinga_macros *mac, macro_token *,char **,int);
+int process_command_macros_r(icinga_macros *mac, command *,char **,int);	/* replaces the macros in a command's command line */
+
 /* cleans macros characters before insertion into output string */
 char *clean_macro_chars(char *,int);
 
@@ -351,6 +380,7 @@ int set_macrox_environment_vars_r(icinga_macros *mac, int);
 int set_argv_macro_environment_vars_r(icinga_macros *mac, int);
 int set_custom_macro_environment_vars_r(icinga_macros *mac, int);
 int set_contact_address_environment_vars_r(icinga_macros *mac, int);
+int set_referenced_macro_environment_vars_r(icinga_macros *mac, int);
 
 int set_macro_environment_var(char *,char *,int);
 #endif
@@ -0,0 +1,66 @@
+/*****************************************************************************
+ *
+ * MINHEAP.H - Header file for the binary min-heap used by the core queues
+ *
+ * Copyright (c) 2009-2013 Icinga Development Team (http://www.icinga.org)
+ *
+ * License:
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *****************************************************************************/
+
+#ifndef _MINHEAP_H
+#define _MINHEAP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * the event queues, the check result list and the check deadline queues are
+ * binary min-heaps of pointers. the heap knows nothing about the items: it asks
+ * comes_before() for their order and tells set_position() (if any) which slot
+ * an item moved to, so items can be found and moved without a search.
+ */
+
+typedef int (*minheap_compare_func)(void *, void *);		/* TRUE if the first item has to come out first */
+typedef void (*minheap_position_func)(void *, unsigned int);	/* new slot of an item, 0 once it left the heap */
+
+/* MINHEAP structure */
+typedef struct minheap_struct{
+	void **items;					/* items[1..count], items[0] unused */
+	unsigned int count;
+	unsigned int size;
+	minheap_compare_func comes_before;
+	minheap_position_func set_position;		/* may be NULL */
+	}minheap;
+
+
+void minheap_init(minheap *, minheap_compare_func, minheap_position_func);
+int minheap_reserve(minheap *, unsigned int);			/* makes room for more items, OK or ERROR */
+int minheap_insert(minheap *, void *);				/* OK, or ERROR if the heap can't grow */
+void minheap_update(minheap *, unsigned int);			/* restores heap order after the item in a slot changed */
+void *minheap_delete(minheap *, unsigned int);			/* removes and returns the item in a slot */
+void *minheap_peek(minheap *);					/* returns the first item without removing it */
+void *minheap_pop(minheap *);					/* removes and returns the first item */
+int minheap_contains(minheap *, void *, unsigned int);		/* TRUE if the item lives in the given slot */
+void minheap_heapify(minheap *);				/* restores heap order after many items changed */
+void minheap_free(minheap *);					/* frees the slots, not the items */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
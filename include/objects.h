@@ -77,6 +77,21 @@ extern int hc_compare(const char *field1, unsigned long hash1,
 #define SERVICEESCALATION_SKIPLIST             11
 #define MODULE_SKIPLIST                        12
 
+
+/***************** HASH INDEXES ****************/
+
+/* objects looked up by name on every check result, command and macro */
+#define NUM_OBJECT_HASHES                      5
+
+#define HOST_HASH                              0
+#define SERVICE_HASH                           1
+#define COMMAND_HASH                           2
+#define TIMEPERIOD_HASH                        3
+#define CONTACT_HASH                           4
+
+#define OBJECT_HASH_MIN_SIZE                   1024	/* always a power of two */
+#define OBJECT_HASH_PAIR(hash1, hash2)         ((hash1) * 31 + (hash2))
+
 /****************** DEFINITIONS *******************/
 /*#define VOLATILE_FALSE 0 - uses FALSE*/
 /*#define VOLATILE_TRUE  1 - uses TRUE */
@@ -94,6 +109,14 @@ typedef struct host_struct host;
 typedef struct service_struct service;
 typedef struct contact_struct contact;
 
+/* CHECK DEADLINE STRUCTURE - when the freshness or orphan checks have to look at a host or service again */
+typedef struct check_deadline_struct{
+	time_t    deadline;
+	unsigned int queue_pos;                             /* 1-based heap slot, 0 if not queued */
+	void      *object;
+	}check_deadline;
+
+
 /* OBJECT LIST STRUCTURE */
 typedef struct objectlist_struct{
 	void      *object_ptr;
@@ -145,6 +168,13 @@ typedef struct timeperiod_struct{
 	timeperiodexclusion *exclusions;
 	struct 	timeperiod_struct *next;
 	struct 	timeperiod_struct *nexthash;
+#ifdef NSCORE
+	time_t  compiled_start;			/* valid times between compiled_start and compiled_end are precompiled */
+	time_t  compiled_end;
+	time_t  *compiled_ranges;		/* start/end pairs, end excluded */
+	int     compiled_range_count;
+	int     compiled_range_size;
+#endif
 	}timeperiod;
 
 
@@ -193,6 +223,9 @@ typedef struct command_struct{
 	char    *command_line;
 	struct command_struct *next;
 	struct command_struct *nexthash;
+#ifdef NSCORE
+	struct macro_token_struct *macro_tokens;	/* command_line split into text and macros */
+#endif
         }command;
 
 
@@ -244,6 +277,8 @@ struct contact_struct{
 	timeperiod *host_notification_period_ptr;
 	timeperiod *service_notification_period_ptr;
 	objectlist *contactgroups_ptr;
+	int     status_dirty;                                /* changed since the last status file update */
+	int     retention_dirty;                             /* changed since the last retention data save */
 #endif
 	struct	contact_struct *next;
 	struct	contact_struct *nexthash;
@@ -424,6 +459,10 @@ struct host_struct{
 #ifdef NSCORE
 	int     current_down_notification_number;
 	int     current_unreachable_notification_number;
+	int     status_dirty;                                /* changed since the last status file update */
+	int     retention_dirty;                             /* changed since the last retention data save */
+	check_deadline freshness_deadline;
+	check_deadline orphan_deadline;
 #endif
 	DECLARE_HASH(name);
         };
@@ -569,6 +608,10 @@ struct service_struct{
 	int     current_warning_notification_number;
 	int     current_critical_notification_number;
 	int     current_unknown_notification_number;
+	int     status_dirty;                                /* changed since the last status file update */
+	int     retention_dirty;                             /* changed since the last retention data save */
+	check_deadline freshness_deadline;
+	check_deadline orphan_deadline;
 #endif
 	DECLARE_HASH(host_name);
 	DECLARE_HASH(description);
@@ -732,6 +775,21 @@ typedef struct module_struct{
 
 /****************** HASH STRUCTURES ********************/
 
+/* open addressing, the hash is kept next to the object so probes and rehashing don't touch the names */
+typedef struct object_hash_entry_struct{
+	unsigned long hash;
+	void    *object;
+        }object_hash_entry;
+
+typedef struct object_hash_struct{
+	object_hash_entry *entries;
+	unsigned long size;
+	unsigned long items;
+	unsigned long lookups;
+	unsigned long misses;
+	double  elapsed;
+        }object_hash;
+
 typedef struct host_cursor_struct{
 	int     host_hashchain_iterator;
 	host    *current_host_pointer;
@@ -798,6 +856,12 @@ int add_module_objects_to_neb(void);									/* add modules to neb, backwards co
 /*** Object Skiplist Functions ****/
 int init_object_skiplists(void);
 int free_object_skiplists(void);
+
+/*** Object Hash Index Functions ****/
+int init_object_hashes(void);
+int free_object_hashes(void);
+int add_object_to_hash(int,unsigned long,void *);
+int get_object_hash_stats(int,unsigned long *,unsigned long *,double *);
 int skiplist_compare_text(const char *val1a, const char *val1b, const char *val2a, const char *val2b);
 int skiplist_compare_host(void *a, void *b);
 int skiplist_compare_service(void *a, void *b);
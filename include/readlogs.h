@@ -130,6 +130,8 @@ typedef struct logentry_struct {
 typedef struct logentry_filter {
 	int	include;		/**< type of log entry which should be included -> LOG ENTRY TYPES */
 	int	exclude;		/**< type of log entry which should be excluded -> LOG ENTRY TYPES */
+	unsigned int host_hash;		/**< hash of the host log entries should belong to, 0 for type filters */
+	unsigned int service_hash;	/**< hash of the service log entries should belong to, 0 for all services */
 	struct	logentry_filter *next;	/**< next logentry_filter */
 	}logfilter;
 
@@ -138,6 +140,8 @@ typedef struct logentry_filter {
     @{ **/
 int sort_icinga_logfiles_by_name(const void *a_in, const void *b_in);
 int add_log_filter(logfilter **filter_list, int requested_filter, int include_exclude);
+int add_log_object_filter(logfilter **filter_list, char *host_name, char *service_description);
+int check_log_entry_type(logfilter *filter_list, int type);
 int get_log_entries(logentry **entry_list, logfilter **filter_list, char **error_text, char *search_string, int reverse, time_t ts_start, time_t ts_end);
 void free_log_filters(logfilter **filter_list);
 void free_log_entries(logentry **entry_list);
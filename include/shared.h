@@ -48,6 +48,7 @@ extern int mmap_fclose(mmapfile *temp_mmapfile);
 extern char *mmap_fgets(mmapfile *temp_mmapfile);
 extern char *mmap_fgets_multiline(mmapfile * temp_mmapfile);
 extern void strip(char *buffer);
+extern char *unescape_newlines(char *rawbuf);
 extern unsigned long sdbm(const char *str);
 extern int hashfunc(const char *name1, const char *name2, int hashslots);
 extern int compare_hashdata(const char *val1a, const char *val1b, const char *val2a,
@@ -56,5 +57,9 @@ extern void get_datetime_string(time_t *raw_time, char *buffer,
 				int buffer_length, int type);
 extern void get_time_breakdown(unsigned long raw_time, int *days, int *hours,
 				   int *minutes, int *seconds);
+
+/* common/extcmd_list.c */
+extern const char *extcmd_get_name(int id);
+extern int extcmd_get_id(const char *name);
 #endif
 
@@ -203,6 +203,11 @@ typedef struct servicestatus_struct{
 int read_status_data(char *,int);                       /* reads all status data */
 int add_host_status(hoststatus *);                      /* adds a host status entry to the list in memory */
 int add_service_status(servicestatus *);                /* adds a service status entry to the list in memory */
+int replace_host_status(hoststatus *);                  /* replaces a host status entry in memory, adds it if it doesn't exist */
+int replace_service_status(servicestatus *);            /* replaces a service status entry in memory, adds it if it doesn't exist */
+int add_indexed_host_status(hoststatus **,unsigned long,unsigned long *,unsigned long *);           /* adds host status entries with precomputed hash chains */
+int add_indexed_service_status(servicestatus **,unsigned long,unsigned long *,unsigned long *);     /* adds service status entries with precomputed hash chains */
+int set_status_data_mapping(void *,size_t);             /* registers the mapped binary status snapshot the status strings point into */
 
 int add_hoststatus_to_hashlist(hoststatus *);
 int add_servicestatus_to_hashlist(servicestatus *);
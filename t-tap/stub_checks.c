@@ -1,3 +1,5 @@
 void schedule_host_check(host *hst, time_t check_time, int options) {}
 void schedule_service_check(service *svc, time_t check_time, int options) {}
+void update_service_freshness_deadline(service *svc) {}
+void update_host_freshness_deadline(host *hst) {}
 
@@ -1,3 +1,9 @@
 /* Stub for common/shared.c */
 void get_datetime_string(time_t * raw_time, char *buffer, int buffer_length, int type) {}
 
+int hashfunc(const char *name1, const char *name2, int hashslots) {
+	return 0;
+}
+int compare_hashdata(const char *val1a, const char *val1b, const char *val2a, const char *val2b) {
+	return strcmp(val1a, val2a);
+}
@@ -2,5 +2,8 @@
 void get_next_valid_time(time_t pref_time, time_t *valid_time, timeperiod *tperiod) {}
 int update_check_stats(int check_type, time_t check_time) {}
 int move_check_result_to_queue(char *checkresult_file) {}
+int init_check_result(check_result *info) {}
+int add_check_result_to_list(check_result *new_cr) {}
+int free_check_result(check_result *info) {}
 int check_time_against_period(time_t test_time, timeperiod *tperiod) {}
 
@@ -77,7 +77,7 @@ int check_for_expired_downtime(void) {}
 time_t get_next_service_notification_time(service *temp_service, time_t time_t1) {}
 int save_state_information(int int1) {}
 int check_for_external_commands(void) {}
-int check_time_against_period(time_t time_t1, timeperiod *timeperiod) {}
+int check_time_against_period(time_t time_t1, timeperiod *timeperiod) { return OK; }
 time_t get_next_log_rotation_time(void) {}
 int handle_scheduled_downtime_by_id(unsigned long long1) {}
 #ifndef TEST_LOGGING
@@ -141,6 +141,7 @@ int clear_host_macros_r(icinga_macros *mac) {}
 
 int process_macros(char *a, char **b, int c) {}
 int process_macros_r(icinga_macros *mac, char *a, char **b, int c) {}
+int process_command_macros_r(icinga_macros *mac, command *a, char **b, int c) {}
 
 int update_host_status(host *hst, int aggregated_dump) {}
 int update_service_status(service *svc, int aggregated_dump) {}
@@ -158,7 +159,13 @@ int get_raw_command_line(command *a, char *b, char **c, int d) {}
 int get_raw_command_line_r(icinga_macros *mac, command *a, char *b, char **c, int d) {}
 check_result    check_result_info;
 char *temp_path;
-int dbuf_init(dbuf *db, int chunk_size) {}
+int dbuf_init(dbuf *db, int chunk_size) {
+	db->buf = NULL;
+	db->used_size = 0L;
+	db->allocated_size = 0L;
+	db->chunk_size = chunk_size;
+	return OK;
+}
 int update_check_stats(int check_type, time_t check_time) {}
 int set_all_macro_environment_vars(int set) {}
 int set_all_macro_environment_vars_r(icinga_macros *mac, int set) {}
@@ -169,11 +176,34 @@ unsigned long   max_debug_file_size = DEFAULT_MAX_DEBUG_FILE_SIZE;
 int             host_check_timeout = DEFAULT_HOST_CHECK_TIMEOUT;
 int broker_host_check(int type, int flags, int attr, host *hst, int check_type, int state, int state_type, struct timeval start_time, struct timeval end_time, char *cmd, double latency, double exectime, int timeout, int early_timeout, int retcode, char *cmdline, char *output, char *long_output, char *perfdata, struct timeval *timestamp) {}
 char *escape_newlines(char *rawbuf) {}
-int dbuf_strcat(dbuf *db, char *buf) {}
-int dbuf_free(dbuf *db) {}
+int dbuf_strcat(dbuf *db, char *buf) {
+	unsigned long buflen = strlen(buf);
+	if (db->allocated_size < db->used_size + buflen + 1) {
+		db->allocated_size = db->used_size + buflen + 1 + db->chunk_size;
+		db->buf = (char *)realloc(db->buf, db->allocated_size);
+	}
+	strcpy(db->buf + db->used_size, buf);
+	db->used_size += buflen;
+	return OK;
+}
+int dbuf_free(dbuf *db) {
+	free(db->buf);
+	db->buf = NULL;
+	db->used_size = 0L;
+	db->allocated_size = 0L;
+	return OK;
+}
 unsigned long   next_event_id = 0L;
 unsigned long   next_problem_id = 0L;
 int move_check_result_to_queue(char *checkresult_file) {}
+int submit_check_result(check_result *info, char *output) {}
+int read_check_result_channel(void) {}
+int init_check_result(check_result *info) {}
+int check_worker_can_run(char *processed_command) {}
+int submit_check_to_worker(check_result *cr, icinga_macros *mac, char *processed_command, int timeout) {}
+int read_check_worker_results(void) {}
+int add_check_result_to_list(check_result *new_cr) {}
+int             check_result_reaper_threads = DEFAULT_CHECK_RESULT_REAPER_THREADS;
 int             free_child_process_memory = -1;
 void free_memory(icinga_macros *mac) {}
 int accept_passive_service_checks = TRUE;
@@ -196,10 +226,9 @@ int compare_strings(char *val1a, char *val2a) {}
 int update_service_performance_data(service *svc) {}
 int free_objectlist(objectlist **temp_list) {}
 unsigned long   cached_service_check_horizon = DEFAULT_CACHED_SERVICE_CHECK_HORIZON;
-timed_event *event_list_low = NULL;
-timed_event *event_list_low_tail = NULL;
-void remove_event(timed_event *event, timed_event **event_list, timed_event **event_list_tail) {}
-void reschedule_event(timed_event *event, timed_event **event_list, timed_event **event_list_tail) {}
+timed_event_queue event_queue_low;
+void remove_event(timed_event *event, timed_event_queue *event_queue) {}
+void reschedule_event(timed_event *event, timed_event_queue *event_queue) {}
 int process_passive_service_check(time_t check_time, char *host_name, char *svc_description, int return_code, char *output) {}
 void process_passive_checks(void) {}
 int             soft_state_dependencies = FALSE;
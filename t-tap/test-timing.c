@@ -0,0 +1,13 @@
+#ifndef ICINGA_TEST_TIMING__
+#define ICINGA_TEST_TIMING__
+#include <sys/time.h>
+
+/* seconds passed since start, the benchmarks print it with diag() */
+double elapsed_seconds(struct timeval *start) {
+	struct timeval end;
+
+	gettimeofday(&end, NULL);
+	return (double)(end.tv_sec - start->tv_sec) + ((double)(end.tv_usec - start->tv_usec) / 1000000.0);
+}
+
+#endif
@@ -27,6 +27,7 @@
 #include "broker.h"
 #include "perfdata.h"
 #include "tap.h"
+#include "test-timing.c"
 #include "test-stubs.c"
 #include "stub_sehandlers.c"
 #include "stub_comments.c"
@@ -162,12 +163,182 @@ setup_objects(time_t time) {
 
 }
 
+void
+test_parse_check_output(void) {
+	char *short_output = NULL;
+	char *long_output = NULL;
+	char *perf_data = NULL;
+	char *buf = NULL;
+
+	buf = strdup("DISK OK - free space|/=2643MB;5948;5958;0;5968\\n/ 15272 MB (77%);\\n/boot 68 MB (69%);|/boot=68MB;88;93;0;98\\n/home=69357MB;253404;253409;0;253414");
+	parse_check_output(buf, &short_output, &long_output, &perf_data, TRUE, TRUE);
+	ok(short_output && !strcmp(short_output, "DISK OK - free space"), "short output parsed") || diag("short_output=%s", short_output);
+	ok(long_output && !strcmp(long_output, "/ 15272 MB (77%);\\n/boot 68 MB (69%);"), "long output parsed") || diag("long_output=%s", long_output);
+	ok(perf_data && !strcmp(perf_data, "/=2643MB;5948;5958;0;5968/boot=68MB;88;93;0;98 /home=69357MB;253404;253409;0;253414"), "perf data parsed") || diag("perf_data=%s", perf_data);
+	free(buf);
+	free(short_output);
+	free(long_output);
+	free(perf_data);
+
+	buf = strdup("PING OK\\n|rta=0.1ms");
+	parse_check_output(buf, &short_output, &long_output, &perf_data, TRUE, TRUE);
+	ok(long_output == NULL && perf_data && !strcmp(perf_data, "rta=0.1ms"), "perf data on a line of its own") || diag("perf_data=%s", perf_data);
+	free(buf);
+	free(short_output);
+	free(perf_data);
+}
+
+/* counts the threads of this process */
+int
+count_threads(void) {
+	DIR *dirp = NULL;
+	struct dirent *dirfile = NULL;
+	int count = 0;
+
+	if ((dirp = opendir("/proc/self/task")) == NULL)
+		return -1;
+	while ((dirfile = readdir(dirp)) != NULL) {
+		if (dirfile->d_name[0] != '.')
+			count++;
+	}
+	closedir(dirp);
+	return count;
+}
+
+void
+benchmark_check_result_reaper(int num_results, int num_hosts) {
+	check_result **results = NULL;
+	char host_name[32];
+	struct timeval start;
+	double elapsed = 0.0;
+	int threads[] = { 1, 2, 4, 8 };
+	int parsed = 0;
+	int thread_count = 0;
+	int x, y;
+
+	results = (check_result **)malloc(num_results * sizeof(check_result *));
+
+	for (y = 0; y < sizeof(threads) / sizeof(threads[0]); y++) {
+
+		for (x = 0; x < num_results; x++) {
+			results[x] = (check_result *)calloc(1, sizeof(check_result));
+			snprintf(host_name, sizeof(host_name), "host%d", x % num_hosts);
+			results[x]->host_name = strdup(host_name);
+			results[x]->output = strdup("HTTP OK: HTTP/1.1 200 OK - 5423 bytes in 0.012 second response time|time=0.012345s;1.000000;2.000000;0.000000 size=5423B;;;0\\nConnected to 127.0.0.1:80\\nRequest: GET / HTTP/1.1\\nResponse: 200 OK\\nContent-Type: text/html|bytes=5423;;;0\\nheaders=12;;;0");
+		}
+
+		gettimeofday(&start, NULL);
+		for (x = 0; x < num_results; x += CHECK_RESULT_REAPER_BATCH_SIZE)
+			preparse_check_results(&results[x], (num_results - x < CHECK_RESULT_REAPER_BATCH_SIZE) ? num_results - x : CHECK_RESULT_REAPER_BATCH_SIZE, threads[y]);
+		elapsed = elapsed_seconds(&start);
+		if (threads[y] == 8)
+			thread_count = count_threads();
+
+		for (x = 0, parsed = 0; x < num_results; x++) {
+			if (results[x]->output_parsed == TRUE && results[x]->perf_data && !strcmp(results[x]->perf_data, "time=0.012345s;1.000000;2.000000;0.000000 size=5423B;;;0bytes=5423;;;0 headers=12;;;0"))
+				parsed++;
+			free(results[x]->host_name);
+			free(results[x]->output);
+			free(results[x]->short_output);
+			free(results[x]->long_output);
+			free(results[x]->perf_data);
+			free(results[x]);
+		}
+
+		ok(parsed == num_results, "%d reaper thread(s) parsed all %d results", threads[y], num_results) || diag("parsed=%d", parsed);
+		diag("%d reaper thread(s): %.0f results/second", threads[y], (elapsed > 0.0) ? num_results / elapsed : 0.0);
+	}
+
+	/* the threads are kept between batches and joined at shutdown */
+	shutdown_check_result_reaper_threads();
+	ok(thread_count == 9 && count_threads() == 1, "Reaper threads are kept between batches and stopped at shutdown") || diag("threads=%d after=%d", thread_count, count_threads());
+
+	free(results);
+}
+
+/* checks that the freshness and orphan checks only pick up the services whose deadline has passed */
+void
+test_check_deadlines(int num_services, int rounds) {
+	service *services = NULL;
+	struct timeval start;
+	time_t now = 0L;
+	int freshened = 0;
+	int x = 0;
+
+	time(&now);
+
+	services = (service *)calloc(num_services, sizeof(service));
+	for (x = 0; x < num_services; x++) {
+		services[x].host_name = "host1";
+		services[x].description = "passive service";
+		services[x].check_freshness = TRUE;
+		services[x].freshness_threshold = 3600;
+		services[x].accept_passive_service_checks = TRUE;
+		services[x].has_been_checked = TRUE;
+		services[x].last_check = (x % 1000 == 999) ? now - 7200 : now;
+		services[x].next = (x + 1 < num_services) ? &services[x + 1] : NULL;
+	}
+	service_list = services;
+	check_service_freshness = TRUE;
+
+	check_service_result_freshness();
+	for (x = 0, freshened = 0; x < num_services; x++) {
+		if (services[x].is_being_freshened == TRUE)
+			freshened++;
+	}
+	ok(freshened == num_services / 1000 && services[999].is_being_freshened == TRUE, "Stale services are freshened") || diag("freshened=%d", freshened);
+
+	/* the freshened services got their results, another one goes stale */
+	for (x = 999; x < num_services; x += 1000) {
+		services[x].is_being_freshened = FALSE;
+		services[x].last_check = now;
+		update_service_freshness_deadline(&services[x]);
+	}
+	services[1].last_check = now - 7200;
+	update_service_freshness_deadline(&services[1]);
+
+	gettimeofday(&start, NULL);
+	for (x = 0; x < rounds; x++)
+		check_service_result_freshness();
+	diag("%d freshness checks of %d services in %.3fs", rounds, num_services, elapsed_seconds(&start));
+
+	for (x = 0, freshened = 0; x < num_services; x++) {
+		if (services[x].is_being_freshened == TRUE)
+			freshened++;
+	}
+	ok(freshened == 1 && services[1].is_being_freshened == TRUE, "Only the service that went stale is freshened") || diag("freshened=%d", freshened);
+
+	/* one check is overdue, the other one is still running */
+	services[2].is_executing = TRUE;
+	services[2].next_check = now - 7200;
+	add_service_orphan_deadline(&services[2]);
+	services[3].is_executing = TRUE;
+	services[3].next_check = now;
+	add_service_orphan_deadline(&services[3]);
+	currently_running_service_checks = 2;
+
+	check_for_orphaned_services();
+	ok(services[2].is_executing == FALSE && services[3].is_executing == TRUE && currently_running_service_checks == 1, "Only the overdue service check is orphaned");
+
+	free_check_deadline_queues();
+	service_list = NULL;
+	free(services);
+}
+
 int
 main(int argc, char **argv) {
 	time_t now = 0L;
 
-	/* FIXME disabled until further debugging */
-	return 0;
+	plan(12);
+
+	test_parse_check_output();
+
+	benchmark_check_result_reaper(200000, 1000);
+
+	test_check_deadlines(150000, 100);
+
+	/* FIXME the check result handling tests below are disabled until further debugging */
+	return exit_status();
 
 	plan(42);
 
@@ -21,9 +21,16 @@
 #include "common.h"
 #include "icinga.h"
 #include "../base/commands.c"
+#include "../base/cmdbuffer.c"
+#include "../common/extcmd_list.c"
 #include "stub_broker.c"
 #include "stub_comments.c"
+/* the check result file tests need host and service lookups that find something */
+#define find_host stub_find_host
+#define find_service stub_find_service
 #include "stub_objects.c"
+#undef find_host
+#undef find_service
 #include "stub_statusdata.c"
 #include "stub_notifications.c"
 #include "stub_events.c"
@@ -34,16 +41,27 @@
 #include "stub_sretention.c"
 #include "stub_checks.c"
 #include "tap.h"
+#include "test-timing.c"
+
+int processed_commands = 0;
 
 void logit(int data_type, int display, const char *fmt, ...) {}
+int write_to_log(char *buffer, unsigned long data_type, time_t *timestamp) {}
 int log_debug_info(int level, int verbosity, const char *fmt, ...) {
 	va_list ap;
 	va_start(ap, fmt);
 	/* vprintf( fmt, ap ); */
+	if (!strncmp(fmt, "Raw", 3))
+		processed_commands++;
 	va_end(ap);
 }
 
+int sigrestart = FALSE;
+unsigned long logging_options;
+int command_file_fd;
+pthread_t worker_threads[TOTAL_WORKER_THREADS];
 circular_buffer external_command_buffer;
+unsigned long check_result_channel_stats[CHECK_RESULT_CHANNELS];
 time_t last_command_check;
 int external_command_buffer_slots;
 char *temp_path;
@@ -114,11 +132,262 @@ void reset_vars() {
 
 hostgroup *temp_hostgroup = NULL;
 
+/* hosts and services the check result file tests submit results for */
+host test_hosts[3];
+service test_services[3];
+int host_lookups = 0;
+int result_batches = 0;
+int results_in_batches = 0;
+int largest_batch = 0;
+int results_before_commands = 0;
+int bad_results = 0;
+
+host *find_host(char *name) {
+	host *temp_host = NULL;
+
+	host_lookups++;
+	for (temp_host = host_list; temp_host != NULL; temp_host = temp_host->next) {
+		if (!strcmp(temp_host->name, name))
+			return temp_host;
+	}
+	return NULL;
+}
+
+service *find_service(char *host_name, char *svc_desc) {
+	int x;
+
+	for (x = 0; x < 3 && host_list != NULL; x++) {
+		if (!strcmp(test_services[x].host_name, host_name) && !strcmp(test_services[x].description, svc_desc))
+			return &test_services[x];
+	}
+	return NULL;
+}
+
+int add_check_results_to_list(check_result **new_results, int count) {
+	int x;
+
+	result_batches++;
+	results_in_batches += count;
+	if (count > largest_batch)
+		largest_batch = count;
+	if (processed_commands == 0)
+		results_before_commands += count;
+
+	for (x = 0; x < count; x++) {
+		if (new_results[x]->object_check_type == SERVICE_CHECK) {
+			if (new_results[x]->check_type != SERVICE_CHECK_PASSIVE || new_results[x]->service_description == NULL || new_results[x]->return_code != STATE_WARNING || strcmp(new_results[x]->output, "WARNING - disk 91% full|disk=91%"))
+				bad_results++;
+		} else if (new_results[x]->check_type != HOST_CHECK_PASSIVE || new_results[x]->service_description != NULL || new_results[x]->return_code != HOST_DOWN || strcmp(new_results[x]->output, "PING CRITICAL"))
+			bad_results++;
+		if (new_results[x]->start_time.tv_sec != 1234567890L)
+			bad_results++;
+		my_free(new_results[x]->host_name);
+		my_free(new_results[x]->service_description);
+		my_free(new_results[x]->output);
+		my_free(new_results[x]);
+	}
+	return OK;
+}
+
+/* writes passive check results to the command file like a busy gateway would */
+void *
+write_commands(void *arg) {
+	char buffer[65536];
+	int num_commands = *(int *)arg;
+	int used = 0;
+	int written = 0;
+	int result = 0;
+	int x;
+
+	for (x = 0; x < num_commands; x++) {
+		used += snprintf(buffer + used, sizeof(buffer) - used, "[%lu] PROCESS_SERVICE_CHECK_RESULT;host%d;service%d;0;OK - everything is fine|time=0.001s;;;0\n", (unsigned long)time(NULL), x % 1000, x);
+		if (used > sizeof(buffer) - 256 || x == num_commands - 1) {
+			for (written = 0; written < used; written += result) {
+				if ((result = write(command_file_fd + 1, buffer + written, used - written)) <= 0)
+					return NULL;
+			}
+			used = 0;
+		}
+	}
+
+	return NULL;
+}
+
+/* what the core used to do: compare the name against every command in turn */
+int
+linear_extcmd_get_id(const char *name) {
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(in_core_commands); i++) {
+		if (!strcmp(in_core_commands[i].name, name))
+			return (in_core_commands[i].cgi_only == TRUE) ? CMD_NONE : in_core_commands[i].id;
+	}
+
+	return CMD_NONE;
+}
+
+void
+test_extcmd_lookup(int num_lookups) {
+	/* command mix of a setup fed by passive check gateways */
+	char *mix[20] = {
+		"PROCESS_SERVICE_CHECK_RESULT", "PROCESS_SERVICE_CHECK_RESULT", "PROCESS_SERVICE_CHECK_RESULT", "PROCESS_SERVICE_CHECK_RESULT",
+		"PROCESS_SERVICE_CHECK_RESULT", "PROCESS_SERVICE_CHECK_RESULT", "PROCESS_SERVICE_CHECK_RESULT", "PROCESS_SERVICE_CHECK_RESULT",
+		"PROCESS_SERVICE_CHECK_RESULT", "PROCESS_SERVICE_CHECK_RESULT", "PROCESS_SERVICE_CHECK_RESULT", "PROCESS_SERVICE_CHECK_RESULT",
+		"PROCESS_HOST_CHECK_RESULT", "PROCESS_HOST_CHECK_RESULT", "ACKNOWLEDGE_SVC_PROBLEM", "ACKNOWLEDGE_HOST_PROBLEM",
+		"SCHEDULE_FORCED_SVC_CHECK", "SCHEDULE_SVC_DOWNTIME", "ADD_SVC_COMMENT", "DEL_SVC_COMMENT"
+	};
+	struct timeval start;
+	double linear_time = 0.0;
+	double sorted_time = 0.0;
+	int mismatches = 0;
+	int sum = 0;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(in_core_commands); i++) {
+		if (extcmd_get_id(in_core_commands[i].name) != ((in_core_commands[i].cgi_only == TRUE) ? CMD_NONE : in_core_commands[i].id))
+			mismatches++;
+	}
+	ok(mismatches == 0, "All %d command names found", (int)ARRAY_SIZE(in_core_commands)) || diag("mismatches=%d", mismatches);
+	ok(extcmd_get_id("PROCESS_SERVICE_CHECK_RESULT") == CMD_PROCESS_SERVICE_CHECK_RESULT && extcmd_get_id("ACKNOWLEDGE_SVC_PROBLEM") == CMD_ACKNOWLEDGE_SVC_PROBLEM, "Passive check and acknowledgement commands found");
+	ok(extcmd_get_id("ENTER_STANDBY_MODE") == CMD_DISABLE_NOTIFICATIONS && extcmd_get_id("RESTART_PROGRAM") == CMD_RESTART_PROCESS, "Old command names still accepted");
+	ok(extcmd_get_id("CANCEL_HOST_DOWNTIME") == CMD_NONE && extcmd_get_id("NONE") == CMD_NONE && extcmd_get_id("NO_SUCH_COMMAND") == CMD_NONE && extcmd_get_id("") == CMD_NONE, "Unknown and CGI only commands refused");
+	ok(!strcmp(extcmd_get_name(CMD_DISABLE_NOTIFICATIONS), "DISABLE_NOTIFICATIONS"), "Names of commands with old names are the new ones");
+
+	gettimeofday(&start, NULL);
+	for (i = 0; i < num_lookups; i++)
+		sum += linear_extcmd_get_id(mix[i % 20]);
+	linear_time = elapsed_seconds(&start);
+
+	gettimeofday(&start, NULL);
+	for (i = 0; i < num_lookups; i++)
+		sum -= extcmd_get_id(mix[i % 20]);
+	sorted_time = elapsed_seconds(&start);
+
+	ok(sum == 0, "Both lookups agree on the command mix");
+	diag("%d lookups: %.3f seconds comparing every name, %.3f seconds with binary search", num_lookups, linear_time, sorted_time);
+}
+
+/* writes a check result file and feeds it to PROCESS_CHECK_RESULT_FILE */
+void
+test_check_result_file(int results_per_service) {
+	char fname[] = "/tmp/icinga_check_results_XXXXXX";
+	char command[128];
+	FILE *fp = NULL;
+	int fd = -1;
+	int x, y;
+
+	for (x = 0; x < 3; x++) {
+		memset(&test_hosts[x], 0, sizeof(host));
+		asprintf(&test_hosts[x].name, "host%d", x);
+		asprintf(&test_hosts[x].address, "10.0.0.%d", x);
+		test_hosts[x].address6 = test_hosts[x].address;
+		test_hosts[x].accept_passive_host_checks = TRUE;
+		test_hosts[x].next = (x < 2) ? &test_hosts[x + 1] : NULL;
+		memset(&test_services[x], 0, sizeof(service));
+		test_services[x].host_name = test_hosts[x].name;
+		test_services[x].description = "disk";
+		test_services[x].accept_passive_service_checks = TRUE;
+	}
+	host_list = &test_hosts[0];
+	accept_passive_service_checks = TRUE;
+	accept_passive_host_checks = TRUE;
+
+	if ((fd = mkstemp(fname)) < 0 || (fp = fdopen(fd, "w")) == NULL) {
+		ok(0, "Created check result file");
+		return;
+	}
+
+	/* results grouped by host, the host with the address instead of its name */
+	for (x = 0; x < 3; x++) {
+		for (y = 0; y < results_per_service; y++) {
+			if (x == 2)
+				fprintf(fp, "[1234567890] PROCESS_SERVICE_CHECK_RESULT;10.0.0.2;disk;1;WARNING - disk 91%% full|disk=91%%\n");
+			else
+				fprintf(fp, "[1234567890] PROCESS_SERVICE_CHECK_RESULT;host%d;disk;1;WARNING - disk 91%% full|disk=91%%\n", x);
+		}
+	}
+	fprintf(fp, "\n# unknown hosts and services are skipped\n");
+	fprintf(fp, "[1234567890] PROCESS_SERVICE_CHECK_RESULT;nosuchhost;disk;1;WARNING - disk 91%% full|disk=91%%\n");
+	fprintf(fp, "[1234567890] PROCESS_SERVICE_CHECK_RESULT;host0;nosuchservice;1;WARNING - disk 91%% full|disk=91%%\n");
+	/* other commands are run after the results that came before them */
+	fprintf(fp, "[1234567890] DISABLE_NOTIFICATIONS\n");
+	fprintf(fp, "[1234567890] PROCESS_HOST_CHECK_RESULT;host0;1;PING CRITICAL\n");
+	fclose(fp);
+
+	processed_commands = 0;
+	host_lookups = 0;
+	enable_notifications = TRUE;
+	snprintf(command, sizeof(command), "%s;1", fname);
+	ok(cmd_process_passive_check_result_file(CMD_PROCESS_CHECK_RESULT_FILE, command) == OK, "PROCESS_CHECK_RESULT_FILE processed");
+
+	ok(results_in_batches == (3 * results_per_service) + 1 && bad_results == 0, "All results in the file reached the check result list") || diag("results=%d bad=%d", results_in_batches, bad_results);
+	ok(largest_batch == CHECK_RESULT_FILE_BATCH_SIZE && result_batches == ((3 * results_per_service) / CHECK_RESULT_FILE_BATCH_SIZE) + 2, "Results were added in batches") || diag("batches=%d largest=%d", result_batches, largest_batch);
+	/* host0, host1, 10.0.0.2 (found by its address), nosuchhost and host0 again */
+	ok(host_lookups == 5, "Hosts were only looked up when the host name changed") || diag("lookups=%d", host_lookups);
+	ok(processed_commands == 1 && results_before_commands == 3 * results_per_service && enable_notifications == FALSE, "Results before another command were flushed before it ran") || diag("processed=%d results_before_commands=%d", processed_commands, results_before_commands);
+	ok(access(fname, F_OK) != 0, "Check result file deleted");
+
+	host_list = NULL;
+	for (x = 0; x < 3; x++) {
+		my_free(test_hosts[x].name);
+		my_free(test_hosts[x].address);
+	}
+}
+
+void
+stress_external_commands(int num_commands) {
+	pthread_t writer;
+	struct timeval start;
+	double elapsed = 0.0;
+	int pipe_fds[2];
+	int buffer_items = 0;
+	int x;
+
+	/* the write end of the pipe is command_file_fd + 1 */
+	if (pipe(pipe_fds) != 0 || pipe_fds[1] != pipe_fds[0] + 1) {
+		ok(0, "Created command pipe");
+		return;
+	}
+	fcntl(pipe_fds[0], F_SETFL, O_NONBLOCK);
+	command_file_fd = pipe_fds[0];
+
+	check_external_commands = TRUE;
+	external_command_buffer_slots = 256;
+	ok(init_command_file_worker_thread() == OK, "Command file worker thread started");
+
+	/* commands submitted by modules are refused once the buffer is full */
+	for (x = 0; x < external_command_buffer_slots; x++)
+		submit_raw_external_command("ENABLE_NOTIFICATIONS", NULL, &buffer_items);
+	ok(submit_raw_external_command("ENABLE_NOTIFICATIONS", NULL, &buffer_items) == ERROR && buffer_items == external_command_buffer_slots, "Full buffer refuses commands");
+	processed_commands = 0;
+	check_for_external_commands();
+	ok(processed_commands == external_command_buffer_slots && get_external_command_buffer_items() == 0, "All buffered commands processed") || diag("processed=%d", processed_commands);
+
+	/* push commands through the pipe, the worker thread and the buffer into process_external_command1() */
+	processed_commands = 0;
+	gettimeofday(&start, NULL);
+	pthread_create(&writer, NULL, write_commands, (void *)&num_commands);
+	while (processed_commands < num_commands && elapsed_seconds(&start) < 60.0) {
+		check_for_external_commands();
+		if (get_external_command_buffer_items() == 0)
+			sched_yield();
+	}
+	elapsed = elapsed_seconds(&start);
+	pthread_join(writer, NULL);
+
+	ok(processed_commands == num_commands, "All %d commands written to the command file were processed", num_commands) || diag("processed=%d", processed_commands);
+	diag("%d commands in %.3f seconds: %.0f commands/second, buffer high water mark %d/%d", processed_commands, elapsed, (elapsed > 0.0) ? processed_commands / elapsed : 0.0, external_command_buffer.high, external_command_buffer_slots);
+
+	shutdown_command_file_worker_thread();
+	close(pipe_fds[0]);
+	close(pipe_fds[1]);
+}
+
 int
 main() {
 	time_t now = 0L;
 
-	plan(62);
+	plan(78);
 
 	ok(test_start_time == 0L, "Start time is empty");
 	ok(test_comment == NULL, "And test_comment is blank");
@@ -216,6 +485,11 @@ main() {
 	ok(strcmp(test_comment, "comment") == 0, "comment right") || diag("comment=%s", test_comment);
 
 
+	test_check_result_file(1000);
+
+	test_extcmd_lookup(5000000);
+
+	stress_external_commands(500000);
 
 	return exit_status();
 }
@@ -38,8 +38,7 @@ int log_debug_info(int level, int verbosity, const char *fmt, ...) {
 	va_end(ap);
 }
 
-timed_event *event_list_high = NULL;
-timed_event *event_list_high_tail = NULL;
+timed_event_queue event_queue_high;
 
 unsigned long next_downtime_id = 1L;
 
@@ -108,8 +107,11 @@ main(int argc, char **argv) {
 	unsigned long downtime_id = 0L;
 	scheduled_downtime *temp_downtime;
 	int i = 0;
+	int found = 0;
+	unsigned long first_id = 0L;
+	struct timeval start, end;
 
-	plan(38);
+	plan(41);
 
 	time(&now);
 
@@ -227,6 +229,32 @@ main(int argc, char **argv) {
 	for (temp_downtime = scheduled_downtime_list, i = 0; temp_downtime != NULL; temp_downtime = temp_downtime->next, i++) {}
 	ok(i == 0, "No downtimes left") || diag("Left: %d", i);
 
+	/* many downtimes, found and deleted by id */
+	for (temp_downtime = scheduled_downtime_list, i = 0; temp_downtime != NULL; temp_downtime = temp_downtime->next, i++) {}
+	first_id = next_downtime_id;
+	for (found = 0; found < 20000; found++)
+		add_host_downtime("host5", temp_start_time, "user", "many", temp_start_time + found % 100, temp_end_time, 0, 0, 0, next_downtime_id++, FALSE, 0);
+
+	gettimeofday(&start, NULL);
+	for (downtime_id = first_id, found = 0; downtime_id < next_downtime_id; downtime_id++) {
+		if (find_downtime(HOST_DOWNTIME, downtime_id) != NULL)
+			found++;
+	}
+	gettimeofday(&end, NULL);
+	ok(found == 20000, "Found all 20000 downtimes by id: %d", found);
+	diag("20000 lookups took %.4f seconds", (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1000000.0);
+
+	for (temp_downtime = scheduled_downtime_list; temp_downtime != NULL && temp_downtime->next != NULL && temp_downtime->start_time <= temp_downtime->next->start_time; temp_downtime = temp_downtime->next);
+	ok(temp_downtime == NULL || temp_downtime->next == NULL, "Downtime list still sorted by start time");
+
+	gettimeofday(&start, NULL);
+	for (downtime_id = first_id; downtime_id < next_downtime_id; downtime_id++)
+		delete_downtime(HOST_DOWNTIME, downtime_id);
+	gettimeofday(&end, NULL);
+	for (temp_downtime = scheduled_downtime_list, found = 0; temp_downtime != NULL; temp_downtime = temp_downtime->next, found++) {}
+	ok(found == i, "Deleted all 20000 downtimes by id") || diag("Left: %d", found - i);
+	diag("20000 deletions took %.4f seconds", (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1000000.0);
+
 	/* add tests for #2536 */
 	/*
 	setup_objects(now);
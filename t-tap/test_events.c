@@ -26,6 +26,7 @@
 #include "broker.h"
 #include "sretention.h"
 #include "tap.h"
+#include "test-timing.c"
 
 char *config_file = "etc/icinga.cfg";
 int      test_scheduling;
@@ -82,10 +83,8 @@ int      child_processes_fork_twice;
 int      time_change_threshold;
 
 
-extern timed_event *event_list_low;
-extern timed_event *event_list_low_tail;
-extern timed_event *event_list_high;
-extern timed_event *event_list_high_tail;
+extern timed_event_queue event_queue_low;
+extern timed_event_queue event_queue_high;
 
 host     *host_list;
 service  *service_list;
@@ -104,6 +103,7 @@ time_t get_next_service_notification_time(service *temp_service, time_t time_t1)
 int save_state_information(int int1) {}
 void get_time_breakdown(unsigned long long1, int *int1, int *int2, int *int3, int *int4) {}
 int check_for_external_commands(void) {}
+int handle_async_commands(void) {}
 void check_for_orphaned_hosts() {}
 void check_service_result_freshness() {}
 int check_time_against_period(time_t time_t1, timeperiod *timeperiod) {}
@@ -186,7 +186,7 @@ setup_events(time_t time) {
 	new_event->event_interval = 0L;
 	new_event->timing_func = NULL;
 	new_event->compensate_for_time_change = TRUE;
-	reschedule_event(new_event, &event_list_low, &event_list_low_tail);
+	reschedule_event(new_event, &event_queue_low);
 
 	/* Second service is one that will get nudged forward */
 	svc2 = (service *)malloc(sizeof(service));
@@ -209,7 +209,7 @@ setup_events(time_t time) {
 	new_event->event_interval = 0L;
 	new_event->timing_func = NULL;
 	new_event->compensate_for_time_change = TRUE;
-	reschedule_event(new_event, &event_list_low, &event_list_low_tail);
+	reschedule_event(new_event, &event_queue_low);
 }
 
 void
@@ -238,7 +238,7 @@ setup_events_with_host(time_t time) {
 	new_event->event_interval = 0L;
 	new_event->timing_func = NULL;
 	new_event->compensate_for_time_change = TRUE;
-	reschedule_event(new_event, &event_list_low, &event_list_low_tail);
+	reschedule_event(new_event, &event_queue_low);
 
 	if (host1 == NULL)
 		host1 = (host *)malloc(sizeof(host));
@@ -263,16 +263,63 @@ setup_events_with_host(time_t time) {
 	new_event->event_interval = 0L;
 	new_event->timing_func = NULL;
 	new_event->compensate_for_time_change = TRUE;
-	reschedule_event(new_event, &event_list_low, &event_list_low_tail);
+	reschedule_event(new_event, &event_queue_low);
 }
 
 
+void
+benchmark_event_queue(time_t now, int num_events) {
+	timed_event **handles = NULL;
+	timed_event *temp_event = NULL;
+	struct timeval start;
+	time_t last_run_time = 0L;
+	int in_order = TRUE;
+	int popped = 0;
+	int x;
+
+	srand(42);
+
+	gettimeofday(&start, NULL);
+	for (x = 0; x < num_events; x++)
+		schedule_new_event(EVENT_USER_FUNCTION, FALSE, now + (rand() % 86400), FALSE, 0L, NULL, TRUE, NULL, NULL, 0);
+	diag("Scheduled %d events in %.3f seconds", num_events, elapsed_seconds(&start));
+	ok(event_queue_low.heap.count == num_events, "All %d events are queued", num_events);
+
+	/* keep the handles, as the heap moves events around while rescheduling */
+	handles = (timed_event **)malloc(num_events * sizeof(timed_event *));
+	memcpy(handles, &event_queue_low.heap.items[1], num_events * sizeof(timed_event *));
+
+	gettimeofday(&start, NULL);
+	for (x = 0; x < num_events; x++) {
+		temp_event = handles[x];
+		remove_event(temp_event, &event_queue_low);
+		temp_event->run_time = now + (rand() % 86400);
+		reschedule_event(temp_event, &event_queue_low);
+	}
+	diag("Rescheduled %d events in %.3f seconds", num_events, elapsed_seconds(&start));
+	ok(event_queue_low.heap.count == num_events, "All %d events are still queued after rescheduling", num_events);
+
+	gettimeofday(&start, NULL);
+	while ((temp_event = pop_next_event(&event_queue_low)) != NULL) {
+		if (temp_event->run_time < last_run_time)
+			in_order = FALSE;
+		last_run_time = temp_event->run_time;
+		popped++;
+	}
+	diag("Popped %d events in %.3f seconds", popped, elapsed_seconds(&start));
+	ok(popped == num_events && in_order == TRUE, "Events come off the queue in order of execution time");
+
+	for (x = 0; x < num_events; x++)
+		free(handles[x]);
+	free(handles);
+}
+
 
 int
 main(int argc, char **argv) {
 	time_t now = 0L;
 
-	plan(10);
+	plan(13);
 
 	time(&now);
 
@@ -312,8 +359,8 @@ main(int argc, char **argv) {
 	 * correctly checks the host
 	 */
 	timed_event *temp_event = NULL;
-	while ((temp_event = event_list_low) != NULL) {
-		remove_event(temp_event, &event_list_low, &event_list_low_tail);
+	while ((temp_event = get_next_event(&event_queue_low)) != NULL) {
+		remove_event(temp_event, &event_queue_low);
 	}
 
 	sigshutdown = FALSE;
@@ -329,6 +376,11 @@ main(int argc, char **argv) {
 	ok(host1->next_check == now,  "host1 rescheduled ahead - normal interval");
 	ok(svc3->next_check == now + 300, "svc3 rescheduled ahead - normal interval");
 
+	while ((temp_event = pop_next_event(&event_queue_low)) != NULL)
+		free(temp_event);
+
+	benchmark_event_queue(now, 1000000);
+
 	return exit_status();
 }
 
@@ -41,7 +41,11 @@
 #include "../include/broker.h"
 #include "../include/nebmods.h"
 #include "../include/nebmodules.h"
+#include "../include/skiplist.h"
+#include "../xdata/xsddefault.h"
+#include "../xdata/xrddefault.h"
 #include "tap.h"
+#include "test-timing.c"
 
 char		*config_file = NULL;
 char		*log_file = NULL;
@@ -209,8 +213,12 @@ double          high_host_flap_threshold = DEFAULT_HIGH_HOST_FLAP_THRESHOLD;
 
 int             use_large_installation_tweaks = DEFAULT_USE_LARGE_INSTALLATION_TWEAKS;
 int             enable_environment_macros = TRUE;
+int             lazy_environment_macros = FALSE;
 int             free_child_process_memory = -1;
 int             child_processes_fork_twice = -1;
+int             check_worker_processes = DEFAULT_CHECK_WORKER_PROCESSES;
+int             check_result_reaper_threads = DEFAULT_CHECK_RESULT_REAPER_THREADS;
+int             max_async_commands = DEFAULT_MAX_ASYNC_COMMANDS;
 
 int             enable_embedded_perl = DEFAULT_ENABLE_EMBEDDED_PERL;
 int             use_embedded_perl_implicitly = DEFAULT_USE_EMBEDDED_PERL_IMPLICITLY;
@@ -220,7 +228,6 @@ int             date_format = DATE_FORMAT_US;
 char            *use_timezone = NULL;
 
 int             command_file_fd;
-FILE            *command_file_fp;
 int             command_file_created = FALSE;
 int		allow_empty_hostgroup_assignment = DEFAULT_ALLOW_EMPTY_HOSTGROUP_ASSIGNMENT;
 
@@ -231,11 +238,13 @@ extern command         *command_list;
 extern timeperiod      *timeperiod_list;
 extern serviceescalation *serviceescalation_list;
 extern host 		*host_list;
+extern service		*service_list;
+extern servicegroup    *servicegroup_list;
 
 notification    *notification_list;
 
 check_result    check_result_info;
-check_result    *check_result_list = NULL;
+check_result_queue check_result_list;
 unsigned long	max_check_result_file_age = DEFAULT_MAX_CHECK_RESULT_AGE;
 
 dbuf            check_result_dbuf;
@@ -246,6 +255,8 @@ pthread_t       worker_threads[TOTAL_WORKER_THREADS];
 int             external_command_buffer_slots = DEFAULT_EXTERNAL_COMMAND_BUFFER_SLOTS;
 
 check_stats     check_statistics[MAX_CHECK_STATS_TYPES];
+unsigned long   check_result_channel_stats[CHECK_RESULT_CHANNELS];
+async_command_stats async_command_statistics;
 
 char            *debug_file;
 int             debug_level = DEFAULT_DEBUG_LEVEL;
@@ -281,9 +292,8 @@ int		enable_state_based_escalation_ranges = FALSE;
 
 /* Dummy variables */
 sched_info scheduling_info;
-timed_event event_list_low;
-timed_event event_list_high;
-timed_event *event_list_high_tail = NULL;
+timed_event_queue event_queue_low;
+timed_event_queue event_queue_high;
 
 /* Dummy functions */
 void logit(int data_type, int display, const char *fmt, ...) {}
@@ -297,6 +307,8 @@ int log_debug_info(int level, int verbosity, const char *fmt, ...) {
 }
 int close_log_file(void) {}
 int chown_debug_log(uid_t uid, gid_t gid) {}
+int fix_log_file_owner(uid_t uid, gid_t gid) {}
+int init_command_file_worker_thread(void) {}
 
 int neb_free_callback_list(void) {}
 void broker_program_status(int type, int flags, int attr, struct timeval *timestamp) {}
@@ -308,10 +320,12 @@ int neb_add_module(char *filename, char *args, int should_be_loaded) {}
 void broker_system_command(int type, int flags, int attr, struct timeval start_time, struct timeval end_time, double exectime, int timeout, int early_timeout, int retcode, char *cmd, char *output, struct timeval *timestamp) {}
 
 int schedule_new_event(int event_type, int high_priority, time_t run_time, int recurring, unsigned long event_interval, void *timing_func, int compensate_for_time_change, void *event_data, void *event_args, int event_options) {}
+void free_check_deadline_queues(void) {}
 int my_tcp_connect(char *host_name, int port, int *sd, int timeout) {}
 int my_recvall(int s, char *buf, int *len, int timeout) {}
 int neb_free_module_list(void) {}
-void remove_event(timed_event *event, timed_event **event_list, timed_event **event_list_tail) {}
+void remove_event(timed_event *event, timed_event_queue *event_queue) {}
+void free_event_queue(timed_event_queue *event_queue) {}
 void check_for_service_flapping(service *svc, int update, int allow_flapstart_notification) {}
 int update_host_status(host *hst, int aggregated_dump) {}
 int update_contact_status(contact *cntct, int aggregated_dump) {}
@@ -333,6 +347,933 @@ void    profiler_update(int event, struct timeval start) {}
 void remove_host_acknowledgement(host * hst) {}
 void remove_service_acknowledgement(service * svc) {}
 
+int get_external_command_buffer_items(void) { return 0; }
+void profiler_output(FILE *fp) {}
+
+/* compares name lookups through the skiplists with the hash indexes on made up objects */
+void
+benchmark_object_lookups(int num_hosts, int services_per_host, int rounds) {
+	extern skiplist *object_skiplists[NUM_OBJECT_SKIPLISTS];
+	host *hosts = NULL;
+	service *services = NULL;
+	host temp_host;
+	service temp_service;
+	struct timeval start;
+	double skiplist_time = 0.0;
+	double hash_time = 0.0;
+	char buffer[64];
+	int num_services = num_hosts * services_per_host;
+	int found_skiplist = 0;
+	int found_hash = 0;
+	int x = 0;
+	int y = 0;
+
+	init_object_skiplists();
+	init_object_hashes();
+
+	hosts = (host *)calloc(num_hosts, sizeof(host));
+	services = (service *)calloc(num_services, sizeof(service));
+	for (x = 0; x < num_hosts; x++) {
+		snprintf(buffer, sizeof(buffer), "host-%06d.example.com", x);
+		hosts[x].name = strdup(buffer);
+		FILL_HASH(hosts[x].name);
+		skiplist_insert(object_skiplists[HOST_SKIPLIST], &hosts[x]);
+		add_object_to_hash(HOST_HASH, hosts[x].name_hash, &hosts[x]);
+		for (y = 0; y < services_per_host; y++) {
+			service *svc = &services[(x * services_per_host) + y];
+			snprintf(buffer, sizeof(buffer), "service-%03d", y);
+			svc->host_name = strdup(hosts[x].name);
+			svc->description = strdup(buffer);
+			FILL_HASH(svc->host_name);
+			FILL_HASH(svc->description);
+			skiplist_insert(object_skiplists[SERVICE_SKIPLIST], svc);
+			add_object_to_hash(SERVICE_HASH, OBJECT_HASH_PAIR(svc->host_name_hash, svc->description_hash), svc);
+		}
+	}
+
+	gettimeofday(&start, NULL);
+	for (y = 0; y < rounds; y++) {
+		for (x = 0; x < num_services; x++) {
+			temp_service.host_name = services[x].host_name;
+			temp_service.description = services[x].description;
+			if (skiplist_find_first(object_skiplists[SERVICE_SKIPLIST], &temp_service, NULL) == &services[x])
+				found_skiplist++;
+		}
+	}
+	skiplist_time = elapsed_seconds(&start);
+
+	gettimeofday(&start, NULL);
+	for (y = 0; y < rounds; y++) {
+		for (x = 0; x < num_services; x++) {
+			if (find_service(services[x].host_name, services[x].description) == &services[x])
+				found_hash++;
+		}
+	}
+	hash_time = elapsed_seconds(&start);
+
+	ok(found_skiplist == num_services * rounds && found_hash == num_services * rounds, "All %d services found through skiplist and hash index", num_services);
+	diag("%d service lookups: skiplist %.3fs, hash index %.3fs", num_services * rounds, skiplist_time, hash_time);
+
+	gettimeofday(&start, NULL);
+	for (y = 0; y < rounds; y++) {
+		for (x = 0; x < num_hosts; x++) {
+			temp_host.name = hosts[x].name;
+			skiplist_find_first(object_skiplists[HOST_SKIPLIST], &temp_host, NULL);
+		}
+	}
+	skiplist_time = elapsed_seconds(&start);
+
+	found_hash = 0;
+	gettimeofday(&start, NULL);
+	for (y = 0; y < rounds; y++) {
+		for (x = 0; x < num_hosts; x++) {
+			if (find_host(hosts[x].name) == &hosts[x])
+				found_hash++;
+		}
+	}
+	hash_time = elapsed_seconds(&start);
+
+	ok(found_hash == num_hosts * rounds, "All %d hosts found through hash index", num_hosts);
+	diag("%d host lookups: skiplist %.3fs, hash index %.3fs", num_hosts * rounds, skiplist_time, hash_time);
+
+	ok(find_host("host-unknown") == NULL && find_service(hosts[0].name, "service-unknown") == NULL, "Unknown objects are not found");
+
+	free_object_skiplists();
+	free_object_hashes();
+	for (x = 0; x < num_services; x++) {
+		free(services[x].host_name);
+		free(services[x].description);
+	}
+	for (x = 0; x < num_hosts; x++)
+		free(hosts[x].name);
+	free(services);
+	free(hosts);
+}
+
+/* compares full status file updates with delta updates when only a few services change between updates */
+void
+benchmark_status_updates(int num_hosts, int services_per_host, int changed_services, int rounds) {
+	extern char *xsddefault_status_log;
+	extern char *xsddefault_status_delta_log;
+	extern char *xsddefault_temp_file;
+	extern int xsddefault_delta_updates;
+	extern char *xsddefault_status_binary_log;
+	extern int xsddefault_binary_status;
+	xsddefault_binary_header header;
+	FILE *fp = NULL;
+	char *snapshot = NULL;
+	char *long_output = "/ 3326 MB free\n/var 812 MB free";
+	host *hosts = NULL;
+	service *services = NULL;
+	struct stat st;
+	clock_t start;
+	double full_cpu = 0.0;
+	double delta_cpu = 0.0;
+	unsigned long full_bytes = 0L;
+	unsigned long delta_bytes = 0L;
+	char buffer[64];
+	int num_services = num_hosts * services_per_host;
+	int dirty_left = 0;
+	int x = 0;
+	int y = 0;
+
+	hosts = (host *)calloc(num_hosts, sizeof(host));
+	services = (service *)calloc(num_services, sizeof(service));
+	for (x = 0; x < num_hosts; x++) {
+		snprintf(buffer, sizeof(buffer), "host-%06d.example.com", x);
+		hosts[x].name = strdup(buffer);
+		hosts[x].plugin_output = strdup("PING OK - Packet loss = 0%, RTA = 0.52 ms");
+		hosts[x].perf_data = strdup("rta=0.520000ms;3000.000000;5000.000000;0.000000 pl=0%;80;100;0");
+		hosts[x].next = (x + 1 < num_hosts) ? &hosts[x + 1] : NULL;
+		for (y = 0; y < services_per_host; y++) {
+			service *svc = &services[(x * services_per_host) + y];
+			snprintf(buffer, sizeof(buffer), "service-%03d", y);
+			svc->host_name = hosts[x].name;
+			svc->description = strdup(buffer);
+			svc->plugin_output = strdup("DISK OK - free space: / 3326 MB (56% inode=99%):");
+			svc->perf_data = strdup("/=2643MB;5948;5958;0;5968");
+			svc->next = ((x * services_per_host) + y + 1 < num_services) ? svc + 1 : NULL;
+		}
+	}
+	host_list = hosts;
+	service_list = services;
+	contact_list = NULL;
+
+	/* long output is kept with escaped newlines in the core */
+	services[0].long_plugin_output = strdup("/ 3326 MB free\\n/var 812 MB free");
+
+	xsddefault_status_log = strdup("var/status.dat.bench");
+	xsddefault_status_delta_log = strdup("var/status.dat.bench.delta");
+	xsddefault_temp_file = strdup("var/status.dat.bench.tmp");
+
+	/* full status file on every update */
+	xsddefault_delta_updates = 0;
+	for (y = 0; y < rounds; y++) {
+		for (x = 0; x < changed_services; x++)
+			services[(y * 7919 + x * 104729) % num_services].status_dirty = TRUE;
+		start = clock();
+		xsddefault_save_status_data();
+		full_cpu += (double)(clock() - start) / CLOCKS_PER_SEC;
+		if (stat(xsddefault_status_log, &st) == 0)
+			full_bytes += st.st_size;
+	}
+
+	/* one full status file, then only the changed services */
+	xsddefault_delta_updates = rounds;
+	xsddefault_save_status_data();
+	unlink(xsddefault_status_delta_log);
+	for (y = 0; y < rounds; y++) {
+		for (x = 0; x < changed_services; x++)
+			services[(y * 7919 + x * 104729) % num_services].status_dirty = TRUE;
+		start = clock();
+		xsddefault_save_status_data();
+		delta_cpu += (double)(clock() - start) / CLOCKS_PER_SEC;
+	}
+	if (stat(xsddefault_status_delta_log, &st) == 0)
+		delta_bytes = st.st_size;
+
+	for (x = 0; x < num_services; x++) {
+		if (services[x].status_dirty == TRUE)
+			dirty_left++;
+	}
+
+	ok(delta_bytes > 0 && delta_bytes < full_bytes / 10, "Delta updates write a fraction of the full status file");
+	ok(dirty_left == 0, "All changed services have been written");
+	diag("%d updates of %d services with %d changes each: full %lu bytes %.3fs cpu, delta %lu bytes %.3fs cpu", rounds, num_services, changed_services, full_bytes, full_cpu, delta_bytes, delta_cpu);
+
+	/* the binary snapshot is written along with the full status file */
+	xsddefault_status_binary_log = strdup("var/status.dat.bench.bin");
+	xsddefault_binary_status = TRUE;
+	xsddefault_delta_updates = 0;
+	xsddefault_save_status_data();
+	memset(&header, 0, sizeof(header));
+	if ((fp = fopen(xsddefault_status_binary_log, "r")) != NULL) {
+		if (fread(&header, sizeof(header), 1, fp) != 1)
+			memset(&header, 0, sizeof(header));
+		else if (fseek(fp, header.string_offset, SEEK_SET) == 0 && (snapshot = (char *)calloc(1, header.string_size + 1)) != NULL && fread(snapshot, 1, header.string_size, fp) != header.string_size)
+			my_free(snapshot);
+		fclose(fp);
+	}
+	ok(!strcmp(header.magic, XSDDEFAULT_BINARY_MAGIC) && header.host_count == num_hosts && header.service_count == num_services, "Binary status snapshot has all hosts and services");
+
+	/* the strings of the snapshot are used as they are, the CGIs don't unescape them */
+	ok(snapshot != NULL && memmem(snapshot, header.string_size, long_output, strlen(long_output)) != NULL && memmem(snapshot, header.string_size, "\\n", 2) == NULL, "Binary status snapshot has long output with unescaped newlines");
+	my_free(snapshot);
+	xsddefault_binary_status = FALSE;
+	unlink(xsddefault_status_binary_log);
+	my_free(xsddefault_status_binary_log);
+
+	unlink(xsddefault_status_log);
+	unlink(xsddefault_status_delta_log);
+	my_free(xsddefault_status_log);
+	my_free(xsddefault_status_delta_log);
+	my_free(xsddefault_temp_file);
+
+	host_list = NULL;
+	service_list = NULL;
+	for (x = 0; x < num_services; x++) {
+		free(services[x].description);
+		free(services[x].plugin_output);
+		free(services[x].long_plugin_output);
+		free(services[x].perf_data);
+	}
+	for (x = 0; x < num_hosts; x++) {
+		free(hosts[x].name);
+		free(hosts[x].plugin_output);
+		free(hosts[x].perf_data);
+	}
+	free(services);
+	free(hosts);
+}
+
+/* sets the retained state of made up services, or clears it if states is NULL */
+void
+set_retained_services(service *services, int num_services, int *states) {
+	char buffer[64];
+	int x = 0;
+
+	for (x = 0; x < num_services; x++) {
+		my_free(services[x].plugin_output);
+		if (states == NULL) {
+			services[x].current_state = STATE_OK;
+			services[x].last_check = (time_t)0;
+			services[x].plugin_output = strdup("");
+		} else {
+			snprintf(buffer, sizeof(buffer), "service %d is in state %d", x, states[x]);
+			services[x].current_state = states[x];
+			services[x].last_check = (time_t)(1000000 + states[x]);
+			services[x].plugin_output = strdup(buffer);
+		}
+	}
+}
+
+/* counts the made up services which have their retained state */
+int
+count_retained_services(service *services, int num_services, int *states) {
+	char buffer[64];
+	int found = 0;
+	int x = 0;
+
+	for (x = 0; x < num_services; x++) {
+		snprintf(buffer, sizeof(buffer), "service %d is in state %d", x, states[x]);
+		if (services[x].current_state == states[x] && services[x].last_check == (time_t)(1000000 + states[x]) && services[x].plugin_output != NULL && !strcmp(services[x].plugin_output, buffer))
+			found++;
+	}
+
+	return found;
+}
+
+/* compares saving and restoring the text retention file with the binary retention file and its appended changes */
+void
+benchmark_retention(int num_hosts, int services_per_host, int changed_services) {
+	extern char *xrddefault_retention_file;
+	extern char *xrddefault_retention_binary_file;
+	extern char *xrddefault_temp_file;
+	extern int xrddefault_binary_retention;
+	extern int xrddefault_read_retention_file_information(char *, int);
+	host *hosts = NULL;
+	service *services = NULL;
+	int *states = NULL;
+	struct stat st;
+	struct timeval start;
+	double text_save = 0.0;
+	double text_read = 0.0;
+	double binary_save = 0.0;
+	double binary_read = 0.0;
+	double delta_save = 0.0;
+	unsigned long text_bytes = 0L;
+	unsigned long binary_bytes = 0L;
+	unsigned long delta_bytes = 0L;
+	char buffer[64];
+	int num_services = num_hosts * services_per_host;
+	int restored_text = 0;
+	int restored_binary = 0;
+	int restored_delta = 0;
+	int dirty_left = 0;
+	int x = 0;
+	int y = 0;
+
+	init_object_hashes();
+
+	hosts = (host *)calloc(num_hosts, sizeof(host));
+	services = (service *)calloc(num_services, sizeof(service));
+	states = (int *)calloc(num_services, sizeof(int));
+	for (x = 0; x < num_hosts; x++) {
+		snprintf(buffer, sizeof(buffer), "host-%06d.example.com", x);
+		hosts[x].name = strdup(buffer);
+		hosts[x].retain_status_information = TRUE;
+		hosts[x].retain_nonstatus_information = TRUE;
+		hosts[x].next = (x + 1 < num_hosts) ? &hosts[x + 1] : NULL;
+		FILL_HASH(hosts[x].name);
+		add_object_to_hash(HOST_HASH, hosts[x].name_hash, &hosts[x]);
+		for (y = 0; y < services_per_host; y++) {
+			service *svc = &services[(x * services_per_host) + y];
+			snprintf(buffer, sizeof(buffer), "service-%03d", y);
+			svc->host_name = hosts[x].name;
+			svc->description = strdup(buffer);
+			svc->retain_status_information = TRUE;
+			svc->retain_nonstatus_information = TRUE;
+			svc->max_attempts = 3;
+			svc->next = ((x * services_per_host) + y + 1 < num_services) ? svc + 1 : NULL;
+			FILL_HASH(svc->host_name);
+			FILL_HASH(svc->description);
+			add_object_to_hash(SERVICE_HASH, OBJECT_HASH_PAIR(svc->host_name_hash, svc->description_hash), svc);
+		}
+	}
+	for (x = 0; x < num_services; x++)
+		states[x] = x % 4;
+	host_list = hosts;
+	service_list = services;
+	contact_list = NULL;
+
+	xrddefault_retention_file = strdup("var/retention.dat.bench");
+	xrddefault_retention_binary_file = strdup("var/retention.dat.bench.bin");
+	xrddefault_temp_file = strdup("var/retention.dat.bench.tmp");
+
+	/* text retention file */
+	set_retained_services(services, num_services, states);
+	xrddefault_binary_retention = FALSE;
+	gettimeofday(&start, NULL);
+	xrddefault_save_state_information(FALSE);
+	text_save = elapsed_seconds(&start);
+	if (stat(xrddefault_retention_file, &st) == 0)
+		text_bytes = st.st_size;
+
+	set_retained_services(services, num_services, NULL);
+	gettimeofday(&start, NULL);
+	xrddefault_read_retention_file_information(xrddefault_retention_file, TRUE);
+	text_read = elapsed_seconds(&start);
+	restored_text = count_retained_services(services, num_services, states);
+
+	/* binary retention file, read instead of the older text file */
+	xrddefault_binary_retention = TRUE;
+	gettimeofday(&start, NULL);
+	xrddefault_save_state_information(FALSE);
+	binary_save = elapsed_seconds(&start);
+	if (stat(xrddefault_retention_binary_file, &st) == 0)
+		binary_bytes = st.st_size;
+
+	set_retained_services(services, num_services, NULL);
+	gettimeofday(&start, NULL);
+	xrddefault_read_state_information();
+	binary_read = elapsed_seconds(&start);
+	restored_binary = count_retained_services(services, num_services, states);
+
+	ok(restored_text == num_services && restored_binary == num_services, "Text and binary retention files restore all %d services", num_services);
+	diag("%d services: text %lu bytes saved in %.3fs read in %.3fs, binary %lu bytes saved in %.3fs read in %.3fs", num_services, text_bytes, text_save, text_read, binary_bytes, binary_save, binary_read);
+
+	/* autosave appends the changed services only */
+	for (x = 0; x < num_services; x++)
+		services[x].retention_dirty = FALSE;
+	for (x = 0; x < changed_services; x++) {
+		y = (x * 104729) % num_services;
+		states[y] = (states[y] + 1) % 4;
+		services[y].retention_dirty = TRUE;
+	}
+	set_retained_services(services, num_services, states);
+	gettimeofday(&start, NULL);
+	xrddefault_save_state_information(TRUE);
+	delta_save = elapsed_seconds(&start);
+	if (stat(xrddefault_retention_binary_file, &st) == 0)
+		delta_bytes = st.st_size - binary_bytes;
+	for (x = 0; x < num_services; x++) {
+		if (services[x].retention_dirty == TRUE)
+			dirty_left++;
+	}
+
+	ok(delta_bytes > 0 && delta_bytes < binary_bytes / 10 && dirty_left == 0, "Autosave appends only the changed services to the binary retention file");
+	diag("%d changed services: %lu bytes appended in %.3fs", changed_services, delta_bytes, delta_save);
+
+	set_retained_services(services, num_services, NULL);
+	xrddefault_read_state_information();
+	restored_delta = count_retained_services(services, num_services, states);
+	ok(restored_delta == num_services, "Changed services are restored from the appended changes");
+
+	unlink(xrddefault_retention_file);
+	unlink(xrddefault_retention_binary_file);
+	my_free(xrddefault_retention_file);
+	my_free(xrddefault_retention_binary_file);
+	my_free(xrddefault_temp_file);
+	xrddefault_binary_retention = FALSE;
+
+	free_object_hashes();
+	host_list = NULL;
+	service_list = NULL;
+	for (x = 0; x < num_services; x++) {
+		free(services[x].description);
+		free(services[x].plugin_output);
+		free(services[x].long_plugin_output);
+		free(services[x].perf_data);
+	}
+	for (x = 0; x < num_hosts; x++) {
+		free(hosts[x].name);
+		free(hosts[x].plugin_output);
+		free(hosts[x].long_plugin_output);
+		free(hosts[x].perf_data);
+	}
+	free(states);
+	free(services);
+	free(hosts);
+}
+
+/* adds a string to a fingerprint of the registered objects */
+unsigned long
+fingerprint_string(unsigned long hash, char *str) {
+
+	if (str == NULL)
+		return (hash * 33) ^ 1;
+	while (*str)
+		hash = (hash * 33) ^ (unsigned char)*str++;
+
+	return (hash * 33) ^ 2;
+}
+
+/* fingerprints the names, members and some settings of the registered objects in list order */
+unsigned long
+fingerprint_objects(void) {
+	unsigned long hash = 5381;
+	timeperiod *temp_timeperiod = NULL;
+	timerange *temp_timerange = NULL;
+	daterange *temp_daterange = NULL;
+	command *temp_command = NULL;
+	contact *temp_contact = NULL;
+	contactgroup *temp_contactgroup = NULL;
+	contactsmember *temp_contactsmember = NULL;
+	hostgroup *temp_hostgroup = NULL;
+	hostsmember *temp_hostsmember = NULL;
+	servicegroup *temp_servicegroup = NULL;
+	servicesmember *temp_servicesmember = NULL;
+	host *temp_host = NULL;
+	service *temp_service = NULL;
+	customvariablesmember *temp_customvariable = NULL;
+	int day = 0;
+	int x = 0;
+
+	for (temp_timeperiod = timeperiod_list; temp_timeperiod != NULL; temp_timeperiod = temp_timeperiod->next) {
+		hash = fingerprint_string(hash, temp_timeperiod->name);
+		for (day = 0; day < 7; day++) {
+			for (temp_timerange = temp_timeperiod->days[day]; temp_timerange != NULL; temp_timerange = temp_timerange->next)
+				hash = (hash * 33) ^ (temp_timerange->range_start * 86401 + temp_timerange->range_end);
+		}
+		for (x = 0; x < DATERANGE_TYPES; x++) {
+			for (temp_daterange = temp_timeperiod->exceptions[x]; temp_daterange != NULL; temp_daterange = temp_daterange->next)
+				hash = (hash * 33) ^ (temp_daterange->syear * 10000 + temp_daterange->smon * 100 + temp_daterange->smday);
+		}
+	}
+	for (temp_command = command_list; temp_command != NULL; temp_command = temp_command->next) {
+		hash = fingerprint_string(hash, temp_command->name);
+		hash = fingerprint_string(hash, temp_command->command_line);
+	}
+	for (temp_contactgroup = contactgroup_list; temp_contactgroup != NULL; temp_contactgroup = temp_contactgroup->next) {
+		hash = fingerprint_string(hash, temp_contactgroup->group_name);
+		for (temp_contactsmember = temp_contactgroup->members; temp_contactsmember != NULL; temp_contactsmember = temp_contactsmember->next)
+			hash = fingerprint_string(hash, temp_contactsmember->contact_name);
+	}
+	for (temp_hostgroup = hostgroup_list; temp_hostgroup != NULL; temp_hostgroup = temp_hostgroup->next) {
+		hash = fingerprint_string(hash, temp_hostgroup->group_name);
+		for (temp_hostsmember = temp_hostgroup->members; temp_hostsmember != NULL; temp_hostsmember = temp_hostsmember->next)
+			hash = fingerprint_string(hash, temp_hostsmember->host_name);
+	}
+	for (temp_servicegroup = servicegroup_list; temp_servicegroup != NULL; temp_servicegroup = temp_servicegroup->next) {
+		hash = fingerprint_string(hash, temp_servicegroup->group_name);
+		for (temp_servicesmember = temp_servicegroup->members; temp_servicesmember != NULL; temp_servicesmember = temp_servicesmember->next)
+			hash = fingerprint_string(fingerprint_string(hash, temp_servicesmember->host_name), temp_servicesmember->service_description);
+	}
+	for (temp_contact = contact_list; temp_contact != NULL; temp_contact = temp_contact->next) {
+		hash = fingerprint_string(hash, temp_contact->name);
+		hash = fingerprint_string(hash, temp_contact->email);
+		hash = (hash * 33) ^ (temp_contact->notify_on_host_down * 2 + temp_contact->notify_on_service_critical);
+	}
+	for (temp_host = host_list; temp_host != NULL; temp_host = temp_host->next) {
+		hash = fingerprint_string(hash, temp_host->name);
+		hash = fingerprint_string(hash, temp_host->address);
+		hash = fingerprint_string(hash, temp_host->host_check_command);
+		hash = (hash * 33) ^ (unsigned long)(temp_host->check_interval * 1000.0 + temp_host->max_attempts);
+		for (temp_hostsmember = temp_host->parent_hosts; temp_hostsmember != NULL; temp_hostsmember = temp_hostsmember->next)
+			hash = fingerprint_string(hash, temp_hostsmember->host_name);
+		for (temp_contactsmember = temp_host->contacts; temp_contactsmember != NULL; temp_contactsmember = temp_contactsmember->next)
+			hash = fingerprint_string(hash, temp_contactsmember->contact_name);
+		for (temp_customvariable = temp_host->custom_variables; temp_customvariable != NULL; temp_customvariable = temp_customvariable->next)
+			hash = fingerprint_string(fingerprint_string(hash, temp_customvariable->variable_name), temp_customvariable->variable_value);
+	}
+	for (temp_service = service_list; temp_service != NULL; temp_service = temp_service->next) {
+		hash = fingerprint_string(hash, temp_service->host_name);
+		hash = fingerprint_string(hash, temp_service->description);
+		hash = fingerprint_string(hash, temp_service->service_check_command);
+		hash = (hash * 33) ^ (unsigned long)(temp_service->check_interval * 1000.0 + temp_service->max_attempts);
+		for (temp_contactsmember = temp_service->contacts; temp_contactsmember != NULL; temp_contactsmember = temp_contactsmember->next)
+			hash = fingerprint_string(hash, temp_contactsmember->contact_name);
+		for (temp_customvariable = temp_service->custom_variables; temp_customvariable != NULL; temp_customvariable = temp_customvariable->next)
+			hash = fingerprint_string(fingerprint_string(hash, temp_customvariable->variable_name), temp_customvariable->variable_value);
+	}
+
+	return hash;
+}
+
+/* reads the config files, writes the precached object files and compares loading them with the text and the binary precache file */
+void
+check_binary_object_cache(void) {
+	char *binary_file = NULL;
+	char *precache_file = NULL;
+	struct timeval start;
+	double text_read = 0.0;
+	double binary_read = 0.0;
+	unsigned long config_objects = 0L;
+	unsigned long text_objects = 0L;
+	unsigned long binary_objects = 0L;
+	int result = OK;
+
+	/* config files, precache like -p does */
+	reset_variables();
+	verify_config = TRUE;
+	precache_objects = TRUE;
+	read_main_config_file(config_file);
+	precache_file = strdup("smallconfig/objects.precache");
+	asprintf(&binary_file, "%s.bin", precache_file);
+	unlink(binary_file);
+	result = read_all_object_data(config_file);
+	config_objects = fingerprint_objects();
+	free_memory(get_global_macros());
+	ok(result == OK && access(binary_file, R_OK) == 0, "Precaching objects writes the binary object cache");
+
+	/* binary precache file like -u does */
+	reset_variables();
+	verify_config = FALSE;
+	precache_objects = FALSE;
+	use_precached_objects = TRUE;
+	read_main_config_file(config_file);
+	gettimeofday(&start, NULL);
+	result = read_all_object_data(config_file);
+	binary_read = elapsed_seconds(&start);
+	if (result == OK)
+		result = pre_flight_check();
+	binary_objects = fingerprint_objects();
+	free_memory(get_global_macros());
+
+	/* text precache file once the binary one is gone */
+	unlink(binary_file);
+	reset_variables();
+	use_precached_objects = TRUE;
+	read_main_config_file(config_file);
+	gettimeofday(&start, NULL);
+	read_all_object_data(config_file);
+	text_read = elapsed_seconds(&start);
+	text_objects = fingerprint_objects();
+	free_memory(get_global_macros());
+
+	ok(result == OK && binary_objects == config_objects && text_objects == config_objects, "Objects from the binary object cache match the config files and the text precache file");
+	diag("text precache file read in %.6fs, binary object cache in %.6fs", text_read, binary_read);
+
+	use_precached_objects = FALSE;
+	unlink(precache_file);
+	my_free(precache_file);
+	my_free(binary_file);
+}
+
+/* returns the value of a custom variable of a service and how often the service has it */
+char *
+service_custom_variable(service *svc, char *name, int *count) {
+	customvariablesmember *temp_customvariable = NULL;
+	char *value = NULL;
+
+	*count = 0;
+	if (svc == NULL)
+		return NULL;
+	for (temp_customvariable = svc->custom_variables; temp_customvariable != NULL; temp_customvariable = temp_customvariable->next) {
+		if (!strcmp(temp_customvariable->variable_name, name)) {
+			value = temp_customvariable->variable_value;
+			(*count)++;
+		}
+	}
+
+	return value;
+}
+
+/* checks inheritance through a deep service template chain and several templates per object */
+void
+check_template_inheritance(void) {
+	FILE *fp = NULL;
+	service *svc1 = NULL;
+	service *svc2 = NULL;
+	service *svc3 = NULL;
+	service *svc4 = NULL;
+	char *level = NULL;
+	char *twice = NULL;
+	int level_count = 0;
+	int twice_count = 0;
+	int count = 0;
+	int result = ERROR;
+	int x = 0;
+
+	mkdir("var/templates", 0755);
+	if ((fp = fopen("var/templates/icinga.cfg", "w")) != NULL) {
+		fprintf(fp, "cfg_file=objects.cfg\nobject_cache_file=var/templates/objects.cache\nprecached_object_file=var/templates/objects.precache\n");
+		fclose(fp);
+	}
+	if ((fp = fopen("var/templates/objects.cfg", "w")) != NULL) {
+		fprintf(fp, "define timeperiod{\n\ttimeperiod_name\t24x7\n\talias\t24x7\n\tmonday\t00:00-24:00\n}\n\n");
+		fprintf(fp, "define command{\n\tcommand_name\tcheck_dummy\n\tcommand_line\t/bin/true $ARG1$\n}\n\n");
+		fprintf(fp, "define contact{\n\tcontact_name\tadmin\n\thost_notification_period\t24x7\n\tservice_notification_period\t24x7\n\thost_notification_options\td,u,r\n\tservice_notification_options\tw,u,c,r\n\thost_notification_commands\tcheck_dummy\n\tservice_notification_commands\tcheck_dummy\n}\n\n");
+		fprintf(fp, "define host{\n\thost_name\thost1\n\tcheck_command\tcheck_dummy\n\tmax_check_attempts\t3\n\tcheck_period\t24x7\n\tnotification_period\t24x7\n\tcontacts\tadmin\n}\n\n");
+		fprintf(fp, "define service{\n\tname\tlevel-0\n\tcheck_command\tcheck_dummy!0\n\tmax_check_attempts\t3\n\tcheck_period\t24x7\n\tnotification_period\t24x7\n\tcontacts\tadmin\n\t_LEVEL\t0\n\t_BASE\tbase\n\tregister\t0\n}\n\n");
+		for (x = 1; x <= 5; x++)
+			fprintf(fp, "define service{\n\tname\tlevel-%d\n\tuse\tlevel-%d\n\tcheck_interval\t%d\n%s\t_LEVEL\t%d\n\tregister\t0\n}\n\n", x, x - 1, x, (x == 3) ? "\tmax_check_attempts\t7\n" : "", x);
+		fprintf(fp, "define service{\n\tname\textra\n\tnotes\textra\n\t_EXTRA\textra\n\t_LEVEL\textra\n\t_TWICE\tfirst\n\t_TWICE\tsecond\n\tregister\t0\n}\n\n");
+		fprintf(fp, "define service{\n\tuse\tlevel-5\n\thost_name\thost1\n\tservice_description\tservice1\n}\n\n");
+		fprintf(fp, "define service{\n\tuse\tlevel-5, extra\n\thost_name\thost1\n\tservice_description\tservice2\n}\n\n");
+		fprintf(fp, "define service{\n\tuse\textra,level-5\n\thost_name\thost1\n\tservice_description\tservice3\n\t_LEVEL\town\n}\n\n");
+		fprintf(fp, "define service{\n\tuse\tlevel-5\n\thost_name\thost1\n\tservice_description\tservice4\n\tmax_check_attempts\t1\n}\n");
+		fclose(fp);
+	}
+
+	reset_variables();
+	result = read_object_config_data("var/templates/icinga.cfg", READ_ALL_OBJECT_DATA, FALSE, FALSE);
+	svc1 = find_service("host1", "service1");
+	svc2 = find_service("host1", "service2");
+	svc3 = find_service("host1", "service3");
+	svc4 = find_service("host1", "service4");
+
+	ok(result == OK && svc1 != NULL && svc1->check_interval == 5.0 && svc1->max_attempts == 7 && !strcmp(svc1->service_check_command, "check_dummy!0")
+	   && svc4 != NULL && svc4->check_interval == 5.0 && svc4->max_attempts == 1
+	   && svc2 != NULL && svc2->notes != NULL && !strcmp(svc2->notes, "extra") && svc3 != NULL && svc3->check_interval == 5.0, "Services inherit properties through five levels of templates");
+
+	result = OK;
+	if ((level = service_custom_variable(svc1, "LEVEL", &level_count)) == NULL || strcmp(level, "5") || level_count != 1 || service_custom_variable(svc1, "BASE", &count) == NULL || count != 1)
+		result = ERROR;
+	if ((level = service_custom_variable(svc2, "LEVEL", &level_count)) == NULL || strcmp(level, "5") || level_count != 1 || service_custom_variable(svc2, "EXTRA", &count) == NULL || count != 1)
+		result = ERROR;
+	if ((twice = service_custom_variable(svc2, "TWICE", &twice_count)) == NULL || twice_count != 1)
+		result = ERROR;
+	if ((level = service_custom_variable(svc3, "LEVEL", &level_count)) == NULL || strcmp(level, "own") || level_count != 1 || service_custom_variable(svc3, "BASE", &count) == NULL || count != 1)
+		result = ERROR;
+	ok(result == OK, "Custom variables are inherited once, the first template and the object itself win");
+
+	free_memory(get_global_macros());
+
+	system("rm -rf var/templates");
+}
+
+/* writes a config with generated hosts and services, one file for every few hosts */
+int
+write_parse_benchmark_config(char *dir, int num_hosts, int services_per_host, int hosts_per_file, int parse_threads) {
+	char filename[256];
+	FILE *fp = NULL;
+	int x = 0;
+	int y = 0;
+
+	snprintf(filename, sizeof(filename), "%s/objects", dir);
+	mkdir(dir, 0755);
+	mkdir(filename, 0755);
+
+	snprintf(filename, sizeof(filename), "%s/icinga.cfg", dir);
+	if ((fp = fopen(filename, "w")) == NULL)
+		return ERROR;
+	fprintf(fp, "cfg_dir=objects\nobject_cache_file=%s/objects.cache\nprecached_object_file=%s/objects.precache\nobject_parse_threads=%d\n", dir, dir, parse_threads);
+	fclose(fp);
+
+	snprintf(filename, sizeof(filename), "%s/objects/templates.cfg", dir);
+	if ((fp = fopen(filename, "w")) == NULL)
+		return ERROR;
+	fprintf(fp, "define timeperiod{\n\ttimeperiod_name\t24x7\n\talias\t24x7\n\tmonday\t00:00-24:00\n\tsunday\t00:00-24:00\n}\n\n");
+	fprintf(fp, "define command{\n\tcommand_name\tcheck_dummy\n\tcommand_line\t/bin/true $ARG1$\n}\n\n");
+	fprintf(fp, "define contact{\n\tcontact_name\tadmin\n\thost_notification_period\t24x7\n\tservice_notification_period\t24x7\n\thost_notification_options\td,u,r\n\tservice_notification_options\tw,u,c,r\n\thost_notification_commands\tcheck_dummy\n\tservice_notification_commands\tcheck_dummy\n}\n\n");
+	fprintf(fp, "define host{\n\tname\tgeneric-host\n\tcheck_command\tcheck_dummy\n\tmax_check_attempts\t3\n\tcheck_period\t24x7\n\tnotification_period\t24x7\n\tcontacts\tadmin\n\tregister\t0\n}\n\n");
+	fprintf(fp, "define service{\n\tname\tgeneric-service\n\tcheck_command\tcheck_dummy!0\n\tmax_check_attempts\t3\n\tcheck_period\t24x7\n\tnotification_period\t24x7\n\tcontacts\tadmin\n\tregister\t0\n}\n");
+	fclose(fp);
+	fp = NULL;
+
+	for (x = 0; x < num_hosts; x++) {
+		if (x % hosts_per_file == 0) {
+			if (fp != NULL)
+				fclose(fp);
+			snprintf(filename, sizeof(filename), "%s/objects/hosts-%05d.cfg", dir, x / hosts_per_file);
+			if ((fp = fopen(filename, "w")) == NULL)
+				return ERROR;
+		}
+		fprintf(fp, "define host{\n\tuse\t\tgeneric-host\n\thost_name\thost-%06d\n\talias\t\thost %d ; generated\n\taddress\t\t10.%d.%d.%d\n\t_RACK\t\t%d\n}\n\n", x, x, x >> 16, (x >> 8) & 255, x & 255, x % 40);
+		for (y = 0; y < services_per_host; y++)
+			fprintf(fp, "define service{\n\tuse\t\t\tgeneric-service\n\thost_name\t\thost-%06d\n\tservice_description\tservice-%03d\n\tcheck_command\t\tcheck_dummy!%d\n\t_PRIORITY\t\t%d\n\t}\n\n", x, y, y, y % 5);
+	}
+	if (fp != NULL)
+		fclose(fp);
+
+	return OK;
+}
+
+/* compares the startup time for object config files read one after another and by parse threads */
+void
+benchmark_config_parsing(int num_hosts, int services_per_host, int hosts_per_file) {
+	struct timeval start;
+	double serial_read = 0.0;
+	double parallel_read = 0.0;
+	unsigned long serial_objects = 0L;
+	unsigned long parallel_objects = 0L;
+	int serial_result = ERROR;
+	int parallel_result = ERROR;
+	int num_services = 0;
+	service *temp_service = NULL;
+
+	write_parse_benchmark_config("var/parse-serial", num_hosts, services_per_host, hosts_per_file, 1);
+	write_parse_benchmark_config("var/parse-parallel", num_hosts, services_per_host, hosts_per_file, 4);
+
+	reset_variables();
+	gettimeofday(&start, NULL);
+	serial_result = read_object_config_data("var/parse-serial/icinga.cfg", READ_ALL_OBJECT_DATA, FALSE, FALSE);
+	serial_read = elapsed_seconds(&start);
+	serial_objects = fingerprint_objects();
+	free_memory(get_global_macros());
+
+	reset_variables();
+	gettimeofday(&start, NULL);
+	parallel_result = read_object_config_data("var/parse-parallel/icinga.cfg", READ_ALL_OBJECT_DATA, FALSE, FALSE);
+	parallel_read = elapsed_seconds(&start);
+	parallel_objects = fingerprint_objects();
+	for (temp_service = service_list; temp_service != NULL; temp_service = temp_service->next)
+		num_services++;
+	free_memory(get_global_macros());
+
+	ok(serial_result == OK && parallel_result == OK && num_services == num_hosts * services_per_host && parallel_objects == serial_objects, "Parse threads read the same %d services as a single thread", num_services);
+	diag("%d services in %d files: read in %.3fs with one thread, %.3fs with 4 parse threads", num_hosts * services_per_host, num_hosts / hosts_per_file + 1, serial_read, parallel_read);
+
+	system("rm -rf var/parse-serial var/parse-parallel");
+}
+
+/* compares expanding precompiled macro tokens with process_macros_r() on the loaded config */
+void
+benchmark_macro_expansion(int rounds) {
+	char *inputs[] = {
+		"", "$", "$$", "a$$b$", "no macros here", "$HOSTNAME$", "$HOSTNAME", "$NOSUCHMACRO$", "x $ARG40$ y",
+		"$USER1$/check_foo $ARG1$!$ARG2$", "$HOSTSTATE:host1$ $_HOSTSNMP_COMMUNITY$ $_HOSTNOSUCHVAR$",
+		"$SERVICEDESC$ on $HOSTADDRESS$ ($HOSTALIAS$)", "$HOSTNAME:nosuchhost$"
+	};
+	char *command_line = "$USER1$/check_snmp -H $HOSTADDRESS$ -C $_HOSTSNMP_COMMUNITY$ -o $ARG1$ -w $ARG2$ -c $ARG3$ -l '$HOSTNAME$ $SERVICEDESC$' -p $HOSTSTATE:host1$";
+	command temp_command;
+	icinga_macros mac;
+	host *temp_host = NULL;
+	service *temp_service = NULL;
+	macro_token *tokens = NULL;
+	char *long_line = NULL;
+	char *output = NULL;
+	char *token_output = NULL;
+	struct timeval start;
+	double string_time = 0.0;
+	double token_time = 0.0;
+	int matched = 0;
+	int x = 0;
+
+	keep_unknown_macros = TRUE;
+
+	temp_host = find_host("host1");
+	for (temp_service = service_list; temp_service != NULL; temp_service = temp_service->next) {
+		if (!strcmp(temp_service->host_name, temp_host->name))
+			break;
+	}
+	add_custom_variable_to_host(temp_host, "SNMP_COMMUNITY", "public");
+
+	memset(&mac, 0, sizeof(mac));
+	grab_host_macros_r(&mac, temp_host);
+	grab_service_macros_r(&mac, temp_service);
+	mac.argv[0] = strdup(".1.3.6.1.2.1.1.3.0");
+	mac.argv[1] = strdup("80");
+	mac.argv[2] = strdup("90");
+
+	for (x = 0; x < sizeof(inputs) / sizeof(inputs[0]); x++) {
+		process_macros_r(&mac, inputs[x], &output, STRIP_ILLEGAL_MACRO_CHARS | ESCAPE_MACRO_CHARS);
+		tokens = compile_macro_tokens(inputs[x]);
+		process_macro_tokens_r(&mac, tokens, &token_output, STRIP_ILLEGAL_MACRO_CHARS | ESCAPE_MACRO_CHARS);
+		if (output != NULL && token_output != NULL && !strcmp(output, token_output))
+			matched++;
+		else
+			diag("'%s' expanded to '%s' and '%s'", inputs[x], output ? output : "", token_output ? token_output : "");
+		free_macro_tokens(tokens);
+		my_free(output);
+		my_free(token_output);
+	}
+	ok(matched == sizeof(inputs) / sizeof(inputs[0]), "Macro tokens expand the same as the original strings");
+
+	memset(&temp_command, 0, sizeof(temp_command));
+	temp_command.command_line = command_line;
+
+	process_macros_r(&mac, command_line, &output, 0);
+	process_command_macros_r(&mac, &temp_command, &token_output, 0);
+	ok(output != NULL && token_output != NULL && !strcmp(output, token_output) && strstr(output, "-C public -o .1.3.6.1.2.1.1.3.0 -w 80 -c 90") != NULL, "Command line is expanded through its cached macro tokens");
+	my_free(output);
+	my_free(token_output);
+
+	gettimeofday(&start, NULL);
+	for (x = 0; x < rounds; x++) {
+		process_macros_r(&mac, command_line, &output, 0);
+		my_free(output);
+	}
+	string_time = elapsed_seconds(&start);
+
+	gettimeofday(&start, NULL);
+	for (x = 0; x < rounds; x++) {
+		process_command_macros_r(&mac, &temp_command, &output, 0);
+		my_free(output);
+	}
+	token_time = elapsed_seconds(&start);
+	diag("%d command line expansions: string %.3fs, cached tokens %.3fs", rounds, string_time, token_time);
+
+	/* a long line with many macros must not take quadratic time */
+	long_line = (char *)malloc((rounds * 8) + 1);
+	for (x = 0; x < rounds; x++)
+		memcpy(long_line + (x * 8), "$ARG2$  ", 8);
+	long_line[rounds * 8] = '\x0';
+	gettimeofday(&start, NULL);
+	process_macros_r(&mac, long_line, &output, 0);
+	string_time = elapsed_seconds(&start);
+	ok(output != NULL && strlen(output) == rounds * 4, "Line with %d macros expanded", rounds);
+	diag("%d macros in one line expanded in %.3fs", rounds, string_time);
+	my_free(output);
+	my_free(long_line);
+
+	/* lazy environment macros only export what the command line uses */
+	enable_environment_macros = TRUE;
+	lazy_environment_macros = TRUE;
+	process_command_macros_r(&mac, &temp_command, &output, 0);
+	my_free(output);
+	set_all_macro_environment_vars_r(&mac, TRUE);
+	ok(getenv(MACRO_ENV_VAR_PREFIX "HOSTNAME") != NULL && !strcmp(getenv(MACRO_ENV_VAR_PREFIX "HOSTNAME"), "host1") && getenv(MACRO_ENV_VAR_PREFIX "ARG2") != NULL && getenv(MACRO_ENV_VAR_PREFIX "_HOSTSNMP_COMMUNITY") != NULL && getenv(MACRO_ENV_VAR_PREFIX "HOSTALIAS") == NULL, "Lazy environment macros are only set for used macros");
+	set_all_macro_environment_vars_r(&mac, FALSE);
+	ok(getenv(MACRO_ENV_VAR_PREFIX "HOSTNAME") == NULL && getenv(MACRO_ENV_VAR_PREFIX "_HOSTSNMP_COMMUNITY") == NULL, "Lazy environment macros are unset again");
+
+	gettimeofday(&start, NULL);
+	for (x = 0; x < rounds / 100; x++) {
+		grab_host_macros_r(&mac, temp_host);
+		grab_service_macros_r(&mac, temp_service);
+		set_all_macro_environment_vars_r(&mac, TRUE);
+		set_all_macro_environment_vars_r(&mac, FALSE);
+	}
+	token_time = elapsed_seconds(&start);
+
+	lazy_environment_macros = FALSE;
+	gettimeofday(&start, NULL);
+	for (x = 0; x < rounds / 100; x++) {
+		grab_host_macros_r(&mac, temp_host);
+		grab_service_macros_r(&mac, temp_service);
+		clear_summary_macros_r(&mac);
+		set_all_macro_environment_vars_r(&mac, TRUE);
+		set_all_macro_environment_vars_r(&mac, FALSE);
+	}
+	string_time = elapsed_seconds(&start);
+	diag("%d environment macro exports: all macros %.3fs, used macros %.3fs", rounds / 100, string_time, token_time);
+
+	free_macro_tokens(temp_command.macro_tokens);
+	clear_volatile_macros_r(&mac);
+	keep_unknown_macros = FALSE;
+}
+
+/* checks that results sent through the in-memory channel end up on the check result list */
+void test_check_result_channel(void) {
+	check_result cr;
+	check_result *temp_cr = NULL;
+	int host_results = 0;
+	int service_results = 0;
+	int x = 0;
+
+	ok(open_check_result_channel() == OK, "Check result channel opened");
+
+	init_check_result(&cr);
+	cr.object_check_type = SERVICE_CHECK;
+	cr.host_name = "host1";
+	cr.service_description = "Dummy service";
+	cr.check_type = SERVICE_CHECK_ACTIVE;
+	cr.scheduled_check = TRUE;
+	cr.start_time.tv_sec = 1234567890L;
+	cr.finish_time.tv_sec = 1234567891L;
+	cr.return_code = STATE_WARNING;
+	cr.output_file = NULL;
+	for (x = 0; x < 10; x++) {
+		if (submit_check_result(&cr, "WARNING - channel test|time=1s") == ERROR)
+			break;
+	}
+	cr.object_check_type = HOST_CHECK;
+	cr.service_description = NULL;
+	cr.check_type = HOST_CHECK_ACTIVE;
+	cr.return_code = STATE_OK;
+	if (x == 10 && submit_check_result(&cr, "PING OK") == OK)
+		x++;
+	ok(x == 11, "Results sent through the channel without result files");
+
+	ok(read_check_result_channel() == 11, "All results read from the channel");
+
+	while ((temp_cr = read_check_result()) != NULL) {
+		if (temp_cr->object_check_type == SERVICE_CHECK && !strcmp(temp_cr->host_name, "host1") && temp_cr->service_description != NULL && !strcmp(temp_cr->service_description, "Dummy service")
+		        && temp_cr->return_code == STATE_WARNING && temp_cr->scheduled_check == TRUE && temp_cr->finish_time.tv_sec == 1234567891L && !strcmp(temp_cr->output, "WARNING - channel test|time=1s"))
+			service_results++;
+		else if (temp_cr->object_check_type == HOST_CHECK && !strcmp(temp_cr->host_name, "host1") && temp_cr->service_description == NULL && temp_cr->return_code == STATE_OK && !strcmp(temp_cr->output, "PING OK"))
+			host_results++;
+		free_check_result(temp_cr);
+		my_free(temp_cr);
+	}
+	ok(service_results == 10 && host_results == 1, "Results on the check result list match what was sent") || diag("service_results=%d host_results=%d", service_results, host_results);
+
+	/* without the channel, and without a result file to fall back to, the result can't be delivered */
+	close_check_result_channel();
+	ok(submit_check_result(&cr, "PING OK") == ERROR && read_check_result_channel() == 0, "Results are not lost silently without the channel");
+}
+
 int main(int argc, char **argv) {
 	int result;
 	int error = FALSE;
@@ -346,8 +1287,12 @@ int main(int argc, char **argv) {
 	host *temp_host = NULL;
 	hostgroup *temp_hostgroup = NULL;
 	hostsmember *temp_member = NULL;
+	service *temp_service = NULL;
+	command *temp_command = NULL;
+	timeperiod *temp_timeperiod = NULL;
+	contact *temp_contact = NULL;
 
-	plan(4);
+	plan(33);
 
 	/* reset program variables */
 	reset_variables();
@@ -381,8 +1326,55 @@ int main(int argc, char **argv) {
 		//printf("host pointer=%d\n", temp_member->host_ptr);
 	}
 
+	result = OK;
+	for (temp_host = host_list; temp_host != NULL; temp_host = temp_host->next) {
+		if (find_host(temp_host->name) != temp_host)
+			result = ERROR;
+	}
+	ok(result == OK, "All hosts found by name");
+
+	result = OK;
+	for (temp_service = service_list; temp_service != NULL; temp_service = temp_service->next) {
+		if (find_service(temp_service->host_name, temp_service->description) != temp_service)
+			result = ERROR;
+	}
+	ok(result == OK, "All services found by host name and description");
+
+	result = OK;
+	for (temp_command = command_list; temp_command != NULL; temp_command = temp_command->next) {
+		if (find_command(temp_command->name) != temp_command)
+			result = ERROR;
+	}
+	for (temp_timeperiod = timeperiod_list; temp_timeperiod != NULL; temp_timeperiod = temp_timeperiod->next) {
+		if (find_timeperiod(temp_timeperiod->name) != temp_timeperiod)
+			result = ERROR;
+	}
+	for (temp_contact = contact_list; temp_contact != NULL; temp_contact = temp_contact->next) {
+		if (find_contact(temp_contact->name) != temp_contact)
+			result = ERROR;
+	}
+	ok(result == OK, "All commands, timeperiods and contacts found by name");
+
+	ok(find_host("nosuchhost") == NULL && find_service("host1", "nosuchservice") == NULL && find_command("nosuchcommand") == NULL, "Unknown names are not found");
+
+	benchmark_macro_expansion(100000);
+
 	cleanup();
 
+	check_binary_object_cache();
+
+	test_check_result_channel();
+
+	check_template_inheritance();
+
+	benchmark_config_parsing(2000, 100, 10);
+
+	benchmark_object_lookups(20000, 20, 3);
+
+	benchmark_status_updates(2000, 20, 200, 5);
+
+	benchmark_retention(2000, 20, 200);
+
 	my_free(config_file);
 
 	return exit_status();
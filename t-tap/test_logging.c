@@ -22,6 +22,7 @@
 #include "objects.h"
 #include "tap.h"
 #include "../common/shared.c"
+#include "../common/logindex.c"
 
 #define TEST_LOGGING 1
 #include "test-stubs.c"
@@ -51,14 +52,17 @@ main(int argc, char **argv) {
 	struct stat stat_info, stat_new;
 	char *log_filename_localtime = NULL;
 	char *temp_command = NULL;
+	char *index_filename = NULL;
 	struct tm *t;
+	logindex *log_index = NULL;
 
-	plan(14);
+	plan(20);
 
 	rotation_time = (time_t)1242949698;
 	t = localtime(&rotation_time);
 
 	asprintf(&log_filename_localtime, "var/icinga-%02d-%02d-%d-%02d.log", t->tm_mon + 1, t->tm_mday, t->tm_year + 1900, t->tm_hour);
+	asprintf(&index_filename, "%s%s", log_filename_localtime, LOGINDEX_SUFFIX);
 
 	log_rotation_method = 5;
 	ok(rotate_log_file(rotation_time) == ERROR, "Got error for a bad log_rotation_method");
@@ -79,13 +83,33 @@ main(int argc, char **argv) {
 	asprintf(&temp_command, "diff var/icinga.log.dummy %s", log_filename_localtime);
 	ok(system(temp_command) == 0, "icinga log archived correctly");
 
+	log_index = open_log_index(log_filename_localtime, NULL);
+	ok(log_index != NULL && log_index->header->entry_count == 0, "Got empty index for archive without timestamps");
+	close_log_index(log_index);
+
 	unlink(log_filename_localtime);
+	unlink(index_filename);
 	ok(system("chmod 777 var/icinga.log") == 0, "Changed mode of icinga.log");
 	ok(stat("var/icinga.log", &stat_info) == 0, "Got stat info for log file");
 	ok(rotate_log_file(rotation_time) == OK, "Log rotate to check if mode is retained");
 	ok(stat(log_filename_localtime, &stat_new) == 0, "Got new stat info for archived log file");
 	ok(stat_info.st_mode == stat_new.st_mode, "Mode for archived file same as original log file");
 
+	/* the archive holds the log rotation and log version entries of the first rotation */
+	log_index = open_log_index(log_filename_localtime, NULL);
+	ok(log_index != NULL && log_index->header->entry_count == 2 && (log_index->header->flags & LOGINDEX_SORTED), "Got sorted index with two entries");
+	ok(log_index != NULL && log_index->entries[0].type == LOGENTRY_LOG_ROTATION && log_index->entries[0].timestamp == (unsigned long)rotation_time, "Index entry has type and timestamp of log rotation");
+	ok(find_log_index_entry(log_index, rotation_time + 1) == 2, "No index entries after rotation time");
+	close_log_index(log_index);
+
+	ok(write_log_index(log_filename_localtime, "var/icinga-cached.idx") == OK && (log_index = open_log_index(log_filename_localtime, "var/icinga-cached.idx")) != NULL && log_index->header->entry_count == 2, "Wrote index to other location");
+	close_log_index(log_index);
+
+	asprintf(&temp_command, "echo >> %s", log_filename_localtime);
+	ok(system(temp_command) == 0 && open_log_index(log_filename_localtime, NULL) == NULL && open_log_index(log_filename_localtime, "var/icinga-cached.idx") == NULL, "Index ignored if archive has changed");
+	unlink(index_filename);
+	unlink("var/icinga-cached.idx");
+
 	ok(stat("var/icinga.log", &stat_new) == 0, "Got new stat info for new log file");
 	ok(stat_info.st_mode == stat_new.st_mode, "Mode for new log file kept same as original log file");
 
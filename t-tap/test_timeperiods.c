@@ -45,6 +45,7 @@
 #include "../include/nebmods.h"
 #include "../include/nebmodules.h"
 #include "tap.h"
+#include "test-timing.c"
 
 char		*config_file = NULL;
 char		*log_file = NULL;
@@ -212,8 +213,12 @@ double          high_host_flap_threshold = DEFAULT_HIGH_HOST_FLAP_THRESHOLD;
 
 int             use_large_installation_tweaks = DEFAULT_USE_LARGE_INSTALLATION_TWEAKS;
 int             enable_environment_macros = TRUE;
+int             lazy_environment_macros = FALSE;
 int             free_child_process_memory = -1;
 int             child_processes_fork_twice = -1;
+int             check_worker_processes = DEFAULT_CHECK_WORKER_PROCESSES;
+int             check_result_reaper_threads = DEFAULT_CHECK_RESULT_REAPER_THREADS;
+int             max_async_commands = DEFAULT_MAX_ASYNC_COMMANDS;
 
 int             enable_embedded_perl = DEFAULT_ENABLE_EMBEDDED_PERL;
 int             use_embedded_perl_implicitly = DEFAULT_USE_EMBEDDED_PERL_IMPLICITLY;
@@ -223,7 +228,6 @@ int             date_format = DATE_FORMAT_US;
 char            *use_timezone = NULL;
 
 int             command_file_fd;
-FILE            *command_file_fp;
 int             command_file_created = FALSE;
 
 int		allow_empty_hostgroup_assignment = DEFAULT_ALLOW_EMPTY_HOSTGROUP_ASSIGNMENT;
@@ -239,7 +243,7 @@ extern host 		*host_list;
 notification    *notification_list;
 
 check_result    check_result_info;
-check_result    *check_result_list = NULL;
+check_result_queue check_result_list;
 unsigned long	max_check_result_file_age = DEFAULT_MAX_CHECK_RESULT_AGE;
 
 dbuf            check_result_dbuf;
@@ -250,6 +254,8 @@ pthread_t       worker_threads[TOTAL_WORKER_THREADS];
 int             external_command_buffer_slots = DEFAULT_EXTERNAL_COMMAND_BUFFER_SLOTS;
 
 check_stats     check_statistics[MAX_CHECK_STATS_TYPES];
+unsigned long   check_result_channel_stats[CHECK_RESULT_CHANNELS];
+async_command_stats async_command_statistics;
 
 char            *debug_file;
 int             debug_level = DEFAULT_DEBUG_LEVEL;
@@ -283,8 +289,8 @@ int 		enable_state_based_escalation_ranges = FALSE;
 
 /* Dummy variables */
 sched_info scheduling_info;
-timed_event event_list_low;
-timed_event event_list_high;
+timed_event_queue event_queue_low;
+timed_event_queue event_queue_high;
 
 /* Dummy functions */
 void logit(int data_type, int display, const char *fmt, ...) {}
@@ -294,6 +300,8 @@ int write_to_log(char *buffer, unsigned long data_type, time_t *timestamp) {}
 int log_debug_info(int level, int verbosity, const char *fmt, ...) {}
 int close_log_file(void) {}
 int chown_debug_log(uid_t uid, gid_t gid) {}
+int fix_log_file_owner(uid_t uid, gid_t gid) {}
+int init_command_file_worker_thread(void) {}
 
 int neb_free_callback_list(void) {}
 void broker_program_status(int type, int flags, int attr, struct timeval *timestamp) {}
@@ -305,9 +313,11 @@ int neb_add_module(char *filename, char *args, int should_be_loaded) {}
 void broker_system_command(int type, int flags, int attr, struct timeval start_time, struct timeval end_time, double exectime, int timeout, int early_timeout, int retcode, char *cmd, char *output, struct timeval *timestamp) {}
 
 int schedule_new_event(int event_type, int high_priority, time_t run_time, int recurring, unsigned long event_interval, void *timing_func, int compensate_for_time_change, void *event_data, void *event_args, int event_options) {}
+void free_check_deadline_queues(void) {}
 int my_tcp_connect(char *host_name, int port, int *sd, int timeout) {}
 int my_recvall(int s, char *buf, int *len, int timeout) {}
 int neb_free_module_list(void) {}
+void free_event_queue(timed_event_queue *event_queue) {}
 
 /* Icinga special */
 int     event_profiling_enabled = FALSE;
@@ -317,6 +327,46 @@ void    profiler_update(int event, struct timeval start) {}
 void remove_host_acknowledgement(host * hst) {}
 void remove_service_acknowledgement(service * svc) {}
 
+/* compares the precompiled timeperiods with _check_time_against_period() over three weeks and measures both */
+void benchmark_timeperiods(char *tz, time_t start_time) {
+	timeperiod *temp_timeperiod = NULL;
+	struct timeval start;
+	double compiled_elapsed = 0.0;
+	double uncompiled_elapsed = 0.0;
+	time_t test_time;
+	time_t end_time = start_time + (21 * 24 * 3600);
+	int calls = 0;
+	int mismatches = 0;
+	int result = 0;
+
+	putenv(tz);
+	tzset();
+	invalidate_compiled_timeperiods();
+
+	for (temp_timeperiod = timeperiod_list; temp_timeperiod != NULL; temp_timeperiod = temp_timeperiod->next) {
+
+		gettimeofday(&start, NULL);
+		for (test_time = start_time; test_time < end_time; test_time += 61)
+			result += check_time_against_period(test_time, temp_timeperiod);
+		compiled_elapsed += elapsed_seconds(&start);
+
+		gettimeofday(&start, NULL);
+		for (test_time = start_time; test_time < end_time; test_time += 61, calls++)
+			result += _check_time_against_period(test_time, temp_timeperiod);
+		uncompiled_elapsed += elapsed_seconds(&start);
+
+		for (test_time = start_time; test_time < end_time; test_time += 61) {
+			if (check_time_against_period(test_time, temp_timeperiod) != _check_time_against_period(test_time, temp_timeperiod)) {
+				if (mismatches++ == 0)
+					diag("%s: first mismatch at %lu", temp_timeperiod->name, (unsigned long)test_time);
+			}
+		}
+	}
+
+	ok(mismatches == 0, "Precompiled timeperiods match _check_time_against_period() with %s", tz) || diag("mismatches=%d", mismatches);
+	diag("%s: %.0f checks/second precompiled, %.0f checks/second uncompiled", tz, (compiled_elapsed > 0.0) ? calls / compiled_elapsed : 0.0, (uncompiled_elapsed > 0.0) ? calls / uncompiled_elapsed : 0.0);
+}
+
 int main(int argc, char **argv) {
 	int result;
 	int error = FALSE;
@@ -338,7 +388,7 @@ int main(int argc, char **argv) {
 	int is_valid_time = 0;
 	int iterations = 1000;
 
-	plan(6043);
+	plan(6046);
 
 	/* reset program variables */
 	reset_variables();
@@ -580,6 +630,11 @@ int main(int argc, char **argv) {
 	_get_next_valid_time_per_timeperiod(test_time, &chosen_valid_time, test_time, temp_timeperiod);
 	ok(chosen_valid_time == 1268115300, "Next valid time=Tue Mar  9 01:15:00 2010");
 
+	/* around the dst changes of 2009 and 2010 */
+	benchmark_timeperiods("TZ=Europe/London", 1256425200 - (7 * 24 * 3600));
+	benchmark_timeperiods("TZ=America/New_York", 1268109420 - (7 * 24 * 3600));
+	benchmark_timeperiods("TZ=UTC", 1278939600);
+
 	cleanup();
 
 	my_free(config_file);
@@ -0,0 +1,382 @@
+/*****************************************************************************
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*
+*****************************************************************************/
+
+#define NSCORE 1
+#include "config.h"
+#include "common.h"
+#include "objects.h"
+#include "macros.h"
+#include "icinga.h"
+#include "broker.h"
+#include "../base/workers.c"
+#include "../base/sehandlers.c"
+#include "../base/notifications.c"
+#include "tap.h"
+
+int             check_worker_processes = 1;
+int             max_async_commands = 0;
+int             enable_environment_macros = FALSE;
+int             service_check_timeout_state = STATE_CRITICAL;
+unsigned long   max_debug_file_size = 0L;
+unsigned long   check_result_channel_stats[CHECK_RESULT_CHANNELS];
+async_command_stats async_command_statistics;
+int             notification_timeout = 1;
+int             event_handler_timeout = 1;
+int             ocsp_timeout = 1;
+int             ochp_timeout = 1;
+int             interval_length = 60;
+int             log_notifications = TRUE;
+int             log_event_handlers = TRUE;
+int             enable_notifications = TRUE;
+int             enable_event_handlers = TRUE;
+int             enable_state_based_escalation_ranges = FALSE;
+int             obsess_over_services = FALSE;
+int             obsess_over_hosts = FALSE;
+unsigned long   next_notification_id = 0L;
+unsigned long   next_event_id = 0L;
+unsigned long   next_problem_id = 0L;
+time_t          program_start = 0L;
+char            *global_host_event_handler = NULL;
+char            *global_service_event_handler = NULL;
+command         *global_host_event_handler_ptr = NULL;
+command         *global_service_event_handler_ptr = NULL;
+char            *ocsp_command = NULL;
+char            *ochp_command = NULL;
+command         *ocsp_command_ptr = NULL;
+command         *ochp_command_ptr = NULL;
+notification    *notification_list = NULL;
+contact         *contact_list = NULL;
+serviceescalation *serviceescalation_list = NULL;
+hostescalation  *hostescalation_list = NULL;
+#ifdef EMBEDDEDPERL
+int             use_embedded_perl = FALSE;
+int file_uses_embedded_perl(char *fname) { return FALSE; }
+#endif
+
+/* everything logged since the test last cleared it */
+char logged[8192] = "";
+
+void logit(int data_type, int display, const char *fmt, ...) {
+	size_t len = strlen(logged);
+	va_list ap;
+
+	va_start(ap, fmt);
+	vsnprintf(logged + len, sizeof(logged) - len, fmt, ap);
+	va_end(ap);
+}
+
+int log_debug_info(int level, int verbosity, const char *fmt, ...) { return OK; }
+int close_command_file(void) { return OK; }
+int close_check_result_channel(void) { return OK; }
+void reset_sighandler(void) {}
+int set_all_macro_environment_vars_r(icinga_macros *mac, int set) { return OK; }
+void broker_system_command(int type, int flags, int attr, struct timeval start_time, struct timeval end_time, double exectime, int timeout, int early_timeout, int retcode, char *cmd, char *output, struct timeval *timestamp) {}
+int has_shell_metachars(const char *command) { return TRUE; }
+int write_to_all_logs(char *buffer, unsigned long data_type) { return OK; }
+int my_system_r(icinga_macros *mac, char *cmd, int timeout, int *early_timeout, double *exectime, char **output, int max_output_length) { return OK; }
+int get_raw_command_line_r(icinga_macros *mac, command *cmd_ptr, char *cmd, char **full_command, int macro_options) { return ERROR; }
+int process_command_macros_r(icinga_macros *mac, command *cmd_ptr, char **output, int options) { return ERROR; }
+int process_macros_r(icinga_macros *mac, char *input_buffer, char **output_buffer, int options) { return ERROR; }
+int grab_host_macros_r(icinga_macros *mac, host *hst) { return OK; }
+int grab_service_macros_r(icinga_macros *mac, service *svc) { return OK; }
+int grab_contact_macros_r(icinga_macros *mac, contact *cntct) { return OK; }
+int clear_argv_macros_r(icinga_macros *mac) { return OK; }
+int clear_host_macros_r(icinga_macros *mac) { return OK; }
+int clear_service_macros_r(icinga_macros *mac) { return OK; }
+int clear_contact_macros_r(icinga_macros *mac) { return OK; }
+int clear_summary_macros_r(icinga_macros *mac) { return OK; }
+int clear_volatile_macros_r(icinga_macros *mac) { return OK; }
+int check_for_external_commands(void) { return OK; }
+int check_host_dependencies(host *hst, int dependency_type) { return DEPENDENCIES_OK; }
+int check_service_dependencies(service *svc, int dependency_type) { return DEPENDENCIES_OK; }
+int check_time_against_period(time_t test_time, timeperiod *tperiod) { return OK; }
+void get_next_valid_time(time_t pref_time, time_t *valid_time, timeperiod *tperiod) { *valid_time = pref_time; }
+host *find_host(char *name) { return NULL; }
+service *find_service(char *host_name, char *svc_desc) { return NULL; }
+contact *find_contact(char *name) { return NULL; }
+hostescalation *get_first_hostescalation_by_host(char *host_name, void **ptr) { return NULL; }
+hostescalation *get_next_hostescalation_by_host(char *host_name, void **ptr) { return NULL; }
+serviceescalation *get_first_serviceescalation_by_service(char *host_name, char *svc_description, void **ptr) { return NULL; }
+serviceescalation *get_next_serviceescalation_by_service(char *host_name, char *svc_description, void **ptr) { return NULL; }
+void free_notification_list(void) {}
+int update_host_status(host *hst, int aggregated_dump) { return OK; }
+int update_service_status(service *svc, int aggregated_dump) { return OK; }
+int broker_notification_data(int type, int flags, int attr, int notification_type, int reason_type, struct timeval start_time, struct timeval end_time, void *data, char *ack_author, char *ack_data, int escalated, int contacts_notified, struct timeval *timestamp) { return OK; }
+int broker_contact_notification_data(int type, int flags, int attr, int notification_type, int reason_type, struct timeval start_time, struct timeval end_time, void *data, contact *cntct, char *ack_author, char *ack_data, int escalated, struct timeval *timestamp) { return OK; }
+void broker_statechange_data(int type, int flags, int attr, int statechange_type, void *data, int state, int state_type, int current_attempt, int max_attempts, struct timeval *timestamp) {}
+
+/* what the broker was told when the last event handler ended */
+int eventhandler_ends = 0;
+int eventhandler_end_retcode = 0;
+int eventhandler_end_early_timeout = FALSE;
+char eventhandler_end_output[1024] = "";
+struct timeval eventhandler_end_time;
+void *eventhandler_end_object = NULL;
+
+int broker_event_handler(int type, int flags, int attr, int eventhandler_type, void *data, int state, int state_type, struct timeval start_time, struct timeval end_time, double exectime, int timeout, int early_timeout, int retcode, char *cmd, char *cmdline, char *output, struct timeval *timestamp) {
+
+	if (type != NEBTYPE_EVENTHANDLER_END)
+		return OK;
+
+	eventhandler_ends++;
+	eventhandler_end_retcode = retcode;
+	eventhandler_end_early_timeout = early_timeout;
+	snprintf(eventhandler_end_output, sizeof(eventhandler_end_output), "%s", (output == NULL) ? "(null)" : output);
+	eventhandler_end_time = end_time;
+	eventhandler_end_object = data;
+	return OK;
+}
+
+/* what the broker was told when the last notification method ended */
+int notification_method_ends = 0;
+struct timeval notification_method_end_time;
+void *notification_method_end_object = NULL;
+contact *notification_method_end_contact = NULL;
+char notification_method_end_author[64] = "";
+
+int broker_contact_notification_method_data(int type, int flags, int attr, int notification_type, int reason_type, struct timeval start_time, struct timeval end_time, void *data, contact *cntct, char *cmd, char *ack_author, char *ack_data, int escalated, struct timeval *timestamp) {
+
+	if (type != NEBTYPE_CONTACTNOTIFICATIONMETHOD_END)
+		return OK;
+
+	notification_method_ends++;
+	notification_method_end_time = end_time;
+	notification_method_end_object = data;
+	notification_method_end_contact = cntct;
+	snprintf(notification_method_end_author, sizeof(notification_method_end_author), "%s", (ack_author == NULL) ? "(null)" : ack_author);
+	return OK;
+}
+int parse_command_line(char *cmd, char *argv[MAX_CMD_ARGS]) { return ERROR; }
+char *escape_newlines(char *rawbuf) { return strdup(rawbuf); }
+
+int dbuf_init(dbuf *db, int chunk_size) {
+	db->buf = NULL;
+	db->used_size = 0L;
+	db->allocated_size = 0L;
+	db->chunk_size = chunk_size;
+	return OK;
+}
+
+int dbuf_strcat(dbuf *db, char *buf) {
+	unsigned long len = strlen(buf);
+
+	if (db->used_size + len + 1 > db->allocated_size) {
+		db->allocated_size = db->used_size + len + 1 + db->chunk_size;
+		db->buf = realloc(db->buf, db->allocated_size);
+	}
+	memcpy(db->buf + db->used_size, buf, len + 1);
+	db->used_size += len;
+	return OK;
+}
+
+int dbuf_free(dbuf *db) {
+	my_free(db->buf);
+	db->used_size = 0L;
+	db->allocated_size = 0L;
+	return OK;
+}
+
+int free_check_result(check_result *info) {
+	my_free(info->host_name);
+	my_free(info->service_description);
+	my_free(info->output);
+	return OK;
+}
+
+/* results the workers hand back end up here instead of on the check result list */
+check_result *received_result = NULL;
+
+int add_check_result_to_list(check_result *new_cr) {
+	received_result = new_cr;
+	return OK;
+}
+
+check_result *new_service_check_result(void) {
+	check_result *cr = (check_result *)calloc(1, sizeof(check_result));
+
+	cr->object_check_type = SERVICE_CHECK;
+	cr->host_name = strdup("host1");
+	cr->service_description = strdup("service1");
+	cr->check_type = SERVICE_CHECK_ACTIVE;
+	gettimeofday(&cr->start_time, NULL);
+	cr->finish_time = cr->start_time;
+	return cr;
+}
+
+/* reads worker results until one arrives or the timeout passes */
+check_result *wait_for_worker_result(int timeout) {
+	time_t deadline = time(NULL) + timeout;
+
+	received_result = NULL;
+	while (received_result == NULL && time(NULL) <= deadline) {
+		read_check_worker_results();
+		if (received_result == NULL)
+			usleep(10000);
+	}
+	return received_result;
+}
+
+/* handles asynchronous commands until none are queued or running or the timeout passes */
+int wait_for_async_commands(int timeout) {
+	time_t deadline = time(NULL) + timeout;
+
+	while ((async_command_queue != NULL || async_command_statistics.running > 0) && time(NULL) <= deadline) {
+		handle_async_commands();
+		usleep(10000);
+	}
+	return (async_command_queue == NULL && async_command_statistics.running == 0) ? TRUE : FALSE;
+}
+
+/* completion handler of plain asynchronous commands, remembers the order they finished in */
+char finished_commands[256] = "";
+
+void record_finished_command(void *data, char *processed_command, int result, int early_timeout, double exectime, struct timeval *end_time, char *output) {
+
+	strncat(finished_commands, (char *)data, sizeof(finished_commands) - strlen(finished_commands) - 1);
+}
+
+double seconds_between(struct timeval *earlier, struct timeval *later) {
+
+	return (double)(later->tv_sec - earlier->tv_sec) + ((double)(later->tv_usec - earlier->tv_usec) / 1000000.0);
+}
+
+void release_result(check_result *cr) {
+	if (cr == NULL)
+		return;
+	free_check_result(cr);
+	free(cr);
+}
+
+int main(int argc, char **argv) {
+	check_result *cr = NULL;
+	pid_t old_pid = 0;
+	host *hst = NULL;
+	service *svc = NULL;
+	contact *cntct = NULL;
+	struct timeval start_time;
+	struct timeval read_time;
+	int x = 0;
+
+	plan(24);
+
+	ok(init_check_workers() == OK && num_check_workers == 1 && check_workers[0].pid > 0, "Check worker started");
+	ok(check_worker_can_run("/bin/true") == TRUE, "Checks can be handed to the worker");
+
+	/* a plain check goes through the worker and comes back with its output and return code */
+	ok(submit_check_to_worker(new_service_check_result(), NULL, "echo worker output; exit 2", 10) == OK, "Check submitted to the worker");
+	cr = wait_for_worker_result(10);
+	ok(cr != NULL && cr->return_code == 2 && cr->early_timeout == FALSE && cr->exited_ok == TRUE && cr->output != NULL && !strcmp(cr->output, "worker output\n"), "Result came back from the worker") || diag("output=%s", (cr == NULL || cr->output == NULL) ? "(none)" : cr->output);
+	ok(cr != NULL && !strcmp(cr->host_name, "host1") && !strcmp(cr->service_description, "service1") && check_workers[0].running_jobs == 0, "Result belongs to the submitted check");
+	release_result(cr);
+
+	/* plugins that run too long get killed */
+	submit_check_to_worker(new_service_check_result(), NULL, "sleep 30", 1);
+	cr = wait_for_worker_result(10);
+	ok(cr != NULL && cr->early_timeout == TRUE && cr->return_code == STATE_CRITICAL, "Check timed out and was killed");
+	release_result(cr);
+
+	/* a worker that dies fails its checks and gets replaced */
+	submit_check_to_worker(new_service_check_result(), NULL, "sleep 30", 60);
+	old_pid = check_workers[0].pid;
+	kill(old_pid, SIGKILL);
+	cr = wait_for_worker_result(10);
+	ok(cr != NULL && cr->return_code == STATE_UNKNOWN && cr->output != NULL && strstr(cr->output, "worker exited") != NULL, "Check of a dead worker returns UNKNOWN");
+	release_result(cr);
+	ok(check_workers[0].pid > 0 && check_workers[0].pid != old_pid && check_workers[0].sd >= 0, "Dead worker was restarted");
+
+	submit_check_to_worker(new_service_check_result(), NULL, "echo again", 10);
+	cr = wait_for_worker_result(10);
+	ok(cr != NULL && cr->return_code == 0 && !strcmp(cr->output, "again\n"), "Restarted worker runs checks");
+	release_result(cr);
+
+	/* the objects the completion handlers of notifications, event handlers and OCSP/OCHP commands point to */
+	hst = (host *)calloc(1, sizeof(host));
+	hst->name = strdup("host1");
+	svc = (service *)calloc(1, sizeof(service));
+	svc->host_name = strdup("host1");
+	svc->description = strdup("service1");
+	cntct = (contact *)calloc(1, sizeof(contact));
+	cntct->name = strdup("contact1");
+
+	/* only max_async_commands run at once, the others wait in the queue */
+	max_async_commands = 1;
+	run_async_command(NULL, "sleep 1", 10, record_finished_command, "first,");
+	run_async_command(NULL, "echo second", 10, record_finished_command, "second,");
+	ok(async_command_statistics.running == 1 && async_command_statistics.queued == 1 && async_command_statistics.max_queued == 1 && async_command_queue != NULL && !strcmp(async_command_queue->command_line, "echo second"), "Commands beyond max_async_commands are queued");
+	ok(wait_for_async_commands(10) == TRUE && !strcmp(finished_commands, "first,second,") && async_command_statistics.completed == 2, "Queued command ran after the running one finished") || diag("finished=%s", finished_commands);
+
+	/* the broker gets the outcome of an event handler and the time it ended, not the time its result was read */
+	gettimeofday(&start_time, NULL);
+	run_async_event_handler(NULL, "echo handler output; exit 1", SERVICE_EVENTHANDLER, (void *)svc, STATE_WARNING, HARD_STATE, "handler");
+	sleep(1);
+	gettimeofday(&read_time, NULL);
+	wait_for_async_commands(10);
+	ok(eventhandler_ends == 1 && eventhandler_end_object == svc && eventhandler_end_retcode == 1 && eventhandler_end_early_timeout == FALSE && !strcmp(eventhandler_end_output, "handler output\n"), "Event handler end has the result code and output of the command") || diag("retcode=%d output=%s", eventhandler_end_retcode, eventhandler_end_output);
+	ok(seconds_between(&start_time, &eventhandler_end_time) >= 0.0 && seconds_between(&eventhandler_end_time, &read_time) > 0.5, "Event handler end has the time the command ended");
+
+	gettimeofday(&start_time, NULL);
+	run_async_notification(NULL, "exit 0", SERVICE_NOTIFICATION, NOTIFICATION_NORMAL, (void *)svc, cntct, "notify-by-test", "author1", "comment1", FALSE, start_time);
+	sleep(1);
+	gettimeofday(&read_time, NULL);
+	wait_for_async_commands(10);
+	ok(notification_method_ends == 1 && notification_method_end_object == svc && notification_method_end_contact == cntct && !strcmp(notification_method_end_author, "author1"), "Notification method end belongs to the notified contact");
+	ok(seconds_between(&start_time, &notification_method_end_time) >= 0.0 && seconds_between(&notification_method_end_time, &read_time) > 0.5, "Notification method end has the time the command ended");
+
+	/* commands that run too long are killed by the worker and logged like forked ones */
+	max_async_commands = 4;
+	logged[0] = '\x0';
+	run_async_event_handler(NULL, "sleep 30", SERVICE_EVENTHANDLER, (void *)svc, STATE_CRITICAL, HARD_STATE, "handler");
+	run_async_notification(NULL, "sleep 30", HOST_NOTIFICATION, NOTIFICATION_NORMAL, (void *)hst, cntct, "notify-by-test", NULL, NULL, FALSE, start_time);
+	run_async_command(NULL, "sleep 30", ocsp_timeout, finish_async_ocsp_command, (void *)svc);
+	run_async_command(NULL, "sleep 30", ochp_timeout, finish_async_ochp_command, (void *)hst);
+	ok(wait_for_async_commands(10) == TRUE && async_command_statistics.timed_out == 4, "Commands that ran too long timed out");
+	ok(eventhandler_ends == 2 && eventhandler_end_early_timeout == TRUE && eventhandler_end_retcode == STATE_CRITICAL && !strcmp(eventhandler_end_output, "(null)"), "Event handler end reports the timeout");
+	ok(strstr(logged, "Service event handler command 'sleep 30' timed out after 1 seconds") != NULL, "Event handler timeout was logged");
+	ok(strstr(logged, "Contact 'contact1' host notification command 'sleep 30' timed out after 1 seconds") != NULL, "Notification timeout was logged");
+	ok(strstr(logged, "OCSP command 'sleep 30' for service 'service1' on host 'host1' timed out after 1 seconds") != NULL && strstr(logged, "OCHP command 'sleep 30' for host 'host1' timed out after 1 seconds") != NULL, "OCSP and OCHP timeouts were logged") || diag("logged=%s", logged);
+
+	/* on restart the workers finish what is queued and running before the objects are freed */
+	max_async_commands = 1;
+	run_async_notification(NULL, "sleep 1", SERVICE_NOTIFICATION, NOTIFICATION_NORMAL, (void *)svc, cntct, "notify-by-test", NULL, NULL, FALSE, start_time);
+	run_async_event_handler(NULL, "echo drained", SERVICE_EVENTHANDLER, (void *)svc, STATE_OK, HARD_STATE, "handler");
+	shutdown_check_workers();
+	ok(notification_method_ends == 3 && eventhandler_ends == 3 && !strcmp(eventhandler_end_output, "drained\n"), "Running and queued commands finished before the workers stopped") || diag("output=%s", eventhandler_end_output);
+	ok(async_command_statistics.queued == 0 && async_command_statistics.running == 0 && async_command_queue == NULL, "Nothing is left queued or running after the workers stopped");
+	for (x = 0; x < CHECK_WORKER_JOB_SLOTS; x++) {
+		if (check_worker_jobs[x] != NULL)
+			break;
+	}
+	ok(x == CHECK_WORKER_JOB_SLOTS, "No job points to an object after the workers stopped");
+
+	/* what restart does next: free the objects and start the workers again */
+	my_free(hst->name);
+	my_free(hst);
+	my_free(svc->host_name);
+	my_free(svc->description);
+	my_free(svc);
+	my_free(cntct->name);
+	my_free(cntct);
+	init_check_workers();
+	finished_commands[0] = '\x0';
+	run_async_command(NULL, "echo restarted", 10, record_finished_command, "restarted");
+	ok(wait_for_async_commands(10) == TRUE && !strcmp(finished_commands, "restarted") && notification_method_ends == 3 && eventhandler_ends == 3, "Restarted workers run new commands only");
+
+	shutdown_check_workers();
+
+	return exit_status();
+}
@@ -42,10 +42,14 @@
 #include "../include/downtime.h"
 #include "../include/macros.h"
 #include "../include/skiplist.h"
+#include "../include/cgiutils.h"
+#include "../xdata/xsddefault.h"
 #include "tap.h"
+#include "test-timing.c"
 
 extern comment *comment_list;
 extern scheduled_downtime *scheduled_downtime_list;
+extern servicestatus *servicestatus_list;
 
 /* Icinga special */
 void profile_object_update_count(char * name, int val) {}
@@ -71,6 +75,240 @@ int navbar_search;
 int CGI_ID;
 
 
+unsigned long add_string(char **table, unsigned long *size, char *string) {
+	unsigned long offset = *size;
+
+	*table = realloc(*table, *size + strlen(string) + 1);
+	strcpy(*table + *size, string);
+	*size += strlen(string) + 1;
+	return offset;
+}
+
+/* writes the same hosts and services as text status file and as binary snapshot */
+int generate_status_files(char *text_file, char *binary_file, int num_hosts, int services_per_host) {
+	xsddefault_binary_header header;
+	xsddefault_binary_host host_record;
+	xsddefault_binary_service service_record;
+	unsigned long *host_index = NULL;
+	unsigned long *service_index = NULL;
+	unsigned long host_tails[XSDDEFAULT_BINARY_HASHSLOTS];
+	unsigned long service_tails[XSDDEFAULT_BINARY_HASHSLOTS];
+	unsigned long *host_names = NULL;
+	unsigned long host_name = 0L;
+	char *strings = NULL;
+	unsigned long strings_size = 0L;
+	char host_buffer[64];
+	char service_buffer[64];
+	int num_services = num_hosts * services_per_host;
+	int slot = 0;
+	int x = 0;
+	int y = 0;
+	FILE *fp = NULL;
+	FILE *bfp = NULL;
+
+	if ((fp = fopen(text_file, "w")) == NULL || (bfp = fopen(binary_file, "w")) == NULL)
+		return ERROR;
+
+	memset(&header, 0, sizeof(header));
+	strcpy(header.magic, XSDDEFAULT_BINARY_MAGIC);
+	header.version = XSDDEFAULT_BINARY_VERSION;
+	header.header_size = sizeof(xsddefault_binary_header);
+	header.host_size = sizeof(xsddefault_binary_host);
+	header.service_size = sizeof(xsddefault_binary_service);
+	header.comment_size = sizeof(xsddefault_binary_comment);
+	header.downtime_size = sizeof(xsddefault_binary_downtime);
+	header.created = time(NULL);
+	header.program_start = header.created;
+	header.host_count = num_hosts;
+	header.service_count = num_services;
+	header.hash_slots = XSDDEFAULT_BINARY_HASHSLOTS;
+	header.host_offset = sizeof(header);
+	header.service_offset = header.host_offset + num_hosts * sizeof(host_record);
+	header.comment_offset = header.service_offset + num_services * sizeof(service_record);
+	header.downtime_offset = header.comment_offset;
+	header.host_index_offset = header.downtime_offset;
+	header.service_index_offset = header.host_index_offset + (header.hash_slots + num_hosts) * sizeof(unsigned long);
+	header.string_offset = header.service_index_offset + (header.hash_slots + num_services) * sizeof(unsigned long);
+	fwrite(&header, sizeof(header), 1, bfp);
+
+	host_names = malloc(num_hosts * sizeof(unsigned long));
+	host_index = malloc((header.hash_slots + num_hosts) * sizeof(unsigned long));
+	service_index = malloc((header.hash_slots + num_services) * sizeof(unsigned long));
+	for (x = 0; x < XSDDEFAULT_BINARY_HASHSLOTS; x++)
+		host_index[x] = service_index[x] = XSDDEFAULT_BINARY_NONE;
+
+	fprintf(fp, "info {\n\tcreated=%lu\n\tversion=%s\n\t}\n\n", header.created, PROGRAM_VERSION);
+	fprintf(fp, "programstatus {\n\ticinga_pid=1\n\tprogram_start=%lu\n\t}\n\n", header.program_start);
+
+	/* names are generated in sorted order, so the hash chains are built by appending */
+	for (x = 0; x < num_hosts; x++) {
+		snprintf(host_buffer, sizeof(host_buffer), "host-%06d.example.com", x);
+		fprintf(fp, "hoststatus {\n\thost_name=%s\n\thas_been_checked=1\n\tcheck_execution_time=0.011\n\tcheck_latency=0.120\n\tcheck_type=0\n\tcurrent_state=0\n\tlast_hard_state=0\n", host_buffer);
+		fprintf(fp, "\tplugin_output=PING OK - Packet loss = 0%%, RTA = 0.52 ms\n\tlong_plugin_output=\n\tperformance_data=rta=0.520000ms;3000.000000;5000.000000;0.000000 pl=0%%;80;100;0\n");
+		fprintf(fp, "\tlast_check=%lu\n\tnext_check=%lu\n\tcurrent_attempt=1\n\tmax_attempts=10\n\tstate_type=1\n\tlast_state_change=%lu\n\tlast_hard_state_change=%lu\n\tlast_time_up=%lu\n", header.created, header.created + 300, header.created, header.created, header.created);
+		fprintf(fp, "\tnotifications_enabled=1\n\tactive_checks_enabled=1\n\tpassive_checks_enabled=1\n\tevent_handler_enabled=1\n\tflap_detection_enabled=1\n\tprocess_performance_data=1\n\tobsess_over_host=1\n\tlast_update=%lu\n\tpercent_state_change=0.00\n\t}\n\n", header.created);
+
+		memset(&host_record, 0, sizeof(host_record));
+		host_names[x] = host_record.host_name = add_string(&strings, &strings_size, host_buffer);
+		host_record.plugin_output = add_string(&strings, &strings_size, "PING OK - Packet loss = 0%, RTA = 0.52 ms");
+		host_record.long_plugin_output = XSDDEFAULT_BINARY_NONE;
+		host_record.perf_data = add_string(&strings, &strings_size, "rta=0.520000ms;3000.000000;5000.000000;0.000000 pl=0%;80;100;0");
+		host_record.has_been_checked = host_record.notifications_enabled = host_record.checks_enabled = TRUE;
+		host_record.last_check = header.created;
+		host_record.next_check = header.created + 300;
+		host_record.current_attempt = 1;
+		host_record.max_attempts = 10;
+		host_record.state_type = 1;
+		fwrite(&host_record, sizeof(host_record), 1, bfp);
+
+		slot = hashfunc(host_buffer, NULL, XSDDEFAULT_BINARY_HASHSLOTS);
+		host_index[header.hash_slots + x] = XSDDEFAULT_BINARY_NONE;
+		if (host_index[slot] == XSDDEFAULT_BINARY_NONE)
+			host_index[slot] = x;
+		else
+			host_index[header.hash_slots + host_tails[slot]] = x;
+		host_tails[slot] = x;
+	}
+
+	for (x = 0; x < num_hosts; x++) {
+		snprintf(host_buffer, sizeof(host_buffer), "host-%06d.example.com", x);
+		host_name = host_names[x];
+		for (y = 0; y < services_per_host; y++) {
+			snprintf(service_buffer, sizeof(service_buffer), "service-%03d", y);
+			fprintf(fp, "servicestatus {\n\thost_name=%s\n\tservice_description=%s\n\thas_been_checked=1\n\tcheck_execution_time=0.011\n\tcheck_latency=0.120\n\tcheck_type=0\n\tcurrent_state=0\n\tlast_hard_state=0\n", host_buffer, service_buffer);
+			fprintf(fp, "\tcurrent_attempt=1\n\tmax_attempts=3\n\tstate_type=1\n\tlast_state_change=%lu\n\tlast_hard_state_change=%lu\n\tlast_time_ok=%lu\n", header.created, header.created, header.created);
+			fprintf(fp, "\tplugin_output=DISK OK - free space: / 3326 MB (56%% inode=99%%):\n\tlong_plugin_output=/ 3326 MB free\\n/var 812 MB free\n\tperformance_data=/=2643MB;5948;5958;0;5968\n\tlast_check=%lu\n\tnext_check=%lu\n", header.created, header.created + 300);
+			fprintf(fp, "\tnotifications_enabled=1\n\tactive_checks_enabled=1\n\tpassive_checks_enabled=1\n\tevent_handler_enabled=1\n\tflap_detection_enabled=1\n\tprocess_performance_data=1\n\tobsess_over_service=1\n\tlast_update=%lu\n\tpercent_state_change=0.00\n\t}\n\n", header.created);
+
+			memset(&service_record, 0, sizeof(service_record));
+			service_record.host_name = host_name;
+			service_record.description = add_string(&strings, &strings_size, service_buffer);
+			service_record.plugin_output = add_string(&strings, &strings_size, "DISK OK - free space: / 3326 MB (56% inode=99%):");
+			/* the core writes plugin output unescaped to the snapshot */
+			service_record.long_plugin_output = add_string(&strings, &strings_size, "/ 3326 MB free\n/var 812 MB free");
+			service_record.perf_data = add_string(&strings, &strings_size, "/=2643MB;5948;5958;0;5968");
+			service_record.has_been_checked = service_record.notifications_enabled = service_record.checks_enabled = TRUE;
+			service_record.last_check = header.created;
+			service_record.next_check = header.created + 300;
+			service_record.current_attempt = 1;
+			service_record.max_attempts = 3;
+			service_record.state_type = 1;
+			fwrite(&service_record, sizeof(service_record), 1, bfp);
+
+			slot = hashfunc(host_buffer, service_buffer, XSDDEFAULT_BINARY_HASHSLOTS);
+			service_index[header.hash_slots + (x * services_per_host) + y] = XSDDEFAULT_BINARY_NONE;
+			if (service_index[slot] == XSDDEFAULT_BINARY_NONE)
+				service_index[slot] = (x * services_per_host) + y;
+			else
+				service_index[header.hash_slots + service_tails[slot]] = (x * services_per_host) + y;
+			service_tails[slot] = (x * services_per_host) + y;
+		}
+	}
+
+	fwrite(host_index, sizeof(unsigned long), header.hash_slots + num_hosts, bfp);
+	fwrite(service_index, sizeof(unsigned long), header.hash_slots + num_services, bfp);
+	fwrite(strings, 1, strings_size, bfp);
+	header.string_size = strings_size;
+	fseek(bfp, 0L, SEEK_SET);
+	fwrite(&header, sizeof(header), 1, bfp);
+
+	free(host_names);
+	free(host_index);
+	free(service_index);
+	free(strings);
+	fclose(bfp);
+	return (fclose(fp) == 0) ? OK : ERROR;
+}
+
+int count_servicestatus(void) {
+	servicestatus *temp_servicestatus = NULL;
+	int count = 0;
+
+	for (temp_servicestatus = servicestatus_list; temp_servicestatus != NULL; temp_servicestatus = temp_servicestatus->next)
+		count++;
+	return count;
+}
+
+/* counts the services with the given long output */
+int count_long_output(char *long_output) {
+	servicestatus *temp_servicestatus = NULL;
+	int count = 0;
+
+	for (temp_servicestatus = servicestatus_list; temp_servicestatus != NULL; temp_servicestatus = temp_servicestatus->next) {
+		if (temp_servicestatus->long_plugin_output != NULL && !strcmp(temp_servicestatus->long_plugin_output, long_output))
+			count++;
+	}
+	return count;
+}
+
+/* compares the CGI startup time of parsing the text status file and mapping the binary snapshot */
+void benchmark_status_read(int num_hosts, int services_per_host) {
+	servicestatus *temp_servicestatus = NULL;
+	char *text_long_output = NULL;
+	int text_long_count = 0;
+	struct timeval start;
+	double text_time = 0.0;
+	double binary_time = 0.0;
+	int num_services = num_hosts * services_per_host;
+	int result = 0;
+	int count = 0;
+	FILE *fp = NULL;
+
+	free_status_data();
+	free_comment_data();
+	free_downtime_data();
+
+	ok(generate_status_files("var/status-benchmark.dat", "var/status-benchmark.dat.bin", num_hosts, services_per_host) == OK, "Generated status file and binary snapshot with %d services", num_services);
+	if ((fp = fopen("var/status-benchmark-text.cfg", "w")) != NULL) {
+		fprintf(fp, "status_file=var/status-benchmark.dat\nstatus_file_binary=0\n");
+		fclose(fp);
+	}
+	if ((fp = fopen("var/status-benchmark-binary.cfg", "w")) != NULL) {
+		fprintf(fp, "status_file=var/status-benchmark.dat\nstatus_file_binary=1\n");
+		fclose(fp);
+	}
+
+	gettimeofday(&start, NULL);
+	result = xsddefault_read_status_data("var/status-benchmark-text.cfg", READ_ALL_STATUS_DATA);
+	text_time = elapsed_seconds(&start);
+	count = count_servicestatus();
+	ok(result == OK && count == num_services, "Read %d services from the text status file", count);
+	temp_servicestatus = find_servicestatus("host-000999.example.com", "service-099");
+	if (temp_servicestatus != NULL && temp_servicestatus->long_plugin_output != NULL)
+		text_long_output = strdup(temp_servicestatus->long_plugin_output);
+	if (text_long_output != NULL)
+		text_long_count = count_long_output(text_long_output);
+	free_status_data();
+
+	/* move the text file away, so only the snapshot can be read */
+	rename("var/status-benchmark.dat", "var/status-benchmark.dat.aside");
+	gettimeofday(&start, NULL);
+	result = xsddefault_read_status_data("var/status-benchmark-binary.cfg", READ_ALL_STATUS_DATA);
+	binary_time = elapsed_seconds(&start);
+	count = count_servicestatus();
+	ok(result == OK && count == num_services, "Read %d services from the binary snapshot", count);
+
+	temp_servicestatus = find_servicestatus("host-000999.example.com", "service-099");
+	ok(temp_servicestatus != NULL && temp_servicestatus->status == SERVICE_OK && !strcmp(temp_servicestatus->perf_data, "/=2643MB;5948;5958;0;5968"), "Services of the binary snapshot can be looked up");
+	ok(text_long_output != NULL && strchr(text_long_output, '\n') != NULL && text_long_count == num_services && count_long_output(text_long_output) == num_services, "Text status file and binary snapshot give the same long output");
+
+	/* the CGIs sanitize plugin output in place */
+	for (temp_servicestatus = servicestatus_list; temp_servicestatus != NULL; temp_servicestatus = temp_servicestatus->next) {
+		sanitize_plugin_output(temp_servicestatus->plugin_output);
+		sanitize_plugin_output(temp_servicestatus->long_plugin_output);
+	}
+	ok(count_long_output(text_long_output) == num_services, "Strings of the binary snapshot can be changed in place");
+	free_status_data();
+	my_free(text_long_output);
+
+	diag("reading %d services: text status file %.3fs, binary snapshot %.3fs", num_services, text_time, binary_time);
+
+	unlink("var/status-benchmark.dat.aside");
+	unlink("var/status-benchmark.dat.bin");
+	unlink("var/status-benchmark-text.cfg");
+	unlink("var/status-benchmark-binary.cfg");
+}
+
 int main(int argc, char **argv) {
 	int result;
 	int c;
@@ -79,7 +317,7 @@ int main(int argc, char **argv) {
 	comment *temp_comment;
 	scheduled_downtime *temp_downtime;
 
-	plan(7);
+	plan(13);
 
 	chdir("../t");
 
@@ -121,6 +359,8 @@ int main(int argc, char **argv) {
 	ok(c == 20, "Got %d downtimes - expected 20", c);
 	ok(result == OK, "All downtimes in order");
 
+	benchmark_status_read(1000, 100);
+
 	return exit_status();
 }
 
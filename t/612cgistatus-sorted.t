@@ -0,0 +1,54 @@
+#!/usr/bin/perl
+
+# sorting related checks for status.cgi with a large generated status file
+#
+# bin/generate_status writes an object cache and a status file with
+# random states, last check times and attempts. status.cgi has to return
+# the entries in the requested order and only the requested page.
+#
+# usage: 612cgistatus-sorted.t [hosts] [services per host]
+
+use warnings;
+use strict;
+use Test::More;
+use Time::HiRes qw( time );
+use Icinga::Test qw ( run_cgi );
+
+use FindBin qw($Bin);
+
+chdir $Bin or die "Cannot chdir";
+
+my $hosts = shift @ARGV || 200;
+my $services = shift @ARGV || 50;
+my $total = $hosts * $services;
+my $generator = "$Bin/bin/generate_status";
+
+plan tests => 7;
+
+is( system("$generator objects $hosts $services > var/objects.cache.sorted"), 0, "Generated objects for $hosts hosts" );
+is( system("$generator status $hosts $services > var/status-sorted.dat"), 0, "Generated status for $total services" );
+
+# sorting by descending service status, one page of 50 entries
+my $start = time;
+my $output = run_cgi('etc/cgi-sorted-status.cfg', 'GET', 'host=all&sorttype=2&sortoption=3&limit=50', 'status.cgi');
+my $duration = sprintf("%.2f", time - $start);
+like( $output, "/显示1 - 50 \\/ $total 服务匹配结果/", "Displayed first page of $total services sorted by status. Took $duration seconds" );
+
+# the same in csv output, check the complete list
+$start = time;
+$output = run_cgi('etc/cgi-sorted-status.cfg', 'GET', 'host=all&sorttype=2&sortoption=3&csvoutput', 'status.cgi');
+$duration = sprintf("%.2f", time - $start);
+my @states = $output =~ m/service\d+ state (\d)'/g;
+is( scalar @states, $total, "Found all $total services in csv output. Took $duration seconds" );
+
+# generated states are 0=ok, 1=warning, 2=critical, 3=unknown; status.cgi sorts by critical, unknown, warning, ok
+my %order = ( 2 => 3, 3 => 2, 1 => 1, 0 => 0 );
+my @sorted = sort { $order{$b} <=> $order{$a} } @states;
+is_deeply( \@states, \@sorted, "Services sorted by descending status" );
+
+# sorting by ascending host name in csv output
+$output = run_cgi('etc/cgi-sorted-status.cfg', 'GET', 'host=all&style=hostdetail&sortobject=hosts&sorttype=1&sortoption=1&csvoutput', 'status.cgi');
+my @names = $output =~ m/^'(host\d+)';/mg;
+is( scalar @names, $hosts, "Found all $hosts hosts in csv output" );
+@sorted = sort { lc($a) cmp lc($b) } @names;
+is_deeply( \@names, \@sorted, "Hosts sorted by ascending name" );
@@ -0,0 +1,54 @@
+#!/usr/bin/perl
+
+# availability reports for lots of subjects over generated log archives
+#
+# bin/generate_status writes the objects, bin/generate_archives a month of
+# daily archives with random host and service alerts. avail.cgi has to
+# report every subject, and a report over all services must contain the
+# same numbers as the report for a single service.
+#
+# usage: 613cgiavail-archives.t [hosts] [services per host] [days]
+
+use warnings;
+use strict;
+use Test::More;
+use Time::HiRes qw( time );
+use Icinga::Test qw ( run_cgi );
+
+use FindBin qw($Bin);
+
+chdir $Bin or die "Cannot chdir";
+
+my $hosts = shift @ARGV || 100;
+my $services = shift @ARGV || 20;
+my $days = shift @ARGV || 31;
+my $total = $hosts * $services;
+
+plan tests => 7;
+
+is( system("$Bin/bin/generate_status objects $hosts $services > var/objects.cache.generated-logs"), 0, "Generated objects for $total services" );
+is( system("$Bin/bin/generate_status status $hosts $services > var/status-generated-logs.dat"), 0, "Generated status for $total services" );
+system("rm -rf var/generated-logs");
+is( system("$Bin/bin/generate_archives var/generated-logs $hosts $services $days 2"), 0, "Generated $days days of log archives" );
+
+# all services
+my $start = time;
+my $output = run_cgi('etc/cgi-generated-logs.cfg', 'GET', "service=all&timeperiod=last31days&csvoutput", 'avail.cgi');
+my $duration = sprintf("%.2f", time - $start);
+my @rows = grep { /^'host\d+';'service\d+';/ } split("\n", $output);
+is( scalar @rows, $total, "Availability of all $total services. Took $duration seconds" );
+
+my ($row) = grep { /^'host7';'service3';/ } @rows;
+ok( defined $row && $row !~ /^'host7';'service3';'0';'0.000%';'0.000%';'0';'0.000%';'0.000%';'0';'0.000%'/, "Found alerts for host7/service3" );
+
+# a single service
+$output = run_cgi('etc/cgi-generated-logs.cfg', 'GET', "host=host7&service=service3&timeperiod=last31days&csvoutput", 'avail.cgi');
+my ($single) = grep { /^'host7';'service3';/ } split("\n", $output);
+is( $single, $row, "Same availability for host7/service3 in single service report" );
+
+# all hosts
+$start = time;
+$output = run_cgi('etc/cgi-generated-logs.cfg', 'GET', "host=all&timeperiod=last31days&csvoutput", 'avail.cgi');
+$duration = sprintf("%.2f", time - $start);
+@rows = grep { /^'host\d+';/ } split("\n", $output);
+is( scalar @rows, $hosts, "Availability of all $hosts hosts. Took $duration seconds" );
@@ -0,0 +1,69 @@
+#!/usr/bin/perl
+
+# log archive indexes built by the CGIs
+#
+# bin/generate_archives writes a month of daily archives without indexes.
+# with log_index_cache_path set, the first request indexes every archive
+# it reads and keeps the indexes in the cache, later requests only read
+# the entries of the requested service. the output has to stay the same.
+#
+# usage: 614cgilogindex-cache.t [hosts] [services per host] [days]
+
+use warnings;
+use strict;
+use Test::More;
+use Time::HiRes qw( time );
+use Icinga::Test qw ( run_cgi );
+
+use FindBin qw($Bin);
+
+chdir $Bin or die "Cannot chdir";
+
+my $hosts = shift @ARGV || 100;
+my $services = shift @ARGV || 20;
+my $days = shift @ARGV || 31;
+my $total = $hosts * $services;
+
+plan tests => 8;
+
+is( system("$Bin/bin/generate_status objects $hosts $services > var/objects.cache.generated-logs"), 0, "Generated objects for $total services" );
+is( system("$Bin/bin/generate_status status $hosts $services > var/status-generated-logs.dat"), 0, "Generated status for $total services" );
+system("rm -rf var/generated-logs");
+is( system("$Bin/bin/generate_archives var/generated-logs $hosts $services $days 2"), 0, "Generated $days days of log archives" );
+mkdir "var/generated-logs/cache";
+
+my $ts_end = time;
+my $ts_start = $ts_end - $days * 86400;
+my $query = "host=host7&service=service3&limit=0&ts_start=$ts_start&ts_end=$ts_end";
+
+sub alerts {
+	my $output = shift;
+	return [ grep { /服务警告&#58; host7&#59;service3&#59;/ } split("\n", $output) ];
+}
+
+# reading the archives line by line
+my $start = time;
+my $expected = alerts(run_cgi('etc/cgi-generated-logs.cfg', 'GET', $query, 'history.cgi'));
+my $duration = sprintf("%.2f", time - $start);
+ok( scalar @$expected > 0, "Found ".scalar @$expected." alerts for host7/service3 without indexes. Took $duration seconds" );
+
+# first request builds the indexes
+$start = time;
+my $alerts = alerts(run_cgi('etc/cgi-generated-logs-cache.cfg', 'GET', $query, 'history.cgi'));
+$duration = sprintf("%.2f", time - $start);
+is_deeply( $alerts, $expected, "Same alerts while indexing the archives. Took $duration seconds" );
+
+my @indexes = glob("var/generated-logs/cache/icinga-*.log.idx");
+is( scalar @indexes, $days, "Indexed all $days archives" );
+
+# later requests use them
+$start = time;
+$alerts = alerts(run_cgi('etc/cgi-generated-logs-cache.cfg', 'GET', $query, 'history.cgi'));
+$duration = sprintf("%.2f", time - $start);
+is_deeply( $alerts, $expected, "Same alerts with cached indexes. Took $duration seconds" );
+
+# availability reads the same cache
+my $avail_query = "host=host7&service=service3&timeperiod=custom&t1=$ts_start&t2=$ts_end&csvoutput";
+my ($row) = grep { /^'host7';'service3';/ } split("\n", run_cgi('etc/cgi-generated-logs.cfg', 'GET', $avail_query, 'avail.cgi'));
+my ($cached_row) = grep { /^'host7';'service3';/ } split("\n", run_cgi('etc/cgi-generated-logs-cache.cfg', 'GET', $avail_query, 'avail.cgi'));
+is( $cached_row, $row, "Same availability for host7/service3 with cached indexes" );
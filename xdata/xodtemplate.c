@@ -76,6 +76,20 @@ extern int use_true_regexp_matching;
 extern int verify_config;
 extern int test_scheduling;
 extern int use_precached_objects;
+
+extern timeperiod *timeperiod_list;
+extern command *command_list;
+extern contactgroup *contactgroup_list;
+extern hostgroup *hostgroup_list;
+extern servicegroup *servicegroup_list;
+extern contact *contact_list;
+extern host *host_list;
+extern service *service_list;
+extern servicedependency *servicedependency_list;
+extern serviceescalation *serviceescalation_list;
+extern hostdependency *hostdependency_list;
+extern hostescalation *hostescalation_list;
+extern module *module_list;
 #endif
 
 xodtemplate_timeperiod *xodtemplate_timeperiod_list = NULL;
@@ -126,6 +140,21 @@ char *xodtemplate_precache_file = NULL;
 
 int presorted_objects = FALSE;
 
+#ifdef NSCORE
+int xodtemplate_parse_threads = 1;
+
+static xodtemplate_parse_job *xodtemplate_parse_jobs = NULL;
+static int xodtemplate_parse_job_count = 0;
+static int xodtemplate_parse_jobs_allocated = 0;
+static int xodtemplate_next_parse_job = 0;
+static pthread_mutex_t xodtemplate_parse_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t xodtemplate_parse_cond = PTHREAD_COND_INITIALIZER;
+
+static xodtemplate_template_cache **xodtemplate_template_cache_slots = NULL;
+static unsigned long xodtemplate_template_cache_lookups = 0L;
+static unsigned long xodtemplate_template_cache_hits = 0L;
+#endif
+
 extern int allow_empty_hostgroup_assignment;
 
 int xodtemplate_create_escalation_condition(char*, xodtemplate_escalation_condition*);
@@ -168,6 +197,10 @@ int xodtemplate_read_config_data(char *main_config_file, int options, int cache,
 	struct timeval tv[14];
 	double runtime[14];
 	mmapfile *thefile = NULL;
+	char *binary_objects = NULL;
+	unsigned long binary_size = 0L;
+	int use_binary_objects = FALSE;
+	int show_timing = FALSE;
 	int dummy; /* reduce compiler warnings */
 #endif
 	int result = OK;
@@ -223,12 +256,22 @@ int xodtemplate_read_config_data(char *main_config_file, int options, int cache,
 #endif
 
 #ifdef NSCORE
-	if (test_scheduling == TRUE)
+	/* -s and -v -v show how long each phase took */
+	show_timing = (test_scheduling == TRUE || verify_config >= 2) ? TRUE : FALSE;
+	if (show_timing == TRUE)
 		gettimeofday(&tv[0], NULL);
 
 	/* only process the precached object file as long as we're not regenerating it and we're not verifying the config */
-	if (use_precached_objects == TRUE)
-		result = xodtemplate_process_config_file(xodtemplate_precache_file, options);
+	if (use_precached_objects == TRUE) {
+
+		/* add the objects from the binary object cache if it is current, they don't need to be registered again */
+		if (precache == FALSE && (binary_objects = xodtemplate_open_binary_objects(xodtemplate_precache_file, &binary_size)) != NULL) {
+			use_binary_objects = TRUE;
+			result = xodtemplate_register_binary_objects(binary_objects);
+			munmap(binary_objects, binary_size);
+		} else
+			result = xodtemplate_process_config_file(xodtemplate_precache_file, options);
+	}
 
 	/* process object config files normally... */
 	else {
@@ -244,6 +287,10 @@ int xodtemplate_read_config_data(char *main_config_file, int options, int cache,
 		config_base_dir = (char *)strdup(dirname(config_file));
 		my_free(config_file);
 
+		/* config files are collected first if parse threads read them, 0 asks for one per processor */
+		if (xodtemplate_parse_threads <= 0)
+			xodtemplate_parse_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+
 		/* open the main config file for reading (we need to find all the config files to read) */
 		if ((thefile = mmap_fopen(main_config_file)) == NULL) {
 			my_free(config_base_dir);
@@ -290,7 +337,10 @@ int xodtemplate_read_config_data(char *main_config_file, int options, int cache,
 					config_file = temp_buffer;
 
 				/* process the config file... */
-				result = xodtemplate_process_config_file(config_file, options);
+				if (xodtemplate_parse_threads > 1)
+					result = xodtemplate_add_parse_job(XODTEMPLATE_PARSE_FILE, config_file);
+				else
+					result = xodtemplate_process_config_file(config_file, options);
 
 				my_free(config_file);
 
@@ -315,7 +365,10 @@ int xodtemplate_read_config_data(char *main_config_file, int options, int cache,
 					config_file[strlen(config_file)-1] = '\x0';
 
 				/* process the config directory... */
-				result = xodtemplate_process_config_dir(config_file, options);
+				if (xodtemplate_parse_threads > 1)
+					result = xodtemplate_collect_config_dir(config_file);
+				else
+					result = xodtemplate_process_config_dir(config_file, options);
 
 				my_free(config_file);
 
@@ -329,9 +382,13 @@ int xodtemplate_read_config_data(char *main_config_file, int options, int cache,
 		my_free(config_base_dir);
 		my_free(input);
 		mmap_fclose(thefile);
+
+		/* read the collected config files, errors while collecting them are reported in order */
+		if (xodtemplate_parse_threads > 1 && xodtemplate_parse_config_files(options) == ERROR)
+			result = ERROR;
 	}
 
-	if (test_scheduling == TRUE)
+	if (show_timing == TRUE)
 		gettimeofday(&tv[1], NULL);
 #endif
 
@@ -348,7 +405,7 @@ int xodtemplate_read_config_data(char *main_config_file, int options, int cache,
 		/* resolve objects definitions */
 		if (result == OK)
 			result = xodtemplate_resolve_objects();
-		if (test_scheduling == TRUE)
+		if (show_timing == TRUE)
 			gettimeofday(&tv[2], NULL);
 
 		/* cleanup some additive inheritance stuff... */
@@ -357,48 +414,54 @@ int xodtemplate_read_config_data(char *main_config_file, int options, int cache,
 		/* do the meat and potatoes stuff... */
 		if (result == OK)
 			result = xodtemplate_recombobulate_contactgroups();
-		if (test_scheduling == TRUE)
+		if (show_timing == TRUE)
 			gettimeofday(&tv[3], NULL);
 
 		if (result == OK)
 			result = xodtemplate_recombobulate_hostgroups();
-		if (test_scheduling == TRUE)
+		if (show_timing == TRUE)
 			gettimeofday(&tv[4], NULL);
 
 		if (result == OK)
 			result = xodtemplate_duplicate_services();
-		if (test_scheduling == TRUE)
+		if (show_timing == TRUE)
 			gettimeofday(&tv[5], NULL);
 
 		if (result == OK)
 			result = xodtemplate_recombobulate_servicegroups();
-		if (test_scheduling == TRUE)
+		if (show_timing == TRUE)
 			gettimeofday(&tv[6], NULL);
 
 		if (result == OK)
 			result = xodtemplate_duplicate_objects();
-		if (test_scheduling == TRUE)
+		if (show_timing == TRUE)
 			gettimeofday(&tv[7], NULL);
 
 		/* NOTE: some missing defaults (notification options, etc.) are also applied here */
 		if (result == OK)
 			result = xodtemplate_inherit_object_properties();
-		if (test_scheduling == TRUE)
+		if (show_timing == TRUE)
 			gettimeofday(&tv[8], NULL);
 
 		if (result == OK)
 			result = xodtemplate_recombobulate_object_contacts();
-		if (test_scheduling == TRUE)
+		if (show_timing == TRUE)
 			gettimeofday(&tv[9], NULL);
 
 		/* sort objects */
 		if (result == OK)
 			result = xodtemplate_sort_objects();
-		if (test_scheduling == TRUE)
+		if (show_timing == TRUE)
 			gettimeofday(&tv[10], NULL);
 	}
 
-	if (result == OK) {
+	/* the text precache file holds the same definitions the object cache file would */
+	if (use_binary_objects == TRUE) {
+		if (result == OK && cache == TRUE)
+			my_fcopy(xodtemplate_precache_file, xodtemplate_cache_file);
+	}
+
+	else if (result == OK) {
 
 		/* merge host/service extinfo definitions with host/service definitions */
 		/* this will be removed in Nagios 4.x */
@@ -413,7 +476,7 @@ int xodtemplate_read_config_data(char *main_config_file, int options, int cache,
 			xodtemplate_cache_objects(xodtemplate_precache_file);
 	}
 
-	if (test_scheduling == TRUE)
+	if (show_timing == TRUE)
 		gettimeofday(&tv[11], NULL);
 
 #endif
@@ -422,15 +485,19 @@ int xodtemplate_read_config_data(char *main_config_file, int options, int cache,
 	if (result == OK)
 		result = xodtemplate_register_objects();
 #ifdef NSCORE
-	if (test_scheduling == TRUE)
+	if (show_timing == TRUE)
 		gettimeofday(&tv[12], NULL);
 #endif
 
 	/* cleanup */
 	xodtemplate_free_memory();
 #ifdef NSCORE
-	if (test_scheduling == TRUE)
+	if (show_timing == TRUE)
 		gettimeofday(&tv[13], NULL);
+
+	/* write the binary object cache along with the precached object file */
+	if (result == OK && precache == TRUE)
+		xodtemplate_cache_binary_objects(xodtemplate_precache_file);
 #endif
 
 	/* free memory */
@@ -438,7 +505,7 @@ int xodtemplate_read_config_data(char *main_config_file, int options, int cache,
 	my_free(xodtemplate_precache_file);
 
 #ifdef NSCORE
-	if (test_scheduling == TRUE) {
+	if (show_timing == TRUE) {
 
 		runtime[0] = (double)((double)(tv[1].tv_sec - tv[0].tv_sec) + (double)((tv[1].tv_usec - tv[0].tv_usec) / 1000.0) / 1000.0);
 		if (use_precached_objects == FALSE) {
@@ -473,7 +540,7 @@ int xodtemplate_read_config_data(char *main_config_file, int options, int cache,
 		printf("below.  You can use this information to see if precaching your\n");
 		printf("object configuration would be useful.\n\n");
 
-		printf("Object Config Source: %s\n\n", (use_precached_objects == TRUE) ? "Pre-cached config file" : "Config files (uncached)");
+		printf("Object Config Source: %s\n\n", (use_binary_objects == TRUE) ? "Binary pre-cached config file" : (use_precached_objects == TRUE) ? "Pre-cached config file" : "Config files (uncached)");
 
 		printf("OBJECT CONFIG PROCESSING TIMES      (* = Potential for precache savings with -u option)\n");
 		printf("----------------------------------\n");
@@ -495,6 +562,8 @@ int xodtemplate_read_config_data(char *main_config_file, int options, int cache,
 		if (use_precached_objects == FALSE)
 			printf("* = %.6lf sec (%.2f%%) estimated savings", runtime[13] - runtime[12] - runtime[11] - runtime[0], ((runtime[13] - runtime[12] - runtime[11] - runtime[0]) / runtime[13]) * 100.0);
 		printf("\n");
+		if (use_precached_objects == FALSE)
+			printf("Template lookups:     %lu ('use' values), %lu from template cache\n", xodtemplate_template_cache_lookups, xodtemplate_template_cache_hits);
 		printf("\n\n");
 	}
 #endif
@@ -518,6 +587,10 @@ int xodtemplate_grab_config_info(char *main_config_file) {
 	if ((thefile = mmap_fopen(main_config_file)) == NULL)
 		return ERROR;
 
+#ifdef NSCORE
+	xodtemplate_parse_threads = 1;
+#endif
+
 	/* read in all lines from the main config file */
 	while (1) {
 
@@ -548,6 +621,12 @@ int xodtemplate_grab_config_info(char *main_config_file) {
 		/* pre-cached object file definition */
 		if (!strcmp(var, "precached_object_file"))
 			xodtemplate_precache_file = (char *)strdup(val);
+
+#ifdef NSCORE
+		/* number of threads reading object config files */
+		if (!strcmp(var, "object_parse_threads"))
+			xodtemplate_parse_threads = atoi(val);
+#endif
 	}
 
 	/* close the file */
@@ -577,24 +656,55 @@ int xodtemplate_grab_config_info(char *main_config_file) {
 
 
 
-/* process all files in a specific config directory */
-int xodtemplate_process_config_dir(char *dirname, int options) {
+/* reports a config directory or a problem with it, the same way whether config files are read by parse threads or not */
+static int xodtemplate_report_config_dir_entry(int type, char *name) {
+
+	switch (type) {
+
+	case XODTEMPLATE_PARSE_DIR:
+#ifdef NSCORE
+		if (verify_config == TRUE)
+			printf("Processing object config directory '%s'...\n", name);
+#endif
+		return OK;
+
+	case XODTEMPLATE_PARSE_DIR_ERROR:
+		logit(NSLOG_CONFIG_ERROR, TRUE, "Error: Could not open config directory '%s' for reading.\n", name);
+		return ERROR;
+
+	case XODTEMPLATE_PARSE_MEMBER_ERROR:
+		logit(NSLOG_RUNTIME_ERROR, TRUE, "Error: Could not open config directory member '%s' for reading.\n", name);
+		return ERROR;
+
+	case XODTEMPLATE_PARSE_NAME_ERROR:
+		logit(NSLOG_CONFIG_ERROR, TRUE, "Error: Path of config directory member '%s' is longer than %d characters.\n", name, MAX_FILENAME_LENGTH - 1);
+		return ERROR;
+
+	default:
+		break;
+	}
+
+	return OK;
+}
+
+
+/* walks a config directory in the order its files are read and hands every directory, config file and problem to the handler */
+static int xodtemplate_walk_config_dir(char *dirname, int (*handler)(int, char *, int), int options) {
 	char file[MAX_FILENAME_LENGTH];
+	char *long_name = NULL;
 	DIR *dirp = NULL;
 	struct dirent *dirfile = NULL;
 	int result = OK;
 	register int x = 0;
 	struct stat stat_buf;
 
-#ifdef NSCORE
-	if (verify_config == TRUE)
-		printf("Processing object config directory '%s'...\n", dirname);
-#endif
+	if (handler(XODTEMPLATE_PARSE_DIR, dirname, options) == ERROR)
+		return ERROR;
 
 	/* open the directory for reading */
 	dirp = opendir(dirname);
 	if (dirp == NULL) {
-		logit(NSLOG_CONFIG_ERROR, TRUE, "Error: Could not open config directory '%s' for reading.\n", dirname);
+		handler(XODTEMPLATE_PARSE_DIR_ERROR, dirname, options);
 		return ERROR;
 	}
 
@@ -605,13 +715,20 @@ int xodtemplate_process_config_dir(char *dirname, int options) {
 		if (dirfile->d_name[0] == '.')
 			continue;
 
-		/* create /path/to/file */
-		snprintf(file, sizeof(file), "%s/%s", dirname, dirfile->d_name);
-		file[sizeof(file)-1] = '\x0';
+		/* create /path/to/file, a truncated path would name some other file */
+		x = snprintf(file, sizeof(file), "%s/%s", dirname, dirfile->d_name);
+		if (x < 0 || x >= (int)sizeof(file)) {
+			if (asprintf(&long_name, "%s/%s", dirname, dirfile->d_name) == -1)
+				long_name = NULL;
+			handler(XODTEMPLATE_PARSE_NAME_ERROR, (long_name == NULL) ? dirfile->d_name : long_name, options);
+			my_free(long_name);
+			closedir(dirp);
+			return ERROR;
+		}
 
 		/* process this if it's a non-hidden config file... */
 		if (stat(file, &stat_buf) == -1) {
-			logit(NSLOG_RUNTIME_ERROR, TRUE, "Error: Could not open config directory member '%s' for reading.\n", file);
+			handler(XODTEMPLATE_PARSE_MEMBER_ERROR, file, options);
 			closedir(dirp);
 			return ERROR;
 		}
@@ -624,30 +741,23 @@ int xodtemplate_process_config_dir(char *dirname, int options) {
 				break;
 
 			/* process the config file */
-			result = xodtemplate_process_config_file(file, options);
-
-			if (result == ERROR) {
-				closedir(dirp);
-				return ERROR;
-			}
-
+			result = handler(XODTEMPLATE_PARSE_FILE, file, options);
 			break;
 
 		case S_IFDIR:
 			/* recurse into subdirectories... */
-			result = xodtemplate_process_config_dir(file, options);
-
-			if (result == ERROR) {
-				closedir(dirp);
-				return ERROR;
-			}
-
+			result = xodtemplate_walk_config_dir(file, handler, options);
 			break;
 
 		default:
 			/* everything else we ignore */
 			break;
 		}
+
+		if (result == ERROR) {
+			closedir(dirp);
+			return ERROR;
+		}
 	}
 
 	closedir(dirp);
@@ -656,25 +766,26 @@ int xodtemplate_process_config_dir(char *dirname, int options) {
 }
 
 
-/* process data in a specific config file */
-int xodtemplate_process_config_file(char *filename, int options) {
-	mmapfile *thefile = NULL;
-	char *input = NULL;
-	register int in_definition = FALSE;
-	register int current_line = 0;
-	int result = OK;
-	register int x = 0;
-	register int y = 0;
-	char *ptr = NULL;
-	int empty_def = TRUE;
+/* processes a config file found in a config directory right away */
+static int xodtemplate_process_config_dir_entry(int type, char *name, int options) {
 
+	if (type == XODTEMPLATE_PARSE_FILE)
+		return xodtemplate_process_config_file(name, options);
 
-#ifdef NSCORE
-	if (verify_config == TRUE)
-		printf("Processing object config file '%s'...\n", filename);
-#endif
+	return xodtemplate_report_config_dir_entry(type, name);
+}
+
+
+/* process all files in a specific config directory */
+int xodtemplate_process_config_dir(char *dirname, int options) {
+
+	return xodtemplate_walk_config_dir(dirname, xodtemplate_process_config_dir_entry, options);
+}
+
+
+/* saves the name of a config file, its number is used in messages about its objects */
+static int xodtemplate_add_config_file_name(char *filename) {
 
-	/* save config file name */
 	xodtemplate_config_files[xodtemplate_current_config_file++] = (char *)strdup(filename);
 
 	/* reallocate memory for config files */
@@ -684,23 +795,20 @@ int xodtemplate_process_config_file(char *filename, int options) {
 			return ERROR;
 	}
 
-	/* open the config file for reading */
-	if ((thefile = mmap_fopen(filename)) == NULL) {
-		logit(NSLOG_CONFIG_ERROR, TRUE, "Error: Cannot open config file '%s' for reading: %s\n", filename, strerror(errno));
-		return ERROR;
-	}
+	return OK;
+}
 
-	/* read in all lines from the config file */
-	while (1) {
 
-		/* free memory */
-		my_free(input);
+/* reads the next line of a config file that isn't empty or a comment, NULL at the end of the file */
+static char *xodtemplate_read_config_line(mmapfile *thefile) {
+	char *input = NULL;
+	register int x = 0;
+
+	while (1) {
 
 		/* read the next line */
 		if ((input = mmap_fgets_multiline(thefile)) == NULL)
-			break;
-
-		current_line = thefile->current_line;
+			return NULL;
 
 		/* grab data before comment delimiter - faster than a strtok() and strncpy()... */
 		for (x = 0; input[x] != '\x0'; x++) {
@@ -717,130 +825,175 @@ int xodtemplate_process_config_file(char *filename, int options) {
 		strip(input);
 
 		/* skip empty lines */
-		if (input[0] == '\x0' || input[0] == '#')
+		if (input[0] == '\x0' || input[0] == '#') {
+			my_free(input);
 			continue;
+		}
 
-		/* this is the start of an object definition */
-		if (strstr(input, "define") == input) {
+		return input;
+	}
+}
 
-			/* get the type of object we're defining... */
-			for (x = 6; input[x] != '\x0'; x++)
-				if (input[x] != ' ' && input[x] != '\t')
-					break;
-			for (y = 0; input[x] != '\x0'; x++) {
-				if (input[x] == ' ' || input[x] == '\t' ||  input[x] == '{')
-					break;
-				else
-					input[y++] = input[x];
-			}
-			input[y] = '\x0';
 
-			/* make sure an object type is specified... */
-			if (input[0] == '\x0') {
-				logit(NSLOG_CONFIG_ERROR, TRUE, "Error: No object type specified in file '%s' on line %d.\n", filename, current_line);
-				result = ERROR;
-				break;
-			}
+/* processes a stripped line of a config file */
+static int xodtemplate_process_config_line(char *input, char *filename, int current_line, int options, int *in_definition, int *empty_def) {
+	register int x = 0;
+	register int y = 0;
+	char *ptr = NULL;
 
-			/* check validity of object type */
-			if (strcmp(input, "timeperiod") && strcmp(input, "command") && strcmp(input, "contact") && strcmp(input, "contactgroup") && strcmp(input, "host") && strcmp(input, "hostgroup") && strcmp(input, "servicegroup") && strcmp(input, "service") && strcmp(input, "servicedependency") && strcmp(input, "serviceescalation") && strcmp(input, "hostgroupescalation") && strcmp(input, "hostdependency") && strcmp(input, "hostescalation") && strcmp(input, "hostextinfo") && strcmp(input, "serviceextinfo") && strcmp(input, "module")) {
-				logit(NSLOG_CONFIG_ERROR, TRUE, "Error: Invalid object definition type '%s' in file '%s' on line %d.\n", input, filename, current_line);
-				result = ERROR;
-				break;
-			}
+	/* this is the start of an object definition */
+	if (strstr(input, "define") == input) {
 
-			/* we're already in an object definition... */
-			if (in_definition == TRUE) {
-				logit(NSLOG_CONFIG_ERROR, TRUE, "Error: Unexpected start of object definition in file '%s' on line %d.  Make sure you close preceding objects before starting a new one.\n", filename, current_line);
-				result = ERROR;
+		/* get the type of object we're defining... */
+		for (x = 6; input[x] != '\x0'; x++)
+			if (input[x] != ' ' && input[x] != '\t')
 				break;
-			}
-
-			/* start a new definition */
-			if (xodtemplate_begin_object_definition(input, options, xodtemplate_current_config_file, current_line) == ERROR) {
-				logit(NSLOG_CONFIG_ERROR, TRUE, "Error: Could not add object definition in file '%s' on line %d.\n", filename, current_line);
-				result = ERROR;
+		for (y = 0; input[x] != '\x0'; x++) {
+			if (input[x] == ' ' || input[x] == '\t' ||  input[x] == '{')
 				break;
-			}
+			else
+				input[y++] = input[x];
+		}
+		input[y] = '\x0';
 
-			in_definition = TRUE;
-			empty_def = TRUE; /* set the default at the beginning */
+		/* make sure an object type is specified... */
+		if (input[0] == '\x0') {
+			logit(NSLOG_CONFIG_ERROR, TRUE, "Error: No object type specified in file '%s' on line %d.\n", filename, current_line);
+			return ERROR;
 		}
 
-		/* we're currently inside an object definition */
-		else if (in_definition == TRUE) {
+		/* check validity of object type */
+		if (strcmp(input, "timeperiod") && strcmp(input, "command") && strcmp(input, "contact") && strcmp(input, "contactgroup") && strcmp(input, "host") && strcmp(input, "hostgroup") && strcmp(input, "servicegroup") && strcmp(input, "service") && strcmp(input, "servicedependency") && strcmp(input, "serviceescalation") && strcmp(input, "hostgroupescalation") && strcmp(input, "hostdependency") && strcmp(input, "hostescalation") && strcmp(input, "hostextinfo") && strcmp(input, "serviceextinfo") && strcmp(input, "module")) {
+			logit(NSLOG_CONFIG_ERROR, TRUE, "Error: Invalid object definition type '%s' in file '%s' on line %d.\n", input, filename, current_line);
+			return ERROR;
+		}
 
-			/* this is the close of an object definition */
-			if (!strcmp(input, "}")) {
+		/* we're already in an object definition... */
+		if (*in_definition == TRUE) {
+			logit(NSLOG_CONFIG_ERROR, TRUE, "Error: Unexpected start of object definition in file '%s' on line %d.  Make sure you close preceding objects before starting a new one.\n", filename, current_line);
+			return ERROR;
+		}
 
-				/* check if definition is empty */
-				if (empty_def == TRUE) {
-					/* this is a hack in order to not register this empty object! */
-					logit(NSLOG_CONFIG_WARNING, TRUE, "Warning: Empty definition found in file '%s' on line %d.\n", filename, current_line);
-					xodtemplate_add_object_property("register 0", options);
-				}
+		/* start a new definition */
+		if (xodtemplate_begin_object_definition(input, options, xodtemplate_current_config_file, current_line) == ERROR) {
+			logit(NSLOG_CONFIG_ERROR, TRUE, "Error: Could not add object definition in file '%s' on line %d.\n", filename, current_line);
+			return ERROR;
+		}
 
-				in_definition = FALSE;
+		*in_definition = TRUE;
+		*empty_def = TRUE; /* set the default at the beginning */
+	}
 
-				/* close out current definition */
-				if (xodtemplate_end_object_definition(options) == ERROR) {
-					logit(NSLOG_CONFIG_ERROR, TRUE, "Error: Could not complete object definition in file '%s' on line %d.\n", filename, current_line);
-					result = ERROR;
-					break;
-				}
-			}
+	/* we're currently inside an object definition */
+	else if (*in_definition == TRUE) {
 
-			/* this is a directive inside an object definition */
-			else {
+		/* this is the close of an object definition */
+		if (!strcmp(input, "}")) {
 
-				/* add directive to object definition */
-				if (xodtemplate_add_object_property(input, options) == ERROR) {
-					logit(NSLOG_CONFIG_ERROR, TRUE, "Error: Could not add object property in file '%s' on line %d.\n", filename, current_line);
-					result = ERROR;
-					break;
-				}
+			/* check if definition is empty */
+			if (*empty_def == TRUE) {
+				/* this is a hack in order to not register this empty object! */
+				logit(NSLOG_CONFIG_WARNING, TRUE, "Warning: Empty definition found in file '%s' on line %d.\n", filename, current_line);
+				xodtemplate_add_object_property("register 0", options);
+			}
 
-				empty_def = FALSE; /* indicate that we just registered an attribute */
+			*in_definition = FALSE;
 
+			/* close out current definition */
+			if (xodtemplate_end_object_definition(options) == ERROR) {
+				logit(NSLOG_CONFIG_ERROR, TRUE, "Error: Could not complete object definition in file '%s' on line %d.\n", filename, current_line);
+				return ERROR;
 			}
 		}
 
-		/* include another file */
-		else if (strstr(input, "include_file=") == input) {
-
-			ptr = strtok(input, "=");
-			ptr = strtok(NULL, "\n");
+		/* this is a directive inside an object definition */
+		else {
 
-			if (ptr != NULL) {
-				result = xodtemplate_process_config_file(ptr, options);
-				if (result == ERROR)
-					break;
+			/* add directive to object definition */
+			if (xodtemplate_add_object_property(input, options) == ERROR) {
+				logit(NSLOG_CONFIG_ERROR, TRUE, "Error: Could not add object property in file '%s' on line %d.\n", filename, current_line);
+				return ERROR;
 			}
+
+			*empty_def = FALSE; /* indicate that we just registered an attribute */
+
 		}
+	}
 
-		/* include a directory */
-		else if (strstr(input, "include_dir") == input) {
+	/* include another file */
+	else if (strstr(input, "include_file=") == input) {
 
-			ptr = strtok(input, "=");
-			ptr = strtok(NULL, "\n");
+		ptr = strtok(input, "=");
+		ptr = strtok(NULL, "\n");
 
-			if (ptr != NULL) {
-				result = xodtemplate_process_config_dir(ptr, options);
-				if (result == ERROR)
-					break;
-			}
-		}
+		if (ptr != NULL)
+			return xodtemplate_process_config_file(ptr, options);
+	}
 
-		/* unexpected token or statement */
-		else {
-			logit(NSLOG_CONFIG_ERROR, TRUE, "Error: Unexpected token or statement in file '%s' on line %d.\n", filename, current_line);
-			result = ERROR;
+	/* include a directory */
+	else if (strstr(input, "include_dir") == input) {
+
+		ptr = strtok(input, "=");
+		ptr = strtok(NULL, "\n");
+
+		if (ptr != NULL)
+			return xodtemplate_process_config_dir(ptr, options);
+	}
+
+	/* unexpected token or statement */
+	else {
+		logit(NSLOG_CONFIG_ERROR, TRUE, "Error: Unexpected token or statement in file '%s' on line %d.\n", filename, current_line);
+		return ERROR;
+	}
+
+	return OK;
+}
+
+
+/* process data in a specific config file */
+int xodtemplate_process_config_file(char *filename, int options) {
+	mmapfile *thefile = NULL;
+	char *input = NULL;
+	int in_definition = FALSE;
+	int current_line = 0;
+	int result = OK;
+	int empty_def = TRUE;
+
+
+#ifdef NSCORE
+	if (verify_config == TRUE)
+		printf("Processing object config file '%s'...\n", filename);
+#endif
+
+	/* save config file name */
+	if (xodtemplate_add_config_file_name(filename) == ERROR)
+		return ERROR;
+
+	/* open the config file for reading */
+	if ((thefile = mmap_fopen(filename)) == NULL) {
+		logit(NSLOG_CONFIG_ERROR, TRUE, "Error: Cannot open config file '%s' for reading: %s\n", filename, strerror(errno));
+		return ERROR;
+	}
+
+	/* read in all lines from the config file */
+	while ((input = xodtemplate_read_config_line(thefile)) != NULL) {
+
+		current_line = thefile->current_line;
+
+		result = xodtemplate_process_config_line(input, filename, current_line, options, &in_definition, &empty_def);
+
+		/* free memory */
+		my_free(input);
+
+		if (result == ERROR)
 			break;
-		}
 	}
 
-	/* free memory and close file */
-	my_free(input);
+	/* the last line read may have been empty or a comment */
+	if (result == OK)
+		current_line = thefile->current_line;
+
+	/* close file */
 	mmap_fclose(thefile);
 
 	/* whoops - EOF while we were in the middle of an object definition... */
@@ -853,47 +1006,286 @@ int xodtemplate_process_config_file(char *filename, int options) {
 }
 
 
+#ifdef NSCORE
 
+/* appends a stripped line to the arena of a parse job */
+static int xodtemplate_add_parse_line(xodtemplate_parse_job *job, char *input, int line) {
+	xodtemplate_parse_line *new_lines = NULL;
+	char *new_arena = NULL;
+	unsigned long len = strlen(input) + 1;
 
+	if (job->arena_size + len > job->arena_allocated) {
+		if ((new_arena = (char *)realloc(job->arena, (job->arena_allocated + len) * 2)) == NULL)
+			return ERROR;
+		job->arena = new_arena;
+		job->arena_allocated = (job->arena_allocated + len) * 2;
+	}
 
-/******************************************************************/
-/***************** OBJECT DEFINITION FUNCTIONS ********************/
-/******************************************************************/
+	if (job->line_count >= job->lines_allocated) {
+		if ((new_lines = (xodtemplate_parse_line *)realloc(job->lines, (job->lines_allocated + 64) * 2 * sizeof(xodtemplate_parse_line))) == NULL)
+			return ERROR;
+		job->lines = new_lines;
+		job->lines_allocated = (job->lines_allocated + 64) * 2;
+	}
 
-/*
- * all objects start the same way, so we can get rid of quite
- * a lot of code with this struct-offset-insensitive macro
- * Credits to Andreas Ericsson
- */
-#define xod_begin_def(type) \
-        do { \
-                new_##type = (xodtemplate_##type *)calloc(1, sizeof(*new_##type)); \
-                if (new_##type == NULL) \
-                        return ERROR; \
-                new_##type->register_object=TRUE; \
-                new_##type->_config_file=config_file; \
-                new_##type->_start_line=start_line; \
-        \
-                /* precached object files are already sorted, so add to tail */ \
-                if(presorted_objects==TRUE){ \
-                        \
-                        if(xodtemplate_##type##_list==NULL){ \
-                                xodtemplate_##type##_list=new_##type; \
-                                xodtemplate_##type##_list_tail=xodtemplate_##type##_list; \
-                        } else { \
-                                xodtemplate_##type##_list_tail->next=new_##type; \
-                                xodtemplate_##type##_list_tail=new_##type; \
-                        } \
-        \
-                        /* update current object pointer */ \
-                        xodtemplate_current_object=xodtemplate_##type##_list_tail; \
-                } else { \
-                        /* add new object to head of list in memory */ \
-                        new_##type->next=xodtemplate_##type##_list; \
-                        xodtemplate_##type##_list=new_##type; \
-        \
-                        /* update current object pointer */ \
-                        xodtemplate_current_object=xodtemplate_##type##_list; \
+	memcpy(job->arena + job->arena_size, input, len);
+	job->lines[job->line_count].offset = job->arena_size;
+	job->lines[job->line_count].line = line;
+	job->line_count++;
+	job->arena_size += len;
+
+	return OK;
+}
+
+
+/* reads a config file into the arena of its parse job, runs in a parse thread */
+static void xodtemplate_read_parse_job(xodtemplate_parse_job *job) {
+	mmapfile *thefile = NULL;
+	char *input = NULL;
+
+	if ((thefile = mmap_fopen(job->filename)) == NULL) {
+		job->error = (errno != 0) ? errno : ENOENT;
+		job->last_line = -1;
+		return;
+	}
+
+	while ((input = xodtemplate_read_config_line(thefile)) != NULL) {
+		if (xodtemplate_add_parse_line(job, input, thefile->current_line) == ERROR) {
+			job->error = ENOMEM;
+			my_free(input);
+			break;
+		}
+		my_free(input);
+	}
+
+	job->last_line = thefile->current_line;
+
+	mmap_fclose(thefile);
+
+	return;
+}
+
+
+/* adds a config file or directory to the parse jobs */
+int xodtemplate_add_parse_job(int type, char *filename) {
+	xodtemplate_parse_job *new_jobs = NULL;
+	xodtemplate_parse_job *new_job = NULL;
+
+	if (xodtemplate_parse_job_count >= xodtemplate_parse_jobs_allocated) {
+		if ((new_jobs = (xodtemplate_parse_job *)realloc(xodtemplate_parse_jobs, (xodtemplate_parse_jobs_allocated + 64) * 2 * sizeof(xodtemplate_parse_job))) == NULL)
+			return ERROR;
+		xodtemplate_parse_jobs = new_jobs;
+		xodtemplate_parse_jobs_allocated = (xodtemplate_parse_jobs_allocated + 64) * 2;
+	}
+
+	new_job = &xodtemplate_parse_jobs[xodtemplate_parse_job_count];
+	memset(new_job, 0, sizeof(xodtemplate_parse_job));
+	new_job->type = type;
+	if ((new_job->filename = (char *)strdup(filename)) == NULL)
+		return ERROR;
+
+	/* only files have to be read */
+	if (type != XODTEMPLATE_PARSE_FILE)
+		new_job->done = TRUE;
+
+	xodtemplate_parse_job_count++;
+
+	return OK;
+}
+
+
+/* adds a config file or directory, or a problem with it, to the parse jobs, problems are reported in order later */
+static int xodtemplate_collect_config_dir_entry(int type, char *name, int options) {
+
+	return xodtemplate_add_parse_job(type, name);
+}
+
+
+/* adds all config files in a directory to the parse jobs, in the order xodtemplate_process_config_dir() reads them */
+int xodtemplate_collect_config_dir(char *dirname) {
+
+	return xodtemplate_walk_config_dir(dirname, xodtemplate_collect_config_dir_entry, 0);
+}
+
+
+/* reads the parse jobs in the order they were collected, several threads at a time */
+static void *xodtemplate_parse_thread(void *arg) {
+	xodtemplate_parse_job *job = NULL;
+
+	while (1) {
+
+		pthread_mutex_lock(&xodtemplate_parse_lock);
+		while (xodtemplate_next_parse_job < xodtemplate_parse_job_count && xodtemplate_parse_jobs[xodtemplate_next_parse_job].done == TRUE)
+			xodtemplate_next_parse_job++;
+		job = (xodtemplate_next_parse_job < xodtemplate_parse_job_count) ? &xodtemplate_parse_jobs[xodtemplate_next_parse_job++] : NULL;
+		pthread_mutex_unlock(&xodtemplate_parse_lock);
+
+		if (job == NULL)
+			break;
+
+		xodtemplate_read_parse_job(job);
+
+		pthread_mutex_lock(&xodtemplate_parse_lock);
+		job->done = TRUE;
+		pthread_cond_broadcast(&xodtemplate_parse_cond);
+		pthread_mutex_unlock(&xodtemplate_parse_lock);
+	}
+
+	return NULL;
+}
+
+
+/* processes the lines a parse thread has read from a config file */
+static int xodtemplate_process_parse_job(xodtemplate_parse_job *job, int options) {
+	int in_definition = FALSE;
+	int current_line = 0;
+	int empty_def = TRUE;
+	int result = OK;
+	int x = 0;
+
+	/* directories and problems with them are only reported */
+	if (job->type != XODTEMPLATE_PARSE_FILE)
+		return xodtemplate_report_config_dir_entry(job->type, job->filename);
+
+	if (verify_config == TRUE)
+		printf("Processing object config file '%s'...\n", job->filename);
+
+	/* save config file name */
+	if (xodtemplate_add_config_file_name(job->filename) == ERROR)
+		return ERROR;
+
+	if (job->last_line < 0) {
+		logit(NSLOG_CONFIG_ERROR, TRUE, "Error: Cannot open config file '%s' for reading: %s\n", job->filename, strerror(job->error));
+		return ERROR;
+	}
+
+	for (x = 0; x < job->line_count; x++) {
+		current_line = job->lines[x].line;
+		if ((result = xodtemplate_process_config_line(job->arena + job->lines[x].offset, job->filename, current_line, options, &in_definition, &empty_def)) == ERROR)
+			break;
+	}
+
+	/* the file could only be read partially */
+	if (result == OK && job->error != 0) {
+		logit(NSLOG_CONFIG_ERROR, TRUE, "Error: Cannot read config file '%s': %s\n", job->filename, strerror(job->error));
+		return ERROR;
+	}
+
+	/* whoops - EOF while we were in the middle of an object definition... */
+	if (in_definition == TRUE && result == OK) {
+		logit(NSLOG_CONFIG_ERROR, TRUE, "Error: Unexpected EOF in file '%s' on line %d - check for a missing closing bracket.\n", job->filename, job->last_line);
+		result = ERROR;
+	}
+
+	return result;
+}
+
+
+/* reads the collected config files with parse threads and processes them in order in this thread */
+int xodtemplate_parse_config_files(int options) {
+	pthread_t threads[XODTEMPLATE_MAX_PARSE_THREADS];
+	xodtemplate_parse_job *job = NULL;
+	int num_threads = 0;
+	int result = OK;
+	int x = 0;
+
+	num_threads = (xodtemplate_parse_threads < xodtemplate_parse_job_count) ? xodtemplate_parse_threads : xodtemplate_parse_job_count;
+	if (num_threads > XODTEMPLATE_MAX_PARSE_THREADS)
+		num_threads = XODTEMPLATE_MAX_PARSE_THREADS;
+
+	xodtemplate_next_parse_job = 0;
+	for (x = 0; x < num_threads; x++) {
+		if (pthread_create(&threads[x], NULL, xodtemplate_parse_thread, NULL) != 0)
+			break;
+	}
+	num_threads = x;
+
+	for (x = 0; x < xodtemplate_parse_job_count; x++) {
+
+		job = &xodtemplate_parse_jobs[x];
+
+		/* read the file here if no thread is left to do it */
+		pthread_mutex_lock(&xodtemplate_parse_lock);
+		if (num_threads == 0 && job->done == FALSE) {
+			xodtemplate_read_parse_job(job);
+			job->done = TRUE;
+		}
+		while (job->done == FALSE)
+			pthread_cond_wait(&xodtemplate_parse_cond, &xodtemplate_parse_lock);
+		pthread_mutex_unlock(&xodtemplate_parse_lock);
+
+		result = xodtemplate_process_parse_job(job, options);
+
+		my_free(job->arena);
+		my_free(job->lines);
+
+		/* files after an error aren't needed anymore */
+		if (result == ERROR) {
+			pthread_mutex_lock(&xodtemplate_parse_lock);
+			xodtemplate_next_parse_job = xodtemplate_parse_job_count;
+			pthread_mutex_unlock(&xodtemplate_parse_lock);
+			break;
+		}
+	}
+
+	for (x = 0; x < num_threads; x++)
+		pthread_join(threads[x], NULL);
+
+	for (x = 0; x < xodtemplate_parse_job_count; x++) {
+		my_free(xodtemplate_parse_jobs[x].filename);
+		my_free(xodtemplate_parse_jobs[x].arena);
+		my_free(xodtemplate_parse_jobs[x].lines);
+	}
+	my_free(xodtemplate_parse_jobs);
+	xodtemplate_parse_job_count = 0;
+	xodtemplate_parse_jobs_allocated = 0;
+
+	return result;
+}
+
+#endif
+
+
+
+
+/******************************************************************/
+/***************** OBJECT DEFINITION FUNCTIONS ********************/
+/******************************************************************/
+
+/*
+ * all objects start the same way, so we can get rid of quite
+ * a lot of code with this struct-offset-insensitive macro
+ * Credits to Andreas Ericsson
+ */
+#define xod_begin_def(type) \
+        do { \
+                new_##type = (xodtemplate_##type *)calloc(1, sizeof(*new_##type)); \
+                if (new_##type == NULL) \
+                        return ERROR; \
+                new_##type->register_object=TRUE; \
+                new_##type->_config_file=config_file; \
+                new_##type->_start_line=start_line; \
+        \
+                /* precached object files are already sorted, so add to tail */ \
+                if(presorted_objects==TRUE){ \
+                        \
+                        if(xodtemplate_##type##_list==NULL){ \
+                                xodtemplate_##type##_list=new_##type; \
+                                xodtemplate_##type##_list_tail=xodtemplate_##type##_list; \
+                        } else { \
+                                xodtemplate_##type##_list_tail->next=new_##type; \
+                                xodtemplate_##type##_list_tail=new_##type; \
+                        } \
+        \
+                        /* update current object pointer */ \
+                        xodtemplate_current_object=xodtemplate_##type##_list_tail; \
+                } else { \
+                        /* add new object to head of list in memory */ \
+                        new_##type->next=xodtemplate_##type##_list; \
+                        xodtemplate_##type##_list=new_##type; \
+        \
+                        /* update current object pointer */ \
+                        xodtemplate_current_object=xodtemplate_##type##_list; \
                 } \
         } while (0)
 
@@ -3653,6 +4045,8 @@ xodtemplate_customvariablesmember *xodtemplate_add_custom_variable_to_contact(xo
 /* adds a custom variable to an object */
 xodtemplate_customvariablesmember *xodtemplate_add_custom_variable_to_object(xodtemplate_customvariablesmember **object_ptr, char *varname, char *varvalue) {
 	xodtemplate_customvariablesmember *new_customvariablesmember = NULL;
+	size_t name_length = 0;
+	size_t value_length = 0;
 	register int x = 0;
 
 	/* make sure we have the data we need */
@@ -3662,19 +4056,16 @@ xodtemplate_customvariablesmember *xodtemplate_add_custom_variable_to_object(xod
 	if (varname == NULL || !strcmp(varname, ""))
 		return NULL;
 
-	/* allocate memory for a new member */
-	if ((new_customvariablesmember = calloc(1, sizeof(xodtemplate_customvariablesmember))) == NULL)
-		return NULL;
-	if ((new_customvariablesmember->variable_name = (char *)strdup(varname)) == NULL) {
-		my_free(new_customvariablesmember);
+	/* allocate memory for a new member, its name and value are kept in the same block */
+	name_length = strlen(varname) + 1;
+	value_length = (varvalue == NULL) ? 0 : strlen(varvalue) + 1;
+	if ((new_customvariablesmember = (xodtemplate_customvariablesmember *)malloc(sizeof(xodtemplate_customvariablesmember) + name_length + value_length)) == NULL)
 		return NULL;
-	}
+	new_customvariablesmember->variable_name = (char *)(new_customvariablesmember + 1);
+	memcpy(new_customvariablesmember->variable_name, varname, name_length);
 	if (varvalue) {
-		if ((new_customvariablesmember->variable_value = (char *)strdup(varvalue)) == NULL) {
-			my_free(new_customvariablesmember->variable_name);
-			my_free(new_customvariablesmember);
-			return NULL;
-		}
+		new_customvariablesmember->variable_value = new_customvariablesmember->variable_name + name_length;
+		memcpy(new_customvariablesmember->variable_value, varvalue, value_length);
 	} else
 		new_customvariablesmember->variable_value = NULL;
 
@@ -5999,6 +6390,163 @@ int xodtemplate_inherit_object_properties(void) {
 
 #ifdef NSCORE
 
+/* checks whether a list of custom variables names every variable only once */
+static int xodtemplate_has_unique_custom_variables(xodtemplate_customvariablesmember *custom_variables) {
+	xodtemplate_customvariablesmember *this_customvariablesmember = NULL;
+	xodtemplate_customvariablesmember *temp_customvariablesmember = NULL;
+
+	for (this_customvariablesmember = custom_variables; this_customvariablesmember != NULL; this_customvariablesmember = this_customvariablesmember->next) {
+		for (temp_customvariablesmember = this_customvariablesmember->next; temp_customvariablesmember != NULL; temp_customvariablesmember = temp_customvariablesmember->next) {
+			if (!strcmp(this_customvariablesmember->variable_name, temp_customvariablesmember->variable_name))
+				return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+
+/* returns the resolved host, service or contact templates named in a 'use' value, each value is only parsed once */
+static xodtemplate_template_cache *xodtemplate_get_templates(int object_type, char *template_names, int config_file, int start_line) {
+	xodtemplate_template_cache *temp_cache = NULL;
+	xodtemplate_host *template_host = NULL;
+	xodtemplate_service *template_service = NULL;
+	xodtemplate_contact *template_contact = NULL;
+	xodtemplate_customvariablesmember *custom_variables = NULL;
+	char *temp_ptr = NULL;
+	char *names = NULL;
+	char *names_ptr = NULL;
+	void *template_object = NULL;
+	void **new_templates = NULL;
+	int *new_unique_variables = NULL;
+	int hashslot = 0;
+
+	if (xodtemplate_template_cache_slots == NULL) {
+		if ((xodtemplate_template_cache_slots = (xodtemplate_template_cache **)calloc(XODTEMPLATE_TEMPLATE_CACHE_SLOTS, sizeof(xodtemplate_template_cache *))) == NULL)
+			return NULL;
+	}
+
+	xodtemplate_template_cache_lookups++;
+
+	/* did we see this value before? */
+	hashslot = hashfunc(template_names, NULL, XODTEMPLATE_TEMPLATE_CACHE_SLOTS);
+	for (temp_cache = xodtemplate_template_cache_slots[hashslot]; temp_cache != NULL; temp_cache = temp_cache->next) {
+		if (temp_cache->object_type == object_type && !strcmp(temp_cache->template_names, template_names)) {
+			xodtemplate_template_cache_hits++;
+			return temp_cache;
+		}
+	}
+
+	if ((temp_cache = (xodtemplate_template_cache *)calloc(1, sizeof(xodtemplate_template_cache))) == NULL)
+		return NULL;
+	temp_cache->object_type = object_type;
+	if ((temp_cache->template_names = (char *)strdup(template_names)) == NULL || (names = (char *)strdup(template_names)) == NULL) {
+		my_free(temp_cache->template_names);
+		my_free(temp_cache);
+		return NULL;
+	}
+
+	/* find and resolve all templates */
+	names_ptr = names;
+	for (temp_ptr = my_strsep(&names_ptr, ","); temp_ptr != NULL; temp_ptr = my_strsep(&names_ptr, ",")) {
+
+		/* strip whitespaces */
+		strip(temp_ptr);
+
+		if (object_type == XODTEMPLATE_HOST) {
+			if ((template_host = xodtemplate_find_host(temp_ptr)) != NULL) {
+				xodtemplate_resolve_host(template_host);
+				custom_variables = template_host->custom_variables;
+			}
+			template_object = template_host;
+		} else if (object_type == XODTEMPLATE_SERVICE) {
+			if ((template_service = xodtemplate_find_service(temp_ptr)) != NULL) {
+				xodtemplate_resolve_service(template_service);
+				custom_variables = template_service->custom_variables;
+			}
+			template_object = template_service;
+		} else {
+			if ((template_contact = xodtemplate_find_contact(temp_ptr)) != NULL) {
+				xodtemplate_resolve_contact(template_contact);
+				custom_variables = template_contact->custom_variables;
+			}
+			template_object = template_contact;
+		}
+
+		if (template_object == NULL)
+			logit(NSLOG_CONFIG_ERROR, TRUE, "Error: Template '%s' specified in %s definition could not be found (config file '%s', starting on line %d)\n", temp_ptr, (object_type == XODTEMPLATE_HOST) ? "host" : (object_type == XODTEMPLATE_SERVICE) ? "service" : "contact", xodtemplate_config_file_name(config_file), start_line);
+
+		else if ((new_templates = (void **)realloc(temp_cache->templates, (temp_cache->template_count + 1) * sizeof(void *))) != NULL) {
+			temp_cache->templates = new_templates;
+			if ((new_unique_variables = (int *)realloc(temp_cache->unique_variables, (temp_cache->template_count + 1) * sizeof(int))) != NULL) {
+				temp_cache->unique_variables = new_unique_variables;
+				temp_cache->templates[temp_cache->template_count] = template_object;
+				temp_cache->unique_variables[temp_cache->template_count] = xodtemplate_has_unique_custom_variables(custom_variables);
+				temp_cache->template_count++;
+				continue;
+			}
+		}
+
+		my_free(names);
+		my_free(temp_cache->templates);
+		my_free(temp_cache->unique_variables);
+		my_free(temp_cache->template_names);
+		my_free(temp_cache);
+		return NULL;
+	}
+
+	my_free(names);
+
+	temp_cache->next = xodtemplate_template_cache_slots[hashslot];
+	xodtemplate_template_cache_slots[hashslot] = temp_cache;
+
+	return temp_cache;
+}
+
+
+/* applies missing custom variables from a resolved template to an object */
+static void xodtemplate_inherit_custom_variables(xodtemplate_customvariablesmember **custom_variables, xodtemplate_customvariablesmember *template_variables, int unique_variables) {
+	xodtemplate_customvariablesmember *own_variables = *custom_variables;
+	xodtemplate_customvariablesmember *this_customvariablesmember = NULL;
+	xodtemplate_customvariablesmember *temp_customvariablesmember = NULL;
+
+	for (temp_customvariablesmember = template_variables; temp_customvariablesmember != NULL; temp_customvariablesmember = temp_customvariablesmember->next) {
+
+		/* see if the object has a variable by the same name - new variables are added to the head of the list, so own_variables still points to the ones the object had before */
+		for (this_customvariablesmember = (unique_variables == TRUE) ? own_variables : *custom_variables; this_customvariablesmember != NULL; this_customvariablesmember = this_customvariablesmember->next) {
+			if (!strcmp(temp_customvariablesmember->variable_name, this_customvariablesmember->variable_name))
+				break;
+		}
+
+		/* we didn't find the same variable name, so add a new custom variable */
+		if (this_customvariablesmember == NULL)
+			xodtemplate_add_custom_variable_to_object(custom_variables, temp_customvariablesmember->variable_name, temp_customvariablesmember->variable_value);
+	}
+}
+
+
+/* frees the cached template lists */
+static void xodtemplate_free_template_cache(void) {
+	xodtemplate_template_cache *this_cache = NULL;
+	xodtemplate_template_cache *next_cache = NULL;
+	int x = 0;
+
+	if (xodtemplate_template_cache_slots == NULL)
+		return;
+
+	for (x = 0; x < XODTEMPLATE_TEMPLATE_CACHE_SLOTS; x++) {
+		for (this_cache = xodtemplate_template_cache_slots[x]; this_cache != NULL; this_cache = next_cache) {
+			next_cache = this_cache->next;
+			my_free(this_cache->templates);
+			my_free(this_cache->unique_variables);
+			my_free(this_cache->template_names);
+			my_free(this_cache);
+		}
+	}
+	my_free(xodtemplate_template_cache_slots);
+}
+
+
 /* resolves object definitions */
 int xodtemplate_resolve_objects(void) {
 	xodtemplate_timeperiod *temp_timeperiod = NULL;
@@ -6017,6 +6565,9 @@ int xodtemplate_resolve_objects(void) {
 	xodtemplate_serviceextinfo *temp_serviceextinfo = NULL;
 	xodtemplate_module *temp_module = NULL;
 
+	xodtemplate_template_cache_lookups = 0L;
+	xodtemplate_template_cache_hits = 0L;
+
 	/* resolve all timeperiod objects */
 	for (temp_timeperiod = xodtemplate_timeperiod_list; temp_timeperiod != NULL; temp_timeperiod = temp_timeperiod->next) {
 		if (xodtemplate_resolve_timeperiod(temp_timeperiod) == ERROR)
@@ -6655,12 +7206,9 @@ int xodtemplate_resolve_serviceescalation(xodtemplate_serviceescalation *this_se
 
 /* resolves a contact object */
 int xodtemplate_resolve_contact(xodtemplate_contact *this_contact) {
-	char *temp_ptr = NULL;
-	char *template_names = NULL;
-	char *template_name_ptr = NULL;
+	xodtemplate_template_cache *template_cache = NULL;
 	xodtemplate_contact *template_contact = NULL;
-	xodtemplate_customvariablesmember *this_customvariablesmember = NULL;
-	xodtemplate_customvariablesmember *temp_customvariablesmember = NULL;
+	int template_num = 0;
 	int x;
 
 	/* return if this contact has already been resolved */
@@ -6674,25 +7222,14 @@ int xodtemplate_resolve_contact(xodtemplate_contact *this_contact) {
 	if (this_contact->template == NULL)
 		return OK;
 
-	if ((template_names = (char *)strdup(this_contact->template)) == NULL)
+	/* find the templates, every 'use' value is only looked up once */
+	if ((template_cache = xodtemplate_get_templates(XODTEMPLATE_CONTACT, this_contact->template, this_contact->_config_file, this_contact->_start_line)) == NULL)
 		return ERROR;
 
 	/* apply all templates */
-	template_name_ptr = template_names;
-	for (temp_ptr = my_strsep(&template_name_ptr, ","); temp_ptr != NULL; temp_ptr = my_strsep(&template_name_ptr, ",")) {
-
-		/* strip whitespaces */
-		strip(temp_ptr);
-
-		template_contact = xodtemplate_find_contact(temp_ptr);
-		if (template_contact == NULL) {
-			logit(NSLOG_CONFIG_ERROR, TRUE, "Error: Template '%s' specified in contact definition could not be found (config file '%s', starting on line %d)\n", temp_ptr, xodtemplate_config_file_name(this_contact->_config_file), this_contact->_start_line);
-			my_free(template_names);
-			return ERROR;
-		}
+	for (template_num = 0; template_num < template_cache->template_count; template_num++) {
 
-		/* resolve the template contact... */
-		xodtemplate_resolve_contact(template_contact);
+		template_contact = (xodtemplate_contact *)template_cache->templates[template_num];
 
 		/* apply missing properties from template contact... */
 		if (this_contact->contact_name == NULL && template_contact->contact_name != NULL)
@@ -6771,22 +7308,9 @@ int xodtemplate_resolve_contact(xodtemplate_contact *this_contact) {
 		}
 
 		/* apply missing custom variables from template contact... */
-		for (temp_customvariablesmember = template_contact->custom_variables; temp_customvariablesmember != NULL; temp_customvariablesmember = temp_customvariablesmember->next) {
-
-			/* see if this host has a variable by the same name */
-			for (this_customvariablesmember = this_contact->custom_variables; this_customvariablesmember != NULL; this_customvariablesmember = this_customvariablesmember->next) {
-				if (!strcmp(temp_customvariablesmember->variable_name, this_customvariablesmember->variable_name))
-					break;
-			}
-
-			/* we didn't find the same variable name, so add a new custom variable */
-			if (this_customvariablesmember == NULL)
-				xodtemplate_add_custom_variable_to_contact(this_contact, temp_customvariablesmember->variable_name, temp_customvariablesmember->variable_value);
-		}
+		xodtemplate_inherit_custom_variables(&this_contact->custom_variables, template_contact->custom_variables, template_cache->unique_variables[template_num]);
 	}
 
-	my_free(template_names);
-
 	return OK;
 }
 
@@ -6794,12 +7318,9 @@ int xodtemplate_resolve_contact(xodtemplate_contact *this_contact) {
 
 /* resolves a host object */
 int xodtemplate_resolve_host(xodtemplate_host *this_host) {
-	char *temp_ptr = NULL;
-	char *template_names = NULL;
-	char *template_name_ptr = NULL;
+	xodtemplate_template_cache *template_cache = NULL;
 	xodtemplate_host *template_host = NULL;
-	xodtemplate_customvariablesmember *this_customvariablesmember = NULL;
-	xodtemplate_customvariablesmember *temp_customvariablesmember = NULL;
+	int template_num = 0;
 
 	/* return if this host has already been resolved */
 	if (this_host->has_been_resolved == TRUE)
@@ -6812,25 +7333,14 @@ int xodtemplate_resolve_host(xodtemplate_host *this_host) {
 	if (this_host->template == NULL)
 		return OK;
 
-	if ((template_names = (char *)strdup(this_host->template)) == NULL)
+	/* find the templates, every 'use' value is only looked up once */
+	if ((template_cache = xodtemplate_get_templates(XODTEMPLATE_HOST, this_host->template, this_host->_config_file, this_host->_start_line)) == NULL)
 		return ERROR;
 
 	/* apply all templates */
-	template_name_ptr = template_names;
-	for (temp_ptr = my_strsep(&template_name_ptr, ","); temp_ptr != NULL; temp_ptr = my_strsep(&template_name_ptr, ",")) {
+	for (template_num = 0; template_num < template_cache->template_count; template_num++) {
 
-		/* strip whitespaces */
-		strip(temp_ptr);
-
-		template_host = xodtemplate_find_host(temp_ptr);
-		if (template_host == NULL) {
-			logit(NSLOG_CONFIG_ERROR, TRUE, "Error: Template '%s' specified in host definition could not be found (config file '%s', starting on line %d)\n", temp_ptr, xodtemplate_config_file_name(this_host->_config_file), this_host->_start_line);
-			my_free(template_names);
-			return ERROR;
-		}
-
-		/* resolve the template host... */
-		xodtemplate_resolve_host(template_host);
+		template_host = (xodtemplate_host *)template_cache->templates[template_num];
 
 		/* apply missing properties from template host... */
 		if (this_host->host_name == NULL && template_host->host_name != NULL)
@@ -7025,22 +7535,9 @@ int xodtemplate_resolve_host(xodtemplate_host *this_host) {
 		}
 
 		/* apply missing custom variables from template host... */
-		for (temp_customvariablesmember = template_host->custom_variables; temp_customvariablesmember != NULL; temp_customvariablesmember = temp_customvariablesmember->next) {
-
-			/* see if this host has a variable by the same name */
-			for (this_customvariablesmember = this_host->custom_variables; this_customvariablesmember != NULL; this_customvariablesmember = this_customvariablesmember->next) {
-				if (!strcmp(temp_customvariablesmember->variable_name, this_customvariablesmember->variable_name))
-					break;
-			}
-
-			/* we didn't find the same variable name, so add a new custom variable */
-			if (this_customvariablesmember == NULL)
-				xodtemplate_add_custom_variable_to_host(this_host, temp_customvariablesmember->variable_name, temp_customvariablesmember->variable_value);
-		}
+		xodtemplate_inherit_custom_variables(&this_host->custom_variables, template_host->custom_variables, template_cache->unique_variables[template_num]);
 	}
 
-	my_free(template_names);
-
 	return OK;
 }
 
@@ -7048,12 +7545,9 @@ int xodtemplate_resolve_host(xodtemplate_host *this_host) {
 
 /* resolves a service object */
 int xodtemplate_resolve_service(xodtemplate_service *this_service) {
-	char *temp_ptr = NULL;
-	char *template_names = NULL;
-	char *template_name_ptr = NULL;
+	xodtemplate_template_cache *template_cache = NULL;
 	xodtemplate_service *template_service = NULL;
-	xodtemplate_customvariablesmember *this_customvariablesmember = NULL;
-	xodtemplate_customvariablesmember *temp_customvariablesmember = NULL;
+	int template_num = 0;
 
 	/* return if this service has already been resolved */
 	if (this_service->has_been_resolved == TRUE)
@@ -7066,25 +7560,14 @@ int xodtemplate_resolve_service(xodtemplate_service *this_service) {
 	if (this_service->template == NULL)
 		return OK;
 
-	if ((template_names = (char *)strdup(this_service->template)) == NULL)
+	/* find the templates, every 'use' value is only looked up once */
+	if ((template_cache = xodtemplate_get_templates(XODTEMPLATE_SERVICE, this_service->template, this_service->_config_file, this_service->_start_line)) == NULL)
 		return ERROR;
 
 	/* apply all templates */
-	template_name_ptr = template_names;
-	for (temp_ptr = my_strsep(&template_name_ptr, ","); temp_ptr != NULL; temp_ptr = my_strsep(&template_name_ptr, ",")) {
+	for (template_num = 0; template_num < template_cache->template_count; template_num++) {
 
-		/* strip whitespaces */
-		strip(temp_ptr);
-
-		template_service = xodtemplate_find_service(temp_ptr);
-		if (template_service == NULL) {
-			logit(NSLOG_CONFIG_ERROR, TRUE, "Error: Template '%s' specified in service definition could not be found (config file '%s', starting on line %d)\n", temp_ptr, xodtemplate_config_file_name(this_service->_config_file), this_service->_start_line);
-			my_free(template_names);
-			return ERROR;
-		}
-
-		/* resolve the template service... */
-		xodtemplate_resolve_service(template_service);
+		template_service = (xodtemplate_service *)template_cache->templates[template_num];
 
 		/* apply missing properties from template service... */
 		if (this_service->have_service_description == FALSE && template_service->have_service_description == TRUE) {
@@ -7273,22 +7756,9 @@ int xodtemplate_resolve_service(xodtemplate_service *this_service) {
 		}
 
 		/* apply missing custom variables from template service... */
-		for (temp_customvariablesmember = template_service->custom_variables; temp_customvariablesmember != NULL; temp_customvariablesmember = temp_customvariablesmember->next) {
-
-			/* see if this host has a variable by the same name */
-			for (this_customvariablesmember = this_service->custom_variables; this_customvariablesmember != NULL; this_customvariablesmember = this_customvariablesmember->next) {
-				if (!strcmp(temp_customvariablesmember->variable_name, this_customvariablesmember->variable_name))
-					break;
-			}
-
-			/* we didn't find the same variable name, so add a new custom variable */
-			if (this_customvariablesmember == NULL)
-				xodtemplate_add_custom_variable_to_service(this_service, temp_customvariablesmember->variable_name, temp_customvariablesmember->variable_value);
-		}
+		xodtemplate_inherit_custom_variables(&this_service->custom_variables, template_service->custom_variables, template_cache->unique_variables[template_num]);
 	}
 
-	my_free(template_names);
-
 	return OK;
 }
 
@@ -11003,229 +11473,1422 @@ int xodtemplate_cache_objects(char *cache_file) {
 		fprintf(fp, "\tretain_status_information\t%d\n", temp_service->retain_status_information);
 		fprintf(fp, "\tretain_nonstatus_information\t%d\n", temp_service->retain_nonstatus_information);
 
-		/* custom variables */
-		for (temp_customvariablesmember = temp_service->custom_variables; temp_customvariablesmember != NULL; temp_customvariablesmember = temp_customvariablesmember->next) {
-			if (temp_customvariablesmember->variable_name)
-				fprintf(fp, "\t_%s\t%s\n", temp_customvariablesmember->variable_name, (temp_customvariablesmember->variable_value == NULL) ? XODTEMPLATE_NULL : temp_customvariablesmember->variable_value);
-		}
+		/* custom variables */
+		for (temp_customvariablesmember = temp_service->custom_variables; temp_customvariablesmember != NULL; temp_customvariablesmember = temp_customvariablesmember->next) {
+			if (temp_customvariablesmember->variable_name)
+				fprintf(fp, "\t_%s\t%s\n", temp_customvariablesmember->variable_name, (temp_customvariablesmember->variable_value == NULL) ? XODTEMPLATE_NULL : temp_customvariablesmember->variable_value);
+		}
+
+		fprintf(fp, "\t}\n\n");
+	}
+
+	/* cache service dependencies */
+	/*for(temp_servicedependency=xodtemplate_servicedependency_list;temp_servicedependency!=NULL;temp_servicedependency=temp_servicedependency->next){*/
+	ptr = NULL;
+	for (temp_servicedependency = (xodtemplate_servicedependency *)skiplist_get_first(xobject_skiplists[X_SERVICEDEPENDENCY_SKIPLIST], &ptr); temp_servicedependency != NULL; temp_servicedependency = (xodtemplate_servicedependency *)skiplist_get_next(&ptr)) {
+		if (temp_servicedependency->register_object == FALSE)
+			continue;
+		fprintf(fp, "define servicedependency {\n");
+		if (temp_servicedependency->host_name)
+			fprintf(fp, "\thost_name\t%s\n", temp_servicedependency->host_name);
+		if (temp_servicedependency->service_description)
+			fprintf(fp, "\tservice_description\t%s\n", temp_servicedependency->service_description);
+		if (temp_servicedependency->dependent_host_name)
+			fprintf(fp, "\tdependent_host_name\t%s\n", temp_servicedependency->dependent_host_name);
+		if (temp_servicedependency->dependent_service_description)
+			fprintf(fp, "\tdependent_service_description\t%s\n", temp_servicedependency->dependent_service_description);
+		if (temp_servicedependency->dependency_period)
+			fprintf(fp, "\tdependency_period\t%s\n", temp_servicedependency->dependency_period);
+		fprintf(fp, "\tinherits_parent\t%d\n", temp_servicedependency->inherits_parent);
+		if (temp_servicedependency->have_notification_dependency_options == TRUE) {
+			fprintf(fp, "\tnotification_failure_options\t");
+			x = 0;
+			if (temp_servicedependency->fail_notify_on_ok == TRUE)
+				fprintf(fp, "%so", (x++ > 0) ? "," : "");
+			if (temp_servicedependency->fail_notify_on_unknown == TRUE)
+				fprintf(fp, "%su", (x++ > 0) ? "," : "");
+			if (temp_servicedependency->fail_notify_on_warning == TRUE)
+				fprintf(fp, "%sw", (x++ > 0) ? "," : "");
+			if (temp_servicedependency->fail_notify_on_critical == TRUE)
+				fprintf(fp, "%sc", (x++ > 0) ? "," : "");
+			if (temp_servicedependency->fail_notify_on_pending == TRUE)
+				fprintf(fp, "%sp", (x++ > 0) ? "," : "");
+			if (x == 0)
+				fprintf(fp, "n");
+			fprintf(fp, "\n");
+		}
+		if (temp_servicedependency->have_execution_dependency_options == TRUE) {
+			fprintf(fp, "\texecution_failure_options\t");
+			x = 0;
+			if (temp_servicedependency->fail_execute_on_ok == TRUE)
+				fprintf(fp, "%so", (x++ > 0) ? "," : "");
+			if (temp_servicedependency->fail_execute_on_unknown == TRUE)
+				fprintf(fp, "%su", (x++ > 0) ? "," : "");
+			if (temp_servicedependency->fail_execute_on_warning == TRUE)
+				fprintf(fp, "%sw", (x++ > 0) ? "," : "");
+			if (temp_servicedependency->fail_execute_on_critical == TRUE)
+				fprintf(fp, "%sc", (x++ > 0) ? "," : "");
+			if (temp_servicedependency->fail_execute_on_pending == TRUE)
+				fprintf(fp, "%sp", (x++ > 0) ? "," : "");
+			if (x == 0)
+				fprintf(fp, "n");
+			fprintf(fp, "\n");
+		}
+		fprintf(fp, "\t}\n\n");
+	}
+
+	/* cache service escalations */
+	/*for(temp_serviceescalation=xodtemplate_serviceescalation_list;temp_serviceescalation!=NULL;temp_serviceescalation=temp_serviceescalation->next){*/
+	ptr = NULL;
+	for (temp_serviceescalation = (xodtemplate_serviceescalation *)skiplist_get_first(xobject_skiplists[X_SERVICEESCALATION_SKIPLIST], &ptr); temp_serviceescalation != NULL; temp_serviceescalation = (xodtemplate_serviceescalation *)skiplist_get_next(&ptr)) {
+		if (temp_serviceescalation->register_object == FALSE)
+			continue;
+		fprintf(fp, "define serviceescalation {\n");
+		if (temp_serviceescalation->host_name)
+			fprintf(fp, "\thost_name\t%s\n", temp_serviceescalation->host_name);
+		if (temp_serviceescalation->service_description)
+			fprintf(fp, "\tservice_description\t%s\n", temp_serviceescalation->service_description);
+		fprintf(fp, "\tfirst_notification\t%d\n", temp_serviceescalation->first_notification);
+		fprintf(fp, "\tlast_notification\t%d\n", temp_serviceescalation->last_notification);
+		/* state based escalation ranges */
+		fprintf(fp, "\tfirst_warning_notification\t%d\n", temp_serviceescalation->first_warning_notification);
+		fprintf(fp, "\tlast_warning_notification\t%d\n", temp_serviceescalation->last_warning_notification);
+		fprintf(fp, "\tfirst_critical_notification\t%d\n", temp_serviceescalation->first_critical_notification);
+		fprintf(fp, "\tlast_critical_notification\t%d\n", temp_serviceescalation->last_critical_notification);
+		fprintf(fp, "\tfirst_unknown_notification\t%d\n", temp_serviceescalation->first_unknown_notification);
+		fprintf(fp, "\tlast_unknown_notification\t%d\n", temp_serviceescalation->last_unknown_notification);
+
+		fprintf(fp, "\tnotification_interval\t%f\n", temp_serviceescalation->notification_interval);
+		if (temp_serviceescalation->escalation_period)
+			fprintf(fp, "\tescalation_period\t%s\n", temp_serviceescalation->escalation_period);
+		if (temp_serviceescalation->have_escalation_options == TRUE) {
+			fprintf(fp, "\tescalation_options\t");
+			x = 0;
+			if (temp_serviceescalation->escalate_on_warning == TRUE)
+				fprintf(fp, "%sw", (x++ > 0) ? "," : "");
+			if (temp_serviceescalation->escalate_on_unknown == TRUE)
+				fprintf(fp, "%su", (x++ > 0) ? "," : "");
+			if (temp_serviceescalation->escalate_on_critical == TRUE)
+				fprintf(fp, "%sc", (x++ > 0) ? "," : "");
+			if (temp_serviceescalation->escalate_on_recovery == TRUE)
+				fprintf(fp, "%sr", (x++ > 0) ? "," : "");
+			if (x == 0)
+				fprintf(fp, "n");
+			fprintf(fp, "\n");
+		}
+		if (temp_serviceescalation->contacts)
+			fprintf(fp, "\tcontacts\t%s\n", temp_serviceescalation->contacts);
+		if (temp_serviceescalation->contact_groups)
+			fprintf(fp, "\tcontact_groups\t%s\n", temp_serviceescalation->contact_groups);
+		fprintf(fp, "\t}\n\n");
+	}
+
+	/* cache host dependencies */
+	/*for(temp_hostdependency=xodtemplate_hostdependency_list;temp_hostdependency!=NULL;temp_hostdependency=temp_hostdependency->next){*/
+	ptr = NULL;
+	for (temp_hostdependency = (xodtemplate_hostdependency *)skiplist_get_first(xobject_skiplists[X_HOSTDEPENDENCY_SKIPLIST], &ptr); temp_hostdependency != NULL; temp_hostdependency = (xodtemplate_hostdependency *)skiplist_get_next(&ptr)) {
+		if (temp_hostdependency->register_object == FALSE)
+			continue;
+		fprintf(fp, "define hostdependency {\n");
+		if (temp_hostdependency->host_name)
+			fprintf(fp, "\thost_name\t%s\n", temp_hostdependency->host_name);
+		if (temp_hostdependency->dependent_host_name)
+			fprintf(fp, "\tdependent_host_name\t%s\n", temp_hostdependency->dependent_host_name);
+		if (temp_hostdependency->dependency_period)
+			fprintf(fp, "\tdependency_period\t%s\n", temp_hostdependency->dependency_period);
+		fprintf(fp, "\tinherits_parent\t%d\n", temp_hostdependency->inherits_parent);
+		if (temp_hostdependency->have_notification_dependency_options == TRUE) {
+			fprintf(fp, "\tnotification_failure_options\t");
+			x = 0;
+			if (temp_hostdependency->fail_notify_on_up == TRUE)
+				fprintf(fp, "%so", (x++ > 0) ? "," : "");
+			if (temp_hostdependency->fail_notify_on_down == TRUE)
+				fprintf(fp, "%sd", (x++ > 0) ? "," : "");
+			if (temp_hostdependency->fail_notify_on_unreachable == TRUE)
+				fprintf(fp, "%su", (x++ > 0) ? "," : "");
+			if (temp_hostdependency->fail_notify_on_pending == TRUE)
+				fprintf(fp, "%sp", (x++ > 0) ? "," : "");
+			if (x == 0)
+				fprintf(fp, "n");
+			fprintf(fp, "\n");
+		}
+		if (temp_hostdependency->have_execution_dependency_options == TRUE) {
+			fprintf(fp, "\texecution_failure_options\t");
+			x = 0;
+			if (temp_hostdependency->fail_execute_on_up == TRUE)
+				fprintf(fp, "%so", (x++ > 0) ? "," : "");
+			if (temp_hostdependency->fail_execute_on_down == TRUE)
+				fprintf(fp, "%sd", (x++ > 0) ? "," : "");
+			if (temp_hostdependency->fail_execute_on_unreachable == TRUE)
+				fprintf(fp, "%su", (x++ > 0) ? "," : "");
+			if (temp_hostdependency->fail_execute_on_pending == TRUE)
+				fprintf(fp, "%sp", (x++ > 0) ? "," : "");
+			if (x == 0)
+				fprintf(fp, "n");
+			fprintf(fp, "\n");
+		}
+		fprintf(fp, "\t}\n\n");
+	}
+
+	/* cache host escalations */
+	/*for(temp_hostescalation=xodtemplate_hostescalation_list;temp_hostescalation!=NULL;temp_hostescalation=temp_hostescalation->next){*/
+	ptr = NULL;
+	for (temp_hostescalation = (xodtemplate_hostescalation *)skiplist_get_first(xobject_skiplists[X_HOSTESCALATION_SKIPLIST], &ptr); temp_hostescalation != NULL; temp_hostescalation = (xodtemplate_hostescalation *)skiplist_get_next(&ptr)) {
+		if (temp_hostescalation->register_object == FALSE)
+			continue;
+		fprintf(fp, "define hostescalation {\n");
+		if (temp_hostescalation->host_name)
+			fprintf(fp, "\thost_name\t%s\n", temp_hostescalation->host_name);
+		fprintf(fp, "\tfirst_notification\t%d\n", temp_hostescalation->first_notification);
+		fprintf(fp, "\tlast_notification\t%d\n", temp_hostescalation->last_notification);
+		/* state based escalation ranges */
+		fprintf(fp, "\tfirst_down_notification\t%d\n", temp_hostescalation->first_down_notification);
+		fprintf(fp, "\tlast_down_notification\t%d\n", temp_hostescalation->last_down_notification);
+		fprintf(fp, "\tfirst_unreachable_notification\t%d\n", temp_hostescalation->first_unreachable_notification);
+		fprintf(fp, "\tlast_unreachable_notification\t%d\n", temp_hostescalation->last_unreachable_notification);
+
+		fprintf(fp, "\tnotification_interval\t%f\n", temp_hostescalation->notification_interval);
+		if (temp_hostescalation->escalation_period)
+			fprintf(fp, "\tescalation_period\t%s\n", temp_hostescalation->escalation_period);
+		if (temp_hostescalation->have_escalation_options == TRUE) {
+			fprintf(fp, "\tescalation_options\t");
+			x = 0;
+			if (temp_hostescalation->escalate_on_down == TRUE)
+				fprintf(fp, "%sd", (x++ > 0) ? "," : "");
+			if (temp_hostescalation->escalate_on_unreachable == TRUE)
+				fprintf(fp, "%su", (x++ > 0) ? "," : "");
+			if (temp_hostescalation->escalate_on_recovery == TRUE)
+				fprintf(fp, "%sr", (x++ > 0) ? "," : "");
+			if (x == 0)
+				fprintf(fp, "n");
+			fprintf(fp, "\n");
+		}
+		if (temp_hostescalation->contacts)
+			fprintf(fp, "\tcontacts\t%s\n", temp_hostescalation->contacts);
+		if (temp_hostescalation->contact_groups)
+			fprintf(fp, "\tcontact_groups\t%s\n", temp_hostescalation->contact_groups);
+		fprintf(fp, "\t}\n\n");
+	}
+
+	/* cache modules */
+	/*for(temp_module=xodtemplate_module_list;temp_module!=NULL;temp_module=temp_module->next){*/
+	ptr = NULL;
+	for (temp_module = (xodtemplate_module *)skiplist_get_first(xobject_skiplists[X_MODULE_SKIPLIST], &ptr); temp_module != NULL; temp_module = (xodtemplate_module *)skiplist_get_next(&ptr)) {
+		if (temp_module->register_object == FALSE)
+			continue;
+		fprintf(fp, "define module {\n");
+		if (temp_module->module_name)
+			fprintf(fp, "\tmodule_name\t%s\n", temp_module->module_name);
+		if (temp_module->module_type)
+			fprintf(fp, "\tmodule_type\t%s\n", temp_module->module_type);
+		if (temp_module->path)
+			fprintf(fp, "\tpath\t%s\n", temp_module->path);
+		if (temp_module->args)
+			fprintf(fp, "\targs\t%s\n", temp_module->args);
+		fprintf(fp, "\t}\n\n");
+	}
+
+
+	fclose(fp);
+
+	return OK;
+}
+
+#endif
+
+/******************************************************************/
+/******************* BINARY CACHE FUNCTIONS ***********************/
+/******************************************************************/
+
+#ifdef NSCORE
+
+/* record sizes of the sections of the binary object cache, the string table is counted in bytes */
+static unsigned long xodtemplate_binary_record_sizes[XODTEMPLATE_BINARY_SECTIONS] = {
+	sizeof(xodtemplate_binary_timeperiod),
+	sizeof(xodtemplate_binary_command),
+	sizeof(xodtemplate_binary_group),
+	sizeof(xodtemplate_binary_group),
+	sizeof(xodtemplate_binary_group),
+	sizeof(xodtemplate_binary_contact),
+	sizeof(xodtemplate_binary_host),
+	sizeof(xodtemplate_binary_service),
+	sizeof(xodtemplate_binary_dependency),
+	sizeof(xodtemplate_binary_escalation),
+	sizeof(xodtemplate_binary_dependency),
+	sizeof(xodtemplate_binary_escalation),
+	sizeof(xodtemplate_binary_module),
+	sizeof(xodtemplate_binary_daterange),
+	sizeof(xodtemplate_binary_timerange),
+	sizeof(xodtemplate_binary_condition),
+	sizeof(xodtemplate_binary_member),
+	1
+	};
+
+
+/* appends a record to a section of the binary object cache */
+static int xodtemplate_append_binary_data(xodtemplate_binary_buffer *buffers, int section, void *data) {
+	xodtemplate_binary_buffer *buffer = &buffers[section];
+	unsigned long size = xodtemplate_binary_record_sizes[section];
+	char *new_data = NULL;
+
+	if (buffer->size + size > buffer->allocated) {
+		if ((new_data = (char *)realloc(buffer->data, (buffer->allocated + size) * 2)) == NULL)
+			return ERROR;
+		buffer->data = new_data;
+		buffer->allocated = (buffer->allocated + size) * 2;
+	}
+
+	memcpy(buffer->data + buffer->size, data, size);
+	buffer->size += size;
+
+	return OK;
+}
+
+
+/* returns the index the next record of a section will get */
+static unsigned long xodtemplate_binary_index(xodtemplate_binary_buffer *buffers, int section) {
+
+	return buffers[section].size / xodtemplate_binary_record_sizes[section];
+}
+
+
+/* appends a string to the string table, unlike empty strings missing ones have no offset */
+static int xodtemplate_add_binary_string(xodtemplate_binary_buffer *buffers, char *string, unsigned long *offset) {
+	char *temp_ptr = NULL;
+
+	*offset = XODTEMPLATE_BINARY_NONE;
+	if (string == NULL)
+		return OK;
+
+	*offset = buffers[XODTEMPLATE_BINARY_STRING].size;
+	for (temp_ptr = string; ; temp_ptr++) {
+		if (xodtemplate_append_binary_data(buffers, XODTEMPLATE_BINARY_STRING, temp_ptr) == ERROR)
+			return ERROR;
+		if (*temp_ptr == '\x0')
+			break;
+	}
+
+	return OK;
+}
+
+
+/* appends a member of an object list */
+static int xodtemplate_add_binary_member(xodtemplate_binary_buffer *buffers, char *name, char *value, unsigned long *count) {
+	xodtemplate_binary_member record;
+
+	if (xodtemplate_add_binary_string(buffers, name, &record.name) == ERROR
+	        || xodtemplate_add_binary_string(buffers, value, &record.value) == ERROR
+	        || xodtemplate_append_binary_data(buffers, XODTEMPLATE_BINARY_MEMBER, &record) == ERROR)
+		return ERROR;
+
+	(*count)++;
+
+	return OK;
+}
+
+
+/* appends the custom variables of an object */
+static int xodtemplate_add_binary_custom_variables(xodtemplate_binary_buffer *buffers, customvariablesmember *first, unsigned long *index, unsigned long *count) {
+	customvariablesmember *temp_customvariablesmember = NULL;
+
+	*index = xodtemplate_binary_index(buffers, XODTEMPLATE_BINARY_MEMBER);
+	*count = 0L;
+	for (temp_customvariablesmember = first; temp_customvariablesmember != NULL; temp_customvariablesmember = temp_customvariablesmember->next) {
+		if (xodtemplate_add_binary_member(buffers, temp_customvariablesmember->variable_name, temp_customvariablesmember->variable_value, count) == ERROR)
+			return ERROR;
+	}
+
+	return OK;
+}
+
+
+/* appends the contact groups of an object */
+static int xodtemplate_add_binary_contactgroups(xodtemplate_binary_buffer *buffers, contactgroupsmember *first, unsigned long *index, unsigned long *count) {
+	contactgroupsmember *temp_contactgroupsmember = NULL;
+
+	*index = xodtemplate_binary_index(buffers, XODTEMPLATE_BINARY_MEMBER);
+	*count = 0L;
+	for (temp_contactgroupsmember = first; temp_contactgroupsmember != NULL; temp_contactgroupsmember = temp_contactgroupsmember->next) {
+		if (xodtemplate_add_binary_member(buffers, temp_contactgroupsmember->group_name, NULL, count) == ERROR)
+			return ERROR;
+	}
+
+	return OK;
+}
+
+
+/* appends the contacts of an object */
+static int xodtemplate_add_binary_contacts(xodtemplate_binary_buffer *buffers, contactsmember *first, unsigned long *index, unsigned long *count) {
+	contactsmember *temp_contactsmember = NULL;
+
+	*index = xodtemplate_binary_index(buffers, XODTEMPLATE_BINARY_MEMBER);
+	*count = 0L;
+	for (temp_contactsmember = first; temp_contactsmember != NULL; temp_contactsmember = temp_contactsmember->next) {
+		if (xodtemplate_add_binary_member(buffers, temp_contactsmember->contact_name, NULL, count) == ERROR)
+			return ERROR;
+	}
+
+	return OK;
+}
+
+
+/* appends the notification commands of a contact */
+static int xodtemplate_add_binary_commands(xodtemplate_binary_buffer *buffers, commandsmember *first, unsigned long *index, unsigned long *count) {
+	commandsmember *temp_commandsmember = NULL;
+
+	*index = xodtemplate_binary_index(buffers, XODTEMPLATE_BINARY_MEMBER);
+	*count = 0L;
+	for (temp_commandsmember = first; temp_commandsmember != NULL; temp_commandsmember = temp_commandsmember->next) {
+		if (xodtemplate_add_binary_member(buffers, temp_commandsmember->command, NULL, count) == ERROR)
+			return ERROR;
+	}
+
+	return OK;
+}
+
+
+/* appends the conditions of an escalation */
+static int xodtemplate_add_binary_conditions(xodtemplate_binary_buffer *buffers, escalation_condition *first, unsigned long *index, unsigned long *count) {
+	escalation_condition *temp_condition = NULL;
+	xodtemplate_binary_condition record;
+
+	*index = xodtemplate_binary_index(buffers, XODTEMPLATE_BINARY_CONDITION);
+	*count = 0L;
+	for (temp_condition = first; temp_condition != NULL; temp_condition = temp_condition->next) {
+		memset(&record, 0, sizeof(record));
+		if (xodtemplate_add_binary_string(buffers, temp_condition->host_name, &record.host_name) == ERROR
+		        || xodtemplate_add_binary_string(buffers, temp_condition->service_description, &record.service_description) == ERROR)
+			return ERROR;
+		record.connector = temp_condition->connector;
+		record.escalate_on_down = temp_condition->escalate_on_down;
+		record.escalate_on_unreachable = temp_condition->escalate_on_unreachable;
+		record.escalate_on_warning = temp_condition->escalate_on_warning;
+		record.escalate_on_unknown = temp_condition->escalate_on_unknown;
+		record.escalate_on_critical = temp_condition->escalate_on_critical;
+		record.escalate_on_ok = temp_condition->escalate_on_ok;
+		if (xodtemplate_append_binary_data(buffers, XODTEMPLATE_BINARY_CONDITION, &record) == ERROR)
+			return ERROR;
+		(*count)++;
+	}
+
+	return OK;
+}
+
+
+/* appends a timeperiod with its time ranges, exceptions and exclusions */
+static int xodtemplate_add_binary_timeperiod(xodtemplate_binary_buffer *buffers, timeperiod *temp_timeperiod) {
+	xodtemplate_binary_timeperiod record;
+	xodtemplate_binary_daterange daterange_record;
+	xodtemplate_binary_timerange timerange_record;
+	daterange *temp_daterange = NULL;
+	timerange *temp_timerange = NULL;
+	timeperiodexclusion *temp_timeperiodexclusion = NULL;
+	int x = 0;
+
+	memset(&record, 0, sizeof(record));
+	if (xodtemplate_add_binary_string(buffers, temp_timeperiod->name, &record.name) == ERROR
+	        || xodtemplate_add_binary_string(buffers, temp_timeperiod->alias, &record.alias) == ERROR)
+		return ERROR;
+
+	for (x = 0; x < 7; x++) {
+		record.days_index[x] = xodtemplate_binary_index(buffers, XODTEMPLATE_BINARY_TIMERANGE);
+		for (temp_timerange = temp_timeperiod->days[x]; temp_timerange != NULL; temp_timerange = temp_timerange->next) {
+			timerange_record.range_start = temp_timerange->range_start;
+			timerange_record.range_end = temp_timerange->range_end;
+			if (xodtemplate_append_binary_data(buffers, XODTEMPLATE_BINARY_TIMERANGE, &timerange_record) == ERROR)
+				return ERROR;
+			record.days_count[x]++;
+		}
+	}
+
+	/* the exceptions of all types are kept together, each one knows its type */
+	record.exceptions_index = xodtemplate_binary_index(buffers, XODTEMPLATE_BINARY_DATERANGE);
+	for (x = 0; x < DATERANGE_TYPES; x++) {
+		for (temp_daterange = temp_timeperiod->exceptions[x]; temp_daterange != NULL; temp_daterange = temp_daterange->next) {
+			memset(&daterange_record, 0, sizeof(daterange_record));
+			daterange_record.times_index = xodtemplate_binary_index(buffers, XODTEMPLATE_BINARY_TIMERANGE);
+			for (temp_timerange = temp_daterange->times; temp_timerange != NULL; temp_timerange = temp_timerange->next) {
+				timerange_record.range_start = temp_timerange->range_start;
+				timerange_record.range_end = temp_timerange->range_end;
+				if (xodtemplate_append_binary_data(buffers, XODTEMPLATE_BINARY_TIMERANGE, &timerange_record) == ERROR)
+					return ERROR;
+				daterange_record.times_count++;
+			}
+			daterange_record.type = temp_daterange->type;
+			daterange_record.syear = temp_daterange->syear;
+			daterange_record.smon = temp_daterange->smon;
+			daterange_record.smday = temp_daterange->smday;
+			daterange_record.swday = temp_daterange->swday;
+			daterange_record.swday_offset = temp_daterange->swday_offset;
+			daterange_record.eyear = temp_daterange->eyear;
+			daterange_record.emon = temp_daterange->emon;
+			daterange_record.emday = temp_daterange->emday;
+			daterange_record.ewday = temp_daterange->ewday;
+			daterange_record.ewday_offset = temp_daterange->ewday_offset;
+			daterange_record.skip_interval = temp_daterange->skip_interval;
+			if (xodtemplate_append_binary_data(buffers, XODTEMPLATE_BINARY_DATERANGE, &daterange_record) == ERROR)
+				return ERROR;
+			record.exceptions_count++;
+		}
+	}
+
+	record.exclusions_index = xodtemplate_binary_index(buffers, XODTEMPLATE_BINARY_MEMBER);
+	for (temp_timeperiodexclusion = temp_timeperiod->exclusions; temp_timeperiodexclusion != NULL; temp_timeperiodexclusion = temp_timeperiodexclusion->next) {
+		if (xodtemplate_add_binary_member(buffers, temp_timeperiodexclusion->timeperiod_name, NULL, &record.exclusions_count) == ERROR)
+			return ERROR;
+	}
+
+	return xodtemplate_append_binary_data(buffers, XODTEMPLATE_BINARY_TIMEPERIOD, &record);
+}
+
+
+/* appends a contact */
+static int xodtemplate_add_binary_contact(xodtemplate_binary_buffer *buffers, contact *temp_contact) {
+	xodtemplate_binary_contact record;
+	int x = 0;
+
+	memset(&record, 0, sizeof(record));
+	if (xodtemplate_add_binary_string(buffers, temp_contact->name, &record.name) == ERROR
+	        || xodtemplate_add_binary_string(buffers, temp_contact->alias, &record.alias) == ERROR
+	        || xodtemplate_add_binary_string(buffers, temp_contact->email, &record.email) == ERROR
+	        || xodtemplate_add_binary_string(buffers, temp_contact->pager, &record.pager) == ERROR
+	        || xodtemplate_add_binary_string(buffers, temp_contact->host_notification_period, &record.host_notification_period) == ERROR
+	        || xodtemplate_add_binary_string(buffers, temp_contact->service_notification_period, &record.service_notification_period) == ERROR)
+		return ERROR;
+	for (x = 0; x < MAX_CONTACT_ADDRESSES; x++) {
+		if (xodtemplate_add_binary_string(buffers, temp_contact->address[x], &record.address[x]) == ERROR)
+			return ERROR;
+	}
+
+	if (xodtemplate_add_binary_commands(buffers, temp_contact->host_notification_commands, &record.host_commands_index, &record.host_commands_count) == ERROR
+	        || xodtemplate_add_binary_commands(buffers, temp_contact->service_notification_commands, &record.service_commands_index, &record.service_commands_count) == ERROR
+	        || xodtemplate_add_binary_custom_variables(buffers, temp_contact->custom_variables, &record.custom_variables_index, &record.custom_variables_count) == ERROR)
+		return ERROR;
+
+	record.notify_on_service_unknown = temp_contact->notify_on_service_unknown;
+	record.notify_on_service_warning = temp_contact->notify_on_service_warning;
+	record.notify_on_service_critical = temp_contact->notify_on_service_critical;
+	record.notify_on_service_recovery = temp_contact->notify_on_service_recovery;
+	record.notify_on_service_flapping = temp_contact->notify_on_service_flapping;
+	record.notify_on_service_downtime = temp_contact->notify_on_service_downtime;
+	record.notify_on_host_down = temp_contact->notify_on_host_down;
+	record.notify_on_host_unreachable = temp_contact->notify_on_host_unreachable;
+	record.notify_on_host_recovery = temp_contact->notify_on_host_recovery;
+	record.notify_on_host_flapping = temp_contact->notify_on_host_flapping;
+	record.notify_on_host_downtime = temp_contact->notify_on_host_downtime;
+	record.host_notifications_enabled = temp_contact->host_notifications_enabled;
+	record.service_notifications_enabled = temp_contact->service_notifications_enabled;
+	record.can_submit_commands = temp_contact->can_submit_commands;
+	record.retain_status_information = temp_contact->retain_status_information;
+	record.retain_nonstatus_information = temp_contact->retain_nonstatus_information;
+
+	return xodtemplate_append_binary_data(buffers, XODTEMPLATE_BINARY_CONTACT, &record);
+}
+
+
+/* appends a host, the cache is written right after registering, so the current state is still the initial one */
+static int xodtemplate_add_binary_host(xodtemplate_binary_buffer *buffers, host *temp_host) {
+	xodtemplate_binary_host record;
+	hostsmember *temp_hostsmember = NULL;
+
+	memset(&record, 0, sizeof(record));
+	if (xodtemplate_add_binary_string(buffers, temp_host->name, &record.name) == ERROR
+	        || xodtemplate_add_binary_string(buffers, temp_host->display_name, &record.display_name) == ERROR
+	        || xodtemplate_add_binary_string(buffers, temp_host->alias, &record.alias) == ERROR
+	        || xodtemplate_add_binary_string(buffers, temp_host->address, &record.address) == ERROR
+	        || xodtemplate_add_binary_string(buffers, temp_host->address6, &record.address6) == ERROR
+	        || xodtemplate_add_binary_string(buffers, temp_host->check_period, &record.check_period) == ERROR
+	        || xodtemplate_add_binary_string(buffers, temp_host->notification_period, &record.notification_period) == ERROR
+	        || xodtemplate_add_binary_string(buffers, temp_host->host_check_command, &record.check_command) == ERROR
+	        || xodtemplate_add_binary_string(buffers, temp_host->event_handler, &record.event_handler) == ERROR
+	        || xodtemplate_add_binary_string(buffers, temp_host->failure_prediction_options, &record.failure_prediction_options) == ERROR
+	        || xodtemplate_add_binary_string(buffers, temp_host->notes, &record.notes) == ERROR
+	        || xodtemplate_add_binary_string(buffers, temp_host->notes_url, &record.notes_url) == ERROR
+	        || xodtemplate_add_binary_string(buffers, temp_host->action_url, &record.action_url) == ERROR
+	        || xodtemplate_add_binary_string(buffers, temp_host->icon_image, &record.icon_image) == ERROR
+	        || xodtemplate_add_binary_string(buffers, temp_host->icon_image_alt, &record.icon_image_alt) == ERROR
+	        || xodtemplate_add_binary_string(buffers, temp_host->vrml_image, &record.vrml_image) == ERROR
+	        || xodtemplate_add_binary_string(buffers, temp_host->statusmap_image, &record.statusmap_image) == ERROR)
+		return ERROR;
+
+	record.parents_index = xodtemplate_binary_index(buffers, XODTEMPLATE_BINARY_MEMBER);
+	for (temp_hostsmember = temp_host->parent_hosts; temp_hostsmember != NULL; temp_hostsmember = temp_hostsmember->next) {
+		if (xodtemplate_add_binary_member(buffers, temp_hostsmember->host_name, NULL, &record.parents_count) == ERROR)
+			return ERROR;
+	}
+	if (xodtemplate_add_binary_contactgroups(buffers, temp_host->contact_groups, &record.contact_groups_index, &record.contact_groups_count) == ERROR
+	        || xodtemplate_add_binary_contacts(buffers, temp_host->contacts, &record.contacts_index, &record.contacts_count) == ERROR
+	        || xodtemplate_add_binary_custom_variables(buffers, temp_host->custom_variables, &record.custom_variables_index, &record.custom_variables_count) == ERROR)
+		return ERROR;
+
+	record.check_interval = temp_host->check_interval;
+	record.retry_interval = temp_host->retry_interval;
+	record.notification_interval = temp_host->notification_interval;
+	record.first_notification_delay = temp_host->first_notification_delay;
+	record.low_flap_threshold = temp_host->low_flap_threshold;
+	record.high_flap_threshold = temp_host->high_flap_threshold;
+	record.x_3d = temp_host->x_3d;
+	record.y_3d = temp_host->y_3d;
+	record.z_3d = temp_host->z_3d;
+	record.initial_state = temp_host->current_state;
+	record.max_attempts = temp_host->max_attempts;
+	record.notify_on_recovery = temp_host->notify_on_recovery;
+	record.notify_on_down = temp_host->notify_on_down;
+	record.notify_on_unreachable = temp_host->notify_on_unreachable;
+	record.notify_on_flapping = temp_host->notify_on_flapping;
+	record.notify_on_downtime = temp_host->notify_on_downtime;
+	record.notifications_enabled = temp_host->notifications_enabled;
+	record.checks_enabled = temp_host->checks_enabled;
+	record.accept_passive_host_checks = temp_host->accept_passive_host_checks;
+	record.event_handler_enabled = temp_host->event_handler_enabled;
+	record.flap_detection_enabled = temp_host->flap_detection_enabled;
+	record.flap_detection_on_up = temp_host->flap_detection_on_up;
+	record.flap_detection_on_down = temp_host->flap_detection_on_down;
+	record.flap_detection_on_unreachable = temp_host->flap_detection_on_unreachable;
+	record.stalk_on_up = temp_host->stalk_on_up;
+	record.stalk_on_down = temp_host->stalk_on_down;
+	record.stalk_on_unreachable = temp_host->stalk_on_unreachable;
+	record.process_performance_data = temp_host->process_performance_data;
+	record.failure_prediction_enabled = temp_host->failure_prediction_enabled;
+	record.check_freshness = temp_host->check_freshness;
+	record.freshness_threshold = temp_host->freshness_threshold;
+	record.x_2d = temp_host->x_2d;
+	record.y_2d = temp_host->y_2d;
+	record.have_2d_coords = temp_host->have_2d_coords;
+	record.have_3d_coords = temp_host->have_3d_coords;
+	record.should_be_drawn = temp_host->should_be_drawn;
+	record.retain_status_information = temp_host->retain_status_information;
+	record.retain_nonstatus_information = temp_host->retain_nonstatus_information;
+	record.obsess_over_host = temp_host->obsess_over_host;
+
+	return xodtemplate_append_binary_data(buffers, XODTEMPLATE_BINARY_HOST, &record);
+}
+
+
+/* appends a service, its current state is still the initial one as well */
+static int xodtemplate_add_binary_service(xodtemplate_binary_buffer *buffers, service *temp_service) {
+	xodtemplate_binary_service record;
+
+	memset(&record, 0, sizeof(record));
+	if (xodtemplate_add_binary_string(buffers, temp_service->host_name, &record.host_name) == ERROR
+	        || xodtemplate_add_binary_string(buffers, temp_service->description, &record.description) == ERROR
+	        || xodtemplate_add_binary_string(buffers, temp_service->display_name, &record.display_name) == ERROR
+	        || xodtemplate_add_binary_string(buffers, temp_service->check_period, &record.check_period) == ERROR
+	        || xodtemplate_add_binary_string(buffers, temp_service->notification_period, &record.notification_period) == ERROR
+	        || xodtemplate_add_binary_string(buffers, temp_service->service_check_command, &record.check_command) == ERROR
+	        || xodtemplate_add_binary_string(buffers, temp_service->event_handler, &record.event_handler) == ERROR
+	        || xodtemplate_add_binary_string(buffers, temp_service->failure_prediction_options, &record.failure_prediction_options) == ERROR
+	        || xodtemplate_add_binary_string(buffers, temp_service->notes, &record.notes) == ERROR
+	        || xodtemplate_add_binary_string(buffers, temp_service->notes_url, &record.notes_url) == ERROR
+	        || xodtemplate_add_binary_string(buffers, temp_service->action_url, &record.action_url) == ERROR
+	        || xodtemplate_add_binary_string(buffers, temp_service->icon_image, &record.icon_image) == ERROR
+	        || xodtemplate_add_binary_string(buffers, temp_service->icon_image_alt, &record.icon_image_alt) == ERROR)
+		return ERROR;
+
+	if (xodtemplate_add_binary_contactgroups(buffers, temp_service->contact_groups, &record.contact_groups_index, &record.contact_groups_count) == ERROR
+	        || xodtemplate_add_binary_contacts(buffers, temp_service->contacts, &record.contacts_index, &record.contacts_count) == ERROR
+	        || xodtemplate_add_binary_custom_variables(buffers, temp_service->custom_variables, &record.custom_variables_index, &record.custom_variables_count) == ERROR)
+		return ERROR;
+
+	record.check_interval = temp_service->check_interval;
+	record.retry_interval = temp_service->retry_interval;
+	record.notification_interval = temp_service->notification_interval;
+	record.first_notification_delay = temp_service->first_notification_delay;
+	record.low_flap_threshold = temp_service->low_flap_threshold;
+	record.high_flap_threshold = temp_service->high_flap_threshold;
+	record.initial_state = temp_service->current_state;
+	record.max_attempts = temp_service->max_attempts;
+	record.parallelize = temp_service->parallelize;
+	record.accept_passive_service_checks = temp_service->accept_passive_service_checks;
+	record.notify_on_recovery = temp_service->notify_on_recovery;
+	record.notify_on_unknown = temp_service->notify_on_unknown;
+	record.notify_on_warning = temp_service->notify_on_warning;
+	record.notify_on_critical = temp_service->notify_on_critical;
+	record.notify_on_flapping = temp_service->notify_on_flapping;
+	record.notify_on_downtime = temp_service->notify_on_downtime;
+	record.notifications_enabled = temp_service->notifications_enabled;
+	record.is_volatile = temp_service->is_volatile;
+	record.event_handler_enabled = temp_service->event_handler_enabled;
+	record.checks_enabled = temp_service->checks_enabled;
+	record.flap_detection_enabled = temp_service->flap_detection_enabled;
+	record.flap_detection_on_ok = temp_service->flap_detection_on_ok;
+	record.flap_detection_on_warning = temp_service->flap_detection_on_warning;
+	record.flap_detection_on_unknown = temp_service->flap_detection_on_unknown;
+	record.flap_detection_on_critical = temp_service->flap_detection_on_critical;
+	record.stalk_on_ok = temp_service->stalk_on_ok;
+	record.stalk_on_warning = temp_service->stalk_on_warning;
+	record.stalk_on_unknown = temp_service->stalk_on_unknown;
+	record.stalk_on_critical = temp_service->stalk_on_critical;
+	record.process_performance_data = temp_service->process_performance_data;
+	record.failure_prediction_enabled = temp_service->failure_prediction_enabled;
+	record.check_freshness = temp_service->check_freshness;
+	record.freshness_threshold = temp_service->freshness_threshold;
+	record.retain_status_information = temp_service->retain_status_information;
+	record.retain_nonstatus_information = temp_service->retain_nonstatus_information;
+	record.obsess_over_service = temp_service->obsess_over_service;
+
+	return xodtemplate_append_binary_data(buffers, XODTEMPLATE_BINARY_SERVICE, &record);
+}
+
+
+/* appends all registered objects to the sections of the binary object cache, in the order they were registered */
+static int xodtemplate_add_binary_objects(xodtemplate_binary_buffer *buffers) {
+	xodtemplate_binary_command command_record;
+	xodtemplate_binary_group group_record;
+	xodtemplate_binary_dependency dependency_record;
+	xodtemplate_binary_escalation escalation_record;
+	xodtemplate_binary_module module_record;
+	timeperiod *temp_timeperiod = NULL;
+	command *temp_command = NULL;
+	contactgroup *temp_contactgroup = NULL;
+	hostgroup *temp_hostgroup = NULL;
+	servicegroup *temp_servicegroup = NULL;
+	contact *temp_contact = NULL;
+	host *temp_host = NULL;
+	service *temp_service = NULL;
+	servicedependency *temp_servicedependency = NULL;
+	serviceescalation *temp_serviceescalation = NULL;
+	hostdependency *temp_hostdependency = NULL;
+	hostescalation *temp_hostescalation = NULL;
+	module *temp_module = NULL;
+	hostsmember *temp_hostsmember = NULL;
+	servicesmember *temp_servicesmember = NULL;
+
+	for (temp_timeperiod = timeperiod_list; temp_timeperiod != NULL; temp_timeperiod = temp_timeperiod->next) {
+		if (xodtemplate_add_binary_timeperiod(buffers, temp_timeperiod) == ERROR)
+			return ERROR;
+	}
+
+	for (temp_command = command_list; temp_command != NULL; temp_command = temp_command->next) {
+		if (xodtemplate_add_binary_string(buffers, temp_command->name, &command_record.name) == ERROR
+		        || xodtemplate_add_binary_string(buffers, temp_command->command_line, &command_record.command_line) == ERROR
+		        || xodtemplate_append_binary_data(buffers, XODTEMPLATE_BINARY_COMMAND, &command_record) == ERROR)
+			return ERROR;
+	}
+
+	for (temp_contactgroup = contactgroup_list; temp_contactgroup != NULL; temp_contactgroup = temp_contactgroup->next) {
+		memset(&group_record, 0, sizeof(group_record));
+		if (xodtemplate_add_binary_string(buffers, temp_contactgroup->group_name, &group_record.group_name) == ERROR
+		        || xodtemplate_add_binary_string(buffers, temp_contactgroup->alias, &group_record.alias) == ERROR
+		        || xodtemplate_add_binary_contacts(buffers, temp_contactgroup->members, &group_record.members_index, &group_record.members_count) == ERROR)
+			return ERROR;
+		group_record.notes = XODTEMPLATE_BINARY_NONE;
+		group_record.notes_url = XODTEMPLATE_BINARY_NONE;
+		group_record.action_url = XODTEMPLATE_BINARY_NONE;
+		if (xodtemplate_append_binary_data(buffers, XODTEMPLATE_BINARY_CONTACTGROUP, &group_record) == ERROR)
+			return ERROR;
+	}
+
+	for (temp_hostgroup = hostgroup_list; temp_hostgroup != NULL; temp_hostgroup = temp_hostgroup->next) {
+		memset(&group_record, 0, sizeof(group_record));
+		if (xodtemplate_add_binary_string(buffers, temp_hostgroup->group_name, &group_record.group_name) == ERROR
+		        || xodtemplate_add_binary_string(buffers, temp_hostgroup->alias, &group_record.alias) == ERROR
+		        || xodtemplate_add_binary_string(buffers, temp_hostgroup->notes, &group_record.notes) == ERROR
+		        || xodtemplate_add_binary_string(buffers, temp_hostgroup->notes_url, &group_record.notes_url) == ERROR
+		        || xodtemplate_add_binary_string(buffers, temp_hostgroup->action_url, &group_record.action_url) == ERROR)
+			return ERROR;
+		group_record.members_index = xodtemplate_binary_index(buffers, XODTEMPLATE_BINARY_MEMBER);
+		for (temp_hostsmember = temp_hostgroup->members; temp_hostsmember != NULL; temp_hostsmember = temp_hostsmember->next) {
+			if (xodtemplate_add_binary_member(buffers, temp_hostsmember->host_name, NULL, &group_record.members_count) == ERROR)
+				return ERROR;
+		}
+		if (xodtemplate_append_binary_data(buffers, XODTEMPLATE_BINARY_HOSTGROUP, &group_record) == ERROR)
+			return ERROR;
+	}
+
+	for (temp_servicegroup = servicegroup_list; temp_servicegroup != NULL; temp_servicegroup = temp_servicegroup->next) {
+		memset(&group_record, 0, sizeof(group_record));
+		if (xodtemplate_add_binary_string(buffers, temp_servicegroup->group_name, &group_record.group_name) == ERROR
+		        || xodtemplate_add_binary_string(buffers, temp_servicegroup->alias, &group_record.alias) == ERROR
+		        || xodtemplate_add_binary_string(buffers, temp_servicegroup->notes, &group_record.notes) == ERROR
+		        || xodtemplate_add_binary_string(buffers, temp_servicegroup->notes_url, &group_record.notes_url) == ERROR
+		        || xodtemplate_add_binary_string(buffers, temp_servicegroup->action_url, &group_record.action_url) == ERROR)
+			return ERROR;
+		group_record.members_index = xodtemplate_binary_index(buffers, XODTEMPLATE_BINARY_MEMBER);
+		for (temp_servicesmember = temp_servicegroup->members; temp_servicesmember != NULL; temp_servicesmember = temp_servicesmember->next) {
+			if (xodtemplate_add_binary_member(buffers, temp_servicesmember->host_name, temp_servicesmember->service_description, &group_record.members_count) == ERROR)
+				return ERROR;
+		}
+		if (xodtemplate_append_binary_data(buffers, XODTEMPLATE_BINARY_SERVICEGROUP, &group_record) == ERROR)
+			return ERROR;
+	}
+
+	for (temp_contact = contact_list; temp_contact != NULL; temp_contact = temp_contact->next) {
+		if (xodtemplate_add_binary_contact(buffers, temp_contact) == ERROR)
+			return ERROR;
+	}
+
+	for (temp_host = host_list; temp_host != NULL; temp_host = temp_host->next) {
+		if (xodtemplate_add_binary_host(buffers, temp_host) == ERROR)
+			return ERROR;
+	}
+
+	for (temp_service = service_list; temp_service != NULL; temp_service = temp_service->next) {
+		if (xodtemplate_add_binary_service(buffers, temp_service) == ERROR)
+			return ERROR;
+	}
+
+	for (temp_servicedependency = servicedependency_list; temp_servicedependency != NULL; temp_servicedependency = temp_servicedependency->next) {
+		memset(&dependency_record, 0, sizeof(dependency_record));
+		if (xodtemplate_add_binary_string(buffers, temp_servicedependency->dependent_host_name, &dependency_record.dependent_host_name) == ERROR
+		        || xodtemplate_add_binary_string(buffers, temp_servicedependency->dependent_service_description, &dependency_record.dependent_service_description) == ERROR
+		        || xodtemplate_add_binary_string(buffers, temp_servicedependency->host_name, &dependency_record.host_name) == ERROR
+		        || xodtemplate_add_binary_string(buffers, temp_servicedependency->service_description, &dependency_record.service_description) == ERROR
+		        || xodtemplate_add_binary_string(buffers, temp_servicedependency->dependency_period, &dependency_record.dependency_period) == ERROR)
+			return ERROR;
+		dependency_record.dependency_type = temp_servicedependency->dependency_type;
+		dependency_record.inherits_parent = temp_servicedependency->inherits_parent;
+		dependency_record.fail_on_ok = temp_servicedependency->fail_on_ok;
+		dependency_record.fail_on_warning = temp_servicedependency->fail_on_warning;
+		dependency_record.fail_on_unknown = temp_servicedependency->fail_on_unknown;
+		dependency_record.fail_on_critical = temp_servicedependency->fail_on_critical;
+		dependency_record.fail_on_pending = temp_servicedependency->fail_on_pending;
+		if (xodtemplate_append_binary_data(buffers, XODTEMPLATE_BINARY_SERVICEDEPENDENCY, &dependency_record) == ERROR)
+			return ERROR;
+	}
+
+	for (temp_serviceescalation = serviceescalation_list; temp_serviceescalation != NULL; temp_serviceescalation = temp_serviceescalation->next) {
+		memset(&escalation_record, 0, sizeof(escalation_record));
+		if (xodtemplate_add_binary_string(buffers, temp_serviceescalation->host_name, &escalation_record.host_name) == ERROR
+		        || xodtemplate_add_binary_string(buffers, temp_serviceescalation->description, &escalation_record.description) == ERROR
+		        || xodtemplate_add_binary_string(buffers, temp_serviceescalation->escalation_period, &escalation_record.escalation_period) == ERROR
+		        || xodtemplate_add_binary_contactgroups(buffers, temp_serviceescalation->contact_groups, &escalation_record.contact_groups_index, &escalation_record.contact_groups_count) == ERROR
+		        || xodtemplate_add_binary_contacts(buffers, temp_serviceescalation->contacts, &escalation_record.contacts_index, &escalation_record.contacts_count) == ERROR
+		        || xodtemplate_add_binary_conditions(buffers, temp_serviceescalation->condition, &escalation_record.conditions_index, &escalation_record.conditions_count) == ERROR)
+			return ERROR;
+		escalation_record.notification_interval = temp_serviceescalation->notification_interval;
+		escalation_record.first_notification = temp_serviceescalation->first_notification;
+		escalation_record.last_notification = temp_serviceescalation->last_notification;
+		escalation_record.first_warning_notification = temp_serviceescalation->first_warning_notification;
+		escalation_record.last_warning_notification = temp_serviceescalation->last_warning_notification;
+		escalation_record.first_critical_notification = temp_serviceescalation->first_critical_notification;
+		escalation_record.last_critical_notification = temp_serviceescalation->last_critical_notification;
+		escalation_record.first_unknown_notification = temp_serviceescalation->first_unknown_notification;
+		escalation_record.last_unknown_notification = temp_serviceescalation->last_unknown_notification;
+		escalation_record.escalate_on_recovery = temp_serviceescalation->escalate_on_recovery;
+		escalation_record.escalate_on_warning = temp_serviceescalation->escalate_on_warning;
+		escalation_record.escalate_on_unknown = temp_serviceescalation->escalate_on_unknown;
+		escalation_record.escalate_on_critical = temp_serviceescalation->escalate_on_critical;
+		if (xodtemplate_append_binary_data(buffers, XODTEMPLATE_BINARY_SERVICEESCALATION, &escalation_record) == ERROR)
+			return ERROR;
+	}
+
+	for (temp_hostdependency = hostdependency_list; temp_hostdependency != NULL; temp_hostdependency = temp_hostdependency->next) {
+		memset(&dependency_record, 0, sizeof(dependency_record));
+		if (xodtemplate_add_binary_string(buffers, temp_hostdependency->dependent_host_name, &dependency_record.dependent_host_name) == ERROR
+		        || xodtemplate_add_binary_string(buffers, temp_hostdependency->host_name, &dependency_record.host_name) == ERROR
+		        || xodtemplate_add_binary_string(buffers, temp_hostdependency->dependency_period, &dependency_record.dependency_period) == ERROR)
+			return ERROR;
+		dependency_record.dependent_service_description = XODTEMPLATE_BINARY_NONE;
+		dependency_record.service_description = XODTEMPLATE_BINARY_NONE;
+		dependency_record.dependency_type = temp_hostdependency->dependency_type;
+		dependency_record.inherits_parent = temp_hostdependency->inherits_parent;
+		dependency_record.fail_on_ok = temp_hostdependency->fail_on_up;
+		dependency_record.fail_on_warning = temp_hostdependency->fail_on_down;
+		dependency_record.fail_on_unknown = temp_hostdependency->fail_on_unreachable;
+		dependency_record.fail_on_pending = temp_hostdependency->fail_on_pending;
+		if (xodtemplate_append_binary_data(buffers, XODTEMPLATE_BINARY_HOSTDEPENDENCY, &dependency_record) == ERROR)
+			return ERROR;
+	}
+
+	for (temp_hostescalation = hostescalation_list; temp_hostescalation != NULL; temp_hostescalation = temp_hostescalation->next) {
+		memset(&escalation_record, 0, sizeof(escalation_record));
+		if (xodtemplate_add_binary_string(buffers, temp_hostescalation->host_name, &escalation_record.host_name) == ERROR
+		        || xodtemplate_add_binary_string(buffers, temp_hostescalation->escalation_period, &escalation_record.escalation_period) == ERROR
+		        || xodtemplate_add_binary_contactgroups(buffers, temp_hostescalation->contact_groups, &escalation_record.contact_groups_index, &escalation_record.contact_groups_count) == ERROR
+		        || xodtemplate_add_binary_contacts(buffers, temp_hostescalation->contacts, &escalation_record.contacts_index, &escalation_record.contacts_count) == ERROR
+		        || xodtemplate_add_binary_conditions(buffers, temp_hostescalation->condition, &escalation_record.conditions_index, &escalation_record.conditions_count) == ERROR)
+			return ERROR;
+		escalation_record.description = XODTEMPLATE_BINARY_NONE;
+		escalation_record.notification_interval = temp_hostescalation->notification_interval;
+		escalation_record.first_notification = temp_hostescalation->first_notification;
+		escalation_record.last_notification = temp_hostescalation->last_notification;
+		escalation_record.first_warning_notification = temp_hostescalation->first_down_notification;
+		escalation_record.last_warning_notification = temp_hostescalation->last_down_notification;
+		escalation_record.first_critical_notification = temp_hostescalation->first_unreachable_notification;
+		escalation_record.last_critical_notification = temp_hostescalation->last_unreachable_notification;
+		escalation_record.escalate_on_recovery = temp_hostescalation->escalate_on_recovery;
+		escalation_record.escalate_on_warning = temp_hostescalation->escalate_on_down;
+		escalation_record.escalate_on_unknown = temp_hostescalation->escalate_on_unreachable;
+		if (xodtemplate_append_binary_data(buffers, XODTEMPLATE_BINARY_HOSTESCALATION, &escalation_record) == ERROR)
+			return ERROR;
+	}
+
+	for (temp_module = module_list; temp_module != NULL; temp_module = temp_module->next) {
+		if (xodtemplate_add_binary_string(buffers, temp_module->name, &module_record.name) == ERROR
+		        || xodtemplate_add_binary_string(buffers, temp_module->type, &module_record.type) == ERROR
+		        || xodtemplate_add_binary_string(buffers, temp_module->path, &module_record.path) == ERROR
+		        || xodtemplate_add_binary_string(buffers, temp_module->args, &module_record.args) == ERROR
+		        || xodtemplate_append_binary_data(buffers, XODTEMPLATE_BINARY_MODULE, &module_record) == ERROR)
+			return ERROR;
+	}
+
+	return OK;
+}
+
+
+/* writes the registered objects to the binary object cache next to the text precache file */
+int xodtemplate_cache_binary_objects(char *precache_file) {
+	xodtemplate_binary_header header;
+	xodtemplate_binary_buffer buffers[XODTEMPLATE_BINARY_SECTIONS];
+	char *binary_file = NULL;
+	char *temp_file = NULL;
+	struct stat statbuf;
+	time_t current_time;
+	int result = OK;
+	int fd = 0;
+	int x = 0;
+	FILE *fp = NULL;
+
+	/* skip if set to /dev/null */
+	if (!precache_file || !strcmp(precache_file, "/dev/null"))
+		return OK;
+
+	/* the binary file is only used together with the text precache file written just before */
+	if (stat(precache_file, &statbuf) == -1)
+		return ERROR;
+
+	if (asprintf(&binary_file, "%s%s", precache_file, XODTEMPLATE_BINARY_SUFFIX) == -1)
+		return ERROR;
+
+	memset(&header, 0, sizeof(header));
+	strncpy(header.magic, XODTEMPLATE_BINARY_MAGIC, sizeof(header.magic));
+	header.version = XODTEMPLATE_BINARY_VERSION;
+	header.header_size = sizeof(xodtemplate_binary_header);
+	time(&current_time);
+	header.created = (unsigned long)current_time;
+	header.precache_size = (unsigned long)statbuf.st_size;
+	header.precache_mtime = (unsigned long)statbuf.st_mtime;
+
+	memset(buffers, 0, sizeof(buffers));
+	result = xodtemplate_add_binary_objects(buffers);
+
+	/* the sections follow the header in the order of their numbers, the string table is the last one */
+	header.size = sizeof(xodtemplate_binary_header);
+	for (x = 0; x < XODTEMPLATE_BINARY_SECTIONS; x++) {
+		header.sections[x].offset = header.size;
+		header.sections[x].count = xodtemplate_binary_index(buffers, x);
+		header.sections[x].record_size = xodtemplate_binary_record_sizes[x];
+		header.size += buffers[x].size;
+	}
+
+	/* open a safe temp file for output */
+	if (result == OK) {
+		if (asprintf(&temp_file, "%sXXXXXX", binary_file) == -1)
+			temp_file = NULL;
+		if (temp_file != NULL && (fd = mkstemp(temp_file)) != -1) {
+			if ((fp = (FILE *)fdopen(fd, "w")) == NULL) {
+				close(fd);
+				unlink(temp_file);
+			}
+		}
+		if (fp == NULL)
+			result = ERROR;
+	}
+
+	if (result == OK) {
+		fwrite(&header, sizeof(header), 1, fp);
+		for (x = 0; x < XODTEMPLATE_BINARY_SECTIONS; x++) {
+			if (buffers[x].size > 0L)
+				fwrite(buffers[x].data, buffers[x].size, 1, fp);
+		}
+
+		if (fclose(fp) != 0) {
+			unlink(temp_file);
+			result = ERROR;
+		} else if (my_rename(temp_file, binary_file)) {
+			unlink(temp_file);
+			result = ERROR;
+		}
+	}
+
+	if (result == ERROR)
+		logit(NSLOG_CONFIG_WARNING, TRUE, "Warning: Could not write binary object cache file '%s'!\n", binary_file);
+
+	for (x = 0; x < XODTEMPLATE_BINARY_SECTIONS; x++)
+		my_free(buffers[x].data);
+	my_free(temp_file);
+	my_free(binary_file);
+
+	return result;
+}
+
+
+
+
+/* maps the binary object cache of a text precache file, returns NULL if it is missing, outdated or invalid */
+char *xodtemplate_open_binary_objects(char *precache_file, unsigned long *size) {
+	xodtemplate_binary_header *header = NULL;
+	char *binary_file = NULL;
+	char *buf = NULL;
+	unsigned long offset = 0L;
+	struct stat statbuf;
+	time_t precache_mtime;
+	off_t precache_size;
+	int result = OK;
+	int fd = -1;
+	int x = 0;
+
+	if (!precache_file || stat(precache_file, &statbuf) == -1)
+		return NULL;
+	precache_size = statbuf.st_size;
+	precache_mtime = statbuf.st_mtime;
+
+	if (asprintf(&binary_file, "%s%s", precache_file, XODTEMPLATE_BINARY_SUFFIX) == -1)
+		return NULL;
+	if ((fd = open(binary_file, O_RDONLY)) == -1) {
+		my_free(binary_file);
+		return NULL;
+	}
+	if (fstat(fd, &statbuf) == -1 || statbuf.st_size < (off_t)sizeof(xodtemplate_binary_header)) {
+		close(fd);
+		my_free(binary_file);
+		return NULL;
+	}
+	*size = (unsigned long)statbuf.st_size;
+
+	/* the records are handed to the add_* functions, some of which modify their arguments */
+	buf = mmap(0, *size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (buf == MAP_FAILED) {
+		my_free(binary_file);
+		return NULL;
+	}
+
+	/* the file must have been written by this version with the same record layout, along with the current text precache file */
+	header = (xodtemplate_binary_header *)buf;
+	if (strncmp(header->magic, XODTEMPLATE_BINARY_MAGIC, sizeof(header->magic)) || header->version != XODTEMPLATE_BINARY_VERSION
+	        || header->header_size != sizeof(xodtemplate_binary_header) || header->size != *size
+	        || header->precache_size != (unsigned long)precache_size || header->precache_mtime != (unsigned long)precache_mtime)
+		result = ERROR;
+
+	for (x = 0, offset = sizeof(xodtemplate_binary_header); x < XODTEMPLATE_BINARY_SECTIONS && result == OK; x++) {
+		if (header->sections[x].record_size != xodtemplate_binary_record_sizes[x] || header->sections[x].offset != offset
+		        || header->sections[x].count > (*size - offset) / xodtemplate_binary_record_sizes[x])
+			result = ERROR;
+		else
+			offset += header->sections[x].count * xodtemplate_binary_record_sizes[x];
+	}
+
+	/* the string table ends the file, so all strings are terminated */
+	if (result == OK && (offset != *size || (header->sections[XODTEMPLATE_BINARY_STRING].count > 0L && buf[*size - 1] != '\x0')))
+		result = ERROR;
+
+	if (result == ERROR) {
+		logit(NSLOG_CONFIG_WARNING, TRUE, "Warning: Binary object cache file '%s' is outdated or invalid, reading '%s' instead.\n", binary_file, precache_file);
+		munmap(buf, *size);
+		buf = NULL;
+	}
+
+	my_free(binary_file);
+
+	return buf;
+}
+
+
+/* returns a string of the binary object cache, NULL if there is none */
+static char *xodtemplate_binary_string(char *buf, unsigned long offset) {
+	xodtemplate_binary_header *header = (xodtemplate_binary_header *)buf;
+
+	if (offset >= header->sections[XODTEMPLATE_BINARY_STRING].count)
+		return NULL;
+
+	return buf + header->sections[XODTEMPLATE_BINARY_STRING].offset + offset;
+}
+
+
+/* returns the first record of a list in a section of the binary object cache, NULL if the list is out of range */
+static void *xodtemplate_binary_records(char *buf, int section, unsigned long index, unsigned long count) {
+	xodtemplate_binary_header *header = (xodtemplate_binary_header *)buf;
+
+	if (index > header->sections[section].count || count > header->sections[section].count - index)
+		return NULL;
+
+	return buf + header->sections[section].offset + index * header->sections[section].record_size;
+}
+
+
+/*
+ * the members of a list were written in list order, they are added in reverse order below.
+ * lists which are built at their head end up in the original order again and members of the
+ * sorted host and service group lists are always inserted at the head.
+ */
+
+/* adds a timeperiod from the binary object cache */
+static int xodtemplate_register_binary_timeperiod(char *buf, xodtemplate_binary_timeperiod *record) {
+	xodtemplate_binary_timerange *timeranges = NULL;
+	xodtemplate_binary_daterange *dateranges = NULL;
+	xodtemplate_binary_daterange *temp_daterange = NULL;
+	xodtemplate_binary_member *members = NULL;
+	timeperiod *new_timeperiod = NULL;
+	daterange *new_daterange = NULL;
+	unsigned long x = 0L;
+	unsigned long y = 0L;
+	int day = 0;
+
+	if ((new_timeperiod = add_timeperiod(xodtemplate_binary_string(buf, record->name), xodtemplate_binary_string(buf, record->alias))) == NULL)
+		return ERROR;
+
+	for (day = 0; day < 7; day++) {
+		if ((timeranges = xodtemplate_binary_records(buf, XODTEMPLATE_BINARY_TIMERANGE, record->days_index[day], record->days_count[day])) == NULL)
+			return ERROR;
+		for (x = record->days_count[day]; x > 0L; x--) {
+			if (add_timerange_to_timeperiod(new_timeperiod, day, timeranges[x - 1].range_start, timeranges[x - 1].range_end) == NULL)
+				return ERROR;
+		}
+	}
+
+	if ((dateranges = xodtemplate_binary_records(buf, XODTEMPLATE_BINARY_DATERANGE, record->exceptions_index, record->exceptions_count)) == NULL)
+		return ERROR;
+	for (x = record->exceptions_count; x > 0L; x--) {
+		temp_daterange = &dateranges[x - 1];
+		if (temp_daterange->type < 0 || temp_daterange->type >= DATERANGE_TYPES)
+			return ERROR;
+		if ((new_daterange = add_exception_to_timeperiod(new_timeperiod, temp_daterange->type, temp_daterange->syear, temp_daterange->smon, temp_daterange->smday, temp_daterange->swday, temp_daterange->swday_offset, temp_daterange->eyear, temp_daterange->emon, temp_daterange->emday, temp_daterange->ewday, temp_daterange->ewday_offset, temp_daterange->skip_interval)) == NULL)
+			return ERROR;
+		if ((timeranges = xodtemplate_binary_records(buf, XODTEMPLATE_BINARY_TIMERANGE, temp_daterange->times_index, temp_daterange->times_count)) == NULL)
+			return ERROR;
+		for (y = temp_daterange->times_count; y > 0L; y--) {
+			if (add_timerange_to_daterange(new_daterange, timeranges[y - 1].range_start, timeranges[y - 1].range_end) == NULL)
+				return ERROR;
+		}
+	}
+
+	if ((members = xodtemplate_binary_records(buf, XODTEMPLATE_BINARY_MEMBER, record->exclusions_index, record->exclusions_count)) == NULL)
+		return ERROR;
+	for (x = record->exclusions_count; x > 0L; x--) {
+		if (add_exclusion_to_timeperiod(new_timeperiod, xodtemplate_binary_string(buf, members[x - 1].name)) == NULL)
+			return ERROR;
+	}
+
+	return OK;
+}
+
+
+/* adds a contact group from the binary object cache */
+static int xodtemplate_register_binary_contactgroup(char *buf, xodtemplate_binary_group *record) {
+	xodtemplate_binary_member *members = NULL;
+	contactgroup *new_contactgroup = NULL;
+	unsigned long x = 0L;
+
+	if ((new_contactgroup = add_contactgroup(xodtemplate_binary_string(buf, record->group_name), xodtemplate_binary_string(buf, record->alias))) == NULL)
+		return ERROR;
+
+	if ((members = xodtemplate_binary_records(buf, XODTEMPLATE_BINARY_MEMBER, record->members_index, record->members_count)) == NULL)
+		return ERROR;
+	for (x = record->members_count; x > 0L; x--) {
+		if (add_contact_to_contactgroup(new_contactgroup, xodtemplate_binary_string(buf, members[x - 1].name)) == NULL)
+			return ERROR;
+	}
+
+	return OK;
+}
+
+
+/* adds a host group from the binary object cache */
+static int xodtemplate_register_binary_hostgroup(char *buf, xodtemplate_binary_group *record) {
+	xodtemplate_binary_member *members = NULL;
+	hostgroup *new_hostgroup = NULL;
+	unsigned long x = 0L;
+
+	if ((new_hostgroup = add_hostgroup(xodtemplate_binary_string(buf, record->group_name), xodtemplate_binary_string(buf, record->alias), xodtemplate_binary_string(buf, record->notes), xodtemplate_binary_string(buf, record->notes_url), xodtemplate_binary_string(buf, record->action_url))) == NULL)
+		return ERROR;
+
+	if ((members = xodtemplate_binary_records(buf, XODTEMPLATE_BINARY_MEMBER, record->members_index, record->members_count)) == NULL)
+		return ERROR;
+	for (x = record->members_count; x > 0L; x--) {
+		if (add_host_to_hostgroup(new_hostgroup, xodtemplate_binary_string(buf, members[x - 1].name)) == NULL)
+			return ERROR;
+	}
+
+	return OK;
+}
+
+
+/* adds a service group from the binary object cache */
+static int xodtemplate_register_binary_servicegroup(char *buf, xodtemplate_binary_group *record) {
+	xodtemplate_binary_member *members = NULL;
+	servicegroup *new_servicegroup = NULL;
+	unsigned long x = 0L;
+
+	if ((new_servicegroup = add_servicegroup(xodtemplate_binary_string(buf, record->group_name), xodtemplate_binary_string(buf, record->alias), xodtemplate_binary_string(buf, record->notes), xodtemplate_binary_string(buf, record->notes_url), xodtemplate_binary_string(buf, record->action_url))) == NULL)
+		return ERROR;
+
+	if ((members = xodtemplate_binary_records(buf, XODTEMPLATE_BINARY_MEMBER, record->members_index, record->members_count)) == NULL)
+		return ERROR;
+	for (x = record->members_count; x > 0L; x--) {
+		if (add_service_to_servicegroup(new_servicegroup, xodtemplate_binary_string(buf, members[x - 1].name), xodtemplate_binary_string(buf, members[x - 1].value)) == NULL)
+			return ERROR;
+	}
+
+	return OK;
+}
+
+
+/* adds a contact from the binary object cache */
+static int xodtemplate_register_binary_contact(char *buf, xodtemplate_binary_contact *record) {
+	xodtemplate_binary_member *members = NULL;
+	contact *new_contact = NULL;
+	char *addresses[MAX_CONTACT_ADDRESSES];
+	unsigned long x = 0L;
+
+	for (x = 0L; x < MAX_CONTACT_ADDRESSES; x++)
+		addresses[x] = xodtemplate_binary_string(buf, record->address[x]);
+
+	if ((new_contact = add_contact(xodtemplate_binary_string(buf, record->name), xodtemplate_binary_string(buf, record->alias), xodtemplate_binary_string(buf, record->email), xodtemplate_binary_string(buf, record->pager), addresses, xodtemplate_binary_string(buf, record->service_notification_period), xodtemplate_binary_string(buf, record->host_notification_period), record->notify_on_service_recovery, record->notify_on_service_critical, record->notify_on_service_warning, record->notify_on_service_unknown, record->notify_on_service_flapping, record->notify_on_service_downtime, record->notify_on_host_recovery, record->notify_on_host_down, record->notify_on_host_unreachable, record->notify_on_host_flapping, record->notify_on_host_downtime, record->host_notifications_enabled, record->service_notifications_enabled, record->can_submit_commands, record->retain_status_information, record->retain_nonstatus_information)) == NULL)
+		return ERROR;
+
+	if ((members = xodtemplate_binary_records(buf, XODTEMPLATE_BINARY_MEMBER, record->host_commands_index, record->host_commands_count)) == NULL)
+		return ERROR;
+	for (x = record->host_commands_count; x > 0L; x--) {
+		if (add_host_notification_command_to_contact(new_contact, xodtemplate_binary_string(buf, members[x - 1].name)) == NULL)
+			return ERROR;
+	}
+
+	if ((members = xodtemplate_binary_records(buf, XODTEMPLATE_BINARY_MEMBER, record->service_commands_index, record->service_commands_count)) == NULL)
+		return ERROR;
+	for (x = record->service_commands_count; x > 0L; x--) {
+		if (add_service_notification_command_to_contact(new_contact, xodtemplate_binary_string(buf, members[x - 1].name)) == NULL)
+			return ERROR;
+	}
+
+	if ((members = xodtemplate_binary_records(buf, XODTEMPLATE_BINARY_MEMBER, record->custom_variables_index, record->custom_variables_count)) == NULL)
+		return ERROR;
+	for (x = record->custom_variables_count; x > 0L; x--) {
+		if (add_custom_variable_to_contact(new_contact, xodtemplate_binary_string(buf, members[x - 1].name), xodtemplate_binary_string(buf, members[x - 1].value)) == NULL)
+			return ERROR;
+	}
+
+	return OK;
+}
+
+
+/* adds a host from the binary object cache */
+static int xodtemplate_register_binary_host(char *buf, xodtemplate_binary_host *record) {
+	xodtemplate_binary_member *members = NULL;
+	host *new_host = NULL;
+	unsigned long x = 0L;
+
+	if ((new_host = add_host(xodtemplate_binary_string(buf, record->name), xodtemplate_binary_string(buf, record->display_name), xodtemplate_binary_string(buf, record->alias), xodtemplate_binary_string(buf, record->address), xodtemplate_binary_string(buf, record->address6), xodtemplate_binary_string(buf, record->check_period), record->initial_state, record->check_interval, record->retry_interval, record->max_attempts, record->notify_on_recovery, record->notify_on_down, record->notify_on_unreachable, record->notify_on_flapping, record->notify_on_downtime, record->notification_interval, record->first_notification_delay, xodtemplate_binary_string(buf, record->notification_period), record->notifications_enabled, xodtemplate_binary_string(buf, record->check_command), record->checks_enabled, record->accept_passive_host_checks, xodtemplate_binary_string(buf, record->event_handler), record->event_handler_enabled, record->flap_detection_enabled, record->low_flap_threshold, record->high_flap_threshold, record->flap_detection_on_up, record->flap_detection_on_down, record->flap_detection_on_unreachable, record->stalk_on_up, record->stalk_on_down, record->stalk_on_unreachable, record->process_performance_data, record->failure_prediction_enabled, xodtemplate_binary_string(buf, record->failure_prediction_options), record->check_freshness, record->freshness_threshold, xodtemplate_binary_string(buf, record->notes), xodtemplate_binary_string(buf, record->notes_url), xodtemplate_binary_string(buf, record->action_url), xodtemplate_binary_string(buf, record->icon_image), xodtemplate_binary_string(buf, record->icon_image_alt), xodtemplate_binary_string(buf, record->vrml_image), xodtemplate_binary_string(buf, record->statusmap_image), record->x_2d, record->y_2d, record->have_2d_coords, record->x_3d, record->y_3d, record->z_3d, record->have_3d_coords, record->should_be_drawn, record->retain_status_information, record->retain_nonstatus_information, record->obsess_over_host)) == NULL)
+		return ERROR;
+
+	if ((members = xodtemplate_binary_records(buf, XODTEMPLATE_BINARY_MEMBER, record->parents_index, record->parents_count)) == NULL)
+		return ERROR;
+	for (x = record->parents_count; x > 0L; x--) {
+		if (add_parent_host_to_host(new_host, xodtemplate_binary_string(buf, members[x - 1].name)) == NULL)
+			return ERROR;
+	}
+
+	if ((members = xodtemplate_binary_records(buf, XODTEMPLATE_BINARY_MEMBER, record->contact_groups_index, record->contact_groups_count)) == NULL)
+		return ERROR;
+	for (x = record->contact_groups_count; x > 0L; x--) {
+		if (add_contactgroup_to_host(new_host, xodtemplate_binary_string(buf, members[x - 1].name)) == NULL)
+			return ERROR;
+	}
+
+	if ((members = xodtemplate_binary_records(buf, XODTEMPLATE_BINARY_MEMBER, record->contacts_index, record->contacts_count)) == NULL)
+		return ERROR;
+	for (x = record->contacts_count; x > 0L; x--) {
+		if (add_contact_to_host(new_host, xodtemplate_binary_string(buf, members[x - 1].name)) == NULL)
+			return ERROR;
+	}
+
+	if ((members = xodtemplate_binary_records(buf, XODTEMPLATE_BINARY_MEMBER, record->custom_variables_index, record->custom_variables_count)) == NULL)
+		return ERROR;
+	for (x = record->custom_variables_count; x > 0L; x--) {
+		if (add_custom_variable_to_host(new_host, xodtemplate_binary_string(buf, members[x - 1].name), xodtemplate_binary_string(buf, members[x - 1].value)) == NULL)
+			return ERROR;
+	}
+
+	return OK;
+}
+
+
+/* adds a service from the binary object cache */
+static int xodtemplate_register_binary_service(char *buf, xodtemplate_binary_service *record) {
+	xodtemplate_binary_member *members = NULL;
+	service *new_service = NULL;
+	unsigned long x = 0L;
+
+	if ((new_service = add_service(xodtemplate_binary_string(buf, record->host_name), xodtemplate_binary_string(buf, record->description), xodtemplate_binary_string(buf, record->display_name), xodtemplate_binary_string(buf, record->check_period), record->initial_state, record->max_attempts, record->parallelize, record->accept_passive_service_checks, record->check_interval, record->retry_interval, record->notification_interval, record->first_notification_delay, xodtemplate_binary_string(buf, record->notification_period), record->notify_on_recovery, record->notify_on_unknown, record->notify_on_warning, record->notify_on_critical, record->notify_on_flapping, record->notify_on_downtime, record->notifications_enabled, record->is_volatile, xodtemplate_binary_string(buf, record->event_handler), record->event_handler_enabled, xodtemplate_binary_string(buf, record->check_command), record->checks_enabled, record->flap_detection_enabled, record->low_flap_threshold, record->high_flap_threshold, record->flap_detection_on_ok, record->flap_detection_on_warning, record->flap_detection_on_unknown, record->flap_detection_on_critical, record->stalk_on_ok, record->stalk_on_warning, record->stalk_on_unknown, record->stalk_on_critical, record->process_performance_data, record->failure_prediction_enabled, xodtemplate_binary_string(buf, record->failure_prediction_options), record->check_freshness, record->freshness_threshold, xodtemplate_binary_string(buf, record->notes), xodtemplate_binary_string(buf, record->notes_url), xodtemplate_binary_string(buf, record->action_url), xodtemplate_binary_string(buf, record->icon_image), xodtemplate_binary_string(buf, record->icon_image_alt), record->retain_status_information, record->retain_nonstatus_information, record->obsess_over_service)) == NULL)
+		return ERROR;
+
+	if ((members = xodtemplate_binary_records(buf, XODTEMPLATE_BINARY_MEMBER, record->contact_groups_index, record->contact_groups_count)) == NULL)
+		return ERROR;
+	for (x = record->contact_groups_count; x > 0L; x--) {
+		if (add_contactgroup_to_service(new_service, xodtemplate_binary_string(buf, members[x - 1].name)) == NULL)
+			return ERROR;
+	}
+
+	if ((members = xodtemplate_binary_records(buf, XODTEMPLATE_BINARY_MEMBER, record->contacts_index, record->contacts_count)) == NULL)
+		return ERROR;
+	for (x = record->contacts_count; x > 0L; x--) {
+		if (add_contact_to_service(new_service, xodtemplate_binary_string(buf, members[x - 1].name)) == NULL)
+			return ERROR;
+	}
+
+	if ((members = xodtemplate_binary_records(buf, XODTEMPLATE_BINARY_MEMBER, record->custom_variables_index, record->custom_variables_count)) == NULL)
+		return ERROR;
+	for (x = record->custom_variables_count; x > 0L; x--) {
+		if (add_custom_variable_to_service(new_service, xodtemplate_binary_string(buf, members[x - 1].name), xodtemplate_binary_string(buf, members[x - 1].value)) == NULL)
+			return ERROR;
+	}
+
+	return OK;
+}
+
+
+/* adds a service escalation from the binary object cache */
+static int xodtemplate_register_binary_serviceescalation(char *buf, xodtemplate_binary_escalation *record) {
+	xodtemplate_binary_member *members = NULL;
+	xodtemplate_binary_condition *conditions = NULL;
+	serviceescalation *new_serviceescalation = NULL;
+	escalation_condition *last_condition = NULL;
+	unsigned long x = 0L;
+
+	if ((new_serviceescalation = add_serviceescalation(xodtemplate_binary_string(buf, record->host_name), xodtemplate_binary_string(buf, record->description), record->first_notification, record->last_notification, record->first_warning_notification, record->last_warning_notification, record->first_critical_notification, record->last_critical_notification, record->first_unknown_notification, record->last_unknown_notification, record->notification_interval, xodtemplate_binary_string(buf, record->escalation_period), record->escalate_on_warning, record->escalate_on_unknown, record->escalate_on_critical, record->escalate_on_recovery)) == NULL)
+		return ERROR;
 
-		fprintf(fp, "\t}\n\n");
+	if ((members = xodtemplate_binary_records(buf, XODTEMPLATE_BINARY_MEMBER, record->contact_groups_index, record->contact_groups_count)) == NULL)
+		return ERROR;
+	for (x = record->contact_groups_count; x > 0L; x--) {
+		if (add_contactgroup_to_serviceescalation(new_serviceescalation, xodtemplate_binary_string(buf, members[x - 1].name)) == NULL)
+			return ERROR;
 	}
 
-	/* cache service dependencies */
-	/*for(temp_servicedependency=xodtemplate_servicedependency_list;temp_servicedependency!=NULL;temp_servicedependency=temp_servicedependency->next){*/
-	ptr = NULL;
-	for (temp_servicedependency = (xodtemplate_servicedependency *)skiplist_get_first(xobject_skiplists[X_SERVICEDEPENDENCY_SKIPLIST], &ptr); temp_servicedependency != NULL; temp_servicedependency = (xodtemplate_servicedependency *)skiplist_get_next(&ptr)) {
-		if (temp_servicedependency->register_object == FALSE)
-			continue;
-		fprintf(fp, "define servicedependency {\n");
-		if (temp_servicedependency->host_name)
-			fprintf(fp, "\thost_name\t%s\n", temp_servicedependency->host_name);
-		if (temp_servicedependency->service_description)
-			fprintf(fp, "\tservice_description\t%s\n", temp_servicedependency->service_description);
-		if (temp_servicedependency->dependent_host_name)
-			fprintf(fp, "\tdependent_host_name\t%s\n", temp_servicedependency->dependent_host_name);
-		if (temp_servicedependency->dependent_service_description)
-			fprintf(fp, "\tdependent_service_description\t%s\n", temp_servicedependency->dependent_service_description);
-		if (temp_servicedependency->dependency_period)
-			fprintf(fp, "\tdependency_period\t%s\n", temp_servicedependency->dependency_period);
-		fprintf(fp, "\tinherits_parent\t%d\n", temp_servicedependency->inherits_parent);
-		if (temp_servicedependency->have_notification_dependency_options == TRUE) {
-			fprintf(fp, "\tnotification_failure_options\t");
-			x = 0;
-			if (temp_servicedependency->fail_notify_on_ok == TRUE)
-				fprintf(fp, "%so", (x++ > 0) ? "," : "");
-			if (temp_servicedependency->fail_notify_on_unknown == TRUE)
-				fprintf(fp, "%su", (x++ > 0) ? "," : "");
-			if (temp_servicedependency->fail_notify_on_warning == TRUE)
-				fprintf(fp, "%sw", (x++ > 0) ? "," : "");
-			if (temp_servicedependency->fail_notify_on_critical == TRUE)
-				fprintf(fp, "%sc", (x++ > 0) ? "," : "");
-			if (temp_servicedependency->fail_notify_on_pending == TRUE)
-				fprintf(fp, "%sp", (x++ > 0) ? "," : "");
-			if (x == 0)
-				fprintf(fp, "n");
-			fprintf(fp, "\n");
-		}
-		if (temp_servicedependency->have_execution_dependency_options == TRUE) {
-			fprintf(fp, "\texecution_failure_options\t");
-			x = 0;
-			if (temp_servicedependency->fail_execute_on_ok == TRUE)
-				fprintf(fp, "%so", (x++ > 0) ? "," : "");
-			if (temp_servicedependency->fail_execute_on_unknown == TRUE)
-				fprintf(fp, "%su", (x++ > 0) ? "," : "");
-			if (temp_servicedependency->fail_execute_on_warning == TRUE)
-				fprintf(fp, "%sw", (x++ > 0) ? "," : "");
-			if (temp_servicedependency->fail_execute_on_critical == TRUE)
-				fprintf(fp, "%sc", (x++ > 0) ? "," : "");
-			if (temp_servicedependency->fail_execute_on_pending == TRUE)
-				fprintf(fp, "%sp", (x++ > 0) ? "," : "");
-			if (x == 0)
-				fprintf(fp, "n");
-			fprintf(fp, "\n");
-		}
-		fprintf(fp, "\t}\n\n");
+	if ((members = xodtemplate_binary_records(buf, XODTEMPLATE_BINARY_MEMBER, record->contacts_index, record->contacts_count)) == NULL)
+		return ERROR;
+	for (x = record->contacts_count; x > 0L; x--) {
+		if (add_contact_to_serviceescalation(new_serviceescalation, xodtemplate_binary_string(buf, members[x - 1].name)) == NULL)
+			return ERROR;
 	}
 
-	/* cache service escalations */
-	/*for(temp_serviceescalation=xodtemplate_serviceescalation_list;temp_serviceescalation!=NULL;temp_serviceescalation=temp_serviceescalation->next){*/
-	ptr = NULL;
-	for (temp_serviceescalation = (xodtemplate_serviceescalation *)skiplist_get_first(xobject_skiplists[X_SERVICEESCALATION_SKIPLIST], &ptr); temp_serviceescalation != NULL; temp_serviceescalation = (xodtemplate_serviceescalation *)skiplist_get_next(&ptr)) {
-		if (temp_serviceescalation->register_object == FALSE)
-			continue;
-		fprintf(fp, "define serviceescalation {\n");
-		if (temp_serviceescalation->host_name)
-			fprintf(fp, "\thost_name\t%s\n", temp_serviceescalation->host_name);
-		if (temp_serviceescalation->service_description)
-			fprintf(fp, "\tservice_description\t%s\n", temp_serviceescalation->service_description);
-		fprintf(fp, "\tfirst_notification\t%d\n", temp_serviceescalation->first_notification);
-		fprintf(fp, "\tlast_notification\t%d\n", temp_serviceescalation->last_notification);
-		/* state based escalation ranges */
-		fprintf(fp, "\tfirst_warning_notification\t%d\n", temp_serviceescalation->first_warning_notification);
-		fprintf(fp, "\tlast_warning_notification\t%d\n", temp_serviceescalation->last_warning_notification);
-		fprintf(fp, "\tfirst_critical_notification\t%d\n", temp_serviceescalation->first_critical_notification);
-		fprintf(fp, "\tlast_critical_notification\t%d\n", temp_serviceescalation->last_critical_notification);
-		fprintf(fp, "\tfirst_unknown_notification\t%d\n", temp_serviceescalation->first_unknown_notification);
-		fprintf(fp, "\tlast_unknown_notification\t%d\n", temp_serviceescalation->last_unknown_notification);
-
-		fprintf(fp, "\tnotification_interval\t%f\n", temp_serviceescalation->notification_interval);
-		if (temp_serviceescalation->escalation_period)
-			fprintf(fp, "\tescalation_period\t%s\n", temp_serviceescalation->escalation_period);
-		if (temp_serviceescalation->have_escalation_options == TRUE) {
-			fprintf(fp, "\tescalation_options\t");
-			x = 0;
-			if (temp_serviceescalation->escalate_on_warning == TRUE)
-				fprintf(fp, "%sw", (x++ > 0) ? "," : "");
-			if (temp_serviceescalation->escalate_on_unknown == TRUE)
-				fprintf(fp, "%su", (x++ > 0) ? "," : "");
-			if (temp_serviceescalation->escalate_on_critical == TRUE)
-				fprintf(fp, "%sc", (x++ > 0) ? "," : "");
-			if (temp_serviceescalation->escalate_on_recovery == TRUE)
-				fprintf(fp, "%sr", (x++ > 0) ? "," : "");
-			if (x == 0)
-				fprintf(fp, "n");
-			fprintf(fp, "\n");
-		}
-		if (temp_serviceescalation->contacts)
-			fprintf(fp, "\tcontacts\t%s\n", temp_serviceescalation->contacts);
-		if (temp_serviceescalation->contact_groups)
-			fprintf(fp, "\tcontact_groups\t%s\n", temp_serviceescalation->contact_groups);
-		fprintf(fp, "\t}\n\n");
+	/* conditions are appended to the last one, so they are added in order */
+	if ((conditions = xodtemplate_binary_records(buf, XODTEMPLATE_BINARY_CONDITION, record->conditions_index, record->conditions_count)) == NULL)
+		return ERROR;
+	for (x = 0L; x < record->conditions_count; x++) {
+		if ((last_condition = add_serviceescalation_condition(new_serviceescalation, last_condition, xodtemplate_binary_string(buf, conditions[x].host_name), xodtemplate_binary_string(buf, conditions[x].service_description), conditions[x].connector, conditions[x].escalate_on_down, conditions[x].escalate_on_unreachable, conditions[x].escalate_on_warning, conditions[x].escalate_on_unknown, conditions[x].escalate_on_critical, conditions[x].escalate_on_ok)) == NULL)
+			return ERROR;
 	}
 
-	/* cache host dependencies */
-	/*for(temp_hostdependency=xodtemplate_hostdependency_list;temp_hostdependency!=NULL;temp_hostdependency=temp_hostdependency->next){*/
-	ptr = NULL;
-	for (temp_hostdependency = (xodtemplate_hostdependency *)skiplist_get_first(xobject_skiplists[X_HOSTDEPENDENCY_SKIPLIST], &ptr); temp_hostdependency != NULL; temp_hostdependency = (xodtemplate_hostdependency *)skiplist_get_next(&ptr)) {
-		if (temp_hostdependency->register_object == FALSE)
-			continue;
-		fprintf(fp, "define hostdependency {\n");
-		if (temp_hostdependency->host_name)
-			fprintf(fp, "\thost_name\t%s\n", temp_hostdependency->host_name);
-		if (temp_hostdependency->dependent_host_name)
-			fprintf(fp, "\tdependent_host_name\t%s\n", temp_hostdependency->dependent_host_name);
-		if (temp_hostdependency->dependency_period)
-			fprintf(fp, "\tdependency_period\t%s\n", temp_hostdependency->dependency_period);
-		fprintf(fp, "\tinherits_parent\t%d\n", temp_hostdependency->inherits_parent);
-		if (temp_hostdependency->have_notification_dependency_options == TRUE) {
-			fprintf(fp, "\tnotification_failure_options\t");
-			x = 0;
-			if (temp_hostdependency->fail_notify_on_up == TRUE)
-				fprintf(fp, "%so", (x++ > 0) ? "," : "");
-			if (temp_hostdependency->fail_notify_on_down == TRUE)
-				fprintf(fp, "%sd", (x++ > 0) ? "," : "");
-			if (temp_hostdependency->fail_notify_on_unreachable == TRUE)
-				fprintf(fp, "%su", (x++ > 0) ? "," : "");
-			if (temp_hostdependency->fail_notify_on_pending == TRUE)
-				fprintf(fp, "%sp", (x++ > 0) ? "," : "");
-			if (x == 0)
-				fprintf(fp, "n");
-			fprintf(fp, "\n");
-		}
-		if (temp_hostdependency->have_execution_dependency_options == TRUE) {
-			fprintf(fp, "\texecution_failure_options\t");
-			x = 0;
-			if (temp_hostdependency->fail_execute_on_up == TRUE)
-				fprintf(fp, "%so", (x++ > 0) ? "," : "");
-			if (temp_hostdependency->fail_execute_on_down == TRUE)
-				fprintf(fp, "%sd", (x++ > 0) ? "," : "");
-			if (temp_hostdependency->fail_execute_on_unreachable == TRUE)
-				fprintf(fp, "%su", (x++ > 0) ? "," : "");
-			if (temp_hostdependency->fail_execute_on_pending == TRUE)
-				fprintf(fp, "%sp", (x++ > 0) ? "," : "");
-			if (x == 0)
-				fprintf(fp, "n");
-			fprintf(fp, "\n");
-		}
-		fprintf(fp, "\t}\n\n");
-	}
+	return OK;
+}
 
-	/* cache host escalations */
-	/*for(temp_hostescalation=xodtemplate_hostescalation_list;temp_hostescalation!=NULL;temp_hostescalation=temp_hostescalation->next){*/
-	ptr = NULL;
-	for (temp_hostescalation = (xodtemplate_hostescalation *)skiplist_get_first(xobject_skiplists[X_HOSTESCALATION_SKIPLIST], &ptr); temp_hostescalation != NULL; temp_hostescalation = (xodtemplate_hostescalation *)skiplist_get_next(&ptr)) {
-		if (temp_hostescalation->register_object == FALSE)
-			continue;
-		fprintf(fp, "define hostescalation {\n");
-		if (temp_hostescalation->host_name)
-			fprintf(fp, "\thost_name\t%s\n", temp_hostescalation->host_name);
-		fprintf(fp, "\tfirst_notification\t%d\n", temp_hostescalation->first_notification);
-		fprintf(fp, "\tlast_notification\t%d\n", temp_hostescalation->last_notification);
-		/* state based escalation ranges */
-		fprintf(fp, "\tfirst_down_notification\t%d\n", temp_hostescalation->first_down_notification);
-		fprintf(fp, "\tlast_down_notification\t%d\n", temp_hostescalation->last_down_notification);
-		fprintf(fp, "\tfirst_unreachable_notification\t%d\n", temp_hostescalation->first_unreachable_notification);
-		fprintf(fp, "\tlast_unreachable_notification\t%d\n", temp_hostescalation->last_unreachable_notification);
 
-		fprintf(fp, "\tnotification_interval\t%f\n", temp_hostescalation->notification_interval);
-		if (temp_hostescalation->escalation_period)
-			fprintf(fp, "\tescalation_period\t%s\n", temp_hostescalation->escalation_period);
-		if (temp_hostescalation->have_escalation_options == TRUE) {
-			fprintf(fp, "\tescalation_options\t");
-			x = 0;
-			if (temp_hostescalation->escalate_on_down == TRUE)
-				fprintf(fp, "%sd", (x++ > 0) ? "," : "");
-			if (temp_hostescalation->escalate_on_unreachable == TRUE)
-				fprintf(fp, "%su", (x++ > 0) ? "," : "");
-			if (temp_hostescalation->escalate_on_recovery == TRUE)
-				fprintf(fp, "%sr", (x++ > 0) ? "," : "");
-			if (x == 0)
-				fprintf(fp, "n");
-			fprintf(fp, "\n");
-		}
-		if (temp_hostescalation->contacts)
-			fprintf(fp, "\tcontacts\t%s\n", temp_hostescalation->contacts);
-		if (temp_hostescalation->contact_groups)
-			fprintf(fp, "\tcontact_groups\t%s\n", temp_hostescalation->contact_groups);
-		fprintf(fp, "\t}\n\n");
+/* adds a host escalation from the binary object cache */
+static int xodtemplate_register_binary_hostescalation(char *buf, xodtemplate_binary_escalation *record) {
+	xodtemplate_binary_member *members = NULL;
+	xodtemplate_binary_condition *conditions = NULL;
+	hostescalation *new_hostescalation = NULL;
+	escalation_condition *last_condition = NULL;
+	unsigned long x = 0L;
+
+	if ((new_hostescalation = add_hostescalation(xodtemplate_binary_string(buf, record->host_name), record->first_notification, record->last_notification, record->first_warning_notification, record->last_warning_notification, record->first_critical_notification, record->last_critical_notification, record->notification_interval, xodtemplate_binary_string(buf, record->escalation_period), record->escalate_on_warning, record->escalate_on_unknown, record->escalate_on_recovery)) == NULL)
+		return ERROR;
+
+	if ((members = xodtemplate_binary_records(buf, XODTEMPLATE_BINARY_MEMBER, record->contact_groups_index, record->contact_groups_count)) == NULL)
+		return ERROR;
+	for (x = record->contact_groups_count; x > 0L; x--) {
+		if (add_contactgroup_to_hostescalation(new_hostescalation, xodtemplate_binary_string(buf, members[x - 1].name)) == NULL)
+			return ERROR;
 	}
 
-	/* cache modules */
-	/*for(temp_module=xodtemplate_module_list;temp_module!=NULL;temp_module=temp_module->next){*/
-	ptr = NULL;
-	for (temp_module = (xodtemplate_module *)skiplist_get_first(xobject_skiplists[X_MODULE_SKIPLIST], &ptr); temp_module != NULL; temp_module = (xodtemplate_module *)skiplist_get_next(&ptr)) {
-		if (temp_module->register_object == FALSE)
-			continue;
-		fprintf(fp, "define module {\n");
-		if (temp_module->module_name)
-			fprintf(fp, "\tmodule_name\t%s\n", temp_module->module_name);
-		if (temp_module->module_type)
-			fprintf(fp, "\tmodule_type\t%s\n", temp_module->module_type);
-		if (temp_module->path)
-			fprintf(fp, "\tpath\t%s\n", temp_module->path);
-		if (temp_module->args)
-			fprintf(fp, "\targs\t%s\n", temp_module->args);
-		fprintf(fp, "\t}\n\n");
+	if ((members = xodtemplate_binary_records(buf, XODTEMPLATE_BINARY_MEMBER, record->contacts_index, record->contacts_count)) == NULL)
+		return ERROR;
+	for (x = record->contacts_count; x > 0L; x--) {
+		if (add_contact_to_hostescalation(new_hostescalation, xodtemplate_binary_string(buf, members[x - 1].name)) == NULL)
+			return ERROR;
 	}
 
+	if ((conditions = xodtemplate_binary_records(buf, XODTEMPLATE_BINARY_CONDITION, record->conditions_index, record->conditions_count)) == NULL)
+		return ERROR;
+	for (x = 0L; x < record->conditions_count; x++) {
+		if ((last_condition = add_hostescalation_condition(new_hostescalation, last_condition, xodtemplate_binary_string(buf, conditions[x].host_name), xodtemplate_binary_string(buf, conditions[x].service_description), conditions[x].connector, conditions[x].escalate_on_down, conditions[x].escalate_on_unreachable, conditions[x].escalate_on_warning, conditions[x].escalate_on_unknown, conditions[x].escalate_on_critical, conditions[x].escalate_on_ok)) == NULL)
+			return ERROR;
+	}
 
-	fclose(fp);
+	return OK;
+}
+
+
+/* adds all objects of a binary object cache mapped by xodtemplate_open_binary_objects(), in the order they were registered */
+int xodtemplate_register_binary_objects(char *buf) {
+	xodtemplate_binary_header *header = (xodtemplate_binary_header *)buf;
+	xodtemplate_binary_command *command_record = NULL;
+	xodtemplate_binary_dependency *dependency_record = NULL;
+	xodtemplate_binary_module *module_record = NULL;
+	char *object_types[XODTEMPLATE_BINARY_MODULE + 1] = {"timeperiod", "command", "contactgroup", "hostgroup", "servicegroup", "contact", "host", "service", "service dependency", "service escalation", "host dependency", "host escalation", "module"};
+	char *record = NULL;
+	unsigned long x = 0L;
+	int section = 0;
+	int result = OK;
+
+	for (section = XODTEMPLATE_BINARY_TIMEPERIOD; section <= XODTEMPLATE_BINARY_MODULE; section++) {
+		for (x = 0L; x < header->sections[section].count; x++) {
+
+			record = buf + header->sections[section].offset + x * header->sections[section].record_size;
+
+			switch (section) {
+			case XODTEMPLATE_BINARY_TIMEPERIOD:
+				result = xodtemplate_register_binary_timeperiod(buf, (xodtemplate_binary_timeperiod *)record);
+				break;
+			case XODTEMPLATE_BINARY_COMMAND:
+				command_record = (xodtemplate_binary_command *)record;
+				result = (add_command(xodtemplate_binary_string(buf, command_record->name), xodtemplate_binary_string(buf, command_record->command_line)) == NULL) ? ERROR : OK;
+				break;
+			case XODTEMPLATE_BINARY_CONTACTGROUP:
+				result = xodtemplate_register_binary_contactgroup(buf, (xodtemplate_binary_group *)record);
+				break;
+			case XODTEMPLATE_BINARY_HOSTGROUP:
+				result = xodtemplate_register_binary_hostgroup(buf, (xodtemplate_binary_group *)record);
+				break;
+			case XODTEMPLATE_BINARY_SERVICEGROUP:
+				result = xodtemplate_register_binary_servicegroup(buf, (xodtemplate_binary_group *)record);
+				break;
+			case XODTEMPLATE_BINARY_CONTACT:
+				result = xodtemplate_register_binary_contact(buf, (xodtemplate_binary_contact *)record);
+				break;
+			case XODTEMPLATE_BINARY_HOST:
+				result = xodtemplate_register_binary_host(buf, (xodtemplate_binary_host *)record);
+				break;
+			case XODTEMPLATE_BINARY_SERVICE:
+				result = xodtemplate_register_binary_service(buf, (xodtemplate_binary_service *)record);
+				break;
+			case XODTEMPLATE_BINARY_SERVICEDEPENDENCY:
+				dependency_record = (xodtemplate_binary_dependency *)record;
+				result = (add_service_dependency(xodtemplate_binary_string(buf, dependency_record->dependent_host_name), xodtemplate_binary_string(buf, dependency_record->dependent_service_description), xodtemplate_binary_string(buf, dependency_record->host_name), xodtemplate_binary_string(buf, dependency_record->service_description), dependency_record->dependency_type, dependency_record->inherits_parent, dependency_record->fail_on_ok, dependency_record->fail_on_warning, dependency_record->fail_on_unknown, dependency_record->fail_on_critical, dependency_record->fail_on_pending, xodtemplate_binary_string(buf, dependency_record->dependency_period)) == NULL) ? ERROR : OK;
+				break;
+			case XODTEMPLATE_BINARY_SERVICEESCALATION:
+				result = xodtemplate_register_binary_serviceescalation(buf, (xodtemplate_binary_escalation *)record);
+				break;
+			case XODTEMPLATE_BINARY_HOSTDEPENDENCY:
+				dependency_record = (xodtemplate_binary_dependency *)record;
+				result = (add_host_dependency(xodtemplate_binary_string(buf, dependency_record->dependent_host_name), xodtemplate_binary_string(buf, dependency_record->host_name), dependency_record->dependency_type, dependency_record->inherits_parent, dependency_record->fail_on_ok, dependency_record->fail_on_warning, dependency_record->fail_on_unknown, dependency_record->fail_on_pending, xodtemplate_binary_string(buf, dependency_record->dependency_period)) == NULL) ? ERROR : OK;
+				break;
+			case XODTEMPLATE_BINARY_HOSTESCALATION:
+				result = xodtemplate_register_binary_hostescalation(buf, (xodtemplate_binary_escalation *)record);
+				break;
+			case XODTEMPLATE_BINARY_MODULE:
+				module_record = (xodtemplate_binary_module *)record;
+				result = (add_module(xodtemplate_binary_string(buf, module_record->name), xodtemplate_binary_string(buf, module_record->type), xodtemplate_binary_string(buf, module_record->path), xodtemplate_binary_string(buf, module_record->args)) == NULL) ? ERROR : OK;
+				break;
+			}
+
+			/* every record starts with the name of its object */
+			if (result == ERROR) {
+				logit(NSLOG_CONFIG_ERROR, TRUE, "Error: Could not register %s '%s' from binary object cache\n", object_types[section], xodtemplate_binary_string(buf, *(unsigned long *)record));
+				return ERROR;
+			}
+		}
+	}
 
 	return OK;
 }
 
 #endif
 
+
+
 /******************************************************************/
 /******************** SKIPLIST FUNCTIONS **************************/
 /******************************************************************/
@@ -12023,8 +13686,6 @@ int xodtemplate_free_memory(void) {
 		this_customvariablesmember = this_contact->custom_variables;
 		while (this_customvariablesmember != NULL) {
 			next_customvariablesmember = this_customvariablesmember->next;
-			my_free(this_customvariablesmember->variable_name);
-			my_free(this_customvariablesmember->variable_value);
 			my_free(this_customvariablesmember);
 			this_customvariablesmember = next_customvariablesmember;
 		}
@@ -12055,8 +13716,6 @@ int xodtemplate_free_memory(void) {
 		this_customvariablesmember = this_host->custom_variables;
 		while (this_customvariablesmember != NULL) {
 			next_customvariablesmember = this_customvariablesmember->next;
-			my_free(this_customvariablesmember->variable_name);
-			my_free(this_customvariablesmember->variable_value);
 			my_free(this_customvariablesmember);
 			this_customvariablesmember = next_customvariablesmember;
 		}
@@ -12097,8 +13756,6 @@ int xodtemplate_free_memory(void) {
 		this_customvariablesmember = this_service->custom_variables;
 		while (this_customvariablesmember != NULL) {
 			next_customvariablesmember = this_customvariablesmember->next;
-			my_free(this_customvariablesmember->variable_name);
-			my_free(this_customvariablesmember->variable_value);
 			my_free(this_customvariablesmember);
 			this_customvariablesmember = next_customvariablesmember;
 		}
@@ -12221,6 +13878,10 @@ int xodtemplate_free_memory(void) {
 	xodtemplate_module_list = NULL;
 	xodtemplate_module_list_tail = NULL;
 
+#ifdef NSCORE
+	/* free the template lists cached while resolving objects */
+	xodtemplate_free_template_cache();
+#endif
 
 	/* free skiplists */
 	xodtemplate_free_xobject_skiplists();
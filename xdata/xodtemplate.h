@@ -855,6 +855,406 @@ typedef struct xodtemplate_memberlist_struct{
         }xodtemplate_memberlist;
 
 
+/********* PARALLEL CONFIG PARSING *********/
+
+/*
+ * with object_parse_threads > 1 the config files named in the main config file are
+ * collected first and read by parse threads. a thread reads a file, joins continuation
+ * lines, strips comments and white space and keeps the remaining lines with their line
+ * numbers in an arena of its own. the main thread replays the lines of the files in the
+ * order they would have been read one after another, so objects, templates, duplicate
+ * checks and error messages with file and line are the same as without threads.
+ */
+
+#define XODTEMPLATE_PARSE_FILE             0      /* config file */
+#define XODTEMPLATE_PARSE_DIR              1      /* config directory, only reported with -v */
+#define XODTEMPLATE_PARSE_DIR_ERROR        2      /* config directory could not be opened */
+#define XODTEMPLATE_PARSE_MEMBER_ERROR     3      /* config directory member could not be read */
+#define XODTEMPLATE_PARSE_NAME_ERROR       4      /* path of a config directory member is too long */
+
+#define XODTEMPLATE_MAX_PARSE_THREADS      16
+
+typedef struct xodtemplate_parse_line_struct{
+	unsigned long   offset;				/* start of the line in the arena */
+	int             line;				/* last line of the line in the file */
+        }xodtemplate_parse_line;
+
+typedef struct xodtemplate_parse_job_struct{
+	int             type;
+	char            *filename;
+	int             error;				/* errno if the file could not be opened */
+	int             last_line;			/* number of lines read from the file */
+	char            *arena;				/* stripped lines, each terminated */
+	unsigned long   arena_size;
+	unsigned long   arena_allocated;
+	xodtemplate_parse_line *lines;
+	int             line_count;
+	int             lines_allocated;
+	int             done;				/* set by the parse thread when the file has been read */
+        }xodtemplate_parse_job;
+
+
+
+/********* TEMPLATE CACHE ***********/
+
+/*
+ * most hosts, services and contacts share a few 'use' values. the templates named in a
+ * 'use' value are looked up and flattened (resolved with their own templates) the first
+ * time the value is seen, every other object with the same value copies its missing
+ * properties straight from the cached, already flattened templates. custom variables of
+ * a template that names each of them once only have to be compared with the variables
+ * the object defines itself, not with the ones it got from the same template.
+ */
+
+#define XODTEMPLATE_TEMPLATE_CACHE_SLOTS   1024
+
+typedef struct xodtemplate_template_cache_struct{
+	int             object_type;
+	char            *template_names;		/* the 'use' value as it was read */
+	void            **templates;			/* resolved templates in the order they are applied */
+	int             *unique_variables;		/* TRUE if the template names each custom variable once */
+	int             template_count;
+	struct xodtemplate_template_cache_struct *next;
+        }xodtemplate_template_cache;
+
+
+
+/********* BINARY OBJECT CACHE ***********/
+
+/*
+ * precaching the object config (-p) also writes <precached_object_file>.bin. it holds the
+ * registered objects as fixed size records in the order they were registered, followed by the
+ * member records of their lists (parents, contacts, group members, custom variables, ...),
+ * the time ranges of the timeperiods and a string table. strings are offsets into the string
+ * table, lists are an index and a count into their section. with -u the objects are added from
+ * these records directly, the config files and the text precache file aren't parsed at all.
+ * the file is only used if the text precache file still has the size and mtime it had when
+ * both were written.
+ */
+
+#define XODTEMPLATE_BINARY_MAGIC           "ICOBJB"
+#define XODTEMPLATE_BINARY_VERSION         1
+#define XODTEMPLATE_BINARY_SUFFIX          ".bin"
+#define XODTEMPLATE_BINARY_NONE            ((unsigned long)-1)
+
+#define XODTEMPLATE_BINARY_TIMEPERIOD         0
+#define XODTEMPLATE_BINARY_COMMAND            1
+#define XODTEMPLATE_BINARY_CONTACTGROUP       2
+#define XODTEMPLATE_BINARY_HOSTGROUP          3
+#define XODTEMPLATE_BINARY_SERVICEGROUP       4
+#define XODTEMPLATE_BINARY_CONTACT            5
+#define XODTEMPLATE_BINARY_HOST               6
+#define XODTEMPLATE_BINARY_SERVICE            7
+#define XODTEMPLATE_BINARY_SERVICEDEPENDENCY  8
+#define XODTEMPLATE_BINARY_SERVICEESCALATION  9
+#define XODTEMPLATE_BINARY_HOSTDEPENDENCY     10
+#define XODTEMPLATE_BINARY_HOSTESCALATION     11
+#define XODTEMPLATE_BINARY_MODULE             12
+#define XODTEMPLATE_BINARY_DATERANGE          13
+#define XODTEMPLATE_BINARY_TIMERANGE          14
+#define XODTEMPLATE_BINARY_CONDITION          15
+#define XODTEMPLATE_BINARY_MEMBER             16
+#define XODTEMPLATE_BINARY_STRING             17
+
+#define XODTEMPLATE_BINARY_SECTIONS           18
+
+typedef struct xodtemplate_binary_section_struct{
+	unsigned long   offset;
+	unsigned long   count;
+	unsigned long   record_size;
+        }xodtemplate_binary_section;
+
+typedef struct xodtemplate_binary_header_struct{
+	char            magic[8];
+	unsigned int    version;
+	unsigned int    header_size;
+	unsigned long   created;
+	unsigned long   precache_size;		/* size of the text precache file written along with this file */
+	unsigned long   precache_mtime;		/* modification time of the text precache file */
+	unsigned long   size;
+	xodtemplate_binary_section sections[XODTEMPLATE_BINARY_SECTIONS];
+        }xodtemplate_binary_header;
+
+/* parents, contacts, contact groups, group members, notification commands, custom variables and exclusions */
+typedef struct xodtemplate_binary_member_struct{
+	unsigned long   name;
+	unsigned long   value;			/* service description or custom variable value */
+        }xodtemplate_binary_member;
+
+typedef struct xodtemplate_binary_timerange_struct{
+	unsigned long   range_start;
+	unsigned long   range_end;
+        }xodtemplate_binary_timerange;
+
+typedef struct xodtemplate_binary_daterange_struct{
+	unsigned long   times_index;
+	unsigned long   times_count;
+	int             type;
+	int             syear;
+	int             smon;
+	int             smday;
+	int             swday;
+	int             swday_offset;
+	int             eyear;
+	int             emon;
+	int             emday;
+	int             ewday;
+	int             ewday_offset;
+	int             skip_interval;
+        }xodtemplate_binary_daterange;
+
+typedef struct xodtemplate_binary_condition_struct{
+	unsigned long   host_name;
+	unsigned long   service_description;
+	int             connector;
+	int             escalate_on_down;
+	int             escalate_on_unreachable;
+	int             escalate_on_warning;
+	int             escalate_on_unknown;
+	int             escalate_on_critical;
+	int             escalate_on_ok;
+        }xodtemplate_binary_condition;
+
+typedef struct xodtemplate_binary_timeperiod_struct{
+	unsigned long   name;
+	unsigned long   alias;
+	unsigned long   days_index[7];
+	unsigned long   days_count[7];
+	unsigned long   exceptions_index;
+	unsigned long   exceptions_count;
+	unsigned long   exclusions_index;
+	unsigned long   exclusions_count;
+        }xodtemplate_binary_timeperiod;
+
+typedef struct xodtemplate_binary_command_struct{
+	unsigned long   name;
+	unsigned long   command_line;
+        }xodtemplate_binary_command;
+
+/* contact groups, host groups and service groups */
+typedef struct xodtemplate_binary_group_struct{
+	unsigned long   group_name;
+	unsigned long   alias;
+	unsigned long   notes;
+	unsigned long   notes_url;
+	unsigned long   action_url;
+	unsigned long   members_index;
+	unsigned long   members_count;
+        }xodtemplate_binary_group;
+
+typedef struct xodtemplate_binary_contact_struct{
+	unsigned long   name;
+	unsigned long   alias;
+	unsigned long   email;
+	unsigned long   pager;
+	unsigned long   address[MAX_CONTACT_ADDRESSES];
+	unsigned long   host_notification_period;
+	unsigned long   service_notification_period;
+	unsigned long   host_commands_index;
+	unsigned long   host_commands_count;
+	unsigned long   service_commands_index;
+	unsigned long   service_commands_count;
+	unsigned long   custom_variables_index;
+	unsigned long   custom_variables_count;
+	int             notify_on_service_unknown;
+	int             notify_on_service_warning;
+	int             notify_on_service_critical;
+	int             notify_on_service_recovery;
+	int             notify_on_service_flapping;
+	int             notify_on_service_downtime;
+	int             notify_on_host_down;
+	int             notify_on_host_unreachable;
+	int             notify_on_host_recovery;
+	int             notify_on_host_flapping;
+	int             notify_on_host_downtime;
+	int             host_notifications_enabled;
+	int             service_notifications_enabled;
+	int             can_submit_commands;
+	int             retain_status_information;
+	int             retain_nonstatus_information;
+        }xodtemplate_binary_contact;
+
+typedef struct xodtemplate_binary_host_struct{
+	unsigned long   name;
+	unsigned long   display_name;
+	unsigned long   alias;
+	unsigned long   address;
+	unsigned long   address6;
+	unsigned long   check_period;
+	unsigned long   notification_period;
+	unsigned long   check_command;
+	unsigned long   event_handler;
+	unsigned long   failure_prediction_options;
+	unsigned long   notes;
+	unsigned long   notes_url;
+	unsigned long   action_url;
+	unsigned long   icon_image;
+	unsigned long   icon_image_alt;
+	unsigned long   vrml_image;
+	unsigned long   statusmap_image;
+	unsigned long   parents_index;
+	unsigned long   parents_count;
+	unsigned long   contact_groups_index;
+	unsigned long   contact_groups_count;
+	unsigned long   contacts_index;
+	unsigned long   contacts_count;
+	unsigned long   custom_variables_index;
+	unsigned long   custom_variables_count;
+	double          check_interval;
+	double          retry_interval;
+	double          notification_interval;
+	double          first_notification_delay;
+	double          low_flap_threshold;
+	double          high_flap_threshold;
+	double          x_3d;
+	double          y_3d;
+	double          z_3d;
+	int             initial_state;
+	int             max_attempts;
+	int             notify_on_recovery;
+	int             notify_on_down;
+	int             notify_on_unreachable;
+	int             notify_on_flapping;
+	int             notify_on_downtime;
+	int             notifications_enabled;
+	int             checks_enabled;
+	int             accept_passive_host_checks;
+	int             event_handler_enabled;
+	int             flap_detection_enabled;
+	int             flap_detection_on_up;
+	int             flap_detection_on_down;
+	int             flap_detection_on_unreachable;
+	int             stalk_on_up;
+	int             stalk_on_down;
+	int             stalk_on_unreachable;
+	int             process_performance_data;
+	int             failure_prediction_enabled;
+	int             check_freshness;
+	int             freshness_threshold;
+	int             x_2d;
+	int             y_2d;
+	int             have_2d_coords;
+	int             have_3d_coords;
+	int             should_be_drawn;
+	int             retain_status_information;
+	int             retain_nonstatus_information;
+	int             obsess_over_host;
+        }xodtemplate_binary_host;
+
+typedef struct xodtemplate_binary_service_struct{
+	unsigned long   host_name;
+	unsigned long   description;
+	unsigned long   display_name;
+	unsigned long   check_period;
+	unsigned long   notification_period;
+	unsigned long   check_command;
+	unsigned long   event_handler;
+	unsigned long   failure_prediction_options;
+	unsigned long   notes;
+	unsigned long   notes_url;
+	unsigned long   action_url;
+	unsigned long   icon_image;
+	unsigned long   icon_image_alt;
+	unsigned long   contact_groups_index;
+	unsigned long   contact_groups_count;
+	unsigned long   contacts_index;
+	unsigned long   contacts_count;
+	unsigned long   custom_variables_index;
+	unsigned long   custom_variables_count;
+	double          check_interval;
+	double          retry_interval;
+	double          notification_interval;
+	double          first_notification_delay;
+	double          low_flap_threshold;
+	double          high_flap_threshold;
+	int             initial_state;
+	int             max_attempts;
+	int             parallelize;
+	int             accept_passive_service_checks;
+	int             notify_on_recovery;
+	int             notify_on_unknown;
+	int             notify_on_warning;
+	int             notify_on_critical;
+	int             notify_on_flapping;
+	int             notify_on_downtime;
+	int             notifications_enabled;
+	int             is_volatile;
+	int             event_handler_enabled;
+	int             checks_enabled;
+	int             flap_detection_enabled;
+	int             flap_detection_on_ok;
+	int             flap_detection_on_warning;
+	int             flap_detection_on_unknown;
+	int             flap_detection_on_critical;
+	int             stalk_on_ok;
+	int             stalk_on_warning;
+	int             stalk_on_unknown;
+	int             stalk_on_critical;
+	int             process_performance_data;
+	int             failure_prediction_enabled;
+	int             check_freshness;
+	int             freshness_threshold;
+	int             retain_status_information;
+	int             retain_nonstatus_information;
+	int             obsess_over_service;
+        }xodtemplate_binary_service;
+
+/* host and service dependencies, the service descriptions are empty for host dependencies */
+typedef struct xodtemplate_binary_dependency_struct{
+	unsigned long   dependent_host_name;
+	unsigned long   dependent_service_description;
+	unsigned long   host_name;
+	unsigned long   service_description;
+	unsigned long   dependency_period;
+	int             dependency_type;
+	int             inherits_parent;
+	int             fail_on_ok;			/* fail_on_up for host dependencies */
+	int             fail_on_warning;		/* fail_on_down for host dependencies */
+	int             fail_on_unknown;		/* fail_on_unreachable for host dependencies */
+	int             fail_on_critical;
+	int             fail_on_pending;
+        }xodtemplate_binary_dependency;
+
+/* host and service escalations, the service state fields hold the host state ones for host escalations */
+typedef struct xodtemplate_binary_escalation_struct{
+	unsigned long   host_name;
+	unsigned long   description;
+	unsigned long   escalation_period;
+	unsigned long   contact_groups_index;
+	unsigned long   contact_groups_count;
+	unsigned long   contacts_index;
+	unsigned long   contacts_count;
+	unsigned long   conditions_index;
+	unsigned long   conditions_count;
+	double          notification_interval;
+	int             first_notification;
+	int             last_notification;
+	int             first_warning_notification;	/* first_down_notification */
+	int             last_warning_notification;	/* last_down_notification */
+	int             first_critical_notification;	/* first_unreachable_notification */
+	int             last_critical_notification;	/* last_unreachable_notification */
+	int             first_unknown_notification;
+	int             last_unknown_notification;
+	int             escalate_on_recovery;
+	int             escalate_on_warning;		/* escalate_on_down */
+	int             escalate_on_unknown;		/* escalate_on_unreachable */
+	int             escalate_on_critical;
+        }xodtemplate_binary_escalation;
+
+typedef struct xodtemplate_binary_module_struct{
+	unsigned long   name;
+	unsigned long   type;
+	unsigned long   path;
+	unsigned long   args;
+        }xodtemplate_binary_module;
+
+typedef struct xodtemplate_binary_buffer_struct{
+	char            *data;
+	unsigned long   size;
+	unsigned long   allocated;
+        }xodtemplate_binary_buffer;
+
+
 /***** CHAINED HASH DATA STRUCTURES ******/
 
 typedef struct xodtemplate_service_cursor_struct{
@@ -872,6 +1272,10 @@ int xodtemplate_process_config_file(char *,int);            /* process data in a
 int xodtemplate_process_config_dir(char *,int);             /* process all files in a specific config directory */
 
 #ifdef NSCORE
+int xodtemplate_collect_config_dir(char *);                 /* adds all files in a config directory to the parse jobs */
+int xodtemplate_add_parse_job(int,char *);                  /* adds a config file or directory to the parse jobs */
+int xodtemplate_parse_config_files(int);                    /* reads the collected config files with parse threads */
+
 xodtemplate_memberlist *xodtemplate_expand_contactgroups_and_contacts(char *,char *,int,int);
 int xodtemplate_expand_contactgroups(xodtemplate_memberlist **,xodtemplate_memberlist **,char *,int,int);
 int xodtemplate_expand_contacts(xodtemplate_memberlist **,xodtemplate_memberlist **,char *,int,int);
@@ -934,6 +1338,9 @@ int xodtemplate_compare_strings1(char *,char *);
 int xodtemplate_compare_strings2(char *,char *,char *,char *);
 
 int xodtemplate_cache_objects(char *);
+int xodtemplate_cache_binary_objects(char *);
+char *xodtemplate_open_binary_objects(char *,unsigned long *);
+int xodtemplate_register_binary_objects(char *);
 
 int xodtemplate_duplicate_service(xodtemplate_service *,char *);
 int xodtemplate_duplicate_hostescalation(xodtemplate_hostescalation *,char *);
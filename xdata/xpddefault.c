@@ -47,6 +47,8 @@ command *xpddefault_service_perfdata_command_ptr = NULL;
 
 char    *xpddefault_host_perfdata_file_template = NULL;
 char    *xpddefault_service_perfdata_file_template = NULL;
+macro_token *xpddefault_host_perfdata_file_template_tokens = NULL;
+macro_token *xpddefault_service_perfdata_file_template_tokens = NULL;
 
 char    *xpddefault_host_perfdata_file = NULL;
 char    *xpddefault_service_perfdata_file = NULL;
@@ -246,6 +248,10 @@ int xpddefault_initialize_performance_data(char *config_file) {
 	xpddefault_preprocess_file_templates(xpddefault_host_perfdata_file_template);
 	xpddefault_preprocess_file_templates(xpddefault_service_perfdata_file_template);
 
+	/* the templates are expanded for every check result, so split them into macro tokens once */
+	xpddefault_host_perfdata_file_template_tokens = compile_macro_tokens(xpddefault_host_perfdata_file_template);
+	xpddefault_service_perfdata_file_template_tokens = compile_macro_tokens(xpddefault_service_perfdata_file_template);
+
 	/* open the performance data files */
 	xpddefault_open_host_perfdata_file();
 	xpddefault_open_service_perfdata_file();
@@ -367,6 +373,10 @@ int xpddefault_cleanup_performance_data(char *config_file) {
 	my_free(xpddefault_service_perfdata_command);
 	my_free(xpddefault_host_perfdata_file_template);
 	my_free(xpddefault_service_perfdata_file_template);
+	free_macro_tokens(xpddefault_host_perfdata_file_template_tokens);
+	free_macro_tokens(xpddefault_service_perfdata_file_template_tokens);
+	xpddefault_host_perfdata_file_template_tokens = NULL;
+	xpddefault_service_perfdata_file_template_tokens = NULL;
 	my_free(xpddefault_host_perfdata_file);
 	my_free(xpddefault_service_perfdata_file);
 	my_free(xpddefault_host_perfdata_file_processing_command);
@@ -506,7 +516,7 @@ int xpddefault_run_service_performance_data_command(icinga_macros *mac, service
 	log_debug_info(DEBUGL_PERFDATA, 2, "Raw service performance data command line: %s\n", raw_command_line);
 
 	/* process any macros in the raw command line */
-	process_macros_r(mac, raw_command_line, &processed_command_line, macro_options);
+	process_command_macros_r(mac, xpddefault_service_perfdata_command_ptr, &processed_command_line, macro_options);
 	my_free(raw_command_line);
 	if (processed_command_line == NULL)
 		return ERROR;
@@ -553,7 +563,7 @@ int xpddefault_run_host_performance_data_command(icinga_macros *mac, host *hst)
 	log_debug_info(DEBUGL_PERFDATA, 2, "Raw host performance data command line: %s\n", raw_command_line);
 
 	/* process any macros in the raw command line */
-	process_macros_r(mac, raw_command_line, &processed_command_line, macro_options);
+	process_command_macros_r(mac, xpddefault_host_perfdata_command_ptr, &processed_command_line, macro_options);
 
 	log_debug_info(DEBUGL_PERFDATA, 2, "Processed host performance data command line: %s\n", processed_command_line);
 
@@ -715,9 +725,14 @@ int xpddefault_update_service_performance_data_file(icinga_macros *mac, service
 	log_debug_info(DEBUGL_PERFDATA, 2, "Raw service performance data file output: %s\n", raw_output);
 
 	/* process any macros in the raw output line */
-	process_macros_r(mac, raw_output, &processed_output, 0);
-	if (processed_output == NULL)
+	if (xpddefault_service_perfdata_file_template_tokens != NULL)
+		process_macro_tokens_r(mac, xpddefault_service_perfdata_file_template_tokens, &processed_output, 0);
+	else
+		process_macros_r(mac, raw_output, &processed_output, 0);
+	if (processed_output == NULL) {
+		my_free(raw_output);
 		return ERROR;
+	}
 
 	log_debug_info(DEBUGL_PERFDATA, 2, "Processed service performance data file output: %s\n", processed_output);
 
@@ -757,9 +772,14 @@ int xpddefault_update_host_performance_data_file(icinga_macros *mac, host *hst)
 	log_debug_info(DEBUGL_PERFDATA, 2, "Raw host performance file output: %s\n", raw_output);
 
 	/* process any macros in the raw output */
-	process_macros_r(mac, raw_output, &processed_output, 0);
-	if (processed_output == NULL)
+	if (xpddefault_host_perfdata_file_template_tokens != NULL)
+		process_macro_tokens_r(mac, xpddefault_host_perfdata_file_template_tokens, &processed_output, 0);
+	else
+		process_macros_r(mac, raw_output, &processed_output, 0);
+	if (processed_output == NULL) {
+		my_free(raw_output);
 		return ERROR;
+	}
 
 	log_debug_info(DEBUGL_PERFDATA, 2, "Processed host performance data file output: %s\n", processed_output);
 
@@ -807,7 +827,7 @@ int xpddefault_process_host_perfdata_file(void) {
 	log_debug_info(DEBUGL_PERFDATA, 2, "Raw host performance data file processing command line: %s\n", raw_command_line);
 
 	/* process any macros in the raw command line */
-	process_macros_r(&mac, raw_command_line, &processed_command_line, macro_options);
+	process_command_macros_r(&mac, xpddefault_host_perfdata_file_processing_command_ptr, &processed_command_line, macro_options);
 	my_free(raw_command_line);
 	if (processed_command_line == NULL) {
 		clear_volatile_macros_r(&mac);
@@ -868,7 +888,7 @@ int xpddefault_process_service_perfdata_file(void) {
 	log_debug_info(DEBUGL_PERFDATA, 2, "Raw service performance data file processing command line: %s\n", raw_command_line);
 
 	/* process any macros in the raw command line */
-	process_macros_r(&mac, raw_command_line, &processed_command_line, macro_options);
+	process_command_macros_r(&mac, xpddefault_service_perfdata_file_processing_command_ptr, &processed_command_line, macro_options);
 	my_free(raw_command_line);
 	if (processed_command_line == NULL) {
 		clear_volatile_macros_r(&mac);
@@ -96,9 +96,39 @@ extern unsigned long  retained_process_service_attribute_mask;
 char *xrddefault_retention_file = NULL;
 char *xrddefault_sync_retention_file = NULL;
 char *xrddefault_temp_file = NULL;
+char *xrddefault_retention_binary_file = NULL;
+int xrddefault_binary_retention = FALSE;
+
+/* growable buffer for the records and strings of the binary retention file */
+typedef struct xrddefault_binary_buffer_struct {
+	char            *data;
+	unsigned long   size;
+	unsigned long   allocated;
+	} xrddefault_binary_buffer;
+
+/* where the current record of a host, service or contact slot lives in the mapped file */
+typedef struct xrddefault_binary_slot_struct {
+	char            *record;
+	char            *strings;
+	unsigned long   string_size;
+	xrddefault_binary_customvar *customvars;
+	unsigned long   customvar_count;
+	} xrddefault_binary_slot;
+
+static unsigned long xrddefault_binary_size = 0L;		/* size of the binary retention file we have written, 0 if there is none */
+static unsigned long xrddefault_binary_full_size = 0L;		/* size of its full save */
+static unsigned long xrddefault_binary_signature = 0L;		/* comments and downtime at the time of the full save */
+static xrddefault_binary_program xrddefault_binary_saved_program;
+static xrddefault_binary_buffer xrddefault_binary_saved_program_strings;
+
+static unsigned long xrddefault_restored_hosts = 0L;
+static unsigned long xrddefault_restored_services = 0L;
+static unsigned long xrddefault_restored_contacts = 0L;
 
 
 int xrddefault_read_retention_file_information(char*, int);
+static int xrddefault_save_binary_state_information(int);
+static int xrddefault_read_binary_retention_file(char *);
 
 /******************************************************************/
 /********************* CONFIG INITIALIZATION  *********************/
@@ -118,6 +148,7 @@ int xrddefault_grab_config_info(char *main_config_file) {
 
 		my_free(xrddefault_sync_retention_file);
 		my_free(xrddefault_retention_file);
+		my_free(xrddefault_retention_binary_file);
 		my_free(xrddefault_temp_file);
 
 		return ERROR;
@@ -158,6 +189,13 @@ int xrddefault_grab_config_info(char *main_config_file) {
 	if (xrddefault_temp_file == NULL)
 		return ERROR;
 
+	/* the binary retention file lives next to the text file */
+	my_free(xrddefault_retention_binary_file);
+	if (asprintf(&xrddefault_retention_binary_file, "%s%s", xrddefault_retention_file, XRDDEFAULT_BINARY_SUFFIX) == -1)
+		xrddefault_retention_binary_file = NULL;
+	if (xrddefault_retention_binary_file == NULL)
+		return ERROR;
+
 	/* save the retention file macro */
 	my_free(mac->x[MACRO_RETENTIONDATAFILE]);
 	if ((mac->x[MACRO_RETENTIONDATAFILE] = (char *)strdup(xrddefault_retention_file)))
@@ -201,6 +239,10 @@ int xrddefault_grab_config_directives(char *input) {
 	else if (!strcmp(varname, "temp_file"))
 		xrddefault_temp_file = (char *)strdup(varvalue);
 
+	/* binary retention file */
+	else if (!strcmp(varname, "retention_file_binary"))
+		xrddefault_binary_retention = (atoi(varvalue) > 0) ? TRUE : FALSE;
+
 	/* free memory */
 	my_free(varname);
 	my_free(varvalue);
@@ -235,7 +277,14 @@ int xrddefault_cleanup_retention_data(char *config_file) {
 	/* free memory */
 	my_free(xrddefault_sync_retention_file);
 	my_free(xrddefault_retention_file);
+	my_free(xrddefault_retention_binary_file);
 	my_free(xrddefault_temp_file);
+	my_free(xrddefault_binary_saved_program_strings.data);
+	xrddefault_binary_saved_program_strings.size = 0L;
+	xrddefault_binary_saved_program_strings.allocated = 0L;
+
+	/* the next save after a restart is a full one */
+	xrddefault_binary_size = 0L;
 
 	return OK;
 }
@@ -245,7 +294,7 @@ int xrddefault_cleanup_retention_data(char *config_file) {
 /**************** DEFAULT STATE OUTPUT FUNCTION *******************/
 /******************************************************************/
 
-int xrddefault_save_state_information(void) {
+int xrddefault_save_state_information(int autosave) {
 	char *temp_file = NULL;
 	customvariablesmember *temp_customvariablesmember = NULL;
 	time_t current_time = 0L;
@@ -278,6 +327,9 @@ int xrddefault_save_state_information(void) {
 		return ERROR;
 	}
 
+	if (xrddefault_binary_retention == TRUE)
+		return xrddefault_save_binary_state_information(autosave);
+
 	/* open a safe temp file for output */
 	dummy = asprintf(&temp_file, "%sXXXXXX", xrddefault_temp_file);
 	if (temp_file == NULL)
@@ -591,6 +643,12 @@ int xrddefault_save_state_information(void) {
 			logit(NSLOG_RUNTIME_ERROR, TRUE, "Error: Unable to update retention file '%s': %s", xrddefault_retention_file, strerror(errno));
 			result = ERROR;
 		}
+
+		/* a binary retention file from before is outdated now */
+		else if (xrddefault_retention_binary_file != NULL) {
+			unlink(xrddefault_retention_binary_file);
+			xrddefault_binary_size = 0L;
+		}
 	}
 
 	/* a problem occurred saving the file */
@@ -611,13 +669,697 @@ int xrddefault_save_state_information(void) {
 
 
 
+/******************************************************************/
+/****************** BINARY STATE OUTPUT FUNCTIONS *****************/
+/******************************************************************/
+
+/* appends data to a buffer of the binary retention file */
+static int xrddefault_append_binary_data(xrddefault_binary_buffer *buffer, void *data, unsigned long size) {
+	char *new_data = NULL;
+
+	if (buffer->size + size > buffer->allocated) {
+		if ((new_data = (char *)realloc(buffer->data, (buffer->allocated + size) * 2)) == NULL)
+			return ERROR;
+		buffer->data = new_data;
+		buffer->allocated = (buffer->allocated + size) * 2;
+	}
+
+	memcpy(buffer->data + buffer->size, data, size);
+	buffer->size += size;
+
+	return OK;
+}
+
+
+/* appends a string to a string table, empty strings are left out */
+static int xrddefault_add_binary_string(xrddefault_binary_buffer *strings, char *string, unsigned long *offset) {
+
+	*offset = XRDDEFAULT_BINARY_NONE;
+	if (string == NULL || string[0] == '\x0')
+		return OK;
+
+	*offset = strings->size;
+	return xrddefault_append_binary_data(strings, string, strlen(string) + 1);
+}
+
+
+/* pads a string table with zeros, so the records which follow it stay aligned */
+static int xrddefault_pad_binary_strings(xrddefault_binary_buffer *strings) {
+	char padding[sizeof(double)];
+
+	if (strings->size % sizeof(double) == 0L)
+		return OK;
+
+	memset(padding, 0, sizeof(padding));
+	return xrddefault_append_binary_data(strings, padding, sizeof(double) - strings->size % sizeof(double));
+}
+
+
+/* appends the modified custom variables of an object, the others are never restored */
+static int xrddefault_add_binary_customvars(xrddefault_binary_buffer *customvars, xrddefault_binary_buffer *strings, customvariablesmember *first, unsigned long *index, unsigned long *count) {
+	customvariablesmember *temp_customvariablesmember = NULL;
+	xrddefault_binary_customvar record;
+
+	*index = customvars->size / sizeof(xrddefault_binary_customvar);
+	*count = 0L;
+
+	for (temp_customvariablesmember = first; temp_customvariablesmember != NULL; temp_customvariablesmember = temp_customvariablesmember->next) {
+		if (temp_customvariablesmember->variable_name == NULL || temp_customvariablesmember->has_been_modified == FALSE)
+			continue;
+		if (xrddefault_add_binary_string(strings, temp_customvariablesmember->variable_name, &record.variable_name) == ERROR
+		        || xrddefault_add_binary_string(strings, temp_customvariablesmember->variable_value, &record.variable_value) == ERROR
+		        || xrddefault_append_binary_data(customvars, &record, sizeof(record)) == ERROR)
+			return ERROR;
+		(*count)++;
+	}
+
+	return OK;
+}
+
+
+/* fills the program state record, its strings are added first so they start the string table */
+static int xrddefault_fill_binary_program(xrddefault_binary_program *record, xrddefault_binary_buffer *strings) {
+
+	memset(record, 0, sizeof(xrddefault_binary_program));
+	if (xrddefault_add_binary_string(strings, global_host_event_handler, &record->global_host_event_handler) == ERROR
+	        || xrddefault_add_binary_string(strings, global_service_event_handler, &record->global_service_event_handler) == ERROR)
+		return ERROR;
+
+	/* NOTE: same masks as the text retention file */
+	record->modified_host_attributes = modified_host_process_attributes & ~retained_process_host_attribute_mask;
+	record->modified_service_attributes = modified_service_process_attributes & ~retained_process_host_attribute_mask;
+	record->disable_notifications_expire_time = (unsigned long)disable_notifications_expire_time;
+	record->next_comment_id = next_comment_id;
+	record->next_downtime_id = next_downtime_id;
+	record->next_event_id = next_event_id;
+	record->next_problem_id = next_problem_id;
+	record->next_notification_id = next_notification_id;
+	record->enable_notifications = enable_notifications;
+	record->execute_service_checks = execute_service_checks;
+	record->accept_passive_service_checks = accept_passive_service_checks;
+	record->execute_host_checks = execute_host_checks;
+	record->accept_passive_host_checks = accept_passive_host_checks;
+	record->enable_event_handlers = enable_event_handlers;
+	record->obsess_over_services = obsess_over_services;
+	record->obsess_over_hosts = obsess_over_hosts;
+	record->check_service_freshness = check_service_freshness;
+	record->check_host_freshness = check_host_freshness;
+	record->enable_flap_detection = enable_flap_detection;
+	record->enable_failure_prediction = enable_failure_prediction;
+	record->process_performance_data = process_performance_data;
+
+	return OK;
+}
+
+
+/* remembers the program state just saved, returns TRUE if it is the same as last time */
+static int xrddefault_binary_program_saved(xrddefault_binary_program *record, xrddefault_binary_buffer *strings, unsigned long string_size, int remember) {
+	int result = FALSE;
+
+	if (xrddefault_binary_saved_program_strings.size == string_size
+	        && !memcmp(&xrddefault_binary_saved_program, record, sizeof(xrddefault_binary_program))
+	        && (string_size == 0L || !memcmp(xrddefault_binary_saved_program_strings.data, strings->data, string_size)))
+		result = TRUE;
+
+	if (remember == TRUE && result == FALSE) {
+		memcpy(&xrddefault_binary_saved_program, record, sizeof(xrddefault_binary_program));
+		xrddefault_binary_saved_program_strings.size = 0L;
+		if (string_size > 0L && xrddefault_append_binary_data(&xrddefault_binary_saved_program_strings, strings->data, string_size) == ERROR)
+			memset(&xrddefault_binary_saved_program, 0, sizeof(xrddefault_binary_program));
+	}
+
+	return result;
+}
+
+
+/* fills the record of a host */
+static int xrddefault_fill_binary_host(xrddefault_binary_host *record, host *hst, unsigned long slot, xrddefault_binary_buffer *strings, xrddefault_binary_buffer *customvars) {
+	int x = 0;
+
+	memset(record, 0, sizeof(xrddefault_binary_host));
+	if (xrddefault_add_binary_string(strings, hst->name, &record->host_name) == ERROR
+	        || xrddefault_add_binary_string(strings, hst->host_check_command, &record->check_command) == ERROR
+	        || xrddefault_add_binary_string(strings, hst->check_period, &record->check_period) == ERROR
+	        || xrddefault_add_binary_string(strings, hst->notification_period, &record->notification_period) == ERROR
+	        || xrddefault_add_binary_string(strings, hst->event_handler, &record->event_handler) == ERROR
+	        || xrddefault_add_binary_string(strings, hst->plugin_output, &record->plugin_output) == ERROR
+	        || xrddefault_add_binary_string(strings, hst->long_plugin_output, &record->long_plugin_output) == ERROR
+	        || xrddefault_add_binary_string(strings, hst->perf_data, &record->perf_data) == ERROR
+	        || xrddefault_add_binary_customvars(customvars, strings, hst->custom_variables, &record->customvar_index, &record->customvar_count) == ERROR)
+		return ERROR;
+
+	record->slot = slot;
+	record->modified_attributes = hst->modified_attributes & ~retained_host_attribute_mask;
+	record->last_event_id = hst->last_event_id;
+	record->current_event_id = hst->current_event_id;
+	record->current_problem_id = hst->current_problem_id;
+	record->last_problem_id = hst->last_problem_id;
+	record->last_check = (unsigned long)hst->last_check;
+	record->next_check = (unsigned long)hst->next_check;
+	record->last_state_change = (unsigned long)hst->last_state_change;
+	record->last_hard_state_change = (unsigned long)hst->last_hard_state_change;
+	record->last_time_up = (unsigned long)hst->last_time_up;
+	record->last_time_down = (unsigned long)hst->last_time_down;
+	record->last_time_unreachable = (unsigned long)hst->last_time_unreachable;
+	record->last_notification = (unsigned long)hst->last_host_notification;
+	record->current_notification_id = hst->current_notification_id;
+	record->acknowledgement_end_time = (unsigned long)hst->acknowledgement_end_time;
+	record->execution_time = hst->execution_time;
+	record->latency = hst->latency;
+	record->check_interval = hst->check_interval;
+	record->retry_interval = hst->retry_interval;
+	record->percent_state_change = hst->percent_state_change;
+	record->has_been_checked = hst->has_been_checked;
+	record->check_type = hst->check_type;
+	record->current_state = hst->current_state;
+	record->last_state = hst->last_state;
+	record->last_hard_state = hst->last_hard_state;
+	record->check_options = hst->check_options;
+	record->current_attempt = hst->current_attempt;
+	record->max_attempts = hst->max_attempts;
+	record->state_type = hst->state_type;
+	record->notified_on_down = hst->notified_on_down;
+	record->notified_on_unreachable = hst->notified_on_unreachable;
+	record->current_notification_number = hst->current_notification_number;
+	record->current_down_notification_number = hst->current_down_notification_number;
+	record->current_unreachable_notification_number = hst->current_unreachable_notification_number;
+	record->notifications_enabled = hst->notifications_enabled;
+	record->problem_has_been_acknowledged = hst->problem_has_been_acknowledged;
+	record->acknowledgement_type = hst->acknowledgement_type;
+	record->checks_enabled = hst->checks_enabled;
+	record->accept_passive_host_checks = hst->accept_passive_host_checks;
+	record->event_handler_enabled = hst->event_handler_enabled;
+	record->flap_detection_enabled = hst->flap_detection_enabled;
+	record->failure_prediction_enabled = hst->failure_prediction_enabled;
+	record->process_performance_data = hst->process_performance_data;
+	record->obsess_over_host = hst->obsess_over_host;
+	record->is_flapping = hst->is_flapping;
+	record->check_flapping_recovery_notification = hst->check_flapping_recovery_notification;
+	for (x = 0; x < MAX_STATE_HISTORY_ENTRIES; x++)
+		record->state_history[x] = hst->state_history[(x + hst->state_history_index) % MAX_STATE_HISTORY_ENTRIES];
+
+	return OK;
+}
+
+
+/* fills the record of a service */
+static int xrddefault_fill_binary_service(xrddefault_binary_service *record, service *svc, unsigned long slot, xrddefault_binary_buffer *strings, xrddefault_binary_buffer *customvars) {
+	int x = 0;
+
+	memset(record, 0, sizeof(xrddefault_binary_service));
+	if (xrddefault_add_binary_string(strings, svc->host_name, &record->host_name) == ERROR
+	        || xrddefault_add_binary_string(strings, svc->description, &record->description) == ERROR
+	        || xrddefault_add_binary_string(strings, svc->service_check_command, &record->check_command) == ERROR
+	        || xrddefault_add_binary_string(strings, svc->check_period, &record->check_period) == ERROR
+	        || xrddefault_add_binary_string(strings, svc->notification_period, &record->notification_period) == ERROR
+	        || xrddefault_add_binary_string(strings, svc->event_handler, &record->event_handler) == ERROR
+	        || xrddefault_add_binary_string(strings, svc->plugin_output, &record->plugin_output) == ERROR
+	        || xrddefault_add_binary_string(strings, svc->long_plugin_output, &record->long_plugin_output) == ERROR
+	        || xrddefault_add_binary_string(strings, svc->perf_data, &record->perf_data) == ERROR
+	        || xrddefault_add_binary_customvars(customvars, strings, svc->custom_variables, &record->customvar_index, &record->customvar_count) == ERROR)
+		return ERROR;
+
+	record->slot = slot;
+	/* NOTE: same mask as the text retention file */
+	record->modified_attributes = svc->modified_attributes & ~retained_host_attribute_mask;
+	record->last_event_id = svc->last_event_id;
+	record->current_event_id = svc->current_event_id;
+	record->current_problem_id = svc->current_problem_id;
+	record->last_problem_id = svc->last_problem_id;
+	record->last_check = (unsigned long)svc->last_check;
+	record->next_check = (unsigned long)svc->next_check;
+	record->last_state_change = (unsigned long)svc->last_state_change;
+	record->last_hard_state_change = (unsigned long)svc->last_hard_state_change;
+	record->last_time_ok = (unsigned long)svc->last_time_ok;
+	record->last_time_warning = (unsigned long)svc->last_time_warning;
+	record->last_time_unknown = (unsigned long)svc->last_time_unknown;
+	record->last_time_critical = (unsigned long)svc->last_time_critical;
+	record->last_notification = (unsigned long)svc->last_notification;
+	record->current_notification_id = svc->current_notification_id;
+	record->acknowledgement_end_time = (unsigned long)svc->acknowledgement_end_time;
+	record->execution_time = svc->execution_time;
+	record->latency = svc->latency;
+	record->check_interval = svc->check_interval;
+	record->retry_interval = svc->retry_interval;
+	record->percent_state_change = svc->percent_state_change;
+	record->has_been_checked = svc->has_been_checked;
+	record->check_type = svc->check_type;
+	record->current_state = svc->current_state;
+	record->last_state = svc->last_state;
+	record->last_hard_state = svc->last_hard_state;
+	record->check_options = svc->check_options;
+	record->current_attempt = svc->current_attempt;
+	record->max_attempts = svc->max_attempts;
+	record->state_type = svc->state_type;
+	record->notified_on_unknown = svc->notified_on_unknown;
+	record->notified_on_warning = svc->notified_on_warning;
+	record->notified_on_critical = svc->notified_on_critical;
+	record->current_notification_number = svc->current_notification_number;
+	record->current_warning_notification_number = svc->current_warning_notification_number;
+	record->current_critical_notification_number = svc->current_critical_notification_number;
+	record->current_unknown_notification_number = svc->current_unknown_notification_number;
+	record->notifications_enabled = svc->notifications_enabled;
+	record->checks_enabled = svc->checks_enabled;
+	record->accept_passive_service_checks = svc->accept_passive_service_checks;
+	record->event_handler_enabled = svc->event_handler_enabled;
+	record->problem_has_been_acknowledged = svc->problem_has_been_acknowledged;
+	record->acknowledgement_type = svc->acknowledgement_type;
+	record->flap_detection_enabled = svc->flap_detection_enabled;
+	record->failure_prediction_enabled = svc->failure_prediction_enabled;
+	record->process_performance_data = svc->process_performance_data;
+	record->obsess_over_service = svc->obsess_over_service;
+	record->is_flapping = svc->is_flapping;
+	record->check_flapping_recovery_notification = svc->check_flapping_recovery_notification;
+	for (x = 0; x < MAX_STATE_HISTORY_ENTRIES; x++)
+		record->state_history[x] = svc->state_history[(x + svc->state_history_index) % MAX_STATE_HISTORY_ENTRIES];
+
+	return OK;
+}
+
+
+/* fills the record of a contact */
+static int xrddefault_fill_binary_contact(xrddefault_binary_contact *record, contact *cntct, unsigned long slot, xrddefault_binary_buffer *strings, xrddefault_binary_buffer *customvars) {
+
+	memset(record, 0, sizeof(xrddefault_binary_contact));
+	if (xrddefault_add_binary_string(strings, cntct->name, &record->contact_name) == ERROR
+	        || xrddefault_add_binary_string(strings, cntct->host_notification_period, &record->host_notification_period) == ERROR
+	        || xrddefault_add_binary_string(strings, cntct->service_notification_period, &record->service_notification_period) == ERROR
+	        || xrddefault_add_binary_customvars(customvars, strings, cntct->custom_variables, &record->customvar_index, &record->customvar_count) == ERROR)
+		return ERROR;
+
+	record->slot = slot;
+	record->modified_attributes = cntct->modified_attributes;
+	record->modified_host_attributes = cntct->modified_host_attributes & ~retained_contact_host_attribute_mask;
+	record->modified_service_attributes = cntct->modified_service_attributes & ~retained_contact_service_attribute_mask;
+	record->last_host_notification = (unsigned long)cntct->last_host_notification;
+	record->last_service_notification = (unsigned long)cntct->last_service_notification;
+	record->host_notifications_enabled = cntct->host_notifications_enabled;
+	record->service_notifications_enabled = cntct->service_notifications_enabled;
+
+	return OK;
+}
+
+
+/* cheap fingerprint of all comments and downtime, changes whenever one is added, deleted or starts/stops */
+static unsigned long xrddefault_comment_downtime_signature(void) {
+	comment *temp_comment = NULL;
+	scheduled_downtime *temp_downtime = NULL;
+	unsigned long signature = 0L;
+
+	signature = next_comment_id * 31 + next_downtime_id;
+	for (temp_comment = comment_list; temp_comment != NULL; temp_comment = temp_comment->next)
+		signature = signature * 31 + temp_comment->comment_id;
+	for (temp_downtime = scheduled_downtime_list; temp_downtime != NULL; temp_downtime = temp_downtime->next)
+		signature = signature * 31 + temp_downtime->downtime_id + temp_downtime->is_in_effect + (unsigned long)temp_downtime->trigger_time;
+
+	return signature;
+}
+
+
+/* checksum of the data following a delta header */
+static unsigned long xrddefault_binary_checksum(unsigned long checksum, char *data, unsigned long size) {
+	unsigned long x = 0L;
+
+	for (x = 0L; x < size; x++)
+		checksum = checksum * 31 + (unsigned char)data[x];
+
+	return checksum;
+}
+
+
+/* writes all retention data to a new binary retention file */
+static int xrddefault_save_binary_retention_file(void) {
+	xrddefault_binary_header header;
+	xrddefault_binary_host host_record;
+	xrddefault_binary_service service_record;
+	xrddefault_binary_contact contact_record;
+	xrddefault_binary_comment comment_record;
+	xrddefault_binary_downtime downtime_record;
+	xrddefault_binary_buffer strings = { NULL, 0L, 0L };
+	xrddefault_binary_buffer customvars = { NULL, 0L, 0L };
+	host *temp_host = NULL;
+	service *temp_service = NULL;
+	contact *temp_contact = NULL;
+	comment *temp_comment = NULL;
+	scheduled_downtime *temp_downtime = NULL;
+	unsigned long program_string_size = 0L;
+	unsigned long x = 0L;
+	char *temp_file = NULL;
+	time_t current_time;
+	int result = OK;
+	int fd = 0;
+	FILE *fp = NULL;
+
+	/* deltas can only be appended to a file which has been saved completely */
+	xrddefault_binary_size = 0L;
+
+	memset(&header, 0, sizeof(header));
+	strncpy(header.magic, XRDDEFAULT_BINARY_MAGIC, sizeof(header.magic));
+	header.version = XRDDEFAULT_BINARY_VERSION;
+	header.header_size = sizeof(xrddefault_binary_header);
+	header.delta_size = sizeof(xrddefault_binary_delta);
+	header.host_size = sizeof(xrddefault_binary_host);
+	header.service_size = sizeof(xrddefault_binary_service);
+	header.contact_size = sizeof(xrddefault_binary_contact);
+	header.comment_size = sizeof(xrddefault_binary_comment);
+	header.downtime_size = sizeof(xrddefault_binary_downtime);
+	header.customvar_size = sizeof(xrddefault_binary_customvar);
+	time(&current_time);
+	header.created = (unsigned long)current_time;
+
+	for (temp_host = host_list; temp_host != NULL; temp_host = temp_host->next)
+		header.host_count++;
+	for (temp_service = service_list; temp_service != NULL; temp_service = temp_service->next)
+		header.service_count++;
+	for (temp_contact = contact_list; temp_contact != NULL; temp_contact = temp_contact->next)
+		header.contact_count++;
+	for (temp_comment = comment_list; temp_comment != NULL; temp_comment = temp_comment->next)
+		header.comment_count++;
+	for (temp_downtime = scheduled_downtime_list; temp_downtime != NULL; temp_downtime = temp_downtime->next)
+		header.downtime_count++;
+
+	/* all records have a fixed size, only the custom variables and strings are counted while writing */
+	header.host_offset = sizeof(xrddefault_binary_header);
+	header.service_offset = header.host_offset + header.host_count * sizeof(xrddefault_binary_host);
+	header.contact_offset = header.service_offset + header.service_count * sizeof(xrddefault_binary_service);
+	header.comment_offset = header.contact_offset + header.contact_count * sizeof(xrddefault_binary_contact);
+	header.downtime_offset = header.comment_offset + header.comment_count * sizeof(xrddefault_binary_comment);
+	header.customvar_offset = header.downtime_offset + header.downtime_count * sizeof(xrddefault_binary_downtime);
+
+	/* open a safe temp file for output */
+	if (asprintf(&temp_file, "%sXXXXXX", xrddefault_temp_file) == -1)
+		temp_file = NULL;
+	if (temp_file != NULL && (fd = mkstemp(temp_file)) != -1) {
+		if ((fp = (FILE *)fdopen(fd, "w")) == NULL) {
+			close(fd);
+			unlink(temp_file);
+		}
+	}
+	if (fp == NULL) {
+		logit(NSLOG_RUNTIME_ERROR, TRUE, "Error: Unable to create temp file for writing binary retention data: %s\n", strerror(errno));
+		my_free(temp_file);
+		return ERROR;
+	}
+
+	log_debug_info(DEBUGL_RETENTIONDATA, 2, "Writing binary retention data to temp file '%s'\n", temp_file);
+
+	/* the header is written again once the string table size is known */
+	fwrite(&header, sizeof(header), 1, fp);
+
+	if (xrddefault_fill_binary_program(&header.program, &strings) == ERROR)
+		result = ERROR;
+	program_string_size = strings.size;
+
+	for (temp_host = host_list, x = 0L; temp_host != NULL && result == OK; temp_host = temp_host->next, x++) {
+		if (xrddefault_fill_binary_host(&host_record, temp_host, x, &strings, &customvars) == ERROR)
+			result = ERROR;
+		fwrite(&host_record, sizeof(host_record), 1, fp);
+		temp_host->retention_dirty = FALSE;
+	}
+
+	for (temp_service = service_list, x = 0L; temp_service != NULL && result == OK; temp_service = temp_service->next, x++) {
+		if (xrddefault_fill_binary_service(&service_record, temp_service, x, &strings, &customvars) == ERROR)
+			result = ERROR;
+		fwrite(&service_record, sizeof(service_record), 1, fp);
+		temp_service->retention_dirty = FALSE;
+	}
+
+	for (temp_contact = contact_list, x = 0L; temp_contact != NULL && result == OK; temp_contact = temp_contact->next, x++) {
+		if (xrddefault_fill_binary_contact(&contact_record, temp_contact, x, &strings, &customvars) == ERROR)
+			result = ERROR;
+		fwrite(&contact_record, sizeof(contact_record), 1, fp);
+		temp_contact->retention_dirty = FALSE;
+	}
+
+	for (temp_comment = comment_list; temp_comment != NULL && result == OK; temp_comment = temp_comment->next) {
+		memset(&comment_record, 0, sizeof(comment_record));
+		if (xrddefault_add_binary_string(&strings, temp_comment->host_name, &comment_record.host_name) == ERROR
+		        || xrddefault_add_binary_string(&strings, temp_comment->service_description, &comment_record.service_description) == ERROR
+		        || xrddefault_add_binary_string(&strings, temp_comment->author, &comment_record.author) == ERROR
+		        || xrddefault_add_binary_string(&strings, temp_comment->comment_data, &comment_record.comment_data) == ERROR)
+			result = ERROR;
+		comment_record.comment_id = temp_comment->comment_id;
+		comment_record.entry_time = (unsigned long)temp_comment->entry_time;
+		comment_record.expire_time = (unsigned long)temp_comment->expire_time;
+		comment_record.comment_type = temp_comment->comment_type;
+		comment_record.entry_type = temp_comment->entry_type;
+		comment_record.source = temp_comment->source;
+		comment_record.persistent = temp_comment->persistent;
+		comment_record.expires = temp_comment->expires;
+		fwrite(&comment_record, sizeof(comment_record), 1, fp);
+	}
+
+	for (temp_downtime = scheduled_downtime_list; temp_downtime != NULL && result == OK; temp_downtime = temp_downtime->next) {
+		memset(&downtime_record, 0, sizeof(downtime_record));
+		if (xrddefault_add_binary_string(&strings, temp_downtime->host_name, &downtime_record.host_name) == ERROR
+		        || xrddefault_add_binary_string(&strings, temp_downtime->service_description, &downtime_record.service_description) == ERROR
+		        || xrddefault_add_binary_string(&strings, temp_downtime->author, &downtime_record.author) == ERROR
+		        || xrddefault_add_binary_string(&strings, temp_downtime->comment, &downtime_record.comment) == ERROR)
+			result = ERROR;
+		downtime_record.downtime_id = temp_downtime->downtime_id;
+		downtime_record.entry_time = (unsigned long)temp_downtime->entry_time;
+		downtime_record.start_time = (unsigned long)temp_downtime->start_time;
+		downtime_record.end_time = (unsigned long)temp_downtime->end_time;
+		downtime_record.triggered_by = temp_downtime->triggered_by;
+		downtime_record.duration = temp_downtime->duration;
+		downtime_record.trigger_time = (unsigned long)temp_downtime->trigger_time;
+		downtime_record.type = temp_downtime->type;
+		downtime_record.fixed = temp_downtime->fixed;
+		downtime_record.is_in_effect = temp_downtime->is_in_effect;
+		fwrite(&downtime_record, sizeof(downtime_record), 1, fp);
+	}
+
+	if (xrddefault_pad_binary_strings(&strings) == ERROR)
+		result = ERROR;
+	header.customvar_count = customvars.size / sizeof(xrddefault_binary_customvar);
+	header.string_offset = header.customvar_offset + customvars.size;
+	header.string_size = strings.size;
+	header.size = header.string_offset + header.string_size;
+	if (customvars.size > 0L)
+		fwrite(customvars.data, customvars.size, 1, fp);
+	if (strings.size > 0L)
+		fwrite(strings.data, strings.size, 1, fp);
+
+	rewind(fp);
+	fwrite(&header, sizeof(header), 1, fp);
+
+	fflush(fp);
+	fsync(fd);
+	if (fclose(fp) != 0 || result == ERROR) {
+		unlink(temp_file);
+		logit(NSLOG_RUNTIME_ERROR, TRUE, "Error: Unable to save binary retention file: %s\n", strerror(errno));
+		result = ERROR;
+	} else if (my_rename(temp_file, xrddefault_retention_binary_file)) {
+		unlink(temp_file);
+		logit(NSLOG_RUNTIME_ERROR, TRUE, "Error: Unable to update binary retention file '%s': %s\n", xrddefault_retention_binary_file, strerror(errno));
+		result = ERROR;
+	} else {
+		xrddefault_binary_size = header.size;
+		xrddefault_binary_full_size = header.size;
+		xrddefault_binary_signature = xrddefault_comment_downtime_signature();
+		xrddefault_binary_program_saved(&header.program, &strings, program_string_size, TRUE);
+	}
+
+	my_free(strings.data);
+	my_free(customvars.data);
+	my_free(temp_file);
+
+	return result;
+}
+
+
+/* appends the changed hosts, services and contacts to the binary retention file, returns ERROR if a full save is needed instead */
+static int xrddefault_append_binary_delta(void) {
+	xrddefault_binary_delta delta;
+	xrddefault_binary_host host_record;
+	xrddefault_binary_service service_record;
+	xrddefault_binary_contact contact_record;
+	xrddefault_binary_buffer hosts = { NULL, 0L, 0L };
+	xrddefault_binary_buffer services = { NULL, 0L, 0L };
+	xrddefault_binary_buffer contacts = { NULL, 0L, 0L };
+	xrddefault_binary_buffer customvars = { NULL, 0L, 0L };
+	xrddefault_binary_buffer strings = { NULL, 0L, 0L };
+	xrddefault_binary_buffer *sections[5];
+	host *temp_host = NULL;
+	service *temp_service = NULL;
+	contact *temp_contact = NULL;
+	unsigned long total_objects = 0L;
+	unsigned long dirty_objects = 0L;
+	unsigned long program_string_size = 0L;
+	unsigned long x = 0L;
+	struct stat st;
+	time_t current_time;
+	int result = OK;
+	int fd = -1;
+	int y = 0;
+
+	/* deltas go on top of a full save made by us, comments and downtime are only saved in full */
+	if (xrddefault_binary_size == 0L || xrddefault_comment_downtime_signature() != xrddefault_binary_signature)
+		return ERROR;
+
+	/* rewrite the file once the deltas have grown to half of the full save */
+	if ((xrddefault_binary_size - xrddefault_binary_full_size) * 2 > xrddefault_binary_full_size)
+		return ERROR;
+
+	/* once most objects have changed, a full save is cheaper */
+	for (temp_host = host_list; temp_host != NULL; temp_host = temp_host->next, total_objects++) {
+		if (temp_host->retention_dirty == TRUE)
+			dirty_objects++;
+	}
+	for (temp_service = service_list; temp_service != NULL; temp_service = temp_service->next, total_objects++) {
+		if (temp_service->retention_dirty == TRUE)
+			dirty_objects++;
+	}
+	for (temp_contact = contact_list; temp_contact != NULL; temp_contact = temp_contact->next, total_objects++) {
+		if (temp_contact->retention_dirty == TRUE)
+			dirty_objects++;
+	}
+	if (dirty_objects * 2 > total_objects)
+		return ERROR;
+
+	memset(&delta, 0, sizeof(delta));
+	strncpy(delta.magic, XRDDEFAULT_BINARY_DELTA_MAGIC, sizeof(delta.magic));
+	time(&current_time);
+	delta.created = (unsigned long)current_time;
+
+	if (xrddefault_fill_binary_program(&delta.program, &strings) == ERROR) {
+		my_free(strings.data);
+		return ERROR;
+	}
+	program_string_size = strings.size;
+
+	/* nothing to save at all */
+	if (dirty_objects == 0L && xrddefault_binary_program_saved(&delta.program, &strings, program_string_size, FALSE) == TRUE) {
+		log_debug_info(DEBUGL_RETENTIONDATA, 2, "Retention data hasn't changed since the last save\n");
+		my_free(strings.data);
+		return OK;
+	}
+
+	for (temp_host = host_list, x = 0L; temp_host != NULL && result == OK; temp_host = temp_host->next, x++) {
+		if (temp_host->retention_dirty == FALSE)
+			continue;
+		if (xrddefault_fill_binary_host(&host_record, temp_host, x, &strings, &customvars) == ERROR || xrddefault_append_binary_data(&hosts, &host_record, sizeof(host_record)) == ERROR)
+			result = ERROR;
+		delta.host_count++;
+	}
+	for (temp_service = service_list, x = 0L; temp_service != NULL && result == OK; temp_service = temp_service->next, x++) {
+		if (temp_service->retention_dirty == FALSE)
+			continue;
+		if (xrddefault_fill_binary_service(&service_record, temp_service, x, &strings, &customvars) == ERROR || xrddefault_append_binary_data(&services, &service_record, sizeof(service_record)) == ERROR)
+			result = ERROR;
+		delta.service_count++;
+	}
+	for (temp_contact = contact_list, x = 0L; temp_contact != NULL && result == OK; temp_contact = temp_contact->next, x++) {
+		if (temp_contact->retention_dirty == FALSE)
+			continue;
+		if (xrddefault_fill_binary_contact(&contact_record, temp_contact, x, &strings, &customvars) == ERROR || xrddefault_append_binary_data(&contacts, &contact_record, sizeof(contact_record)) == ERROR)
+			result = ERROR;
+		delta.contact_count++;
+	}
+
+	if (result == OK && xrddefault_pad_binary_strings(&strings) == ERROR)
+		result = ERROR;
+	delta.customvar_count = customvars.size / sizeof(xrddefault_binary_customvar);
+	delta.string_size = strings.size;
+
+	sections[0] = &hosts;
+	sections[1] = &services;
+	sections[2] = &contacts;
+	sections[3] = &customvars;
+	sections[4] = &strings;
+	delta.size = sizeof(delta);
+	for (y = 0; y < 5; y++) {
+		delta.size += sections[y]->size;
+		delta.checksum = xrddefault_binary_checksum(delta.checksum, sections[y]->data, sections[y]->size);
+	}
+
+	/* append to the file only if it is still the one we have written */
+	if (result == OK) {
+		if ((fd = open(xrddefault_retention_binary_file, O_WRONLY | O_APPEND)) == -1 || fstat(fd, &st) != 0 || (unsigned long)st.st_size != xrddefault_binary_size)
+			result = ERROR;
+	}
+
+	log_debug_info(DEBUGL_RETENTIONDATA, 2, "Appending %lu changed objects to binary retention file '%s'\n", dirty_objects, xrddefault_retention_binary_file);
+
+	if (result == OK && write(fd, &delta, sizeof(delta)) != sizeof(delta))
+		result = ERROR;
+	for (y = 0; y < 5 && result == OK; y++) {
+		if (sections[y]->size > 0L && write(fd, sections[y]->data, sections[y]->size) != (ssize_t)sections[y]->size)
+			result = ERROR;
+	}
+	if (result == OK && fsync(fd) != 0)
+		result = ERROR;
+	if (fd != -1 && close(fd) != 0)
+		result = ERROR;
+
+	if (result == OK) {
+		xrddefault_binary_size += delta.size;
+		xrddefault_binary_program_saved(&delta.program, &strings, program_string_size, TRUE);
+
+		for (temp_host = host_list; temp_host != NULL; temp_host = temp_host->next)
+			temp_host->retention_dirty = FALSE;
+		for (temp_service = service_list; temp_service != NULL; temp_service = temp_service->next)
+			temp_service->retention_dirty = FALSE;
+		for (temp_contact = contact_list; temp_contact != NULL; temp_contact = temp_contact->next)
+			temp_contact->retention_dirty = FALSE;
+	}
+
+	for (y = 0; y < 5; y++)
+		my_free(sections[y]->data);
+
+	return result;
+}
+
+
+/* saves the retention data to the binary retention file */
+static int xrddefault_save_binary_state_information(int autosave) {
+
+	/* autosaves only append what has changed since the last save if they can */
+	if (autosave == TRUE && xrddefault_append_binary_delta() == OK)
+		return OK;
+
+	return xrddefault_save_binary_retention_file();
+}
+
+
+
 
 /******************************************************************/
 /***************** DEFAULT STATE INPUT FUNCTION *******************/
 /******************************************************************/
 
 int xrddefault_read_state_information(void) {
-	return xrddefault_read_retention_file_information(xrddefault_retention_file, TRUE);
+	struct stat binary_statbuf;
+	struct stat text_statbuf;
+	struct timeval tv[2];
+	char *retention_file = xrddefault_retention_file;
+	int result = ERROR;
+
+	xrddefault_restored_hosts = 0L;
+	xrddefault_restored_services = 0L;
+	xrddefault_restored_contacts = 0L;
+
+	gettimeofday(&tv[0], NULL);
+
+	/* the binary retention file is used unless the text file has been written after it */
+	if (xrddefault_retention_file != NULL && xrddefault_retention_binary_file != NULL && stat(xrddefault_retention_binary_file, &binary_statbuf) == 0) {
+		if (stat(xrddefault_retention_file, &text_statbuf) != 0 || binary_statbuf.st_mtime >= text_statbuf.st_mtime) {
+			if ((result = xrddefault_read_binary_retention_file(xrddefault_retention_binary_file)) == OK)
+				retention_file = xrddefault_retention_binary_file;
+			else
+				logit(NSLOG_RUNTIME_WARNING, TRUE, "Warning: Binary retention file '%s' is invalid, reading '%s' instead\n", xrddefault_retention_binary_file, xrddefault_retention_file);
+		}
+	}
+
+	if (result == ERROR)
+		result = xrddefault_read_retention_file_information(xrddefault_retention_file, TRUE);
+
+	if (result == OK) {
+		gettimeofday(&tv[1], NULL);
+		logit(NSLOG_PROCESS_INFO, FALSE, "已从 '%s' 恢复 %lu 个主机, %lu 个服务和 %lu 个联系人的保存状态, 用时 %.3f 秒\n", retention_file, xrddefault_restored_hosts, xrddefault_restored_services, xrddefault_restored_contacts, (double)(tv[1].tv_sec - tv[0].tv_sec) + (double)(tv[1].tv_usec - tv[0].tv_usec) / 1000000.0);
+	}
+
+	return result;
 }
 
 int xrddefault_sync_state_information(void) {
@@ -627,6 +1369,280 @@ int xrddefault_sync_state_information(void) {
 	return result;
 }
 
+/* restores the program state after its retention data has been read */
+static void xrddefault_restore_program_status(void) {
+	time_t current_time;
+
+	/* adjust modified attributes if necessary */
+	if (use_retained_program_state == FALSE) {
+		modified_host_process_attributes = MODATTR_NONE;
+		modified_service_process_attributes = MODATTR_NONE;
+	}
+
+	/* handle expiring disabled notifications */
+	if (enable_notifications == FALSE && disable_notifications_expire_time != (time_t)0) {
+		time(&current_time);
+
+		if (disable_notifications_expire_time > current_time) {
+			schedule_new_event(EVENT_EXPIRE_DISABLED_NOTIFICATIONS, TRUE, (disable_notifications_expire_time + 1), FALSE, 0, NULL, FALSE, NULL, NULL, 0);
+		} else {
+			/* re-enable everything */
+			enable_all_notifications();
+			disable_notifications_expire_time = (time_t)0;
+		}
+
+	}
+}
+
+
+/* finishes the restore of a host after its retention data has been read */
+static void xrddefault_restore_host_status(host *temp_host, int was_flapping) {
+	customvariablesmember *temp_customvariablesmember = NULL;
+	int allow_flapstart_notification = TRUE;
+	time_t current_time;
+
+	/* adjust modified attributes if necessary */
+	if (temp_host->retain_nonstatus_information == FALSE)
+		temp_host->modified_attributes = MODATTR_NONE;
+
+	/* adjust modified attributes if no custom variables have been changed */
+	if (temp_host->modified_attributes & MODATTR_CUSTOM_VARIABLE) {
+		for (temp_customvariablesmember = temp_host->custom_variables; temp_customvariablesmember != NULL; temp_customvariablesmember = temp_customvariablesmember->next) {
+			if (temp_customvariablesmember->has_been_modified == TRUE)
+				break;
+
+		}
+		if (temp_customvariablesmember == NULL)
+			temp_host->modified_attributes -= MODATTR_CUSTOM_VARIABLE;
+	}
+
+	/* calculate next possible notification time */
+	if (temp_host->current_state != HOST_UP && temp_host->last_host_notification != (time_t)0)
+		temp_host->next_host_notification = get_next_host_notification_time(temp_host, temp_host->last_host_notification);
+
+	/* ADDED 01/23/2009 adjust current check attempts if host in hard problem state (max attempts may have changed in config since restart) */
+	if (temp_host->current_state != HOST_UP && temp_host->state_type == HARD_STATE)
+		temp_host->current_attempt = temp_host->max_attempts;
+
+
+	/* ADDED 02/20/08 assume same flapping state if large install tweaks enabled */
+	if (use_large_installation_tweaks == TRUE) {
+		temp_host->is_flapping = was_flapping;
+	}
+	/* else use normal startup flap detection logic */
+	else {
+		/* host was flapping before program started */
+		/* 11/10/07 don't allow flapping notifications to go out */
+		if (was_flapping == TRUE)
+			allow_flapstart_notification = FALSE;
+		else
+			/* flapstart notifications are okay */
+			allow_flapstart_notification = TRUE;
+
+		/* check for flapping */
+		check_for_host_flapping(temp_host, FALSE, FALSE, allow_flapstart_notification);
+
+		/* host was flapping before and isn't now, so clear recovery check variable if host isn't flapping now */
+		if (was_flapping == TRUE && temp_host->is_flapping == FALSE)
+			temp_host->check_flapping_recovery_notification = FALSE;
+	}
+
+	/* handle new vars added in 2.x */
+	if (temp_host->last_hard_state_change == (time_t)0)
+		temp_host->last_hard_state_change = temp_host->last_state_change;
+
+	/* handle expiring acknowledgements */
+	if (temp_host->problem_has_been_acknowledged == TRUE && temp_host->acknowledgement_end_time != (time_t)0) {
+		time(&current_time);
+		if (temp_host->acknowledgement_end_time > current_time) {
+			schedule_new_event(EVENT_EXPIRE_ACKNOWLEDGEMENT, TRUE, (temp_host->acknowledgement_end_time + 1), FALSE, 0, NULL, FALSE, temp_host, NULL, HOST_ACKNOWLEDGEMENT);
+		} else {
+			temp_host->problem_has_been_acknowledged = FALSE;
+			temp_host->acknowledgement_type = ACKNOWLEDGEMENT_NONE;
+			temp_host->acknowledgement_end_time = (time_t)0;
+		}
+	}
+
+	/* update host status */
+	/* MF 2011-07-22: see #1742 - do not dump retained host state into
+	   neb modules, setting aggregated dumps to true. made a config option. */
+	if (dump_retained_host_service_states_to_neb == TRUE) {
+		update_host_status(temp_host, FALSE);
+	} else {
+		update_host_status(temp_host, TRUE);
+	}
+
+	xrddefault_restored_hosts++;
+}
+
+
+/* finishes the restore of a service after its retention data has been read */
+static void xrddefault_restore_service_status(service *temp_service, int was_flapping) {
+	customvariablesmember *temp_customvariablesmember = NULL;
+	int allow_flapstart_notification = TRUE;
+	time_t current_time;
+
+	/* adjust modified attributes if necessary */
+	if (temp_service->retain_nonstatus_information == FALSE)
+		temp_service->modified_attributes = MODATTR_NONE;
+
+	/* adjust modified attributes if no custom variables have been changed */
+	if (temp_service->modified_attributes & MODATTR_CUSTOM_VARIABLE) {
+		for (temp_customvariablesmember = temp_service->custom_variables; temp_customvariablesmember != NULL; temp_customvariablesmember = temp_customvariablesmember->next) {
+			if (temp_customvariablesmember->has_been_modified == TRUE)
+				break;
+
+		}
+		if (temp_customvariablesmember == NULL)
+			temp_service->modified_attributes -= MODATTR_CUSTOM_VARIABLE;
+	}
+
+	/* calculate next possible notification time */
+	if (temp_service->current_state != STATE_OK && temp_service->last_notification != (time_t)0)
+		temp_service->next_notification = get_next_service_notification_time(temp_service, temp_service->last_notification);
+
+	/* fix old vars */
+	if (temp_service->has_been_checked == FALSE && temp_service->state_type == SOFT_STATE)
+		temp_service->state_type = HARD_STATE;
+
+	/* ADDED 01/23/2009 adjust current check attempt if service is in hard problem state (max attempts may have changed in config since restart) */
+	if (temp_service->current_state != STATE_OK && temp_service->state_type == HARD_STATE)
+		temp_service->current_attempt = temp_service->max_attempts;
+
+
+	/* ADDED 02/20/08 assume same flapping state if large install tweaks enabled */
+	if (use_large_installation_tweaks == TRUE) {
+		temp_service->is_flapping = was_flapping;
+	}
+	/* else use normal startup flap detection logic */
+	else {
+		/* service was flapping before program started */
+		/* 11/10/07 don't allow flapping notifications to go out */
+		if (was_flapping == TRUE)
+			allow_flapstart_notification = FALSE;
+		else
+			/* flapstart notifications are okay */
+			allow_flapstart_notification = TRUE;
+
+		/* check for flapping */
+		check_for_service_flapping(temp_service, FALSE, allow_flapstart_notification);
+
+		/* service was flapping before and isn't now, so clear recovery check variable if service isn't flapping now */
+		if (was_flapping == TRUE && temp_service->is_flapping == FALSE)
+			temp_service->check_flapping_recovery_notification = FALSE;
+	}
+
+	/* handle new vars added in 2.x */
+	if (temp_service->last_hard_state_change == (time_t)0)
+		temp_service->last_hard_state_change = temp_service->last_state_change;
+
+	/* handle expiring acknowledgements */
+	if (temp_service->problem_has_been_acknowledged == TRUE && temp_service->acknowledgement_end_time != (time_t)0) {
+		time(&current_time);
+		if (temp_service->acknowledgement_end_time > current_time) {
+			schedule_new_event(EVENT_EXPIRE_ACKNOWLEDGEMENT, TRUE, (temp_service->acknowledgement_end_time + 1), FALSE, 0, NULL, FALSE, temp_service, NULL, SERVICE_ACKNOWLEDGEMENT);
+		} else {
+			temp_service->problem_has_been_acknowledged = FALSE;
+			temp_service->acknowledgement_type = ACKNOWLEDGEMENT_NONE;
+			temp_service->acknowledgement_end_time = (time_t)0;
+		}
+	}
+
+	/* update service status */
+	/* MF 2011-07-22: see #1742 - do not dump retained service state into
+	   neb modules, setting aggregated dumps to true. made a config option. */
+	if (dump_retained_host_service_states_to_neb == TRUE) {
+		update_service_status(temp_service, FALSE);
+	} else {
+		update_service_status(temp_service, TRUE);
+	}
+
+	xrddefault_restored_services++;
+}
+
+
+/* finishes the restore of a contact after its retention data has been read */
+static void xrddefault_restore_contact_status(contact *temp_contact) {
+	customvariablesmember *temp_customvariablesmember = NULL;
+
+	/* adjust modified attributes if necessary */
+	if (temp_contact->retain_nonstatus_information == FALSE)
+		temp_contact->modified_attributes = MODATTR_NONE;
+
+	/* adjust modified attributes if no custom variables have been changed */
+	if (temp_contact->modified_attributes & MODATTR_CUSTOM_VARIABLE) {
+		for (temp_customvariablesmember = temp_contact->custom_variables; temp_customvariablesmember != NULL; temp_customvariablesmember = temp_customvariablesmember->next) {
+			if (temp_customvariablesmember->has_been_modified == TRUE)
+				break;
+
+		}
+		if (temp_customvariablesmember == NULL)
+			temp_contact->modified_attributes -= MODATTR_CUSTOM_VARIABLE;
+	}
+
+	/* update contact status */
+	update_contact_status(temp_contact, FALSE);
+
+	xrddefault_restored_contacts++;
+}
+
+
+/* adds a retained comment and deletes it again if it has to go */
+static void xrddefault_restore_comment(int data_type, int entry_type, char *host_name, char *service_description, time_t entry_time, char *author, char *comment_data, unsigned long comment_id, int persistent, int expires, time_t expire_time, int source) {
+	host *temp_host = NULL;
+	service *temp_service = NULL;
+	int remove_comment = FALSE;
+	int ack = FALSE;
+
+	/* add the comment */
+	add_comment((data_type == XRDDEFAULT_HOSTCOMMENT_DATA) ? HOST_COMMENT : SERVICE_COMMENT, entry_type, host_name, service_description, entry_time, author, comment_data, comment_id, persistent, expires, expire_time, source);
+
+	/* delete the comment if necessary */
+	/* it seems a bit backwards to add and then immediately delete the comment, but its necessary to track comment deletions in the event broker */
+	remove_comment = FALSE;
+	/* host no longer exists */
+	if ((temp_host = find_host(host_name)) == NULL) {
+		remove_comment = TRUE;
+		/* service no longer exists */
+	} else if (data_type == XRDDEFAULT_SERVICECOMMENT_DATA && (temp_service = find_service(host_name, service_description)) == NULL) {
+		remove_comment = TRUE;
+		/* acknowledgement comments get deleted if they're not persistent and the original problem is no longer acknowledged */
+	} else if (entry_type == ACKNOWLEDGEMENT_COMMENT) {
+		ack = FALSE;
+		if (data_type == XRDDEFAULT_HOSTCOMMENT_DATA) {
+			ack = temp_host->problem_has_been_acknowledged;
+		} else {
+			ack = temp_service->problem_has_been_acknowledged;
+		}
+		if (ack == FALSE && persistent == FALSE)
+			remove_comment = TRUE;
+	}
+
+	/* non-persistent comments don't last past restarts UNLESS they're acks (see above) */
+	else if (persistent == FALSE) {
+		remove_comment = TRUE;
+	}
+
+	if (remove_comment == TRUE)
+		delete_comment((data_type == XRDDEFAULT_HOSTCOMMENT_DATA) ? HOST_COMMENT : SERVICE_COMMENT, comment_id);
+}
+
+
+/* adds a retained downtime */
+static void xrddefault_restore_downtime(int data_type, char *host_name, char *service_description, time_t entry_time, char *author, char *comment_data, time_t start_time, time_t end_time, int fixed, unsigned long triggered_by, unsigned long duration, unsigned long downtime_id, int is_in_effect, time_t trigger_time) {
+
+	/* add the downtime */
+	if (data_type == XRDDEFAULT_HOSTDOWNTIME_DATA) {
+		add_host_downtime(host_name, entry_time, author, comment_data, start_time, end_time, fixed, triggered_by, duration, downtime_id, is_in_effect, trigger_time);
+	} else {
+		add_service_downtime(host_name, service_description, entry_time, author, comment_data, start_time, end_time, fixed, triggered_by, duration, downtime_id, is_in_effect, trigger_time);
+	}
+
+	/* must register the downtime with Icinga so it can schedule it, add comments, etc. */
+	register_downtime((data_type == XRDDEFAULT_HOSTDOWNTIME_DATA) ? HOST_DOWNTIME : SERVICE_DOWNTIME, downtime_id);
+}
+
+
 int xrddefault_read_retention_file_information(char *retention_file, int overwrite_data) {
 	char *input = NULL;
 	char *inputbuf = NULL;
@@ -673,10 +1689,7 @@ int xrddefault_read_retention_file_information(char *retention_file, int overwri
 	unsigned long contact_service_attribute_mask = 0L;
 	unsigned long process_host_attribute_mask = 0L;
 	unsigned long process_service_attribute_mask = 0L;
-	int remove_comment = FALSE;
-	int ack = FALSE;
 	int was_flapping = FALSE;
-	int allow_flapstart_notification = TRUE;
 	struct timeval tv[2];
 	double runtime[2];
 	int found_directive = FALSE;
@@ -743,126 +1756,34 @@ int xrddefault_read_retention_file_information(char *retention_file, int overwri
 		else if (!strcmp(input, "hostcomment {"))
 			data_type = XRDDEFAULT_HOSTCOMMENT_DATA;
 		else if (!strcmp(input, "servicecomment {"))
-			data_type = XRDDEFAULT_SERVICECOMMENT_DATA;
-		else if (!strcmp(input, "hostdowntime {"))
-			data_type = XRDDEFAULT_HOSTDOWNTIME_DATA;
-		else if (!strcmp(input, "servicedowntime {"))
-			data_type = XRDDEFAULT_SERVICEDOWNTIME_DATA;
-		else if (!strcmp(input, "info {"))
-			data_type = XRDDEFAULT_INFO_DATA;
-		else if (!strcmp(input, "program {"))
-			data_type = XRDDEFAULT_PROGRAMSTATUS_DATA;
-
-		else if (!strcmp(input, "}")) {
-
-			switch (data_type) {
-
-			case XRDDEFAULT_INFO_DATA:
-				break;
-
-			case XRDDEFAULT_PROGRAMSTATUS_DATA:
-
-				/* adjust modified attributes if necessary */
-				if (use_retained_program_state == FALSE) {
-					modified_host_process_attributes = MODATTR_NONE;
-					modified_service_process_attributes = MODATTR_NONE;
-				}
-
-				/* handle expiring disabled notifications */
-				if (enable_notifications == FALSE && disable_notifications_expire_time != (time_t)0) {
-					time(&current_time);
-
-					if (disable_notifications_expire_time > current_time) {
-						schedule_new_event(EVENT_EXPIRE_DISABLED_NOTIFICATIONS, TRUE, (disable_notifications_expire_time + 1), FALSE, 0, NULL, FALSE, NULL, NULL, 0);
-					} else {
-						/* re-enable everything */
-						enable_all_notifications();
-						disable_notifications_expire_time = (time_t)0;
-					}
-
-				}
-
-				break;
-
-			case XRDDEFAULT_HOSTSTATUS_DATA:
-
-				if (temp_host != NULL && retain_flag) {
-
-					/* adjust modified attributes if necessary */
-					if (temp_host->retain_nonstatus_information == FALSE)
-						temp_host->modified_attributes = MODATTR_NONE;
-
-					/* adjust modified attributes if no custom variables have been changed */
-					if (temp_host->modified_attributes & MODATTR_CUSTOM_VARIABLE) {
-						for (temp_customvariablesmember = temp_host->custom_variables; temp_customvariablesmember != NULL; temp_customvariablesmember = temp_customvariablesmember->next) {
-							if (temp_customvariablesmember->has_been_modified == TRUE)
-								break;
-
-						}
-						if (temp_customvariablesmember == NULL)
-							temp_host->modified_attributes -= MODATTR_CUSTOM_VARIABLE;
-					}
-
-					/* calculate next possible notification time */
-					if (temp_host->current_state != HOST_UP && temp_host->last_host_notification != (time_t)0)
-						temp_host->next_host_notification = get_next_host_notification_time(temp_host, temp_host->last_host_notification);
-
-					/* ADDED 01/23/2009 adjust current check attempts if host in hard problem state (max attempts may have changed in config since restart) */
-					if (temp_host->current_state != HOST_UP && temp_host->state_type == HARD_STATE)
-						temp_host->current_attempt = temp_host->max_attempts;
+			data_type = XRDDEFAULT_SERVICECOMMENT_DATA;
+		else if (!strcmp(input, "hostdowntime {"))
+			data_type = XRDDEFAULT_HOSTDOWNTIME_DATA;
+		else if (!strcmp(input, "servicedowntime {"))
+			data_type = XRDDEFAULT_SERVICEDOWNTIME_DATA;
+		else if (!strcmp(input, "info {"))
+			data_type = XRDDEFAULT_INFO_DATA;
+		else if (!strcmp(input, "program {"))
+			data_type = XRDDEFAULT_PROGRAMSTATUS_DATA;
 
+		else if (!strcmp(input, "}")) {
 
-					/* ADDED 02/20/08 assume same flapping state if large install tweaks enabled */
-					if (use_large_installation_tweaks == TRUE) {
-						temp_host->is_flapping = was_flapping;
-					}
-					/* else use normal startup flap detection logic */
-					else {
-						/* host was flapping before program started */
-						/* 11/10/07 don't allow flapping notifications to go out */
-						if (was_flapping == TRUE)
-							allow_flapstart_notification = FALSE;
-						else
-							/* flapstart notifications are okay */
-							allow_flapstart_notification = TRUE;
+			switch (data_type) {
 
-						/* check for flapping */
-						check_for_host_flapping(temp_host, FALSE, FALSE, allow_flapstart_notification);
+			case XRDDEFAULT_INFO_DATA:
+				break;
 
-						/* host was flapping before and isn't now, so clear recovery check variable if host isn't flapping now */
-						if (was_flapping == TRUE && temp_host->is_flapping == FALSE)
-							temp_host->check_flapping_recovery_notification = FALSE;
-					}
+			case XRDDEFAULT_PROGRAMSTATUS_DATA:
+				xrddefault_restore_program_status();
+				break;
 
-					/* handle new vars added in 2.x */
-					if (temp_host->last_hard_state_change == (time_t)0)
-						temp_host->last_hard_state_change = temp_host->last_state_change;
-
-					/* handle expiring acknowledgements */
-					if (temp_host->problem_has_been_acknowledged == TRUE && temp_host->acknowledgement_end_time != (time_t)0) {
-						time(&current_time);
-						if (temp_host->acknowledgement_end_time > current_time) {
-							schedule_new_event(EVENT_EXPIRE_ACKNOWLEDGEMENT, TRUE, (temp_host->acknowledgement_end_time + 1), FALSE, 0, NULL, FALSE, temp_host, NULL, HOST_ACKNOWLEDGEMENT);
-						} else {
-							temp_host->problem_has_been_acknowledged = FALSE;
-							temp_host->acknowledgement_type = ACKNOWLEDGEMENT_NONE;
-							temp_host->acknowledgement_end_time = (time_t)0;
-						}
-					}
+			case XRDDEFAULT_HOSTSTATUS_DATA:
 
-					/* update host status */
-					/* MF 2011-07-22: see #1742 - do not dump retained host state into
-					   neb modules, setting aggregated dumps to true. made a config option. */
-					if (dump_retained_host_service_states_to_neb == TRUE) {
-						update_host_status(temp_host, FALSE);
-					} else {
-						update_host_status(temp_host, TRUE);
-					}
-				}
+				if (temp_host != NULL && retain_flag)
+					xrddefault_restore_host_status(temp_host, was_flapping);
 
 				/* reset vars */
 				was_flapping = FALSE;
-				allow_flapstart_notification = TRUE;
 				retain_flag = TRUE;
 
 				my_free(host_name);
@@ -872,88 +1793,11 @@ int xrddefault_read_retention_file_information(char *retention_file, int overwri
 
 			case XRDDEFAULT_SERVICESTATUS_DATA:
 
-				if (temp_service != NULL && retain_flag) {
-
-					/* adjust modified attributes if necessary */
-					if (temp_service->retain_nonstatus_information == FALSE)
-						temp_service->modified_attributes = MODATTR_NONE;
-
-					/* adjust modified attributes if no custom variables have been changed */
-					if (temp_service->modified_attributes & MODATTR_CUSTOM_VARIABLE) {
-						for (temp_customvariablesmember = temp_service->custom_variables; temp_customvariablesmember != NULL; temp_customvariablesmember = temp_customvariablesmember->next) {
-							if (temp_customvariablesmember->has_been_modified == TRUE)
-								break;
-
-						}
-						if (temp_customvariablesmember == NULL)
-							temp_service->modified_attributes -= MODATTR_CUSTOM_VARIABLE;
-					}
-
-					/* calculate next possible notification time */
-					if (temp_service->current_state != STATE_OK && temp_service->last_notification != (time_t)0)
-						temp_service->next_notification = get_next_service_notification_time(temp_service, temp_service->last_notification);
-
-					/* fix old vars */
-					if (temp_service->has_been_checked == FALSE && temp_service->state_type == SOFT_STATE)
-						temp_service->state_type = HARD_STATE;
-
-					/* ADDED 01/23/2009 adjust current check attempt if service is in hard problem state (max attempts may have changed in config since restart) */
-					if (temp_service->current_state != STATE_OK && temp_service->state_type == HARD_STATE)
-						temp_service->current_attempt = temp_service->max_attempts;
-
-
-					/* ADDED 02/20/08 assume same flapping state if large install tweaks enabled */
-					if (use_large_installation_tweaks == TRUE) {
-						temp_service->is_flapping = was_flapping;
-					}
-					/* else use normal startup flap detection logic */
-					else {
-						/* service was flapping before program started */
-						/* 11/10/07 don't allow flapping notifications to go out */
-						if (was_flapping == TRUE)
-							allow_flapstart_notification = FALSE;
-						else
-							/* flapstart notifications are okay */
-							allow_flapstart_notification = TRUE;
-
-						/* check for flapping */
-						check_for_service_flapping(temp_service, FALSE, allow_flapstart_notification);
-
-						/* service was flapping before and isn't now, so clear recovery check variable if service isn't flapping now */
-						if (was_flapping == TRUE && temp_service->is_flapping == FALSE)
-							temp_service->check_flapping_recovery_notification = FALSE;
-					}
-
-					/* handle new vars added in 2.x */
-					if (temp_service->last_hard_state_change == (time_t)0)
-						temp_service->last_hard_state_change = temp_service->last_state_change;
-
-					/* handle expiring acknowledgements */
-					if (temp_service->problem_has_been_acknowledged == TRUE && temp_service->acknowledgement_end_time != (time_t)0) {
-						time(&current_time);
-						if (temp_service->acknowledgement_end_time > current_time) {
-							schedule_new_event(EVENT_EXPIRE_ACKNOWLEDGEMENT, TRUE, (temp_service->acknowledgement_end_time + 1), FALSE, 0, NULL, FALSE, temp_service, NULL, SERVICE_ACKNOWLEDGEMENT);
-						} else {
-							temp_service->problem_has_been_acknowledged = FALSE;
-							temp_service->acknowledgement_type = ACKNOWLEDGEMENT_NONE;
-							temp_service->acknowledgement_end_time = (time_t)0;
-						}
-					}
-
-					/* update service status */
-					/* MF 2011-07-22: see #1742 - do not dump retained service state into
-					   neb modules, setting aggregated dumps to true. made a config option. */
-					if (dump_retained_host_service_states_to_neb == TRUE) {
-						update_service_status(temp_service, FALSE);
-					} else {
-						update_service_status(temp_service, TRUE);
-					}
-
-				}
+				if (temp_service != NULL && retain_flag)
+					xrddefault_restore_service_status(temp_service, was_flapping);
 
 				/* reset vars */
 				was_flapping = FALSE;
-				allow_flapstart_notification = TRUE;
 				retain_flag = TRUE;
 
 				my_free(host_name);
@@ -963,26 +1807,8 @@ int xrddefault_read_retention_file_information(char *retention_file, int overwri
 
 			case XRDDEFAULT_CONTACTSTATUS_DATA:
 
-				if (temp_contact != NULL) {
-
-					/* adjust modified attributes if necessary */
-					if (temp_contact->retain_nonstatus_information == FALSE)
-						temp_contact->modified_attributes = MODATTR_NONE;
-
-					/* adjust modified attributes if no custom variables have been changed */
-					if (temp_contact->modified_attributes & MODATTR_CUSTOM_VARIABLE) {
-						for (temp_customvariablesmember = temp_contact->custom_variables; temp_customvariablesmember != NULL; temp_customvariablesmember = temp_customvariablesmember->next) {
-							if (temp_customvariablesmember->has_been_modified == TRUE)
-								break;
-
-						}
-						if (temp_customvariablesmember == NULL)
-							temp_contact->modified_attributes -= MODATTR_CUSTOM_VARIABLE;
-					}
-
-					/* update contact status */
-					update_contact_status(temp_contact, FALSE);
-				}
+				if (temp_contact != NULL)
+					xrddefault_restore_contact_status(temp_contact);
 
 				my_free(contact_name);
 				temp_contact = NULL;
@@ -1006,43 +1832,8 @@ int xrddefault_read_retention_file_information(char *retention_file, int overwri
 					}
 				}
 
-				if (add_object == TRUE) {
-					/* add the comment */
-					add_comment((data_type == XRDDEFAULT_HOSTCOMMENT_DATA) ? HOST_COMMENT : SERVICE_COMMENT, entry_type, host_name, service_description, entry_time, author, comment_data, comment_id, persistent, expires, expire_time, source);
-
-					/* delete the comment if necessary */
-					/* it seems a bit backwards to add and then immediately delete the comment, but its necessary to track comment deletions in the event broker */
-					remove_comment = FALSE;
-					/* host no longer exists */
-					if ((temp_host = find_host(host_name)) == NULL) {
-						remove_comment = TRUE;
-						/* service no longer exists */
-					} else if (data_type == XRDDEFAULT_SERVICECOMMENT_DATA && (temp_service = find_service(host_name, service_description)) == NULL) {
-						remove_comment = TRUE;
-						/* acknowledgement comments get deleted if they're not persistent and the original problem is no longer acknowledged */
-					} else if (entry_type == ACKNOWLEDGEMENT_COMMENT) {
-						ack = FALSE;
-						if (data_type == XRDDEFAULT_HOSTCOMMENT_DATA) {
-							ack = temp_host->problem_has_been_acknowledged;
-						} else {
-							ack = temp_service->problem_has_been_acknowledged;
-						}
-						if (ack == FALSE && persistent == FALSE)
-							remove_comment = TRUE;
-					}
-
-					/* non-persistent comments don't last past restarts UNLESS they're acks (see above) */
-					else if (persistent == FALSE) {
-						remove_comment = TRUE;
-					}
-
-					if (remove_comment == TRUE)
-						delete_comment((data_type == XRDDEFAULT_HOSTCOMMENT_DATA) ? HOST_COMMENT : SERVICE_COMMENT, comment_id);
-
-					/* Reset any temporary pointers */
-					temp_host = NULL;
-					temp_service = NULL;
-				}
+				if (add_object == TRUE)
+					xrddefault_restore_comment(data_type, entry_type, host_name, service_description, entry_time, author, comment_data, comment_id, persistent, expires, expire_time, source);
 
 
 				/* free temp memory */
@@ -1081,18 +1872,8 @@ int xrddefault_read_retention_file_information(char *retention_file, int overwri
 					}
 				}
 
-				if (add_object == TRUE) {
-
-					/* add the downtime */
-					if (data_type == XRDDEFAULT_HOSTDOWNTIME_DATA) {
-						add_host_downtime(host_name, entry_time, author, comment_data, start_time, end_time, fixed, triggered_by, duration, downtime_id, is_in_effect, trigger_time);
-					} else {
-						add_service_downtime(host_name, service_description, entry_time, author, comment_data, start_time, end_time, fixed, triggered_by, duration, downtime_id, is_in_effect, trigger_time);
-					}
-
-					/* must register the downtime with Icinga so it can schedule it, add comments, etc. */
-					register_downtime((data_type == XRDDEFAULT_HOSTDOWNTIME_DATA) ? HOST_DOWNTIME : SERVICE_DOWNTIME, downtime_id);
-				}
+				if (add_object == TRUE)
+					xrddefault_restore_downtime(data_type, host_name, service_description, entry_time, author, comment_data, start_time, end_time, fixed, triggered_by, duration, downtime_id, is_in_effect, trigger_time);
 
 				/* free temp memory */
 				my_free(host_name);
@@ -1951,3 +2732,677 @@ int xrddefault_read_retention_file_information(char *retention_file, int overwri
 
 	return OK;
 }
+
+
+
+/******************************************************************/
+/****************** BINARY STATE INPUT FUNCTIONS ******************/
+/******************************************************************/
+
+/* returns a string of a binary retention file record, NULL if there is none */
+static char *xrddefault_binary_string(xrddefault_binary_slot *slot, unsigned long offset) {
+
+	if (offset == XRDDEFAULT_BINARY_NONE || offset >= slot->string_size)
+		return NULL;
+
+	return slot->strings + offset;
+}
+
+
+/* returns a copy of a string of a binary retention file record, empty if there is none */
+static char *xrddefault_binary_strdup(xrddefault_binary_slot *slot, unsigned long offset) {
+	char *temp_ptr = NULL;
+
+	if ((temp_ptr = xrddefault_binary_string(slot, offset)) == NULL)
+		temp_ptr = "";
+
+	return (char *)strdup(temp_ptr);
+}
+
+
+/* returns a copy of a retained command line if its command still exists */
+static char *xrddefault_retained_command(char *command_line) {
+	command *temp_command = NULL;
+	char *temp_buffer = NULL;
+
+	if (command_line == NULL || (temp_buffer = (char *)strdup(command_line)) == NULL)
+		return NULL;
+
+	temp_command = find_command(my_strtok(temp_buffer, "!"));
+	my_free(temp_buffer);
+	if (temp_command == NULL)
+		return NULL;
+
+	return (char *)strdup(command_line);
+}
+
+
+/* returns a copy of a retained timeperiod name if the timeperiod still exists */
+static char *xrddefault_retained_timeperiod(char *timeperiod_name) {
+
+	if (timeperiod_name == NULL || find_timeperiod(timeperiod_name) == NULL)
+		return NULL;
+
+	return (char *)strdup(timeperiod_name);
+}
+
+
+/* restores the modified custom variables of an object */
+static void xrddefault_apply_binary_customvars(customvariablesmember *first, xrddefault_binary_slot *slot, unsigned long index, unsigned long count) {
+	customvariablesmember *temp_customvariablesmember = NULL;
+	char *variable_name = NULL;
+	char *variable_value = NULL;
+	unsigned long x = 0L;
+
+	if (index > slot->customvar_count || count > slot->customvar_count - index)
+		return;
+
+	for (x = index; x < index + count; x++) {
+		if ((variable_name = xrddefault_binary_string(slot, slot->customvars[x].variable_name)) == NULL)
+			continue;
+		if ((variable_value = xrddefault_binary_string(slot, slot->customvars[x].variable_value)) == NULL)
+			continue;
+
+		for (temp_customvariablesmember = first; temp_customvariablesmember != NULL; temp_customvariablesmember = temp_customvariablesmember->next) {
+			if (!strcmp(variable_name, temp_customvariablesmember->variable_name)) {
+				my_free(temp_customvariablesmember->variable_value);
+				temp_customvariablesmember->variable_value = (char *)strdup(variable_value);
+				temp_customvariablesmember->has_been_modified = TRUE;
+				break;
+			}
+		}
+	}
+}
+
+
+/* restores the program state from a binary retention file */
+static void xrddefault_apply_binary_program(xrddefault_binary_program *record, xrddefault_binary_slot *slot) {
+	char *temp_ptr = NULL;
+
+	/* mask out attributes we don't want to retain */
+	modified_host_process_attributes = record->modified_host_attributes & ~retained_process_host_attribute_mask;
+	modified_service_process_attributes = record->modified_service_attributes & ~retained_process_host_attribute_mask;
+
+	if (use_retained_program_state == TRUE) {
+		if (modified_host_process_attributes & MODATTR_NOTIFICATIONS_ENABLED)
+			enable_notifications = (record->enable_notifications > 0) ? TRUE : FALSE;
+		disable_notifications_expire_time = (time_t)record->disable_notifications_expire_time;
+		if (modified_service_process_attributes & MODATTR_ACTIVE_CHECKS_ENABLED)
+			execute_service_checks = (record->execute_service_checks > 0) ? TRUE : FALSE;
+		if (modified_service_process_attributes & MODATTR_PASSIVE_CHECKS_ENABLED)
+			accept_passive_service_checks = (record->accept_passive_service_checks > 0) ? TRUE : FALSE;
+		if (modified_host_process_attributes & MODATTR_ACTIVE_CHECKS_ENABLED)
+			execute_host_checks = (record->execute_host_checks > 0) ? TRUE : FALSE;
+		if (modified_host_process_attributes & MODATTR_PASSIVE_CHECKS_ENABLED)
+			accept_passive_host_checks = (record->accept_passive_host_checks > 0) ? TRUE : FALSE;
+		if (modified_host_process_attributes & MODATTR_EVENT_HANDLER_ENABLED)
+			enable_event_handlers = (record->enable_event_handlers > 0) ? TRUE : FALSE;
+		if (modified_service_process_attributes & MODATTR_OBSESSIVE_HANDLER_ENABLED)
+			obsess_over_services = (record->obsess_over_services > 0) ? TRUE : FALSE;
+		if (modified_host_process_attributes & MODATTR_OBSESSIVE_HANDLER_ENABLED)
+			obsess_over_hosts = (record->obsess_over_hosts > 0) ? TRUE : FALSE;
+		if (modified_service_process_attributes & MODATTR_FRESHNESS_CHECKS_ENABLED)
+			check_service_freshness = (record->check_service_freshness > 0) ? TRUE : FALSE;
+		if (modified_host_process_attributes & MODATTR_FRESHNESS_CHECKS_ENABLED)
+			check_host_freshness = (record->check_host_freshness > 0) ? TRUE : FALSE;
+		if (modified_host_process_attributes & MODATTR_FLAP_DETECTION_ENABLED)
+			enable_flap_detection = (record->enable_flap_detection > 0) ? TRUE : FALSE;
+		if (modified_host_process_attributes & MODATTR_FAILURE_PREDICTION_ENABLED)
+			enable_failure_prediction = (record->enable_failure_prediction > 0) ? TRUE : FALSE;
+		if (modified_host_process_attributes & MODATTR_PERFORMANCE_DATA_ENABLED)
+			process_performance_data = (record->process_performance_data > 0) ? TRUE : FALSE;
+		if (modified_host_process_attributes & MODATTR_EVENT_HANDLER_COMMAND) {
+			if ((temp_ptr = xrddefault_retained_command(xrddefault_binary_string(slot, record->global_host_event_handler))) != NULL) {
+				my_free(global_host_event_handler);
+				global_host_event_handler = temp_ptr;
+			}
+		}
+		if (modified_service_process_attributes & MODATTR_EVENT_HANDLER_COMMAND) {
+			if ((temp_ptr = xrddefault_retained_command(xrddefault_binary_string(slot, record->global_service_event_handler))) != NULL) {
+				my_free(global_service_event_handler);
+				global_service_event_handler = temp_ptr;
+			}
+		}
+		next_comment_id = record->next_comment_id;
+		next_downtime_id = record->next_downtime_id;
+		next_event_id = record->next_event_id;
+		next_problem_id = record->next_problem_id;
+		next_notification_id = record->next_notification_id;
+	}
+
+	xrddefault_restore_program_status();
+}
+
+
+/* restores a host from its record in a binary retention file */
+static void xrddefault_apply_binary_host(host *temp_host, xrddefault_binary_slot *slot, int scheduling_info_is_ok) {
+	xrddefault_binary_host *record = (xrddefault_binary_host *)slot->record;
+	char *temp_ptr = NULL;
+	int was_flapping = FALSE;
+	int x = 0;
+
+	/* mask out attributes we don't want to retain */
+	temp_host->modified_attributes = record->modified_attributes & ~retained_host_attribute_mask;
+
+	if (temp_host->retain_status_information == TRUE) {
+		temp_host->has_been_checked = (record->has_been_checked > 0) ? TRUE : FALSE;
+		temp_host->execution_time = record->execution_time;
+		temp_host->latency = record->latency;
+		temp_host->check_type = record->check_type;
+		temp_host->current_state = record->current_state;
+		temp_host->last_state = record->last_state;
+		temp_host->last_hard_state = record->last_hard_state;
+		my_free(temp_host->plugin_output);
+		temp_host->plugin_output = xrddefault_binary_strdup(slot, record->plugin_output);
+		my_free(temp_host->long_plugin_output);
+		temp_host->long_plugin_output = xrddefault_binary_strdup(slot, record->long_plugin_output);
+		my_free(temp_host->perf_data);
+		temp_host->perf_data = xrddefault_binary_strdup(slot, record->perf_data);
+		temp_host->last_check = (time_t)record->last_check;
+		if (use_retained_scheduling_info == TRUE && scheduling_info_is_ok == TRUE) {
+			temp_host->next_check = (time_t)record->next_check;
+			temp_host->check_options = record->check_options;
+		}
+		temp_host->current_attempt = (record->current_attempt > 0) ? TRUE : FALSE;
+		temp_host->current_event_id = record->current_event_id;
+		temp_host->last_event_id = record->last_event_id;
+		temp_host->current_problem_id = record->current_problem_id;
+		temp_host->last_problem_id = record->last_problem_id;
+		temp_host->state_type = record->state_type;
+		temp_host->last_state_change = (time_t)record->last_state_change;
+		temp_host->last_hard_state_change = (time_t)record->last_hard_state_change;
+		temp_host->last_time_up = (time_t)record->last_time_up;
+		temp_host->last_time_down = (time_t)record->last_time_down;
+		temp_host->last_time_unreachable = (time_t)record->last_time_unreachable;
+		temp_host->notified_on_down = (record->notified_on_down > 0) ? TRUE : FALSE;
+		temp_host->notified_on_unreachable = (record->notified_on_unreachable > 0) ? TRUE : FALSE;
+		temp_host->last_host_notification = (time_t)record->last_notification;
+		temp_host->current_notification_number = record->current_notification_number;
+		temp_host->current_down_notification_number = record->current_down_notification_number;
+		temp_host->current_unreachable_notification_number = record->current_unreachable_notification_number;
+		temp_host->current_notification_id = record->current_notification_id;
+		was_flapping = record->is_flapping;
+		temp_host->percent_state_change = record->percent_state_change;
+		temp_host->check_flapping_recovery_notification = record->check_flapping_recovery_notification;
+		for (x = 0; x < MAX_STATE_HISTORY_ENTRIES; x++)
+			temp_host->state_history[x] = record->state_history[x];
+		temp_host->state_history_index = 0;
+
+		/* NOTE: like with the text retention file, non-status information is only restored together with status information */
+		if (temp_host->retain_nonstatus_information == TRUE) {
+			temp_host->problem_has_been_acknowledged = (record->problem_has_been_acknowledged > 0) ? TRUE : FALSE;
+			temp_host->acknowledgement_type = record->acknowledgement_type;
+			temp_host->acknowledgement_end_time = (time_t)record->acknowledgement_end_time;
+			if (temp_host->modified_attributes & MODATTR_NOTIFICATIONS_ENABLED)
+				temp_host->notifications_enabled = (record->notifications_enabled > 0) ? TRUE : FALSE;
+			if (temp_host->modified_attributes & MODATTR_ACTIVE_CHECKS_ENABLED)
+				temp_host->checks_enabled = (record->checks_enabled > 0) ? TRUE : FALSE;
+			if (temp_host->modified_attributes & MODATTR_PASSIVE_CHECKS_ENABLED)
+				temp_host->accept_passive_host_checks = (record->accept_passive_host_checks > 0) ? TRUE : FALSE;
+			if (temp_host->modified_attributes & MODATTR_EVENT_HANDLER_ENABLED)
+				temp_host->event_handler_enabled = (record->event_handler_enabled > 0) ? TRUE : FALSE;
+			if (temp_host->modified_attributes & MODATTR_FLAP_DETECTION_ENABLED)
+				temp_host->flap_detection_enabled = (record->flap_detection_enabled > 0) ? TRUE : FALSE;
+			if (temp_host->modified_attributes & MODATTR_FAILURE_PREDICTION_ENABLED)
+				temp_host->failure_prediction_enabled = (record->failure_prediction_enabled > 0) ? TRUE : FALSE;
+			if (temp_host->modified_attributes & MODATTR_PERFORMANCE_DATA_ENABLED)
+				temp_host->process_performance_data = (record->process_performance_data > 0) ? TRUE : FALSE;
+			if (temp_host->modified_attributes & MODATTR_OBSESSIVE_HANDLER_ENABLED)
+				temp_host->obsess_over_host = (record->obsess_over_host > 0) ? TRUE : FALSE;
+			if (temp_host->modified_attributes & MODATTR_CHECK_COMMAND) {
+				if ((temp_ptr = xrddefault_retained_command(xrddefault_binary_string(slot, record->check_command))) != NULL) {
+					my_free(temp_host->host_check_command);
+					temp_host->host_check_command = temp_ptr;
+				} else
+					temp_host->modified_attributes -= MODATTR_CHECK_COMMAND;
+			}
+			if (temp_host->modified_attributes & MODATTR_CHECK_TIMEPERIOD) {
+				if ((temp_ptr = xrddefault_retained_timeperiod(xrddefault_binary_string(slot, record->check_period))) != NULL) {
+					my_free(temp_host->check_period);
+					temp_host->check_period = temp_ptr;
+				} else
+					temp_host->modified_attributes -= MODATTR_CHECK_TIMEPERIOD;
+			}
+			if (temp_host->modified_attributes & MODATTR_NOTIFICATION_TIMEPERIOD) {
+				if ((temp_ptr = xrddefault_retained_timeperiod(xrddefault_binary_string(slot, record->notification_period))) != NULL) {
+					my_free(temp_host->notification_period);
+					temp_host->notification_period = temp_ptr;
+				} else
+					temp_host->modified_attributes -= MODATTR_NOTIFICATION_TIMEPERIOD;
+			}
+			if (temp_host->modified_attributes & MODATTR_EVENT_HANDLER_COMMAND) {
+				if ((temp_ptr = xrddefault_retained_command(xrddefault_binary_string(slot, record->event_handler))) != NULL) {
+					my_free(temp_host->event_handler);
+					temp_host->event_handler = temp_ptr;
+				} else
+					temp_host->modified_attributes -= MODATTR_EVENT_HANDLER_COMMAND;
+			}
+			if (temp_host->modified_attributes & MODATTR_NORMAL_CHECK_INTERVAL && record->check_interval >= 0)
+				temp_host->check_interval = record->check_interval;
+			if (temp_host->modified_attributes & MODATTR_RETRY_CHECK_INTERVAL && record->retry_interval >= 0)
+				temp_host->retry_interval = record->retry_interval;
+			if (temp_host->modified_attributes & MODATTR_MAX_CHECK_ATTEMPTS && record->max_attempts >= 1) {
+
+				temp_host->max_attempts = record->max_attempts;
+
+				/* adjust current attempt number if in a hard state */
+				if (temp_host->state_type == HARD_STATE && temp_host->current_state != HOST_UP && temp_host->current_attempt > 1)
+					temp_host->current_attempt = temp_host->max_attempts;
+			}
+			if (temp_host->modified_attributes & MODATTR_CUSTOM_VARIABLE)
+				xrddefault_apply_binary_customvars(temp_host->custom_variables, slot, record->customvar_index, record->customvar_count);
+		}
+	}
+
+	xrddefault_restore_host_status(temp_host, was_flapping);
+}
+
+
+/* restores a service from its record in a binary retention file */
+static void xrddefault_apply_binary_service(service *temp_service, xrddefault_binary_slot *slot, int scheduling_info_is_ok) {
+	xrddefault_binary_service *record = (xrddefault_binary_service *)slot->record;
+	char *temp_ptr = NULL;
+	int was_flapping = FALSE;
+	int x = 0;
+
+	/* mask out attributes we don't want to retain */
+	temp_service->modified_attributes = record->modified_attributes & ~retained_host_attribute_mask;
+
+	if (temp_service->retain_status_information == TRUE) {
+		temp_service->has_been_checked = (record->has_been_checked > 0) ? TRUE : FALSE;
+		temp_service->execution_time = record->execution_time;
+		temp_service->latency = record->latency;
+		temp_service->check_type = record->check_type;
+		temp_service->current_state = record->current_state;
+		temp_service->last_state = record->last_state;
+		temp_service->last_hard_state = record->last_hard_state;
+		temp_service->current_attempt = record->current_attempt;
+		temp_service->current_event_id = record->current_event_id;
+		temp_service->last_event_id = record->last_event_id;
+		temp_service->current_problem_id = record->current_problem_id;
+		temp_service->last_problem_id = record->last_problem_id;
+		temp_service->state_type = record->state_type;
+		temp_service->last_state_change = (time_t)record->last_state_change;
+		temp_service->last_hard_state_change = (time_t)record->last_hard_state_change;
+		temp_service->last_time_ok = (time_t)record->last_time_ok;
+		temp_service->last_time_warning = (time_t)record->last_time_warning;
+		temp_service->last_time_unknown = (time_t)record->last_time_unknown;
+		temp_service->last_time_critical = (time_t)record->last_time_critical;
+		my_free(temp_service->plugin_output);
+		temp_service->plugin_output = xrddefault_binary_strdup(slot, record->plugin_output);
+		my_free(temp_service->long_plugin_output);
+		temp_service->long_plugin_output = xrddefault_binary_strdup(slot, record->long_plugin_output);
+		my_free(temp_service->perf_data);
+		temp_service->perf_data = xrddefault_binary_strdup(slot, record->perf_data);
+		temp_service->last_check = (time_t)record->last_check;
+		if (use_retained_scheduling_info == TRUE && scheduling_info_is_ok == TRUE) {
+			temp_service->next_check = (time_t)record->next_check;
+			temp_service->check_options = record->check_options;
+		}
+		temp_service->notified_on_unknown = (record->notified_on_unknown > 0) ? TRUE : FALSE;
+		temp_service->notified_on_warning = (record->notified_on_warning > 0) ? TRUE : FALSE;
+		temp_service->notified_on_critical = (record->notified_on_critical > 0) ? TRUE : FALSE;
+		temp_service->current_notification_number = record->current_notification_number;
+		temp_service->current_warning_notification_number = record->current_warning_notification_number;
+		temp_service->current_critical_notification_number = record->current_critical_notification_number;
+		temp_service->current_unknown_notification_number = record->current_unknown_notification_number;
+		temp_service->current_notification_id = record->current_notification_id;
+		temp_service->last_notification = (time_t)record->last_notification;
+		was_flapping = record->is_flapping;
+		temp_service->percent_state_change = record->percent_state_change;
+		temp_service->check_flapping_recovery_notification = record->check_flapping_recovery_notification;
+		for (x = 0; x < MAX_STATE_HISTORY_ENTRIES; x++)
+			temp_service->state_history[x] = record->state_history[x];
+		temp_service->state_history_index = 0;
+
+		/* NOTE: like with the text retention file, non-status information is only restored together with status information */
+		if (temp_service->retain_nonstatus_information == TRUE) {
+			temp_service->problem_has_been_acknowledged = (record->problem_has_been_acknowledged > 0) ? TRUE : FALSE;
+			temp_service->acknowledgement_type = record->acknowledgement_type;
+			temp_service->acknowledgement_end_time = (time_t)record->acknowledgement_end_time;
+			if (temp_service->modified_attributes & MODATTR_NOTIFICATIONS_ENABLED)
+				temp_service->notifications_enabled = (record->notifications_enabled > 0) ? TRUE : FALSE;
+			if (temp_service->modified_attributes & MODATTR_ACTIVE_CHECKS_ENABLED)
+				temp_service->checks_enabled = (record->checks_enabled > 0) ? TRUE : FALSE;
+			if (temp_service->modified_attributes & MODATTR_PASSIVE_CHECKS_ENABLED)
+				temp_service->accept_passive_service_checks = (record->accept_passive_service_checks > 0) ? TRUE : FALSE;
+			if (temp_service->modified_attributes & MODATTR_EVENT_HANDLER_ENABLED)
+				temp_service->event_handler_enabled = (record->event_handler_enabled > 0) ? TRUE : FALSE;
+			if (temp_service->modified_attributes & MODATTR_FLAP_DETECTION_ENABLED)
+				temp_service->flap_detection_enabled = (record->flap_detection_enabled > 0) ? TRUE : FALSE;
+			if (temp_service->modified_attributes & MODATTR_FAILURE_PREDICTION_ENABLED)
+				temp_service->failure_prediction_enabled = (record->failure_prediction_enabled > 0) ? TRUE : FALSE;
+			if (temp_service->modified_attributes & MODATTR_PERFORMANCE_DATA_ENABLED)
+				temp_service->process_performance_data = (record->process_performance_data > 0) ? TRUE : FALSE;
+			if (temp_service->modified_attributes & MODATTR_OBSESSIVE_HANDLER_ENABLED)
+				temp_service->obsess_over_service = (record->obsess_over_service > 0) ? TRUE : FALSE;
+			if (temp_service->modified_attributes & MODATTR_CHECK_COMMAND) {
+				if ((temp_ptr = xrddefault_retained_command(xrddefault_binary_string(slot, record->check_command))) != NULL) {
+					my_free(temp_service->service_check_command);
+					temp_service->service_check_command = temp_ptr;
+				} else
+					temp_service->modified_attributes -= MODATTR_CHECK_COMMAND;
+			}
+			if (temp_service->modified_attributes & MODATTR_CHECK_TIMEPERIOD) {
+				if ((temp_ptr = xrddefault_retained_timeperiod(xrddefault_binary_string(slot, record->check_period))) != NULL) {
+					my_free(temp_service->check_period);
+					temp_service->check_period = temp_ptr;
+				} else
+					temp_service->modified_attributes -= MODATTR_CHECK_TIMEPERIOD;
+			}
+			if (temp_service->modified_attributes & MODATTR_NOTIFICATION_TIMEPERIOD) {
+				if ((temp_ptr = xrddefault_retained_timeperiod(xrddefault_binary_string(slot, record->notification_period))) != NULL) {
+					my_free(temp_service->notification_period);
+					temp_service->notification_period = temp_ptr;
+				} else
+					temp_service->modified_attributes -= MODATTR_NOTIFICATION_TIMEPERIOD;
+			}
+			if (temp_service->modified_attributes & MODATTR_EVENT_HANDLER_COMMAND) {
+				if ((temp_ptr = xrddefault_retained_command(xrddefault_binary_string(slot, record->event_handler))) != NULL) {
+					my_free(temp_service->event_handler);
+					temp_service->event_handler = temp_ptr;
+				} else
+					temp_service->modified_attributes -= MODATTR_EVENT_HANDLER_COMMAND;
+			}
+			if (temp_service->modified_attributes & MODATTR_NORMAL_CHECK_INTERVAL && record->check_interval >= 0)
+				temp_service->check_interval = record->check_interval;
+			if (temp_service->modified_attributes & MODATTR_RETRY_CHECK_INTERVAL && record->retry_interval >= 0)
+				temp_service->retry_interval = record->retry_interval;
+			if (temp_service->modified_attributes & MODATTR_MAX_CHECK_ATTEMPTS && record->max_attempts >= 1) {
+
+				temp_service->max_attempts = record->max_attempts;
+
+				/* adjust current attempt number if in a hard state */
+				if (temp_service->state_type == HARD_STATE && temp_service->current_state != STATE_OK && temp_service->current_attempt > 1)
+					temp_service->current_attempt = temp_service->max_attempts;
+			}
+			if (temp_service->modified_attributes & MODATTR_CUSTOM_VARIABLE)
+				xrddefault_apply_binary_customvars(temp_service->custom_variables, slot, record->customvar_index, record->customvar_count);
+		}
+	}
+
+	xrddefault_restore_service_status(temp_service, was_flapping);
+}
+
+
+/* restores a contact from its record in a binary retention file */
+static void xrddefault_apply_binary_contact(contact *temp_contact, xrddefault_binary_slot *slot) {
+	xrddefault_binary_contact *record = (xrddefault_binary_contact *)slot->record;
+	char *temp_ptr = NULL;
+
+	temp_contact->modified_attributes = record->modified_attributes;
+
+	/* mask out attributes we don't want to retain */
+	temp_contact->modified_host_attributes = record->modified_host_attributes & ~retained_contact_host_attribute_mask;
+	temp_contact->modified_service_attributes = record->modified_service_attributes & ~retained_contact_service_attribute_mask;
+
+	if (temp_contact->retain_status_information == TRUE) {
+		temp_contact->last_host_notification = (time_t)record->last_host_notification;
+		temp_contact->last_service_notification = (time_t)record->last_service_notification;
+
+		/* NOTE: like with the text retention file, non-status information is only restored together with status information */
+		if (temp_contact->retain_nonstatus_information == TRUE) {
+			if (temp_contact->modified_host_attributes & MODATTR_NOTIFICATION_TIMEPERIOD) {
+				if ((temp_ptr = xrddefault_retained_timeperiod(xrddefault_binary_string(slot, record->host_notification_period))) != NULL) {
+					my_free(temp_contact->host_notification_period);
+					temp_contact->host_notification_period = temp_ptr;
+				} else
+					temp_contact->modified_host_attributes -= MODATTR_NOTIFICATION_TIMEPERIOD;
+			}
+			if (temp_contact->modified_service_attributes & MODATTR_NOTIFICATION_TIMEPERIOD) {
+				if ((temp_ptr = xrddefault_retained_timeperiod(xrddefault_binary_string(slot, record->service_notification_period))) != NULL) {
+					my_free(temp_contact->service_notification_period);
+					temp_contact->service_notification_period = temp_ptr;
+				} else
+					temp_contact->modified_service_attributes -= MODATTR_NOTIFICATION_TIMEPERIOD;
+			}
+			if (temp_contact->modified_host_attributes & MODATTR_NOTIFICATIONS_ENABLED)
+				temp_contact->host_notifications_enabled = (record->host_notifications_enabled > 0) ? TRUE : FALSE;
+			if (temp_contact->modified_service_attributes & MODATTR_NOTIFICATIONS_ENABLED)
+				temp_contact->service_notifications_enabled = (record->service_notifications_enabled > 0) ? TRUE : FALSE;
+			if (temp_contact->modified_attributes & MODATTR_CUSTOM_VARIABLE)
+				xrddefault_apply_binary_customvars(temp_contact->custom_variables, slot, record->customvar_index, record->customvar_count);
+		}
+	}
+
+	xrddefault_restore_contact_status(temp_contact);
+}
+
+
+/* points the slots of a full save or delta to their records, returns ERROR if a record doesn't fit */
+static int xrddefault_set_binary_slots(xrddefault_binary_slot *slots, unsigned long slot_count, char *records, unsigned long record_count, unsigned long record_size, xrddefault_binary_slot *section) {
+	unsigned long slot = 0L;
+	unsigned long x = 0L;
+
+	for (x = 0L; x < record_count; x++) {
+		/* every record starts with its slot */
+		slot = *(unsigned long *)(records + x * record_size);
+		if (slot >= slot_count)
+			return ERROR;
+		slots[slot] = *section;
+		slots[slot].record = records + x * record_size;
+	}
+
+	return OK;
+}
+
+
+/* reads the retention data from a binary retention file, nothing is restored if the file is invalid */
+static int xrddefault_read_binary_retention_file(char *retention_file) {
+	xrddefault_binary_header *header = NULL;
+	xrddefault_binary_delta *delta = NULL;
+	xrddefault_binary_program *program = NULL;
+	xrddefault_binary_comment *comment_record = NULL;
+	xrddefault_binary_downtime *downtime_record = NULL;
+	xrddefault_binary_slot *host_slots = NULL;
+	xrddefault_binary_slot *service_slots = NULL;
+	xrddefault_binary_slot *contact_slots = NULL;
+	xrddefault_binary_slot section;
+	xrddefault_binary_slot program_section;
+	host *temp_host = NULL;
+	service *temp_service = NULL;
+	contact *temp_contact = NULL;
+	char *buf = NULL;
+	char *host_name = NULL;
+	char *service_description = NULL;
+	char *contact_name = NULL;
+	unsigned long size = 0L;
+	unsigned long position = 0L;
+	unsigned long delta_size = 0L;
+	unsigned long created = 0L;
+	unsigned long x = 0L;
+	struct stat statbuf;
+	time_t current_time;
+	int scheduling_info_is_ok = FALSE;
+	int result = OK;
+	int fd = -1;
+
+	log_debug_info(DEBUGL_FUNCTIONS, 0, "xrddefault_read_binary_retention_file() start\n");
+
+	if ((fd = open(retention_file, O_RDONLY)) == -1)
+		return ERROR;
+	if (fstat(fd, &statbuf) == -1 || statbuf.st_size < (off_t)sizeof(xrddefault_binary_header)) {
+		close(fd);
+		return ERROR;
+	}
+	size = (unsigned long)statbuf.st_size;
+	buf = mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (buf == MAP_FAILED)
+		return ERROR;
+
+	/* the file must have been written by this version with the same record layout */
+	header = (xrddefault_binary_header *)buf;
+	if (strncmp(header->magic, XRDDEFAULT_BINARY_MAGIC, sizeof(header->magic)) || header->version != XRDDEFAULT_BINARY_VERSION
+	        || header->header_size != sizeof(xrddefault_binary_header) || header->delta_size != sizeof(xrddefault_binary_delta)
+	        || header->host_size != sizeof(xrddefault_binary_host) || header->service_size != sizeof(xrddefault_binary_service)
+	        || header->contact_size != sizeof(xrddefault_binary_contact) || header->comment_size != sizeof(xrddefault_binary_comment)
+	        || header->downtime_size != sizeof(xrddefault_binary_downtime) || header->customvar_size != sizeof(xrddefault_binary_customvar)
+	        || header->host_count > size / sizeof(xrddefault_binary_host) || header->service_count > size / sizeof(xrddefault_binary_service)
+	        || header->contact_count > size / sizeof(xrddefault_binary_contact) || header->comment_count > size / sizeof(xrddefault_binary_comment)
+	        || header->downtime_count > size / sizeof(xrddefault_binary_downtime) || header->customvar_count > size / sizeof(xrddefault_binary_customvar)
+	        || header->string_size > size || header->size > size || header->host_offset != sizeof(xrddefault_binary_header)
+	        || header->service_offset != header->host_offset + header->host_count * sizeof(xrddefault_binary_host)
+	        || header->contact_offset != header->service_offset + header->service_count * sizeof(xrddefault_binary_service)
+	        || header->comment_offset != header->contact_offset + header->contact_count * sizeof(xrddefault_binary_contact)
+	        || header->downtime_offset != header->comment_offset + header->comment_count * sizeof(xrddefault_binary_comment)
+	        || header->customvar_offset != header->downtime_offset + header->downtime_count * sizeof(xrddefault_binary_downtime)
+	        || header->string_offset != header->customvar_offset + header->customvar_count * sizeof(xrddefault_binary_customvar)
+	        || header->size != header->string_offset + header->string_size
+	        || (header->string_size > 0L && buf[header->string_offset + header->string_size - 1] != '\x0')) {
+		munmap(buf, size);
+		return ERROR;
+	}
+
+	/* records of the full save */
+	section.record = NULL;
+	section.strings = buf + header->string_offset;
+	section.string_size = header->string_size;
+	section.customvars = (xrddefault_binary_customvar *)(buf + header->customvar_offset);
+	section.customvar_count = header->customvar_count;
+	program_section = section;
+	program = &header->program;
+	created = header->created;
+
+	host_slots = (xrddefault_binary_slot *)calloc(header->host_count + 1, sizeof(xrddefault_binary_slot));
+	service_slots = (xrddefault_binary_slot *)calloc(header->service_count + 1, sizeof(xrddefault_binary_slot));
+	contact_slots = (xrddefault_binary_slot *)calloc(header->contact_count + 1, sizeof(xrddefault_binary_slot));
+	if (host_slots == NULL || service_slots == NULL || contact_slots == NULL)
+		result = ERROR;
+
+	if (result == OK && (xrddefault_set_binary_slots(host_slots, header->host_count, buf + header->host_offset, header->host_count, sizeof(xrddefault_binary_host), &section) == ERROR
+	                     || xrddefault_set_binary_slots(service_slots, header->service_count, buf + header->service_offset, header->service_count, sizeof(xrddefault_binary_service), &section) == ERROR
+	                     || xrddefault_set_binary_slots(contact_slots, header->contact_count, buf + header->contact_offset, header->contact_count, sizeof(xrddefault_binary_contact), &section) == ERROR))
+		result = ERROR;
+
+	/* records of later deltas replace the ones before, a delta which was not written completely ends the file */
+	for (position = header->size; result == OK && size - position >= sizeof(xrddefault_binary_delta); position += delta->size) {
+
+		delta = (xrddefault_binary_delta *)(buf + position);
+		if (strncmp(delta->magic, XRDDEFAULT_BINARY_DELTA_MAGIC, sizeof(delta->magic)) || delta->size > size - position
+		        || delta->host_count > delta->size / sizeof(xrddefault_binary_host) || delta->service_count > delta->size / sizeof(xrddefault_binary_service)
+		        || delta->contact_count > delta->size / sizeof(xrddefault_binary_contact) || delta->customvar_count > delta->size / sizeof(xrddefault_binary_customvar)
+		        || delta->string_size > delta->size)
+			break;
+
+		delta_size = sizeof(xrddefault_binary_delta) + delta->host_count * sizeof(xrddefault_binary_host) + delta->service_count * sizeof(xrddefault_binary_service) + delta->contact_count * sizeof(xrddefault_binary_contact) + delta->customvar_count * sizeof(xrddefault_binary_customvar) + delta->string_size;
+		if (delta->size != delta_size || delta->checksum != xrddefault_binary_checksum(0L, buf + position + sizeof(xrddefault_binary_delta), delta->size - sizeof(xrddefault_binary_delta))
+		        || (delta->string_size > 0L && buf[position + delta->size - 1] != '\x0'))
+			break;
+
+		section.strings = buf + position + delta->size - delta->string_size;
+		section.string_size = delta->string_size;
+		section.customvars = (xrddefault_binary_customvar *)(section.strings - delta->customvar_count * sizeof(xrddefault_binary_customvar));
+		section.customvar_count = delta->customvar_count;
+
+		x = position + sizeof(xrddefault_binary_delta);
+		if (xrddefault_set_binary_slots(host_slots, header->host_count, buf + x, delta->host_count, sizeof(xrddefault_binary_host), &section) == ERROR)
+			result = ERROR;
+		x += delta->host_count * sizeof(xrddefault_binary_host);
+		if (xrddefault_set_binary_slots(service_slots, header->service_count, buf + x, delta->service_count, sizeof(xrddefault_binary_service), &section) == ERROR)
+			result = ERROR;
+		x += delta->service_count * sizeof(xrddefault_binary_service);
+		if (xrddefault_set_binary_slots(contact_slots, header->contact_count, buf + x, delta->contact_count, sizeof(xrddefault_binary_contact), &section) == ERROR)
+			result = ERROR;
+
+		program_section = section;
+		program = &delta->program;
+		created = delta->created;
+	}
+
+	if (result == ERROR) {
+		my_free(host_slots);
+		my_free(service_slots);
+		my_free(contact_slots);
+		munmap(buf, size);
+		return ERROR;
+	}
+
+	log_debug_info(DEBUGL_RETENTIONDATA, 2, "Restoring retention data from binary retention file '%s'\n", retention_file);
+
+	time(&current_time);
+	if (current_time - (time_t)created < retention_scheduling_horizon)
+		scheduling_info_is_ok = TRUE;
+
+	/* save that for determining freshness of checkresults on startup */
+	last_program_stop = (time_t)created;
+
+	xrddefault_apply_binary_program(program, &program_section);
+
+	/* records are in the order of the object lists unless the config has changed */
+	for (x = 0L, temp_host = host_list; x < header->host_count; x++) {
+		if (host_slots[x].record == NULL)
+			continue;
+		if ((host_name = xrddefault_binary_string(&host_slots[x], ((xrddefault_binary_host *)host_slots[x].record)->host_name)) == NULL)
+			continue;
+		if (temp_host == NULL || strcmp(temp_host->name, host_name))
+			temp_host = find_host(host_name);
+		if (temp_host == NULL)
+			continue;
+		xrddefault_apply_binary_host(temp_host, &host_slots[x], scheduling_info_is_ok);
+		temp_host = temp_host->next;
+	}
+
+	for (x = 0L, temp_service = service_list; x < header->service_count; x++) {
+		if (service_slots[x].record == NULL)
+			continue;
+		if ((host_name = xrddefault_binary_string(&service_slots[x], ((xrddefault_binary_service *)service_slots[x].record)->host_name)) == NULL)
+			continue;
+		if ((service_description = xrddefault_binary_string(&service_slots[x], ((xrddefault_binary_service *)service_slots[x].record)->description)) == NULL)
+			continue;
+		if (temp_service == NULL || strcmp(temp_service->host_name, host_name) || strcmp(temp_service->description, service_description))
+			temp_service = find_service(host_name, service_description);
+		if (temp_service == NULL)
+			continue;
+		xrddefault_apply_binary_service(temp_service, &service_slots[x], scheduling_info_is_ok);
+		temp_service = temp_service->next;
+	}
+
+	for (x = 0L, temp_contact = contact_list; x < header->contact_count; x++) {
+		if (contact_slots[x].record == NULL)
+			continue;
+		if ((contact_name = xrddefault_binary_string(&contact_slots[x], ((xrddefault_binary_contact *)contact_slots[x].record)->contact_name)) == NULL)
+			continue;
+		if (temp_contact == NULL || strcmp(temp_contact->name, contact_name))
+			temp_contact = find_contact(contact_name);
+		if (temp_contact == NULL)
+			continue;
+		xrddefault_apply_binary_contact(temp_contact, &contact_slots[x]);
+		temp_contact = temp_contact->next;
+	}
+
+	/* comments and downtime are only part of the full save */
+	section.strings = buf + header->string_offset;
+	section.string_size = header->string_size;
+
+	defer_downtime_sorting = 1;
+	defer_comment_sorting = 1;
+
+	comment_record = (xrddefault_binary_comment *)(buf + header->comment_offset);
+	for (x = 0L; x < header->comment_count; x++, comment_record++) {
+		if ((host_name = xrddefault_binary_string(&section, comment_record->host_name)) == NULL)
+			continue;
+		xrddefault_restore_comment((comment_record->comment_type == HOST_COMMENT) ? XRDDEFAULT_HOSTCOMMENT_DATA : XRDDEFAULT_SERVICECOMMENT_DATA, comment_record->entry_type, host_name, xrddefault_binary_string(&section, comment_record->service_description), (time_t)comment_record->entry_time, xrddefault_binary_string(&section, comment_record->author), xrddefault_binary_string(&section, comment_record->comment_data), comment_record->comment_id, comment_record->persistent, comment_record->expires, (time_t)comment_record->expire_time, comment_record->source);
+	}
+
+	downtime_record = (xrddefault_binary_downtime *)(buf + header->downtime_offset);
+	for (x = 0L; x < header->downtime_count; x++, downtime_record++) {
+		if ((host_name = xrddefault_binary_string(&section, downtime_record->host_name)) == NULL)
+			continue;
+		xrddefault_restore_downtime((downtime_record->type == HOST_DOWNTIME) ? XRDDEFAULT_HOSTDOWNTIME_DATA : XRDDEFAULT_SERVICEDOWNTIME_DATA, host_name, xrddefault_binary_string(&section, downtime_record->service_description), (time_t)downtime_record->entry_time, xrddefault_binary_string(&section, downtime_record->author), xrddefault_binary_string(&section, downtime_record->comment), (time_t)downtime_record->start_time, (time_t)downtime_record->end_time, downtime_record->fixed, downtime_record->triggered_by, downtime_record->duration, downtime_record->downtime_id, downtime_record->is_in_effect, (time_t)downtime_record->trigger_time);
+	}
+
+	my_free(host_slots);
+	my_free(service_slots);
+	my_free(contact_slots);
+	munmap(buf, size);
+
+	if (sort_downtime() != OK)
+		return ERROR;
+	if (sort_comments() != OK)
+		return ERROR;
+
+	log_debug_info(DEBUGL_FUNCTIONS, 0, "xrddefault_read_binary_retention_file() end\n");
+
+	return OK;
+}
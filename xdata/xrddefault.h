@@ -42,8 +42,279 @@ int xrddefault_initialize_retention_data(char *);
 int xrddefault_cleanup_retention_data(char *);
 int xrddefault_grab_config_info(char *);
 int xrddefault_grab_config_directives(char *);
-int xrddefault_save_state_information(void);        /* saves all host and service state information */
+int xrddefault_save_state_information(int);         /* saves all host and service state information */
 int xrddefault_read_state_information(void);        /* reads in initial host and service state information */
 int xrddefault_sync_state_information(void);        /* syncs in host and service state information via sync file */
 
+/*********************** BINARY RETENTION FILE *************************/
+
+/*
+ * if retention_file_binary is enabled, the retention data is saved to <state_retention_file>.bin
+ * instead of the text file. a full save starts with a header holding the program state and the
+ * offsets and counts of all sections, followed by fixed size host, service, contact, comment,
+ * downtime and custom variable records and a string table. hosts, services and contacts are
+ * written in the order of the object lists, so a restore can pair records and objects without
+ * looking up their names. autosaves append a delta with the program state and the records of
+ * the objects which have changed since the last save, records of a delta replace the record
+ * in the same slot of the full save. string offsets are relative to the string table of the
+ * full save or delta the record belongs to, custom variable indexes likewise.
+ */
+
+#define XRDDEFAULT_BINARY_MAGIC          "ICRETB"
+#define XRDDEFAULT_BINARY_DELTA_MAGIC    "ICRETD"
+#define XRDDEFAULT_BINARY_VERSION        1
+#define XRDDEFAULT_BINARY_SUFFIX         ".bin"
+#define XRDDEFAULT_BINARY_NONE           ((unsigned long)-1)
+
+typedef struct xrddefault_binary_program_struct {
+	unsigned long   modified_host_attributes;
+	unsigned long   modified_service_attributes;
+	unsigned long   disable_notifications_expire_time;
+	unsigned long   global_host_event_handler;
+	unsigned long   global_service_event_handler;
+	unsigned long   next_comment_id;
+	unsigned long   next_downtime_id;
+	unsigned long   next_event_id;
+	unsigned long   next_problem_id;
+	unsigned long   next_notification_id;
+	int             enable_notifications;
+	int             execute_service_checks;
+	int             accept_passive_service_checks;
+	int             execute_host_checks;
+	int             accept_passive_host_checks;
+	int             enable_event_handlers;
+	int             obsess_over_services;
+	int             obsess_over_hosts;
+	int             check_service_freshness;
+	int             check_host_freshness;
+	int             enable_flap_detection;
+	int             enable_failure_prediction;
+	int             process_performance_data;
+	} xrddefault_binary_program;
+
+typedef struct xrddefault_binary_header_struct {
+	char            magic[8];
+	unsigned int    version;
+	unsigned int    header_size;
+	unsigned int    delta_size;
+	unsigned int    host_size;
+	unsigned int    service_size;
+	unsigned int    contact_size;
+	unsigned int    comment_size;
+	unsigned int    downtime_size;
+	unsigned int    customvar_size;
+	unsigned long   created;
+	xrddefault_binary_program program;
+
+	/* object index */
+	unsigned long   host_offset;
+	unsigned long   host_count;
+	unsigned long   service_offset;
+	unsigned long   service_count;
+	unsigned long   contact_offset;
+	unsigned long   contact_count;
+	unsigned long   comment_offset;
+	unsigned long   comment_count;
+	unsigned long   downtime_offset;
+	unsigned long   downtime_count;
+	unsigned long   customvar_offset;
+	unsigned long   customvar_count;
+	unsigned long   string_offset;
+	unsigned long   string_size;
+	unsigned long   size;			/* end of the full save, deltas follow */
+	} xrddefault_binary_header;
+
+/* a delta is followed by its host, service, contact and custom variable records and its strings */
+typedef struct xrddefault_binary_delta_struct {
+	char            magic[8];
+	unsigned long   created;
+	xrddefault_binary_program program;
+	unsigned long   host_count;
+	unsigned long   service_count;
+	unsigned long   contact_count;
+	unsigned long   customvar_count;
+	unsigned long   string_size;
+	unsigned long   size;			/* size of the delta including this header */
+	unsigned long   checksum;		/* of everything after this header */
+	} xrddefault_binary_delta;
+
+typedef struct xrddefault_binary_customvar_struct {
+	unsigned long   variable_name;
+	unsigned long   variable_value;
+	} xrddefault_binary_customvar;
+
+typedef struct xrddefault_binary_host_struct {
+	unsigned long   slot;
+	unsigned long   host_name;
+	unsigned long   modified_attributes;
+	unsigned long   check_command;
+	unsigned long   check_period;
+	unsigned long   notification_period;
+	unsigned long   event_handler;
+	unsigned long   plugin_output;
+	unsigned long   long_plugin_output;
+	unsigned long   perf_data;
+	unsigned long   last_event_id;
+	unsigned long   current_event_id;
+	unsigned long   current_problem_id;
+	unsigned long   last_problem_id;
+	unsigned long   last_check;
+	unsigned long   next_check;
+	unsigned long   last_state_change;
+	unsigned long   last_hard_state_change;
+	unsigned long   last_time_up;
+	unsigned long   last_time_down;
+	unsigned long   last_time_unreachable;
+	unsigned long   last_notification;
+	unsigned long   current_notification_id;
+	unsigned long   acknowledgement_end_time;
+	unsigned long   customvar_index;	/* modified custom variables only */
+	unsigned long   customvar_count;
+	double          execution_time;
+	double          latency;
+	double          check_interval;
+	double          retry_interval;
+	double          percent_state_change;
+	int             has_been_checked;
+	int             check_type;
+	int             current_state;
+	int             last_state;
+	int             last_hard_state;
+	int             check_options;
+	int             current_attempt;
+	int             max_attempts;
+	int             state_type;
+	int             notified_on_down;
+	int             notified_on_unreachable;
+	int             current_notification_number;
+	int             current_down_notification_number;
+	int             current_unreachable_notification_number;
+	int             notifications_enabled;
+	int             problem_has_been_acknowledged;
+	int             acknowledgement_type;
+	int             checks_enabled;
+	int             accept_passive_host_checks;
+	int             event_handler_enabled;
+	int             flap_detection_enabled;
+	int             failure_prediction_enabled;
+	int             process_performance_data;
+	int             obsess_over_host;
+	int             is_flapping;
+	int             check_flapping_recovery_notification;
+	int             state_history[MAX_STATE_HISTORY_ENTRIES];
+	} xrddefault_binary_host;
+
+typedef struct xrddefault_binary_service_struct {
+	unsigned long   slot;
+	unsigned long   host_name;
+	unsigned long   description;
+	unsigned long   modified_attributes;
+	unsigned long   check_command;
+	unsigned long   check_period;
+	unsigned long   notification_period;
+	unsigned long   event_handler;
+	unsigned long   plugin_output;
+	unsigned long   long_plugin_output;
+	unsigned long   perf_data;
+	unsigned long   last_event_id;
+	unsigned long   current_event_id;
+	unsigned long   current_problem_id;
+	unsigned long   last_problem_id;
+	unsigned long   last_check;
+	unsigned long   next_check;
+	unsigned long   last_state_change;
+	unsigned long   last_hard_state_change;
+	unsigned long   last_time_ok;
+	unsigned long   last_time_warning;
+	unsigned long   last_time_unknown;
+	unsigned long   last_time_critical;
+	unsigned long   last_notification;
+	unsigned long   current_notification_id;
+	unsigned long   acknowledgement_end_time;
+	unsigned long   customvar_index;
+	unsigned long   customvar_count;
+	double          execution_time;
+	double          latency;
+	double          check_interval;
+	double          retry_interval;
+	double          percent_state_change;
+	int             has_been_checked;
+	int             check_type;
+	int             current_state;
+	int             last_state;
+	int             last_hard_state;
+	int             check_options;
+	int             current_attempt;
+	int             max_attempts;
+	int             state_type;
+	int             notified_on_unknown;
+	int             notified_on_warning;
+	int             notified_on_critical;
+	int             current_notification_number;
+	int             current_warning_notification_number;
+	int             current_critical_notification_number;
+	int             current_unknown_notification_number;
+	int             notifications_enabled;
+	int             checks_enabled;
+	int             accept_passive_service_checks;
+	int             event_handler_enabled;
+	int             problem_has_been_acknowledged;
+	int             acknowledgement_type;
+	int             flap_detection_enabled;
+	int             failure_prediction_enabled;
+	int             process_performance_data;
+	int             obsess_over_service;
+	int             is_flapping;
+	int             check_flapping_recovery_notification;
+	int             state_history[MAX_STATE_HISTORY_ENTRIES];
+	} xrddefault_binary_service;
+
+typedef struct xrddefault_binary_contact_struct {
+	unsigned long   slot;
+	unsigned long   contact_name;
+	unsigned long   modified_attributes;
+	unsigned long   modified_host_attributes;
+	unsigned long   modified_service_attributes;
+	unsigned long   host_notification_period;
+	unsigned long   service_notification_period;
+	unsigned long   last_host_notification;
+	unsigned long   last_service_notification;
+	unsigned long   customvar_index;
+	unsigned long   customvar_count;
+	int             host_notifications_enabled;
+	int             service_notifications_enabled;
+	} xrddefault_binary_contact;
+
+typedef struct xrddefault_binary_comment_struct {
+	unsigned long   host_name;
+	unsigned long   service_description;
+	unsigned long   author;
+	unsigned long   comment_data;
+	unsigned long   comment_id;
+	unsigned long   entry_time;
+	unsigned long   expire_time;
+	int             comment_type;
+	int             entry_type;
+	int             source;
+	int             persistent;
+	int             expires;
+	} xrddefault_binary_comment;
+
+typedef struct xrddefault_binary_downtime_struct {
+	unsigned long   host_name;
+	unsigned long   service_description;
+	unsigned long   author;
+	unsigned long   comment;
+	unsigned long   downtime_id;
+	unsigned long   entry_time;
+	unsigned long   start_time;
+	unsigned long   end_time;
+	unsigned long   triggered_by;
+	unsigned long   duration;
+	unsigned long   trigger_time;
+	int             type;
+	int             fixed;
+	int             is_in_effect;
+	} xrddefault_binary_downtime;
+
 #endif
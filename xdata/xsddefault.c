@@ -131,6 +131,9 @@ extern char           *global_host_event_handler;
 extern char           *global_service_event_handler;
 
 extern check_stats    check_statistics[MAX_CHECK_STATS_TYPES];
+extern unsigned long  check_result_channel_stats[CHECK_RESULT_CHANNELS];
+extern async_command_stats async_command_statistics;
+extern check_result_queue check_result_list;
 /* make sure gcc3 won't hit here */
 #ifndef GCCTOOOLD
 extern int event_profiling_enabled;
@@ -139,7 +142,18 @@ extern int event_profiling_enabled;
 
 
 char *xsddefault_status_log = NULL;
+char *xsddefault_status_delta_log = NULL;
+char *xsddefault_status_binary_log = NULL;
 char *xsddefault_temp_file = NULL;
+int xsddefault_delta_updates = 0;
+int xsddefault_binary_status = FALSE;
+
+#ifdef NSCORE
+static char xsddefault_delta_generation[MAX_INPUT_BUFFER] = "";
+static unsigned long xsddefault_full_updates = 0L;
+static unsigned long xsddefault_delta_signature = 0L;
+static int xsddefault_deltas_written = 0;
+#endif
 
 
 
@@ -158,6 +172,9 @@ int xsddefault_grab_config_info(char *config_file) {
 
 	/*** CORE PASSES IN MAIN CONFIG FILE, CGIS PASS IN CGI CONFIG FILE! ***/
 
+	xsddefault_delta_updates = 0;
+	xsddefault_binary_status = FALSE;
+
 	/* open the config file for reading */
 	if ((thefile = mmap_fopen(config_file)) == NULL)
 		return ERROR;
@@ -195,6 +212,16 @@ int xsddefault_grab_config_info(char *config_file) {
 	/* make sure we have what we need */
 	if (xsddefault_status_log == NULL)
 		return ERROR;
+
+	/* deltas are appended next to the status file */
+	my_free(xsddefault_status_delta_log);
+	if (asprintf(&xsddefault_status_delta_log, "%s.delta", xsddefault_status_log) == -1)
+		return ERROR;
+
+	/* so is the binary snapshot */
+	my_free(xsddefault_status_binary_log);
+	if (asprintf(&xsddefault_status_binary_log, "%s.bin", xsddefault_status_log) == -1)
+		return ERROR;
 	if (xsddefault_temp_file == NULL)
 		return ERROR;
 
@@ -241,6 +268,14 @@ int xsddefault_grab_config_directives(char *input) {
 	else if (!strcmp(varname, "temp_file"))
 		xsddefault_temp_file = (char *)strdup(temp_ptr);
 
+	/* number of delta updates between full status file updates */
+	else if (!strcmp(varname, "status_file_delta_updates"))
+		xsddefault_delta_updates = atoi(temp_ptr);
+
+	/* binary status snapshot for the CGIs */
+	else if (!strcmp(varname, "status_file_binary"))
+		xsddefault_binary_status = (atoi(temp_ptr) > 0) ? TRUE : FALSE;
+
 	/* free memory */
 	my_free(varname);
 	my_free(varvalue);
@@ -266,9 +301,16 @@ int xsddefault_initialize_status_data(char *config_file) {
 	if (result == ERROR)
 		return ERROR;
 
-	/* delete the old status log (it might not exist) */
+	/* the first update after a (re)start writes a full status file */
+	xsddefault_delta_generation[0] = '\x0';
+
+	/* delete the old status log, its deltas and binary snapshot (they might not exist) */
 	if (xsddefault_status_log)
 		unlink(xsddefault_status_log);
+	if (xsddefault_status_delta_log)
+		unlink(xsddefault_status_delta_log);
+	if (xsddefault_status_binary_log)
+		unlink(xsddefault_status_binary_log);
 
 	return OK;
 }
@@ -279,12 +321,18 @@ int xsddefault_cleanup_status_data(char *config_file, int delete_status_data) {
 
 	/* delete the status log */
 	if (delete_status_data == TRUE && xsddefault_status_log) {
+		if (xsddefault_status_delta_log)
+			unlink(xsddefault_status_delta_log);
+		if (xsddefault_status_binary_log)
+			unlink(xsddefault_status_binary_log);
 		if (unlink(xsddefault_status_log))
 			return ERROR;
 	}
 
 	/* free memory */
 	my_free(xsddefault_status_log);
+	my_free(xsddefault_status_delta_log);
+	my_free(xsddefault_status_binary_log);
 	my_free(xsddefault_temp_file);
 
 	return OK;
@@ -295,69 +343,15 @@ int xsddefault_cleanup_status_data(char *config_file, int delete_status_data) {
 /****************** STATUS DATA OUTPUT FUNCTIONS ******************/
 /******************************************************************/
 
-/* write all status data to file */
-int xsddefault_save_status_data(void) {
-	char *temp_file = NULL;
-	customvariablesmember *temp_customvariablesmember = NULL;
-	host *temp_host = NULL;
-	service *temp_service = NULL;
-	contact *temp_contact = NULL;
-	comment *temp_comment = NULL;
-	scheduled_downtime *temp_downtime = NULL;
-	time_t current_time;
-	int fd = 0;
-	int dummy; /* reduce compiler warnings */
-	FILE *fp = NULL;
+/* writes the program status block */
+static void xsddefault_write_program_status(FILE *fp) {
 	int used_external_command_buffer_slots = 0;
 	int high_external_command_buffer_slots = 0;
-	int result = OK;
-
-	log_debug_info(DEBUGL_FUNCTIONS, 0, "save_status_data()\n");
-
-	/* if this is set to /dev/null, skip it */
-	if (!xsddefault_status_log || !strcmp(xsddefault_status_log, "/dev/null"))
-		return OK;
-
-	/* open a safe temp file for output */
-	if (xsddefault_temp_file == NULL)
-		return ERROR;
-	dummy = asprintf(&temp_file, "%sXXXXXX", xsddefault_temp_file);
-	if (temp_file == NULL)
-		return ERROR;
-
-	log_debug_info(DEBUGL_STATUSDATA, 2, "Writing status data to temp file '%s'\n", temp_file);
-
-	if ((fd = mkstemp(temp_file)) == -1) {
-
-		/* log an error */
-		logit(NSLOG_RUNTIME_ERROR, TRUE, "Error: Unable to create temp file '%s' for writing status data: %s\n", temp_file, strerror(errno));
-
-		/* free memory */
-		my_free(temp_file);
-
-		return ERROR;
-	}
-	fp = (FILE *)fdopen(fd, "w");
-	if (fp == NULL) {
-
-		close(fd);
-		unlink(temp_file);
-
-		/* log an error */
-		logit(NSLOG_RUNTIME_ERROR, TRUE, "Error: Unable to open temp file '%s' for writing status data: %s\n", temp_file, strerror(errno));
-
-		/* free memory */
-		my_free(temp_file);
-
-		return ERROR;
-	}
 
 	/* get number of items in the command buffer */
 	if (check_external_commands == TRUE) {
-		pthread_mutex_lock(&external_command_buffer.buffer_lock);
-		used_external_command_buffer_slots = external_command_buffer.items;
+		used_external_command_buffer_slots = get_external_command_buffer_items();
 		high_external_command_buffer_slots = external_command_buffer.high;
-		pthread_mutex_unlock(&external_command_buffer.buffer_lock);
 	} else {
 		used_external_command_buffer_slots = 0;
 		high_external_command_buffer_slots = 0;
@@ -366,23 +360,6 @@ int xsddefault_save_status_data(void) {
 	/* generate check statistics */
 	generate_check_stats();
 
-	/* write version info to status file */
-	fprintf(fp, "########################################\n");
-	fprintf(fp, "#          %s STATUS FILE\n", PROGRAM_NAME_UC);
-	fprintf(fp, "#\n");
-	fprintf(fp, "# THIS FILE IS AUTOMATICALLY GENERATED\n");
-	fprintf(fp, "# BY %s.  DO NOT MODIFY THIS FILE!\n", PROGRAM_NAME_UC);
-	fprintf(fp, "########################################\n\n");
-
-	time(&current_time);
-
-	/* write file info */
-	fprintf(fp, "info {\n");
-	fprintf(fp, "\tcreated=%lu\n", current_time);
-	fprintf(fp, "\tversion=%s\n", PROGRAM_VERSION);
-	fprintf(fp, "\t}\n\n");
-
-	/* save program status data */
 	fprintf(fp, "programstatus {\n");
 	fprintf(fp, "\tmodified_host_attributes=%lu\n", modified_host_process_attributes);
 	fprintf(fp, "\tmodified_service_attributes=%lu\n", modified_service_process_attributes);
@@ -415,6 +392,8 @@ int xsddefault_save_status_data(void) {
 	fprintf(fp, "\ttotal_external_command_buffer_slots=%d\n", external_command_buffer_slots);
 	fprintf(fp, "\tused_external_command_buffer_slots=%d\n", used_external_command_buffer_slots);
 	fprintf(fp, "\thigh_external_command_buffer_slots=%d\n", high_external_command_buffer_slots);
+	fprintf(fp, "\tcheck_result_list_length=%u\n", check_result_list.heap.count);
+	fprintf(fp, "\thigh_check_result_list_length=%u\n", check_result_list.high);
 	fprintf(fp, "\tactive_scheduled_host_check_stats=%d,%d,%d\n", check_statistics[ACTIVE_SCHEDULED_HOST_CHECK_STATS].minute_stats[0], check_statistics[ACTIVE_SCHEDULED_HOST_CHECK_STATS].minute_stats[1], check_statistics[ACTIVE_SCHEDULED_HOST_CHECK_STATS].minute_stats[2]);
 	fprintf(fp, "\tactive_ondemand_host_check_stats=%d,%d,%d\n", check_statistics[ACTIVE_ONDEMAND_HOST_CHECK_STATS].minute_stats[0], check_statistics[ACTIVE_ONDEMAND_HOST_CHECK_STATS].minute_stats[1], check_statistics[ACTIVE_ONDEMAND_HOST_CHECK_STATS].minute_stats[2]);
 	fprintf(fp, "\tpassive_host_check_stats=%d,%d,%d\n", check_statistics[PASSIVE_HOST_CHECK_STATS].minute_stats[0], check_statistics[PASSIVE_HOST_CHECK_STATS].minute_stats[1], check_statistics[PASSIVE_HOST_CHECK_STATS].minute_stats[2]);
@@ -427,6 +406,17 @@ int xsddefault_save_status_data(void) {
 
 	fprintf(fp, "\tparallel_host_check_stats=%d,%d,%d\n", check_statistics[PARALLEL_HOST_CHECK_STATS].minute_stats[0], check_statistics[PARALLEL_HOST_CHECK_STATS].minute_stats[1], check_statistics[PARALLEL_HOST_CHECK_STATS].minute_stats[2]);
 	fprintf(fp, "\tserial_host_check_stats=%d,%d,%d\n", check_statistics[SERIAL_HOST_CHECK_STATS].minute_stats[0], check_statistics[SERIAL_HOST_CHECK_STATS].minute_stats[1], check_statistics[SERIAL_HOST_CHECK_STATS].minute_stats[2]);
+	fprintf(fp, "\tspool_check_results=%lu\n", check_result_channel_stats[CHECK_RESULT_CHANNEL_SPOOL]);
+	fprintf(fp, "\tpipe_check_results=%lu\n", check_result_channel_stats[CHECK_RESULT_CHANNEL_PIPE]);
+	fprintf(fp, "\tworker_check_results=%lu\n", check_result_channel_stats[CHECK_RESULT_CHANNEL_WORKER]);
+	fprintf(fp, "\texternal_command_check_results=%lu\n", check_result_channel_stats[CHECK_RESULT_CHANNEL_EXTCMD]);
+	fprintf(fp, "\tqueued_async_commands=%d\n", async_command_statistics.queued);
+	fprintf(fp, "\trunning_async_commands=%d\n", async_command_statistics.running);
+	fprintf(fp, "\thigh_queued_async_commands=%d\n", async_command_statistics.max_queued);
+	fprintf(fp, "\tcompleted_async_commands=%lu\n", async_command_statistics.completed);
+	fprintf(fp, "\ttimed_out_async_commands=%lu\n", async_command_statistics.timed_out);
+	fprintf(fp, "\tasync_command_queue_latency=%.3f,%.3f\n", (async_command_statistics.completed > 0) ? async_command_statistics.total_queue_latency / (double)async_command_statistics.completed : 0.0, async_command_statistics.max_queue_latency);
+	fprintf(fp, "\tasync_command_execution_time=%.3f\n", (async_command_statistics.completed > 0) ? async_command_statistics.total_execution_time / (double)async_command_statistics.completed : 0.0);
 
 	/* make sure gcc3 won't hit here */
 #ifndef GCCTOOOLD
@@ -438,188 +428,791 @@ int xsddefault_save_status_data(void) {
 
 	fprintf(fp, "\t}\n\n");
 
+	return;
+}
+
+
+/* writes the status block of a single host */
+static void xsddefault_write_host_status(FILE *fp, host *hst, time_t current_time) {
+	customvariablesmember *temp_customvariablesmember = NULL;
+
+	fprintf(fp, "hoststatus {\n");
+	fprintf(fp, "\thost_name=%s\n", hst->name);
+
+	fprintf(fp, "\tmodified_attributes=%lu\n", hst->modified_attributes);
+	fprintf(fp, "\tcheck_command=%s\n", (hst->host_check_command == NULL) ? "" : hst->host_check_command);
+	fprintf(fp, "\tcheck_period=%s\n", (hst->check_period == NULL) ? "" : hst->check_period);
+	fprintf(fp, "\tnotification_period=%s\n", (hst->notification_period == NULL) ? "" : hst->notification_period);
+	fprintf(fp, "\tcheck_interval=%f\n", hst->check_interval);
+	fprintf(fp, "\tretry_interval=%f\n", hst->retry_interval);
+	fprintf(fp, "\tevent_handler=%s\n", (hst->event_handler == NULL) ? "" : hst->event_handler);
+
+	fprintf(fp, "\thas_been_checked=%d\n", hst->has_been_checked);
+	fprintf(fp, "\tshould_be_scheduled=%d\n", hst->should_be_scheduled);
+	fprintf(fp, "\tcheck_execution_time=%.3f\n", hst->execution_time);
+	fprintf(fp, "\tcheck_latency=%.3f\n", hst->latency);
+	fprintf(fp, "\tcheck_type=%d\n", hst->check_type);
+	fprintf(fp, "\tcurrent_state=%d\n", hst->current_state);
+	fprintf(fp, "\tlast_hard_state=%d\n", hst->last_hard_state);
+	fprintf(fp, "\tlast_event_id=%lu\n", hst->last_event_id);
+	fprintf(fp, "\tcurrent_event_id=%lu\n", hst->current_event_id);
+	fprintf(fp, "\tcurrent_problem_id=%lu\n", hst->current_problem_id);
+	fprintf(fp, "\tlast_problem_id=%lu\n", hst->last_problem_id);
+	fprintf(fp, "\tplugin_output=%s\n", (hst->plugin_output == NULL) ? "" : hst->plugin_output);
+	fprintf(fp, "\tlong_plugin_output=%s\n", (hst->long_plugin_output == NULL) ? "" : hst->long_plugin_output);
+	fprintf(fp, "\tperformance_data=%s\n", (hst->perf_data == NULL) ? "" : hst->perf_data);
+	fprintf(fp, "\tlast_check=%lu\n", hst->last_check);
+	fprintf(fp, "\tnext_check=%lu\n", hst->next_check);
+	fprintf(fp, "\tcheck_options=%d\n", hst->check_options);
+	fprintf(fp, "\tcurrent_attempt=%d\n", hst->current_attempt);
+	fprintf(fp, "\tmax_attempts=%d\n", hst->max_attempts);
+	fprintf(fp, "\tstate_type=%d\n", hst->state_type);
+	fprintf(fp, "\tlast_state_change=%lu\n", hst->last_state_change);
+	fprintf(fp, "\tlast_hard_state_change=%lu\n", hst->last_hard_state_change);
+	fprintf(fp, "\tlast_time_up=%lu\n", hst->last_time_up);
+	fprintf(fp, "\tlast_time_down=%lu\n", hst->last_time_down);
+	fprintf(fp, "\tlast_time_unreachable=%lu\n", hst->last_time_unreachable);
+	fprintf(fp, "\tlast_notification=%lu\n", hst->last_host_notification);
+	fprintf(fp, "\tnext_notification=%lu\n", hst->next_host_notification);
+	fprintf(fp, "\tno_more_notifications=%d\n", hst->no_more_notifications);
+	fprintf(fp, "\tcurrent_notification_number=%d\n", hst->current_notification_number);
+	/* state based escalation ranges */
+	fprintf(fp, "\tcurrent_down_notification_number=%d\n", hst->current_down_notification_number);
+	fprintf(fp, "\tcurrent_unreachable_notification_number=%d\n", hst->current_unreachable_notification_number);
+
+	fprintf(fp, "\tcurrent_notification_id=%lu\n", hst->current_notification_id);
+	fprintf(fp, "\tnotifications_enabled=%d\n", hst->notifications_enabled);
+	fprintf(fp, "\tproblem_has_been_acknowledged=%d\n", hst->problem_has_been_acknowledged);
+	fprintf(fp, "\tacknowledgement_type=%d\n", hst->acknowledgement_type);
+	fprintf(fp, "\tacknowledgement_end_time=%lu\n", hst->acknowledgement_end_time);
+	fprintf(fp, "\tactive_checks_enabled=%d\n", hst->checks_enabled);
+	fprintf(fp, "\tpassive_checks_enabled=%d\n", hst->accept_passive_host_checks);
+	fprintf(fp, "\tevent_handler_enabled=%d\n", hst->event_handler_enabled);
+	fprintf(fp, "\tflap_detection_enabled=%d\n", hst->flap_detection_enabled);
+	fprintf(fp, "\tfailure_prediction_enabled=%d\n", hst->failure_prediction_enabled);
+	fprintf(fp, "\tprocess_performance_data=%d\n", hst->process_performance_data);
+	fprintf(fp, "\tobsess_over_host=%d\n", hst->obsess_over_host);
+	fprintf(fp, "\tlast_update=%lu\n", current_time);
+	fprintf(fp, "\tis_flapping=%d\n", hst->is_flapping);
+	fprintf(fp, "\tpercent_state_change=%.2f\n", hst->percent_state_change);
+	fprintf(fp, "\tscheduled_downtime_depth=%d\n", hst->scheduled_downtime_depth);
+	/*
+	fprintf(fp,"\tstate_history=");
+	for(x=0;x<MAX_STATE_HISTORY_ENTRIES;x++)
+		fprintf(fp,"%s%d",(x>0)?",":"",hst->state_history[(x+hst->state_history_index)%MAX_STATE_HISTORY_ENTRIES]);
+	fprintf(fp,"\n");
+	*/
+	/* custom variables */
+	for (temp_customvariablesmember = hst->custom_variables; temp_customvariablesmember != NULL; temp_customvariablesmember = temp_customvariablesmember->next) {
+		if (temp_customvariablesmember->variable_name)
+			fprintf(fp, "\t_%s=%d;%s\n", temp_customvariablesmember->variable_name, temp_customvariablesmember->has_been_modified, (temp_customvariablesmember->variable_value == NULL) ? "" : temp_customvariablesmember->variable_value);
+	}
+	fprintf(fp, "\t}\n\n");
+
+	hst->status_dirty = FALSE;
+
+	return;
+}
+
+
+/* writes the status block of a single service */
+static void xsddefault_write_service_status(FILE *fp, service *svc, time_t current_time) {
+	customvariablesmember *temp_customvariablesmember = NULL;
+
+	fprintf(fp, "servicestatus {\n");
+	fprintf(fp, "\thost_name=%s\n", svc->host_name);
+
+	fprintf(fp, "\tservice_description=%s\n", svc->description);
+	fprintf(fp, "\tmodified_attributes=%lu\n", svc->modified_attributes);
+	fprintf(fp, "\tcheck_command=%s\n", (svc->service_check_command == NULL) ? "" : svc->service_check_command);
+	fprintf(fp, "\tcheck_period=%s\n", (svc->check_period == NULL) ? "" : svc->check_period);
+	fprintf(fp, "\tnotification_period=%s\n", (svc->notification_period == NULL) ? "" : svc->notification_period);
+	fprintf(fp, "\tcheck_interval=%f\n", svc->check_interval);
+	fprintf(fp, "\tretry_interval=%f\n", svc->retry_interval);
+	fprintf(fp, "\tevent_handler=%s\n", (svc->event_handler == NULL) ? "" : svc->event_handler);
+
+	fprintf(fp, "\thas_been_checked=%d\n", svc->has_been_checked);
+	fprintf(fp, "\tshould_be_scheduled=%d\n", svc->should_be_scheduled);
+	fprintf(fp, "\tcheck_execution_time=%.3f\n", svc->execution_time);
+	fprintf(fp, "\tcheck_latency=%.3f\n", svc->latency);
+	fprintf(fp, "\tcheck_type=%d\n", svc->check_type);
+	fprintf(fp, "\tcurrent_state=%d\n", svc->current_state);
+	fprintf(fp, "\tlast_hard_state=%d\n", svc->last_hard_state);
+	fprintf(fp, "\tlast_event_id=%lu\n", svc->last_event_id);
+	fprintf(fp, "\tcurrent_event_id=%lu\n", svc->current_event_id);
+	fprintf(fp, "\tcurrent_problem_id=%lu\n", svc->current_problem_id);
+	fprintf(fp, "\tlast_problem_id=%lu\n", svc->last_problem_id);
+	fprintf(fp, "\tcurrent_attempt=%d\n", svc->current_attempt);
+	fprintf(fp, "\tmax_attempts=%d\n", svc->max_attempts);
+	fprintf(fp, "\tstate_type=%d\n", svc->state_type);
+	fprintf(fp, "\tlast_state_change=%lu\n", svc->last_state_change);
+	fprintf(fp, "\tlast_hard_state_change=%lu\n", svc->last_hard_state_change);
+	fprintf(fp, "\tlast_time_ok=%lu\n", svc->last_time_ok);
+	fprintf(fp, "\tlast_time_warning=%lu\n", svc->last_time_warning);
+	fprintf(fp, "\tlast_time_unknown=%lu\n", svc->last_time_unknown);
+	fprintf(fp, "\tlast_time_critical=%lu\n", svc->last_time_critical);
+	fprintf(fp, "\tplugin_output=%s\n", (svc->plugin_output == NULL) ? "" : svc->plugin_output);
+	fprintf(fp, "\tlong_plugin_output=%s\n", (svc->long_plugin_output == NULL) ? "" : svc->long_plugin_output);
+	fprintf(fp, "\tperformance_data=%s\n", (svc->perf_data == NULL) ? "" : svc->perf_data);
+	fprintf(fp, "\tlast_check=%lu\n", svc->last_check);
+	fprintf(fp, "\tnext_check=%lu\n", svc->next_check);
+	fprintf(fp, "\tcheck_options=%d\n", svc->check_options);
+	fprintf(fp, "\tcurrent_notification_number=%d\n", svc->current_notification_number);
+	/* state based escalation ranges */
+	fprintf(fp, "\tcurrent_warning_notification_number=%d\n", svc->current_warning_notification_number);
+	fprintf(fp, "\tcurrent_critical_notification_number=%d\n", svc->current_critical_notification_number);
+	fprintf(fp, "\tcurrent_unknown_notification_number=%d\n", svc->current_unknown_notification_number);
+
+	fprintf(fp, "\tcurrent_notification_id=%lu\n", svc->current_notification_id);
+	fprintf(fp, "\tlast_notification=%lu\n", svc->last_notification);
+	fprintf(fp, "\tnext_notification=%lu\n", svc->next_notification);
+	fprintf(fp, "\tno_more_notifications=%d\n", svc->no_more_notifications);
+	fprintf(fp, "\tnotifications_enabled=%d\n", svc->notifications_enabled);
+	fprintf(fp, "\tactive_checks_enabled=%d\n", svc->checks_enabled);
+	fprintf(fp, "\tpassive_checks_enabled=%d\n", svc->accept_passive_service_checks);
+	fprintf(fp, "\tevent_handler_enabled=%d\n", svc->event_handler_enabled);
+	fprintf(fp, "\tproblem_has_been_acknowledged=%d\n", svc->problem_has_been_acknowledged);
+	fprintf(fp, "\tacknowledgement_type=%d\n", svc->acknowledgement_type);
+	fprintf(fp, "\tacknowledgement_end_time=%lu\n", svc->acknowledgement_end_time);
+	fprintf(fp, "\tflap_detection_enabled=%d\n", svc->flap_detection_enabled);
+	fprintf(fp, "\tfailure_prediction_enabled=%d\n", svc->failure_prediction_enabled);
+	fprintf(fp, "\tprocess_performance_data=%d\n", svc->process_performance_data);
+	fprintf(fp, "\tobsess_over_service=%d\n", svc->obsess_over_service);
+	fprintf(fp, "\tlast_update=%lu\n", current_time);
+	fprintf(fp, "\tis_flapping=%d\n", svc->is_flapping);
+	fprintf(fp, "\tpercent_state_change=%.2f\n", svc->percent_state_change);
+	fprintf(fp, "\tscheduled_downtime_depth=%d\n", svc->scheduled_downtime_depth);
+	/*
+	fprintf(fp,"\tstate_history=");
+	for(x=0;x<MAX_STATE_HISTORY_ENTRIES;x++)
+		fprintf(fp,"%s%d",(x>0)?",":"",svc->state_history[(x+svc->state_history_index)%MAX_STATE_HISTORY_ENTRIES]);
+	fprintf(fp,"\n");
+	*/
+	/* custom variables */
+	for (temp_customvariablesmember = svc->custom_variables; temp_customvariablesmember != NULL; temp_customvariablesmember = temp_customvariablesmember->next) {
+		if (temp_customvariablesmember->variable_name)
+			fprintf(fp, "\t_%s=%d;%s\n", temp_customvariablesmember->variable_name, temp_customvariablesmember->has_been_modified, (temp_customvariablesmember->variable_value == NULL) ? "" : temp_customvariablesmember->variable_value);
+	}
+	fprintf(fp, "\t}\n\n");
+
+	svc->status_dirty = FALSE;
+
+	return;
+}
+
+
+/* writes the status block of a single contact */
+static void xsddefault_write_contact_status(FILE *fp, contact *cntct) {
+	customvariablesmember *temp_customvariablesmember = NULL;
+
+	fprintf(fp, "contactstatus {\n");
+	fprintf(fp, "\tcontact_name=%s\n", cntct->name);
+
+	fprintf(fp, "\tmodified_attributes=%lu\n", cntct->modified_attributes);
+	fprintf(fp, "\tmodified_host_attributes=%lu\n", cntct->modified_host_attributes);
+	fprintf(fp, "\tmodified_service_attributes=%lu\n", cntct->modified_service_attributes);
+	fprintf(fp, "\thost_notification_period=%s\n", (cntct->host_notification_period == NULL) ? "" : cntct->host_notification_period);
+	fprintf(fp, "\tservice_notification_period=%s\n", (cntct->service_notification_period == NULL) ? "" : cntct->service_notification_period);
+
+	fprintf(fp, "\tlast_host_notification=%lu\n", cntct->last_host_notification);
+	fprintf(fp, "\tlast_service_notification=%lu\n", cntct->last_service_notification);
+	fprintf(fp, "\thost_notifications_enabled=%d\n", cntct->host_notifications_enabled);
+	fprintf(fp, "\tservice_notifications_enabled=%d\n", cntct->service_notifications_enabled);
+	/* custom variables */
+	for (temp_customvariablesmember = cntct->custom_variables; temp_customvariablesmember != NULL; temp_customvariablesmember = temp_customvariablesmember->next) {
+		if (temp_customvariablesmember->variable_name)
+			fprintf(fp, "\t_%s=%d;%s\n", temp_customvariablesmember->variable_name, temp_customvariablesmember->has_been_modified, (temp_customvariablesmember->variable_value == NULL) ? "" : temp_customvariablesmember->variable_value);
+	}
+	fprintf(fp, "\t}\n\n");
+
+	cntct->status_dirty = FALSE;
+
+	return;
+}
+
+
+/* cheap fingerprint of all comments and downtime, changes whenever one is added, deleted or starts/stops */
+static unsigned long xsddefault_comment_downtime_signature(void) {
+	comment *temp_comment = NULL;
+	scheduled_downtime *temp_downtime = NULL;
+	unsigned long signature = 0L;
+
+	signature = next_comment_id * 31 + next_downtime_id;
+	for (temp_comment = comment_list; temp_comment != NULL; temp_comment = temp_comment->next)
+		signature = signature * 31 + temp_comment->comment_id;
+	for (temp_downtime = scheduled_downtime_list; temp_downtime != NULL; temp_downtime = temp_downtime->next)
+		signature = signature * 31 + temp_downtime->downtime_id + temp_downtime->is_in_effect + (unsigned long)temp_downtime->trigger_time;
+
+	return signature;
+}
+
+
+/* appends the changed hosts, services and contacts to the status delta file, returns ERROR if a full update is needed instead */
+static int xsddefault_save_status_delta(void) {
+	host *temp_host = NULL;
+	service *temp_service = NULL;
+	contact *temp_contact = NULL;
+	unsigned long total_objects = 0L;
+	unsigned long dirty_objects = 0L;
+	time_t current_time;
+	FILE *fp = NULL;
+
+	/* comments and downtime are only written in full */
+	if (xsddefault_comment_downtime_signature() != xsddefault_delta_signature)
+		return ERROR;
+
+	/* once most objects have changed, a full update is cheaper */
+	for (temp_host = host_list; temp_host != NULL; temp_host = temp_host->next, total_objects++) {
+		if (temp_host->status_dirty == TRUE)
+			dirty_objects++;
+	}
+	for (temp_service = service_list; temp_service != NULL; temp_service = temp_service->next, total_objects++) {
+		if (temp_service->status_dirty == TRUE)
+			dirty_objects++;
+	}
+	for (temp_contact = contact_list; temp_contact != NULL; temp_contact = temp_contact->next, total_objects++) {
+		if (temp_contact->status_dirty == TRUE)
+			dirty_objects++;
+	}
+	if (dirty_objects * 2 > total_objects)
+		return ERROR;
+
+	log_debug_info(DEBUGL_STATUSDATA, 2, "Appending %lu changed objects to status delta file '%s'\n", dirty_objects, xsddefault_status_delta_log);
+
+	if ((fp = fopen(xsddefault_status_delta_log, "a")) == NULL) {
+		logit(NSLOG_RUNTIME_ERROR, TRUE, "Error: Unable to open status delta file '%s' for writing: %s\n", xsddefault_status_delta_log, strerror(errno));
+		return ERROR;
+	}
+	fchmod(fileno(fp), S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH);
+
+	time(&current_time);
+
+	/* readers skip deltas which don't belong to the status file they have read */
+	fprintf(fp, "delta {\n");
+	fprintf(fp, "\tgeneration=%s\n", xsddefault_delta_generation);
+	fprintf(fp, "\tcreated=%lu\n", current_time);
+	fprintf(fp, "\t}\n\n");
+
+	xsddefault_write_program_status(fp);
 
-	/* save host status data */
 	for (temp_host = host_list; temp_host != NULL; temp_host = temp_host->next) {
+		if (temp_host->status_dirty == TRUE)
+			xsddefault_write_host_status(fp, temp_host, current_time);
+	}
+	for (temp_service = service_list; temp_service != NULL; temp_service = temp_service->next) {
+		if (temp_service->status_dirty == TRUE)
+			xsddefault_write_service_status(fp, temp_service, current_time);
+	}
+	for (temp_contact = contact_list; temp_contact != NULL; temp_contact = temp_contact->next) {
+		if (temp_contact->status_dirty == TRUE)
+			xsddefault_write_contact_status(fp, temp_contact);
+	}
+
+	if (fclose(fp)) {
+		logit(NSLOG_RUNTIME_ERROR, TRUE, "Error: Unable to save status delta file '%s': %s\n", xsddefault_status_delta_log, strerror(errno));
+		return ERROR;
+	}
+
+	xsddefault_deltas_written++;
+
+	return OK;
+}
+
+
+/* appends a string to the string table of the binary status snapshot, empty strings are left out */
+static int xsddefault_add_binary_string(char **table, unsigned long *table_size, unsigned long *table_allocated, char *string, int unescape, unsigned long *offset) {
+	unsigned long length = 0L;
+	char *new_table = NULL;
+
+	*offset = XSDDEFAULT_BINARY_NONE;
+	if (string == NULL || string[0] == '\x0')
+		return OK;
+
+	length = strlen(string) + 1;
+	if (*table_size + length > *table_allocated) {
+		if ((new_table = (char *)realloc(*table, (*table_allocated + length) * 2)) == NULL)
+			return ERROR;
+		*table = new_table;
+		*table_allocated = (*table_allocated + length) * 2;
+	}
+
+	memcpy(*table + *table_size, string, length);
+
+	/* plugin output is stored the way the text status file reader returns it */
+	if (unescape == TRUE)
+		length = strlen(unescape_newlines(*table + *table_size)) + 1;
+
+	*offset = *table_size;
+	*table_size += length;
 
-		fprintf(fp, "hoststatus {\n");
-		fprintf(fp, "\thost_name=%s\n", temp_host->name);
-
-		fprintf(fp, "\tmodified_attributes=%lu\n", temp_host->modified_attributes);
-		fprintf(fp, "\tcheck_command=%s\n", (temp_host->host_check_command == NULL) ? "" : temp_host->host_check_command);
-		fprintf(fp, "\tcheck_period=%s\n", (temp_host->check_period == NULL) ? "" : temp_host->check_period);
-		fprintf(fp, "\tnotification_period=%s\n", (temp_host->notification_period == NULL) ? "" : temp_host->notification_period);
-		fprintf(fp, "\tcheck_interval=%f\n", temp_host->check_interval);
-		fprintf(fp, "\tretry_interval=%f\n", temp_host->retry_interval);
-		fprintf(fp, "\tevent_handler=%s\n", (temp_host->event_handler == NULL) ? "" : temp_host->event_handler);
-
-		fprintf(fp, "\thas_been_checked=%d\n", temp_host->has_been_checked);
-		fprintf(fp, "\tshould_be_scheduled=%d\n", temp_host->should_be_scheduled);
-		fprintf(fp, "\tcheck_execution_time=%.3f\n", temp_host->execution_time);
-		fprintf(fp, "\tcheck_latency=%.3f\n", temp_host->latency);
-		fprintf(fp, "\tcheck_type=%d\n", temp_host->check_type);
-		fprintf(fp, "\tcurrent_state=%d\n", temp_host->current_state);
-		fprintf(fp, "\tlast_hard_state=%d\n", temp_host->last_hard_state);
-		fprintf(fp, "\tlast_event_id=%lu\n", temp_host->last_event_id);
-		fprintf(fp, "\tcurrent_event_id=%lu\n", temp_host->current_event_id);
-		fprintf(fp, "\tcurrent_problem_id=%lu\n", temp_host->current_problem_id);
-		fprintf(fp, "\tlast_problem_id=%lu\n", temp_host->last_problem_id);
-		fprintf(fp, "\tplugin_output=%s\n", (temp_host->plugin_output == NULL) ? "" : temp_host->plugin_output);
-		fprintf(fp, "\tlong_plugin_output=%s\n", (temp_host->long_plugin_output == NULL) ? "" : temp_host->long_plugin_output);
-		fprintf(fp, "\tperformance_data=%s\n", (temp_host->perf_data == NULL) ? "" : temp_host->perf_data);
-		fprintf(fp, "\tlast_check=%lu\n", temp_host->last_check);
-		fprintf(fp, "\tnext_check=%lu\n", temp_host->next_check);
-		fprintf(fp, "\tcheck_options=%d\n", temp_host->check_options);
-		fprintf(fp, "\tcurrent_attempt=%d\n", temp_host->current_attempt);
-		fprintf(fp, "\tmax_attempts=%d\n", temp_host->max_attempts);
-		fprintf(fp, "\tstate_type=%d\n", temp_host->state_type);
-		fprintf(fp, "\tlast_state_change=%lu\n", temp_host->last_state_change);
-		fprintf(fp, "\tlast_hard_state_change=%lu\n", temp_host->last_hard_state_change);
-		fprintf(fp, "\tlast_time_up=%lu\n", temp_host->last_time_up);
-		fprintf(fp, "\tlast_time_down=%lu\n", temp_host->last_time_down);
-		fprintf(fp, "\tlast_time_unreachable=%lu\n", temp_host->last_time_unreachable);
-		fprintf(fp, "\tlast_notification=%lu\n", temp_host->last_host_notification);
-		fprintf(fp, "\tnext_notification=%lu\n", temp_host->next_host_notification);
-		fprintf(fp, "\tno_more_notifications=%d\n", temp_host->no_more_notifications);
-		fprintf(fp, "\tcurrent_notification_number=%d\n", temp_host->current_notification_number);
-		/* state based escalation ranges */
-		fprintf(fp, "\tcurrent_down_notification_number=%d\n", temp_host->current_down_notification_number);
-		fprintf(fp, "\tcurrent_unreachable_notification_number=%d\n", temp_host->current_unreachable_notification_number);
-
-		fprintf(fp, "\tcurrent_notification_id=%lu\n", temp_host->current_notification_id);
-		fprintf(fp, "\tnotifications_enabled=%d\n", temp_host->notifications_enabled);
-		fprintf(fp, "\tproblem_has_been_acknowledged=%d\n", temp_host->problem_has_been_acknowledged);
-		fprintf(fp, "\tacknowledgement_type=%d\n", temp_host->acknowledgement_type);
-		fprintf(fp, "\tacknowledgement_end_time=%lu\n", temp_host->acknowledgement_end_time);
-		fprintf(fp, "\tactive_checks_enabled=%d\n", temp_host->checks_enabled);
-		fprintf(fp, "\tpassive_checks_enabled=%d\n", temp_host->accept_passive_host_checks);
-		fprintf(fp, "\tevent_handler_enabled=%d\n", temp_host->event_handler_enabled);
-		fprintf(fp, "\tflap_detection_enabled=%d\n", temp_host->flap_detection_enabled);
-		fprintf(fp, "\tfailure_prediction_enabled=%d\n", temp_host->failure_prediction_enabled);
-		fprintf(fp, "\tprocess_performance_data=%d\n", temp_host->process_performance_data);
-		fprintf(fp, "\tobsess_over_host=%d\n", temp_host->obsess_over_host);
-		fprintf(fp, "\tlast_update=%lu\n", current_time);
-		fprintf(fp, "\tis_flapping=%d\n", temp_host->is_flapping);
-		fprintf(fp, "\tpercent_state_change=%.2f\n", temp_host->percent_state_change);
-		fprintf(fp, "\tscheduled_downtime_depth=%d\n", temp_host->scheduled_downtime_depth);
-		/*
-		fprintf(fp,"\tstate_history=");
-		for(x=0;x<MAX_STATE_HISTORY_ENTRIES;x++)
-			fprintf(fp,"%s%d",(x>0)?",":"",temp_host->state_history[(x+temp_host->state_history_index)%MAX_STATE_HISTORY_ENTRIES]);
-		fprintf(fp,"\n");
-		*/
-		/* custom variables */
-		for (temp_customvariablesmember = temp_host->custom_variables; temp_customvariablesmember != NULL; temp_customvariablesmember = temp_customvariablesmember->next) {
-			if (temp_customvariablesmember->variable_name)
-				fprintf(fp, "\t_%s=%d;%s\n", temp_customvariablesmember->variable_name, temp_customvariablesmember->has_been_modified, (temp_customvariablesmember->variable_value == NULL) ? "" : temp_customvariablesmember->variable_value);
+	return OK;
+}
+
+
+/* writes the binary status snapshot the CGIs can map instead of parsing the status file */
+static int xsddefault_save_binary_status(char *delta_generation, time_t current_time) {
+	xsddefault_binary_header header;
+	xsddefault_binary_host host_record;
+	xsddefault_binary_service service_record;
+	xsddefault_binary_comment comment_record;
+	xsddefault_binary_downtime downtime_record;
+	host *temp_host = NULL;
+	service *temp_service = NULL;
+	host *last_host = NULL;
+	comment *temp_comment = NULL;
+	scheduled_downtime *temp_downtime = NULL;
+	host **hosts = NULL;
+	service **services = NULL;
+	unsigned long *host_index = NULL;
+	unsigned long *service_index = NULL;
+	unsigned long slot_tails[XSDDEFAULT_BINARY_HASHSLOTS];
+	unsigned long *slot_heads = NULL;
+	unsigned long *next_entries = NULL;
+	unsigned long last_host_name = XSDDEFAULT_BINARY_NONE;
+	char *strings = NULL;
+	unsigned long strings_size = 0L;
+	unsigned long strings_allocated = 0L;
+	unsigned long x = 0L;
+	unsigned long y = 0L;
+	unsigned long last = 0L;
+	char *temp_file = NULL;
+	int hashslot = 0;
+	int result = OK;
+	int fd = 0;
+	FILE *fp = NULL;
+
+	/* the profiler data only fits into the text status file */
+#ifndef GCCTOOOLD
+	if (event_profiling_enabled) {
+		unlink(xsddefault_status_binary_log);
+		return OK;
+	}
+#endif
+
+	memset(&header, 0, sizeof(header));
+	strncpy(header.magic, XSDDEFAULT_BINARY_MAGIC, sizeof(header.magic));
+	header.version = XSDDEFAULT_BINARY_VERSION;
+	header.header_size = sizeof(xsddefault_binary_header);
+	header.host_size = sizeof(xsddefault_binary_host);
+	header.service_size = sizeof(xsddefault_binary_service);
+	header.comment_size = sizeof(xsddefault_binary_comment);
+	header.downtime_size = sizeof(xsddefault_binary_downtime);
+	header.created = (unsigned long)current_time;
+	snprintf(header.delta_generation, sizeof(header.delta_generation), "%s", delta_generation);
+
+	header.program_start = (unsigned long)program_start;
+	header.last_command_check = (unsigned long)last_command_check;
+	header.last_log_rotation = (unsigned long)last_log_rotation;
+	header.disable_notifications_expire_time = (unsigned long)disable_notifications_expire_time;
+	header.nagios_pid = nagios_pid;
+	header.daemon_mode = daemon_mode;
+	header.enable_notifications = enable_notifications;
+	header.execute_service_checks = execute_service_checks;
+	header.accept_passive_service_checks = accept_passive_service_checks;
+	header.execute_host_checks = execute_host_checks;
+	header.accept_passive_host_checks = accept_passive_host_checks;
+	header.enable_event_handlers = enable_event_handlers;
+	header.obsess_over_services = obsess_over_services;
+	header.obsess_over_hosts = obsess_over_hosts;
+	header.check_service_freshness = check_service_freshness;
+	header.check_host_freshness = check_host_freshness;
+	header.enable_flap_detection = enable_flap_detection;
+	header.enable_failure_prediction = enable_failure_prediction;
+	header.process_performance_data = process_performance_data;
+	header.buffer_stats[0] = external_command_buffer_slots;
+	if (check_external_commands == TRUE) {
+		header.buffer_stats[1] = get_external_command_buffer_items();
+		header.buffer_stats[2] = external_command_buffer.high;
+	}
+	/* the stats were generated for the status file just written */
+	for (x = 0; x < MAX_CHECK_STATS_TYPES; x++) {
+		header.program_stats[x][0] = check_statistics[x].minute_stats[0];
+		header.program_stats[x][1] = check_statistics[x].minute_stats[1];
+		header.program_stats[x][2] = check_statistics[x].minute_stats[2];
+	}
+
+	for (temp_host = host_list; temp_host != NULL; temp_host = temp_host->next)
+		header.host_count++;
+	for (temp_service = service_list; temp_service != NULL; temp_service = temp_service->next)
+		header.service_count++;
+	for (temp_comment = comment_list; temp_comment != NULL; temp_comment = temp_comment->next)
+		header.comment_count++;
+	for (temp_downtime = scheduled_downtime_list; temp_downtime != NULL; temp_downtime = temp_downtime->next)
+		header.downtime_count++;
+
+	/* all records have a fixed size, so every section offset is known up front */
+	header.hash_slots = XSDDEFAULT_BINARY_HASHSLOTS;
+	header.host_offset = sizeof(xsddefault_binary_header);
+	header.service_offset = header.host_offset + header.host_count * sizeof(xsddefault_binary_host);
+	header.comment_offset = header.service_offset + header.service_count * sizeof(xsddefault_binary_service);
+	header.downtime_offset = header.comment_offset + header.comment_count * sizeof(xsddefault_binary_comment);
+	header.host_index_offset = header.downtime_offset + header.downtime_count * sizeof(xsddefault_binary_downtime);
+	header.service_index_offset = header.host_index_offset + (header.hash_slots + header.host_count) * sizeof(unsigned long);
+	header.string_offset = header.service_index_offset + (header.hash_slots + header.service_count) * sizeof(unsigned long);
+
+	hosts = (host **)malloc(sizeof(host *) * (header.host_count + 1));
+	services = (service **)malloc(sizeof(service *) * (header.service_count + 1));
+	host_index = (unsigned long *)malloc(sizeof(unsigned long) * (header.hash_slots + header.host_count));
+	service_index = (unsigned long *)malloc(sizeof(unsigned long) * (header.hash_slots + header.service_count));
+	if (hosts == NULL || services == NULL || host_index == NULL || service_index == NULL)
+		result = ERROR;
+
+	/* open a safe temp file for output */
+	if (result == OK && asprintf(&temp_file, "%sXXXXXX", xsddefault_temp_file) == -1)
+		temp_file = NULL;
+	if (result == OK && temp_file != NULL && (fd = mkstemp(temp_file)) != -1) {
+		if ((fp = (FILE *)fdopen(fd, "w")) == NULL) {
+			close(fd);
+			unlink(temp_file);
 		}
-		fprintf(fp, "\t}\n\n");
+	}
+	if (fp == NULL) {
+		if (result == OK)
+			logit(NSLOG_RUNTIME_ERROR, TRUE, "Error: Unable to create temp file for writing binary status data: %s\n", strerror(errno));
+		my_free(hosts);
+		my_free(services);
+		my_free(host_index);
+		my_free(service_index);
+		my_free(temp_file);
+		return ERROR;
 	}
 
-	/* save service status data */
-	for (temp_service = service_list; temp_service != NULL; temp_service = temp_service->next) {
+	log_debug_info(DEBUGL_STATUSDATA, 2, "Writing binary status data to temp file '%s'\n", temp_file);
 
-		fprintf(fp, "servicestatus {\n");
-		fprintf(fp, "\thost_name=%s\n", temp_service->host_name);
-
-		fprintf(fp, "\tservice_description=%s\n", temp_service->description);
-		fprintf(fp, "\tmodified_attributes=%lu\n", temp_service->modified_attributes);
-		fprintf(fp, "\tcheck_command=%s\n", (temp_service->service_check_command == NULL) ? "" : temp_service->service_check_command);
-		fprintf(fp, "\tcheck_period=%s\n", (temp_service->check_period == NULL) ? "" : temp_service->check_period);
-		fprintf(fp, "\tnotification_period=%s\n", (temp_service->notification_period == NULL) ? "" : temp_service->notification_period);
-		fprintf(fp, "\tcheck_interval=%f\n", temp_service->check_interval);
-		fprintf(fp, "\tretry_interval=%f\n", temp_service->retry_interval);
-		fprintf(fp, "\tevent_handler=%s\n", (temp_service->event_handler == NULL) ? "" : temp_service->event_handler);
-
-		fprintf(fp, "\thas_been_checked=%d\n", temp_service->has_been_checked);
-		fprintf(fp, "\tshould_be_scheduled=%d\n", temp_service->should_be_scheduled);
-		fprintf(fp, "\tcheck_execution_time=%.3f\n", temp_service->execution_time);
-		fprintf(fp, "\tcheck_latency=%.3f\n", temp_service->latency);
-		fprintf(fp, "\tcheck_type=%d\n", temp_service->check_type);
-		fprintf(fp, "\tcurrent_state=%d\n", temp_service->current_state);
-		fprintf(fp, "\tlast_hard_state=%d\n", temp_service->last_hard_state);
-		fprintf(fp, "\tlast_event_id=%lu\n", temp_service->last_event_id);
-		fprintf(fp, "\tcurrent_event_id=%lu\n", temp_service->current_event_id);
-		fprintf(fp, "\tcurrent_problem_id=%lu\n", temp_service->current_problem_id);
-		fprintf(fp, "\tlast_problem_id=%lu\n", temp_service->last_problem_id);
-		fprintf(fp, "\tcurrent_attempt=%d\n", temp_service->current_attempt);
-		fprintf(fp, "\tmax_attempts=%d\n", temp_service->max_attempts);
-		fprintf(fp, "\tstate_type=%d\n", temp_service->state_type);
-		fprintf(fp, "\tlast_state_change=%lu\n", temp_service->last_state_change);
-		fprintf(fp, "\tlast_hard_state_change=%lu\n", temp_service->last_hard_state_change);
-		fprintf(fp, "\tlast_time_ok=%lu\n", temp_service->last_time_ok);
-		fprintf(fp, "\tlast_time_warning=%lu\n", temp_service->last_time_warning);
-		fprintf(fp, "\tlast_time_unknown=%lu\n", temp_service->last_time_unknown);
-		fprintf(fp, "\tlast_time_critical=%lu\n", temp_service->last_time_critical);
-		fprintf(fp, "\tplugin_output=%s\n", (temp_service->plugin_output == NULL) ? "" : temp_service->plugin_output);
-		fprintf(fp, "\tlong_plugin_output=%s\n", (temp_service->long_plugin_output == NULL) ? "" : temp_service->long_plugin_output);
-		fprintf(fp, "\tperformance_data=%s\n", (temp_service->perf_data == NULL) ? "" : temp_service->perf_data);
-		fprintf(fp, "\tlast_check=%lu\n", temp_service->last_check);
-		fprintf(fp, "\tnext_check=%lu\n", temp_service->next_check);
-		fprintf(fp, "\tcheck_options=%d\n", temp_service->check_options);
-		fprintf(fp, "\tcurrent_notification_number=%d\n", temp_service->current_notification_number);
-		/* state based escalation ranges */
-		fprintf(fp, "\tcurrent_warning_notification_number=%d\n", temp_service->current_warning_notification_number);
-		fprintf(fp, "\tcurrent_critical_notification_number=%d\n", temp_service->current_critical_notification_number);
-		fprintf(fp, "\tcurrent_unknown_notification_number=%d\n", temp_service->current_unknown_notification_number);
-
-		fprintf(fp, "\tcurrent_notification_id=%lu\n", temp_service->current_notification_id);
-		fprintf(fp, "\tlast_notification=%lu\n", temp_service->last_notification);
-		fprintf(fp, "\tnext_notification=%lu\n", temp_service->next_notification);
-		fprintf(fp, "\tno_more_notifications=%d\n", temp_service->no_more_notifications);
-		fprintf(fp, "\tnotifications_enabled=%d\n", temp_service->notifications_enabled);
-		fprintf(fp, "\tactive_checks_enabled=%d\n", temp_service->checks_enabled);
-		fprintf(fp, "\tpassive_checks_enabled=%d\n", temp_service->accept_passive_service_checks);
-		fprintf(fp, "\tevent_handler_enabled=%d\n", temp_service->event_handler_enabled);
-		fprintf(fp, "\tproblem_has_been_acknowledged=%d\n", temp_service->problem_has_been_acknowledged);
-		fprintf(fp, "\tacknowledgement_type=%d\n", temp_service->acknowledgement_type);
-		fprintf(fp, "\tacknowledgement_end_time=%lu\n", temp_service->acknowledgement_end_time);
-		fprintf(fp, "\tflap_detection_enabled=%d\n", temp_service->flap_detection_enabled);
-		fprintf(fp, "\tfailure_prediction_enabled=%d\n", temp_service->failure_prediction_enabled);
-		fprintf(fp, "\tprocess_performance_data=%d\n", temp_service->process_performance_data);
-		fprintf(fp, "\tobsess_over_service=%d\n", temp_service->obsess_over_service);
-		fprintf(fp, "\tlast_update=%lu\n", current_time);
-		fprintf(fp, "\tis_flapping=%d\n", temp_service->is_flapping);
-		fprintf(fp, "\tpercent_state_change=%.2f\n", temp_service->percent_state_change);
-		fprintf(fp, "\tscheduled_downtime_depth=%d\n", temp_service->scheduled_downtime_depth);
-		/*
-		fprintf(fp,"\tstate_history=");
-		for(x=0;x<MAX_STATE_HISTORY_ENTRIES;x++)
-			fprintf(fp,"%s%d",(x>0)?",":"",temp_service->state_history[(x+temp_service->state_history_index)%MAX_STATE_HISTORY_ENTRIES]);
-		fprintf(fp,"\n");
-		*/
-		/* custom variables */
-		for (temp_customvariablesmember = temp_service->custom_variables; temp_customvariablesmember != NULL; temp_customvariablesmember = temp_customvariablesmember->next) {
-			if (temp_customvariablesmember->variable_name)
-				fprintf(fp, "\t_%s=%d;%s\n", temp_customvariablesmember->variable_name, temp_customvariablesmember->has_been_modified, (temp_customvariablesmember->variable_value == NULL) ? "" : temp_customvariablesmember->variable_value);
+	/* the header is written again once the string table size is known */
+	fwrite(&header, sizeof(header), 1, fp);
+
+	for (temp_host = host_list, x = 0; temp_host != NULL && result == OK; temp_host = temp_host->next, x++) {
+		hosts[x] = temp_host;
+		memset(&host_record, 0, sizeof(host_record));
+		if (xsddefault_add_binary_string(&strings, &strings_size, &strings_allocated, temp_host->name, FALSE, &host_record.host_name) == ERROR
+		        || xsddefault_add_binary_string(&strings, &strings_size, &strings_allocated, temp_host->plugin_output, TRUE, &host_record.plugin_output) == ERROR
+		        || xsddefault_add_binary_string(&strings, &strings_size, &strings_allocated, temp_host->long_plugin_output, TRUE, &host_record.long_plugin_output) == ERROR
+		        || xsddefault_add_binary_string(&strings, &strings_size, &strings_allocated, temp_host->perf_data, FALSE, &host_record.perf_data) == ERROR)
+			result = ERROR;
+		host_record.modified_attributes = temp_host->modified_attributes;
+		host_record.last_check = (unsigned long)temp_host->last_check;
+		host_record.next_check = (unsigned long)temp_host->next_check;
+		host_record.last_state_change = (unsigned long)temp_host->last_state_change;
+		host_record.last_hard_state_change = (unsigned long)temp_host->last_hard_state_change;
+		host_record.last_time_up = (unsigned long)temp_host->last_time_up;
+		host_record.last_time_down = (unsigned long)temp_host->last_time_down;
+		host_record.last_time_unreachable = (unsigned long)temp_host->last_time_unreachable;
+		host_record.last_notification = (unsigned long)temp_host->last_host_notification;
+		host_record.next_notification = (unsigned long)temp_host->next_host_notification;
+		host_record.acknowledgement_end_time = (unsigned long)temp_host->acknowledgement_end_time;
+		host_record.percent_state_change = temp_host->percent_state_change;
+		host_record.latency = temp_host->latency;
+		host_record.execution_time = temp_host->execution_time;
+		host_record.status = temp_host->current_state;
+		host_record.has_been_checked = temp_host->has_been_checked;
+		host_record.should_be_scheduled = temp_host->should_be_scheduled;
+		host_record.current_attempt = temp_host->current_attempt;
+		host_record.max_attempts = temp_host->max_attempts;
+		host_record.check_options = temp_host->check_options;
+		host_record.check_type = temp_host->check_type;
+		host_record.last_hard_state = temp_host->last_hard_state;
+		host_record.state_type = temp_host->state_type;
+		host_record.no_more_notifications = temp_host->no_more_notifications;
+		host_record.notifications_enabled = temp_host->notifications_enabled;
+		host_record.problem_has_been_acknowledged = temp_host->problem_has_been_acknowledged;
+		host_record.acknowledgement_type = temp_host->acknowledgement_type;
+		host_record.current_notification_number = temp_host->current_notification_number;
+		host_record.current_down_notification_number = temp_host->current_down_notification_number;
+		host_record.current_unreachable_notification_number = temp_host->current_unreachable_notification_number;
+		host_record.accept_passive_host_checks = temp_host->accept_passive_host_checks;
+		host_record.event_handler_enabled = temp_host->event_handler_enabled;
+		host_record.checks_enabled = temp_host->checks_enabled;
+		host_record.flap_detection_enabled = temp_host->flap_detection_enabled;
+		host_record.is_flapping = temp_host->is_flapping;
+		host_record.scheduled_downtime_depth = temp_host->scheduled_downtime_depth;
+		host_record.failure_prediction_enabled = temp_host->failure_prediction_enabled;
+		host_record.process_performance_data = temp_host->process_performance_data;
+		host_record.obsess_over_host = temp_host->obsess_over_host;
+		fwrite(&host_record, sizeof(host_record), 1, fp);
+	}
+
+	for (temp_service = service_list, x = 0; temp_service != NULL && result == OK; temp_service = temp_service->next, x++) {
+		services[x] = temp_service;
+		memset(&service_record, 0, sizeof(service_record));
+
+		/* services of the same host share its name */
+		if (last_host == NULL || temp_service->host_ptr != last_host || last_host_name == XSDDEFAULT_BINARY_NONE) {
+			if (xsddefault_add_binary_string(&strings, &strings_size, &strings_allocated, temp_service->host_name, FALSE, &last_host_name) == ERROR)
+				result = ERROR;
+			last_host = temp_service->host_ptr;
 		}
-		fprintf(fp, "\t}\n\n");
+		service_record.host_name = last_host_name;
+		if (xsddefault_add_binary_string(&strings, &strings_size, &strings_allocated, temp_service->description, FALSE, &service_record.description) == ERROR
+		        || xsddefault_add_binary_string(&strings, &strings_size, &strings_allocated, temp_service->plugin_output, TRUE, &service_record.plugin_output) == ERROR
+		        || xsddefault_add_binary_string(&strings, &strings_size, &strings_allocated, temp_service->long_plugin_output, TRUE, &service_record.long_plugin_output) == ERROR
+		        || xsddefault_add_binary_string(&strings, &strings_size, &strings_allocated, temp_service->perf_data, FALSE, &service_record.perf_data) == ERROR)
+			result = ERROR;
+		service_record.modified_attributes = temp_service->modified_attributes;
+		service_record.last_check = (unsigned long)temp_service->last_check;
+		service_record.next_check = (unsigned long)temp_service->next_check;
+		service_record.last_state_change = (unsigned long)temp_service->last_state_change;
+		service_record.last_hard_state_change = (unsigned long)temp_service->last_hard_state_change;
+		service_record.last_time_ok = (unsigned long)temp_service->last_time_ok;
+		service_record.last_time_warning = (unsigned long)temp_service->last_time_warning;
+		service_record.last_time_unknown = (unsigned long)temp_service->last_time_unknown;
+		service_record.last_time_critical = (unsigned long)temp_service->last_time_critical;
+		service_record.last_notification = (unsigned long)temp_service->last_notification;
+		service_record.next_notification = (unsigned long)temp_service->next_notification;
+		service_record.acknowledgement_end_time = (unsigned long)temp_service->acknowledgement_end_time;
+		service_record.percent_state_change = temp_service->percent_state_change;
+		service_record.latency = temp_service->latency;
+		service_record.execution_time = temp_service->execution_time;
+		service_record.status = temp_service->current_state;
+		service_record.has_been_checked = temp_service->has_been_checked;
+		service_record.should_be_scheduled = temp_service->should_be_scheduled;
+		service_record.current_attempt = temp_service->current_attempt;
+		service_record.max_attempts = temp_service->max_attempts;
+		service_record.check_options = temp_service->check_options;
+		service_record.check_type = temp_service->check_type;
+		service_record.last_hard_state = temp_service->last_hard_state;
+		service_record.state_type = temp_service->state_type;
+		service_record.no_more_notifications = temp_service->no_more_notifications;
+		service_record.notifications_enabled = temp_service->notifications_enabled;
+		service_record.problem_has_been_acknowledged = temp_service->problem_has_been_acknowledged;
+		service_record.acknowledgement_type = temp_service->acknowledgement_type;
+		service_record.current_notification_number = temp_service->current_notification_number;
+		service_record.current_warning_notification_number = temp_service->current_warning_notification_number;
+		service_record.current_critical_notification_number = temp_service->current_critical_notification_number;
+		service_record.current_unknown_notification_number = temp_service->current_unknown_notification_number;
+		service_record.accept_passive_service_checks = temp_service->accept_passive_service_checks;
+		service_record.event_handler_enabled = temp_service->event_handler_enabled;
+		service_record.checks_enabled = temp_service->checks_enabled;
+		service_record.flap_detection_enabled = temp_service->flap_detection_enabled;
+		service_record.is_flapping = temp_service->is_flapping;
+		service_record.scheduled_downtime_depth = temp_service->scheduled_downtime_depth;
+		service_record.failure_prediction_enabled = temp_service->failure_prediction_enabled;
+		service_record.process_performance_data = temp_service->process_performance_data;
+		service_record.obsess_over_service = temp_service->obsess_over_service;
+		fwrite(&service_record, sizeof(service_record), 1, fp);
 	}
 
-	/* save contact status data */
-	for (temp_contact = contact_list; temp_contact != NULL; temp_contact = temp_contact->next) {
+	for (temp_comment = comment_list; temp_comment != NULL && result == OK; temp_comment = temp_comment->next) {
+		memset(&comment_record, 0, sizeof(comment_record));
+		if (xsddefault_add_binary_string(&strings, &strings_size, &strings_allocated, temp_comment->host_name, FALSE, &comment_record.host_name) == ERROR
+		        || xsddefault_add_binary_string(&strings, &strings_size, &strings_allocated, temp_comment->service_description, FALSE, &comment_record.service_description) == ERROR
+		        || xsddefault_add_binary_string(&strings, &strings_size, &strings_allocated, temp_comment->author, FALSE, &comment_record.author) == ERROR
+		        || xsddefault_add_binary_string(&strings, &strings_size, &strings_allocated, temp_comment->comment_data, FALSE, &comment_record.comment_data) == ERROR)
+			result = ERROR;
+		comment_record.comment_id = temp_comment->comment_id;
+		comment_record.entry_time = (unsigned long)temp_comment->entry_time;
+		comment_record.expire_time = (unsigned long)temp_comment->expire_time;
+		comment_record.comment_type = temp_comment->comment_type;
+		comment_record.entry_type = temp_comment->entry_type;
+		comment_record.source = temp_comment->source;
+		comment_record.persistent = temp_comment->persistent;
+		comment_record.expires = temp_comment->expires;
+		fwrite(&comment_record, sizeof(comment_record), 1, fp);
+	}
+
+	for (temp_downtime = scheduled_downtime_list; temp_downtime != NULL && result == OK; temp_downtime = temp_downtime->next) {
+		memset(&downtime_record, 0, sizeof(downtime_record));
+		if (xsddefault_add_binary_string(&strings, &strings_size, &strings_allocated, temp_downtime->host_name, FALSE, &downtime_record.host_name) == ERROR
+		        || xsddefault_add_binary_string(&strings, &strings_size, &strings_allocated, temp_downtime->service_description, FALSE, &downtime_record.service_description) == ERROR
+		        || xsddefault_add_binary_string(&strings, &strings_size, &strings_allocated, temp_downtime->author, FALSE, &downtime_record.author) == ERROR
+		        || xsddefault_add_binary_string(&strings, &strings_size, &strings_allocated, temp_downtime->comment, FALSE, &downtime_record.comment) == ERROR)
+			result = ERROR;
+		downtime_record.downtime_id = temp_downtime->downtime_id;
+		downtime_record.entry_time = (unsigned long)temp_downtime->entry_time;
+		downtime_record.start_time = (unsigned long)temp_downtime->start_time;
+		downtime_record.end_time = (unsigned long)temp_downtime->end_time;
+		downtime_record.triggered_by = temp_downtime->triggered_by;
+		downtime_record.duration = temp_downtime->duration;
+		downtime_record.trigger_time = (unsigned long)temp_downtime->trigger_time;
+		downtime_record.type = temp_downtime->type;
+		downtime_record.fixed = temp_downtime->fixed;
+		downtime_record.is_in_effect = temp_downtime->is_in_effect;
+		fwrite(&downtime_record, sizeof(downtime_record), 1, fp);
+	}
 
-		fprintf(fp, "contactstatus {\n");
-		fprintf(fp, "\tcontact_name=%s\n", temp_contact->name);
-
-		fprintf(fp, "\tmodified_attributes=%lu\n", temp_contact->modified_attributes);
-		fprintf(fp, "\tmodified_host_attributes=%lu\n", temp_contact->modified_host_attributes);
-		fprintf(fp, "\tmodified_service_attributes=%lu\n", temp_contact->modified_service_attributes);
-		fprintf(fp, "\thost_notification_period=%s\n", (temp_contact->host_notification_period == NULL) ? "" : temp_contact->host_notification_period);
-		fprintf(fp, "\tservice_notification_period=%s\n", (temp_contact->service_notification_period == NULL) ? "" : temp_contact->service_notification_period);
-
-		fprintf(fp, "\tlast_host_notification=%lu\n", temp_contact->last_host_notification);
-		fprintf(fp, "\tlast_service_notification=%lu\n", temp_contact->last_service_notification);
-		fprintf(fp, "\thost_notifications_enabled=%d\n", temp_contact->host_notifications_enabled);
-		fprintf(fp, "\tservice_notifications_enabled=%d\n", temp_contact->service_notifications_enabled);
-		/* custom variables */
-		for (temp_customvariablesmember = temp_contact->custom_variables; temp_customvariablesmember != NULL; temp_customvariablesmember = temp_customvariablesmember->next) {
-			if (temp_customvariablesmember->variable_name)
-				fprintf(fp, "\t_%s=%d;%s\n", temp_customvariablesmember->variable_name, temp_customvariablesmember->has_been_modified, (temp_customvariablesmember->variable_value == NULL) ? "" : temp_customvariablesmember->variable_value);
+	/* precompute the sorted hash chains the CGIs would otherwise build entry by entry */
+	if (result == OK) {
+		slot_heads = host_index;
+		next_entries = host_index + header.hash_slots;
+		for (hashslot = 0; hashslot < XSDDEFAULT_BINARY_HASHSLOTS; hashslot++)
+			slot_heads[hashslot] = XSDDEFAULT_BINARY_NONE;
+		for (x = 0; x < header.host_count; x++) {
+			hashslot = hashfunc(hosts[x]->name, NULL, XSDDEFAULT_BINARY_HASHSLOTS);
+			next_entries[x] = XSDDEFAULT_BINARY_NONE;
+			/* objects usually come sorted, so mostly they are appended */
+			if (slot_heads[hashslot] == XSDDEFAULT_BINARY_NONE)
+				slot_heads[hashslot] = x;
+			else if (compare_hashdata(hosts[slot_tails[hashslot]]->name, NULL, hosts[x]->name, NULL) < 0)
+				next_entries[slot_tails[hashslot]] = x;
+			else {
+				for (last = XSDDEFAULT_BINARY_NONE, y = slot_heads[hashslot]; y != XSDDEFAULT_BINARY_NONE && compare_hashdata(hosts[y]->name, NULL, hosts[x]->name, NULL) < 0; last = y, y = next_entries[y]);
+				next_entries[x] = y;
+				if (last == XSDDEFAULT_BINARY_NONE)
+					slot_heads[hashslot] = x;
+				else
+					next_entries[last] = x;
+				continue;
+			}
+			slot_tails[hashslot] = x;
 		}
-		fprintf(fp, "\t}\n\n");
+		fwrite(host_index, sizeof(unsigned long), header.hash_slots + header.host_count, fp);
+
+		slot_heads = service_index;
+		next_entries = service_index + header.hash_slots;
+		for (hashslot = 0; hashslot < XSDDEFAULT_BINARY_HASHSLOTS; hashslot++)
+			slot_heads[hashslot] = XSDDEFAULT_BINARY_NONE;
+		for (x = 0; x < header.service_count; x++) {
+			hashslot = hashfunc(services[x]->host_name, services[x]->description, XSDDEFAULT_BINARY_HASHSLOTS);
+			next_entries[x] = XSDDEFAULT_BINARY_NONE;
+			if (slot_heads[hashslot] == XSDDEFAULT_BINARY_NONE)
+				slot_heads[hashslot] = x;
+			else if (compare_hashdata(services[slot_tails[hashslot]]->host_name, services[slot_tails[hashslot]]->description, services[x]->host_name, services[x]->description) < 0)
+				next_entries[slot_tails[hashslot]] = x;
+			else {
+				for (last = XSDDEFAULT_BINARY_NONE, y = slot_heads[hashslot]; y != XSDDEFAULT_BINARY_NONE && compare_hashdata(services[y]->host_name, services[y]->description, services[x]->host_name, services[x]->description) < 0; last = y, y = next_entries[y]);
+				next_entries[x] = y;
+				if (last == XSDDEFAULT_BINARY_NONE)
+					slot_heads[hashslot] = x;
+				else
+					next_entries[last] = x;
+				continue;
+			}
+			slot_tails[hashslot] = x;
+		}
+		fwrite(service_index, sizeof(unsigned long), header.hash_slots + header.service_count, fp);
+
+		header.string_size = strings_size;
+		if (strings_size > 0)
+			fwrite(strings, 1, strings_size, fp);
+
+		fseek(fp, 0L, SEEK_SET);
+		fwrite(&header, sizeof(header), 1, fp);
+	}
+
+	my_free(hosts);
+	my_free(services);
+	my_free(host_index);
+	my_free(service_index);
+	my_free(strings);
+
+	fchmod(fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH);
+	fflush(fp);
+	fsync(fd);
+	if (fclose(fp) != 0 || result == ERROR) {
+		unlink(temp_file);
+		logit(NSLOG_RUNTIME_ERROR, TRUE, "Error: Unable to save binary status file: %s\n", strerror(errno));
+		result = ERROR;
+	} else if (my_rename(temp_file, xsddefault_status_binary_log)) {
+		unlink(temp_file);
+		logit(NSLOG_RUNTIME_ERROR, TRUE, "Error: Unable to update binary status data file '%s': %s\n", xsddefault_status_binary_log, strerror(errno));
+		result = ERROR;
 	}
 
+	my_free(temp_file);
+
+	return result;
+}
+
+
+/* write all status data to file */
+int xsddefault_save_status_data(void) {
+	char *temp_file = NULL;
+	host *temp_host = NULL;
+	service *temp_service = NULL;
+	contact *temp_contact = NULL;
+	comment *temp_comment = NULL;
+	scheduled_downtime *temp_downtime = NULL;
+	time_t current_time;
+	int fd = 0;
+	int dummy; /* reduce compiler warnings */
+	FILE *fp = NULL;
+	int result = OK;
+	char delta_generation[MAX_INPUT_BUFFER] = "";
+
+	log_debug_info(DEBUGL_FUNCTIONS, 0, "save_status_data()\n");
+
+	/* if this is set to /dev/null, skip it */
+	if (!xsddefault_status_log || !strcmp(xsddefault_status_log, "/dev/null"))
+		return OK;
+
+	/* only append what has changed as long as the full status file allows it */
+	if (xsddefault_delta_updates > 0 && xsddefault_deltas_written < xsddefault_delta_updates && xsddefault_delta_generation[0] != '\x0') {
+		if (xsddefault_save_status_delta() == OK)
+			return OK;
+	}
+
+	/* the full status file starts a new generation of deltas */
+	xsddefault_delta_generation[0] = '\x0';
+	if (xsddefault_delta_updates > 0)
+		snprintf(delta_generation, sizeof(delta_generation), "%lu.%lu", (unsigned long)program_start, ++xsddefault_full_updates);
+
+	/* open a safe temp file for output */
+	if (xsddefault_temp_file == NULL)
+		return ERROR;
+	dummy = asprintf(&temp_file, "%sXXXXXX", xsddefault_temp_file);
+	if (temp_file == NULL)
+		return ERROR;
+
+	log_debug_info(DEBUGL_STATUSDATA, 2, "Writing status data to temp file '%s'\n", temp_file);
+
+	if ((fd = mkstemp(temp_file)) == -1) {
+
+		/* log an error */
+		logit(NSLOG_RUNTIME_ERROR, TRUE, "Error: Unable to create temp file '%s' for writing status data: %s\n", temp_file, strerror(errno));
+
+		/* free memory */
+		my_free(temp_file);
+
+		return ERROR;
+	}
+	fp = (FILE *)fdopen(fd, "w");
+	if (fp == NULL) {
+
+		close(fd);
+		unlink(temp_file);
+
+		/* log an error */
+		logit(NSLOG_RUNTIME_ERROR, TRUE, "Error: Unable to open temp file '%s' for writing status data: %s\n", temp_file, strerror(errno));
+
+		/* free memory */
+		my_free(temp_file);
+
+		return ERROR;
+	}
+
+	/* write version info to status file */
+	fprintf(fp, "########################################\n");
+	fprintf(fp, "#          %s STATUS FILE\n", PROGRAM_NAME_UC);
+	fprintf(fp, "#\n");
+	fprintf(fp, "# THIS FILE IS AUTOMATICALLY GENERATED\n");
+	fprintf(fp, "# BY %s.  DO NOT MODIFY THIS FILE!\n", PROGRAM_NAME_UC);
+	fprintf(fp, "########################################\n\n");
+
+	time(&current_time);
+
+	/* write file info */
+	fprintf(fp, "info {\n");
+	fprintf(fp, "\tcreated=%lu\n", current_time);
+	fprintf(fp, "\tversion=%s\n", PROGRAM_VERSION);
+	if (delta_generation[0] != '\x0')
+		fprintf(fp, "\tdelta_generation=%s\n", delta_generation);
+	fprintf(fp, "\t}\n\n");
+
+	/* save program status data */
+	xsddefault_write_program_status(fp);
+
+	/* save host status data */
+	for (temp_host = host_list; temp_host != NULL; temp_host = temp_host->next)
+		xsddefault_write_host_status(fp, temp_host, current_time);
+
+	/* save service status data */
+	for (temp_service = service_list; temp_service != NULL; temp_service = temp_service->next)
+		xsddefault_write_service_status(fp, temp_service, current_time);
+
+	/* save contact status data */
+	for (temp_contact = contact_list; temp_contact != NULL; temp_contact = temp_contact->next)
+		xsddefault_write_contact_status(fp, temp_contact);
+
 	/* save all comments */
 	for (temp_comment = comment_list; temp_comment != NULL; temp_comment = temp_comment->next) {
 
@@ -690,6 +1283,14 @@ int xsddefault_save_status_data(void) {
 			logit(NSLOG_RUNTIME_ERROR, TRUE, "Error: Unable to update status data file '%s': %s", xsddefault_status_log, strerror(errno));
 			result = ERROR;
 		}
+
+		/* old deltas are skipped by readers anyway, start with an empty delta file */
+		else if (delta_generation[0] != '\x0') {
+			unlink(xsddefault_status_delta_log);
+			strcpy(xsddefault_delta_generation, delta_generation);
+			xsddefault_delta_signature = xsddefault_comment_downtime_signature();
+			xsddefault_deltas_written = 0;
+		}
 	}
 
 	/* a problem occurred saving the file */
@@ -702,6 +1303,14 @@ int xsddefault_save_status_data(void) {
 		logit(NSLOG_RUNTIME_ERROR, TRUE, "Error: Unable to save status file: %s", strerror(errno));
 	}
 
+	/* the binary snapshot must never be older than the status file, or the CGIs would prefer stale data */
+	if (xsddefault_binary_status == TRUE) {
+		if (result == OK)
+			result = xsddefault_save_binary_status(delta_generation, current_time);
+		if (result == ERROR)
+			unlink(xsddefault_status_binary_log);
+	}
+
 	/* free memory */
 	my_free(temp_file);
 
@@ -718,8 +1327,8 @@ int xsddefault_save_status_data(void) {
 /****************** DEFAULT DATA INPUT FUNCTIONS ******************/
 /******************************************************************/
 
-/* read all program, host, and service status information */
-int xsddefault_read_status_data(char *config_file, int options) {
+/* reads a status file or, if delta_file is TRUE, the deltas appended to it */
+static int xsddefault_read_status_file(char *filename, int delta_file, char *delta_generation) {
 #ifdef NO_MMAP
 	char input[MAX_PLUGIN_OUTPUT_LENGTH] = "";
 	FILE *fp = NULL;
@@ -733,7 +1342,7 @@ int xsddefault_read_status_data(char *config_file, int options) {
 	char *var = NULL;
 	char *val = NULL;
 	char *ptr = NULL;
-	int result = 0;
+	int skip_delta = TRUE;
 	/* comment and downtime vars */
 	unsigned long comment_id = 0;
 	int persistent = FALSE;
@@ -757,31 +1366,15 @@ int xsddefault_read_status_data(char *config_file, int options) {
 	time_t trigger_time = 0L;
 
 
-	/* initialize some vars */
-	for (x = 0; x < MAX_CHECK_STATS_TYPES; x++) {
-		program_stats[x][0] = 0;
-		program_stats[x][1] = 0;
-		program_stats[x][2] = 0;
-	}
-
-	/* grab configuration data */
-	result = xsddefault_grab_config_info(config_file);
-	if (result == ERROR)
-		return ERROR;
-
 	/* open the status file for reading */
 #ifdef NO_MMAP
-	if ((fp = fopen(xsddefault_status_log, "r")) == NULL)
+	if ((fp = fopen(filename, "r")) == NULL)
 		return ERROR;
 #else
-	if ((thefile = mmap_fopen(xsddefault_status_log)) == NULL)
+	if ((thefile = mmap_fopen(filename)) == NULL)
 		return ERROR;
 #endif
 
-	/* Big speedup when reading status.dat in bulk */
-	defer_downtime_sorting = 1;
-	defer_comment_sorting = 1;
-
 	/* read all lines in the status file */
 	while (1) {
 
@@ -804,7 +1397,14 @@ int xsddefault_read_status_data(char *config_file, int options) {
 		if (input[0] == '#' || input[0] == '\x0')
 			continue;
 
-		else if (!strcmp(input, "info {"))
+		/* skip deltas which belong to an older status file */
+		else if (delta_file == TRUE && skip_delta == TRUE && data_type != XSDDEFAULT_DELTA_DATA && strcmp(input, "delta {"))
+			continue;
+
+		else if (!strcmp(input, "delta {")) {
+			data_type = XSDDEFAULT_DELTA_DATA;
+			skip_delta = TRUE;
+		} else if (!strcmp(input, "info {"))
 			data_type = XSDDEFAULT_INFO_DATA;
 		else if (!strcmp(input, "programstatus {"))
 			data_type = XSDDEFAULT_PROGRAMSTATUS_DATA;
@@ -838,13 +1438,19 @@ int xsddefault_read_status_data(char *config_file, int options) {
 
 			case XSDDEFAULT_HOSTSTATUS_DATA:
 				temp_hoststatus->added = 0;
-				add_host_status(temp_hoststatus);
+				if (delta_file == TRUE)
+					replace_host_status(temp_hoststatus);
+				else
+					add_host_status(temp_hoststatus);
 				temp_hoststatus = NULL;
 				break;
 
 			case XSDDEFAULT_SERVICESTATUS_DATA:
 				temp_servicestatus->added = 0;
-				add_service_status(temp_servicestatus);
+				if (delta_file == TRUE)
+					replace_service_status(temp_servicestatus);
+				else
+					add_service_status(temp_servicestatus);
 				temp_servicestatus = NULL;
 				break;
 
@@ -922,6 +1528,17 @@ int xsddefault_read_status_data(char *config_file, int options) {
 #ifdef NSCGI
 				if (!strcmp(var, "created"))
 					status_file_creation_time = strtoul(val, NULL, 10);
+#endif
+				if (!strcmp(var, "delta_generation") && delta_file == FALSE)
+					snprintf(delta_generation, MAX_INPUT_BUFFER, "%s", val);
+				break;
+
+			case XSDDEFAULT_DELTA_DATA:
+				if (!strcmp(var, "generation"))
+					skip_delta = (strcmp(val, delta_generation)) ? TRUE : FALSE;
+#ifdef NSCGI
+				else if (!strcmp(var, "created") && skip_delta == FALSE)
+					status_file_creation_time = strtoul(val, NULL, 10);
 #endif
 				break;
 
@@ -1317,6 +1934,23 @@ int xsddefault_read_status_data(char *config_file, int options) {
 		}
 	}
 
+	/* a delta may still be in the middle of being written */
+	if (temp_hoststatus != NULL) {
+		my_free(temp_hoststatus->host_name);
+		my_free(temp_hoststatus->plugin_output);
+		my_free(temp_hoststatus->long_plugin_output);
+		my_free(temp_hoststatus->perf_data);
+		my_free(temp_hoststatus);
+	}
+	if (temp_servicestatus != NULL) {
+		my_free(temp_servicestatus->host_name);
+		my_free(temp_servicestatus->description);
+		my_free(temp_servicestatus->plugin_output);
+		my_free(temp_servicestatus->long_plugin_output);
+		my_free(temp_servicestatus->perf_data);
+		my_free(temp_servicestatus);
+	}
+
 	/* free memory and close the file */
 #ifdef NO_MMAP
 	fclose(fp);
@@ -1325,8 +1959,315 @@ int xsddefault_read_status_data(char *config_file, int options) {
 	mmap_fclose(thefile);
 #endif
 
+	return OK;
+}
+
+
+/* checks that a section of the binary status snapshot lies within the file */
+static int xsddefault_binary_section_ok(unsigned long offset, unsigned long count, unsigned long size, unsigned long file_size) {
+
+	if (offset % sizeof(unsigned long) || offset > file_size)
+		return FALSE;
+	if (count > (file_size - offset) / size)
+		return FALSE;
+
+	return TRUE;
+}
+
+
+/* returns a string of the binary status snapshot, NULL for empty strings */
+static char *xsddefault_binary_string(xsddefault_binary_header *header, unsigned long offset) {
+
+	if (offset == XSDDEFAULT_BINARY_NONE || offset >= header->string_size)
+		return NULL;
+
+	return (char *)header + header->string_offset + offset;
+}
+
+
+/* reads the binary status snapshot in place, returns ERROR if the status file has to be parsed instead */
+static int xsddefault_read_binary_status_file(char *filename, char *delta_generation) {
+	xsddefault_binary_header *header = NULL;
+	xsddefault_binary_host *host_record = NULL;
+	xsddefault_binary_service *service_record = NULL;
+	xsddefault_binary_comment *comment_record = NULL;
+	xsddefault_binary_downtime *downtime_record = NULL;
+	hoststatus **hosts = NULL;
+	servicestatus **services = NULL;
+	unsigned long *host_index = NULL;
+	unsigned long *service_index = NULL;
+	unsigned long file_size = 0L;
+	unsigned long x = 0L;
+	struct stat st;
+	void *mapping = NULL;
+	int fd = 0;
+	int result = OK;
+
+	if ((fd = open(filename, O_RDONLY)) == -1)
+		return ERROR;
+	if (fstat(fd, &st) == -1 || st.st_size < (off_t)sizeof(xsddefault_binary_header)) {
+		close(fd);
+		return ERROR;
+	}
+	file_size = (unsigned long)st.st_size;
+	/* the CGIs change some strings in place, a private mapping keeps that from the file and the other CGIs */
+	mapping = mmap(NULL, file_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (mapping == MAP_FAILED)
+		return ERROR;
+
+	/* only use snapshots written by a core with the same record layout */
+	header = (xsddefault_binary_header *)mapping;
+	if (memcmp(header->magic, XSDDEFAULT_BINARY_MAGIC, sizeof(XSDDEFAULT_BINARY_MAGIC))
+	        || header->version != XSDDEFAULT_BINARY_VERSION
+	        || header->header_size != sizeof(xsddefault_binary_header)
+	        || header->host_size != sizeof(xsddefault_binary_host)
+	        || header->service_size != sizeof(xsddefault_binary_service)
+	        || header->comment_size != sizeof(xsddefault_binary_comment)
+	        || header->downtime_size != sizeof(xsddefault_binary_downtime)
+	        || header->delta_generation[sizeof(header->delta_generation) - 1] != '\x0'
+	        || header->hash_slots > file_size
+	        || !xsddefault_binary_section_ok(header->host_offset, header->host_count, sizeof(xsddefault_binary_host), file_size)
+	        || !xsddefault_binary_section_ok(header->service_offset, header->service_count, sizeof(xsddefault_binary_service), file_size)
+	        || !xsddefault_binary_section_ok(header->comment_offset, header->comment_count, sizeof(xsddefault_binary_comment), file_size)
+	        || !xsddefault_binary_section_ok(header->downtime_offset, header->downtime_count, sizeof(xsddefault_binary_downtime), file_size)
+	        || !xsddefault_binary_section_ok(header->host_index_offset, header->hash_slots + header->host_count, sizeof(unsigned long), file_size)
+	        || !xsddefault_binary_section_ok(header->service_index_offset, header->hash_slots + header->service_count, sizeof(unsigned long), file_size)
+	        || header->string_offset > file_size || header->string_size > file_size - header->string_offset
+	        || (header->string_size > 0 && ((char *)mapping)[header->string_offset + header->string_size - 1] != '\x0')) {
+		munmap(mapping, file_size);
+		return ERROR;
+	}
+
+	hosts = (hoststatus **)calloc(header->host_count + 1, sizeof(hoststatus *));
+	services = (servicestatus **)calloc(header->service_count + 1, sizeof(servicestatus *));
+	if (hosts == NULL || services == NULL)
+		result = ERROR;
+	for (x = 0; x < header->host_count && result == OK; x++) {
+		if ((hosts[x] = (hoststatus *)calloc(1, sizeof(hoststatus))) == NULL)
+			result = ERROR;
+	}
+	for (x = 0; x < header->service_count && result == OK; x++) {
+		if ((services[x] = (servicestatus *)calloc(1, sizeof(servicestatus))) == NULL)
+			result = ERROR;
+	}
+
+	/* the status strings point into the mapping from here on */
+	if (result == OK)
+		result = set_status_data_mapping(mapping, file_size);
+
+	if (result == ERROR) {
+		for (x = 0; hosts != NULL && x < header->host_count; x++)
+			my_free(hosts[x]);
+		for (x = 0; services != NULL && x < header->service_count; x++)
+			my_free(services[x]);
+		my_free(hosts);
+		my_free(services);
+		munmap(mapping, file_size);
+		return ERROR;
+	}
+
+	status_file_creation_time = (time_t)header->created;
+	snprintf(delta_generation, MAX_INPUT_BUFFER, "%s", header->delta_generation);
+
+	program_start = (time_t)header->program_start;
+	last_command_check = (time_t)header->last_command_check;
+	last_log_rotation = (time_t)header->last_log_rotation;
+	disable_notifications_expire_time = (time_t)header->disable_notifications_expire_time;
+	nagios_pid = header->nagios_pid;
+	daemon_mode = (header->daemon_mode > 0) ? TRUE : FALSE;
+	enable_notifications = (header->enable_notifications > 0) ? TRUE : FALSE;
+	execute_service_checks = (header->execute_service_checks > 0) ? TRUE : FALSE;
+	accept_passive_service_checks = (header->accept_passive_service_checks > 0) ? TRUE : FALSE;
+	execute_host_checks = (header->execute_host_checks > 0) ? TRUE : FALSE;
+	accept_passive_host_checks = (header->accept_passive_host_checks > 0) ? TRUE : FALSE;
+	enable_event_handlers = (header->enable_event_handlers > 0) ? TRUE : FALSE;
+	obsess_over_services = (header->obsess_over_services > 0) ? TRUE : FALSE;
+	obsess_over_hosts = (header->obsess_over_hosts > 0) ? TRUE : FALSE;
+	check_service_freshness = (header->check_service_freshness > 0) ? TRUE : FALSE;
+	check_host_freshness = (header->check_host_freshness > 0) ? TRUE : FALSE;
+	enable_flap_detection = (header->enable_flap_detection > 0) ? TRUE : FALSE;
+	enable_failure_prediction = (header->enable_failure_prediction > 0) ? TRUE : FALSE;
+	process_performance_data = (header->process_performance_data > 0) ? TRUE : FALSE;
+#ifndef GCCTOOOLD
+	event_profiling_enabled = FALSE;
+#endif
+	buffer_stats[0][0] = header->buffer_stats[0];
+	buffer_stats[0][1] = header->buffer_stats[1];
+	buffer_stats[0][2] = header->buffer_stats[2];
+	for (x = 0; x < MAX_CHECK_STATS_TYPES; x++) {
+		program_stats[x][0] = header->program_stats[x][0];
+		program_stats[x][1] = header->program_stats[x][1];
+		program_stats[x][2] = header->program_stats[x][2];
+	}
+
+	host_record = (xsddefault_binary_host *)((char *)mapping + header->host_offset);
+	for (x = 0; x < header->host_count; x++, host_record++) {
+		hosts[x]->host_name = xsddefault_binary_string(header, host_record->host_name);
+		hosts[x]->plugin_output = xsddefault_binary_string(header, host_record->plugin_output);
+		hosts[x]->long_plugin_output = xsddefault_binary_string(header, host_record->long_plugin_output);
+		hosts[x]->perf_data = xsddefault_binary_string(header, host_record->perf_data);
+		hosts[x]->modified_attributes = host_record->modified_attributes;
+		hosts[x]->last_update = (time_t)header->created;
+		hosts[x]->last_check = (time_t)host_record->last_check;
+		hosts[x]->next_check = (time_t)host_record->next_check;
+		hosts[x]->last_state_change = (time_t)host_record->last_state_change;
+		hosts[x]->last_hard_state_change = (time_t)host_record->last_hard_state_change;
+		hosts[x]->last_time_up = (time_t)host_record->last_time_up;
+		hosts[x]->last_time_down = (time_t)host_record->last_time_down;
+		hosts[x]->last_time_unreachable = (time_t)host_record->last_time_unreachable;
+		hosts[x]->last_notification = (time_t)host_record->last_notification;
+		hosts[x]->next_notification = (time_t)host_record->next_notification;
+		hosts[x]->acknowledgement_end_time = (time_t)host_record->acknowledgement_end_time;
+		hosts[x]->percent_state_change = host_record->percent_state_change;
+		hosts[x]->latency = host_record->latency;
+		hosts[x]->execution_time = host_record->execution_time;
+		hosts[x]->status = host_record->status;
+		hosts[x]->has_been_checked = (host_record->has_been_checked > 0) ? TRUE : FALSE;
+		hosts[x]->should_be_scheduled = (host_record->should_be_scheduled > 0) ? TRUE : FALSE;
+		hosts[x]->current_attempt = host_record->current_attempt;
+		hosts[x]->max_attempts = host_record->max_attempts;
+		hosts[x]->check_options = host_record->check_options;
+		hosts[x]->check_type = host_record->check_type;
+		hosts[x]->last_hard_state = host_record->last_hard_state;
+		hosts[x]->state_type = host_record->state_type;
+		hosts[x]->no_more_notifications = (host_record->no_more_notifications > 0) ? TRUE : FALSE;
+		hosts[x]->notifications_enabled = (host_record->notifications_enabled > 0) ? TRUE : FALSE;
+		hosts[x]->problem_has_been_acknowledged = (host_record->problem_has_been_acknowledged > 0) ? TRUE : FALSE;
+		hosts[x]->acknowledgement_type = host_record->acknowledgement_type;
+		hosts[x]->current_notification_number = host_record->current_notification_number;
+		hosts[x]->current_down_notification_number = host_record->current_down_notification_number;
+		hosts[x]->current_unreachable_notification_number = host_record->current_unreachable_notification_number;
+		hosts[x]->accept_passive_host_checks = (host_record->accept_passive_host_checks > 0) ? TRUE : FALSE;
+		hosts[x]->event_handler_enabled = (host_record->event_handler_enabled > 0) ? TRUE : FALSE;
+		hosts[x]->checks_enabled = (host_record->checks_enabled > 0) ? TRUE : FALSE;
+		hosts[x]->flap_detection_enabled = (host_record->flap_detection_enabled > 0) ? TRUE : FALSE;
+		hosts[x]->is_flapping = (host_record->is_flapping > 0) ? TRUE : FALSE;
+		hosts[x]->scheduled_downtime_depth = host_record->scheduled_downtime_depth;
+		hosts[x]->failure_prediction_enabled = (host_record->failure_prediction_enabled > 0) ? TRUE : FALSE;
+		hosts[x]->process_performance_data = (host_record->process_performance_data > 0) ? TRUE : FALSE;
+		hosts[x]->obsess_over_host = (host_record->obsess_over_host > 0) ? TRUE : FALSE;
+	}
+
+	service_record = (xsddefault_binary_service *)((char *)mapping + header->service_offset);
+	for (x = 0; x < header->service_count; x++, service_record++) {
+		services[x]->host_name = xsddefault_binary_string(header, service_record->host_name);
+		services[x]->description = xsddefault_binary_string(header, service_record->description);
+		services[x]->plugin_output = xsddefault_binary_string(header, service_record->plugin_output);
+		services[x]->long_plugin_output = xsddefault_binary_string(header, service_record->long_plugin_output);
+		services[x]->perf_data = xsddefault_binary_string(header, service_record->perf_data);
+		services[x]->modified_attributes = service_record->modified_attributes;
+		services[x]->last_update = (time_t)header->created;
+		services[x]->last_check = (time_t)service_record->last_check;
+		services[x]->next_check = (time_t)service_record->next_check;
+		services[x]->last_state_change = (time_t)service_record->last_state_change;
+		services[x]->last_hard_state_change = (time_t)service_record->last_hard_state_change;
+		services[x]->last_time_ok = (time_t)service_record->last_time_ok;
+		services[x]->last_time_warning = (time_t)service_record->last_time_warning;
+		services[x]->last_time_unknown = (time_t)service_record->last_time_unknown;
+		services[x]->last_time_critical = (time_t)service_record->last_time_critical;
+		services[x]->last_notification = (time_t)service_record->last_notification;
+		services[x]->next_notification = (time_t)service_record->next_notification;
+		services[x]->acknowledgement_end_time = (time_t)service_record->acknowledgement_end_time;
+		services[x]->percent_state_change = service_record->percent_state_change;
+		services[x]->latency = service_record->latency;
+		services[x]->execution_time = service_record->execution_time;
+		services[x]->status = service_record->status;
+		services[x]->has_been_checked = (service_record->has_been_checked > 0) ? TRUE : FALSE;
+		services[x]->should_be_scheduled = (service_record->should_be_scheduled > 0) ? TRUE : FALSE;
+		services[x]->current_attempt = service_record->current_attempt;
+		services[x]->max_attempts = service_record->max_attempts;
+		services[x]->check_options = service_record->check_options;
+		services[x]->check_type = service_record->check_type;
+		services[x]->last_hard_state = service_record->last_hard_state;
+		services[x]->state_type = service_record->state_type;
+		services[x]->no_more_notifications = (service_record->no_more_notifications > 0) ? TRUE : FALSE;
+		services[x]->notifications_enabled = (service_record->notifications_enabled > 0) ? TRUE : FALSE;
+		services[x]->problem_has_been_acknowledged = (service_record->problem_has_been_acknowledged > 0) ? TRUE : FALSE;
+		services[x]->acknowledgement_type = service_record->acknowledgement_type;
+		services[x]->current_notification_number = service_record->current_notification_number;
+		services[x]->current_warning_notification_number = service_record->current_warning_notification_number;
+		services[x]->current_critical_notification_number = service_record->current_critical_notification_number;
+		services[x]->current_unknown_notification_number = service_record->current_unknown_notification_number;
+		services[x]->accept_passive_service_checks = (service_record->accept_passive_service_checks > 0) ? TRUE : FALSE;
+		services[x]->event_handler_enabled = (service_record->event_handler_enabled > 0) ? TRUE : FALSE;
+		services[x]->checks_enabled = (service_record->checks_enabled > 0) ? TRUE : FALSE;
+		services[x]->flap_detection_enabled = (service_record->flap_detection_enabled > 0) ? TRUE : FALSE;
+		services[x]->is_flapping = (service_record->is_flapping > 0) ? TRUE : FALSE;
+		services[x]->scheduled_downtime_depth = service_record->scheduled_downtime_depth;
+		services[x]->failure_prediction_enabled = (service_record->failure_prediction_enabled > 0) ? TRUE : FALSE;
+		services[x]->process_performance_data = (service_record->process_performance_data > 0) ? TRUE : FALSE;
+		services[x]->obsess_over_service = (service_record->obsess_over_service > 0) ? TRUE : FALSE;
+	}
+
+	/* take over the hash chains the core has already sorted, fall back to adding entries one by one */
+	host_index = (unsigned long *)((char *)mapping + header->host_index_offset);
+	if (header->hash_slots != HOSTSTATUS_HASHSLOTS || add_indexed_host_status(hosts, header->host_count, host_index, host_index + header->hash_slots) == ERROR) {
+		for (x = 0; x < header->host_count; x++)
+			add_host_status(hosts[x]);
+	}
+	service_index = (unsigned long *)((char *)mapping + header->service_index_offset);
+	if (header->hash_slots != SERVICESTATUS_HASHSLOTS || add_indexed_service_status(services, header->service_count, service_index, service_index + header->hash_slots) == ERROR) {
+		for (x = 0; x < header->service_count; x++)
+			add_service_status(services[x]);
+	}
+
+	my_free(hosts);
+	my_free(services);
+
+	/* comments and downtime are few, they are copied */
+	comment_record = (xsddefault_binary_comment *)((char *)mapping + header->comment_offset);
+	for (x = 0; x < header->comment_count; x++, comment_record++)
+		add_comment(comment_record->comment_type, comment_record->entry_type, xsddefault_binary_string(header, comment_record->host_name), xsddefault_binary_string(header, comment_record->service_description), (time_t)comment_record->entry_time, xsddefault_binary_string(header, comment_record->author), xsddefault_binary_string(header, comment_record->comment_data), comment_record->comment_id, comment_record->persistent, comment_record->expires, (time_t)comment_record->expire_time, comment_record->source);
+
+	downtime_record = (xsddefault_binary_downtime *)((char *)mapping + header->downtime_offset);
+	for (x = 0; x < header->downtime_count; x++, downtime_record++) {
+		if (downtime_record->type == HOST_DOWNTIME)
+			add_host_downtime(xsddefault_binary_string(header, downtime_record->host_name), (time_t)downtime_record->entry_time, xsddefault_binary_string(header, downtime_record->author), xsddefault_binary_string(header, downtime_record->comment), (time_t)downtime_record->start_time, (time_t)downtime_record->end_time, downtime_record->fixed, downtime_record->triggered_by, downtime_record->duration, downtime_record->downtime_id, downtime_record->is_in_effect, (time_t)downtime_record->trigger_time);
+		else
+			add_service_downtime(xsddefault_binary_string(header, downtime_record->host_name), xsddefault_binary_string(header, downtime_record->service_description), (time_t)downtime_record->entry_time, xsddefault_binary_string(header, downtime_record->author), xsddefault_binary_string(header, downtime_record->comment), (time_t)downtime_record->start_time, (time_t)downtime_record->end_time, downtime_record->fixed, downtime_record->triggered_by, downtime_record->duration, downtime_record->downtime_id, downtime_record->is_in_effect, (time_t)downtime_record->trigger_time);
+	}
+
+	return OK;
+}
+
+
+/* read all program, host, and service status information */
+int xsddefault_read_status_data(char *config_file, int options) {
+	char delta_generation[MAX_INPUT_BUFFER] = "";
+	int result = 0;
+	int x = 0;
+
+	/* initialize some vars */
+	for (x = 0; x < MAX_CHECK_STATS_TYPES; x++) {
+		program_stats[x][0] = 0;
+		program_stats[x][1] = 0;
+		program_stats[x][2] = 0;
+	}
+
+	/* grab configuration data */
+	result = xsddefault_grab_config_info(config_file);
+	if (result == ERROR)
+		return ERROR;
+
+	/* Big speedup when reading status.dat in bulk */
+	defer_downtime_sorting = 1;
+	defer_comment_sorting = 1;
+
+	/* the binary snapshot saves parsing the status file, which is always there as well */
+	if (xsddefault_binary_status == FALSE || xsddefault_read_binary_status_file(xsddefault_status_binary_log, delta_generation) == ERROR) {
+		if (xsddefault_read_status_file(xsddefault_status_log, FALSE, delta_generation) == ERROR)
+			return ERROR;
+	}
+
+	/* apply the changes the core has appended since (there may be none) */
+	if (delta_generation[0] != '\x0')
+		xsddefault_read_status_file(xsddefault_status_delta_log, TRUE, delta_generation);
+
 	/* free memory */
 	my_free(xsddefault_status_log);
+	my_free(xsddefault_status_delta_log);
+	my_free(xsddefault_status_binary_log);
 	my_free(xsddefault_temp_file);
 
 	if (sort_downtime() != OK)
@@ -44,10 +44,204 @@ int xsddefault_save_status_data(void);
 #define XSDDEFAULT_SERVICECOMMENT_DATA   7
 #define XSDDEFAULT_HOSTDOWNTIME_DATA     8
 #define XSDDEFAULT_SERVICEDOWNTIME_DATA  9
+#define XSDDEFAULT_DELTA_DATA            10
 
 int xsddefault_read_status_data(char *,int);
 #endif
 
+
+/************************ BINARY STATUS SNAPSHOT ***************************/
+
+/*
+ * if status_file_binary is enabled, the core writes <status_file>.bin next to every full
+ * status file. the CGIs map it and use the strings in place instead of parsing the text.
+ * all offsets are relative to the start of the file, string offsets are relative to the
+ * string table. layout: header, host, service, comment and downtime records, host and
+ * service hash indexes (slot heads followed by the next record of each record), strings.
+ */
+
+#define XSDDEFAULT_BINARY_MAGIC          "ICSTATB"
+#define XSDDEFAULT_BINARY_VERSION        2
+#define XSDDEFAULT_BINARY_HASHSLOTS      1024
+#define XSDDEFAULT_BINARY_NONE           ((unsigned long)-1)
+
+typedef struct xsddefault_binary_header_struct{
+	char            magic[8];
+	unsigned int    version;
+	unsigned int    header_size;
+	unsigned int    host_size;
+	unsigned int    service_size;
+	unsigned int    comment_size;
+	unsigned int    downtime_size;
+	unsigned long   created;
+	char            delta_generation[64];
+
+	/* program status */
+	unsigned long   program_start;
+	unsigned long   last_command_check;
+	unsigned long   last_log_rotation;
+	unsigned long   disable_notifications_expire_time;
+	int             nagios_pid;
+	int             daemon_mode;
+	int             enable_notifications;
+	int             execute_service_checks;
+	int             accept_passive_service_checks;
+	int             execute_host_checks;
+	int             accept_passive_host_checks;
+	int             enable_event_handlers;
+	int             obsess_over_services;
+	int             obsess_over_hosts;
+	int             check_service_freshness;
+	int             check_host_freshness;
+	int             enable_flap_detection;
+	int             enable_failure_prediction;
+	int             process_performance_data;
+	int             buffer_stats[3];
+	int             program_stats[MAX_CHECK_STATS_TYPES][3];
+
+	/* sections */
+	unsigned long   host_offset;
+	unsigned long   host_count;
+	unsigned long   service_offset;
+	unsigned long   service_count;
+	unsigned long   comment_offset;
+	unsigned long   comment_count;
+	unsigned long   downtime_offset;
+	unsigned long   downtime_count;
+	unsigned long   hash_slots;
+	unsigned long   host_index_offset;
+	unsigned long   service_index_offset;
+	unsigned long   string_offset;
+	unsigned long   string_size;
+        }xsddefault_binary_header;
+
+typedef struct xsddefault_binary_host_struct{
+	unsigned long   host_name;
+	unsigned long   plugin_output;
+	unsigned long   long_plugin_output;
+	unsigned long   perf_data;
+	unsigned long   modified_attributes;
+	unsigned long   last_check;
+	unsigned long   next_check;
+	unsigned long   last_state_change;
+	unsigned long   last_hard_state_change;
+	unsigned long   last_time_up;
+	unsigned long   last_time_down;
+	unsigned long   last_time_unreachable;
+	unsigned long   last_notification;
+	unsigned long   next_notification;
+	unsigned long   acknowledgement_end_time;
+	double          percent_state_change;
+	double          latency;
+	double          execution_time;
+	int             status;
+	int             has_been_checked;
+	int             should_be_scheduled;
+	int             current_attempt;
+	int             max_attempts;
+	int             check_options;
+	int             check_type;
+	int             last_hard_state;
+	int             state_type;
+	int             no_more_notifications;
+	int             notifications_enabled;
+	int             problem_has_been_acknowledged;
+	int             acknowledgement_type;
+	int             current_notification_number;
+	int             current_down_notification_number;
+	int             current_unreachable_notification_number;
+	int             accept_passive_host_checks;
+	int             event_handler_enabled;
+	int             checks_enabled;
+	int             flap_detection_enabled;
+	int             is_flapping;
+	int             scheduled_downtime_depth;
+	int             failure_prediction_enabled;
+	int             process_performance_data;
+	int             obsess_over_host;
+        }xsddefault_binary_host;
+
+typedef struct xsddefault_binary_service_struct{
+	unsigned long   host_name;
+	unsigned long   description;
+	unsigned long   plugin_output;
+	unsigned long   long_plugin_output;
+	unsigned long   perf_data;
+	unsigned long   modified_attributes;
+	unsigned long   last_check;
+	unsigned long   next_check;
+	unsigned long   last_state_change;
+	unsigned long   last_hard_state_change;
+	unsigned long   last_time_ok;
+	unsigned long   last_time_warning;
+	unsigned long   last_time_unknown;
+	unsigned long   last_time_critical;
+	unsigned long   last_notification;
+	unsigned long   next_notification;
+	unsigned long   acknowledgement_end_time;
+	double          percent_state_change;
+	double          latency;
+	double          execution_time;
+	int             status;
+	int             has_been_checked;
+	int             should_be_scheduled;
+	int             current_attempt;
+	int             max_attempts;
+	int             check_options;
+	int             check_type;
+	int             last_hard_state;
+	int             state_type;
+	int             no_more_notifications;
+	int             notifications_enabled;
+	int             problem_has_been_acknowledged;
+	int             acknowledgement_type;
+	int             current_notification_number;
+	int             current_warning_notification_number;
+	int             current_critical_notification_number;
+	int             current_unknown_notification_number;
+	int             accept_passive_service_checks;
+	int             event_handler_enabled;
+	int             checks_enabled;
+	int             flap_detection_enabled;
+	int             is_flapping;
+	int             scheduled_downtime_depth;
+	int             failure_prediction_enabled;
+	int             process_performance_data;
+	int             obsess_over_service;
+        }xsddefault_binary_service;
+
+typedef struct xsddefault_binary_comment_struct{
+	unsigned long   host_name;
+	unsigned long   service_description;
+	unsigned long   author;
+	unsigned long   comment_data;
+	unsigned long   comment_id;
+	unsigned long   entry_time;
+	unsigned long   expire_time;
+	int             comment_type;
+	int             entry_type;
+	int             source;
+	int             persistent;
+	int             expires;
+        }xsddefault_binary_comment;
+
+typedef struct xsddefault_binary_downtime_struct{
+	unsigned long   host_name;
+	unsigned long   service_description;
+	unsigned long   author;
+	unsigned long   comment;
+	unsigned long   downtime_id;
+	unsigned long   entry_time;
+	unsigned long   start_time;
+	unsigned long   end_time;
+	unsigned long   triggered_by;
+	unsigned long   duration;
+	unsigned long   trigger_time;
+	int             type;
+	int             fixed;
+	int             is_in_effect;
+        }xsddefault_binary_downtime;
+
 int xsddefault_grab_config_info(char *);
 int xsddefault_grab_config_directives(char *);
 